@@ -0,0 +1,284 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Benchmark of the boundary surface extraction of hexahedral meshes (@see extractMeshBoundarySurface).
+ *
+ * The parallel extraction is compared to the previous serial implementation (sorting all faces with std::sort and
+ * compacting the vertices using a std::set and std::unordered_map) on structured hexahedral grids of increasing size
+ * with randomly shuffled vertex indices and, optionally, on the passed mesh files. For each mesh, the average time of
+ * both implementations is measured, and it is checked that both produce identical output. The results are written as
+ * CSV.
+ *
+ * Usage: LineVis_benchmark_boundary [--output <file.csv>] [--max-cells <n>] [--repetitions <n>] [<mesh.vtk> ...]
+ */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <array>
+#include <set>
+#include <unordered_map>
+#include <random>
+#include <numeric>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#if _OPENMP >= 201107
+#include <omp.h>
+#endif
+
+#include <glm/glm.hpp>
+
+#include "LineData/Mesh/VtkLoader.hpp"
+#include "LineData/Mesh/MeshLoader.hpp"
+#include "LineData/Mesh/MeshBoundarySurface.hpp"
+
+namespace {
+
+const int HEX_FACE_TABLE[6][4] = {
+        { 0,1,2,3 }, { 5,4,7,6 }, { 4,5,1,0 }, { 4,0,3,7 }, { 6,7,3,2 }, { 1,5,6,2 },
+};
+
+/// The previous serial implementation of the boundary surface extraction.
+void extractMeshBoundarySurfaceSerial(
+        const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& cellIndices,
+        std::vector<uint32_t>& triangleIndices, std::vector<glm::vec3>& vertexPositions) {
+    struct TempFace {
+        uint32_t vertexId[4];
+        uint32_t faceId;
+        bool operator<(const TempFace& other) const {
+            for (int i = 0; i < 4; i++) {
+                if (vertexId[i] != other.vertexId[i]) {
+                    return vertexId[i] < other.vertexId[i];
+                }
+            }
+            return faceId < other.faceId;
+        }
+        bool operator!=(const TempFace& other) const {
+            return !std::equal(vertexId, vertexId + 4, other.vertexId);
+        }
+    };
+
+    const uint32_t numCells = uint32_t(cellIndices.size() / 8);
+    std::vector<std::array<uint32_t, 4>> totalFaces(numCells * 6);
+    std::vector<TempFace> tempFaces(numCells * 6);
+    for (uint32_t cellId = 0; cellId < numCells; cellId++) {
+        for (uint32_t faceIdx = 0; faceIdx < 6; faceIdx++) {
+            std::array<uint32_t, 4> face;
+            for (int i = 0; i < 4; i++) {
+                face[i] = cellIndices[cellId * 8 + HEX_FACE_TABLE[faceIdx][i]];
+            }
+            uint32_t faceId = 6 * cellId + faceIdx;
+            totalFaces[faceId] = face;
+            std::sort(face.begin(), face.end());
+            tempFaces[faceId] = TempFace{ { face[0], face[1], face[2], face[3] }, faceId };
+        }
+    }
+    std::sort(tempFaces.begin(), tempFaces.end());
+
+    std::vector<std::array<uint32_t, 4>> faces;
+    std::vector<bool> isBoundaryFace;
+    faces.reserve(tempFaces.size() / 3);
+    for (size_t i = 0; i < tempFaces.size(); i++) {
+        if (i == 0 || tempFaces[i] != tempFaces[i - 1]) {
+            faces.push_back(totalFaces[tempFaces[i].faceId]);
+            isBoundaryFace.push_back(true);
+        } else {
+            isBoundaryFace.back() = false;
+        }
+    }
+
+    std::set<uint32_t> usedVertexSet;
+    for (size_t i = 0; i < faces.size(); i++) {
+        if (isBoundaryFace[i]) {
+            usedVertexSet.insert(faces[i].begin(), faces[i].end());
+        }
+    }
+    std::unordered_map<uint32_t, uint32_t> vertexIndexMap;
+    for (uint32_t vertexId : usedVertexSet) {
+        vertexIndexMap.insert(std::make_pair(vertexId, uint32_t(vertexPositions.size())));
+        vertexPositions.push_back(vertices[vertexId]);
+    }
+    for (size_t i = 0; i < faces.size(); i++) {
+        if (!isBoundaryFace[i]) {
+            continue;
+        }
+        const std::array<uint32_t, 4>& f = faces[i];
+        for (int j : { 2, 1, 0, 3, 2, 0 }) {
+            triangleIndices.push_back(vertexIndexMap[f[j]]);
+        }
+    }
+}
+
+/// Creates a grid of numCellsPerAxis^3 hexahedra with randomly shuffled vertex indices.
+void createHexGrid(int numCellsPerAxis, std::vector<glm::vec3>& vertices, std::vector<uint32_t>& cellIndices) {
+    std::default_random_engine generator(12345);
+    const int numVerticesPerAxis = numCellsPerAxis + 1;
+    const size_t numVertices = size_t(numVerticesPerAxis) * size_t(numVerticesPerAxis) * size_t(numVerticesPerAxis);
+    std::vector<uint32_t> permutation(numVertices);
+    std::iota(permutation.begin(), permutation.end(), 0);
+    std::shuffle(permutation.begin(), permutation.end(), generator);
+
+    vertices.resize(numVertices);
+    for (int z = 0; z < numVerticesPerAxis; z++) {
+        for (int y = 0; y < numVerticesPerAxis; y++) {
+            for (int x = 0; x < numVerticesPerAxis; x++) {
+                size_t vertexIdx = (size_t(z) * numVerticesPerAxis + y) * numVerticesPerAxis + x;
+                vertices[permutation[vertexIdx]] = glm::vec3(float(x), float(y), float(z));
+            }
+        }
+    }
+    auto vertexIndex = [&](int x, int y, int z) {
+        return permutation[(size_t(z) * numVerticesPerAxis + y) * numVerticesPerAxis + x];
+    };
+    cellIndices.clear();
+    cellIndices.reserve(size_t(numCellsPerAxis) * numCellsPerAxis * numCellsPerAxis * 8);
+    for (int z = 0; z < numCellsPerAxis; z++) {
+        for (int y = 0; y < numCellsPerAxis; y++) {
+            for (int x = 0; x < numCellsPerAxis; x++) {
+                cellIndices.insert(cellIndices.end(), {
+                        vertexIndex(x, y, z), vertexIndex(x + 1, y, z),
+                        vertexIndex(x + 1, y + 1, z), vertexIndex(x, y + 1, z),
+                        vertexIndex(x, y, z + 1), vertexIndex(x + 1, y, z + 1),
+                        vertexIndex(x + 1, y + 1, z + 1), vertexIndex(x, y + 1, z + 1) });
+            }
+        }
+    }
+}
+
+bool loadHexMesh(const std::string& filename, std::vector<glm::vec3>& vertices, std::vector<uint32_t>& cellIndices) {
+    std::vector<glm::vec3> deformations;
+    std::vector<float> anisotropyMetricList;
+    size_t extensionPos = filename.find_last_of('.');
+    std::string extension = extensionPos == std::string::npos ? "" : filename.substr(extensionPos + 1);
+    if (extension == "vtk") {
+        VtkLoader loader;
+        return loader.loadHexahedralMeshFromFile(filename, vertices, cellIndices, deformations, anisotropyMetricList);
+    } else if (extension == "mesh") {
+        MeshLoader loader;
+        return loader.loadHexahedralMeshFromFile(filename, vertices, cellIndices, deformations, anisotropyMetricList);
+    }
+    return false;
+}
+
+double getElapsedMilliseconds(const std::chrono::steady_clock::time_point& start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void benchmarkMesh(
+        std::ostream& output, const std::string& meshName, const std::vector<glm::vec3>& vertices,
+        const std::vector<uint32_t>& cellIndices, int numRepetitions) {
+    std::vector<uint32_t> triangleIndicesSerial, triangleIndicesParallel;
+    std::vector<glm::vec3> vertexPositionsSerial, vertexPositionsParallel;
+
+    double serialMs = 0.0, parallelMs = 0.0;
+    for (int repetition = 0; repetition < numRepetitions; repetition++) {
+        triangleIndicesSerial.clear();
+        vertexPositionsSerial.clear();
+        auto startTime = std::chrono::steady_clock::now();
+        extractMeshBoundarySurfaceSerial(vertices, cellIndices, triangleIndicesSerial, vertexPositionsSerial);
+        serialMs += getElapsedMilliseconds(startTime);
+
+        startTime = std::chrono::steady_clock::now();
+        extractMeshBoundarySurface(vertices, cellIndices, triangleIndicesParallel, vertexPositionsParallel);
+        parallelMs += getElapsedMilliseconds(startTime);
+    }
+    serialMs /= double(numRepetitions);
+    parallelMs /= double(numRepetitions);
+
+    bool isIdentical =
+            triangleIndicesSerial == triangleIndicesParallel
+            && vertexPositionsSerial.size() == vertexPositionsParallel.size()
+            && std::equal(vertexPositionsSerial.begin(), vertexPositionsSerial.end(), vertexPositionsParallel.begin());
+#if _OPENMP >= 201107
+    int numThreads = omp_get_max_threads();
+#else
+    int numThreads = 1;
+#endif
+    output << meshName << "," << (cellIndices.size() / 8) << "," << (triangleIndicesParallel.size() / 3) << ","
+            << numThreads << "," << serialMs << "," << parallelMs << "," << (serialMs / parallelMs) << ","
+            << (isIdentical ? "true" : "false") << std::endl;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    std::string outputFilename;
+    size_t maxNumCells = 8000000;
+    int numRepetitions = 3;
+    std::vector<std::string> meshFilenames;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            outputFilename = argv[++i];
+        } else if (std::strcmp(argv[i], "--max-cells") == 0 && i + 1 < argc) {
+            maxNumCells = size_t(std::strtoull(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+            numRepetitions = std::max(std::atoi(argv[++i]), 1);
+        } else if (argv[i][0] == '-') {
+            std::cerr << "Usage: " << argv[0]
+                    << " [--output <file.csv>] [--max-cells <n>] [--repetitions <n>] [<mesh.vtk> ...]" << std::endl;
+            return 1;
+        } else {
+            meshFilenames.push_back(argv[i]);
+        }
+    }
+
+    std::ofstream outputFile;
+    if (!outputFilename.empty()) {
+        outputFile.open(outputFilename);
+        if (!outputFile.is_open()) {
+            std::cerr << "Error: Couldn't open the file \"" << outputFilename << "\" for writing." << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& output = outputFilename.empty() ? std::cout : outputFile;
+    output << "mesh,num_cells,num_boundary_triangles,num_threads,serial_ms,parallel_ms,speedup,identical" << std::endl;
+
+    std::vector<glm::vec3> vertices;
+    std::vector<uint32_t> cellIndices;
+    for (int numCellsPerAxis = 25; size_t(numCellsPerAxis) * numCellsPerAxis * numCellsPerAxis <= maxNumCells;
+            numCellsPerAxis *= 2) {
+        createHexGrid(numCellsPerAxis, vertices, cellIndices);
+        benchmarkMesh(output, "grid" + std::to_string(numCellsPerAxis), vertices, cellIndices, numRepetitions);
+    }
+    for (const std::string& meshFilename : meshFilenames) {
+        vertices.clear();
+        cellIndices.clear();
+        if (!loadHexMesh(meshFilename, vertices, cellIndices)) {
+            std::cerr << "Error: Couldn't load the mesh file \"" << meshFilename << "\"." << std::endl;
+            continue;
+        }
+        benchmarkMesh(output, meshFilename, vertices, cellIndices, numRepetitions);
+    }
+    return 0;
+}
@@ -0,0 +1,724 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Benchmark of the point search structures in src/LineData/SearchStructures.
+ *
+ * Each search structure is built on synthetic point sets of increasing size (uniformly distributed, clustered and
+ * line-like points) and, optionally, on the vertices of the passed Wavefront OBJ line files. For each combination,
+ * the build time, the heap memory used by the structure and the throughput of single (one thread) and batched (all
+ * threads) nearest neighbor and radius queries are measured. The results are written as CSV. For example, the rows
+ * of KdTree and FlatKdTree on one million uniformly distributed points with --num-queries 1000000 compare the build
+ * and query throughput of the pointer-based and the flat k-d-tree.
+ *
+ * Additionally, the build time of the line segment hierarchy used for picking lines and the time of a picking ray
+ * query are measured on random walk lines with up to the maximum number of points. These results are written as a
+ * second CSV table (after an empty line if no separate picking output file is passed).
+ *
+ * Finally, the conversion of multi-variate lines to Bezier curves (@see convertTrajectoriesToBezierCurves) is timed
+ * with the Newton arc length solver and with the arc length table solver, and the maximum distance between the
+ * resampled points of the two solvers is reported. These results are written as a third CSV table in the same way.
+ *
+ * Usage: LineVis_benchmark [--output <file.csv>] [--picking-output <file.csv>] [--bezier-output <file.csv>]
+ *        [--max-points <n>] [--num-queries <n>] [<lines.obj> ...]
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <random>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
+#include <limits>
+#include <new>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+
+#include <glm/glm.hpp>
+
+#include "LineData/SearchStructures/SearchStructure.hpp"
+#include "LineData/SearchStructures/NaiveSearchStructure.h"
+#include "LineData/SearchStructures/KdTree.hpp"
+#include "LineData/SearchStructures/FlatKdTree.hpp"
+#include "LineData/SearchStructures/HashedGrid.hpp"
+#include "LineData/SearchStructures/UniformGrid.hpp"
+#include "LineData/SearchStructures/LineSegmentBvh.hpp"
+#include "LineData/MultiVar/BezierTrajectory.hpp"
+
+// --- Heap allocation tracking for measuring the memory used by the search structures. ---
+
+namespace {
+std::atomic<size_t> numAllocatedBytes(0);
+std::atomic<size_t> peakNumAllocatedBytes(0);
+/// Each allocation stores its size in front of the returned memory (keeps the alignment of malloc).
+const size_t ALLOCATION_HEADER_SIZE = 16;
+
+void* trackedMalloc(size_t size) {
+    void* ptr = std::malloc(size + ALLOCATION_HEADER_SIZE);
+    if (ptr == nullptr) {
+        return nullptr;
+    }
+    *static_cast<size_t*>(ptr) = size;
+    size_t currentNumBytes = numAllocatedBytes.fetch_add(size, std::memory_order_relaxed) + size;
+    size_t peakNumBytes = peakNumAllocatedBytes.load(std::memory_order_relaxed);
+    while (currentNumBytes > peakNumBytes
+            && !peakNumAllocatedBytes.compare_exchange_weak(peakNumBytes, currentNumBytes)) {}
+    return static_cast<char*>(ptr) + ALLOCATION_HEADER_SIZE;
+}
+
+void trackedFree(void* ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    void* allocationPtr = static_cast<char*>(ptr) - ALLOCATION_HEADER_SIZE;
+    numAllocatedBytes.fetch_sub(*static_cast<size_t*>(allocationPtr), std::memory_order_relaxed);
+    std::free(allocationPtr);
+}
+}
+
+void* operator new(size_t size) {
+    void* ptr = trackedMalloc(size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+void* operator new[](size_t size) {
+    void* ptr = trackedMalloc(size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return trackedMalloc(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return trackedMalloc(size); }
+void operator delete(void* ptr) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr) noexcept { trackedFree(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { trackedFree(ptr); }
+#ifdef __cpp_sized_deallocation
+void operator delete(void* ptr, size_t) noexcept { trackedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { trackedFree(ptr); }
+#endif
+
+
+// --- Point sets. ---
+
+struct PointSet {
+    std::string name;
+    std::vector<glm::vec3> positions;
+};
+
+void generateUniformPoints(size_t numPoints, std::default_random_engine& generator, std::vector<glm::vec3>& positions) {
+    std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+    positions.resize(numPoints);
+    for (size_t i = 0; i < numPoints; i++) {
+        positions.at(i) = glm::vec3(distribution(generator), distribution(generator), distribution(generator));
+    }
+}
+
+/// Points normally distributed around 64 cluster centers with varying extent.
+void generateClusteredPoints(
+        size_t numPoints, std::default_random_engine& generator, std::vector<glm::vec3>& positions) {
+    const int NUM_CLUSTERS = 64;
+    std::uniform_real_distribution<float> centerDistribution(0.1f, 0.9f);
+    std::uniform_real_distribution<float> sigmaDistribution(0.005f, 0.05f);
+    std::uniform_int_distribution<int> clusterDistribution(0, NUM_CLUSTERS - 1);
+    std::normal_distribution<float> normalDistribution(0.0f, 1.0f);
+    std::vector<glm::vec3> clusterCenters(NUM_CLUSTERS);
+    std::vector<float> clusterSigmas(NUM_CLUSTERS);
+    for (int clusterIdx = 0; clusterIdx < NUM_CLUSTERS; clusterIdx++) {
+        clusterCenters.at(clusterIdx) = glm::vec3(
+                centerDistribution(generator), centerDistribution(generator), centerDistribution(generator));
+        clusterSigmas.at(clusterIdx) = sigmaDistribution(generator);
+    }
+    positions.resize(numPoints);
+    for (size_t i = 0; i < numPoints; i++) {
+        int clusterIdx = clusterDistribution(generator);
+        positions.at(i) = clusterCenters.at(clusterIdx) + clusterSigmas.at(clusterIdx) * glm::vec3(
+                normalDistribution(generator), normalDistribution(generator), normalDistribution(generator));
+    }
+}
+
+/// Random walk lines with closely spaced points, similar to the vertices of traced flow or stress lines.
+void generateLinePoints(size_t numPoints, std::default_random_engine& generator, std::vector<glm::vec3>& positions) {
+    std::uniform_real_distribution<float> positionDistribution(0.0f, 1.0f);
+    std::uniform_real_distribution<float> directionDistribution(-1.0f, 1.0f);
+    std::uniform_int_distribution<size_t> lengthDistribution(100, 500);
+    const float STEP_SIZE = 0.002f;
+    positions.clear();
+    positions.reserve(numPoints);
+    while (positions.size() < numPoints) {
+        glm::vec3 position(positionDistribution(generator), positionDistribution(generator),
+                positionDistribution(generator));
+        glm::vec3 direction(1.0f, 0.0f, 0.0f);
+        size_t numLinePoints = std::min(lengthDistribution(generator), numPoints - positions.size());
+        for (size_t i = 0; i < numLinePoints; i++) {
+            positions.push_back(position);
+            glm::vec3 newDirection = direction + 0.2f * glm::vec3(
+                    directionDistribution(generator), directionDistribution(generator),
+                    directionDistribution(generator));
+            float length = glm::length(newDirection);
+            if (length > 1e-6f) {
+                direction = newDirection / length;
+            }
+            position += STEP_SIZE * direction;
+        }
+    }
+}
+
+/// Loads the vertex positions of a Wavefront OBJ file and scales them to the unit cube (preserving the aspect ratio).
+bool loadObjPoints(const std::string& filename, std::vector<glm::vec3>& positions) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.size() < 2 || line[0] != 'v' || (line[1] != ' ' && line[1] != '\t')) {
+            continue;
+        }
+        std::istringstream lineStream(line.substr(2));
+        glm::vec3 position;
+        if (lineStream >> position.x >> position.y >> position.z) {
+            positions.push_back(position);
+        }
+    }
+    if (positions.empty()) {
+        return false;
+    }
+
+    glm::vec3 minPosition(std::numeric_limits<float>::max());
+    glm::vec3 maxPosition(std::numeric_limits<float>::lowest());
+    for (const glm::vec3& position : positions) {
+        for (int i = 0; i < 3; i++) {
+            minPosition[i] = std::min(minPosition[i], position[i]);
+            maxPosition[i] = std::max(maxPosition[i], position[i]);
+        }
+    }
+    glm::vec3 extent = maxPosition - minPosition;
+    float maxExtent = std::max(extent.x, std::max(extent.y, extent.z));
+    float scale = maxExtent > 0.0f ? 1.0f / maxExtent : 1.0f;
+    for (glm::vec3& position : positions) {
+        position = (position - minPosition) * scale;
+    }
+    return true;
+}
+
+
+// --- Search structures. ---
+
+struct SearchStructureInfo {
+    std::string name;
+    /// Point sets with more points are skipped (e.g., for the O(n) queries of NaiveSearchStructure).
+    size_t maxNumPoints;
+    /// Creates the search structure for a point set with the passed number of points and query radius.
+    std::function<SearchStructure*(size_t numPoints, float queryRadius)> create;
+};
+
+std::vector<SearchStructureInfo> getSearchStructureInfos() {
+    std::vector<SearchStructureInfo> infos;
+    infos.push_back({ "NaiveSearchStructure", 10000, [](size_t, float) -> SearchStructure* {
+        return new NaiveSearchStructure;
+    }});
+    infos.push_back({ "KdTree", std::numeric_limits<size_t>::max(), [](size_t, float) -> SearchStructure* {
+        return new KdTree;
+    }});
+    infos.push_back({ "FlatKdTree", std::numeric_limits<size_t>::max(), [](size_t, float) -> SearchStructure* {
+        return new FlatKdTree;
+    }});
+    // One hash table entry per point and cells covering the query diameter.
+    infos.push_back({ "HashedGrid", std::numeric_limits<size_t>::max(),
+            [](size_t numPoints, float queryRadius) -> SearchStructure* {
+        return new HashedGrid(std::max(numPoints, size_t(1)), 2.0f * queryRadius);
+    }});
+    infos.push_back({ "UniformGrid", std::numeric_limits<size_t>::max(), [](size_t, float) -> SearchStructure* {
+        return new UniformGrid;
+    }});
+    return infos;
+}
+
+
+// --- Measurements. ---
+
+struct BenchmarkResult {
+    double buildTimeMs = 0.0;
+    size_t memoryBytes = 0; ///< Heap memory used by the built structure.
+    size_t buildPeakMemoryBytes = 0; ///< Peak heap memory used during the build (including temporary memory).
+    // Queries per second (negative if the structure does not support the query type).
+    double nearestNeighborSingleQps = -1.0;
+    double nearestNeighborBatchedQps = -1.0;
+    double radiusSingleQps = -1.0;
+    double radiusBatchedQps = -1.0;
+    double averageNumRadiusResults = 0.0;
+};
+
+double getElapsedSeconds(const std::chrono::steady_clock::time_point& start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// Counts the points inside of the sphere. NaiveSearchStructure returns all points, so its results are filtered.
+size_t countPointsInSphere(const std::vector<IndexedPoint*>& points, const glm::vec3& center, float radius) {
+    const float radiusSquared = radius * radius;
+    size_t numPointsInSphere = 0;
+    for (const IndexedPoint* point : points) {
+        glm::vec3 diff = point->position - center;
+        if (diff.x * diff.x + diff.y * diff.y + diff.z * diff.z <= radiusSquared) {
+            numPointsInSphere++;
+        }
+    }
+    return numPointsInSphere;
+}
+
+/**
+ * Nearest neighbor queries are only supported by the k-d-trees.
+ * @return False if the search structure does not support nearest neighbor queries.
+ */
+bool findNearestNeighbors(
+        SearchStructure* searchStructure, const std::vector<glm::vec3>& queryPoints, bool batched,
+        std::vector<IndexedPoint*>& nearestNeighbors) {
+    const auto numQueries = int(queryPoints.size());
+    nearestNeighbors.resize(queryPoints.size());
+    if (auto* flatKdTree = dynamic_cast<FlatKdTree*>(searchStructure)) {
+        if (batched) {
+            flatKdTree->findNearestNeighbors(queryPoints, nearestNeighbors);
+        } else {
+            for (int i = 0; i < numQueries; i++) {
+                nearestNeighbors.at(i) = flatKdTree->findNearestNeighbor(queryPoints.at(i));
+            }
+        }
+        return true;
+    }
+    if (auto* kdTree = dynamic_cast<KdTree*>(searchStructure)) {
+        if (batched) {
+#if _OPENMP >= 201107
+            #pragma omp parallel for shared(queryPoints, nearestNeighbors, kdTree, numQueries) default(none)
+#endif
+            for (int i = 0; i < numQueries; i++) {
+                nearestNeighbors.at(i) = kdTree->findNearestNeighbor(queryPoints.at(i));
+            }
+        } else {
+            for (int i = 0; i < numQueries; i++) {
+                nearestNeighbors.at(i) = kdTree->findNearestNeighbor(queryPoints.at(i));
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
+/// The batched queries use the batch interface of FlatKdTree and a parallel loop over the queries otherwise.
+size_t findPointsInSpheres(
+        SearchStructure* searchStructure, const std::vector<glm::vec3>& queryPoints, float radius, bool batched) {
+    const auto numQueries = int(queryPoints.size());
+    size_t numResults = 0;
+    if (!batched) {
+        for (int i = 0; i < numQueries; i++) {
+            const glm::vec3& queryPoint = queryPoints.at(i);
+            numResults += countPointsInSphere(
+                    searchStructure->findPointsInSphere(queryPoint, radius), queryPoint, radius);
+        }
+        return numResults;
+    }
+
+    std::vector<std::vector<IndexedPoint*>> pointsInSpheres;
+    auto* flatKdTree = dynamic_cast<FlatKdTree*>(searchStructure);
+    if (flatKdTree) {
+        flatKdTree->findPointsInSpheres(queryPoints, radius, pointsInSpheres);
+    } else {
+        pointsInSpheres.resize(queryPoints.size());
+#if _OPENMP >= 201107
+        #pragma omp parallel for shared(queryPoints, pointsInSpheres, searchStructure, numQueries, radius) \
+        default(none)
+#endif
+        for (int i = 0; i < numQueries; i++) {
+            pointsInSpheres.at(i) = searchStructure->findPointsInSphere(queryPoints.at(i), radius);
+        }
+    }
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(queryPoints, pointsInSpheres, numQueries, radius) default(none) \
+    reduction(+: numResults)
+#endif
+    for (int i = 0; i < numQueries; i++) {
+        numResults += countPointsInSphere(pointsInSpheres.at(i), queryPoints.at(i), radius);
+    }
+    return numResults;
+}
+
+BenchmarkResult runBenchmark(
+        const SearchStructureInfo& info, const std::vector<IndexedPoint*>& indexedPoints,
+        const std::vector<glm::vec3>& queryPoints, float queryRadius) {
+    BenchmarkResult result;
+
+    // Small point sets are built multiple times to get stable timings.
+    const int numBuildRepetitions = indexedPoints.size() <= 100000 ? 3 : 1;
+    std::unique_ptr<SearchStructure> searchStructure;
+    result.buildTimeMs = std::numeric_limits<double>::max();
+    for (int repetition = 0; repetition < numBuildRepetitions; repetition++) {
+        searchStructure.reset();
+        size_t numBytesStart = numAllocatedBytes.load();
+        peakNumAllocatedBytes.store(numBytesStart);
+        auto startTime = std::chrono::steady_clock::now();
+        searchStructure.reset(info.create(indexedPoints.size(), queryRadius));
+        searchStructure->build(indexedPoints);
+        result.buildTimeMs = std::min(result.buildTimeMs, getElapsedSeconds(startTime) * 1e3);
+        result.memoryBytes = numAllocatedBytes.load() - numBytesStart;
+        result.buildPeakMemoryBytes = peakNumAllocatedBytes.load() - numBytesStart;
+    }
+
+    const auto numQueries = double(queryPoints.size());
+    std::vector<IndexedPoint*> nearestNeighbors;
+    auto startTime = std::chrono::steady_clock::now();
+    if (findNearestNeighbors(searchStructure.get(), queryPoints, false, nearestNeighbors)) {
+        result.nearestNeighborSingleQps = numQueries / getElapsedSeconds(startTime);
+        startTime = std::chrono::steady_clock::now();
+        findNearestNeighbors(searchStructure.get(), queryPoints, true, nearestNeighbors);
+        result.nearestNeighborBatchedQps = numQueries / getElapsedSeconds(startTime);
+    }
+
+    startTime = std::chrono::steady_clock::now();
+    size_t numResults = findPointsInSpheres(searchStructure.get(), queryPoints, queryRadius, false);
+    result.radiusSingleQps = numQueries / getElapsedSeconds(startTime);
+    startTime = std::chrono::steady_clock::now();
+    findPointsInSpheres(searchStructure.get(), queryPoints, queryRadius, true);
+    result.radiusBatchedQps = numQueries / getElapsedSeconds(startTime);
+    result.averageNumRadiusResults = double(numResults) / numQueries;
+
+    return result;
+}
+
+/// Writes a CSV field for an optional measurement (empty if the value is negative, i.e., not supported).
+std::string formatOptional(double value) {
+    if (value < 0.0) {
+        return "";
+    }
+    std::ostringstream stream;
+    stream << value;
+    return stream.str();
+}
+
+void benchmarkPointSet(
+        const PointSet& pointSet, const std::vector<SearchStructureInfo>& infos, size_t maxNumQueries,
+        std::ostream& output) {
+    const size_t numPoints = pointSet.positions.size();
+    std::vector<IndexedPoint> points(numPoints);
+    std::vector<IndexedPoint*> indexedPoints(numPoints);
+    for (size_t i = 0; i < numPoints; i++) {
+        points.at(i).position = pointSet.positions.at(i);
+        points.at(i).index = ptrdiff_t(i);
+        indexedPoints.at(i) = &points.at(i);
+    }
+
+    // The radius is chosen such that a query contains 16 points on average for uniformly distributed points.
+    const float EXPECTED_NUM_NEIGHBORS = 16.0f;
+    const float PI = 3.14159265358979323846f;
+    float queryRadius = std::cbrt(3.0f * EXPECTED_NUM_NEIGHBORS / (4.0f * PI * float(std::max(numPoints, size_t(1)))));
+
+    // The query points are jittered points of the point set (like, e.g., the queries of degenerate point removal).
+    std::default_random_engine generator(4321);
+    std::uniform_int_distribution<size_t> pointDistribution(0, std::max(numPoints, size_t(1)) - 1);
+    std::normal_distribution<float> jitterDistribution(0.0f, queryRadius);
+    std::vector<glm::vec3> queryPoints(std::min(numPoints, maxNumQueries));
+    for (glm::vec3& queryPoint : queryPoints) {
+        queryPoint = pointSet.positions.at(pointDistribution(generator)) + glm::vec3(
+                jitterDistribution(generator), jitterDistribution(generator), jitterDistribution(generator));
+    }
+
+    for (const SearchStructureInfo& info : infos) {
+        if (numPoints > info.maxNumPoints) {
+            continue;
+        }
+        std::cerr << "Benchmarking " << info.name << " on " << pointSet.name << " (" << numPoints << " points)..."
+                << std::endl;
+        BenchmarkResult result = runBenchmark(info, indexedPoints, queryPoints, queryRadius);
+        output << pointSet.name << "," << numPoints << "," << info.name << ","
+                << result.buildTimeMs << "," << result.memoryBytes << "," << result.buildPeakMemoryBytes << ","
+                << queryPoints.size() << "," << queryRadius << ","
+                << formatOptional(result.nearestNeighborSingleQps) << ","
+                << formatOptional(result.nearestNeighborBatchedQps) << ","
+                << formatOptional(result.radiusSingleQps) << ","
+                << formatOptional(result.radiusBatchedQps) << ","
+                << result.averageNumRadiusResults << std::endl;
+    }
+}
+
+
+// --- Line picking. ---
+
+/// Random walk lines with 100 points each (i.e., like the lines of generateLinePoints, but with rougher steps).
+void generateLines(
+        size_t numLines, std::default_random_engine& generator, std::vector<std::vector<glm::vec3>>& lines) {
+    const int NUM_LINE_POINTS = 100;
+    std::uniform_real_distribution<float> positionDistribution(0.0f, 1.0f);
+    std::uniform_real_distribution<float> stepDistribution(-0.005f, 0.005f);
+    lines.resize(numLines);
+    for (std::vector<glm::vec3>& line : lines) {
+        glm::vec3 position(
+                positionDistribution(generator), positionDistribution(generator), positionDistribution(generator));
+        line.clear();
+        for (int i = 0; i < NUM_LINE_POINTS; i++) {
+            line.push_back(position);
+            position += glm::vec3(
+                    stepDistribution(generator), stepDistribution(generator), stepDistribution(generator));
+        }
+    }
+}
+
+/**
+ * Builds a LineSegmentBvh and picks the lines with a screen-sized grid of rays from a perspective camera. Picking is
+ * done on mouse hover, so a single ray query should take well under a millisecond.
+ */
+void benchmarkLinePicking(const std::vector<std::vector<glm::vec3>>& lines, std::ostream& output) {
+    const int GRID_SIZE = 64;
+    const float TUBE_RADIUS = 0.002f;
+    const glm::vec3 cameraPosition(0.5f, 0.5f, 3.0f);
+
+    auto startTime = std::chrono::steady_clock::now();
+    LineSegmentBvh bvh;
+    bvh.build(lines);
+    double buildTimeMs = getElapsedSeconds(startTime) * 1e3;
+
+    int numHits = 0;
+    startTime = std::chrono::steady_clock::now();
+    for (int y = 0; y < GRID_SIZE; y++) {
+        for (int x = 0; x < GRID_SIZE; x++) {
+            glm::vec3 target((float(x) + 0.5f) / float(GRID_SIZE), (float(y) + 0.5f) / float(GRID_SIZE), 0.5f);
+            LineSegmentHit hit;
+            if (bvh.intersectRay(cameraPosition, glm::normalize(target - cameraPosition), TUBE_RADIUS, hit)) {
+                numHits++;
+            }
+        }
+    }
+    double queryTimeUs = getElapsedSeconds(startTime) * 1e6 / double(GRID_SIZE * GRID_SIZE);
+
+    output << lines.size() << "," << bvh.getNumSegments() << "," << buildTimeMs << ","
+            << (GRID_SIZE * GRID_SIZE) << "," << TUBE_RADIUS << "," << queryTimeUs << "," << numHits << std::endl;
+}
+
+// --- Bezier curve conversion of multi-variate lines. ---
+
+/// Noisy helices with the passed number of variables per line point (like the lines in TestBezierTrajectory.cpp).
+void generateMultiVarTrajectories(
+        size_t numLines, int numLinePoints, int numVariables, std::default_random_engine& generator,
+        Trajectories& trajectories) {
+    std::uniform_real_distribution<float> positionDistribution(0.0f, 1.0f);
+    std::uniform_real_distribution<float> noiseDistribution(-0.002f, 0.002f);
+    std::uniform_real_distribution<float> attributeDistribution(-10.0f, 10.0f);
+    trajectories.clear();
+    trajectories.resize(numLines);
+    for (Trajectory& trajectory : trajectories) {
+        glm::vec3 center(
+                positionDistribution(generator), positionDistribution(generator), positionDistribution(generator));
+        float radius = 0.02f + 0.05f * positionDistribution(generator);
+        float pitch = 0.001f + 0.004f * positionDistribution(generator);
+        for (int i = 0; i < numLinePoints; i++) {
+            float angle = 0.2f * float(i);
+            trajectory.positions.push_back(center + glm::vec3(
+                    radius * std::cos(angle) + noiseDistribution(generator),
+                    radius * std::sin(angle) + noiseDistribution(generator),
+                    pitch * float(i)));
+        }
+        trajectory.attributes.resize(numVariables);
+        for (std::vector<float>& attributeValues : trajectory.attributes) {
+            for (int i = 0; i < numLinePoints; i++) {
+                attributeValues.push_back(attributeDistribution(generator));
+            }
+        }
+    }
+}
+
+/// Returns the maximum distance between corresponding resampled points of the two sets of Bezier trajectories.
+float computeMaxBezierPointDistance(
+        const BezierTrajectories& trajectories0, const BezierTrajectories& trajectories1) {
+    float maxDistance = 0.0f;
+    for (size_t lineIdx = 0; lineIdx < trajectories0.size() && lineIdx < trajectories1.size(); lineIdx++) {
+        const std::vector<glm::vec3>& positions0 = trajectories0.at(lineIdx).positions;
+        const std::vector<glm::vec3>& positions1 = trajectories1.at(lineIdx).positions;
+        for (size_t i = 0; i < positions0.size() && i < positions1.size(); i++) {
+            maxDistance = std::max(maxDistance, glm::length(positions0.at(i) - positions1.at(i)));
+        }
+    }
+    return maxDistance;
+}
+
+/**
+ * Converts the passed lines to Bezier curves once with the Newton arc length solver (the previous implementation) and
+ * once with the arc length table solver. The conversion runs when a multi-variate data set is loaded.
+ */
+void benchmarkBezierConversion(const Trajectories& trajectories, int numVariables, std::ostream& output) {
+    const std::pair<const char*, BezierArcLengthSolver> solvers[] = {
+            { "newton", BEZIER_ARC_LENGTH_SOLVER_NEWTON },
+            { "table", BEZIER_ARC_LENGTH_SOLVER_TABLE },
+    };
+    BezierTrajectories bezierTrajectoriesPerSolver[2];
+    double conversionTimesMs[2];
+    for (int solverIdx = 0; solverIdx < 2; solverIdx++) {
+        auto startTime = std::chrono::steady_clock::now();
+        convertTrajectoriesToBezierCurves(
+                trajectories, bezierTrajectoriesPerSolver[solverIdx], solvers[solverIdx].second);
+        conversionTimesMs[solverIdx] = getElapsedSeconds(startTime) * 1e3;
+    }
+    float maxDistance = computeMaxBezierPointDistance(bezierTrajectoriesPerSolver[0], bezierTrajectoriesPerSolver[1]);
+
+    size_t numPoints = 0;
+    for (const Trajectory& trajectory : trajectories) {
+        numPoints += trajectory.positions.size();
+    }
+    for (int solverIdx = 0; solverIdx < 2; solverIdx++) {
+        output << trajectories.size() << "," << numPoints << "," << numVariables << "," << solvers[solverIdx].first
+                << "," << conversionTimesMs[solverIdx] << "," << (conversionTimesMs[0] / conversionTimesMs[solverIdx])
+                << "," << maxDistance << std::endl;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::string outputFilename;
+    std::string pickingOutputFilename;
+    std::string bezierOutputFilename;
+    size_t maxNumPoints = 1000000;
+    size_t maxNumQueries = 100000;
+    std::vector<std::string> objFilenames;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            outputFilename = argv[++i];
+        } else if (std::strcmp(argv[i], "--picking-output") == 0 && i + 1 < argc) {
+            pickingOutputFilename = argv[++i];
+        } else if (std::strcmp(argv[i], "--bezier-output") == 0 && i + 1 < argc) {
+            bezierOutputFilename = argv[++i];
+        } else if (std::strcmp(argv[i], "--max-points") == 0 && i + 1 < argc) {
+            maxNumPoints = size_t(std::strtoull(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--num-queries") == 0 && i + 1 < argc) {
+            maxNumQueries = size_t(std::strtoull(argv[++i], nullptr, 10));
+        } else if (argv[i][0] == '-') {
+            std::cerr << "Usage: " << argv[0] << " [--output <file.csv>] [--picking-output <file.csv>]"
+                    << " [--bezier-output <file.csv>] [--max-points <n>] [--num-queries <n>] [<lines.obj> ...]"
+                    << std::endl;
+            return 1;
+        } else {
+            objFilenames.push_back(argv[i]);
+        }
+    }
+
+    std::ofstream outputFile;
+    if (!outputFilename.empty()) {
+        outputFile.open(outputFilename);
+        if (!outputFile.is_open()) {
+            std::cerr << "Error: Couldn't open the file \"" << outputFilename << "\" for writing." << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& output = outputFilename.empty() ? std::cout : outputFile;
+    std::ofstream pickingOutputFile;
+    if (!pickingOutputFilename.empty()) {
+        pickingOutputFile.open(pickingOutputFilename);
+        if (!pickingOutputFile.is_open()) {
+            std::cerr << "Error: Couldn't open the file \"" << pickingOutputFilename << "\" for writing." << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& pickingOutput = pickingOutputFilename.empty() ? output : pickingOutputFile;
+    std::ofstream bezierOutputFile;
+    if (!bezierOutputFilename.empty()) {
+        bezierOutputFile.open(bezierOutputFilename);
+        if (!bezierOutputFile.is_open()) {
+            std::cerr << "Error: Couldn't open the file \"" << bezierOutputFilename << "\" for writing." << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& bezierOutput = bezierOutputFilename.empty() ? output : bezierOutputFile;
+    output << "distribution,num_points,structure,build_ms,memory_bytes,build_peak_memory_bytes,num_queries,"
+            << "query_radius,nn_single_queries_per_s,nn_batched_queries_per_s,radius_single_queries_per_s,"
+            << "radius_batched_queries_per_s,avg_radius_results" << std::endl;
+
+    std::vector<SearchStructureInfo> infos = getSearchStructureInfos();
+    typedef void (*PointGenerator)(size_t, std::default_random_engine&, std::vector<glm::vec3>&);
+    const std::pair<const char*, PointGenerator> generators[] = {
+            { "uniform", generateUniformPoints },
+            { "clustered", generateClusteredPoints },
+            { "lines", generateLinePoints },
+    };
+    for (const auto& generator : generators) {
+        for (size_t numPoints = 10000; numPoints <= maxNumPoints; numPoints *= 10) {
+            std::default_random_engine randomEngine(1234);
+            PointSet pointSet;
+            pointSet.name = generator.first;
+            generator.second(numPoints, randomEngine, pointSet.positions);
+            benchmarkPointSet(pointSet, infos, maxNumQueries, output);
+        }
+    }
+
+    for (const std::string& objFilename : objFilenames) {
+        PointSet pointSet;
+        size_t separatorIdx = objFilename.find_last_of("/\\");
+        pointSet.name = separatorIdx == std::string::npos ? objFilename : objFilename.substr(separatorIdx + 1);
+        if (!loadObjPoints(objFilename, pointSet.positions)) {
+            std::cerr << "Error: Couldn't load points from the file \"" << objFilename << "\"." << std::endl;
+            continue;
+        }
+        benchmarkPointSet(pointSet, infos, maxNumQueries, output);
+    }
+
+    if (pickingOutputFilename.empty()) {
+        output << std::endl;
+    }
+    pickingOutput << "num_lines,num_segments,build_ms,num_rays,tube_radius,ray_query_us,ray_hits" << std::endl;
+    for (size_t numPoints = 10000; numPoints <= maxNumPoints; numPoints *= 10) {
+        std::cerr << "Benchmarking LineSegmentBvh picking (" << numPoints << " points)..." << std::endl;
+        std::default_random_engine randomEngine(12345);
+        std::vector<std::vector<glm::vec3>> lines;
+        generateLines(numPoints / 100, randomEngine, lines);
+        benchmarkLinePicking(lines, pickingOutput);
+    }
+
+    if (bezierOutputFilename.empty()) {
+        output << std::endl;
+    }
+    bezierOutput << "num_lines,num_points,num_variables,arc_length_solver,conversion_ms,speedup_over_newton,"
+            << "max_point_distance" << std::endl;
+    const int NUM_BEZIER_LINE_POINTS = 100;
+    for (size_t numPoints = 10000; numPoints <= maxNumPoints; numPoints *= 10) {
+        for (int numVariables : { 1, 8 }) {
+            std::cerr << "Benchmarking Bezier curve conversion (" << numPoints << " points, " << numVariables
+                    << " variables)..." << std::endl;
+            std::default_random_engine randomEngine(12345);
+            Trajectories trajectories;
+            generateMultiVarTrajectories(
+                    numPoints / NUM_BEZIER_LINE_POINTS, NUM_BEZIER_LINE_POINTS, numVariables, randomEngine,
+                    trajectories);
+            benchmarkBezierConversion(trajectories, numVariables, bezierOutput);
+        }
+    }
+
+    return 0;
+}
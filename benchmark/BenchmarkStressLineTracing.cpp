@@ -0,0 +1,204 @@
+/*
+ * Benchmark of the latency of stress line tracing requests using the local mock tracer (StressLineTracingMockServer).
+ *
+ * For line sets of increasing size, requests are sent with StressLineTracingRequesterSocket (like the application
+ * does) using
+ * - the text path (dat): The server writes a .dat version 3 file, which the client parses.
+ * - the binary path (binary): The server sends binary message parts, which the requester thread decodes.
+ * - the streamed binary path (binary-streamed): Like the binary path, but the lines are sent in multiple batches.
+ * The latency is split up into simulated tracing, serialization (on the server), transport and parsing/decoding (on the
+ * client). For the streamed path, the time until the first partial result is available is reported additionally.
+ * The time needed for loading the lines into the line data and rebuilding the render data is logged by the
+ * application itself (see MainApp::logStressLineTracerLatency), as it needs a rendering context.
+ * The results are written as CSV.
+ *
+ * Usage: LineVis_benchmark_tracing [--output <file.csv>] [--max-points <n>] [--repetitions <n>] [--port <n>]
+ *                                  [--delay <ms>] [--batches <n>]
+ */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include <zmq.h>
+#include <json/json.h>
+
+#include "Loaders/StressTrajectoriesDatLoader.hpp"
+#include "Loaders/StressTrajectoriesBinaryLoader.hpp"
+#include "LineData/Stress/StressLineTracingRequesterSocket.hpp"
+#include "LineData/Stress/StressLineTracingMockServer.hpp"
+
+namespace {
+
+const int NUM_POINTS_PER_LINE = 200;
+const char* const PATH_NAMES[] = { "dat", "binary", "binary-streamed" };
+
+struct RequestTimings {
+    double firstResultMs = 0.0; ///< Time until the first (partial) lines were available.
+    double totalMs = 0.0; ///< Time until all lines were available in memory.
+    double tracingMs = 0.0;
+    double serializationMs = 0.0;
+    double transportMs = 0.0;
+    double parsingMs = 0.0;
+    size_t numLines = 0;
+};
+
+double getElapsedMilliseconds(const std::chrono::steady_clock::time_point& start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+size_t getNumLines(const StressTrajectoriesMemoryData& data) {
+    size_t numLines = 0;
+    for (const Trajectories& trajectories : data.trajectoriesPs) {
+        numLines += trajectories.size();
+    }
+    return numLines;
+}
+
+/// Sends one request and waits until all lines of the reply were loaded into memory.
+RequestTimings requestStressLines(StressLineTracingRequesterSocket& requester, int pathIdx, float lineDensCtrl) {
+    Json::Value request;
+    request["lineDensCtrl"] = lineDensCtrl;
+    request["selectedPrincipalStressField"].append(1);
+    request["selectedPrincipalStressField"].append(3);
+    if (pathIdx >= 1) {
+        request["binaryReply"] = true;
+    }
+    if (pathIdx == 2) {
+        request["streamReply"] = true;
+    }
+
+    RequestTimings timings;
+    auto startTime = std::chrono::steady_clock::now();
+    requester.queueRequestJson(request);
+    double decodingMs = 0.0;
+    while (true) {
+        Json::Value reply;
+        std::shared_ptr<const StressTrajectoriesMemoryData> replyData;
+        StressLineTracingReplyTimings replyTimings;
+        if (!requester.getReplyJson(reply, replyData, &replyTimings)) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            continue;
+        }
+
+        const bool isFinalReply = !reply.get("partial", false).asBool();
+        timings.tracingMs += reply["serverTimings"].get("tracingMs", 0.0).asDouble();
+        timings.serializationMs += reply["serverTimings"].get("serializationMs", 0.0).asDouble();
+        decodingMs += replyTimings.decodingMs;
+        if (!replyData && reply.isMember("fileName")) {
+            auto parsingStartTime = std::chrono::steady_clock::now();
+            StressTrajectoriesMemoryData data;
+            loadStressTrajectoriesFromDat_v3(
+                    { reply["fileName"].asString() }, data.loadedPsIndices, data.meshType,
+                    data.trajectoriesPs, data.stressTrajectoriesDataPs,
+                    data.bandPointsUnsmoothedListLeftPs, data.bandPointsUnsmoothedListRightPs,
+                    data.bandPointsSmoothedListLeftPs, data.bandPointsSmoothedListRightPs,
+                    data.simulationMeshOutlineTriangleIndices, data.simulationMeshOutlineVertexPositions);
+            timings.parsingMs += getElapsedMilliseconds(parsingStartTime);
+            timings.numLines = getNumLines(data);
+        } else if (replyData) {
+            // Streamed replies only contain the lines received since the previous partial reply.
+            timings.numLines += getNumLines(*replyData);
+        }
+        if (timings.firstResultMs == 0.0) {
+            timings.firstResultMs = getElapsedMilliseconds(startTime);
+        }
+        if (isFinalReply) {
+            // The decoding of earlier batches overlaps with the transport of later ones and is not subtracted.
+            timings.transportMs = replyTimings.roundTripMs - timings.tracingMs - timings.serializationMs;
+            timings.parsingMs += decodingMs;
+            break;
+        }
+    }
+    timings.totalMs = getElapsedMilliseconds(startTime);
+    return timings;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    std::string outputFilename;
+    size_t maxNumPoints = 1000000;
+    int numRepetitions = 5;
+    StressLineTracingMockServerSettings settings;
+    settings.port = 17386;
+    settings.numPointsPerLine = NUM_POINTS_PER_LINE;
+    settings.tracingTimeMs = 0;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            outputFilename = argv[++i];
+        } else if (std::strcmp(argv[i], "--max-points") == 0 && i + 1 < argc) {
+            maxNumPoints = size_t(std::strtoull(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+            numRepetitions = std::max(std::atoi(argv[++i]), 1);
+        } else if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            settings.port = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--delay") == 0 && i + 1 < argc) {
+            settings.tracingTimeMs = std::max(std::atoi(argv[++i]), 0);
+        } else if (std::strcmp(argv[i], "--batches") == 0 && i + 1 < argc) {
+            settings.numBatches = std::max(std::atoi(argv[++i]), 1);
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                    << " [--output <file.csv>] [--max-points <n>] [--repetitions <n>] [--port <n>] [--delay <ms>]"
+                    << " [--batches <n>]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::ofstream outputFile;
+    if (!outputFilename.empty()) {
+        outputFile.open(outputFilename);
+        if (!outputFile.is_open()) {
+            std::cerr << "Error: Couldn't open the file \"" << outputFilename << "\" for writing." << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& output = outputFilename.empty() ? std::cout : outputFile;
+    output << "num_points,num_lines,path,first_result_ms,request_to_loaded_ms,tracing_ms,serialization_ms,"
+            << "transport_ms,parsing_ms" << std::endl;
+
+    void* context = zmq_ctx_new();
+    {
+        // The lines are requested with the default line density, i.e., settings.numLinesPerSet lines per set.
+        StressLineTracingMockServer mockServer(context, settings);
+        StressLineTracingRequesterSocket requester(context, "127.0.0.1", settings.port);
+
+        for (size_t numPoints = 10000; numPoints <= maxNumPoints; numPoints *= 10) {
+            settings.numLinesPerSet = int(std::max(numPoints / (2 * NUM_POINTS_PER_LINE), size_t(1)));
+            mockServer.setSettings(settings);
+
+            for (int pathIdx = 0; pathIdx < 3; pathIdx++) {
+                // Warm-up request (connection setup, page cache).
+                requestStressLines(requester, pathIdx, 16.0f);
+                RequestTimings sum;
+                for (int repetition = 0; repetition < numRepetitions; repetition++) {
+                    RequestTimings timings = requestStressLines(requester, pathIdx, 16.0f);
+                    sum.firstResultMs += timings.firstResultMs;
+                    sum.totalMs += timings.totalMs;
+                    sum.tracingMs += timings.tracingMs;
+                    sum.serializationMs += timings.serializationMs;
+                    sum.transportMs += timings.transportMs;
+                    sum.parsingMs += timings.parsingMs;
+                    sum.numLines = timings.numLines;
+                }
+                const double n = double(numRepetitions);
+                output << (sum.numLines * NUM_POINTS_PER_LINE) << "," << sum.numLines << "," << PATH_NAMES[pathIdx]
+                        << "," << (sum.firstResultMs / n) << "," << (sum.totalMs / n) << "," << (sum.tracingMs / n)
+                        << "," << (sum.serializationMs / n) << "," << (sum.transportMs / n) << ","
+                        << (sum.parsingMs / n) << std::endl;
+            }
+        }
+
+        requester.join();
+        mockServer.join();
+    }
+    zmq_ctx_term(context);
+    return 0;
+}
@@ -0,0 +1,269 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * Benchmark of the transfer of traced principal stress lines from the line tracer to the visualization.
+ *
+ * A line tracing server is simulated by a ZeroMQ REP socket on the local loopback interface. For synthetic line sets
+ * of increasing size, the time from sending a request until the lines are available in memory is measured for
+ * - the text path: The server writes a .dat version 3 file and replies with its file name, and the client parses the
+ *   file using loadStressTrajectoriesFromDat_v3.
+ * - the binary path: The server replies with a JSON header and binary message parts (sent without copying using
+ *   zmq_msg_init_data), and the client decodes them using decodeStressTrajectoriesBinary.
+ * The results are written as CSV.
+ *
+ * Usage: LineVis_benchmark_transfer [--output <file.csv>] [--max-points <n>] [--repetitions <n>] [--port <n>]
+ */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <limits>
+#include <cstdlib>
+#include <cstring>
+
+#include <zmq.h>
+#include <json/json.h>
+#include <boost/filesystem.hpp>
+
+#include "Loaders/StressTrajectoriesDatLoader.hpp"
+#include "Loaders/StressTrajectoriesBinaryLoader.hpp"
+#include "LineData/Stress/StressLineTracingMockServer.hpp"
+
+namespace {
+
+const size_t NUM_POINTS_PER_LINE = 200;
+
+void freeFrame(void* data, void* hint) {
+    delete static_cast<std::string*>(hint);
+}
+
+/// Sends a message part without copying its data. The ownership of the frame is passed to ZeroMQ.
+void sendFrame(void* socket, std::string* frame, bool hasMore) {
+    zmq_msg_t message;
+    zmq_msg_init_data(&message, &(*frame)[0], frame->size(), freeFrame, frame);
+    if (zmq_msg_send(&message, socket, hasMore ? ZMQ_SNDMORE : 0) < 0) {
+        zmq_msg_close(&message);
+    }
+}
+
+/**
+ * The simulated line tracing server. It answers requests with the passed lines until it receives "KILL". The size of
+ * the last reply in bytes is stored in lastReplySize.
+ */
+void serverLoop(
+        void* context, const std::string& endpoint, const StressTrajectoriesMemoryData* data,
+        const std::string& datFilename, std::atomic<size_t>* lastReplySize) {
+    void* socket = zmq_socket(context, ZMQ_REP);
+    zmq_bind(socket, endpoint.c_str());
+    Json::CharReaderBuilder readerBuilder;
+    std::unique_ptr<Json::CharReader> jsonCharReader(readerBuilder.newCharReader());
+    Json::StreamWriterBuilder writerBuilder;
+
+    while (true) {
+        zmq_msg_t requestMessage;
+        zmq_msg_init(&requestMessage);
+        if (zmq_msg_recv(&requestMessage, socket, 0) < 0) {
+            zmq_msg_close(&requestMessage);
+            break;
+        }
+        std::string requestString(
+                static_cast<const char*>(zmq_msg_data(&requestMessage)), zmq_msg_size(&requestMessage));
+        zmq_msg_close(&requestMessage);
+        if (requestString == "KILL") {
+            zmq_send(socket, "", 0, 0);
+            break;
+        }
+
+        Json::Value request;
+        std::string jsonErrorString;
+        jsonCharReader->parse(
+                requestString.c_str(), requestString.c_str() + requestString.size(), &request, &jsonErrorString);
+
+        if (request.get("binaryReply", false).asBool()) {
+            Json::Value header;
+            std::vector<std::string> frames;
+            encodeStressTrajectoriesBinary(*data, header, frames);
+            std::string* headerString = new std::string(Json::writeString(writerBuilder, header));
+            size_t replySize = headerString->size();
+            for (const std::string& frame : frames) {
+                replySize += frame.size();
+            }
+            *lastReplySize = replySize;
+            sendFrame(socket, headerString, true);
+            for (size_t frameIdx = 0; frameIdx < frames.size(); frameIdx++) {
+                sendFrame(socket, new std::string(std::move(frames.at(frameIdx))), frameIdx + 1 != frames.size());
+            }
+        } else {
+            writeStressTrajectoriesToDat_v3(datFilename, *data);
+            Json::Value reply;
+            reply["fileName"] = datFilename;
+            std::string replyString = Json::writeString(writerBuilder, reply);
+            *lastReplySize = size_t(boost::filesystem::file_size(datFilename));
+            zmq_send(socket, replyString.data(), replyString.size(), 0);
+        }
+    }
+
+    zmq_close(socket);
+}
+
+double getElapsedSeconds(const std::chrono::steady_clock::time_point& start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+/// Requests the lines from the server and loads them into memory. Returns the number of loaded lines.
+size_t requestStressLines(void* socket, bool binaryReply, Json::CharReader* jsonCharReader) {
+    std::string requestString = binaryReply ? "{\"binaryReply\": true}" : "{}";
+    zmq_send(socket, requestString.data(), requestString.size(), 0);
+
+    std::deque<zmq_msg_t> replyParts;
+    while (true) {
+        replyParts.emplace_back();
+        zmq_msg_init(&replyParts.back());
+        if (zmq_msg_recv(&replyParts.back(), socket, 0) < 0 || !zmq_msg_more(&replyParts.back())) {
+            break;
+        }
+    }
+    std::string replyString(
+            static_cast<const char*>(zmq_msg_data(&replyParts.front())), zmq_msg_size(&replyParts.front()));
+    Json::Value reply;
+    std::string jsonErrorString;
+    jsonCharReader->parse(replyString.c_str(), replyString.c_str() + replyString.size(), &reply, &jsonErrorString);
+
+    StressTrajectoriesMemoryData data;
+    if (binaryReply) {
+        std::vector<StressTrajectoriesBinaryFrame> frames;
+        for (auto it = replyParts.begin() + 1; it != replyParts.end(); ++it) {
+            frames.push_back({ zmq_msg_data(&*it), zmq_msg_size(&*it) });
+        }
+        decodeStressTrajectoriesBinary(reply, frames, data);
+    } else {
+        loadStressTrajectoriesFromDat_v3(
+                { reply["fileName"].asString() }, data.loadedPsIndices, data.meshType,
+                data.trajectoriesPs, data.stressTrajectoriesDataPs,
+                data.bandPointsUnsmoothedListLeftPs, data.bandPointsUnsmoothedListRightPs,
+                data.bandPointsSmoothedListLeftPs, data.bandPointsSmoothedListRightPs,
+                data.simulationMeshOutlineTriangleIndices, data.simulationMeshOutlineVertexPositions);
+    }
+    for (zmq_msg_t& replyPart : replyParts) {
+        zmq_msg_close(&replyPart);
+    }
+
+    size_t numLines = 0;
+    for (const Trajectories& trajectories : data.trajectoriesPs) {
+        numLines += trajectories.size();
+    }
+    return numLines;
+}
+
+}
+
+int main(int argc, char *argv[]) {
+    std::string outputFilename;
+    size_t maxNumPoints = 1000000;
+    int numRepetitions = 5;
+    int port = 17385;
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            outputFilename = argv[++i];
+        } else if (std::strcmp(argv[i], "--max-points") == 0 && i + 1 < argc) {
+            maxNumPoints = size_t(std::strtoull(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+            numRepetitions = std::max(std::atoi(argv[++i]), 1);
+        } else if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            port = std::atoi(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                    << " [--output <file.csv>] [--max-points <n>] [--repetitions <n>] [--port <n>]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::ofstream outputFile;
+    if (!outputFilename.empty()) {
+        outputFile.open(outputFilename);
+        if (!outputFile.is_open()) {
+            std::cerr << "Error: Couldn't open the file \"" << outputFilename << "\" for writing." << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& output = outputFilename.empty() ? std::cout : outputFile;
+    output << "num_points,num_lines,path,reply_bytes,avg_round_trip_ms,min_round_trip_ms" << std::endl;
+
+    const std::string endpoint = "tcp://127.0.0.1:" + std::to_string(port);
+    const std::string datFilename =
+            (boost::filesystem::temp_directory_path() / "LineVis_benchmark_transfer.dat").string();
+    void* context = zmq_ctx_new();
+    Json::CharReaderBuilder readerBuilder;
+    std::unique_ptr<Json::CharReader> jsonCharReader(readerBuilder.newCharReader());
+
+    for (size_t numPoints = 10000; numPoints <= maxNumPoints; numPoints *= 10) {
+        const size_t numLinesPerSet = std::max(numPoints / (2 * NUM_POINTS_PER_LINE), size_t(1));
+        StressTrajectoriesMemoryData data;
+        generateSyntheticStressLines({ 0, 2 }, numLinesPerSet, NUM_POINTS_PER_LINE, 1234, data);
+
+        std::atomic<size_t> lastReplySize(0);
+        std::thread serverThread(serverLoop, context, endpoint, &data, datFilename, &lastReplySize);
+        void* socket = zmq_socket(context, ZMQ_REQ);
+        zmq_connect(socket, endpoint.c_str());
+
+        for (int pathIdx = 0; pathIdx < 2; pathIdx++) {
+            const bool binaryReply = pathIdx == 1;
+            // Warm-up request (connection setup, page cache).
+            size_t numLines = requestStressLines(socket, binaryReply, jsonCharReader.get());
+            double totalSeconds = 0.0, minSeconds = std::numeric_limits<double>::max();
+            for (int repetition = 0; repetition < numRepetitions; repetition++) {
+                auto startTime = std::chrono::steady_clock::now();
+                requestStressLines(socket, binaryReply, jsonCharReader.get());
+                double seconds = getElapsedSeconds(startTime);
+                totalSeconds += seconds;
+                minSeconds = std::min(minSeconds, seconds);
+            }
+            output << (numLines * NUM_POINTS_PER_LINE) << "," << numLines << "," << (binaryReply ? "binary" : "dat")
+                    << "," << lastReplySize.load() << "," << (totalSeconds * 1e3 / numRepetitions) << ","
+                    << (minSeconds * 1e3) << std::endl;
+        }
+
+        zmq_send(socket, "KILL", 4, 0);
+        char buffer[1];
+        zmq_recv(socket, buffer, 0, 0);
+        zmq_close(socket);
+        serverThread.join();
+    }
+
+    zmq_ctx_term(context);
+    boost::filesystem::remove(datFilename);
+    return 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LINEVIS_FILTEREDLINESVIEW_HPP
+#define LINEVIS_FILTEREDLINESVIEW_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <glm/glm.hpp>
+
+#include "LinePreprocessingCache.hpp"
+
+/**
+ * Non-owning view of a contiguous array (pointer and number of elements).
+ */
+template<class T>
+class ArrayView {
+public:
+    ArrayView() {}
+    ArrayView(const T* data, size_t numElements) : ptr(data), numElements(numElements) {}
+
+    inline const T* data() const { return ptr; }
+    inline size_t size() const { return numElements; }
+    inline bool empty() const { return numElements == 0; }
+    inline const T* begin() const { return ptr; }
+    inline const T* end() const { return ptr + numElements; }
+    inline const T& operator[](size_t i) const { return ptr[i]; }
+    inline const T& front() const { return ptr[0]; }
+    inline const T& back() const { return ptr[numElements - 1]; }
+
+private:
+    const T* ptr = nullptr;
+    size_t numElements = 0;
+};
+
+/**
+ * A view of the filtered lines (i.e., only containing the lines and points also shown when rendering) that references
+ * the line positions stored in @see LinePreprocessingCache instead of copying them. The view consists of a list with
+ * one entry per line pointing into the cached vertex positions.
+ * The view shares the ownership of the referenced line sets with the cache. When the filter or the line geometry
+ * changes, the cache creates new line sets, and the view keeps showing the old lines until a new view is retrieved
+ * (which renderers do in LineRenderer::setLineData).
+ */
+class FilteredLinesView {
+public:
+    /// Appends all lines of the passed preprocessed line set to the view.
+    void addLineSet(const std::shared_ptr<const LinePreprocessedData>& lineSetPtr) {
+        const LinePreprocessedData& lineSet = *lineSetPtr;
+        lineSets.push_back(lineSetPtr);
+        const size_t numLineSetLines = lineSet.getNumLines();
+        lines.reserve(lines.size() + numLineSetLines);
+        for (size_t lineIdx = 0; lineIdx < numLineSetLines; lineIdx++) {
+            LineEntry entry;
+            entry.positions = lineSet.vertexPositions.data() + lineSet.lineVertexOffsets.at(lineIdx);
+            entry.numPoints = lineSet.lineNumVertices.at(lineIdx);
+            lines.push_back(entry);
+        }
+        numLinePoints += lineSet.getNumVertices();
+    }
+
+    void clear() {
+        lineSets.clear();
+        lines.clear();
+        lines.shrink_to_fit();
+        numLinePoints = 0;
+    }
+
+    inline bool empty() const { return lines.empty(); }
+    inline size_t getNumLines() const { return lines.size(); }
+    inline size_t getNumLinePoints() const { return numLinePoints; }
+
+    /// @return The positions of the points of the line with the passed index.
+    inline ArrayView<glm::vec3> getLinePoints(size_t lineIdx) const {
+        const LineEntry& entry = lines[lineIdx];
+        return ArrayView<glm::vec3>(entry.positions, entry.numPoints);
+    }
+
+private:
+    struct LineEntry {
+        const glm::vec3* positions;
+        uint32_t numPoints;
+    };
+    std::vector<std::shared_ptr<const LinePreprocessedData>> lineSets; ///< Keeps the referenced positions alive.
+    std::vector<LineEntry> lines;
+    size_t numLinePoints = 0;
+};
+
+#endif //LINEVIS_FILTEREDLINESVIEW_HPP
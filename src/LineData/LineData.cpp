@@ -26,10 +26,13 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <utility>
+
 #include <Utils/File/Logfile.hpp>
 #include <Graphics/Shader/ShaderManager.hpp>
 #include <Graphics/Shader/ShaderAttributes.hpp>
 #include <Graphics/Renderer.hpp>
+#include <Graphics/OpenGL/GeometryBuffer.hpp>
 
 #include <ImGui/imgui.h>
 #include <ImGui/imgui_custom.h>
@@ -38,6 +41,7 @@
 #include "Utils/MeshSmoothing.hpp"
 #include "Renderers/LineRenderer.hpp"
 #include "Mesh/MeshBoundarySurface.hpp"
+#include "LineSimplification.hpp"
 #include "LineData.hpp"
 
 LineData::LinePrimitiveMode LineData::linePrimitiveMode = LineData::LINE_PRIMITIVES_RIBBON_PROGRAMMABLE_FETCH;
@@ -49,10 +53,11 @@ const char *const LINE_PRIMITIVE_MODE_DISPLAYNAMES[] = {
 };
 
 LineData::LineData(sgl::TransferFunctionWindow &transferFunctionWindow, DataSetType dataSetType)
-        : dataSetType(dataSetType), transferFunctionWindow(transferFunctionWindow) {
+        : dataSetType(dataSetType), transferFunctionWindow(transferFunctionWindow), isPickingBvhBuilding(false) {
 }
 
 LineData::~LineData() {
+    joinPickingBvhBuilderThread();
 }
 
 bool LineData::setNewSettings(const SettingsMap& settings) {
@@ -73,6 +78,17 @@ bool LineData::setNewSettings(const SettingsMap& settings) {
         }
     }
 
+    if (settings.getValueOpt("use_line_simplification", useLineSimplification)) {
+        dirty = true;
+    }
+    settings.getValueOpt("max_screen_space_error", maxScreenSpaceError);
+    if (settings.getValueOpt("use_frustum_culling", useFrustumCulling)) {
+        dirty = true;
+    }
+    if (settings.getValueOpt("use_meshlet_culling", useMeshletCulling)) {
+        dirty = true;
+    }
+
     return false;
 }
 
@@ -107,6 +123,33 @@ bool LineData::renderGuiRenderer(bool isRasterizer) {
         }
     }
 
+    if (ImGui::Checkbox("Level of Detail", &useLineSimplification)) {
+        dirty = true;
+    }
+    if (useLineSimplification) {
+        if (ImGui::SliderFloat("Max. Screen Error (px)", &maxScreenSpaceError, 0.1f, 8.0f)) {
+            reRender = true;
+        }
+    }
+
+    if (ImGui::Checkbox("Frustum Culling", &useFrustumCulling)) {
+        dirty = true;
+    }
+    if (!lineChunkBvh.getIsEmpty()) {
+        ImGui::Text(
+                "Culling: %.3f ms, %.1f%% culled, %d draw ranges", lineCullingStatistics.cullingTimeMs,
+                lineCullingStatistics.getCulledFraction() * 100.0f, int(lineCullingStatistics.numDrawRanges));
+    }
+    if (ImGui::Checkbox("Meshlet Culling", &useMeshletCulling)) {
+        dirty = true;
+    }
+    if (getUseMeshletDrawing()) {
+        ImGui::Text(
+                "Meshlets: %.3f ms, %.1f%% culled, %d of %d visible", meshletCullingStatistics.cullingTimeMs,
+                meshletCullingStatistics.getCulledFraction() * 100.0f,
+                int(meshletCullingStatistics.numVisibleChunks), int(meshletCullingStatistics.numChunks));
+    }
+
     ImGui::Checkbox("Render Color Legend", &shallRenderColorLegendWidgets);
 
     if (!simulationMeshOutlineTriangleIndices.empty()) {
@@ -207,6 +250,87 @@ void LineData::rebuildInternalRepresentationIfNecessary() {
     }
 }
 
+bool LineData::pickLine(
+        const glm::vec3& rayOrigin, const glm::vec3& rayDirection, float lineRadius, LinePickingResult& result) {
+    if (dirty) {
+        return false;
+    }
+
+    if (isPickingBvhBuilding) {
+        return false;
+    }
+    if (!isPickingBvhValid) {
+        joinPickingBvhBuilderThread();
+        isPickingBvhBuilding = true;
+        isPickingBvhValid = true;
+        // The view keeps the filtered lines alive even if they are recomputed while the worker thread is running.
+        FilteredLinesView filteredLinesView = getFilteredLinesView();
+        pickingBvhBuilderThread = std::thread([this, filteredLinesView]() {
+            std::vector<std::vector<glm::vec3>> lines(filteredLinesView.getNumLines());
+            for (size_t lineIdx = 0; lineIdx < lines.size(); lineIdx++) {
+                ArrayView<glm::vec3> linePoints = filteredLinesView.getLinePoints(lineIdx);
+                lines.at(lineIdx).assign(linePoints.begin(), linePoints.end());
+            }
+            pickingBvh.build(lines);
+            isPickingBvhBuilding = false;
+        });
+        return false;
+    }
+
+    LineSegmentHit hit;
+    auto isLineVisible = [this](uint32_t lineIdx) { return getIsLineVisible(lineIdx); };
+    if (!pickingBvh.intersectRay(
+            rayOrigin, rayDirection, lineRadius, hit, std::numeric_limits<float>::max(), isLineVisible)) {
+        return false;
+    }
+    result = LinePickingResult();
+    result.hitPosition = hit.closestPoint;
+    result.hitDistance = hit.distance;
+    getPickedLineMetadata(hit.lineIdx, hit.segmentIdx, hit.t, result);
+    return true;
+}
+
+void LineData::joinPickingBvhBuilderThread() {
+    if (pickingBvhBuilderThread.joinable()) {
+        pickingBvhBuilderThread.join();
+    }
+}
+
+void LineData::getPickedLineMetadataFromLineSet(
+        const Trajectories& trajectories, const LinePreprocessedData& lineSet,
+        uint32_t lineIdx, uint32_t segmentIdx, float t, LinePickingResult& result) {
+    result.trajectoryIdx = lineSet.lineTrajectoryIndices.at(lineIdx);
+    uint32_t vertexIdx = lineSet.lineVertexOffsets.at(lineIdx) + segmentIdx;
+    uint32_t pointIdx0 = lineSet.vertexPointIndices.at(vertexIdx);
+    uint32_t pointIdx1 = lineSet.vertexPointIndices.at(vertexIdx + 1);
+    result.pointIdx = t < 0.5f ? pointIdx0 : pointIdx1;
+
+    const Trajectory& trajectory = trajectories.at(result.trajectoryIdx);
+    result.attributeValues.clear();
+    result.attributeValues.reserve(trajectory.attributes.size());
+    for (const std::vector<float>& attributeValues : trajectory.attributes) {
+        result.attributeValues.push_back(glm::mix(attributeValues.at(pointIdx0), attributeValues.at(pointIdx1), t));
+    }
+}
+
+void LineData::renderGuiPickedLineTooltip(const LinePickingResult& result) {
+    ImGui::BeginTooltip();
+    if (result.lineSetName.empty()) {
+        ImGui::Text("Line %u, point %u", result.trajectoryIdx, result.pointIdx);
+    } else {
+        ImGui::Text("%s line %u, point %u", result.lineSetName.c_str(), result.trajectoryIdx, result.pointIdx);
+    }
+    ImGui::Text(
+            "Position: (%.4f, %.4f, %.4f)", result.hitPosition.x, result.hitPosition.y, result.hitPosition.z);
+    if (result.lineHierarchyLevel >= 0.0f) {
+        ImGui::Text("Hierarchy level: %.3f", result.lineHierarchyLevel);
+    }
+    for (size_t attrIdx = 0; attrIdx < result.attributeValues.size() && attrIdx < attributeNames.size(); attrIdx++) {
+        ImGui::Text("%s: %g", attributeNames.at(attrIdx).c_str(), result.attributeValues.at(attrIdx));
+    }
+    ImGui::EndTooltip();
+}
+
 sgl::ShaderProgramPtr LineData::reloadGatherShader() {
     sgl::ShaderManager->invalidateShaderCache();
     sgl::ShaderProgramPtr shaderProgramPtr;
@@ -253,12 +377,72 @@ sgl::ShaderProgramPtr LineData::reloadGatherShader() {
     return shaderProgramPtr;
 }
 
+sgl::GeometryBufferPtr LineData::createRenderDataBuffer(
+        size_t size, const void* data, sgl::BufferType bufferType) {
+    if (streamingBufferUploader) {
+        return streamingBufferUploader->createGeometryBuffer(size, data, bufferType);
+    }
+    return sgl::Renderer->createGeometryBuffer(size, const_cast<void*>(data), bufferType);
+}
+
+void LineData::keepPreviousDrawState() {
+    previousDrawState.linePointDataSSBO = linePointDataSSBO;
+    previousDrawState.lineChunkBvh = lineChunkBvh;
+    previousDrawState.lineDrawMode = lineDrawMode;
+    previousDrawState.numDrawIndicesPerLineIndex = numDrawIndicesPerLineIndex;
+    previousDrawState.lineIndexBuffer = lineIndexBuffer;
+    previousDrawState.meshletIndexBuffer = meshletIndexBuffer;
+    previousDrawState.lineMeshlets = lineMeshlets;
+}
+
+void LineData::swapPreviousDrawState() {
+    std::swap(linePointDataSSBO, previousDrawState.linePointDataSSBO);
+    std::swap(lineChunkBvh, previousDrawState.lineChunkBvh);
+    std::swap(lineDrawMode, previousDrawState.lineDrawMode);
+    std::swap(numDrawIndicesPerLineIndex, previousDrawState.numDrawIndicesPerLineIndex);
+    std::swap(lineIndexBuffer, previousDrawState.lineIndexBuffer);
+    std::swap(meshletIndexBuffer, previousDrawState.meshletIndexBuffer);
+    std::swap(lineMeshlets, previousDrawState.lineMeshlets);
+}
+
+void LineData::releasePreviousDrawState() {
+    previousDrawState = DrawState();
+}
+
+void LineData::setTubeRenderDataMeshlets(
+        TubeRenderData& tubeRenderData, std::vector<LineMeshlet>& meshlets, std::vector<uint16_t>& localIndices) {
+    LineMeshletStatistics statistics = computeLineMeshletStatistics(meshlets, MESHLET_MAX_NUM_VERTICES);
+    sgl::Logfile::get()->writeInfo(
+            "Number of meshlets: " + std::to_string(statistics.numMeshlets) + ", average fill rate: "
+            + std::to_string(statistics.averageFillRate * 100.0f) + "%, index memory: "
+            + std::to_string(statistics.meshletBytes) + " bytes (instead of "
+            + std::to_string(statistics.indexBytes32) + " bytes with 32-bit indices).");
+
+    tubeRenderData.meshletIndexBuffer = createRenderDataBuffer(std::move(localIndices), sgl::INDEX_BUFFER);
+    tubeRenderData.meshlets = std::move(meshlets);
+}
+
+void LineData::setGatherShaderMeshlets(TubeRenderData* tubeRenderData) {
+    if (tubeRenderData && tubeRenderData->meshletIndexBuffer) {
+        lineIndexBuffer = tubeRenderData->indexBuffer;
+        meshletIndexBuffer = tubeRenderData->meshletIndexBuffer;
+        lineMeshlets = std::move(tubeRenderData->meshlets);
+    } else {
+        lineIndexBuffer = sgl::GeometryBufferPtr();
+        meshletIndexBuffer = sgl::GeometryBufferPtr();
+        lineMeshlets.clear();
+    }
+}
+
 sgl::ShaderAttributesPtr LineData::getGatherShaderAttributes(sgl::ShaderProgramPtr& gatherShader) {
     sgl::ShaderAttributesPtr shaderAttributes;
 
     if (linePrimitiveMode == LINE_PRIMITIVES_RIBBON_PROGRAMMABLE_FETCH) {
         TubeRenderDataProgrammableFetch tubeRenderData = this->getTubeRenderDataProgrammableFetch();
         linePointDataSSBO = tubeRenderData.linePointsBuffer;
+        lineDrawMode = GL_TRIANGLES;
+        numDrawIndicesPerLineIndex = 3;
+        setGatherShaderMeshlets(nullptr);
 
         shaderAttributes = sgl::ShaderManager->createShaderAttributes(gatherShader);
         shaderAttributes->setVertexMode(sgl::VERTEX_MODE_TRIANGLES);
@@ -266,6 +450,9 @@ sgl::ShaderAttributesPtr LineData::getGatherShaderAttributes(sgl::ShaderProgramP
     } else {
         TubeRenderData tubeRenderData = this->getTubeRenderData();
         linePointDataSSBO = sgl::GeometryBufferPtr();
+        lineDrawMode = GL_LINES;
+        numDrawIndicesPerLineIndex = 1;
+        setGatherShaderMeshlets(&tubeRenderData);
 
         shaderAttributes = sgl::ShaderManager->createShaderAttributes(gatherShader);
 
@@ -314,6 +501,117 @@ sgl::ShaderAttributesPtr LineData::getGatherShaderAttributesHull(sgl::ShaderProg
     return shaderAttributes;
 }
 
+void LineData::drawLines(sgl::ShaderAttributesPtr& shaderAttributes, const sgl::CameraPtr& camera) {
+    if (getUseMeshletDrawing()) {
+        drawLineMeshlets(shaderAttributes, camera);
+        return;
+    }
+    std::vector<LineIndexRange> visibleRanges;
+    if (cullLines(camera, visibleRanges)) {
+        drawLineIndexRanges(shaderAttributes, visibleRanges);
+    } else {
+        sgl::Renderer->render(shaderAttributes);
+    }
+}
+
+void LineData::rebuildLineChunkBvh(
+        std::vector<uint32_t>& lineIndices, const std::vector<glm::vec3>& vertexPositions,
+        const std::vector<float>* vertexSimplificationErrors, const std::vector<float>* vertexRadiusScales) {
+    if (!getUseLineChunkBvh()) {
+        lineChunkBvh.clear();
+        return;
+    }
+    lineChunkBvh.build(lineIndices, vertexPositions, 256, vertexRadiusScales);
+    if (getUseLineLevelsOfDetail() && vertexSimplificationErrors) {
+        lineChunkBvh.buildLevelsOfDetail(
+                lineIndices, *vertexSimplificationErrors, computeLineSimplificationLevelErrors(modelBoundingBox));
+    }
+}
+
+float LineData::getMaxLineRadius() {
+    float lineWidth = LineRenderer::getLineWidth();
+    if (useBands()) {
+        lineWidth = std::max(lineWidth, LineRenderer::getBandWidth());
+    }
+    return 0.5f * lineWidth;
+}
+
+bool LineData::cullLines(
+        const sgl::CameraPtr& camera, std::vector<LineIndexRange>& visibleRanges,
+        const std::vector<LineIndexRange>* indexRanges) {
+    if (lineChunkBvh.getIsEmpty()) {
+        return false;
+    }
+    ViewFrustum frustum;
+    if (useFrustumCulling) {
+        frustum = ViewFrustum(camera->getProjectionMatrix() * camera->getViewMatrix());
+    }
+    LineLevelOfDetailSelection levelOfDetail;
+    if (useLineSimplification) {
+        levelOfDetail.cameraPosition = camera->getPosition();
+        levelOfDetail.errorPerDistance = computeLineSimplificationErrorPerDistance(
+                camera->getFOVy(), viewportHeight, maxScreenSpaceError);
+    }
+    lineChunkBvh.cull(
+            frustum, visibleRanges, &lineCullingStatistics, getMaxLineRadius(),
+            useLineSimplification ? &levelOfDetail : nullptr, indexRanges);
+    return true;
+}
+
+void LineData::drawLineIndexRanges(
+        sgl::ShaderAttributesPtr& shaderAttributes, const std::vector<LineIndexRange>& ranges) {
+    std::vector<GLsizei> indexCounts;
+    std::vector<const void*> indexOffsets;
+    indexCounts.reserve(ranges.size());
+    indexOffsets.reserve(ranges.size());
+    for (const LineIndexRange& range : ranges) {
+        size_t indexOffset = size_t(range.indexOffset) * numDrawIndicesPerLineIndex;
+        indexCounts.push_back(GLsizei(range.numIndices * numDrawIndicesPerLineIndex));
+        indexOffsets.push_back(reinterpret_cast<const void*>(indexOffset * sizeof(uint32_t)));
+    }
+    if (indexCounts.empty()) {
+        return;
+    }
+
+    shaderAttributes->bind();
+    glMultiDrawElements(
+            lineDrawMode, indexCounts.data(), GL_UNSIGNED_INT, indexOffsets.data(), GLsizei(indexCounts.size()));
+    shaderAttributes->unbind();
+}
+
+void LineData::drawLineMeshlets(sgl::ShaderAttributesPtr& shaderAttributes, const sgl::CameraPtr& camera) {
+    ViewFrustum frustum(camera->getProjectionMatrix() * camera->getViewMatrix());
+    std::vector<uint32_t> visibleMeshletIndices;
+    cullLineMeshlets(lineMeshlets, frustum, visibleMeshletIndices, &meshletCullingStatistics, getMaxLineRadius());
+    if (visibleMeshletIndices.empty()) {
+        return;
+    }
+
+    std::vector<GLsizei> indexCounts;
+    std::vector<const void*> indexOffsets;
+    std::vector<GLint> baseVertices;
+    indexCounts.reserve(visibleMeshletIndices.size());
+    indexOffsets.reserve(visibleMeshletIndices.size());
+    baseVertices.reserve(visibleMeshletIndices.size());
+    for (uint32_t meshletIdx : visibleMeshletIndices) {
+        const LineMeshlet& meshlet = lineMeshlets.at(meshletIdx);
+        indexCounts.push_back(GLsizei(meshlet.numIndices));
+        indexOffsets.push_back(reinterpret_cast<const void*>(size_t(meshlet.indexOffset) * sizeof(uint16_t)));
+        baseVertices.push_back(GLint(meshlet.vertexOffset));
+    }
+
+    // The element array buffer binding is part of the vertex array object, so the 32-bit index buffer is restored.
+    GLuint meshletIndexBufferId = static_cast<sgl::GeometryBufferGL*>(meshletIndexBuffer.get())->getBuffer();
+    GLuint lineIndexBufferId = static_cast<sgl::GeometryBufferGL*>(lineIndexBuffer.get())->getBuffer();
+    shaderAttributes->bind();
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, meshletIndexBufferId);
+    glMultiDrawElementsBaseVertex(
+            GL_LINES, indexCounts.data(), GL_UNSIGNED_SHORT, indexOffsets.data(), GLsizei(indexCounts.size()),
+            baseVertices.data());
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, lineIndexBufferId);
+    shaderAttributes->unbind();
+}
+
 SimulationMeshOutlineRenderData LineData::getSimulationMeshOutlineRenderData() {
     SimulationMeshOutlineRenderData renderData;
 
@@ -30,15 +30,23 @@
 #define STRESSLINEVIS_LINEDATA_HPP
 
 #include <memory>
+#include <thread>
+#include <atomic>
 
 #include <Graphics/Buffers/GeometryBuffer.hpp>
 #include <Graphics/Shader/Shader.hpp>
 #include <Graphics/Shader/ShaderAttributes.hpp>
+#include <Graphics/Scene/Camera.hpp>
 #include <ImGui/Widgets/TransferFunctionWindow.hpp>
 #include <ImGui/Widgets/ColorLegendWidget.hpp>
 #include "Utils/InternalState.hpp"
 #include "Loaders/DataSetList.hpp"
 #include "Loaders/TrajectoryFile.hpp"
+#include "Renderers/Helpers/StreamingBufferUploader.hpp"
+#include "SearchStructures/LineChunkBvh.hpp"
+#include "SearchStructures/LineSegmentBvh.hpp"
+#include "LineMeshlets.hpp"
+#include "FilteredLinesView.hpp"
 
 struct Trajectory;
 typedef std::vector<Trajectory> Trajectories;
@@ -57,6 +65,10 @@ struct TubeRenderData {
     sgl::GeometryBufferPtr vertexPrincipalStressIndexBuffer; ///< Empty for flow lines.
     sgl::GeometryBufferPtr vertexLineHierarchyLevelBuffer; ///< Empty for flow lines.
     sgl::GeometryBufferPtr vertexLineAppearanceOrderBuffer; ///< Empty for flow lines.
+
+    // Optional meshlet data (only set if meshlet culling is used).
+    sgl::GeometryBufferPtr meshletIndexBuffer; ///< 16-bit line segment indices relative to their meshlet.
+    std::vector<LineMeshlet> meshlets; ///< CPU copy of the meshlets for culling.
 };
 
 struct BandRenderData {
@@ -119,6 +131,17 @@ const char *const LINE_RASTERIZATION_ALL_TECHNIQUE_NAMES[] = {
 const int NUM_LINE_RASTERIZATION_TECHNIQUES_TOTAL =
         ((int)(sizeof(LINE_RASTERIZATION_ALL_TECHNIQUE_NAMES) / sizeof(*LINE_RASTERIZATION_ALL_TECHNIQUE_NAMES)));
 
+/// Information about the line hit by a ray (@see LineData::pickLine).
+struct LinePickingResult {
+    glm::vec3 hitPosition = glm::vec3(0.0f); ///< Position on the tube surface hit by the ray.
+    float hitDistance = 0.0f; ///< Distance of the hit position to the ray origin.
+    uint32_t trajectoryIdx = 0; ///< Index of the line in its trajectory set.
+    uint32_t pointIdx = 0; ///< Index of the line point closest to the hit position.
+    std::vector<float> attributeValues; ///< The attribute values interpolated at the hit position.
+    std::string lineSetName; ///< Name of the line set the line belongs to (may be empty).
+    float lineHierarchyLevel = -1.0f; ///< Hierarchy level between 0 and 1 or negative if not available.
+};
+
 class LineData {
 public:
     LineData(sgl::TransferFunctionWindow &transferFunctionWindow, DataSetType dataSetType);
@@ -132,6 +155,20 @@ public:
     inline bool isDirty() { return dirty; }
     // Returns if the data needs to be re-rendered, but the visualization mapping is valid.
     virtual bool needsReRender() { bool tmp = reRender; reRender = false; return tmp; }
+    /// Sets the viewport height in pixels used for selecting the level of detail of the lines (@see cullLines).
+    inline void setViewportHeight(int height) { viewportHeight = height; }
+    /// Sets the uploader used for streaming large render data buffers over multiple frames (may be nullptr).
+    inline void setStreamingBufferUploader(StreamingBufferUploader* uploader) { streamingBufferUploader = uploader; }
+    /**
+     * Keeps the state needed for drawing the current render data (e.g., the line chunk hierarchy). The renderer may
+     * keep drawing the current render data while the render data of the next rebuild is still uploaded
+     * (@see LineRenderer::keepPreviousRenderData).
+     */
+    virtual void keepPreviousDrawState();
+    /// Swaps the current draw state with the one kept by @see keepPreviousDrawState.
+    virtual void swapPreviousDrawState();
+    /// Frees the draw state kept by @see keepPreviousDrawState.
+    virtual void releasePreviousDrawState();
     // Do non-static settings that lead to a gather shader reload differ?
     virtual bool settingsDiffer(LineData* other) { return false; }
 
@@ -176,7 +213,23 @@ public:
 
     // Get filtered line data (only containing points also shown when rendering).
     virtual Trajectories filterTrajectoryData()=0;
-    virtual std::vector<std::vector<glm::vec3>> getFilteredLines()=0;
+    /// Zero-copy view of the filtered line positions (the view keeps the positions alive; @see FilteredLinesView).
+    virtual FilteredLinesView getFilteredLinesView()=0;
+
+    /**
+     * Picks the line hit first by the passed ray (e.g., a ray through the mouse cursor). The lines are approximated as
+     * tubes with the passed radius. The hierarchy over the line segments (@see LineSegmentBvh) is built on a worker
+     * thread on first use after the filtered lines changed. No line is picked until the build has finished.
+     * @param rayOrigin The origin of the ray.
+     * @param rayDirection The normalized direction of the ray.
+     * @param lineRadius The radius of the tubes.
+     * @param result Information about the hit line.
+     * @return Whether a line was hit.
+     */
+    bool pickLine(
+            const glm::vec3& rayOrigin, const glm::vec3& rayDirection, float lineRadius, LinePickingResult& result);
+    /// Renders information about the passed picked line as a tooltip at the mouse cursor.
+    void renderGuiPickedLineTooltip(const LinePickingResult& result);
 
     // --- Retrieve data for rendering. Preferred way. ---
     virtual sgl::ShaderProgramPtr reloadGatherShader();
@@ -191,6 +244,13 @@ public:
     virtual TubeRenderDataOpacityOptimization getTubeRenderDataOpacityOptimization()=0;
     virtual BandRenderData getBandRenderData() { return BandRenderData(); }
     virtual BandRenderData getTubeBandRenderData() { return BandRenderData(); }
+    /**
+     * Draws the shader attributes returned by @see getGatherShaderAttributes. If frustum culling is used, only the line
+     * segment chunks intersecting the view frustum of the passed camera are drawn. If meshlet culling is used, only the
+     * meshlets intersecting the view frustum are drawn using their 16-bit local indices. Subclasses may further
+     * restrict the drawn index ranges.
+     */
+    virtual void drawLines(sgl::ShaderAttributesPtr& shaderAttributes, const sgl::CameraPtr& camera);
 
     // Retrieve simulation mesh outline (optional).
     inline bool hasSimulationMeshOutline() { return !simulationMeshOutlineVertexPositions.empty(); }
@@ -252,6 +312,94 @@ protected:
     void rebuildInternalRepresentationIfNecessary();
     virtual void recomputeColorLegend();
 
+    /**
+     * Fills the information about a picked line not stored in the segment hierarchy (@see pickLine).
+     * @param lineIdx The index of the line in the filtered lines view (@see getFilteredLinesView).
+     * @param segmentIdx The index of the hit segment in the line.
+     * @param t The position of the hit along the segment in [0, 1].
+     * @param result The picking result to fill.
+     */
+    virtual void getPickedLineMetadata(uint32_t lineIdx, uint32_t segmentIdx, float t, LinePickingResult& result)=0;
+    /**
+     * Lines that are not visible (e.g., hidden by a line hierarchy slider) are skipped when intersecting the picking
+     * hierarchy, so that they can neither be picked nor occlude visible lines. The hierarchy itself contains all
+     * filtered lines and thus does not need to be rebuilt when the visibility changes.
+     * @param lineIdx The index of the line in the filtered lines view (@see getFilteredLinesView).
+     */
+    virtual bool getIsLineVisible(uint32_t lineIdx) { return true; }
+    /// Implementation of @see getPickedLineMetadata for one line set.
+    static void getPickedLineMetadataFromLineSet(
+            const Trajectories& trajectories, const LinePreprocessedData& lineSet,
+            uint32_t lineIdx, uint32_t segmentIdx, float t, LinePickingResult& result);
+
+    /**
+     * Creates a buffer for the render data. If a streaming uploader is set, large buffers are filled over the next
+     * frames. The passed data is moved into the uploader in this case.
+     */
+    template<typename T>
+    sgl::GeometryBufferPtr createRenderDataBuffer(std::vector<T>&& data, sgl::BufferType bufferType) {
+        if (streamingBufferUploader) {
+            return streamingBufferUploader->createGeometryBuffer(std::move(data), bufferType);
+        }
+        return createRenderDataBuffer(data.size() * sizeof(T), data.data(), bufferType);
+    }
+    sgl::GeometryBufferPtr createRenderDataBuffer(size_t size, const void* data, sgl::BufferType bufferType);
+
+    /**
+     * Adds the passed meshlets to the tube render data and logs statistics about them.
+     * The passed arrays are moved into the render data.
+     */
+    void setTubeRenderDataMeshlets(
+            TubeRenderData& tubeRenderData, std::vector<LineMeshlet>& meshlets, std::vector<uint16_t>& localIndices);
+
+    /// Whether the line segment index lists get simplified levels of detail (@see rebuildLineChunkBvh).
+    inline bool getUseLineLevelsOfDetail() const {
+        return useLineSimplification && renderingMode != RENDERING_MODE_OPACITY_OPTIMIZATION;
+    }
+    /// Whether the line segment index lists are drawn using the line chunk hierarchy (@see cullLines).
+    inline bool getUseLineChunkBvh() const { return useFrustumCulling || getUseLineLevelsOfDetail(); }
+    /**
+     * Rebuilds the line chunk hierarchy for the passed line segment index list (if frustum culling or the level of
+     * detail is used). With the level of detail, the simplified index lists are appended to the passed index list
+     * (@see LineChunkBvh::buildLevelsOfDetail), so it needs to be drawn using @see drawLines.
+     * @param vertexSimplificationErrors The simplification errors of the vertices (only needed with the level of
+     * detail; @see LinePreprocessingCache::getVertexSimplificationErrors).
+     * @param vertexRadiusScales Optional factors the line radius is scaled with at the vertices (e.g., the length of
+     * the band offsets; @see LineChunkBvh::build).
+     */
+    void rebuildLineChunkBvh(
+            std::vector<uint32_t>& lineIndices, const std::vector<glm::vec3>& vertexPositions,
+            const std::vector<float>* vertexSimplificationErrors,
+            const std::vector<float>* vertexRadiusScales = nullptr);
+    /// The largest world space radius of the rendered tubes or bands (i.e., how far they extend from the line center).
+    float getMaxLineRadius();
+    /**
+     * Computes the index ranges of all line segment chunks intersecting the view frustum of the passed camera. The
+     * chunks are grown by the current line radius (@see getMaxLineRadius), so changing the line width takes effect
+     * with the next frame. With the level of detail, the simplified range of every chunk is selected by its distance
+     * to the camera.
+     * @param indexRanges If not nullptr, only these sorted ranges of the full resolution index list are drawn.
+     * @return false if the line chunk hierarchy is not used (@see getUseLineChunkBvh).
+     */
+    bool cullLines(
+            const sgl::CameraPtr& camera, std::vector<LineIndexRange>& visibleRanges,
+            const std::vector<LineIndexRange>* indexRanges = nullptr);
+    /// Draws the passed ranges of the line segment index list (@see lineDrawMode).
+    void drawLineIndexRanges(sgl::ShaderAttributesPtr& shaderAttributes, const std::vector<LineIndexRange>& ranges);
+
+    /**
+     * Sets the meshlets used for drawing the gather shader attributes. Needs to be called by all implementations of
+     * @see getGatherShaderAttributes; the meshlets are only used if the render data has them.
+     * @param tubeRenderData The tube render data of the gather shader attributes or nullptr for other render data.
+     */
+    void setGatherShaderMeshlets(TubeRenderData* tubeRenderData);
+    /// Whether the gather shader attributes are drawn meshlet by meshlet (@see drawLineMeshlets).
+    inline bool getUseMeshletDrawing() const {
+        return useMeshletCulling && lineDrawMode == GL_LINES && meshletIndexBuffer && !lineMeshlets.empty();
+    }
+    /// Draws the meshlets intersecting the view frustum of the passed camera (always at full resolution).
+    void drawLineMeshlets(sgl::ShaderAttributesPtr& shaderAttributes, const sgl::CameraPtr& camera);
+
     DataSetType dataSetType;
     sgl::AABB3 modelBoundingBox;
     std::vector<std::string> fileNames;
@@ -260,6 +408,7 @@ protected:
     int selectedAttributeIndex = 0; ///< Selected attribute/importance criterion index.
     int selectedAttributeIndexUi = 0;
     bool dirty = false; ///< Should be set to true if the representation changed.
+    uint64_t lineDataGeneration = 0; ///< Incremented whenever new line geometry is set (e.g., for keying caches).
     bool reRender = false;
     sgl::TransferFunctionWindow& transferFunctionWindow;
 
@@ -278,6 +427,46 @@ protected:
 
     /// Stores line point data if linePrimitiveMode == LINE_PRIMITIVES_RIBBON_PROGRAMMABLE_FETCH.
     sgl::GeometryBufferPtr linePointDataSSBO;
+    StreamingBufferUploader* streamingBufferUploader = nullptr;
+    static const uint32_t MESHLET_MAX_NUM_VERTICES = 64;
+
+    // Line picking (@see pickLine).
+    void joinPickingBvhBuilderThread();
+    LineSegmentBvh pickingBvh; ///< Only accessed by the builder thread while isPickingBvhBuilding is set.
+    std::thread pickingBvhBuilderThread;
+    std::atomic<bool> isPickingBvhBuilding;
+    bool isPickingBvhValid = false; ///< Needs to be reset when the filtered lines change.
+
+    // Frustum culling (@see LineChunkBvh).
+    bool useFrustumCulling = false;
+    LineChunkBvh lineChunkBvh;
+    LineCullingStatistics lineCullingStatistics;
+    GLenum lineDrawMode = GL_LINES; ///< Primitive type of the index buffer of the gather shader attributes.
+    uint32_t numDrawIndicesPerLineIndex = 1; ///< 3 for the triangle topology of programmable fetching.
+
+    // Meshlet culling (@see LineMeshlet).
+    bool useMeshletCulling = false;
+    sgl::GeometryBufferPtr lineIndexBuffer; ///< 32-bit index buffer of the gather shader attributes.
+    sgl::GeometryBufferPtr meshletIndexBuffer;
+    std::vector<LineMeshlet> lineMeshlets;
+    LineCullingStatistics meshletCullingStatistics;
+
+    /// The draw state kept by @see keepPreviousDrawState.
+    struct DrawState {
+        sgl::GeometryBufferPtr linePointDataSSBO;
+        LineChunkBvh lineChunkBvh;
+        GLenum lineDrawMode = GL_LINES;
+        uint32_t numDrawIndicesPerLineIndex = 1;
+        sgl::GeometryBufferPtr lineIndexBuffer;
+        sgl::GeometryBufferPtr meshletIndexBuffer;
+        std::vector<LineMeshlet> lineMeshlets;
+    };
+    DrawState previousDrawState;
+
+    // Level of detail (@see LineSimplification.hpp and LineChunkBvh::buildLevelsOfDetail).
+    bool useLineSimplification = false;
+    float maxScreenSpaceError = 1.0f; ///< In pixels.
+    int viewportHeight = 0;
 
     // Optional.
     bool shallRenderSimulationMeshBoundary = false;
@@ -29,7 +29,6 @@
 #include <Graphics/Renderer.hpp>
 
 #include "Loaders/TrajectoryFile.hpp"
-#include "Renderers/Tubes/Tubes.hpp"
 
 #include <Utils/File/Logfile.hpp>
 
@@ -72,6 +71,9 @@ bool LineDataFlow::loadFromFile(
 
 void LineDataFlow::setTrajectoryData(const Trajectories& trajectories) {
     this->trajectories = trajectories;
+    linePreprocessingCache.invalidate();
+    lineDataGeneration++;
+    isPickingBvhValid = false;
 
     sgl::Logfile::get()->writeInfo(
             std::string() + "Number of lines: " + std::to_string(getNumLines()));
@@ -170,6 +172,7 @@ void LineDataFlow::filterTrajectories(std::function<bool(const Trajectory&)> cal
 }
 
 void LineDataFlow::resetTrajectoryFilter()  {
+    isPickingBvhValid = false;
     if (filteredTrajectories.empty()) {
         filteredTrajectories.resize(trajectories.size(), false);
     } else {
@@ -226,47 +229,23 @@ Trajectories LineDataFlow::filterTrajectoryData() {
     return trajectoriesFiltered;
 }
 
-std::vector<std::vector<glm::vec3>> LineDataFlow::getFilteredLines() {
-    std::vector<std::vector<glm::vec3>> linesFiltered;
-    linesFiltered.reserve(trajectories.size());
-    size_t trajectoryIndex = 0;
-    for (const Trajectory& trajectory : trajectories) {
-        if (!filteredTrajectories.empty() && filteredTrajectories.at(trajectoryIndex)) {
-            trajectoryIndex++;
-            continue;
-        }
-
-        std::vector<glm::vec3> lineFiltered;
-        size_t n = trajectory.positions.size();
-
-        int numValidLinePoints = 0;
-        for (size_t i = 0; i < n; i++) {
-            glm::vec3 tangent, normal;
-            if (i == 0) {
-                tangent = trajectory.positions[i+1] - trajectory.positions[i];
-            } else if (i == n - 1) {
-                tangent = trajectory.positions[i] - trajectory.positions[i-1];
-            } else {
-                tangent = (trajectory.positions[i+1] - trajectory.positions[i-1]);
-            }
-            float lineSegmentLength = glm::length(tangent);
-
-            if (lineSegmentLength < 0.0001f) {
-                // In case the two vertices are almost identical, just skip this path line segment
-                continue;
-            }
-
-            lineFiltered.push_back(trajectory.positions.at(i));
-            numValidLinePoints++;
-        }
-
-        if (numValidLinePoints > 1) {
-            linesFiltered.push_back(lineFiltered);
-        }
+FilteredLinesView LineDataFlow::getFilteredLinesView() {
+    rebuildInternalRepresentationIfNecessary();
+    FilteredLinesView filteredLinesView;
+    filteredLinesView.addLineSet(linePreprocessingCache.getShared(trajectories, filteredTrajectories));
+    return filteredLinesView;
+}
 
-        trajectoryIndex++;
+const std::vector<float>* LineDataFlow::getVertexSimplificationErrors() {
+    if (!getUseLineLevelsOfDetail()) {
+        return nullptr;
     }
-    return linesFiltered;
+    return &linePreprocessingCache.getVertexSimplificationErrors(trajectories);
+}
+
+void LineDataFlow::getPickedLineMetadata(uint32_t lineIdx, uint32_t segmentIdx, float t, LinePickingResult& result) {
+    const LinePreprocessedData& lineSet = linePreprocessingCache.get(trajectories, filteredTrajectories);
+    getPickedLineMetadataFromLineSet(trajectories, lineSet, lineIdx, segmentIdx, t, result);
 }
 
 
@@ -275,57 +254,38 @@ std::vector<std::vector<glm::vec3>> LineDataFlow::getFilteredLines() {
 TubeRenderData LineDataFlow::getTubeRenderData() {
     rebuildInternalRepresentationIfNecessary();
 
-    std::vector<std::vector<glm::vec3>> lineCentersList;
-    std::vector<std::vector<float>> lineAttributesList;
-    std::vector<uint32_t> lineIndices;
-    std::vector<glm::vec3> vertexPositions;
-    std::vector<glm::vec3> vertexNormals;
-    std::vector<glm::vec3> vertexTangents;
+    const LinePreprocessedData& lineData = linePreprocessingCache.get(trajectories, filteredTrajectories);
     std::vector<float> vertexAttributes;
-
-    lineCentersList.resize(trajectories.size());
-    lineAttributesList.resize(trajectories.size());
-    for (size_t trajectoryIdx = 0; trajectoryIdx < trajectories.size(); trajectoryIdx++) {
-        if (!filteredTrajectories.empty() && filteredTrajectories.at(trajectoryIdx)) {
-            continue;
-        }
-
-        Trajectory& trajectory = trajectories.at(trajectoryIdx);
-        std::vector<float>& attributes = trajectory.attributes.at(selectedAttributeIndex);
-        assert(attributes.size() == trajectory.positions.size());
-        std::vector<glm::vec3>& lineCenters = lineCentersList.at(trajectoryIdx);
-        std::vector<float>& lineAttributes = lineAttributesList.at(trajectoryIdx);
-        for (size_t i = 0; i < trajectory.positions.size(); i++) {
-            lineCenters.push_back(trajectory.positions.at(i));
-            lineAttributes.push_back(attributes.at(i));
-        }
-    }
-
-    createLineTubesRenderDataCPU(
-            lineCentersList, lineAttributesList,
-            lineIndices, vertexPositions, vertexNormals, vertexTangents, vertexAttributes);
+    lineData.appendVertexAttributes(trajectories, selectedAttributeIndex, vertexAttributes);
 
     TubeRenderData tubeRenderData;
+    std::vector<uint32_t> lineIndices = lineData.lineIndices;
+    rebuildLineChunkBvh(lineIndices, lineData.vertexPositions, getVertexSimplificationErrors());
 
     // Add the index buffer.
-    tubeRenderData.indexBuffer = sgl::Renderer->createGeometryBuffer(
-            sizeof(uint32_t)*lineIndices.size(), lineIndices.data(), sgl::INDEX_BUFFER);
+    tubeRenderData.indexBuffer = createRenderDataBuffer(std::move(lineIndices), sgl::INDEX_BUFFER);
 
     // Add the position buffer.
-    tubeRenderData.vertexPositionBuffer = sgl::Renderer->createGeometryBuffer(
-            vertexPositions.size()*sizeof(glm::vec3), vertexPositions.data(), sgl::VERTEX_BUFFER);
+    tubeRenderData.vertexPositionBuffer = createRenderDataBuffer(
+            lineData.vertexPositions.size()*sizeof(glm::vec3), lineData.vertexPositions.data(), sgl::VERTEX_BUFFER);
 
     // Add the attribute buffer.
-    tubeRenderData.vertexAttributeBuffer = sgl::Renderer->createGeometryBuffer(
-            vertexAttributes.size()*sizeof(float), vertexAttributes.data(), sgl::VERTEX_BUFFER);
+    tubeRenderData.vertexAttributeBuffer = createRenderDataBuffer(std::move(vertexAttributes), sgl::VERTEX_BUFFER);
 
     // Add the normal buffer.
-    tubeRenderData.vertexNormalBuffer = sgl::Renderer->createGeometryBuffer(
-            vertexNormals.size()*sizeof(glm::vec3), vertexNormals.data(), sgl::VERTEX_BUFFER);
+    tubeRenderData.vertexNormalBuffer = createRenderDataBuffer(
+            lineData.vertexNormals.size()*sizeof(glm::vec3), lineData.vertexNormals.data(), sgl::VERTEX_BUFFER);
 
     // Add the tangent buffer.
-    tubeRenderData.vertexTangentBuffer = sgl::Renderer->createGeometryBuffer(
-            vertexTangents.size()*sizeof(glm::vec3), vertexTangents.data(), sgl::VERTEX_BUFFER);
+    tubeRenderData.vertexTangentBuffer = createRenderDataBuffer(
+            lineData.vertexTangents.size()*sizeof(glm::vec3), lineData.vertexTangents.data(), sgl::VERTEX_BUFFER);
+
+    if (useMeshletCulling) {
+        const LineMeshletData& meshletData = linePreprocessingCache.getMeshletData(MESHLET_MAX_NUM_VERTICES);
+        std::vector<LineMeshlet> meshlets = meshletData.meshlets;
+        std::vector<uint16_t> localIndices = meshletData.localIndices;
+        setTubeRenderDataMeshlets(tubeRenderData, meshlets, localIndices);
+    }
 
     return tubeRenderData;
 }
@@ -334,36 +294,12 @@ TubeRenderDataProgrammableFetch LineDataFlow::getTubeRenderDataProgrammableFetch
     rebuildInternalRepresentationIfNecessary();
     TubeRenderDataProgrammableFetch tubeRenderData;
 
-    // 1. Compute all tangents.
-    std::vector<std::vector<glm::vec3>> lineCentersList;
-    std::vector<std::vector<float>> lineAttributesList;
-    std::vector<uint32_t> lineIndices;
-    std::vector<glm::vec3> vertexPositions;
-    std::vector<glm::vec3> vertexNormals;
-    std::vector<glm::vec3> vertexTangents;
+    // 1. Get the (cached) line centers and tangents.
+    const LinePreprocessedData& lineData = linePreprocessingCache.get(trajectories, filteredTrajectories);
+    std::vector<uint32_t> lineIndices = lineData.lineIndices;
     std::vector<float> vertexAttributes;
-
-    lineCentersList.resize(trajectories.size());
-    lineAttributesList.resize(trajectories.size());
-    for (size_t trajectoryIdx = 0; trajectoryIdx < trajectories.size(); trajectoryIdx++) {
-        if (!filteredTrajectories.empty() && filteredTrajectories.at(trajectoryIdx)) {
-            continue;
-        }
-
-        Trajectory& trajectory = trajectories.at(trajectoryIdx);
-        std::vector<float>& attributes = trajectory.attributes.at(selectedAttributeIndex);
-        assert(attributes.size() == trajectory.positions.size());
-        std::vector<glm::vec3>& lineCenters = lineCentersList.at(trajectoryIdx);
-        std::vector<float>& lineAttributes = lineAttributesList.at(trajectoryIdx);
-        for (size_t i = 0; i < trajectory.positions.size(); i++) {
-            lineCenters.push_back(trajectory.positions.at(i));
-            lineAttributes.push_back(attributes.at(i));
-        }
-    }
-
-    createLineTubesRenderDataCPU(
-            lineCentersList, lineAttributesList,
-            lineIndices, vertexPositions, vertexNormals, vertexTangents, vertexAttributes);
+    lineData.appendVertexAttributes(trajectories, selectedAttributeIndex, vertexAttributes);
+    rebuildLineChunkBvh(lineIndices, lineData.vertexPositions, getVertexSimplificationErrors());
 
     // 2. Construct the triangle topology for programmable fetching.
     std::vector<uint32_t> fetchIndices;
@@ -380,22 +316,19 @@ TubeRenderDataProgrammableFetch LineDataFlow::getTubeRenderDataProgrammableFetch
         fetchIndices.push_back(base1+1);
         fetchIndices.push_back(base0+1);
     }
-    tubeRenderData.indexBuffer = sgl::Renderer->createGeometryBuffer(
-            sizeof(uint32_t) * fetchIndices.size(), fetchIndices.data(), sgl::INDEX_BUFFER);
+    tubeRenderData.indexBuffer = createRenderDataBuffer(std::move(fetchIndices), sgl::INDEX_BUFFER);
 
     // 3. Add the point data for all line points.
     std::vector<LinePointDataProgrammableFetch> linePointData;
-    linePointData.resize(vertexPositions.size());
-    for (size_t i = 0; i < vertexPositions.size(); i++) {
-        linePointData.at(i).vertexPosition = vertexPositions.at(i);
+    linePointData.resize(lineData.vertexPositions.size());
+    for (size_t i = 0; i < lineData.vertexPositions.size(); i++) {
+        linePointData.at(i).vertexPosition = lineData.vertexPositions.at(i);
         linePointData.at(i).vertexAttribute = vertexAttributes.at(i);
-        linePointData.at(i).vertexTangent = vertexTangents.at(i);
+        linePointData.at(i).vertexTangent = lineData.vertexTangents.at(i);
         linePointData.at(i).principalStressIndex = 0;
     }
 
-    tubeRenderData.linePointsBuffer = sgl::Renderer->createGeometryBuffer(
-            linePointData.size() * sizeof(LinePointDataProgrammableFetch), linePointData.data(),
-            sgl::SHADER_STORAGE_BUFFER);
+    tubeRenderData.linePointsBuffer = createRenderDataBuffer(std::move(linePointData), sgl::SHADER_STORAGE_BUFFER);
 
     return tubeRenderData;
 }
@@ -403,53 +336,26 @@ TubeRenderDataProgrammableFetch LineDataFlow::getTubeRenderDataProgrammableFetch
 TubeRenderDataOpacityOptimization LineDataFlow::getTubeRenderDataOpacityOptimization() {
     rebuildInternalRepresentationIfNecessary();
 
-    std::vector<std::vector<glm::vec3>> lineCentersList;
-    std::vector<std::vector<float>> lineAttributesList;
-    std::vector<uint32_t> lineIndices;
-    std::vector<glm::vec3> vertexPositions;
-    std::vector<glm::vec3> vertexNormals;
-    std::vector<glm::vec3> vertexTangents;
+    const LinePreprocessedData& lineData = linePreprocessingCache.get(trajectories, filteredTrajectories);
     std::vector<float> vertexAttributes;
-
-    lineCentersList.resize(trajectories.size());
-    lineAttributesList.resize(trajectories.size());
-    for (size_t trajectoryIdx = 0; trajectoryIdx < trajectories.size(); trajectoryIdx++) {
-        if (!filteredTrajectories.empty() && filteredTrajectories.at(trajectoryIdx)) {
-            continue;
-        }
-
-        Trajectory& trajectory = trajectories.at(trajectoryIdx);
-        std::vector<float>& attributes = trajectory.attributes.at(selectedAttributeIndex);
-        assert(attributes.size() == trajectory.positions.size());
-        std::vector<glm::vec3>& lineCenters = lineCentersList.at(trajectoryIdx);
-        std::vector<float>& lineAttributes = lineAttributesList.at(trajectoryIdx);
-        for (size_t i = 0; i < trajectory.positions.size(); i++) {
-            lineCenters.push_back(trajectory.positions.at(i));
-            lineAttributes.push_back(attributes.at(i));
-        }
-    }
-
-    createLineTubesRenderDataCPU(
-            lineCentersList, lineAttributesList,
-            lineIndices, vertexPositions, vertexNormals, vertexTangents, vertexAttributes);
+    lineData.appendVertexAttributes(trajectories, selectedAttributeIndex, vertexAttributes);
 
     TubeRenderDataOpacityOptimization tubeRenderData;
 
     // Add the index buffer.
-    tubeRenderData.indexBuffer = sgl::Renderer->createGeometryBuffer(
-            sizeof(uint32_t)*lineIndices.size(), lineIndices.data(), sgl::INDEX_BUFFER);
+    tubeRenderData.indexBuffer = createRenderDataBuffer(
+            lineData.lineIndices.size()*sizeof(uint32_t), lineData.lineIndices.data(), sgl::INDEX_BUFFER);
 
     // Add the position buffer.
-    tubeRenderData.vertexPositionBuffer = sgl::Renderer->createGeometryBuffer(
-            vertexPositions.size()*sizeof(glm::vec3), vertexPositions.data(), sgl::VERTEX_BUFFER);
+    tubeRenderData.vertexPositionBuffer = createRenderDataBuffer(
+            lineData.vertexPositions.size()*sizeof(glm::vec3), lineData.vertexPositions.data(), sgl::VERTEX_BUFFER);
 
     // Add the attribute buffer.
-    tubeRenderData.vertexAttributeBuffer = sgl::Renderer->createGeometryBuffer(
-            vertexAttributes.size()*sizeof(float), vertexAttributes.data(), sgl::VERTEX_BUFFER);
+    tubeRenderData.vertexAttributeBuffer = createRenderDataBuffer(std::move(vertexAttributes), sgl::VERTEX_BUFFER);
 
     // Add the tangent buffer.
-    tubeRenderData.vertexTangentBuffer = sgl::Renderer->createGeometryBuffer(
-            vertexTangents.size()*sizeof(glm::vec3), vertexTangents.data(), sgl::VERTEX_BUFFER);
+    tubeRenderData.vertexTangentBuffer = createRenderDataBuffer(
+            lineData.vertexTangents.size()*sizeof(glm::vec3), lineData.vertexTangents.data(), sgl::VERTEX_BUFFER);
 
     return tubeRenderData;
 }
@@ -30,6 +30,7 @@
 #define STRESSLINEVIS_LINEDATAFLOW_HPP
 
 #include "LineData.hpp"
+#include "LinePreprocessingCache.hpp"
 
 class LineDataFlow : public LineData {
 public:
@@ -62,7 +63,7 @@ public:
 
     // Get filtered line data (only containing points also shown when rendering).
     virtual Trajectories filterTrajectoryData() override;
-    virtual std::vector<std::vector<glm::vec3>> getFilteredLines() override;
+    virtual FilteredLinesView getFilteredLinesView() override;
 
     // --- Retrieve data for rendering. ---
     TubeRenderData getTubeRenderData();
@@ -71,9 +72,14 @@ public:
 
 protected:
     virtual void recomputeHistogram() override;
+    virtual void getPickedLineMetadata(
+            uint32_t lineIdx, uint32_t segmentIdx, float t, LinePickingResult& result) override;
+    /// The per-vertex simplification errors of the filtered lines, or nullptr if the level of detail is not used.
+    const std::vector<float>* getVertexSimplificationErrors();
 
     Trajectories trajectories;
     std::vector<bool> filteredTrajectories;
+    LinePreprocessingCache linePreprocessingCache; ///< Filtered line geometry shared by all render data builders.
 };
 
 #endif //STRESSLINEVIS_LINEDATAFLOW_HPP
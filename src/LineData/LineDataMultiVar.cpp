@@ -26,6 +26,8 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <utility>
+
 #include <Graphics/Renderer.hpp>
 #include <Graphics/Shader/ShaderManager.hpp>
 
@@ -126,16 +128,21 @@ LineDataMultiVar::~LineDataMultiVar() {
 
 void LineDataMultiVar::recomputeHistogram() {
     const size_t numAttributes = attributeNames.size();
-    std::vector<std::vector<float>> attributesList(numAttributes);
-    for (const Trajectory& trajectory : trajectories) {
+    if (attributeHistograms.size() != numAttributes) {
+        attributeHistograms.clear();
+        attributeHistograms.resize(numAttributes);
+        std::vector<float> attributeList;
+        attributeList.reserve(getNumLinePoints());
         for (size_t attrIdx = 0; attrIdx < numAttributes; attrIdx++) {
-            std::vector<float>& attributeList = attributesList.at(attrIdx);
-            for (float val : trajectory.attributes.at(attrIdx)) {
-                attributeList.push_back(val);
+            attributeList.clear();
+            for (const Trajectory& trajectory : trajectories) {
+                const std::vector<float>& values = trajectory.attributes.at(attrIdx);
+                attributeList.insert(attributeList.end(), values.begin(), values.end());
             }
+            attributeHistograms.at(attrIdx).build(attributeList);
         }
     }
-    multiVarTransferFunctionWindow.setAttributesValues(attributeNames, attributesList);
+    multiVarTransferFunctionWindow.setAttributeHistograms(attributeNames, attributeHistograms);
     //multiVarWindow.setAttributes(attributesList, attributeNames);
 
     LineDataFlow::recomputeHistogram();
@@ -195,12 +202,9 @@ sgl::ShaderAttributesPtr LineDataMultiVar::getGatherShaderAttributes(sgl::Shader
     }
 
     TubeRenderDataMultiVar tubeRenderData = this->getTubeRenderDataMultiVar();
-    variableArrayBuffer = sgl::GeometryBufferPtr();
-    lineDescArrayBuffer = sgl::GeometryBufferPtr();
-    varDescArrayBuffer = sgl::GeometryBufferPtr();
-    lineVarDescArrayBuffer = sgl::GeometryBufferPtr();
-    varSelectedArrayBuffer = sgl::GeometryBufferPtr();
-    //varColorArrayBuffer = sgl::GeometryBufferPtr();
+    lineDrawMode = GL_LINES;
+    numDrawIndicesPerLineIndex = 1;
+    setGatherShaderMeshlets(nullptr);
 
     sgl::ShaderAttributesPtr shaderAttributes = sgl::ShaderManager->createShaderAttributes(gatherShader);
 
@@ -226,7 +230,9 @@ sgl::ShaderAttributesPtr LineDataMultiVar::getGatherShaderAttributes(sgl::Shader
     lineDescArrayBuffer = tubeRenderData.lineDescArrayBuffer;
     varDescArrayBuffer = tubeRenderData.varDescArrayBuffer;
     lineVarDescArrayBuffer = tubeRenderData.lineVarDescArrayBuffer;
-    varSelectedArrayBuffer = tubeRenderData.varSelectedArrayBuffer;
+    if (!varSelectedArrayBuffer) {
+        updateVarSelectedArrayBuffer();
+    }
     //varColorArrayBuffer = tubeRenderData.varColorArrayBuffer;
 
     return shaderAttributes;
@@ -251,6 +257,29 @@ void LineDataMultiVar::setUniformGatherShaderData_AllPasses() {
     sgl::ShaderManager->bindShaderStorageBuffer(9, multiVarTransferFunctionWindow.getMinMaxSsbo());
 }
 
+void LineDataMultiVar::keepPreviousDrawState() {
+    LineData::keepPreviousDrawState();
+    previousLineSsbos[0] = variableArrayBuffer;
+    previousLineSsbos[1] = lineDescArrayBuffer;
+    previousLineSsbos[2] = varDescArrayBuffer;
+    previousLineSsbos[3] = lineVarDescArrayBuffer;
+}
+
+void LineDataMultiVar::swapPreviousDrawState() {
+    LineData::swapPreviousDrawState();
+    std::swap(variableArrayBuffer, previousLineSsbos[0]);
+    std::swap(lineDescArrayBuffer, previousLineSsbos[1]);
+    std::swap(varDescArrayBuffer, previousLineSsbos[2]);
+    std::swap(lineVarDescArrayBuffer, previousLineSsbos[3]);
+}
+
+void LineDataMultiVar::releasePreviousDrawState() {
+    LineData::releasePreviousDrawState();
+    for (sgl::GeometryBufferPtr& previousLineSsbo : previousLineSsbos) {
+        previousLineSsbo = sgl::GeometryBufferPtr();
+    }
+}
+
 void LineDataMultiVar::setUniformGatherShaderData_Pass(sgl::ShaderProgramPtr& gatherShader) {
     if (!useMultiVarRendering) {
         LineData::setUniformGatherShaderData_Pass(gatherShader);
@@ -291,11 +320,17 @@ void LineDataMultiVar::setUniformGatherShaderData_Pass(sgl::ShaderProgramPtr& ga
 
 void LineDataMultiVar::setTrajectoryData(const Trajectories& trajectories) {
     LineDataFlow::setTrajectoryData(trajectories);
-    bezierTrajectories = convertTrajectoriesToBezierCurves(filterTrajectoryData());
+    // If the conversion fails (i.e., if there are no variables), an error is logged and no lines are shown.
+    convertTrajectoriesToBezierCurves(filterTrajectoryData(), bezierTrajectories);
+    attributeHistograms.clear();
+    // The cache is outdated due to the new line data generation; release its memory early.
+    cachedTubeRenderData = TubeRenderDataMultiVar();
+    cachedLineChunkBvh.clear();
 
     // Reset selected attributes.
     varSelected = std::vector<uint32_t>(attributeNames.size(), false);
     numVariablesSelected = 0;
+    varSelectedArrayBuffer = sgl::GeometryBufferPtr();
 
     // Set starting colors based on default color array.
     /*varColors = std::vector<glm::vec4>(attributeNames.size());
@@ -351,8 +386,28 @@ struct LineVarDescData {
     glm::vec2 minMax;
 };
 
+void LineDataMultiVar::updateVarSelectedArrayBuffer() {
+    if (varSelected.empty()) {
+        varSelectedArrayBuffer = sgl::GeometryBufferPtr();
+        return;
+    }
+    if (varSelectedArrayBuffer && varSelectedArrayBuffer->getSize() == varSelected.size() * sizeof(uint32_t)) {
+        varSelectedArrayBuffer->subData(0, varSelected.size() * sizeof(uint32_t), varSelected.data());
+    } else {
+        varSelectedArrayBuffer = sgl::Renderer->createGeometryBuffer(
+                varSelected.size() * sizeof(uint32_t), varSelected.data(),
+                sgl::SHADER_STORAGE_BUFFER);
+    }
+}
+
 TubeRenderDataMultiVar LineDataMultiVar::getTubeRenderDataMultiVar() {
     rebuildInternalRepresentationIfNecessary();
+    if (isTubeRenderDataValid && cachedTubeRenderDataGeneration == lineDataGeneration
+            && cachedTubeRenderDataFilteredTrajectories == filteredTrajectories
+            && cachedTubeRenderDataUseLineChunkBvh == getUseLineChunkBvh()) {
+        lineChunkBvh = cachedLineChunkBvh;
+        return cachedTubeRenderData;
+    }
 
     std::vector<std::vector<glm::vec3>> lineCentersList;
     std::vector<std::vector<std::vector<float>>> lineAttributesList;
@@ -385,6 +440,8 @@ TubeRenderDataMultiVar LineDataMultiVar::getTubeRenderDataMultiVar() {
     createLineTubesRenderDataCPU(
             lineCentersList, lineAttributesList,
             lineIndices, vertexPositions, vertexNormals, vertexTangents, vertexAttributes);
+    rebuildLineChunkBvh(lineIndices, vertexPositions, nullptr);
+    cachedLineChunkBvh = lineChunkBvh;
 
     std::vector<glm::vec4> vertexMultiVariableArray;
     std::vector<glm::vec4> vertexVariableDescArray;
@@ -435,12 +492,6 @@ TubeRenderDataMultiVar LineDataMultiVar::getTubeRenderDataMultiVar() {
     std::vector<VarDescData> varDescData;
     std::vector<LineVarDescData> lineVarDescData;
 
-    for (BezierTrajectory& bezierTrajectory : bezierTrajectories) {
-        for (float attrVal : bezierTrajectory.multiVarData) {
-            varData.push_back(attrVal);
-        }
-    }
-
     for (BezierTrajectory& bezierTrajectory : bezierTrajectories) {
         for (float attrVal : bezierTrajectory.multiVarData) {
             varData.push_back(attrVal);
@@ -493,12 +544,14 @@ TubeRenderDataMultiVar LineDataMultiVar::getTubeRenderDataMultiVar() {
     tubeRenderData.lineVarDescArrayBuffer = sgl::Renderer->createGeometryBuffer(
             lineVarDescData.size()*sizeof(LineVarDescData), lineVarDescData.data(),
             sgl::SHADER_STORAGE_BUFFER);
-    tubeRenderData.varSelectedArrayBuffer = sgl::Renderer->createGeometryBuffer(
-            varSelected.size()*sizeof(uint32_t), varSelected.data(),
-            sgl::SHADER_STORAGE_BUFFER);
     /*tubeRenderData.varColorArrayBuffer = sgl::Renderer->createGeometryBuffer(
             varColors.size()*sizeof(glm::vec4), varColors.data(),
             sgl::SHADER_STORAGE_BUFFER);*/
 
+    cachedTubeRenderData = tubeRenderData;
+    isTubeRenderDataValid = true;
+    cachedTubeRenderDataGeneration = lineDataGeneration;
+    cachedTubeRenderDataFilteredTrajectories = filteredTrajectories;
+    cachedTubeRenderDataUseLineChunkBvh = getUseLineChunkBvh();
     return tubeRenderData;
 }
@@ -48,7 +48,6 @@ struct TubeRenderDataMultiVar {
     sgl::GeometryBufferPtr lineDescArrayBuffer;
     sgl::GeometryBufferPtr varDescArrayBuffer;
     sgl::GeometryBufferPtr lineVarDescArrayBuffer;
-    sgl::GeometryBufferPtr varSelectedArrayBuffer;
     //sgl::GeometryBufferPtr varColorArrayBuffer;
 };
 
@@ -71,6 +70,9 @@ public:
     virtual void setUniformGatherShaderData(sgl::ShaderProgramPtr& gatherShader) override;
     virtual void setUniformGatherShaderData_AllPasses() override;
     virtual void setUniformGatherShaderData_Pass(sgl::ShaderProgramPtr& gatherShader) override;
+    virtual void keepPreviousDrawState() override;
+    virtual void swapPreviousDrawState() override;
+    virtual void releasePreviousDrawState() override;
 
     /**
      * For selecting options for the rendering technique (e.g., screen-oriented bands, tubes).
@@ -102,7 +104,23 @@ private:
 
     /// Create render data.
     TubeRenderDataMultiVar getTubeRenderDataMultiVar();
+    /// Uploads the selected variables (@see varSelected) without touching the other render data.
+    void updateVarSelectedArrayBuffer();
     BezierTrajectories bezierTrajectories;
+    /// Histograms of all attributes for the transfer function editors (built once per data set).
+    std::vector<AttributeHistogram> attributeHistograms;
+
+    /**
+     * The multi-variate render data only depends on the Bezier trajectories, the trajectory filter and whether the
+     * line chunk hierarchy is used. The cache is keyed on exactly these inputs, so it survives all other changes
+     * marking the line data dirty (e.g., the variable selection, the transfer functions or the render mode).
+     */
+    TubeRenderDataMultiVar cachedTubeRenderData;
+    bool isTubeRenderDataValid = false;
+    uint64_t cachedTubeRenderDataGeneration = 0; ///< @see LineData::lineDataGeneration.
+    std::vector<bool> cachedTubeRenderDataFilteredTrajectories;
+    bool cachedTubeRenderDataUseLineChunkBvh = false;
+    LineChunkBvh cachedLineChunkBvh; ///< Culling hierarchy of cachedTubeRenderData (empty if culling is disabled).
 
     // GUI window for inspecting variable distributions over lines.
     //MultiVarWindow multiVarWindow;
@@ -134,6 +152,8 @@ private:
     sgl::GeometryBufferPtr lineVarDescArrayBuffer;
     sgl::GeometryBufferPtr varSelectedArrayBuffer;
     //sgl::GeometryBufferPtr varColorArrayBuffer;
+    /// The line SSBOs of the previous render data (@see keepPreviousDrawState).
+    sgl::GeometryBufferPtr previousLineSsbos[4];
 
     // Multi-variable settings.
     std::vector<uint32_t> varSelected;
@@ -255,9 +255,7 @@ bool LineDataMultiVar::renderGuiTechniqueSettings() {
 
         // Update SSBO
         if (itemHasChanged) {
-            varSelectedArrayBuffer = sgl::Renderer->createGeometryBuffer(
-                    varSelected.size() * sizeof(uint32_t), varSelected.data(),
-                    sgl::SHADER_STORAGE_BUFFER);
+            updateVarSelectedArrayBuffer();
             shallReloadGatherShader = true;
             recomputeWidgetPositions();
         }
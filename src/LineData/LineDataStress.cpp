@@ -26,11 +26,16 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <utility>
+
 #include <Graphics/Renderer.hpp>
 #include <Graphics/Shader/ShaderManager.hpp>
 
 #include "Loaders/TrajectoryFile.hpp"
-#include "Renderers/Tubes/Tubes.hpp"
+#include "Loaders/StressTrajectoriesBinaryLoader.hpp"
 #include "Renderers/OIT/OpacityOptimizationRenderer.hpp"
 
 #include <Utils/File/Logfile.hpp>
@@ -38,7 +43,8 @@
 #include "Utils/TriangleNormals.hpp"
 #include "Utils/MeshSmoothing.hpp"
 #include "Loaders/DegeneratePointsDatLoader.hpp"
-#include "SearchStructures/KdTree.hpp"
+#include "SearchStructures/FlatKdTree.hpp"
+#include "SearchStructures/PointDistanceField.hpp"
 #include "Renderers/LineRenderer.hpp"
 #include "LineDataStress.hpp"
 
@@ -51,6 +57,8 @@ bool LineDataStress::renderThickBands = true;
 bool LineDataStress::useSmoothedBands = true;
 LineDataStress::LineHierarchyType LineDataStress::lineHierarchyType = LineDataStress::LineHierarchyType::GEO;
 glm::vec3 LineDataStress::lineHierarchySliderValues = glm::vec3(1.0f);
+bool LineDataStress::useDegeneratePointsDistanceField = false;
+float LineDataStress::degeneratePointsDistanceFieldMaxError = 0.01f;
 
 const char* const stressDirectionNames[] = { "Major", "Medium", "Minor" };
 const char* const lineHierarchyTypeNames[] = { "GEO-based", "PS-based", "vM-based", "Length-based" };
@@ -60,7 +68,8 @@ LineDataStress::LineDataStress(sgl::TransferFunctionWindow &transferFunctionWind
           //multiVarTransferFunctionWindow("stress", { "reds.xml", "greens.xml", "blues.xml" }) {
           multiVarTransferFunctionWindow(
                   "stress",
-                  { "qualitative-pale-lilac.xml", "qualitative-emerald.xml", "qualitative-ocher.xml" }) {
+                  { "qualitative-pale-lilac.xml", "qualitative-emerald.xml", "qualitative-ocher.xml" }),
+          isStressTensorProbeReady(false) {
     colorLegendWidgets.resize(3);
     for (int psIdx = 0; psIdx < 3; psIdx++) {
         colorLegendWidgets[psIdx].setPositionIndex(psIdx, 3);
@@ -70,6 +79,7 @@ LineDataStress::LineDataStress(sgl::TransferFunctionWindow &transferFunctionWind
 }
 
 LineDataStress::~LineDataStress() {
+    joinStressTensorProbeLoaderThread();
 }
 
 bool LineDataStress::settingsDiffer(LineData* other) {
@@ -234,6 +244,13 @@ bool LineDataStress::renderGuiLineData(bool isRasterizer) {
             shallReloadGatherShader = true;
             recomputeColorLegend();
         }
+
+        // Only used when the degenerate point distance attributes are computed, i.e., when loading a data set.
+        ImGui::Checkbox("Degenerate Point Distance Field", &useDegeneratePointsDistanceField);
+        if (useDegeneratePointsDistanceField) {
+            ImGui::SliderFloat(
+                    "Max. Kernel Error", &degeneratePointsDistanceFieldMaxError, 0.001f, 0.1f, "%.3f");
+        }
     }
 
     if (lineRenderer && renderingMode == RENDERING_MODE_OPACITY_OPTIMIZATION && recomputeOpacityOptimization) {
@@ -311,14 +328,66 @@ bool LineDataStress::loadFromFile(
     std::vector<StressTrajectoriesData> stressTrajectoriesDataPs;
     sgl::AABB3 oldAABB;
     MeshType meshType = MeshType::CARTESIAN;
-    loadStressTrajectoriesFromFile(
-            fileNames, dataSetInformation.filenamesStressLineHierarchy, dataSetInformation.version, loadedPsIndices,
-            meshType, trajectoriesPs, stressTrajectoriesDataPs,
-            bandPointsUnsmoothedListLeftPs, bandPointsUnsmoothedListRightPs,
-            bandPointsSmoothedListLeftPs, bandPointsSmoothedListRightPs,
-            simulationMeshOutlineTriangleIndices, simulationMeshOutlineVertexPositions,
-            true, false, &oldAABB, transformationMatrixPtr);
+    if (dataSetInformation.stressTrajectoriesMemoryData) {
+        // The data was received from the line tracer without a round trip over the file system.
+        const StressTrajectoriesMemoryData& memoryData = *dataSetInformation.stressTrajectoriesMemoryData;
+        loadedPsIndices = memoryData.loadedPsIndices;
+        meshType = memoryData.meshType;
+        trajectoriesPs = memoryData.trajectoriesPs;
+        stressTrajectoriesDataPs = memoryData.stressTrajectoriesDataPs;
+        bandPointsUnsmoothedListLeftPs = memoryData.bandPointsUnsmoothedListLeftPs;
+        bandPointsUnsmoothedListRightPs = memoryData.bandPointsUnsmoothedListRightPs;
+        bandPointsSmoothedListLeftPs = memoryData.bandPointsSmoothedListLeftPs;
+        bandPointsSmoothedListRightPs = memoryData.bandPointsSmoothedListRightPs;
+        simulationMeshOutlineTriangleIndices = memoryData.simulationMeshOutlineTriangleIndices;
+        simulationMeshOutlineVertexPositions = memoryData.simulationMeshOutlineVertexPositions;
+        // The reply may only be the first batch of a streamed reply, and further batches are appended using the same
+        // normalization (@see appendStreamedLines). If available, the mesh outline gives the bounds of all lines.
+        if (!simulationMeshOutlineVertexPositions.empty()) {
+            for (const glm::vec3& vertexPosition : simulationMeshOutlineVertexPositions) {
+                oldAABB.combine(vertexPosition);
+            }
+        } else {
+            oldAABB = computeTrajectoriesPsAABB3(trajectoriesPs);
+        }
+        normalizeStressTrajectoriesPs(
+                !bandPointsUnsmoothedListLeftPs.empty(), trajectoriesPs,
+                bandPointsUnsmoothedListLeftPs, bandPointsUnsmoothedListRightPs,
+                bandPointsSmoothedListLeftPs, bandPointsSmoothedListRightPs,
+                oldAABB, transformationMatrixPtr);
+    } else {
+        loadStressTrajectoriesFromFile(
+                fileNames, dataSetInformation.filenamesStressLineHierarchy, dataSetInformation.version,
+                loadedPsIndices, meshType, trajectoriesPs, stressTrajectoriesDataPs,
+                bandPointsUnsmoothedListLeftPs, bandPointsUnsmoothedListRightPs,
+                bandPointsSmoothedListLeftPs, bandPointsSmoothedListRightPs,
+                simulationMeshOutlineTriangleIndices, simulationMeshOutlineVertexPositions,
+                true, false, &oldAABB, transformationMatrixPtr);
+    }
     hasBandsData = !bandPointsUnsmoothedListLeftPs.empty();
+    this->meshType = meshType;
+    normalizationAABB = oldAABB;
+    hasNormalizationTransform = transformationMatrixPtr != nullptr;
+    if (hasNormalizationTransform) {
+        normalizationTransform = *transformationMatrixPtr;
+    }
+
+    // Remember the normalization of the data (@see normalizeVertexPositions) for probing the simulation mesh.
+    joinStressTensorProbeLoaderThread();
+    simulationMeshFilename = dataSetInformation.meshFilename;
+    stressTensorProbe = {};
+    isStressTensorProbeLoading = false;
+    isStressTensorProbeReady = false;
+    glm::vec3 scale3D = 0.5f / oldAABB.getDimensions();
+    float scale = std::min(scale3D.x, std::min(scale3D.y, scale3D.z));
+    meshToWorldMatrix = glm::mat4(1.0f);
+    meshToWorldMatrix[0][0] = meshToWorldMatrix[1][1] = meshToWorldMatrix[2][2] = scale;
+    meshToWorldMatrix[3] = glm::vec4(-oldAABB.getCenter() * scale, 1.0f);
+    if (transformationMatrixPtr != nullptr) {
+        meshToWorldMatrix = (*transformationMatrixPtr) * meshToWorldMatrix;
+    }
+    worldToMeshMatrix = glm::inverse(meshToWorldMatrix);
+
     if (!simulationMeshOutlineTriangleIndices.empty()) {
         normalizeVertexPositions(simulationMeshOutlineVertexPositions, oldAABB, transformationMatrixPtr);
         if (meshType == MeshType::CARTESIAN) {
@@ -380,12 +449,153 @@ bool LineDataStress::loadFromFile(
     return dataLoaded;
 }
 
+bool LineDataStress::appendStreamedLines(const StressTrajectoriesMemoryData& memoryData) {
+    std::vector<Trajectories> batchTrajectoriesPs = memoryData.trajectoriesPs;
+    std::vector<std::vector<std::vector<glm::vec3>>> batchBandPointsUnsmoothedListLeftPs;
+    std::vector<std::vector<std::vector<glm::vec3>>> batchBandPointsUnsmoothedListRightPs;
+    std::vector<std::vector<std::vector<glm::vec3>>> batchBandPointsSmoothedListLeftPs;
+    std::vector<std::vector<std::vector<glm::vec3>>> batchBandPointsSmoothedListRightPs;
+    if (hasBandsData) {
+        if (memoryData.bandPointsUnsmoothedListLeftPs.empty() && !batchTrajectoriesPs.empty()) {
+            sgl::Logfile::get()->writeError(
+                    "Error in LineDataStress::appendStreamedLines: The lines have no band data.");
+            return false;
+        }
+        batchBandPointsUnsmoothedListLeftPs = memoryData.bandPointsUnsmoothedListLeftPs;
+        batchBandPointsUnsmoothedListRightPs = memoryData.bandPointsUnsmoothedListRightPs;
+        batchBandPointsSmoothedListLeftPs = memoryData.bandPointsSmoothedListLeftPs;
+        batchBandPointsSmoothedListRightPs = memoryData.bandPointsSmoothedListRightPs;
+    }
+    const glm::mat4* transformationMatrixPtr = hasNormalizationTransform ? &normalizationTransform : nullptr;
+    normalizeStressTrajectoriesPs(
+            hasBandsData, batchTrajectoriesPs,
+            batchBandPointsUnsmoothedListLeftPs, batchBandPointsUnsmoothedListRightPs,
+            batchBandPointsSmoothedListLeftPs, batchBandPointsSmoothedListRightPs,
+            normalizationAABB, transformationMatrixPtr);
+    modelBoundingBox.combine(computeTrajectoriesPsAABB3(batchTrajectoriesPs));
+
+    bool addedLineSet = false;
+    for (size_t batchLineSetIdx = 0; batchLineSetIdx < batchTrajectoriesPs.size(); batchLineSetIdx++) {
+        const int psIdx = memoryData.loadedPsIndices.at(batchLineSetIdx);
+        auto it = std::find(loadedPsIndices.begin(), loadedPsIndices.end(), psIdx);
+        const size_t i = size_t(it - loadedPsIndices.begin());
+        if (it == loadedPsIndices.end()) {
+            loadedPsIndices.push_back(psIdx);
+            trajectoriesPs.emplace_back();
+            stressTrajectoriesDataPs.emplace_back();
+            filteredTrajectoriesPs.emplace_back();
+            linePreprocessingCachesPs.emplace_back();
+            if (hasBandsData) {
+                bandPointsUnsmoothedListLeftPs.emplace_back();
+                bandPointsUnsmoothedListRightPs.emplace_back();
+                bandPointsSmoothedListLeftPs.emplace_back();
+                bandPointsSmoothedListRightPs.emplace_back();
+            }
+            minMaxAttributeValuesPs[psIdx].assign(
+                    minMaxAttributeValues.size(),
+                    glm::vec2(std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest()));
+            addedLineSet = true;
+        }
+
+        // Only the value ranges are updated. The histograms are rebuilt on demand (@see recomputeHistogram).
+        Trajectories& batchTrajectories = batchTrajectoriesPs.at(batchLineSetIdx);
+        for (const Trajectory& trajectory : batchTrajectories) {
+            for (size_t attrIdx = 0; attrIdx < minMaxAttributeValues.size(); attrIdx++) {
+                if (attrIdx >= trajectory.attributes.size()) {
+                    break;
+                }
+                glm::vec2& minMaxPs = minMaxAttributeValuesPs[psIdx].at(attrIdx);
+                glm::vec2& minMax = minMaxAttributeValues.at(attrIdx);
+                for (float val : trajectory.attributes.at(attrIdx)) {
+                    minMaxPs = glm::vec2(std::min(minMaxPs.x, val), std::max(minMaxPs.y, val));
+                    minMax = glm::vec2(std::min(minMax.x, val), std::max(minMax.y, val));
+                }
+            }
+        }
+
+        const StressTrajectoriesData& batchStressTrajectoriesData =
+                memoryData.stressTrajectoriesDataPs.at(batchLineSetIdx);
+        for (const StressTrajectoryData& stressTrajectoryData : batchStressTrajectoriesData) {
+            glm::vec3 seedPosition = stressTrajectoryData.seedPosition;
+            normalizeVertexPosition(seedPosition, normalizationAABB, transformationMatrixPtr);
+            if (size_t(stressTrajectoryData.appearanceOrder) >= seedPoints.size()) {
+                seedPoints.resize(size_t(stressTrajectoryData.appearanceOrder) + 1);
+            }
+            seedPoints.at(stressTrajectoryData.appearanceOrder) = seedPosition;
+        }
+        StressTrajectoriesData& stressTrajectoriesData = stressTrajectoriesDataPs.at(i);
+        stressTrajectoriesData.insert(
+                stressTrajectoriesData.end(), batchStressTrajectoriesData.begin(), batchStressTrajectoriesData.end());
+
+        Trajectories& trajectories = trajectoriesPs.at(i);
+        trajectories.insert(
+                trajectories.end(), std::make_move_iterator(batchTrajectories.begin()),
+                std::make_move_iterator(batchTrajectories.end()));
+        if (!filteredTrajectoriesPs.at(i).empty()) {
+            filteredTrajectoriesPs.at(i).resize(trajectories.size(), false);
+        }
+        if (hasBandsData) {
+            auto appendBandPoints = [i, batchLineSetIdx](
+                    std::vector<std::vector<std::vector<glm::vec3>>>& bandPointsListPs,
+                    std::vector<std::vector<std::vector<glm::vec3>>>& batchBandPointsListPs) {
+                std::vector<std::vector<glm::vec3>>& bandPointsList = bandPointsListPs.at(i);
+                std::vector<std::vector<glm::vec3>>& batchBandPointsList = batchBandPointsListPs.at(batchLineSetIdx);
+                bandPointsList.insert(
+                        bandPointsList.end(), std::make_move_iterator(batchBandPointsList.begin()),
+                        std::make_move_iterator(batchBandPointsList.end()));
+            };
+            appendBandPoints(bandPointsUnsmoothedListLeftPs, batchBandPointsUnsmoothedListLeftPs);
+            appendBandPoints(bandPointsUnsmoothedListRightPs, batchBandPointsUnsmoothedListRightPs);
+            appendBandPoints(bandPointsSmoothedListLeftPs, batchBandPointsSmoothedListLeftPs);
+            appendBandPoints(bandPointsSmoothedListRightPs, batchBandPointsSmoothedListRightPs);
+        }
+        linePreprocessingCachesPs.at(i).invalidate();
+    }
+
+    // The tracer may send the outline of the simulation mesh with any of the batches.
+    if (simulationMeshOutlineTriangleIndices.empty() && !memoryData.simulationMeshOutlineTriangleIndices.empty()) {
+        simulationMeshOutlineTriangleIndices = memoryData.simulationMeshOutlineTriangleIndices;
+        simulationMeshOutlineVertexPositions = memoryData.simulationMeshOutlineVertexPositions;
+        normalizeVertexPositions(simulationMeshOutlineVertexPositions, normalizationAABB, transformationMatrixPtr);
+        if (meshType == MeshType::CARTESIAN) {
+            laplacianSmoothing(simulationMeshOutlineTriangleIndices, simulationMeshOutlineVertexPositions);
+        }
+        computeSmoothTriangleNormals(
+                simulationMeshOutlineTriangleIndices, simulationMeshOutlineVertexPositions,
+                simulationMeshOutlineVertexNormals);
+        shallRenderSimulationMeshBoundary = true;
+    }
+
+    if (addedLineSet) {
+        std::vector<bool> usedPsDirections = this->usedPsDirections;
+        for (size_t i = 0; i < loadedPsIndices.size(); i++) {
+            int psIdx = loadedPsIndices.at(i);
+            colorLegendWidgets[psIdx].setPositionIndex(int(i), int(loadedPsIndices.size()));
+            usedPsDirections.at(psIdx) = true;
+        }
+        setUsedPsDirections(usedPsDirections);
+    }
+    lineDataGeneration++;
+    isPickingBvhValid = false;
+    attributeHistogramsPs.clear();
+    updateLineHierarchyHistogram();
+    dirty = true;
+    return true;
+}
+
 void LineDataStress::setStressTrajectoryData(
         const std::vector<Trajectories>& trajectoriesPs,
         const std::vector<StressTrajectoriesData>& stressTrajectoriesDataPs) {
     this->trajectoriesPs = trajectoriesPs;
     this->stressTrajectoriesDataPs = stressTrajectoriesDataPs;
     filteredTrajectoriesPs.resize(trajectoriesPs.size());
+    linePreprocessingCachesPs.resize(trajectoriesPs.size());
+    for (LinePreprocessingCache& linePreprocessingCache : linePreprocessingCachesPs) {
+        linePreprocessingCache.invalidate();
+    }
+    lineDataGeneration++;
+    isPickingBvhValid = false;
+    attributeHistogramsPs.clear();
     for (size_t attrIdx = attributeNames.size(); attrIdx < getNumAttributes(); attrIdx++) {
         attributeNames.push_back(std::string() + "Attribute #" + std::to_string(attrIdx + 1));
     }
@@ -442,17 +652,13 @@ void LineDataStress::updateLineHierarchyHistogram() {
 }
 
 // Exponential kernel: f_1(x,y) = exp(-||x-y||_2 / l), l \in \mathbb{R}
-float exponentialKernel(const glm::vec3& pt0, const glm::vec3& pt1, float lengthScale) {
-    glm::vec3 diff = pt0 - pt1;
-    float dist = std::sqrt(diff.x * diff.x + diff.y * diff.y + diff.z * diff.z);
-    return std::exp(-dist / lengthScale);
+float exponentialKernel(float distance, float lengthScale) {
+    return std::exp(-distance / lengthScale);
 }
 
 // Squared exponential kernel: f_2(x,y) = exp(-||x-y||_2^2 / (2*l^2)), l \in \mathbb{R}
-float squaredExponentialKernel(const glm::vec3& pt0, const glm::vec3& pt1, float lengthScale) {
-    glm::vec3 diff = pt0 - pt1;
-    float dist = diff.x * diff.x + diff.y * diff.y + diff.z * diff.z;
-    return std::exp(-dist / (2.0f * lengthScale * lengthScale));
+float squaredExponentialKernel(float distance, float lengthScale) {
+    return std::exp(-distance * distance / (2.0f * lengthScale * lengthScale));
 }
 
 void LineDataStress::setDegeneratePoints(
@@ -463,7 +669,7 @@ void LineDataStress::setDegeneratePoints(
     }
 
     // Build a search structure on the degenerate points.
-    KdTree kdTree;
+    FlatKdTree kdTree;
     std::vector<IndexedPoint> indexedPoints;
     std::vector<IndexedPoint*> indexedPointsPointers;
     indexedPoints.resize(degeneratePoints.size());
@@ -479,32 +685,47 @@ void LineDataStress::setDegeneratePoints(
     // TODO: Dependent on AABB?
     const float lengthScale = 0.02f;
 
-    // Find for all line points the distance to the closest degenerate point.
+    // Find for all line points the distance to the closest degenerate point in one batch.
+    std::vector<glm::vec3> linePoints;
+    for (Trajectories& trajectories : trajectoriesPs) {
+        for (Trajectory& trajectory : trajectories) {
+            linePoints.insert(linePoints.end(), trajectory.positions.begin(), trajectory.positions.end());
+        }
+    }
+    std::vector<float> degeneratePointDistances;
+    if (useDegeneratePointsDistanceField) {
+        computeDegeneratePointDistancesFromField(kdTree, linePoints, lengthScale, degeneratePointDistances);
+    } else {
+        std::vector<IndexedPoint*> nearestNeighbors;
+        kdTree.findNearestNeighbors(linePoints, nearestNeighbors);
+        degeneratePointDistances.resize(linePoints.size());
+        for (size_t i = 0; i < linePoints.size(); i++) {
+            degeneratePointDistances.at(i) = glm::length(linePoints.at(i) - nearestNeighbors.at(i)->position);
+        }
+    }
+
     size_t psIdx = 0;
+    size_t linePointOffset = 0;
     for (Trajectories& trajectories : trajectoriesPs) {
         for (Trajectory& trajectory : trajectories) {
+            const size_t numLinePoints = trajectory.positions.size();
             std::vector<float> distanceMeasuresExponentialKernel;
             std::vector<float> distanceMeasuresSquaredExponentialKernel;
-            distanceMeasuresExponentialKernel.resize(trajectory.positions.size());
-            distanceMeasuresSquaredExponentialKernel.resize(trajectory.positions.size());
+            distanceMeasuresExponentialKernel.resize(numLinePoints);
+            distanceMeasuresSquaredExponentialKernel.resize(numLinePoints);
 #if _OPENMP >= 201107
-            #pragma omp parallel for shared(trajectory, kdTree, degeneratePoints, lengthScale, \
-            distanceMeasuresExponentialKernel, distanceMeasuresSquaredExponentialKernel) default(none)
+            #pragma omp parallel for shared(degeneratePointDistances, numLinePoints, linePointOffset, \
+            lengthScale, distanceMeasuresExponentialKernel, distanceMeasuresSquaredExponentialKernel) default(none)
 #endif
-            for (size_t linePointIdx = 0; linePointIdx < trajectory.positions.size(); linePointIdx++) {
-                const glm::vec3& linePoint = trajectory.positions.at(linePointIdx);
-
-                IndexedPoint* nearestNeighbor = kdTree.findNearestNeighbor(linePoint);
-                float distanceExponentialKernel = exponentialKernel(
-                        linePoint, nearestNeighbor->position, lengthScale);
-                float distanceSquaredExponentialKernel = squaredExponentialKernel(
-                        linePoint, nearestNeighbor->position, lengthScale);
-
-                distanceMeasuresExponentialKernel.at(linePointIdx) = distanceExponentialKernel;
-                distanceMeasuresSquaredExponentialKernel.at(linePointIdx) = distanceSquaredExponentialKernel;
+            for (size_t linePointIdx = 0; linePointIdx < numLinePoints; linePointIdx++) {
+                float distance = degeneratePointDistances.at(linePointOffset + linePointIdx);
+                distanceMeasuresExponentialKernel.at(linePointIdx) = exponentialKernel(distance, lengthScale);
+                distanceMeasuresSquaredExponentialKernel.at(linePointIdx) = squaredExponentialKernel(
+                        distance, lengthScale);
             }
             trajectory.attributes.push_back(distanceMeasuresExponentialKernel);
             trajectory.attributes.push_back(distanceMeasuresSquaredExponentialKernel);
+            linePointOffset += numLinePoints;
         }
         minMaxAttributeValuesPs[psIdx].push_back(glm::vec2(0.0f, 1.0f));
         minMaxAttributeValuesPs[psIdx].push_back(glm::vec2(0.0f, 1.0f));
@@ -517,8 +738,91 @@ void LineDataStress::setDegeneratePoints(
     attributeNames.push_back("Distance Squared Exponential Kernel");
 }
 
+void LineDataStress::buildAttributeHistograms(size_t attrIdx) {
+    attributeHistogramsPs.resize(trajectoriesPs.size());
+    const size_t numAttributes = getNumAttributes();
+    std::vector<float> attributeValues;
+    for (size_t i = 0; i < trajectoriesPs.size(); i++) {
+        std::vector<AttributeHistogram>& attributeHistograms = attributeHistogramsPs.at(i);
+        attributeHistograms.resize(numAttributes);
+        AttributeHistogram& attributeHistogram = attributeHistograms.at(attrIdx);
+        if (!attributeHistogram.getIsEmpty()) {
+            continue;
+        }
+        attributeValues.clear();
+        for (const Trajectory& trajectory : trajectoriesPs.at(i)) {
+            const std::vector<float>& values = trajectory.attributes.at(attrIdx);
+            attributeValues.insert(attributeValues.end(), values.begin(), values.end());
+        }
+        attributeHistogram.build(attributeValues);
+    }
+}
+
+void LineDataStress::computeDegeneratePointDistancesFromField(
+        const FlatKdTree& kdTree, const std::vector<glm::vec3>& linePoints, float lengthScale,
+        std::vector<float>& distances) {
+    const int MIN_RESOLUTION = 32;
+    const int MAX_RESOLUTION = 256;
+    const size_t MAX_NUM_SAMPLE_POINTS = 10000;
+
+    AxisAlignedBox domain(
+            glm::vec3(std::numeric_limits<float>::max()), glm::vec3(std::numeric_limits<float>::lowest()));
+    for (const glm::vec3& linePoint : linePoints) {
+        domain.min = glm::min(domain.min, linePoint);
+        domain.max = glm::max(domain.max, linePoint);
+    }
+    if (linePoints.empty()) {
+        domain = AxisAlignedBox(glm::vec3(0.0f), glm::vec3(0.0f));
+    }
+
+    // The error of the kernel values is measured using exact queries for a subset of the line points.
+    std::vector<glm::vec3> samplePoints;
+    size_t sampleStride = std::max(linePoints.size() / MAX_NUM_SAMPLE_POINTS, size_t(1));
+    for (size_t i = 0; i < linePoints.size(); i += sampleStride) {
+        samplePoints.push_back(linePoints.at(i));
+    }
+    std::vector<IndexedPoint*> sampleNearestNeighbors;
+    kdTree.findNearestNeighbors(samplePoints, sampleNearestNeighbors);
+
+    // Refine the grid until the maximum error of the sampled kernel values is small enough.
+    PointDistanceField distanceField;
+    std::vector<float> sampleDistances;
+    float maxKernelError = 0.0f;
+    for (int resolution = MIN_RESOLUTION; resolution <= MAX_RESOLUTION; resolution *= 2) {
+        distanceField.build(degeneratePoints, domain, resolution);
+        distanceField.getDistances(samplePoints, sampleDistances);
+        maxKernelError = 0.0f;
+        for (size_t i = 0; i < samplePoints.size(); i++) {
+            float distanceExact = glm::length(samplePoints.at(i) - sampleNearestNeighbors.at(i)->position);
+            maxKernelError = std::max(maxKernelError, std::abs(
+                    exponentialKernel(sampleDistances.at(i), lengthScale)
+                    - exponentialKernel(distanceExact, lengthScale)));
+            maxKernelError = std::max(maxKernelError, std::abs(
+                    squaredExponentialKernel(sampleDistances.at(i), lengthScale)
+                    - squaredExponentialKernel(distanceExact, lengthScale)));
+        }
+        if (maxKernelError <= degeneratePointsDistanceFieldMaxError) {
+            break;
+        }
+    }
+    distanceField.getDistances(linePoints, distances);
+
+    const glm::ivec3& gridResolution = distanceField.getResolution();
+    sgl::Logfile::get()->writeInfo(
+            "Degenerate point distance field: Resolution " + std::to_string(gridResolution.x) + "x"
+            + std::to_string(gridResolution.y) + "x" + std::to_string(gridResolution.z)
+            + ", maximum kernel error " + std::to_string(maxKernelError) + " (sampled at "
+            + std::to_string(samplePoints.size()) + " line points).");
+    if (maxKernelError > degeneratePointsDistanceFieldMaxError) {
+        sgl::Logfile::get()->writeWarning(
+                "Warning in LineDataStress::computeDegeneratePointDistancesFromField: The maximum kernel error "
+                "exceeds the allowed error at the maximum grid resolution.", false);
+    }
+}
+
 void LineDataStress::setUsedPsDirections(const std::vector<bool>& usedPsDirections) {
     this->usedPsDirections = usedPsDirections;
+    isPickingBvhValid = false;
     useMajorPS = usedPsDirections.at(0);
     useMediumPS = usedPsDirections.at(1);
     useMinorPS = usedPsDirections.at(2);
@@ -547,26 +851,26 @@ void LineDataStress::recomputeHistogram() {
     glm::vec2 minMaxAttributes = minMaxAttributeValues.at(selectedAttributeIndex);
     transferFunctionWindow.computeHistogram(attributeList, minMaxAttributes.x, minMaxAttributes.y);
 
+    // The histograms are only built the first time an attribute is selected.
+    buildAttributeHistograms(size_t(selectedAttributeIndex));
     std::vector<std::string> attrNamesMultiVarWindow;
-    std::vector<std::vector<float>> attributesValuesMultiVarWindow;
+    std::vector<AttributeHistogram> attributeHistogramsMultiVarWindow;
     for (int psIdx = 0; psIdx < 3; psIdx++) {
         attrNamesMultiVarWindow.push_back(
                 std::string() + attributeNames.at(selectedAttributeIndex) + " (" + stressDirectionNames[psIdx] + ")");
-        std::vector<float> attributeValues;
         auto it = std::find(loadedPsIndices.begin(), loadedPsIndices.end(), psIdx);
-        if (it != loadedPsIndices.end()) {
-            Trajectories& trajectories = trajectoriesPs.at(std::distance(loadedPsIndices.begin(), it));
-            for (Trajectory& trajectory : trajectories) {
-                for (float& attrVal : trajectory.attributes.at(selectedAttributeIndex)) {
-                    attributeValues.push_back(attrVal);
-                }
-            }
-        } else {
-            attributeValues = {0.0f, 1.0f};
+        if (it == loadedPsIndices.end()) {
+            std::vector<float> attributeValues = {0.0f, 1.0f};
+            attributeHistogramsMultiVarWindow.push_back(AttributeHistogram());
+            attributeHistogramsMultiVarWindow.back().build(attributeValues);
+            continue;
         }
-        attributesValuesMultiVarWindow.push_back(attributeValues);
+
+        size_t i = std::distance(loadedPsIndices.begin(), it);
+        attributeHistogramsMultiVarWindow.push_back(attributeHistogramsPs.at(i).at(selectedAttributeIndex));
     }
-    multiVarTransferFunctionWindow.setAttributesValues(attrNamesMultiVarWindow, attributesValuesMultiVarWindow);
+    multiVarTransferFunctionWindow.setAttributeHistograms(
+            attrNamesMultiVarWindow, attributeHistogramsMultiVarWindow);
 
     recomputeColorLegend();
 }
@@ -710,6 +1014,7 @@ void LineDataStress::filterTrajectories(std::function<bool(const Trajectory&)> c
 }
 
 void LineDataStress::resetTrajectoryFilter()  {
+    isPickingBvhValid = false;
     for (size_t i = 0; i < trajectoriesPs.size(); i++) {
         Trajectories & trajectories = trajectoriesPs.at(i);
         std::vector<bool>& filteredTrajectories = filteredTrajectoriesPs.at(i);
@@ -779,57 +1084,137 @@ Trajectories LineDataStress::filterTrajectoryData() {
     return trajectoriesFiltered;
 }
 
-std::vector<std::vector<glm::vec3>> LineDataStress::getFilteredLines() {
-    std::vector<std::vector<glm::vec3>> linesFiltered;
+FilteredLinesView LineDataStress::getFilteredLinesView() {
+    rebuildInternalRepresentationIfNecessary();
+    FilteredLinesView filteredLinesView;
     for (size_t i = 0; i < trajectoriesPs.size(); i++) {
         int psIdx = loadedPsIndices.at(i);
-        const Trajectories& trajectories = trajectoriesPs.at(i);
         if (!usedPsDirections.at(psIdx)) {
             continue;
         }
+        filteredLinesView.addLineSet(linePreprocessingCachesPs.at(i).getShared(
+                trajectoriesPs.at(i), filteredTrajectoriesPs.at(i)));
+    }
+    return filteredLinesView;
+}
 
-        std::vector<bool>& filteredTrajectories = filteredTrajectoriesPs.at(i);
-        size_t trajectoryIdx = 0;
-        for (const Trajectory &trajectory : trajectories) {
-            if (!filteredTrajectories.empty() && filteredTrajectories.at(trajectoryIdx)) {
-                trajectoryIdx++;
-                continue;
-            }
+bool LineDataStress::probeStressTensor(
+        const glm::vec3& rayOrigin, const glm::vec3& rayDirection, const glm::vec3* probePosition,
+        StressTensorProbeResult& result) {
+    if (!isStressTensorProbeLoading) {
+        startLoadingStressTensorProbe();
+    }
+    // Nothing can be probed while the mesh is still loading (or if it has no stress tensors).
+    if (!isStressTensorProbeReady) {
+        return false;
+    }
 
-            std::vector<glm::vec3> lineFiltered;
-            size_t n = trajectory.positions.size();
+    if (probePosition != nullptr) {
+        glm::vec4 meshPosition = worldToMeshMatrix * glm::vec4(*probePosition, 1.0f);
+        return stressTensorProbe->probe(glm::vec3(meshPosition), result);
+    }
+    glm::vec3 meshRayOrigin(worldToMeshMatrix * glm::vec4(rayOrigin, 1.0f));
+    glm::vec3 meshRayDirection = glm::normalize(glm::vec3(worldToMeshMatrix * glm::vec4(rayDirection, 0.0f)));
+    return stressTensorProbe->probeAlongRay(meshRayOrigin, meshRayDirection, result);
+}
 
-            int numValidLinePoints = 0;
-            for (size_t i = 0; i < n; i++) {
-                glm::vec3 tangent, normal;
-                if (i == 0) {
-                    tangent = trajectory.positions[i + 1] - trajectory.positions[i];
-                } else if (i == n - 1) {
-                    tangent = trajectory.positions[i] - trajectory.positions[i - 1];
-                } else {
-                    tangent = (trajectory.positions[i + 1] - trajectory.positions[i - 1]);
-                }
-                float lineSegmentLength = glm::length(tangent);
+void LineDataStress::startLoadingStressTensorProbe() {
+    // Only try once, as the mesh file may not contain any stress tensors.
+    isStressTensorProbeLoading = true;
+    if (simulationMeshFilename.empty()) {
+        sgl::Logfile::get()->writeInfo(
+                "LineDataStress::startLoadingStressTensorProbe: No simulation mesh is available for the loaded "
+                "data set.");
+        return;
+    }
 
-                if (lineSegmentLength < 0.0001f) {
-                    // In case the two vertices are almost identical, just skip this path line segment
-                    continue;
-                }
+    const std::string meshFilename = simulationMeshFilename;
+    stressTensorProbeLoaderThread = std::thread([this, meshFilename]() {
+        std::unique_ptr<StressTensorProbe> newStressTensorProbe(new StressTensorProbe);
+        if (!newStressTensorProbe->loadMeshFromFile(meshFilename) || newStressTensorProbe->getIsEmpty()) {
+            sgl::Logfile::get()->writeInfo(
+                    "LineDataStress::startLoadingStressTensorProbe: No stress tensors are available for the loaded "
+                    "data set.");
+            return;
+        }
+        stressTensorProbe = std::move(newStressTensorProbe);
+        isStressTensorProbeReady = true;
+    });
+}
 
-                lineFiltered.push_back(trajectory.positions.at(i));
-                numValidLinePoints++;
-            }
+void LineDataStress::joinStressTensorProbeLoaderThread() {
+    if (stressTensorProbeLoaderThread.joinable()) {
+        stressTensorProbeLoaderThread.join();
+    }
+}
 
-            if (numValidLinePoints > 1) {
-                linesFiltered.push_back(lineFiltered);
-            }
+void LineDataStress::renderGuiStressTensorProbeTooltip(const StressTensorProbeResult& result) {
+    ImGui::BeginTooltip();
+    ImGui::Text(
+            "Stress tensor at (%.4g, %.4g, %.4g), cell %u",
+            result.position.x, result.position.y, result.position.z, result.cellIdx);
+    ImGui::Text(
+            "xx: %g, yy: %g, zz: %g",
+            result.stressTensor[0], result.stressTensor[1], result.stressTensor[2]);
+    ImGui::Text(
+            "yz: %g, zx: %g, xy: %g",
+            result.stressTensor[3], result.stressTensor[4], result.stressTensor[5]);
+    for (int psIdx = 0; psIdx < 3; psIdx++) {
+        const glm::vec3& direction = result.principalStressDirections[psIdx];
+        ImGui::Text(
+                "%s principal stress: %g, direction: (%.3f, %.3f, %.3f)", stressDirectionNames[psIdx],
+                result.principalStresses[psIdx], direction.x, direction.y, direction.z);
+    }
+    ImGui::Text("von Mises stress: %g", result.vonMisesStress);
+    ImGui::EndTooltip();
+}
 
-            trajectoryIdx++;
+size_t LineDataStress::getFilteredLineSetIndex(uint32_t& lineIdx) {
+    // The filtered lines view contains the lines of all used principal stress directions one after another.
+    size_t lastUsedLineSetIdx = 0;
+    for (size_t i = 0; i < trajectoriesPs.size(); i++) {
+        int psIdx = loadedPsIndices.at(i);
+        if (!usedPsDirections.at(psIdx)) {
+            continue;
+        }
+        lastUsedLineSetIdx = i;
+        const LinePreprocessedData& lineSet = getLinePreprocessedDataPs(i);
+        if (lineIdx >= lineSet.getNumLines()) {
+            lineIdx -= uint32_t(lineSet.getNumLines());
+            continue;
+        }
+        return i;
+    }
+    return lastUsedLineSetIdx;
+}
+
+void LineDataStress::getPickedLineMetadata(uint32_t lineIdx, uint32_t segmentIdx, float t, LinePickingResult& result) {
+    size_t i = getFilteredLineSetIndex(lineIdx);
+    const LinePreprocessedData& lineSet = getLinePreprocessedDataPs(i);
+    getPickedLineMetadataFromLineSet(trajectoriesPs.at(i), lineSet, lineIdx, segmentIdx, t, result);
+    result.lineSetName = stressDirectionNames[loadedPsIndices.at(i)];
+    const StressTrajectoriesData& stressTrajectoriesData = stressTrajectoriesDataPs.at(i);
+    if (result.trajectoryIdx < stressTrajectoriesData.size()) {
+        const std::vector<float>& hierarchyLevels = stressTrajectoriesData.at(result.trajectoryIdx).hierarchyLevels;
+        if (int(lineHierarchyType) < int(hierarchyLevels.size())) {
+            result.lineHierarchyLevel = hierarchyLevels.at(int(lineHierarchyType));
         }
     }
-    return linesFiltered;
 }
 
+bool LineDataStress::getIsLineVisible(uint32_t lineIdx) {
+    // With transparency, all lines are rendered (@see drawLines).
+    if (!hasLineHierarchy || !useLineHierarchy || rendererSupportsTransparency) {
+        return true;
+    }
+    size_t i = getFilteredLineSetIndex(lineIdx);
+    const LinePreprocessedData& lineSet = getLinePreprocessedDataPs(i);
+    const StressTrajectoryData& stressTrajectoryData = stressTrajectoriesDataPs.at(i).at(
+            lineSet.lineTrajectoryIndices.at(lineIdx));
+    float level = stressTrajectoryData.hierarchyLevels.at(int(lineHierarchyType));
+    // Same test as for the line hierarchy draw ranges and in the gather shaders.
+    return level >= 1.0f - lineHierarchySliderValues[loadedPsIndices.at(i)];
+}
 
 std::vector<Trajectories> LineDataStress::filterTrajectoryPsData() {
     std::vector<Trajectories> trajectoriesPsFiltered;
@@ -890,63 +1275,6 @@ std::vector<Trajectories> LineDataStress::filterTrajectoryPsData() {
     return trajectoriesPsFiltered;
 }
 
-std::vector<std::vector<std::vector<glm::vec3>>> LineDataStress::getFilteredPrincipalStressLines() {
-    std::vector<std::vector<std::vector<glm::vec3>>> linesPsFiltered;
-    linesPsFiltered.reserve(trajectoriesPs.size());
-    for (size_t i = 0; i < trajectoriesPs.size(); i++) {
-        int psIdx = loadedPsIndices.at(i);
-        const Trajectories& trajectories = trajectoriesPs.at(i);
-        if (!usedPsDirections.at(psIdx)) {
-            continue;
-        }
-
-        std::vector<std::vector<glm::vec3>> linesFiltered;
-        linesFiltered.reserve(trajectories.size());
-        std::vector<bool>& filteredTrajectories = filteredTrajectoriesPs.at(i);
-        size_t trajectoryIdx = 0;
-        for (const Trajectory &trajectory : trajectories) {
-            if (!filteredTrajectories.empty() && filteredTrajectories.at(trajectoryIdx)) {
-                trajectoryIdx++;
-                continue;
-            }
-
-            std::vector<glm::vec3> lineFiltered;
-            size_t n = trajectory.positions.size();
-
-            int numValidLinePoints = 0;
-            for (size_t i = 0; i < n; i++) {
-                glm::vec3 tangent, normal;
-                if (i == 0) {
-                    tangent = trajectory.positions[i+1] - trajectory.positions[i];
-                } else if (i == n - 1) {
-                    tangent = trajectory.positions[i] - trajectory.positions[i-1];
-                } else {
-                    tangent = (trajectory.positions[i+1] - trajectory.positions[i-1]);
-                }
-                float lineSegmentLength = glm::length(tangent);
-
-                if (lineSegmentLength < 0.0001f) {
-                    // In case the two vertices are almost identical, just skip this path line segment
-                    continue;
-                }
-
-                lineFiltered.push_back(trajectory.positions.at(i));
-                numValidLinePoints++;
-            }
-
-            if (numValidLinePoints > 1) {
-                linesFiltered.push_back(lineFiltered);
-            }
-
-            trajectoryIdx++;
-        }
-
-        trajectoriesPs.push_back(trajectories);
-    }
-
-    return linesPsFiltered;
-}
-
 
 // --- Retrieve data for rendering. ---
 
@@ -983,8 +1311,121 @@ sgl::ShaderProgramPtr LineDataStress::reloadGatherShader() {
     return gatherShader;
 }
 
+const LinePreprocessedData& LineDataStress::getLinePreprocessedDataPs(size_t i) {
+    return linePreprocessingCachesPs.at(i).get(trajectoriesPs.at(i), filteredTrajectoriesPs.at(i));
+}
+
+void LineDataStress::appendVertexSimplificationErrorsPs(size_t i, std::vector<float>& vertexSimplificationErrors) {
+    if (!getUseLineLevelsOfDetail()) {
+        return;
+    }
+    const std::vector<float>& errors = linePreprocessingCachesPs.at(i).getVertexSimplificationErrors(
+            trajectoriesPs.at(i));
+    vertexSimplificationErrors.insert(vertexSimplificationErrors.end(), errors.begin(), errors.end());
+}
+
+void LineDataStress::appendLineHierarchyDataPs(
+        size_t i, const LinePreprocessedData& lineData, std::vector<float>& vertexLineHierarchyLevels,
+        std::vector<uint32_t>* vertexLineAppearanceOrders) {
+    StressTrajectoriesData& stressTrajectoriesData = stressTrajectoriesDataPs.at(i);
+    for (size_t lineIdx = 0; lineIdx < lineData.getNumLines(); lineIdx++) {
+        uint32_t trajectoryIdx = lineData.lineTrajectoryIndices.at(lineIdx);
+        uint32_t numValidPoints = lineData.lineNumVertices.at(lineIdx);
+        StressTrajectoryData& stressTrajectoryData = stressTrajectoriesData.at(trajectoryIdx);
+        if (hasLineHierarchy) {
+            vertexLineHierarchyLevels.insert(
+                    vertexLineHierarchyLevels.end(), numValidPoints,
+                    stressTrajectoryData.hierarchyLevels.at(int(lineHierarchyType)));
+        }
+        if (vertexLineAppearanceOrders) {
+            vertexLineAppearanceOrders->insert(
+                    vertexLineAppearanceOrders->end(), numValidPoints,
+                    uint32_t(stressTrajectoryData.appearanceOrder));
+        }
+    }
+}
+
+uint32_t LineHierarchyDrawRange::getNumIndices(float minLevel) const {
+    auto it = std::upper_bound(levels.begin(), levels.end(), minLevel, std::greater<float>());
+    size_t numLevels = size_t(it - levels.begin());
+    return numLevels == 0 ? 0 : levelIndexEnds.at(numLevels - 1);
+}
+
+void LineDataStress::appendLineIndicesPs(
+        size_t i, const LinePreprocessedData& lineData, uint32_t vertexOffset, std::vector<uint32_t>& lineIndices) {
+    if (!hasLineHierarchy) {
+        lineData.appendLineIndices(lineIndices, vertexOffset);
+        return;
+    }
+
+    StressTrajectoriesData& stressTrajectoriesData = stressTrajectoriesDataPs.at(i);
+    const size_t numLines = lineData.getNumLines();
+    std::vector<float> lineLevels(numLines);
+    std::vector<uint32_t> sortedLineIndices(numLines);
+    for (size_t lineIdx = 0; lineIdx < numLines; lineIdx++) {
+        lineLevels.at(lineIdx) = stressTrajectoriesData.at(lineData.lineTrajectoryIndices.at(lineIdx))
+                .hierarchyLevels.at(int(lineHierarchyType));
+        sortedLineIndices.at(lineIdx) = uint32_t(lineIdx);
+    }
+    std::stable_sort(
+            sortedLineIndices.begin(), sortedLineIndices.end(), [&lineLevels](uint32_t idx0, uint32_t idx1) {
+                return lineLevels.at(idx0) > lineLevels.at(idx1);
+            });
+
+    LineHierarchyDrawRange drawRange;
+    drawRange.psIdx = loadedPsIndices.at(i);
+    drawRange.indexOffset = uint32_t(lineIndices.size());
+    lineIndices.reserve(lineIndices.size() + lineData.lineIndices.size());
+    for (uint32_t lineIdx : sortedLineIndices) {
+        // All previous lines have one segment less than they have vertices (@see computeLinePreprocessedData).
+        size_t segmentOffset = (size_t(lineData.lineVertexOffsets.at(lineIdx)) - lineIdx) * 2;
+        size_t numLineIndices = (size_t(lineData.lineNumVertices.at(lineIdx)) - 1) * 2;
+        for (size_t idx = segmentOffset; idx < segmentOffset + numLineIndices; idx++) {
+            lineIndices.push_back(vertexOffset + lineData.lineIndices.at(idx));
+        }
+
+        float level = lineLevels.at(lineIdx);
+        uint32_t indexEnd = uint32_t(lineIndices.size()) - drawRange.indexOffset;
+        if (drawRange.levels.empty() || drawRange.levels.back() != level) {
+            drawRange.levels.push_back(level);
+            drawRange.levelIndexEnds.push_back(indexEnd);
+        } else {
+            drawRange.levelIndexEnds.back() = indexEnd;
+        }
+    }
+    lineHierarchyDrawRanges.push_back(std::move(drawRange));
+}
+
+void LineDataStress::drawLines(sgl::ShaderAttributesPtr& shaderAttributes, const sgl::CameraPtr& camera) {
+    // With transparency, all lines are rendered and the hierarchy level is mapped to the opacity.
+    // Meshlets contain lines of all hierarchy levels (the gather shaders discard the lines above the slider value).
+    if (!useLineHierarchy || rendererSupportsTransparency || lineHierarchyDrawRanges.empty()
+            || getUseMeshletDrawing()) {
+        LineData::drawLines(shaderAttributes, camera);
+        return;
+    }
+
+    std::vector<LineIndexRange> visibleRanges;
+    for (const LineHierarchyDrawRange& drawRange : lineHierarchyDrawRanges) {
+        // Same test as in the gather shaders (lines with a level below 1 - slider value are discarded).
+        float minLevel = 1.0f - lineHierarchySliderValues[drawRange.psIdx];
+        uint32_t numIndices = drawRange.getNumIndices(minLevel);
+        if (numIndices > 0) {
+            visibleRanges.push_back(LineIndexRange(drawRange.indexOffset, numIndices));
+        }
+    }
+
+    std::vector<LineIndexRange> culledRanges;
+    if (cullLines(camera, culledRanges, &visibleRanges)) {
+        drawLineIndexRanges(shaderAttributes, culledRanges);
+    } else {
+        drawLineIndexRanges(shaderAttributes, visibleRanges);
+    }
+}
+
 TubeRenderData LineDataStress::getTubeRenderData() {
     rebuildInternalRepresentationIfNecessary();
+    lineHierarchyDrawRanges.clear();
     TubeRenderData tubeRenderData;
 
     std::vector<uint32_t> lineIndices;
@@ -995,8 +1436,11 @@ TubeRenderData LineDataStress::getTubeRenderData() {
     std::vector<uint32_t> vertexPrincipalStressIndices;
     std::vector<float> vertexLineHierarchyLevels;
     std::vector<uint32_t> vertexLineAppearanceOrders;
+    std::vector<float> vertexSimplificationErrors;
+    std::vector<LineMeshlet> meshlets;
+    std::vector<uint16_t> meshletLocalIndices;
 
-    std::vector<std::vector<std::vector<glm::vec3>>> *bandPointsListRightPs;
+    std::vector<std::vector<std::vector<glm::vec3>>> *bandPointsListRightPs = nullptr;
     if (useBands()) {
         if (useSmoothedBands) {
             bandPointsListRightPs = &bandPointsSmoothedListRightPs;
@@ -1011,232 +1455,91 @@ TubeRenderData LineDataStress::getTubeRenderData() {
             continue;
         }
 
-        Trajectories& trajectories = trajectoriesPs.at(i);
-        StressTrajectoriesData& stressTrajectoriesData = stressTrajectoriesDataPs.at(i);
-
-        std::vector<std::vector<glm::vec3>> lineCentersList;
-        std::vector<std::vector<float>> lineAttributesList;
+        const LinePreprocessedData& lineData = getLinePreprocessedDataPs(i);
+        if (useMeshletCulling) {
+            appendLineMeshlets(
+                    linePreprocessingCachesPs.at(i).getMeshletData(MESHLET_MAX_NUM_VERTICES),
+                    uint32_t(vertexPositions.size()), meshlets, meshletLocalIndices);
+        }
+        appendLineIndicesPs(i, lineData, uint32_t(vertexPositions.size()), lineIndices);
+        vertexPositions.insert(
+                vertexPositions.end(), lineData.vertexPositions.begin(), lineData.vertexPositions.end());
+        vertexTangents.insert(
+                vertexTangents.end(), lineData.vertexTangents.begin(), lineData.vertexTangents.end());
+        lineData.appendVertexAttributes(trajectoriesPs.at(i), selectedAttributeIndex, vertexAttributes);
 
         if (useBands() && psUseBands.at(psIdx)) {
-            std::vector<std::vector<glm::vec3>> bandRightVectorList;
+            // The normals of bands are orthogonal to the band plane.
             std::vector<std::vector<glm::vec3>>& bandPointsListRight = bandPointsListRightPs->at(i);
-
-            lineCentersList.resize(trajectories.size());
-            lineAttributesList.resize(trajectories.size());
-            bandRightVectorList.resize(trajectories.size());
-            std::vector<bool>& filteredTrajectories = filteredTrajectoriesPs.at(i);
-            for (size_t trajectoryIdx = 0; trajectoryIdx < trajectories.size(); trajectoryIdx++) {
-                if (!filteredTrajectories.empty() && filteredTrajectories.at(trajectoryIdx)) {
-                    continue;
-                }
-
-                Trajectory& trajectory = trajectories.at(trajectoryIdx);
-                StressTrajectoryData& stressTrajectoryData = stressTrajectoriesData.at(trajectoryIdx);
-                std::vector<float>& attributes = trajectory.attributes.at(selectedAttributeIndex);
-                std::vector<glm::vec3>& bandPointsRight = bandPointsListRight.at(trajectoryIdx);
-                assert(attributes.size() == trajectory.positions.size());
-                std::vector<glm::vec3>& lineCenters = lineCentersList.at(trajectoryIdx);
-                std::vector<float>& lineAttributes = lineAttributesList.at(trajectoryIdx);
-                std::vector<glm::vec3>& bandRightVectors = bandRightVectorList.at(trajectoryIdx);
-                for (size_t i = 0; i < trajectory.positions.size(); i++) {
-                    lineCenters.push_back(trajectory.positions.at(i));
-                    lineAttributes.push_back(attributes.at(i));
-                    bandRightVectors.push_back(bandPointsRight.at(i));
+            for (size_t lineIdx = 0; lineIdx < lineData.getNumLines(); lineIdx++) {
+                const std::vector<glm::vec3>& bandPointsRight = bandPointsListRight.at(
+                        lineData.lineTrajectoryIndices.at(lineIdx));
+                uint32_t vertexStart = lineData.lineVertexOffsets.at(lineIdx);
+                uint32_t vertexEnd = vertexStart + lineData.lineNumVertices.at(lineIdx);
+                for (uint32_t vertexIdx = vertexStart; vertexIdx < vertexEnd; vertexIdx++) {
+                    vertexNormals.push_back(glm::cross(
+                            bandPointsRight.at(lineData.vertexPointIndices.at(vertexIdx)),
+                            lineData.vertexTangents.at(vertexIdx)));
                 }
             }
-
-            size_t numVerticesOld = vertexPositions.size();
-
-            for (size_t lineId = 0; lineId < lineCentersList.size(); lineId++) {
-                const std::vector<glm::vec3> &lineCenters = lineCentersList.at(lineId);
-                const std::vector<float> &lineAttributes = lineAttributesList.at(lineId);
-                const std::vector<glm::vec3> &bandRightVectors = bandRightVectorList.at(lineId);
-                StressTrajectoryData& stressTrajectoryData = stressTrajectoriesData.at(lineId);
-                assert(lineCenters.size() == lineAttributes.size());
-                size_t n = lineCenters.size();
-                size_t indexOffset = vertexPositions.size();
-
-                if (n < 2) {
-                    continue;
-                }
-
-                glm::vec3 lastLineNormal(1.0f, 0.0f, 0.0f);
-                int numValidLinePoints = 0;
-                for (size_t i = 0; i < n; i++) {
-                    glm::vec3 tangent, normal;
-                    if (i == 0) {
-                        tangent = lineCenters[i+1] - lineCenters[i];
-                    } else if (i == n - 1) {
-                        tangent = lineCenters[i] - lineCenters[i-1];
-                    } else {
-                        tangent = (lineCenters[i+1] - lineCenters[i-1]);
-                    }
-                    float lineSegmentLength = glm::length(tangent);
-
-                    if (lineSegmentLength < 0.0001f) {
-                        // In case the two vertices are almost identical, just skip this path line segment
-                        continue;
-                    }
-                    tangent = glm::normalize(tangent);
-
-                    normal = glm::cross(bandRightVectors.at(i), tangent);
-
-                    vertexPositions.push_back(lineCenters.at(i));
-                    vertexNormals.push_back(normal);
-                    vertexTangents.push_back(tangent);
-                    vertexAttributes.push_back(lineAttributes.at(i));
-                    if (hasLineHierarchy) {
-                        vertexLineHierarchyLevels.push_back(
-                                stressTrajectoryData.hierarchyLevels.at(int(lineHierarchyType)));
-                    }
-                    vertexLineAppearanceOrders.push_back(stressTrajectoryData.appearanceOrder);
-                    numValidLinePoints++;
-                }
-
-                if (numValidLinePoints == 1) {
-                    // Only one vertex left -> Output nothing (tube consisting only of one point).
-                    vertexPositions.pop_back();
-                    vertexNormals.pop_back();
-                    vertexTangents.pop_back();
-                    vertexAttributes.pop_back();
-                    vertexLineHierarchyLevels.pop_back();
-                    vertexLineAppearanceOrders.pop_back();
-                    continue;
-                }
-
-                // Create indices
-                for (int i = 0; i < numValidLinePoints-1; i++) {
-                    lineIndices.push_back(indexOffset + i);
-                    lineIndices.push_back(indexOffset + i + 1);
-                }
-            }
-
-            size_t numVerticesAdded = vertexPositions.size() - numVerticesOld;
-            for (size_t i = 0; i < numVerticesAdded; i++) {
-                vertexPrincipalStressIndices.push_back(psIdx);
-            }
         } else {
-            // Compute all tangents.
-            lineCentersList.resize(trajectories.size());
-            lineAttributesList.resize(trajectories.size());
-            std::vector<bool>& filteredTrajectories = filteredTrajectoriesPs.at(i);
-            for (size_t trajectoryIdx = 0; trajectoryIdx < trajectories.size(); trajectoryIdx++) {
-                if (!filteredTrajectories.empty() && filteredTrajectories.at(trajectoryIdx)) {
-                    continue;
-                }
-
-                Trajectory& trajectory = trajectories.at(trajectoryIdx);
-                StressTrajectoryData& stressTrajectoryData = stressTrajectoriesData.at(trajectoryIdx);
-                std::vector<float>& attributes = trajectory.attributes.at(selectedAttributeIndex);
-                assert(attributes.size() == trajectory.positions.size());
-                std::vector<glm::vec3>& lineCenters = lineCentersList.at(trajectoryIdx);
-                std::vector<float>& lineAttributes = lineAttributesList.at(trajectoryIdx);
-                for (size_t i = 0; i < trajectory.positions.size(); i++) {
-                    lineCenters.push_back(trajectory.positions.at(i));
-                    lineAttributes.push_back(attributes.at(i));
-                }
-            }
-
-            size_t numVerticesOld = vertexPositions.size();
-            std::vector<uint32_t> validLineIndices;
-            std::vector<uint32_t> numValidLineVertices;
-            createLineTubesRenderDataCPU(
-                    lineCentersList, lineAttributesList,
-                    lineIndices, vertexPositions, vertexNormals, vertexTangents, vertexAttributes,
-                    validLineIndices, numValidLineVertices);
-            for (size_t idx = 0; idx < validLineIndices.size(); idx++) {
-                uint32_t trajectoryIdx = validLineIndices.at(idx);
-                uint32_t numValidPoints = numValidLineVertices.at(idx);
-                StressTrajectoryData& stressTrajectoryData = stressTrajectoriesData.at(trajectoryIdx);
-                if (hasLineHierarchy) {
-                    for (uint32_t counter = 0; counter < numValidPoints; counter++) {
-                        vertexLineHierarchyLevels.push_back(
-                                stressTrajectoryData.hierarchyLevels.at(int(lineHierarchyType)));
-                    }
-                }
-                for (uint32_t counter = 0; counter < numValidPoints; counter++) {
-                    vertexLineAppearanceOrders.push_back(stressTrajectoryData.appearanceOrder);
-                }
-            }
-            size_t numVerticesAdded = vertexPositions.size() - numVerticesOld;
-            for (size_t i = 0; i < numVerticesAdded; i++) {
-                vertexPrincipalStressIndices.push_back(psIdx);
-            }
+            vertexNormals.insert(
+                    vertexNormals.end(), lineData.vertexNormals.begin(), lineData.vertexNormals.end());
         }
-    }
 
-    if (useBands()) {
-        for (size_t i = 0; i < trajectoriesPs.size(); i++) {
-            // 1. Compute all tangents.
-            std::vector<std::vector<glm::vec3>> lineCentersList;
-            std::vector<std::vector<float>> lineAttributesList;
-
-        }
-    } else {
-        for (size_t i = 0; i < trajectoriesPs.size(); i++) {
-            int psIdx = loadedPsIndices.at(i);
-            if (!usedPsDirections.at(psIdx)) {
-                continue;
-            }
-
-            Trajectories& trajectories = trajectoriesPs.at(i);
-            StressTrajectoriesData& stressTrajectoriesData = stressTrajectoriesDataPs.at(i);
-
-        }
+        vertexPrincipalStressIndices.resize(vertexPositions.size(), uint32_t(psIdx));
+        appendLineHierarchyDataPs(i, lineData, vertexLineHierarchyLevels, &vertexLineAppearanceOrders);
+        appendVertexSimplificationErrorsPs(i, vertexSimplificationErrors);
     }
 
+    rebuildLineChunkBvh(lineIndices, vertexPositions, &vertexSimplificationErrors);
 
     // Add the index buffer.
-    tubeRenderData.indexBuffer = sgl::Renderer->createGeometryBuffer(
-            lineIndices.size()*sizeof(uint32_t), lineIndices.data(), sgl::INDEX_BUFFER);
+    tubeRenderData.indexBuffer = createRenderDataBuffer(std::move(lineIndices), sgl::INDEX_BUFFER);
 
     // Add the position buffer.
-    tubeRenderData.vertexPositionBuffer = sgl::Renderer->createGeometryBuffer(
-            vertexPositions.size()*sizeof(glm::vec3), vertexPositions.data(), sgl::VERTEX_BUFFER);
+    tubeRenderData.vertexPositionBuffer = createRenderDataBuffer(std::move(vertexPositions), sgl::VERTEX_BUFFER);
 
     // Add the attribute buffer.
-    tubeRenderData.vertexAttributeBuffer = sgl::Renderer->createGeometryBuffer(
-            vertexAttributes.size()*sizeof(float), vertexAttributes.data(), sgl::VERTEX_BUFFER);
+    tubeRenderData.vertexAttributeBuffer = createRenderDataBuffer(std::move(vertexAttributes), sgl::VERTEX_BUFFER);
 
     // Add the normal buffer.
-    tubeRenderData.vertexNormalBuffer = sgl::Renderer->createGeometryBuffer(
-            vertexNormals.size()*sizeof(glm::vec3), vertexNormals.data(), sgl::VERTEX_BUFFER);
+    tubeRenderData.vertexNormalBuffer = createRenderDataBuffer(std::move(vertexNormals), sgl::VERTEX_BUFFER);
 
     // Add the tangent buffer.
-    tubeRenderData.vertexTangentBuffer = sgl::Renderer->createGeometryBuffer(
-            vertexTangents.size()*sizeof(glm::vec3), vertexTangents.data(), sgl::VERTEX_BUFFER);
+    tubeRenderData.vertexTangentBuffer = createRenderDataBuffer(std::move(vertexTangents), sgl::VERTEX_BUFFER);
 
     // Add the principal stress index buffer.
-    tubeRenderData.vertexPrincipalStressIndexBuffer = sgl::Renderer->createGeometryBuffer(
-            vertexPrincipalStressIndices.size()*sizeof(uint32_t),
-            vertexPrincipalStressIndices.data(), sgl::VERTEX_BUFFER);
+    tubeRenderData.vertexPrincipalStressIndexBuffer = createRenderDataBuffer(
+            std::move(vertexPrincipalStressIndices), sgl::VERTEX_BUFFER);
 
     if (hasLineHierarchy) {
         // Add the line hierarchy level buffer.
-        tubeRenderData.vertexLineHierarchyLevelBuffer = sgl::Renderer->createGeometryBuffer(
-                vertexLineHierarchyLevels.size()*sizeof(float),
-                vertexLineHierarchyLevels.data(), sgl::VERTEX_BUFFER);
+        tubeRenderData.vertexLineHierarchyLevelBuffer = createRenderDataBuffer(
+                std::move(vertexLineHierarchyLevels), sgl::VERTEX_BUFFER);
     }
 
     // Add the line appearance order buffer.
-    tubeRenderData.vertexLineAppearanceOrderBuffer = sgl::Renderer->createGeometryBuffer(
-            vertexLineAppearanceOrders.size()*sizeof(uint32_t),
-            vertexLineAppearanceOrders.data(), sgl::VERTEX_BUFFER);
+    tubeRenderData.vertexLineAppearanceOrderBuffer = createRenderDataBuffer(
+            std::move(vertexLineAppearanceOrders), sgl::VERTEX_BUFFER);
+
+    if (useMeshletCulling) {
+        setTubeRenderDataMeshlets(tubeRenderData, meshlets, meshletLocalIndices);
+    }
 
     return tubeRenderData;
 }
 
 TubeRenderDataProgrammableFetch LineDataStress::getTubeRenderDataProgrammableFetch() {
     rebuildInternalRepresentationIfNecessary();
+    lineHierarchyDrawRanges.clear();
     TubeRenderDataProgrammableFetch tubeRenderData;
 
     std::vector<uint32_t> lineIndices;
-    std::vector<glm::vec3> vertexPositions;
-    std::vector<glm::vec3> vertexNormals;
-    std::vector<glm::vec3> vertexTangents;
+    std::vector<LinePointDataProgrammableFetch> linePointData;
     std::vector<float> vertexAttributes;
-    std::vector<uint32_t> vertexPrincipalStressIndices;
     std::vector<float> vertexLineHierarchyLevels;
+    std::vector<float> vertexSimplificationErrors;
 
     for (size_t i = 0; i < trajectoriesPs.size(); i++) {
         int psIdx = loadedPsIndices.at(i);
@@ -1244,56 +1547,34 @@ TubeRenderDataProgrammableFetch LineDataStress::getTubeRenderDataProgrammableFet
             continue;
         }
 
-        Trajectories& trajectories = trajectoriesPs.at(i);
-        StressTrajectoriesData& stressTrajectoriesData = stressTrajectoriesDataPs.at(i);
-
-        // 1. Compute all tangents.
-        std::vector<std::vector<glm::vec3>> lineCentersList;
-        std::vector<std::vector<float>> lineAttributesList;
-
-        lineCentersList.resize(trajectories.size());
-        lineAttributesList.resize(trajectories.size());
-        std::vector<bool>& filteredTrajectories = filteredTrajectoriesPs.at(i);
-        for (size_t trajectoryIdx = 0; trajectoryIdx < trajectories.size(); trajectoryIdx++) {
-            if (!filteredTrajectories.empty() && filteredTrajectories.at(trajectoryIdx)) {
-                continue;
-            }
+        // 1. Get the (cached) line centers and tangents.
+        const LinePreprocessedData& lineData = getLinePreprocessedDataPs(i);
+        size_t vertexOffset = linePointData.size();
+        appendLineIndicesPs(i, lineData, uint32_t(vertexOffset), lineIndices);
+        vertexAttributes.clear();
+        lineData.appendVertexAttributes(trajectoriesPs.at(i), selectedAttributeIndex, vertexAttributes);
 
-            Trajectory& trajectory = trajectories.at(trajectoryIdx);
-            StressTrajectoryData& stressTrajectoryData = stressTrajectoriesData.at(trajectoryIdx);
-            std::vector<float>& attributes = trajectory.attributes.at(selectedAttributeIndex);
-            assert(attributes.size() == trajectory.positions.size());
-            std::vector<glm::vec3>& lineCenters = lineCentersList.at(trajectoryIdx);
-            std::vector<float>& lineAttributes = lineAttributesList.at(trajectoryIdx);
-            for (size_t i = 0; i < trajectory.positions.size(); i++) {
-                lineCenters.push_back(trajectory.positions.at(i));
-                lineAttributes.push_back(attributes.at(i));
-            }
+        linePointData.resize(vertexOffset + lineData.getNumVertices());
+        for (size_t vertexIdx = 0; vertexIdx < lineData.getNumVertices(); vertexIdx++) {
+            LinePointDataProgrammableFetch& linePoint = linePointData.at(vertexOffset + vertexIdx);
+            linePoint.vertexPosition = lineData.vertexPositions.at(vertexIdx);
+            linePoint.vertexAttribute = vertexAttributes.at(vertexIdx);
+            linePoint.vertexTangent = lineData.vertexTangents.at(vertexIdx);
+            linePoint.principalStressIndex = uint32_t(psIdx);
         }
 
+        appendLineHierarchyDataPs(i, lineData, vertexLineHierarchyLevels, nullptr);
+        appendVertexSimplificationErrorsPs(i, vertexSimplificationErrors);
+    }
 
-        size_t numVerticesOld = vertexPositions.size();
-        std::vector<uint32_t> validLineIndices;
-        std::vector<uint32_t> numValidLineVertices;
-        createLineTubesRenderDataCPU(
-                lineCentersList, lineAttributesList,
-                lineIndices, vertexPositions, vertexNormals, vertexTangents, vertexAttributes,
-                validLineIndices, numValidLineVertices);
-        for (size_t idx = 0; idx < validLineIndices.size(); idx++) {
-            uint32_t trajectoryIdx = validLineIndices.at(idx);
-            uint32_t numValidPoints = numValidLineVertices.at(idx);
-            StressTrajectoryData& stressTrajectoryData = stressTrajectoriesData.at(trajectoryIdx);
-            if (hasLineHierarchy) {
-                for (uint32_t counter = 0; counter < numValidPoints; counter++) {
-                    vertexLineHierarchyLevels.push_back(
-                            stressTrajectoryData.hierarchyLevels.at(int(lineHierarchyType)));
-                }
-            }
-        }
-        size_t numVerticesAdded = vertexPositions.size() - numVerticesOld;
-        for (size_t i = 0; i < numVerticesAdded; i++) {
-            vertexPrincipalStressIndices.push_back(psIdx);
+    if (getUseLineChunkBvh()) {
+        std::vector<glm::vec3> vertexPositions(linePointData.size());
+        for (size_t vertexIdx = 0; vertexIdx < linePointData.size(); vertexIdx++) {
+            vertexPositions.at(vertexIdx) = linePointData.at(vertexIdx).vertexPosition;
         }
+        rebuildLineChunkBvh(lineIndices, vertexPositions, &vertexSimplificationErrors);
+    } else {
+        lineChunkBvh.clear();
     }
 
     // 2. Construct the triangle topology for programmable fetching.
@@ -1311,28 +1592,15 @@ TubeRenderDataProgrammableFetch LineDataStress::getTubeRenderDataProgrammableFet
         fetchIndices.push_back(base1+1);
         fetchIndices.push_back(base0+1);
     }
-    tubeRenderData.indexBuffer = sgl::Renderer->createGeometryBuffer(
-            sizeof(uint32_t) * fetchIndices.size(), fetchIndices.data(), sgl::INDEX_BUFFER);
+    tubeRenderData.indexBuffer = createRenderDataBuffer(std::move(fetchIndices), sgl::INDEX_BUFFER);
 
     // 3. Add the point data for all line points.
-    std::vector<LinePointDataProgrammableFetch> linePointData;
-    linePointData.resize(vertexPositions.size());
-    for (size_t i = 0; i < vertexPositions.size(); i++) {
-        linePointData.at(i).vertexPosition = vertexPositions.at(i);
-        linePointData.at(i).vertexAttribute = vertexAttributes.at(i);
-        linePointData.at(i).vertexTangent = vertexTangents.at(i);
-        linePointData.at(i).principalStressIndex = vertexPrincipalStressIndices.at(i);
-    }
-
-    tubeRenderData.linePointsBuffer = sgl::Renderer->createGeometryBuffer(
-            linePointData.size() * sizeof(LinePointDataProgrammableFetch), linePointData.data(),
-            sgl::SHADER_STORAGE_BUFFER);
+    tubeRenderData.linePointsBuffer = createRenderDataBuffer(std::move(linePointData), sgl::SHADER_STORAGE_BUFFER);
 
     if (hasLineHierarchy) {
         // Add the line hierarchy level buffer.
-        tubeRenderData.lineHierarchyLevelsBuffer = sgl::Renderer->createGeometryBuffer(
-                vertexLineHierarchyLevels.size()*sizeof(float),
-                vertexLineHierarchyLevels.data(), sgl::SHADER_STORAGE_BUFFER);
+        tubeRenderData.lineHierarchyLevelsBuffer = createRenderDataBuffer(
+                std::move(vertexLineHierarchyLevels), sgl::SHADER_STORAGE_BUFFER);
     }
 
     return tubeRenderData;
@@ -1340,11 +1608,11 @@ TubeRenderDataProgrammableFetch LineDataStress::getTubeRenderDataProgrammableFet
 
 TubeRenderDataOpacityOptimization LineDataStress::getTubeRenderDataOpacityOptimization() {
     rebuildInternalRepresentationIfNecessary();
+    lineHierarchyDrawRanges.clear();
     TubeRenderDataOpacityOptimization tubeRenderData;
 
     std::vector<uint32_t> lineIndices;
     std::vector<glm::vec3> vertexPositions;
-    std::vector<glm::vec3> vertexNormals;
     std::vector<glm::vec3> vertexTangents;
     std::vector<float> vertexAttributes;
     std::vector<uint32_t> vertexPrincipalStressIndices;
@@ -1356,83 +1624,37 @@ TubeRenderDataOpacityOptimization LineDataStress::getTubeRenderDataOpacityOptimi
             continue;
         }
 
-        Trajectories& trajectories = trajectoriesPs.at(i);
-        StressTrajectoriesData& stressTrajectoriesData = stressTrajectoriesDataPs.at(i);
-
-        // 1. Compute all tangents.
-        std::vector<std::vector<glm::vec3>> lineCentersList;
-        std::vector<std::vector<float>> lineAttributesList;
-
-        lineCentersList.resize(trajectories.size());
-        lineAttributesList.resize(trajectories.size());
-        std::vector<bool>& filteredTrajectories = filteredTrajectoriesPs.at(i);
-        for (size_t trajectoryIdx = 0; trajectoryIdx < trajectories.size(); trajectoryIdx++) {
-            if (!filteredTrajectories.empty() && filteredTrajectories.at(trajectoryIdx)) {
-                continue;
-            }
-
-            Trajectory& trajectory = trajectories.at(trajectoryIdx);
-            StressTrajectoryData& stressTrajectoryData = stressTrajectoriesData.at(trajectoryIdx);
-            std::vector<float>& attributes = trajectory.attributes.at(selectedAttributeIndex);
-            assert(attributes.size() == trajectory.positions.size());
-            std::vector<glm::vec3>& lineCenters = lineCentersList.at(trajectoryIdx);
-            std::vector<float>& lineAttributes = lineAttributesList.at(trajectoryIdx);
-            for (size_t i = 0; i < trajectory.positions.size(); i++) {
-                lineCenters.push_back(trajectory.positions.at(i));
-                lineAttributes.push_back(attributes.at(i));
-            }
-        }
-
-        size_t numVerticesOld = vertexPositions.size();
-        std::vector<uint32_t> validLineIndices;
-        std::vector<uint32_t> numValidLineVertices;
-        createLineTubesRenderDataCPU(
-                lineCentersList, lineAttributesList,
-                lineIndices, vertexPositions, vertexNormals, vertexTangents, vertexAttributes,
-                validLineIndices, numValidLineVertices);
-        for (size_t idx = 0; idx < validLineIndices.size(); idx++) {
-            uint32_t trajectoryIdx = validLineIndices.at(idx);
-            uint32_t numValidPoints = numValidLineVertices.at(idx);
-            StressTrajectoryData& stressTrajectoryData = stressTrajectoriesData.at(trajectoryIdx);
-            if (hasLineHierarchy) {
-                for (uint32_t counter = 0; counter < numValidPoints; counter++) {
-                    vertexLineHierarchyLevels.push_back(
-                            stressTrajectoryData.hierarchyLevels.at(int(lineHierarchyType)));
-                }
-            }
-        }
-        size_t numVerticesAdded = vertexPositions.size() - numVerticesOld;
-        for (size_t i = 0; i < numVerticesAdded; i++) {
-            vertexPrincipalStressIndices.push_back(psIdx);
-        }
+        const LinePreprocessedData& lineData = getLinePreprocessedDataPs(i);
+        appendLineIndicesPs(i, lineData, uint32_t(vertexPositions.size()), lineIndices);
+        vertexPositions.insert(
+                vertexPositions.end(), lineData.vertexPositions.begin(), lineData.vertexPositions.end());
+        vertexTangents.insert(
+                vertexTangents.end(), lineData.vertexTangents.begin(), lineData.vertexTangents.end());
+        lineData.appendVertexAttributes(trajectoriesPs.at(i), selectedAttributeIndex, vertexAttributes);
+        vertexPrincipalStressIndices.resize(vertexPositions.size(), uint32_t(psIdx));
+        appendLineHierarchyDataPs(i, lineData, vertexLineHierarchyLevels, nullptr);
     }
 
     // Add the index buffer.
-    tubeRenderData.indexBuffer = sgl::Renderer->createGeometryBuffer(
-            lineIndices.size()*sizeof(uint32_t), lineIndices.data(), sgl::INDEX_BUFFER);
+    tubeRenderData.indexBuffer = createRenderDataBuffer(std::move(lineIndices), sgl::INDEX_BUFFER);
 
     // Add the position buffer.
-    tubeRenderData.vertexPositionBuffer = sgl::Renderer->createGeometryBuffer(
-            vertexPositions.size()*sizeof(glm::vec3), vertexPositions.data(), sgl::VERTEX_BUFFER);
+    tubeRenderData.vertexPositionBuffer = createRenderDataBuffer(std::move(vertexPositions), sgl::VERTEX_BUFFER);
 
     // Add the attribute buffer.
-    tubeRenderData.vertexAttributeBuffer = sgl::Renderer->createGeometryBuffer(
-            vertexAttributes.size()*sizeof(float), vertexAttributes.data(), sgl::VERTEX_BUFFER);
+    tubeRenderData.vertexAttributeBuffer = createRenderDataBuffer(std::move(vertexAttributes), sgl::VERTEX_BUFFER);
 
     // Add the tangent buffer.
-    tubeRenderData.vertexTangentBuffer = sgl::Renderer->createGeometryBuffer(
-            vertexTangents.size()*sizeof(glm::vec3), vertexTangents.data(), sgl::VERTEX_BUFFER);
+    tubeRenderData.vertexTangentBuffer = createRenderDataBuffer(std::move(vertexTangents), sgl::VERTEX_BUFFER);
 
     // Add the principal stress index buffer.
-    tubeRenderData.vertexPrincipalStressIndexBuffer = sgl::Renderer->createGeometryBuffer(
-            vertexPrincipalStressIndices.size()*sizeof(uint32_t),
-            vertexPrincipalStressIndices.data(), sgl::VERTEX_BUFFER);
+    tubeRenderData.vertexPrincipalStressIndexBuffer = createRenderDataBuffer(
+            std::move(vertexPrincipalStressIndices), sgl::VERTEX_BUFFER);
 
     if (hasLineHierarchy) {
         // Add the line hierarchy level buffer.
-        tubeRenderData.vertexLineHierarchyLevelBuffer = sgl::Renderer->createGeometryBuffer(
-                vertexLineHierarchyLevels.size()*sizeof(float),
-                vertexLineHierarchyLevels.data(), sgl::VERTEX_BUFFER);
+        tubeRenderData.vertexLineHierarchyLevelBuffer = createRenderDataBuffer(
+                std::move(vertexLineHierarchyLevels), sgl::VERTEX_BUFFER);
     }
 
     return tubeRenderData;
@@ -1448,6 +1670,7 @@ PointRenderData LineDataStress::getDegeneratePointsRenderData() {
 
 BandRenderData LineDataStress::getBandRenderData() {
     rebuildInternalRepresentationIfNecessary();
+    lineHierarchyDrawRanges.clear();
     BandRenderData bandRenderData;
 
     std::vector<uint32_t> lineIndices;
@@ -1457,9 +1680,21 @@ BandRenderData LineDataStress::getBandRenderData() {
     std::vector<glm::vec3> vertexTangents;
     std::vector<glm::vec3> vertexOffsetsLeft;
     std::vector<glm::vec3> vertexOffsetsRight;
+    std::vector<float> vertexRadiusScales;
     std::vector<uint32_t> vertexPrincipalStressIndices;
     std::vector<float> vertexLineHierarchyLevels;
     std::vector<uint32_t> vertexLineAppearanceOrders;
+    std::vector<float> vertexSimplificationErrors;
+
+    std::vector<std::vector<std::vector<glm::vec3>>>* bandPointsListLeftPs;
+    std::vector<std::vector<std::vector<glm::vec3>>>* bandPointsListRightPs;
+    if (useSmoothedBands) {
+        bandPointsListLeftPs = &bandPointsSmoothedListLeftPs;
+        bandPointsListRightPs = &bandPointsSmoothedListRightPs;
+    } else {
+        bandPointsListLeftPs = &bandPointsUnsmoothedListLeftPs;
+        bandPointsListRightPs = &bandPointsUnsmoothedListRightPs;
+    }
 
     for (size_t i = 0; i < trajectoriesPs.size(); i++) {
         int psIdx = loadedPsIndices.at(i);
@@ -1467,189 +1702,89 @@ BandRenderData LineDataStress::getBandRenderData() {
             continue;
         }
 
-        Trajectories& trajectories = trajectoriesPs.at(i);
-        StressTrajectoriesData& stressTrajectoriesData = stressTrajectoriesDataPs.at(i);
+        const LinePreprocessedData& lineData = getLinePreprocessedDataPs(i);
+        appendLineIndicesPs(i, lineData, uint32_t(vertexPositions.size()), lineIndices);
+        vertexPositions.insert(
+                vertexPositions.end(), lineData.vertexPositions.begin(), lineData.vertexPositions.end());
+        vertexTangents.insert(
+                vertexTangents.end(), lineData.vertexTangents.begin(), lineData.vertexTangents.end());
+        lineData.appendVertexAttributes(trajectoriesPs.at(i), selectedAttributeIndex, vertexAttributes);
 
         if (psUseBands.at(psIdx)) {
-            std::vector<std::vector<std::vector<glm::vec3>>>* bandPointsListLeftPs;
-            std::vector<std::vector<std::vector<glm::vec3>>>* bandPointsListRightPs;
-            if (useSmoothedBands) {
-                bandPointsListLeftPs = &bandPointsSmoothedListLeftPs;
-                bandPointsListRightPs = &bandPointsSmoothedListRightPs;
-            } else {
-                bandPointsListLeftPs = &bandPointsUnsmoothedListLeftPs;
-                bandPointsListRightPs = &bandPointsUnsmoothedListRightPs;
-            }
             std::vector<std::vector<glm::vec3>>& bandPointsListLeft = bandPointsListLeftPs->at(i);
             std::vector<std::vector<glm::vec3>>& bandPointsListRight = bandPointsListRightPs->at(i);
-
-            std::vector<bool>& filteredTrajectories = filteredTrajectoriesPs.at(i);
-            for (size_t trajectoryIdx = 0; trajectoryIdx < trajectories.size(); trajectoryIdx++) {
-                if (!filteredTrajectories.empty() && filteredTrajectories.at(trajectoryIdx)) {
-                    continue;
-                }
-
-                Trajectory& trajectory = trajectories.at(trajectoryIdx);
-                StressTrajectoryData& stressTrajectoryData = stressTrajectoriesData.at(trajectoryIdx);
-                std::vector<float>& attributes = trajectory.attributes.at(selectedAttributeIndex);
-                std::vector<glm::vec3>& bandPointsLeft = bandPointsListLeft.at(trajectoryIdx);
-                std::vector<glm::vec3>& bandPointsRight = bandPointsListRight.at(trajectoryIdx);
-                assert(attributes.size() == trajectory.positions.size());
-                assert(attributes.size() == bandPointsLeft.size());
-                assert(attributes.size() == bandPointsRight.size());
-
-                if (trajectory.positions.size() < 2) {
-                    continue;
-                }
-
-                size_t indexStart = vertexPositions.size();
-                int n = int(trajectory.positions.size());
-                int numValidLinePoints = 0;
-                for (size_t i = 0; i < trajectory.positions.size(); i++) {
-                    vertexPositions.push_back(trajectory.positions.at(i));
-                    vertexOffsetsLeft.push_back(bandPointsLeft.at(i));
-                    vertexOffsetsRight.push_back(bandPointsRight.at(i));
-
-                    glm::vec3 vertexTangent;
-                    if (i == 0) {
-                        vertexTangent = trajectory.positions[i+1] - trajectory.positions[i];
-                    } else if (i == n - 1) {
-                        vertexTangent = trajectory.positions[i] - trajectory.positions[i-1];
-                    } else {
-                        vertexTangent = trajectory.positions[i+1] - trajectory.positions[i-1];
+            for (size_t lineIdx = 0; lineIdx < lineData.getNumLines(); lineIdx++) {
+                uint32_t trajectoryIdx = lineData.lineTrajectoryIndices.at(lineIdx);
+                const std::vector<glm::vec3>& bandPointsLeft = bandPointsListLeft.at(trajectoryIdx);
+                const std::vector<glm::vec3>& bandPointsRight = bandPointsListRight.at(trajectoryIdx);
+                uint32_t vertexStart = lineData.lineVertexOffsets.at(lineIdx);
+                uint32_t vertexEnd = vertexStart + lineData.lineNumVertices.at(lineIdx);
+                for (uint32_t vertexIdx = vertexStart; vertexIdx < vertexEnd; vertexIdx++) {
+                    uint32_t pointIdx = lineData.vertexPointIndices.at(vertexIdx);
+                    const glm::vec3& bandPointLeft = bandPointsLeft.at(pointIdx);
+                    const glm::vec3& bandPointRight = bandPointsRight.at(pointIdx);
+                    vertexOffsetsLeft.push_back(bandPointLeft);
+                    vertexOffsetsRight.push_back(bandPointRight);
+                    if (getUseLineChunkBvh()) {
+                        vertexRadiusScales.push_back(std::max(
+                                1.0f, std::max(glm::length(bandPointLeft), glm::length(bandPointRight))));
                     }
-                    vertexTangent = glm::normalize(vertexTangent);
-                    vertexTangents.push_back(vertexTangent);
-
-                    glm::vec3 vertexNormal = glm::normalize(glm::cross(
-                            vertexTangent, bandPointsRight.at(i) - bandPointsLeft.at(i)));
-                    vertexNormals.push_back(vertexNormal);
-
-                    vertexAttributes.push_back(attributes.at(i));
-                    vertexPrincipalStressIndices.push_back(psIdx);
-                    if (hasLineHierarchy) {
-                        vertexLineHierarchyLevels.push_back(
-                                stressTrajectoryData.hierarchyLevels.at(int(lineHierarchyType)));
-                    }
-                    vertexLineAppearanceOrders.push_back(stressTrajectoryData.appearanceOrder);
-                    numValidLinePoints++;
-                }
-
-                if (numValidLinePoints == 1) {
-                    // Only one vertex left -> Output nothing (tube consisting only of one point).
-                    vertexPositions.pop_back();
-                    vertexNormals.pop_back();
-                    vertexTangents.pop_back();
-                    vertexAttributes.pop_back();
-                    vertexLineHierarchyLevels.pop_back();
-                    vertexLineAppearanceOrders.pop_back();
-                    continue;
-                }
-
-                for (int i = 0; i < numValidLinePoints-1; i++) {
-                    lineIndices.push_back(indexStart + i);
-                    lineIndices.push_back(indexStart + i + 1);
+                    vertexNormals.push_back(glm::normalize(glm::cross(
+                            lineData.vertexTangents.at(vertexIdx), bandPointRight - bandPointLeft)));
                 }
             }
         } else {
-            // 1. Compute all tangents.
-            std::vector<std::vector<glm::vec3>> lineCentersList;
-            std::vector<std::vector<float>> lineAttributesList;
-
-            lineCentersList.resize(trajectories.size());
-            lineAttributesList.resize(trajectories.size());
-            std::vector<bool>& filteredTrajectories = filteredTrajectoriesPs.at(i);
-            for (size_t trajectoryIdx = 0; trajectoryIdx < trajectories.size(); trajectoryIdx++) {
-                if (!filteredTrajectories.empty() && filteredTrajectories.at(trajectoryIdx)) {
-                    continue;
-                }
-
-                Trajectory& trajectory = trajectories.at(trajectoryIdx);
-                StressTrajectoryData& stressTrajectoryData = stressTrajectoriesData.at(trajectoryIdx);
-                std::vector<float>& attributes = trajectory.attributes.at(selectedAttributeIndex);
-                assert(attributes.size() == trajectory.positions.size());
-                std::vector<glm::vec3>& lineCenters = lineCentersList.at(trajectoryIdx);
-                std::vector<float>& lineAttributes = lineAttributesList.at(trajectoryIdx);
-                for (size_t i = 0; i < trajectory.positions.size(); i++) {
-                    lineCenters.push_back(trajectory.positions.at(i));
-                    lineAttributes.push_back(attributes.at(i));
-                }
-            }
-
-            size_t numVerticesOld = vertexPositions.size();
-            std::vector<uint32_t> validLineIndices;
-            std::vector<uint32_t> numValidLineVertices;
-            createLineTubesRenderDataCPU(
-                    lineCentersList, lineAttributesList,
-                    lineIndices, vertexPositions, vertexNormals, vertexTangents, vertexAttributes,
-                    validLineIndices, numValidLineVertices);
-            for (size_t idx = 0; idx < validLineIndices.size(); idx++) {
-                uint32_t trajectoryIdx = validLineIndices.at(idx);
-                uint32_t numValidPoints = numValidLineVertices.at(idx);
-                StressTrajectoryData& stressTrajectoryData = stressTrajectoriesData.at(trajectoryIdx);
-                if (hasLineHierarchy) {
-                    for (uint32_t counter = 0; counter < numValidPoints; counter++) {
-                        vertexLineHierarchyLevels.push_back(
-                                stressTrajectoryData.hierarchyLevels.at(int(lineHierarchyType)));
-                    }
-                }
-                for (uint32_t counter = 0; counter < numValidPoints; counter++) {
-                    vertexLineAppearanceOrders.push_back(stressTrajectoryData.appearanceOrder);
-                }
-            }
-            size_t numVerticesAdded = vertexPositions.size() - numVerticesOld;
-            for (size_t i = 0; i < numVerticesAdded; i++) {
-                vertexPrincipalStressIndices.push_back(psIdx);
-                vertexOffsetsLeft.push_back(glm::vec3(0.0f));
-                vertexOffsetsRight.push_back(glm::vec3(0.0f));
+            vertexNormals.insert(
+                    vertexNormals.end(), lineData.vertexNormals.begin(), lineData.vertexNormals.end());
+            vertexOffsetsLeft.resize(vertexPositions.size(), glm::vec3(0.0f));
+            vertexOffsetsRight.resize(vertexPositions.size(), glm::vec3(0.0f));
+            if (getUseLineChunkBvh()) {
+                vertexRadiusScales.resize(vertexPositions.size(), 1.0f);
             }
         }
+
+        vertexPrincipalStressIndices.resize(vertexPositions.size(), uint32_t(psIdx));
+        appendLineHierarchyDataPs(i, lineData, vertexLineHierarchyLevels, &vertexLineAppearanceOrders);
+        appendVertexSimplificationErrorsPs(i, vertexSimplificationErrors);
     }
 
+    // The bands extend by the band width times the length of their offset vectors from the line centers.
+    rebuildLineChunkBvh(lineIndices, vertexPositions, &vertexSimplificationErrors, &vertexRadiusScales);
+
     // Add the index buffer.
-    bandRenderData.indexBuffer = sgl::Renderer->createGeometryBuffer(
-            lineIndices.size()*sizeof(uint32_t), lineIndices.data(), sgl::INDEX_BUFFER);
+    bandRenderData.indexBuffer = createRenderDataBuffer(std::move(lineIndices), sgl::INDEX_BUFFER);
 
     // Add the position buffer.
-    bandRenderData.vertexPositionBuffer = sgl::Renderer->createGeometryBuffer(
-            vertexPositions.size()*sizeof(glm::vec3), vertexPositions.data(), sgl::VERTEX_BUFFER);
+    bandRenderData.vertexPositionBuffer = createRenderDataBuffer(std::move(vertexPositions), sgl::VERTEX_BUFFER);
 
     // Add the attribute buffer.
-    bandRenderData.vertexAttributeBuffer = sgl::Renderer->createGeometryBuffer(
-            vertexAttributes.size()*sizeof(float), vertexAttributes.data(), sgl::VERTEX_BUFFER);
+    bandRenderData.vertexAttributeBuffer = createRenderDataBuffer(std::move(vertexAttributes), sgl::VERTEX_BUFFER);
 
     // Add the normal buffer.
-    bandRenderData.vertexNormalBuffer = sgl::Renderer->createGeometryBuffer(
-            vertexNormals.size()*sizeof(glm::vec3), vertexNormals.data(), sgl::VERTEX_BUFFER);
+    bandRenderData.vertexNormalBuffer = createRenderDataBuffer(std::move(vertexNormals), sgl::VERTEX_BUFFER);
 
     // Add the tangent buffer.
-    bandRenderData.vertexTangentBuffer = sgl::Renderer->createGeometryBuffer(
-            vertexTangents.size()*sizeof(glm::vec3), vertexTangents.data(), sgl::VERTEX_BUFFER);
+    bandRenderData.vertexTangentBuffer = createRenderDataBuffer(std::move(vertexTangents), sgl::VERTEX_BUFFER);
 
     // Add the left vertex offset buffer.
-    bandRenderData.vertexOffsetLeftBuffer = sgl::Renderer->createGeometryBuffer(
-            vertexOffsetsLeft.size()*sizeof(glm::vec3), vertexOffsetsLeft.data(), sgl::VERTEX_BUFFER);
+    bandRenderData.vertexOffsetLeftBuffer = createRenderDataBuffer(std::move(vertexOffsetsLeft), sgl::VERTEX_BUFFER);
 
     // Add the right vertex offset buffer.
-    bandRenderData.vertexOffsetRightBuffer = sgl::Renderer->createGeometryBuffer(
-            vertexOffsetsRight.size()*sizeof(glm::vec3), vertexOffsetsRight.data(), sgl::VERTEX_BUFFER);
+    bandRenderData.vertexOffsetRightBuffer = createRenderDataBuffer(std::move(vertexOffsetsRight), sgl::VERTEX_BUFFER);
 
     // Add the principal stress index buffer.
-    bandRenderData.vertexPrincipalStressIndexBuffer = sgl::Renderer->createGeometryBuffer(
-            vertexPrincipalStressIndices.size()*sizeof(uint32_t),
-            vertexPrincipalStressIndices.data(), sgl::VERTEX_BUFFER);
+    bandRenderData.vertexPrincipalStressIndexBuffer = createRenderDataBuffer(
+            std::move(vertexPrincipalStressIndices), sgl::VERTEX_BUFFER);
 
     if (hasLineHierarchy) {
         // Add the line hierarchy level buffer.
-        bandRenderData.vertexLineHierarchyLevelBuffer = sgl::Renderer->createGeometryBuffer(
-                vertexLineHierarchyLevels.size()*sizeof(float),
-                vertexLineHierarchyLevels.data(), sgl::VERTEX_BUFFER);
+        bandRenderData.vertexLineHierarchyLevelBuffer = createRenderDataBuffer(
+                std::move(vertexLineHierarchyLevels), sgl::VERTEX_BUFFER);
     }
 
     // Add the line appearance order buffer.
-    bandRenderData.vertexLineAppearanceOrderBuffer = sgl::Renderer->createGeometryBuffer(
-            vertexLineAppearanceOrders.size()*sizeof(uint32_t),
-            vertexLineAppearanceOrders.data(), sgl::VERTEX_BUFFER);
+    bandRenderData.vertexLineAppearanceOrderBuffer = createRenderDataBuffer(
+            std::move(vertexLineAppearanceOrders), sgl::VERTEX_BUFFER);
 
     return bandRenderData;
 }
@@ -1661,6 +1796,9 @@ sgl::ShaderAttributesPtr LineDataStress::getGatherShaderAttributes(sgl::ShaderPr
         BandRenderData tubeRenderData = this->getBandRenderData();
         linePointDataSSBO = sgl::GeometryBufferPtr();
         lineHierarchyLevelsSSBO = sgl::GeometryBufferPtr();
+        lineDrawMode = GL_LINES;
+        numDrawIndicesPerLineIndex = 1;
+        setGatherShaderMeshlets(nullptr);
 
         shaderAttributes = sgl::ShaderManager->createShaderAttributes(gatherShader);
 
@@ -1704,6 +1842,10 @@ sgl::ShaderAttributesPtr LineDataStress::getGatherShaderAttributes(sgl::ShaderPr
         TubeRenderDataProgrammableFetch tubeRenderData = this->getTubeRenderDataProgrammableFetch();
         linePointDataSSBO = tubeRenderData.linePointsBuffer;
         lineHierarchyLevelsSSBO = tubeRenderData.lineHierarchyLevelsBuffer;
+        // Each line segment is rendered as two triangles (i.e., six indices per two line segment indices).
+        lineDrawMode = GL_TRIANGLES;
+        numDrawIndicesPerLineIndex = 3;
+        setGatherShaderMeshlets(nullptr);
 
         shaderAttributes = sgl::ShaderManager->createShaderAttributes(gatherShader);
         shaderAttributes->setVertexMode(sgl::VERTEX_MODE_TRIANGLES);
@@ -1712,6 +1854,9 @@ sgl::ShaderAttributesPtr LineDataStress::getGatherShaderAttributes(sgl::ShaderPr
         TubeRenderData tubeRenderData = this->getTubeRenderData();
         linePointDataSSBO = sgl::GeometryBufferPtr();
         lineHierarchyLevelsSSBO = sgl::GeometryBufferPtr();
+        lineDrawMode = GL_LINES;
+        numDrawIndicesPerLineIndex = 1;
+        setGatherShaderMeshlets(&tubeRenderData);
 
         shaderAttributes = sgl::ShaderManager->createShaderAttributes(gatherShader);
 
@@ -1751,6 +1896,24 @@ sgl::ShaderAttributesPtr LineDataStress::getGatherShaderAttributes(sgl::ShaderPr
     return shaderAttributes;
 }
 
+void LineDataStress::keepPreviousDrawState() {
+    LineData::keepPreviousDrawState();
+    previousLineHierarchyDrawRanges = lineHierarchyDrawRanges;
+    previousLineHierarchyLevelsSSBO = lineHierarchyLevelsSSBO;
+}
+
+void LineDataStress::swapPreviousDrawState() {
+    LineData::swapPreviousDrawState();
+    std::swap(lineHierarchyDrawRanges, previousLineHierarchyDrawRanges);
+    std::swap(lineHierarchyLevelsSSBO, previousLineHierarchyLevelsSSBO);
+}
+
+void LineDataStress::releasePreviousDrawState() {
+    LineData::releasePreviousDrawState();
+    previousLineHierarchyDrawRanges.clear();
+    previousLineHierarchyLevelsSSBO = sgl::GeometryBufferPtr();
+}
+
 void LineDataStress::setUniformGatherShaderData_AllPasses() {
     LineData::setUniformGatherShaderData_AllPasses();
     if (useLineHierarchy && linePrimitiveMode == LINE_PRIMITIVES_RIBBON_PROGRAMMABLE_FETCH) {
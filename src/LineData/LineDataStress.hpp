@@ -30,8 +30,13 @@
 #define STRESSLINEVIS_LINEDATASTRESS_HPP
 
 #include <array>
+#include <memory>
+#include <thread>
+#include <atomic>
 
 #include "LineData.hpp"
+#include "LinePreprocessingCache.hpp"
+#include "Stress/StressTensorProbe.hpp"
 #include "Widgets/StressLineHierarchyMappingWidget.hpp"
 #include "Widgets/MultiVarTransferFunctionWindow.hpp"
 
@@ -41,6 +46,22 @@
 //};
 //const int NUM_DISTANCE_MEASURES = ((int)(sizeof(DISTANCE_MEASURES)/sizeof(*DISTANCE_MEASURES)));
 
+class FlatKdTree;
+
+/**
+ * The line segment indices of one principal stress direction sorted by decreasing line hierarchy level. The lines
+ * visible for a hierarchy slider value form a prefix of the index range, so only this prefix needs to be drawn.
+ */
+struct LineHierarchyDrawRange {
+    int psIdx = 0;
+    uint32_t indexOffset = 0; ///< Offset of the range in the line segment index list.
+    std::vector<float> levels; ///< The distinct line hierarchy levels in decreasing order.
+    std::vector<uint32_t> levelIndexEnds; ///< Number of indices of all lines with a hierarchy level >= levels[k].
+
+    /// @return The number of indices of all lines with a hierarchy level >= minLevel.
+    uint32_t getNumIndices(float minLevel) const;
+};
+
 class LineDataStress : public LineData {
 public:
     LineDataStress(sgl::TransferFunctionWindow &transferFunctionWindow);
@@ -63,6 +84,15 @@ public:
             const std::vector<std::string>& fileNames, DataSetInformation dataSetInformation,
             glm::mat4* transformationMatrixPtr) override;
 
+    /**
+     * Appends the lines of a further batch of a streamed line tracer reply to the data loaded from the first batch.
+     * The lines are normalized like the loaded data. Only the value ranges of the attributes are updated, so
+     * @see recomputeHistogram needs to be called by the main thread after the last batch.
+     * @param memoryData The lines traced since the previous batch.
+     * @return Whether the batch could be appended.
+     */
+    bool appendStreamedLines(const StressTrajectoriesMemoryData& memoryData);
+
     void setStressTrajectoryData(
             const std::vector<Trajectories>& trajectoriesPs,
             const std::vector<StressTrajectoriesData>& stressTrajectoriesDataPs);
@@ -89,16 +119,17 @@ public:
 
     // Get filtered line data (only containing points also shown when rendering).
     virtual Trajectories filterTrajectoryData() override;
-    virtual std::vector<std::vector<glm::vec3>> getFilteredLines() override;
+    virtual FilteredLinesView getFilteredLinesView() override;
     std::vector<Trajectories> filterTrajectoryPsData();
-    /// Principal stress direction -> Line set index -> Point on line index.
-    std::vector<std::vector<std::vector<glm::vec3>>> getFilteredPrincipalStressLines();
 
     // --- Retrieve data for rendering. Preferred way. ---
     virtual sgl::ShaderProgramPtr reloadGatherShader() override;
     virtual sgl::ShaderAttributesPtr getGatherShaderAttributes(sgl::ShaderProgramPtr& gatherShader);
     virtual void setUniformGatherShaderData_AllPasses();
     virtual void setUniformGatherShaderData_Pass(sgl::ShaderProgramPtr& gatherShader);
+    virtual void keepPreviousDrawState() override;
+    virtual void swapPreviousDrawState() override;
+    virtual void releasePreviousDrawState() override;
 
     // --- Retrieve data for rendering. ---
     virtual TubeRenderData getTubeRenderData() override;
@@ -106,6 +137,7 @@ public:
     virtual TubeRenderDataOpacityOptimization getTubeRenderDataOpacityOptimization() override;
     PointRenderData getDegeneratePointsRenderData();
     virtual BandRenderData getBandRenderData() override;
+    virtual void drawLines(sgl::ShaderAttributesPtr& shaderAttributes, const sgl::CameraPtr& camera) override;
 
     /**
      * For selecting options for the rendering technique (e.g., screen-oriented bands, tubes).
@@ -150,11 +182,60 @@ public:
     inline void setCurrentSeedIdx(int currentSeedIdx) { this->currentSeedIdx = currentSeedIdx; }
     inline const glm::vec3& getCurrentSeedPosition() const { return seedPoints.at(currentSeedIdx); }
 
+    /**
+     * Probes the stress tensor of the simulation mesh (@see StressTensorProbe). The mesh and its per-vertex tensors
+     * are loaded on a worker thread on first use.
+     * @param rayOrigin The origin of the ray (e.g., through the mouse cursor) in world space.
+     * @param rayDirection The normalized direction of the ray in world space.
+     * @param probePosition If not nullptr, the tensor is probed at this world space position (e.g., the hit position
+     * of a picked line). Otherwise, it is probed where the ray enters the simulation mesh.
+     * @param result The probed tensor. Like the tensor itself, the position and the principal stress directions are
+     * given in the coordinate system of the simulation mesh.
+     * @return False if no tensor could be probed (e.g., if the mesh is still loading, has no stress tensors or was not
+     * hit).
+     */
+    bool probeStressTensor(
+            const glm::vec3& rayOrigin, const glm::vec3& rayDirection, const glm::vec3* probePosition,
+            StressTensorProbeResult& result);
+    /// Renders the passed probed stress tensor as a tooltip at the mouse cursor.
+    void renderGuiStressTensorProbeTooltip(const StressTensorProbeResult& result);
+
 private:
     virtual void recomputeHistogram() override;
     virtual void recomputeColorLegend() override;
+    virtual void getPickedLineMetadata(
+            uint32_t lineIdx, uint32_t segmentIdx, float t, LinePickingResult& result) override;
+    virtual bool getIsLineVisible(uint32_t lineIdx) override;
+    /**
+     * Maps a line index of the filtered lines view (@see getFilteredLinesView) to the loaded line set it belongs to.
+     * @param lineIdx The line index in the filtered lines view. Afterwards, the index of the line in its line set.
+     * @return The index of the loaded principal stress line set.
+     */
+    size_t getFilteredLineSetIndex(uint32_t& lineIdx);
     void recomputeColorLegendPositions();
 
+    /// Returns the (cached) filtered line geometry of the loaded principal stress line set with index i.
+    const LinePreprocessedData& getLinePreprocessedDataPs(size_t i);
+    /**
+     * Appends the per-vertex line hierarchy level and (if not nullptr) line appearance order of the passed filtered
+     * line geometry of the loaded principal stress line set with index i.
+     */
+    void appendLineHierarchyDataPs(
+            size_t i, const LinePreprocessedData& lineData, std::vector<float>& vertexLineHierarchyLevels,
+            std::vector<uint32_t>* vertexLineAppearanceOrders);
+    /**
+     * Appends the per-vertex simplification errors of the filtered line geometry of the loaded principal stress line
+     * set with index i (only if the level of detail is used; @see LineData::rebuildLineChunkBvh).
+     */
+    void appendVertexSimplificationErrorsPs(size_t i, std::vector<float>& vertexSimplificationErrors);
+    /**
+     * Appends the line segment indices of the passed filtered line geometry of the loaded principal stress line set
+     * with index i. If the data has a line hierarchy, the lines are sorted by decreasing hierarchy level and a draw
+     * range is added to @see lineHierarchyDrawRanges.
+     */
+    void appendLineIndicesPs(
+            size_t i, const LinePreprocessedData& lineData, uint32_t vertexOffset, std::vector<uint32_t>& lineIndices);
+
     // Should we show major, medium and/or minor principal stress lines?
     static bool useMajorPS, useMediumPS, useMinorPS;
     /// Should we use the principal direction ID for rendering?
@@ -167,8 +248,18 @@ private:
     std::vector<glm::vec3> degeneratePoints;
     std::vector<bool> usedPsDirections; ///< What principal stress (PS) directions do we want to display?
     std::vector<std::vector<bool>> filteredTrajectoriesPs;
+    std::vector<LinePreprocessingCache> linePreprocessingCachesPs; ///< Filtered line geometry per line set.
+    /// Line set -> attribute. Histograms for the multi-variate transfer function window (empty until first used).
+    std::vector<std::vector<AttributeHistogram>> attributeHistogramsPs;
+    /// Builds the histograms of the passed attribute for all line sets that do not have one yet.
+    void buildAttributeHistograms(size_t attrIdx);
     std::vector<glm::vec2> minMaxAttributeValuesPs[3];
     int fileFormatVersion = 0;
+    MeshType meshType = MeshType::CARTESIAN;
+    /// The normalization of the loaded data (@see normalizeVertexPositions) that appended lines need to match.
+    sgl::AABB3 normalizationAABB;
+    glm::mat4 normalizationTransform = glm::mat4(1.0f);
+    bool hasNormalizationTransform = false;
     // If optional band data is provided:
     bool hasBandsData = false;
     std::vector<std::vector<std::vector<glm::vec3>>> bandPointsUnsmoothedListLeftPs, bandPointsUnsmoothedListRightPs;
@@ -189,6 +280,39 @@ private:
     };
     static LineHierarchyType lineHierarchyType;
     static glm::vec3 lineHierarchySliderValues;
+    /// Draw ranges of the last created render data (in units of line segment indices).
+    std::vector<LineHierarchyDrawRange> lineHierarchyDrawRanges;
+    // The line hierarchy data of the previous render data (@see keepPreviousDrawState).
+    std::vector<LineHierarchyDrawRange> previousLineHierarchyDrawRanges;
+    sgl::GeometryBufferPtr previousLineHierarchyLevelsSSBO;
+
+    // Distances of the line points to the degenerate points.
+    /**
+     * Computes the distances of the line points to the closest degenerate point using a distance field
+     * (@see PointDistanceField). The grid is refined until the maximum error of the kernel values, which is sampled
+     * using the exact distances found by the passed k-d-tree, lies below degeneratePointsDistanceFieldMaxError.
+     */
+    void computeDegeneratePointDistancesFromField(
+            const FlatKdTree& kdTree, const std::vector<glm::vec3>& linePoints, float lengthScale,
+            std::vector<float>& distances);
+    /// Whether to use a distance field instead of exact queries for the degenerate point distance attributes.
+    static bool useDegeneratePointsDistanceField;
+    static float degeneratePointsDistanceFieldMaxError;
+
+    // Probing of the stress tensor of the simulation mesh (@see probeStressTensor).
+    /**
+     * Loading the mesh and building its cell grid may take seconds for large meshes, so it is done on a worker thread
+     * when the stress tensor is probed for the first time.
+     */
+    void startLoadingStressTensorProbe();
+    void joinStressTensorProbeLoaderThread();
+    std::string simulationMeshFilename;
+    std::unique_ptr<StressTensorProbe> stressTensorProbe; ///< Only set by the loader thread if loading succeeded.
+    std::thread stressTensorProbeLoaderThread;
+    bool isStressTensorProbeLoading = false; ///< Loading is only attempted once per data set.
+    std::atomic<bool> isStressTensorProbeReady; ///< Set by the loader thread after setting stressTensorProbe.
+    glm::mat4 meshToWorldMatrix = glm::mat4(1.0f); ///< The normalization applied to the loaded data.
+    glm::mat4 worldToMeshMatrix = glm::mat4(1.0f);
 
     // The seed process can be rendered for the video.
     bool shallRenderSeedingProcess = false;
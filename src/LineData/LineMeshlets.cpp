@@ -0,0 +1,294 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+#include <cmath>
+
+#include "LinePreprocessingCache.hpp"
+#include "LineMeshlets.hpp"
+
+namespace {
+
+/// A part of a line with at most maxNumVertices vertices.
+struct LinePiece {
+    uint32_t vertexStart;
+    uint32_t numVertices;
+    glm::vec3 aabbMin;
+    glm::vec3 aabbMax;
+};
+
+/// Range of pieces merged into one meshlet.
+struct MeshletPieceRange {
+    uint32_t pieceBegin;
+    uint32_t pieceEnd;
+};
+
+inline float getAabbDiagonal(const glm::vec3& aabbMin, const glm::vec3& aabbMax) {
+    return glm::length(aabbMax - aabbMin);
+}
+
+/// Number of consecutive lines whose pieces are merged independently of other lines (@see buildLineMeshlets).
+const size_t NUM_LINES_PER_MERGE_BLOCK = 256;
+
+/**
+ * Greedily merges consecutive pieces as long as the vertex budget allows it and the pieces are close.
+ * @param pieces All line pieces.
+ * @param pieceBegin The first piece to merge.
+ * @param pieceEnd The end of the piece range to merge.
+ * @param maxNumVertices The maximum number of vertices per meshlet.
+ * @param meshletPieceRanges The output piece ranges of the merged meshlets.
+ */
+void mergeLinePieces(
+        const std::vector<LinePiece>& pieces, uint32_t pieceBegin, uint32_t pieceEnd, uint32_t maxNumVertices,
+        std::vector<MeshletPieceRange>& meshletPieceRanges) {
+    uint32_t pieceIdx = pieceBegin;
+    while (pieceIdx < pieceEnd) {
+        MeshletPieceRange pieceRange;
+        pieceRange.pieceBegin = pieceIdx;
+        const uint32_t vertexStart = pieces.at(pieceIdx).vertexStart;
+        glm::vec3 aabbMin = pieces.at(pieceIdx).aabbMin;
+        glm::vec3 aabbMax = pieces.at(pieceIdx).aabbMax;
+        pieceIdx++;
+        while (pieceIdx < pieceEnd) {
+            const LinePiece& piece = pieces.at(pieceIdx);
+            if (piece.vertexStart + piece.numVertices - vertexStart > maxNumVertices) {
+                break;
+            }
+            // Only merge if the merged cluster is not much larger than its parts.
+            glm::vec3 mergedAabbMin = glm::min(aabbMin, piece.aabbMin);
+            glm::vec3 mergedAabbMax = glm::max(aabbMax, piece.aabbMax);
+            float maxPartDiagonal = std::max(
+                    getAabbDiagonal(aabbMin, aabbMax), getAabbDiagonal(piece.aabbMin, piece.aabbMax));
+            if (getAabbDiagonal(mergedAabbMin, mergedAabbMax) > 2.0f * maxPartDiagonal) {
+                break;
+            }
+            aabbMin = mergedAabbMin;
+            aabbMax = mergedAabbMax;
+            pieceIdx++;
+        }
+        pieceRange.pieceEnd = pieceIdx;
+        meshletPieceRanges.push_back(pieceRange);
+    }
+}
+
+}
+
+void buildLineMeshlets(
+        const LinePreprocessedData& lineData, uint32_t maxNumVertices, LineMeshletData& meshletData) {
+    meshletData = LineMeshletData();
+    maxNumVertices = std::max(std::min(maxNumVertices, uint32_t(65536)), uint32_t(2));
+    const uint32_t maxNumSegments = maxNumVertices - 1;
+    const size_t numLines = lineData.getNumLines();
+
+    // 1. Split the lines into balanced pieces of at most maxNumVertices vertices.
+    std::vector<uint32_t> linePieceOffsets(numLines + 1, 0);
+    for (size_t lineIdx = 0; lineIdx < numLines; lineIdx++) {
+        uint32_t numSegments = lineData.lineNumVertices.at(lineIdx) - 1;
+        uint32_t numLinePieces = (numSegments + maxNumSegments - 1) / maxNumSegments;
+        linePieceOffsets.at(lineIdx + 1) = linePieceOffsets.at(lineIdx) + numLinePieces;
+    }
+    const uint32_t numPieces = linePieceOffsets.back();
+    std::vector<LinePiece> pieces(numPieces);
+
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(lineData, linePieceOffsets, pieces, numLines) default(none)
+#endif
+    for (size_t lineIdx = 0; lineIdx < numLines; lineIdx++) {
+        const uint32_t numSegments = lineData.lineNumVertices.at(lineIdx) - 1;
+        const uint32_t linePieceOffset = linePieceOffsets.at(lineIdx);
+        const uint32_t numLinePieces = linePieceOffsets.at(lineIdx + 1) - linePieceOffset;
+        for (uint32_t linePieceIdx = 0; linePieceIdx < numLinePieces; linePieceIdx++) {
+            uint32_t segmentStart = uint32_t(uint64_t(linePieceIdx) * numSegments / numLinePieces);
+            uint32_t segmentEnd = uint32_t(uint64_t(linePieceIdx + 1) * numSegments / numLinePieces);
+            LinePiece& piece = pieces.at(linePieceOffset + linePieceIdx);
+            piece.vertexStart = lineData.lineVertexOffsets.at(lineIdx) + segmentStart;
+            piece.numVertices = segmentEnd - segmentStart + 1;
+            piece.aabbMin = glm::vec3(std::numeric_limits<float>::max());
+            piece.aabbMax = glm::vec3(std::numeric_limits<float>::lowest());
+            for (uint32_t vertexIdx = piece.vertexStart; vertexIdx < piece.vertexStart + piece.numVertices;
+                    vertexIdx++) {
+                const glm::vec3& vertexPosition = lineData.vertexPositions.at(vertexIdx);
+                piece.aabbMin = glm::min(piece.aabbMin, vertexPosition);
+                piece.aabbMax = glm::max(piece.aabbMax, vertexPosition);
+            }
+        }
+    }
+
+    // 2. Merge the pieces of blocks of consecutive lines in parallel. The blocks do not depend on the thread count.
+    const size_t numMergeBlocks = (numLines + NUM_LINES_PER_MERGE_BLOCK - 1) / NUM_LINES_PER_MERGE_BLOCK;
+    std::vector<std::vector<MeshletPieceRange>> blockMeshletPieceRanges(numMergeBlocks);
+#if _OPENMP >= 201107
+    #pragma omp parallel for default(none) schedule(dynamic) \
+            shared(pieces, linePieceOffsets, blockMeshletPieceRanges, maxNumVertices, numLines, numMergeBlocks)
+#endif
+    for (size_t blockIdx = 0; blockIdx < numMergeBlocks; blockIdx++) {
+        size_t lineBegin = blockIdx * NUM_LINES_PER_MERGE_BLOCK;
+        size_t lineEnd = std::min(lineBegin + NUM_LINES_PER_MERGE_BLOCK, numLines);
+        mergeLinePieces(
+                pieces, linePieceOffsets.at(lineBegin), linePieceOffsets.at(lineEnd), maxNumVertices,
+                blockMeshletPieceRanges.at(blockIdx));
+    }
+    std::vector<MeshletPieceRange> meshletPieceRanges;
+    for (const std::vector<MeshletPieceRange>& pieceRanges : blockMeshletPieceRanges) {
+        meshletPieceRanges.insert(meshletPieceRanges.end(), pieceRanges.begin(), pieceRanges.end());
+    }
+
+    // 3. Compute the vertex and index ranges of all meshlets.
+    const size_t numMeshlets = meshletPieceRanges.size();
+    meshletData.meshlets.resize(numMeshlets);
+    uint32_t numIndices = 0;
+    for (size_t meshletIdx = 0; meshletIdx < numMeshlets; meshletIdx++) {
+        const MeshletPieceRange& pieceRange = meshletPieceRanges.at(meshletIdx);
+        const LinePiece& firstPiece = pieces.at(pieceRange.pieceBegin);
+        const LinePiece& lastPiece = pieces.at(pieceRange.pieceEnd - 1);
+        LineMeshlet& meshlet = meshletData.meshlets.at(meshletIdx);
+        meshlet.vertexOffset = firstPiece.vertexStart;
+        meshlet.numVertices = lastPiece.vertexStart + lastPiece.numVertices - firstPiece.vertexStart;
+        meshlet.indexOffset = numIndices;
+        meshlet.numIndices = 0;
+        for (uint32_t i = pieceRange.pieceBegin; i < pieceRange.pieceEnd; i++) {
+            meshlet.numIndices += (pieces.at(i).numVertices - 1) * 2;
+        }
+        numIndices += meshlet.numIndices;
+    }
+    meshletData.localIndices.resize(numIndices);
+
+    // 4. Write the local indices and compute the bounding volumes.
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(lineData, meshletData, meshletPieceRanges, pieces, numMeshlets) default(none)
+#endif
+    for (size_t meshletIdx = 0; meshletIdx < numMeshlets; meshletIdx++) {
+        const MeshletPieceRange& pieceRange = meshletPieceRanges.at(meshletIdx);
+        LineMeshlet& meshlet = meshletData.meshlets.at(meshletIdx);
+
+        uint32_t writeIdx = meshlet.indexOffset;
+        glm::vec3 aabbMin(std::numeric_limits<float>::max());
+        glm::vec3 aabbMax(std::numeric_limits<float>::lowest());
+        for (uint32_t i = pieceRange.pieceBegin; i < pieceRange.pieceEnd; i++) {
+            const LinePiece& piece = pieces.at(i);
+            uint16_t localVertexStart = uint16_t(piece.vertexStart - meshlet.vertexOffset);
+            for (uint32_t j = 0; j + 1 < piece.numVertices; j++) {
+                meshletData.localIndices.at(writeIdx++) = uint16_t(localVertexStart + j);
+                meshletData.localIndices.at(writeIdx++) = uint16_t(localVertexStart + j + 1);
+            }
+            aabbMin = glm::min(aabbMin, piece.aabbMin);
+            aabbMax = glm::max(aabbMax, piece.aabbMax);
+        }
+
+        // Bounding sphere around the center of the bounding box.
+        glm::vec3 center = (aabbMin + aabbMax) * 0.5f;
+        float radiusSquared = 0.0f;
+        glm::vec3 tangentSum(0.0f);
+        for (uint32_t vertexIdx = meshlet.vertexOffset; vertexIdx < meshlet.vertexOffset + meshlet.numVertices;
+                vertexIdx++) {
+            glm::vec3 diff = lineData.vertexPositions.at(vertexIdx) - center;
+            radiusSquared = std::max(radiusSquared, glm::dot(diff, diff));
+            tangentSum += lineData.vertexTangents.at(vertexIdx);
+        }
+        meshlet.boundingSphereCenter = center;
+        meshlet.boundingSphereRadius = std::sqrt(radiusSquared);
+
+        // Cone bounding all line directions.
+        float tangentSumLength = glm::length(tangentSum);
+        if (tangentSumLength < 1e-6f) {
+            meshlet.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+            meshlet.coneCutoff = -1.0f;
+        } else {
+            meshlet.coneAxis = tangentSum / tangentSumLength;
+            meshlet.coneCutoff = 1.0f;
+            for (uint32_t vertexIdx = meshlet.vertexOffset; vertexIdx < meshlet.vertexOffset + meshlet.numVertices;
+                    vertexIdx++) {
+                meshlet.coneCutoff = std::min(
+                        meshlet.coneCutoff, glm::dot(meshlet.coneAxis, lineData.vertexTangents.at(vertexIdx)));
+            }
+        }
+    }
+}
+
+void appendLineMeshlets(
+        const LineMeshletData& meshletData, uint32_t vertexOffset,
+        std::vector<LineMeshlet>& meshletsOut, std::vector<uint16_t>& localIndicesOut) {
+    const uint32_t indexOffset = uint32_t(localIndicesOut.size());
+    meshletsOut.reserve(meshletsOut.size() + meshletData.meshlets.size());
+    for (const LineMeshlet& meshlet : meshletData.meshlets) {
+        LineMeshlet meshletOut = meshlet;
+        meshletOut.vertexOffset += vertexOffset;
+        meshletOut.indexOffset += indexOffset;
+        meshletsOut.push_back(meshletOut);
+    }
+    localIndicesOut.insert(localIndicesOut.end(), meshletData.localIndices.begin(), meshletData.localIndices.end());
+}
+
+void cullLineMeshlets(
+        const std::vector<LineMeshlet>& meshlets, const ViewFrustum& frustum,
+        std::vector<uint32_t>& visibleMeshletIndices, LineCullingStatistics* statistics, float lineRadius) {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    visibleMeshletIndices.clear();
+    size_t numIndices = 0;
+    size_t numVisibleIndices = 0;
+    for (size_t meshletIdx = 0; meshletIdx < meshlets.size(); meshletIdx++) {
+        const LineMeshlet& meshlet = meshlets.at(meshletIdx);
+        numIndices += meshlet.numIndices;
+        if (frustum.intersectSphere(meshlet.boundingSphereCenter, meshlet.boundingSphereRadius + lineRadius)
+                != ViewFrustum::OUTSIDE) {
+            visibleMeshletIndices.push_back(uint32_t(meshletIdx));
+            numVisibleIndices += meshlet.numIndices;
+        }
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+
+    if (statistics) {
+        statistics->cullingTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+        statistics->numChunks = meshlets.size();
+        statistics->numVisibleChunks = visibleMeshletIndices.size();
+        statistics->numIndices = numIndices;
+        statistics->numVisibleIndices = numVisibleIndices;
+        statistics->numDrawRanges = visibleMeshletIndices.size();
+    }
+}
+
+LineMeshletStatistics computeLineMeshletStatistics(
+        const std::vector<LineMeshlet>& meshlets, uint32_t maxNumVertices) {
+    LineMeshletStatistics statistics;
+    statistics.numMeshlets = meshlets.size();
+    size_t numIndices = 0;
+    double fillRateSum = 0.0;
+    for (const LineMeshlet& meshlet : meshlets) {
+        numIndices += meshlet.numIndices;
+        fillRateSum += double(meshlet.numVertices) / double(maxNumVertices);
+    }
+    statistics.numLineSegments = numIndices / 2;
+    if (!meshlets.empty()) {
+        statistics.averageFillRate = float(fillRateSum / double(meshlets.size()));
+    }
+    statistics.indexBytes32 = numIndices * sizeof(uint32_t);
+    statistics.meshletBytes = numIndices * sizeof(uint16_t) + meshlets.size() * sizeof(LineMeshlet);
+    return statistics;
+}
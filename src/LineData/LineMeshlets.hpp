@@ -0,0 +1,111 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LINEVIS_LINEMESHLETS_HPP
+#define LINEVIS_LINEMESHLETS_HPP
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "SearchStructures/LineChunkBvh.hpp"
+
+struct LinePreprocessedData;
+
+/**
+ * A small, spatially coherent cluster of line segments. The vertices of a meshlet are a contiguous range of the vertex
+ * arrays of the render data, so 16-bit indices relative to vertexOffset suffice (e.g., for drawing with
+ * glMultiDrawElementsBaseVertex).
+ */
+struct LineMeshlet {
+    glm::vec3 boundingSphereCenter;
+    float boundingSphereRadius;
+    glm::vec3 coneAxis; ///< Average line direction of the meshlet.
+    float coneCutoff; ///< Cosine of the cone half angle bounding all line directions (-1 if unbounded).
+    uint32_t vertexOffset; ///< Index of the first vertex in the render data vertex arrays.
+    uint32_t numVertices;
+    uint32_t indexOffset; ///< Index of the first local index in the meshlet index array.
+    uint32_t numIndices; ///< Two indices per line segment.
+};
+
+struct LineMeshletData {
+    std::vector<LineMeshlet> meshlets;
+    std::vector<uint16_t> localIndices; ///< Line segment indices relative to the vertex offset of their meshlet.
+};
+
+struct LineMeshletStatistics {
+    size_t numMeshlets = 0;
+    size_t numLineSegments = 0;
+    float averageFillRate = 0.0f; ///< Average ratio of used vertices to the maximum number of vertices per meshlet.
+    size_t indexBytes32 = 0; ///< Size of a global 32-bit index buffer.
+    size_t meshletBytes = 0; ///< Size of the 16-bit index buffer plus the meshlet descriptors.
+};
+
+/**
+ * Clusters the passed line geometry into meshlets.
+ * Each line is split into balanced pieces of at most maxNumVertices vertices (neighboring pieces share one vertex).
+ * Afterwards, consecutive pieces are merged into one meshlet if the vertex budget allows it and if the pieces are
+ * spatially close. Merging is done in parallel for fixed blocks of consecutive lines (meshlets never span two blocks),
+ * so the result does not depend on the number of threads.
+ * @param lineData The filtered line geometry.
+ * @param maxNumVertices The maximum number of vertices per meshlet (at least 2, at most 65536).
+ * @param meshletData The output meshlets.
+ */
+void buildLineMeshlets(
+        const LinePreprocessedData& lineData, uint32_t maxNumVertices, LineMeshletData& meshletData);
+
+/**
+ * Appends the passed meshlets to the output arrays, e.g., when concatenating multiple line sets.
+ * @param vertexOffset The index of the first vertex of the line set in the output vertex arrays.
+ */
+void appendLineMeshlets(
+        const LineMeshletData& meshletData, uint32_t vertexOffset,
+        std::vector<LineMeshlet>& meshletsOut, std::vector<uint16_t>& localIndicesOut);
+
+/**
+ * Culls the passed meshlets against a view frustum using their bounding spheres. The direction cones are not used, as
+ * tubes and screen-oriented ribbons are visible from all view directions.
+ * @param meshlets The meshlets to cull.
+ * @param frustum The view frustum.
+ * @param visibleMeshletIndices The indices of all meshlets intersecting the frustum in ascending order.
+ * @param statistics Optional statistics about the culling pass (may be nullptr). The meshlets are counted as chunks.
+ * @param lineRadius The world space radius of the rendered lines. The bounding spheres only contain the line centers
+ * and are grown by this radius.
+ */
+void cullLineMeshlets(
+        const std::vector<LineMeshlet>& meshlets, const ViewFrustum& frustum,
+        std::vector<uint32_t>& visibleMeshletIndices, LineCullingStatistics* statistics = nullptr,
+        float lineRadius = 0.0f);
+
+/**
+ * Computes statistics about the passed meshlets (e.g., for logging).
+ */
+LineMeshletStatistics computeLineMeshletStatistics(
+        const std::vector<LineMeshlet>& meshlets, uint32_t maxNumVertices);
+
+#endif //LINEVIS_LINEMESHLETS_HPP
@@ -0,0 +1,257 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "MultiVar/BezierTrajectory.hpp"
+#include "LineSimplification.hpp"
+#include "LinePreprocessingCache.hpp"
+
+/**
+ * Computes the (non-normalized) tangent of the line at the passed point using central differences.
+ * Points where the tangent is almost zero are considered degenerate and are skipped when creating the render data.
+ * @param lineCenters The points of the line.
+ * @param i The index of the point.
+ */
+static inline glm::vec3 computeLineTangent(const std::vector<glm::vec3>& lineCenters, size_t i) {
+    const size_t n = lineCenters.size();
+    if (i == 0) {
+        return lineCenters[i+1] - lineCenters[i];
+    } else if (i == n - 1) {
+        return lineCenters[i] - lineCenters[i-1];
+    } else {
+        return lineCenters[i+1] - lineCenters[i-1];
+    }
+}
+
+template<typename T>
+void computeLinePreprocessedData(
+        const std::vector<T>& trajectories, const std::vector<bool>& filteredTrajectories,
+        LinePreprocessedData& data) {
+    data = LinePreprocessedData();
+    const size_t numTrajectories = trajectories.size();
+
+    // 1. Count the number of valid points of each line.
+    std::vector<uint32_t> numValidLinePointsList(numTrajectories, 0);
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(trajectories, filteredTrajectories, numValidLinePointsList, numTrajectories) \
+    default(none)
+#endif
+    for (size_t trajectoryIdx = 0; trajectoryIdx < numTrajectories; trajectoryIdx++) {
+        if (!filteredTrajectories.empty() && filteredTrajectories.at(trajectoryIdx)) {
+            continue;
+        }
+        const std::vector<glm::vec3>& lineCenters = trajectories.at(trajectoryIdx).positions;
+        const size_t n = lineCenters.size();
+        if (n < 2) {
+            continue;
+        }
+
+        uint32_t numValidLinePoints = 0;
+        for (size_t i = 0; i < n; i++) {
+            if (glm::length(computeLineTangent(lineCenters, i)) >= 0.0001f) {
+                numValidLinePoints++;
+            }
+        }
+
+        // Only one vertex left -> Output nothing (tube consisting only of one point).
+        numValidLinePointsList.at(trajectoryIdx) = numValidLinePoints > 1 ? numValidLinePoints : 0;
+    }
+
+    // 2. Compute the vertex offsets of the valid lines (exclusive prefix sum).
+    uint32_t numVertices = 0;
+    for (size_t trajectoryIdx = 0; trajectoryIdx < numTrajectories; trajectoryIdx++) {
+        uint32_t numValidLinePoints = numValidLinePointsList.at(trajectoryIdx);
+        if (numValidLinePoints == 0) {
+            continue;
+        }
+        data.lineTrajectoryIndices.push_back(uint32_t(trajectoryIdx));
+        data.lineVertexOffsets.push_back(numVertices);
+        data.lineNumVertices.push_back(numValidLinePoints);
+        numVertices += numValidLinePoints;
+    }
+    const size_t numLines = data.lineTrajectoryIndices.size();
+    data.vertexPointIndices.resize(numVertices);
+    data.vertexPositions.resize(numVertices);
+    data.vertexTangents.resize(numVertices);
+    data.vertexNormals.resize(numVertices);
+    data.lineIndices.resize((numVertices - numLines) * 2);
+
+    // 3. Compute the tangents and normals of all valid lines.
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(trajectories, data, numLines) default(none)
+#endif
+    for (size_t lineIdx = 0; lineIdx < numLines; lineIdx++) {
+        const std::vector<glm::vec3>& lineCenters = trajectories.at(data.lineTrajectoryIndices.at(lineIdx)).positions;
+        const size_t n = lineCenters.size();
+        const uint32_t vertexOffset = data.lineVertexOffsets.at(lineIdx);
+        uint32_t vertexIdx = vertexOffset;
+
+        glm::vec3 lastLineNormal(1.0f, 0.0f, 0.0f);
+        for (size_t i = 0; i < n; i++) {
+            glm::vec3 tangent = computeLineTangent(lineCenters, i);
+            float lineSegmentLength = glm::length(tangent);
+            if (lineSegmentLength < 0.0001f) {
+                // In case the two vertices are almost identical, just skip this path line segment
+                continue;
+            }
+            tangent = tangent / lineSegmentLength;
+
+            glm::vec3 helperAxis = lastLineNormal;
+            if (glm::length(glm::cross(helperAxis, tangent)) < 0.01f) {
+                // If tangent == lastNormal
+                helperAxis = glm::vec3(0.0f, 1.0f, 0.0f);
+                if (glm::length(glm::cross(helperAxis, tangent)) < 0.01f) {
+                    // If tangent == helperAxis
+                    helperAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+                }
+            }
+            glm::vec3 normal = glm::normalize(helperAxis - tangent * glm::dot(helperAxis, tangent)); // Gram-Schmidt
+            lastLineNormal = normal;
+
+            data.vertexPointIndices.at(vertexIdx) = uint32_t(i);
+            data.vertexPositions.at(vertexIdx) = lineCenters.at(i);
+            data.vertexTangents.at(vertexIdx) = tangent;
+            data.vertexNormals.at(vertexIdx) = normal;
+            vertexIdx++;
+        }
+
+        // Create indices. The line has (numVertices - 1) segments, and all previous lines have one segment less than
+        // they have vertices.
+        size_t segmentOffset = (size_t(vertexOffset) - lineIdx) * 2;
+        const uint32_t numLineVertices = data.lineNumVertices.at(lineIdx);
+        for (uint32_t i = 0; i < numLineVertices - 1; i++) {
+            data.lineIndices.at(segmentOffset + i * 2) = vertexOffset + i;
+            data.lineIndices.at(segmentOffset + i * 2 + 1) = vertexOffset + i + 1;
+        }
+    }
+}
+
+template
+void computeLinePreprocessedData<Trajectory>(
+        const std::vector<Trajectory>& trajectories, const std::vector<bool>& filteredTrajectories,
+        LinePreprocessedData& data);
+
+template
+void computeLinePreprocessedData<BezierTrajectory>(
+        const std::vector<BezierTrajectory>& trajectories, const std::vector<bool>& filteredTrajectories,
+        LinePreprocessedData& data);
+
+
+void LinePreprocessedData::appendVertexAttributes(
+        const Trajectories& trajectories, int attributeIndex, std::vector<float>& vertexAttributes) const {
+    const size_t numLines = lineTrajectoryIndices.size();
+    const size_t attributeOffset = vertexAttributes.size();
+    vertexAttributes.resize(attributeOffset + vertexPositions.size());
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(trajectories, attributeIndex, vertexAttributes, numLines, attributeOffset) \
+    default(none)
+#endif
+    for (size_t lineIdx = 0; lineIdx < numLines; lineIdx++) {
+        const std::vector<float>& attributes =
+                trajectories.at(lineTrajectoryIndices.at(lineIdx)).attributes.at(attributeIndex);
+        const uint32_t vertexOffset = lineVertexOffsets.at(lineIdx);
+        const uint32_t numLineVertices = lineNumVertices.at(lineIdx);
+        for (uint32_t vertexIdx = vertexOffset; vertexIdx < vertexOffset + numLineVertices; vertexIdx++) {
+            vertexAttributes.at(attributeOffset + vertexIdx) = attributes.at(vertexPointIndices.at(vertexIdx));
+        }
+    }
+}
+
+void LinePreprocessedData::appendLineIndices(std::vector<uint32_t>& lineIndicesOut, uint32_t vertexOffset) const {
+    lineIndicesOut.reserve(lineIndicesOut.size() + lineIndices.size());
+    for (uint32_t lineIndex : lineIndices) {
+        lineIndicesOut.push_back(vertexOffset + lineIndex);
+    }
+}
+
+
+const LinePreprocessedData& LinePreprocessingCache::get(
+        const Trajectories& trajectories, const std::vector<bool>& filteredTrajectories) {
+    return *getShared(trajectories, filteredTrajectories);
+}
+
+std::shared_ptr<const LinePreprocessedData> LinePreprocessingCache::getShared(
+        const Trajectories& trajectories, const std::vector<bool>& filteredTrajectories) {
+    if (!isValid || cachedFilteredTrajectories != filteredTrajectories) {
+        // Views of the old data (@see FilteredLinesView) keep it alive, so it must not be overwritten in place.
+        auto newData = std::make_shared<LinePreprocessedData>();
+        computeLinePreprocessedData(trajectories, filteredTrajectories, *newData);
+        data = newData;
+        cachedFilteredTrajectories = filteredTrajectories;
+        isValid = true;
+        isMeshletDataValid = false;
+        isVertexSimplificationErrorDataValid = false;
+    }
+    return data;
+}
+
+const LineMeshletData& LinePreprocessingCache::getMeshletData(uint32_t maxNumVertices) {
+    if (!isMeshletDataValid || meshletMaxNumVertices != maxNumVertices) {
+        buildLineMeshlets(*data, maxNumVertices, meshletData);
+        meshletMaxNumVertices = maxNumVertices;
+        isMeshletDataValid = true;
+    }
+    return meshletData;
+}
+
+const std::vector<float>& LinePreprocessingCache::getVertexSimplificationErrors(const Trajectories& trajectories) {
+    if (!isVertexSimplificationErrorDataValid) {
+        if (!isSimplificationErrorDataValid) {
+            computeLineSimplificationErrors(trajectories, pointSimplificationErrors);
+            isSimplificationErrorDataValid = true;
+        }
+        const LinePreprocessedData& lineData = *data;
+        const size_t numLines = lineData.getNumLines();
+        vertexSimplificationErrors.resize(lineData.getNumVertices());
+#if _OPENMP >= 201107
+        #pragma omp parallel for shared(lineData, numLines) default(none)
+#endif
+        for (size_t lineIdx = 0; lineIdx < numLines; lineIdx++) {
+            const std::vector<float>& pointErrors =
+                    pointSimplificationErrors.at(lineData.lineTrajectoryIndices.at(lineIdx));
+            const uint32_t vertexOffset = lineData.lineVertexOffsets.at(lineIdx);
+            const uint32_t numLineVertices = lineData.lineNumVertices.at(lineIdx);
+            for (uint32_t vertexIdx = vertexOffset; vertexIdx < vertexOffset + numLineVertices; vertexIdx++) {
+                vertexSimplificationErrors.at(vertexIdx) = pointErrors.at(lineData.vertexPointIndices.at(vertexIdx));
+            }
+        }
+        isVertexSimplificationErrorDataValid = true;
+    }
+    return vertexSimplificationErrors;
+}
+
+void LinePreprocessingCache::invalidate() {
+    isValid = false;
+    cachedFilteredTrajectories.clear();
+    data = std::make_shared<LinePreprocessedData>();
+    isSimplificationErrorDataValid = false;
+    pointSimplificationErrors.clear();
+    isVertexSimplificationErrorDataValid = false;
+    vertexSimplificationErrors.clear();
+    isMeshletDataValid = false;
+    meshletData = LineMeshletData();
+}
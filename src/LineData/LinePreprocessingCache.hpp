@@ -0,0 +1,159 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LINEVIS_LINEPREPROCESSINGCACHE_HPP
+#define LINEVIS_LINEPREPROCESSINGCACHE_HPP
+
+#include <vector>
+#include <memory>
+#include <glm/glm.hpp>
+
+#include "Loaders/TrajectoryFile.hpp"
+#include "LineMeshlets.hpp"
+
+class BezierTrajectory;
+
+/**
+ * Line geometry shared by all render data builders (tubes, bands, programmable fetch, opacity optimization).
+ * Degenerate line points (i.e., points almost identical to their neighbors) and lines with less than two valid points
+ * are removed. The data only depends on the line positions and on the trajectory filter, i.e., it stays valid when the
+ * selected attribute, the line primitive mode, the level of detail or the renderer changes.
+ */
+struct LinePreprocessedData {
+    // Per valid line data.
+    std::vector<uint32_t> lineTrajectoryIndices; ///< Index of the line in the input trajectory set.
+    std::vector<uint32_t> lineVertexOffsets; ///< Index of the first vertex of the line.
+    std::vector<uint32_t> lineNumVertices; ///< Number of valid vertices of the line.
+
+    // Per vertex data.
+    /// Index of the point in the input trajectory (for attribute lookup).
+    std::vector<uint32_t> vertexPointIndices;
+    std::vector<glm::vec3> vertexPositions;
+    std::vector<glm::vec3> vertexTangents;
+    std::vector<glm::vec3> vertexNormals; ///< Normals transported along the line (rotation-minimizing frame).
+
+    /// Line segment list (two vertex indices per segment).
+    std::vector<uint32_t> lineIndices;
+
+    inline size_t getNumLines() const { return lineTrajectoryIndices.size(); }
+    inline size_t getNumVertices() const { return vertexPositions.size(); }
+
+    /**
+     * Gathers the values of the attribute with the passed index for all vertices.
+     * @param trajectories The trajectories the data was computed for.
+     * @param attributeIndex The index of the attribute to gather.
+     * @param vertexAttributes The array the attribute values are appended to.
+     */
+    void appendVertexAttributes(
+            const Trajectories& trajectories, int attributeIndex, std::vector<float>& vertexAttributes) const;
+
+    /**
+     * Appends the line segment list to the passed index array.
+     * @param lineIndicesOut The array the indices are appended to.
+     * @param vertexOffset The index of the first vertex of this data in the output vertex arrays.
+     */
+    void appendLineIndices(std::vector<uint32_t>& lineIndicesOut, uint32_t vertexOffset) const;
+};
+
+/**
+ * Computes the filtered line centers, tangents and normals of the passed trajectories in parallel.
+ * @param trajectories The trajectories (Trajectory or BezierTrajectory objects).
+ * @param filteredTrajectories Which trajectories are filtered out (may be empty if no trajectory is filtered).
+ * @param data The output data.
+ */
+template<typename T>
+void computeLinePreprocessedData(
+        const std::vector<T>& trajectories, const std::vector<bool>& filteredTrajectories,
+        LinePreprocessedData& data);
+
+/**
+ * Caches @see LinePreprocessedData for one trajectory set. The data is only recomputed if the geometry was invalidated
+ * using @see invalidate or if the trajectory filter changed since the last call of @see get.
+ * The simplification hierarchy is built on first use and kept until the geometry is invalidated.
+ */
+class LinePreprocessingCache {
+public:
+    /**
+     * @param trajectories The trajectory set the cache belongs to.
+     * @param filteredTrajectories Which trajectories are filtered out (may be empty if no trajectory is filtered).
+     * @return The preprocessed data. Stays valid until the next call of @see get or @see invalidate.
+     */
+    const LinePreprocessedData& get(
+            const Trajectories& trajectories, const std::vector<bool>& filteredTrajectories);
+    /**
+     * Same as @see get, but the caller shares the ownership of the data. When the data is recomputed, the cache
+     * creates a new object, so the returned data stays valid (but outdated) for as long as it is referenced.
+     */
+    std::shared_ptr<const LinePreprocessedData> getShared(
+            const Trajectories& trajectories, const std::vector<bool>& filteredTrajectories);
+
+    /**
+     * @param maxNumVertices The maximum number of vertices per meshlet.
+     * @return The meshlets of the data returned by the last call of @see get (built on first use).
+     */
+    const LineMeshletData& getMeshletData(uint32_t maxNumVertices);
+
+    /**
+     * @param trajectories The trajectory set passed to the last call of @see get.
+     * @return The simplification error of every vertex of the data returned by the last call of @see get (built on
+     * first use; @see computeLineSimplificationErrors).
+     */
+    const std::vector<float>& getVertexSimplificationErrors(const Trajectories& trajectories);
+
+    /// Needs to be called when the positions of the trajectories change.
+    void invalidate();
+
+private:
+    bool isValid = false;
+    std::vector<bool> cachedFilteredTrajectories;
+    std::shared_ptr<LinePreprocessedData> data = std::make_shared<LinePreprocessedData>();
+    bool isSimplificationErrorDataValid = false;
+    std::vector<std::vector<float>> pointSimplificationErrors;
+    bool isVertexSimplificationErrorDataValid = false;
+    std::vector<float> vertexSimplificationErrors;
+    bool isMeshletDataValid = false;
+    uint32_t meshletMaxNumVertices = 0;
+    LineMeshletData meshletData;
+};
+
+
+/*
+ * Template forward declarations, as code is in .cpp file.
+ */
+
+extern template
+void computeLinePreprocessedData<Trajectory>(
+        const std::vector<Trajectory>& trajectories, const std::vector<bool>& filteredTrajectories,
+        LinePreprocessedData& data);
+
+extern template
+void computeLinePreprocessedData<BezierTrajectory>(
+        const std::vector<BezierTrajectory>& trajectories, const std::vector<bool>& filteredTrajectories,
+        LinePreprocessedData& data);
+
+#endif //LINEVIS_LINEPREPROCESSINGCACHE_HPP
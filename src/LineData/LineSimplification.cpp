@@ -0,0 +1,170 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "LineSimplification.hpp"
+
+/// World space error corresponding to an attribute deviation of the full range (relative to the data set size).
+static const float ATTRIBUTE_ERROR_SCALE_FACTOR = 0.1f;
+/// Error of the finest simplification level (relative to the data set size).
+static const float MIN_SIMPLIFICATION_ERROR_FACTOR = 1e-4f;
+/// Number of simplification levels (the coarsest has an error of about 20% of the data set size).
+static const int NUM_SIMPLIFICATION_LEVELS = 12;
+
+void computeLineSimplificationErrors(
+        const Trajectory& trajectory, const std::vector<glm::vec2>& minMaxAttributeValues, float attributeErrorScale,
+        std::vector<float>& pointErrors) {
+    const std::vector<glm::vec3>& positions = trajectory.positions;
+    const size_t n = positions.size();
+    pointErrors.clear();
+    pointErrors.resize(n, 0.0f);
+    if (n == 0) {
+        return;
+    }
+    pointErrors.front() = std::numeric_limits<float>::max();
+    pointErrors.back() = std::numeric_limits<float>::max();
+    if (n < 3) {
+        return;
+    }
+
+    const size_t numAttributes = std::min(trajectory.attributes.size(), minMaxAttributeValues.size());
+    std::vector<float> attributeScales(numAttributes, 0.0f);
+    for (size_t attrIdx = 0; attrIdx < numAttributes; attrIdx++) {
+        const glm::vec2& minMax = minMaxAttributeValues.at(attrIdx);
+        if (minMax.y > minMax.x && trajectory.attributes.at(attrIdx).size() == n) {
+            attributeScales.at(attrIdx) = attributeErrorScale / (minMax.y - minMax.x);
+        }
+    }
+
+    // Iterative Douglas-Peucker refinement (avoids deep recursion for long lines).
+    struct LineRange {
+        size_t start, end;
+        float parentError;
+    };
+    std::vector<LineRange> rangeStack;
+    rangeStack.push_back({ 0, n - 1, std::numeric_limits<float>::max() });
+    while (!rangeStack.empty()) {
+        LineRange range = rangeStack.back();
+        rangeStack.pop_back();
+        if (range.end - range.start < 2) {
+            continue;
+        }
+
+        const glm::vec3& p0 = positions.at(range.start);
+        const glm::vec3 segment = positions.at(range.end) - p0;
+        const float segmentLengthSquared = glm::dot(segment, segment);
+        float maxError = -1.0f;
+        size_t maxErrorIdx = range.start + 1;
+        for (size_t i = range.start + 1; i < range.end; i++) {
+            float t = 0.0f;
+            if (segmentLengthSquared > 0.0f) {
+                t = glm::clamp(glm::dot(positions.at(i) - p0, segment) / segmentLengthSquared, 0.0f, 1.0f);
+            }
+            float error = glm::length(positions.at(i) - (p0 + t * segment));
+            for (size_t attrIdx = 0; attrIdx < numAttributes; attrIdx++) {
+                const float attributeScale = attributeScales.at(attrIdx);
+                if (attributeScale == 0.0f) {
+                    continue;
+                }
+                const std::vector<float>& attributes = trajectory.attributes.at(attrIdx);
+                float interpolatedValue = glm::mix(attributes.at(range.start), attributes.at(range.end), t);
+                error = std::max(error, std::abs(attributes.at(i) - interpolatedValue) * attributeScale);
+            }
+            if (error > maxError) {
+                maxError = error;
+                maxErrorIdx = i;
+            }
+        }
+
+        // Clamp to the error of the parent so that the errors are monotonic along the hierarchy.
+        const float pointError = std::min(maxError, range.parentError);
+        pointErrors.at(maxErrorIdx) = pointError;
+        rangeStack.push_back({ range.start, maxErrorIdx, pointError });
+        rangeStack.push_back({ maxErrorIdx, range.end, pointError });
+    }
+}
+
+void computeLineSimplificationErrors(
+        const Trajectories& trajectories, std::vector<std::vector<float>>& pointErrorsList) {
+    sgl::AABB3 boundingBox;
+    std::vector<glm::vec2> minMaxAttributeValues;
+    for (const Trajectory& trajectory : trajectories) {
+        for (const glm::vec3& position : trajectory.positions) {
+            boundingBox.combine(position);
+        }
+        if (minMaxAttributeValues.size() < trajectory.attributes.size()) {
+            minMaxAttributeValues.resize(
+                    trajectory.attributes.size(),
+                    glm::vec2(std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest()));
+        }
+        for (size_t attrIdx = 0; attrIdx < trajectory.attributes.size(); attrIdx++) {
+            glm::vec2& minMax = minMaxAttributeValues.at(attrIdx);
+            for (float value : trajectory.attributes.at(attrIdx)) {
+                minMax.x = std::min(minMax.x, value);
+                minMax.y = std::max(minMax.y, value);
+            }
+        }
+    }
+    const float attributeErrorScale =
+            trajectories.empty() ? 0.0f : glm::length(boundingBox.getDimensions()) * ATTRIBUTE_ERROR_SCALE_FACTOR;
+
+    const size_t numTrajectories = trajectories.size();
+    pointErrorsList.resize(numTrajectories);
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(trajectories, pointErrorsList, minMaxAttributeValues, numTrajectories) \
+    shared(attributeErrorScale) default(none)
+#endif
+    for (size_t trajectoryIdx = 0; trajectoryIdx < numTrajectories; trajectoryIdx++) {
+        computeLineSimplificationErrors(
+                trajectories.at(trajectoryIdx), minMaxAttributeValues, attributeErrorScale,
+                pointErrorsList.at(trajectoryIdx));
+    }
+}
+
+std::vector<float> computeLineSimplificationLevelErrors(const sgl::AABB3& modelBoundingBox) {
+    std::vector<float> levelErrors;
+    const float minError = glm::length(modelBoundingBox.getDimensions()) * MIN_SIMPLIFICATION_ERROR_FACTOR;
+    if (!(minError > 0.0f)) {
+        return levelErrors;
+    }
+    for (int level = 0; level < NUM_SIMPLIFICATION_LEVELS; level++) {
+        levelErrors.push_back(minError * std::exp2(float(level)));
+    }
+    return levelErrors;
+}
+
+float computeLineSimplificationErrorPerDistance(float fovy, int viewportHeight, float maxScreenSpaceError) {
+    if (viewportHeight <= 0 || maxScreenSpaceError <= 0.0f) {
+        return 0.0f;
+    }
+    float worldSizePerPixel = 2.0f * std::tan(fovy * 0.5f) / float(viewportHeight);
+    return maxScreenSpaceError * worldSizePerPixel;
+}
@@ -0,0 +1,86 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LINEVIS_LINESIMPLIFICATION_HPP
+#define LINEVIS_LINESIMPLIFICATION_HPP
+
+#include <vector>
+#include <glm/glm.hpp>
+#include <Math/Geometry/AABB3.hpp>
+
+#include "Loaders/TrajectoryFile.hpp"
+
+/**
+ * Computes a Douglas-Peucker simplification hierarchy of a trajectory. Each line point is assigned the error
+ * introduced by removing it, i.e., the maximum deviation from the simplified line in the refinement step that inserted
+ * the point. The errors are monotonically decreasing along the refinement hierarchy, so that the points with an error
+ * greater or equal to some threshold always form a valid simplification of the line with at most that error.
+ * The end points of a line are never removed (their error is std::numeric_limits<float>::max()).
+ *
+ * The error is attribute-aware: The deviation of each attribute from its linear interpolation along the simplified
+ * segment, normalized by the attribute range, is scaled by the passed attribute error scale and treated like a
+ * positional deviation in world space.
+ *
+ * @param trajectory The trajectory to simplify.
+ * @param minMaxAttributeValues The value range of every attribute (used for normalizing the attribute deviation).
+ * @param attributeErrorScale World space error corresponding to an attribute deviation of the full attribute range.
+ * @param pointErrors The output per point simplification errors.
+ */
+void computeLineSimplificationErrors(
+        const Trajectory& trajectory, const std::vector<glm::vec2>& minMaxAttributeValues, float attributeErrorScale,
+        std::vector<float>& pointErrors);
+
+/**
+ * Computes the simplification errors (@see computeLineSimplificationErrors) of all trajectories in parallel.
+ * The attribute error scale is set to a fraction of the bounding box diagonal of the trajectories.
+ * @param trajectories The trajectory set.
+ * @param pointErrorsList The output per point simplification errors of each trajectory.
+ */
+void computeLineSimplificationErrors(
+        const Trajectories& trajectories, std::vector<std::vector<float>>& pointErrorsList);
+
+/**
+ * Computes the world space errors of the simplified levels of detail of the line data (@see
+ * LineChunkBvh::buildLevelsOfDetail). The levels have the errors minError * 2^k, where minError is a small fraction of
+ * the bounding box diagonal.
+ * @param modelBoundingBox The bounding box of the line data.
+ * @return The increasing level errors (empty if the bounding box is empty).
+ */
+std::vector<float> computeLineSimplificationLevelErrors(const sgl::AABB3& modelBoundingBox);
+
+/**
+ * Computes the maximum world space error per unit of distance to the camera that stays below the passed screen space
+ * error, i.e., the projected size of maxScreenSpaceError pixels at distance 1.
+ * @param fovy The vertical field of view of the camera (in radians).
+ * @param viewportHeight The height of the viewport in pixels.
+ * @param maxScreenSpaceError The maximum tolerated screen space error in pixels.
+ * @return The error per distance, or 0 if no simplification is possible.
+ */
+float computeLineSimplificationErrorPerDistance(float fovy, int viewportHeight, float maxScreenSpaceError);
+
+#endif //LINEVIS_LINESIMPLIFICATION_HPP
@@ -37,6 +37,8 @@
 
 class HexahedralMeshLoader {
 public:
+    virtual ~HexahedralMeshLoader() {}
+
     // Reads the mesh from the specified file
     /**
      * Reads the mesh from the specified file. The vertices and the cell indices are required.
@@ -52,6 +54,20 @@ public:
             const std::string& filename,
             std::vector<glm::vec3>& vertices, std::vector<uint32_t>& cellIndices,
             std::vector<glm::vec3>& deformations, std::vector<float>& anisotropyMetricList)=0;
+
+    /**
+     * Reads the mesh together with the per-vertex stress tensors from the specified file.
+     * @param filename
+     * @param vertices
+     * @param cellIndices
+     * @param stressTensors Six values per vertex, i.e., the normal stresses (xx, yy, zz) and the shear stresses
+     * (yz, zx, xy) in the order used by the stress line tracer.
+     * @return Whether loading has succeeded. False is returned if the file format stores no stress data.
+     */
+    virtual bool loadHexahedralMeshWithStressFromFile(
+            const std::string& filename,
+            std::vector<glm::vec3>& vertices, std::vector<uint32_t>& cellIndices,
+            std::vector<float>& stressTensors) { return false; }
 };
 
 /**
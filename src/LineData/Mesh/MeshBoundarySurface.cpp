@@ -26,10 +26,13 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#include <set>
 #include <map>
-#include <unordered_map>
 #include <algorithm>
+#include <limits>
+
+#if _OPENMP >= 201107
+#include <omp.h>
+#endif
 
 #include <Utils/File/Logfile.hpp>
 
@@ -37,26 +40,6 @@
 #include "MeshLoader.hpp"
 #include "MeshBoundarySurface.hpp"
 
-struct FaceSlim {
-    uint32_t vs[4]; ///< vertex indices
-};
-struct VertexSlim {
-    std::vector<uint32_t> cs; ///< cell indices
-};
-
-void buildVerticesSlim(
-        const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& cellIndices,
-        std::vector<VertexSlim>& verticesSlim) {
-    verticesSlim.resize(vertices.size());
-    const uint32_t numCells = cellIndices.size() / 8;
-    for (uint32_t c_id = 0; c_id < numCells; c_id++) {
-        for (uint32_t v_internal_id = 0; v_internal_id < 8; v_internal_id++) {
-            uint32_t v_id = cellIndices.at(c_id * 8 + v_internal_id);
-            verticesSlim.at(v_id).cs.push_back(c_id);
-        }
-    }
-}
-
 const int hexFaceTable[6][4] = {
         // Use consistent winding for faces at the boundary (normals pointing out of the cell - no arbitrary decisions).
         { 0,1,2,3 },
@@ -66,79 +49,286 @@ const int hexFaceTable[6][4] = {
         { 6,7,3,2 },
         { 1,5,6,2 },
 };
+/// The faces of a tetrahedron (VTK vertex order) with the same winding as the faces in hexFaceTable.
+const int tetFaceTable[4][3] = {
+        { 0,1,2 },
+        { 0,3,1 },
+        { 0,2,3 },
+        { 1,3,2 },
+};
+/// Pads the keys of triangle faces, so that they can never be equal to the keys of quadrilateral faces.
+const uint32_t INVALID_VERTEX = std::numeric_limits<uint32_t>::max();
 
-void buildFacesSlim(
-        const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& cellIndices,
-        std::vector<FaceSlim>& facesSlim, std::vector<bool>& isBoundaryFace) {
-    struct TempFace {
-        uint32_t vertexId[4];
-        uint32_t faceId;
-
-        inline bool operator==(const TempFace& other) const {
-            for (int i = 0; i < 4; i++) {
-                if (vertexId[i] != other.vertexId[i]) {
-                    return false;
-                }
+/**
+ * A cell face identified by its sorted vertex indices. Sorting the faces by their key brings all faces shared by
+ * multiple cells next to each other. The cell and face index are used as a tie-breaker to make the order unique.
+ */
+struct FaceKey {
+    uint32_t vertexIds[4];
+    uint32_t cellIdx;
+    uint32_t faceIdx;
+
+    inline bool operator<(const FaceKey& other) const {
+        for (int i = 0; i < 4; i++) {
+            if (vertexIds[i] != other.vertexIds[i]) {
+                return vertexIds[i] < other.vertexIds[i];
             }
-            return true;
         }
+        if (cellIdx != other.cellIdx) {
+            return cellIdx < other.cellIdx;
+        }
+        return faceIdx < other.faceIdx;
+    }
+    inline bool getHasSameVertices(const FaceKey& other) const {
+        return vertexIds[0] == other.vertexIds[0] && vertexIds[1] == other.vertexIds[1]
+                && vertexIds[2] == other.vertexIds[2] && vertexIds[3] == other.vertexIds[3];
+    }
+};
 
-        inline bool operator!=(const TempFace& other) const {
-            for (int i = 0; i < 4; i++) {
-                if (vertexId[i] != other.vertexId[i]) {
-                    return true;
-                }
-            }
-            return false;
+/**
+ * Replaces the passed values by their exclusive prefix sum. The array is split into one block per thread. The block
+ * sums are computed in parallel, scanned serially, and then used as the start values of the parallel block scans.
+ * @return The sum of all values.
+ */
+static uint32_t computeExclusivePrefixSum(std::vector<uint32_t>& values) {
+    const size_t numValues = values.size();
+#if _OPENMP >= 201107
+    int numBlocks = std::max(omp_get_max_threads(), 1);
+#else
+    int numBlocks = 1;
+#endif
+    size_t blockSize = (numValues + size_t(numBlocks) - 1) / size_t(numBlocks);
+    std::vector<uint32_t> blockOffsets(numBlocks + 1, 0);
+
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(values, numValues, numBlocks, blockSize, blockOffsets) default(none)
+#endif
+    for (int blockIdx = 0; blockIdx < numBlocks; blockIdx++) {
+        size_t begin = std::min(size_t(blockIdx) * blockSize, numValues);
+        size_t end = std::min(begin + blockSize, numValues);
+        uint32_t blockSum = 0;
+        for (size_t i = begin; i < end; i++) {
+            blockSum += values[i];
         }
+        blockOffsets[blockIdx + 1] = blockSum;
+    }
+    for (int blockIdx = 0; blockIdx < numBlocks; blockIdx++) {
+        blockOffsets[blockIdx + 1] += blockOffsets[blockIdx];
+    }
 
-        inline bool operator<(const TempFace& other) const {
-            for (int i = 0; i < 4; i++) {
-                if (vertexId[i] < other.vertexId[i]) {
-                    return true;
-                } else if (vertexId[i] > other.vertexId[i]) {
-                    return false;
-                }
-            }
-            return faceId < other.faceId;
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(values, numValues, numBlocks, blockSize, blockOffsets) default(none)
+#endif
+    for (int blockIdx = 0; blockIdx < numBlocks; blockIdx++) {
+        size_t begin = std::min(size_t(blockIdx) * blockSize, numValues);
+        size_t end = std::min(begin + blockSize, numValues);
+        uint32_t runningSum = blockOffsets[blockIdx];
+        for (size_t i = begin; i < end; i++) {
+            uint32_t value = values[i];
+            values[i] = runningSum;
+            runningSum += value;
         }
-    };
+    }
+    return blockOffsets[numBlocks];
+}
 
-    const uint32_t numCells = cellIndices.size() / 8;
-    std::vector<FaceSlim> totalFaces(numCells * 6);
-    std::vector<TempFace> tempFaces(numCells * 6);
+/// @return The number of faces of a cell with the passed number of vertices (0 for unsupported cell types).
+static inline uint32_t getNumCellFaces(uint32_t numCellVertices) {
+    return numCellVertices == 8 ? 6 : (numCellVertices == 4 ? 4 : 0);
+}
 
-    FaceSlim face;
-    for (uint32_t cellId = 0; cellId < numCells; ++cellId) {
-        for (uint32_t faceIdx = 0; faceIdx < 6; faceIdx++){
-            for (uint32_t vertexIdx = 0; vertexIdx < 4; vertexIdx++) {
-                face.vs[vertexIdx] = cellIndices.at(cellId * 8 + hexFaceTable[faceIdx][vertexIdx]);
-            }
+/// Computes the key of a face of a hexahedron or tetrahedron (@see FaceKey).
+static inline void computeFaceKey(
+        const uint32_t* cellVertexIds, uint32_t numCellVertices, uint32_t cellIdx, uint32_t faceIdx,
+        FaceKey& faceKey) {
+    if (numCellVertices == 8) {
+        for (int i = 0; i < 4; i++) {
+            faceKey.vertexIds[i] = cellVertexIds[hexFaceTable[faceIdx][i]];
+        }
+    } else {
+        for (int i = 0; i < 3; i++) {
+            faceKey.vertexIds[i] = cellVertexIds[tetFaceTable[faceIdx][i]];
+        }
+        faceKey.vertexIds[3] = INVALID_VERTEX;
+    }
+    // Sorting network for four values.
+    uint32_t* ids = faceKey.vertexIds;
+    if (ids[0] > ids[1]) { std::swap(ids[0], ids[1]); }
+    if (ids[2] > ids[3]) { std::swap(ids[2], ids[3]); }
+    if (ids[0] > ids[2]) { std::swap(ids[0], ids[2]); }
+    if (ids[1] > ids[3]) { std::swap(ids[1], ids[3]); }
+    if (ids[1] > ids[2]) { std::swap(ids[1], ids[2]); }
+    faceKey.cellIdx = cellIdx;
+    faceKey.faceIdx = faceIdx;
+}
 
-            uint32_t faceId = 6 * cellId + faceIdx;
-            totalFaces[faceId] = face;
-            std::sort(face.vs, face.vs + 4);
-            tempFaces[faceId] = TempFace{
-                    face.vs[0], face.vs[1], face.vs[2], face.vs[3], faceId
-            };
+void extractMeshBoundarySurface(
+        const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& cellIndices,
+        const std::vector<uint32_t>& cellOffsets,
+        std::vector<uint32_t>& triangleIndices, std::vector<glm::vec3>& vertexPositions) {
+    triangleIndices.clear();
+    vertexPositions.clear();
+    const bool isHexMesh = cellOffsets.empty();
+    const uint32_t numCells = isHexMesh ? uint32_t(cellIndices.size() / 8) : uint32_t(cellOffsets.size() - 1);
+    const uint32_t numVertices = uint32_t(vertices.size());
+    if (numCells == 0) {
+        return;
+    }
+
+    // The faces of cell i are the face range [cellFaceOffsets[i], cellFaceOffsets[i + 1]).
+    std::vector<uint32_t> cellFaceOffsets(numCells + 1, 0);
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(cellOffsets, numCells, isHexMesh, cellFaceOffsets) default(none)
+#endif
+    for (uint32_t cellIdx = 0; cellIdx < numCells; cellIdx++) {
+        uint32_t numCellVertices = isHexMesh ? 8 : cellOffsets[cellIdx + 1] - cellOffsets[cellIdx];
+        cellFaceOffsets[cellIdx] = getNumCellFaces(numCellVertices);
+    }
+    const uint32_t numFaces = computeExclusivePrefixSum(cellFaceOffsets);
+
+    // The faces are sorted by their key using a parallel counting sort by the smallest vertex index (which is the
+    // first key component), followed by a sort of the (few) faces with the same smallest vertex index.
+    // Pass 1: Count the number of faces per smallest vertex index.
+    std::vector<uint32_t> vertexFaceOffsets(numVertices + 1, 0);
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(cellIndices, cellOffsets, numCells, isHexMesh, vertexFaceOffsets) \
+    default(none)
+#endif
+    for (uint32_t cellIdx = 0; cellIdx < numCells; cellIdx++) {
+        const uint32_t* cellVertexIds = cellIndices.data() + (isHexMesh ? size_t(cellIdx) * 8 : cellOffsets[cellIdx]);
+        uint32_t numCellVertices = isHexMesh ? 8 : cellOffsets[cellIdx + 1] - cellOffsets[cellIdx];
+        uint32_t numCellFaces = getNumCellFaces(numCellVertices);
+        for (uint32_t faceIdx = 0; faceIdx < numCellFaces; faceIdx++) {
+            FaceKey faceKey;
+            computeFaceKey(cellVertexIds, numCellVertices, cellIdx, faceIdx, faceKey);
+#if _OPENMP >= 201107
+            #pragma omp atomic
+#endif
+            vertexFaceOffsets[faceKey.vertexIds[0]]++;
+        }
+    }
+
+    // Pass 2: Prefix sum over the counts.
+    computeExclusivePrefixSum(vertexFaceOffsets);
+
+    // Pass 3: Scatter the face keys to their buckets.
+    std::vector<FaceKey> faceKeys(numFaces);
+    std::vector<uint32_t> writeOffsets(vertexFaceOffsets.begin(), vertexFaceOffsets.end() - 1);
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(cellIndices, cellOffsets, numCells, isHexMesh, faceKeys, writeOffsets) \
+    default(none)
+#endif
+    for (uint32_t cellIdx = 0; cellIdx < numCells; cellIdx++) {
+        const uint32_t* cellVertexIds = cellIndices.data() + (isHexMesh ? size_t(cellIdx) * 8 : cellOffsets[cellIdx]);
+        uint32_t numCellVertices = isHexMesh ? 8 : cellOffsets[cellIdx + 1] - cellOffsets[cellIdx];
+        uint32_t numCellFaces = getNumCellFaces(numCellVertices);
+        for (uint32_t faceIdx = 0; faceIdx < numCellFaces; faceIdx++) {
+            FaceKey faceKey;
+            computeFaceKey(cellVertexIds, numCellVertices, cellIdx, faceIdx, faceKey);
+            uint32_t writeIdx;
+#if _OPENMP >= 201107
+            #pragma omp atomic capture
+#endif
+            writeIdx = writeOffsets[faceKey.vertexIds[0]]++;
+            faceKeys[writeIdx] = faceKey;
+        }
+    }
+
+    // Pass 4: Sort the buckets. Afterwards, the faces are in the same order as when sorting all keys at once.
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numVertices, faceKeys, vertexFaceOffsets) default(none) schedule(dynamic, 1024)
+#endif
+    for (uint32_t vertexIdx = 0; vertexIdx < numVertices; vertexIdx++) {
+        uint32_t begin = vertexFaceOffsets[vertexIdx];
+        uint32_t end = vertexFaceOffsets[vertexIdx + 1];
+        if (end - begin > 1) {
+            std::sort(faceKeys.begin() + begin, faceKeys.begin() + end);
+        }
+    }
+
+    // Faces not shared with any other cell lie on the boundary. Compact them in sorted order.
+    std::vector<uint32_t> boundaryFaceOffsets(numFaces + 1, 0);
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numFaces, faceKeys, boundaryFaceOffsets) default(none)
+#endif
+    for (uint32_t i = 0; i < numFaces; i++) {
+        bool isBoundaryFace =
+                (i == 0 || !faceKeys[i].getHasSameVertices(faceKeys[i - 1]))
+                && (i + 1 == numFaces || !faceKeys[i].getHasSameVertices(faceKeys[i + 1]));
+        boundaryFaceOffsets[i] = isBoundaryFace ? 1 : 0;
+    }
+    const uint32_t numBoundaryFaces = computeExclusivePrefixSum(boundaryFaceOffsets);
+    std::vector<FaceKey> boundaryFaces(numBoundaryFaces);
+    std::vector<uint32_t> boundaryFaceIndexOffsets(numBoundaryFaces + 1, 0);
+    std::vector<uint32_t> usedVertexOffsets(numVertices + 1, 0);
+#if _OPENMP >= 201107
+    #pragma omp parallel for default(none) \
+    shared(numFaces, faceKeys, boundaryFaceOffsets, boundaryFaces, boundaryFaceIndexOffsets, usedVertexOffsets)
+#endif
+    for (uint32_t i = 0; i < numFaces; i++) {
+        if (boundaryFaceOffsets[i] == boundaryFaceOffsets[i + 1]) {
+            continue;
+        }
+        const FaceKey& faceKey = faceKeys[i];
+        uint32_t boundaryFaceIdx = boundaryFaceOffsets[i];
+        boundaryFaces[boundaryFaceIdx] = faceKey;
+        bool isTriangle = faceKey.vertexIds[3] == INVALID_VERTEX;
+        boundaryFaceIndexOffsets[boundaryFaceIdx] = isTriangle ? 3 : 6;
+        for (int j = 0; j < (isTriangle ? 3 : 4); j++) {
+#if _OPENMP >= 201107
+            #pragma omp atomic write
+#endif
+            usedVertexOffsets[faceKey.vertexIds[j]] = 1;
         }
     }
-    std::sort(tempFaces.begin(), tempFaces.end());
+    const uint32_t numTriangleIndices = computeExclusivePrefixSum(boundaryFaceIndexOffsets);
 
-    facesSlim.reserve(tempFaces.size() / 3);
-    uint32_t numFaces = 0;
-    for (uint32_t i = 0; i < tempFaces.size(); ++i) {
-        if (i == 0 || tempFaces[i] != tempFaces[i - 1]) {
-            face = totalFaces[tempFaces[i].faceId];
-            facesSlim.push_back(face);
-            isBoundaryFace.push_back(true);
-            numFaces++;
+    // Compact the used vertices. Their order is the same as in the mesh.
+    const uint32_t numUsedVertices = computeExclusivePrefixSum(usedVertexOffsets);
+    vertexPositions.resize(numUsedVertices);
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(vertices, numVertices, usedVertexOffsets, vertexPositions) default(none)
+#endif
+    for (uint32_t vertexIdx = 0; vertexIdx < numVertices; vertexIdx++) {
+        if (usedVertexOffsets[vertexIdx] != usedVertexOffsets[vertexIdx + 1]) {
+            vertexPositions[usedVertexOffsets[vertexIdx]] = vertices[vertexIdx];
+        }
+    }
+
+    // Add the triangle indices. The vertex order of the faces is taken from the cells to keep the winding.
+    triangleIndices.resize(numTriangleIndices);
+#if _OPENMP >= 201107
+    #pragma omp parallel for default(none) shared(cellIndices, cellOffsets, isHexMesh, numBoundaryFaces) \
+    shared(boundaryFaces, boundaryFaceIndexOffsets, usedVertexOffsets, triangleIndices, hexFaceTable, tetFaceTable)
+#endif
+    for (uint32_t boundaryFaceIdx = 0; boundaryFaceIdx < numBoundaryFaces; boundaryFaceIdx++) {
+        const FaceKey& faceKey = boundaryFaces[boundaryFaceIdx];
+        const uint32_t* cellVertexIds =
+                cellIndices.data() + (isHexMesh ? size_t(faceKey.cellIdx) * 8 : cellOffsets[faceKey.cellIdx]);
+        uint32_t* indices = triangleIndices.data() + boundaryFaceIndexOffsets[boundaryFaceIdx];
+        if (faceKey.vertexIds[3] == INVALID_VERTEX) {
+            const int* face = tetFaceTable[faceKey.faceIdx];
+            indices[0] = usedVertexOffsets[cellVertexIds[face[2]]];
+            indices[1] = usedVertexOffsets[cellVertexIds[face[1]]];
+            indices[2] = usedVertexOffsets[cellVertexIds[face[0]]];
         } else {
-            isBoundaryFace[numFaces - 1] = false;
+            const int* face = hexFaceTable[faceKey.faceIdx];
+            indices[0] = usedVertexOffsets[cellVertexIds[face[2]]];
+            indices[1] = usedVertexOffsets[cellVertexIds[face[1]]];
+            indices[2] = usedVertexOffsets[cellVertexIds[face[0]]];
+            indices[3] = usedVertexOffsets[cellVertexIds[face[3]]];
+            indices[4] = usedVertexOffsets[cellVertexIds[face[2]]];
+            indices[5] = usedVertexOffsets[cellVertexIds[face[0]]];
         }
     }
 }
 
+void extractMeshBoundarySurface(
+        const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& cellIndices,
+        std::vector<uint32_t>& triangleIndices, std::vector<glm::vec3>& vertexPositions) {
+    extractMeshBoundarySurface(vertices, cellIndices, {}, triangleIndices, vertexPositions);
+}
+
 void loadMeshBoundarySurfaceFromFile(
         const std::string& meshFilename,
         std::vector<uint32_t>& triangleIndices, std::vector<glm::vec3>& vertexPositions) {
@@ -172,49 +362,7 @@ void loadMeshBoundarySurfaceFromFile(
         return;
     }
 
-    std::vector<VertexSlim> verticesSlim;
-    std::vector<FaceSlim> facesSlim;
-    std::vector<bool> facesBoundarySlim;
-
-    buildVerticesSlim(vertices, cellIndices, verticesSlim);
-    buildFacesSlim(vertices, cellIndices, facesSlim, facesBoundarySlim);
-
-    std::set<uint32_t> usedVertexSet;
-    std::unordered_map<uint32_t, uint32_t> vertexIndexMap;
-
-    for (size_t f_id = 0; f_id < facesSlim.size(); f_id++) {
-        FaceSlim &f = facesSlim.at(f_id);
-        if (!facesBoundarySlim.at(f_id)) {
-            continue;
-        }
-        for (size_t i = 0; i < 4; i++) {
-            usedVertexSet.insert(f.vs[i]);
-        }
-    }
-
-    // Add the used hex-mesh vertices to the triangle mesh vertex data.
-    uint32_t ctr = 0;
-    for (uint32_t v_id : usedVertexSet) {
-        vertexIndexMap.insert(std::make_pair(v_id, ctr));
-        vertexPositions.push_back(vertices.at(v_id));
-        ctr++;
-    }
-
-    // Add the triangle indices.
-    for (size_t f_id = 0; f_id < facesSlim.size(); f_id++) {
-        FaceSlim& f = facesSlim.at(f_id);
-        if (!facesBoundarySlim.at(f_id)) {
-            continue;
-        }
-
-        triangleIndices.push_back(vertexIndexMap[f.vs[2]]);
-        triangleIndices.push_back(vertexIndexMap[f.vs[1]]);
-        triangleIndices.push_back(vertexIndexMap[f.vs[0]]);
-        triangleIndices.push_back(vertexIndexMap[f.vs[3]]);
-        triangleIndices.push_back(vertexIndexMap[f.vs[2]]);
-        triangleIndices.push_back(vertexIndexMap[f.vs[0]]);
-    }
-
+    extractMeshBoundarySurface(vertices, cellIndices, triangleIndices, vertexPositions);
 
     for (auto& it : meshLoaderMap) {
         delete it.second;
@@ -31,10 +31,32 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
 #include <glm/vec3.hpp>
 
 #include <Math/Geometry/AABB3.hpp>
 
+/**
+ * Extracts the boundary surface of a mesh consisting of hexahedra and tetrahedra, i.e., all cell faces not shared with
+ * any other cell. The faces are found by sorting them by their vertex indices in parallel. Quadrilateral faces are
+ * split into two triangles. The normals of the triangles point out of the cells.
+ * @param vertices The vertex positions of the mesh.
+ * @param cellIndices The vertex indices of the cells (VTK vertex order).
+ * @param cellOffsets Offsets of the cells into cellIndices (number of cells + 1 entries). Cells with eight vertices
+ * are hexahedra, cells with four vertices are tetrahedra, and all other cells are ignored.
+ * @param triangleIndices The triangle indices of the boundary surface. The faces are ordered by their sorted vertex
+ * indices.
+ * @param vertexPositions The vertices used by the boundary surface (in the same order as in the mesh).
+ */
+void extractMeshBoundarySurface(
+        const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& cellIndices,
+        const std::vector<uint32_t>& cellOffsets,
+        std::vector<uint32_t>& triangleIndices, std::vector<glm::vec3>& vertexPositions);
+/// Extracts the boundary surface of a purely hexahedral mesh with eight vertex indices per cell.
+void extractMeshBoundarySurface(
+        const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& cellIndices,
+        std::vector<uint32_t>& triangleIndices, std::vector<glm::vec3>& vertexPositions);
+
 void loadMeshBoundarySurfaceFromFile(
         const std::string& meshFilename,
         std::vector<uint32_t>& triangleIndices, std::vector<glm::vec3>& vertexPositions);
@@ -42,6 +42,64 @@ bool VtkLoader::loadHexahedralMeshFromFile(
         const std::string& filename,
         std::vector<glm::vec3>& vertices, std::vector<uint32_t>& cellIndices,
         std::vector<glm::vec3>& deformations, std::vector<float>& anisotropyMetricList) {
+    return loadFile(filename, vertices, cellIndices, deformations, anisotropyMetricList, nullptr);
+}
+
+bool VtkLoader::loadHexahedralMeshWithStressFromFile(
+        const std::string& filename,
+        std::vector<glm::vec3>& vertices, std::vector<uint32_t>& cellIndices,
+        std::vector<float>& stressTensors) {
+    std::vector<glm::vec3> deformations;
+    std::vector<float> anisotropyMetricList;
+    stressTensors.clear();
+    if (!loadFile(filename, vertices, cellIndices, deformations, anisotropyMetricList, &stressTensors)) {
+        return false;
+    }
+    if (stressTensors.empty()) {
+        sgl::Logfile::get()->writeError(
+                "Error in VtkLoader: The file \"" + filename + "\" contains no per-vertex stress tensors!");
+        return false;
+    }
+    if (stressTensors.size() != vertices.size() * 6) {
+        sgl::Logfile::get()->writeError(
+                "Error in VtkLoader: The number of stress tensors in the file \"" + filename
+                + "\" does not match the number of vertices!");
+        return false;
+    }
+    return true;
+}
+
+/// The layouts of stress tensors in the point data.
+enum class VtkStressTensorFormat {
+    NONE, TENSORS, TENSORS6, VOIGT
+};
+
+/**
+ * Converts stress tensors read from the point data to six values per vertex (xx, yy, zz, yz, zx, xy).
+ */
+static void convertStressTensors(
+        VtkStressTensorFormat format, const std::vector<float>& values, std::vector<float>& stressTensors) {
+    const int numComponents = format == VtkStressTensorFormat::TENSORS ? 9 : 6;
+    // Indices of xx, yy, zz, yz, zx and xy in the input tuples.
+    const int TENSORS_INDICES[] = { 0, 4, 8, 5, 6, 1 };
+    const int TENSORS6_INDICES[] = { 0, 1, 2, 4, 5, 3 };
+    const int VOIGT_INDICES[] = { 0, 1, 2, 3, 4, 5 };
+    const int* indices = format == VtkStressTensorFormat::TENSORS ? TENSORS_INDICES
+            : (format == VtkStressTensorFormat::TENSORS6 ? TENSORS6_INDICES : VOIGT_INDICES);
+    const size_t numTuples = values.size() / numComponents;
+    stressTensors.resize(numTuples * 6);
+    for (size_t tupleIdx = 0; tupleIdx < numTuples; tupleIdx++) {
+        for (int i = 0; i < 6; i++) {
+            stressTensors.at(tupleIdx * 6 + i) = values.at(tupleIdx * numComponents + indices[i]);
+        }
+    }
+}
+
+bool VtkLoader::loadFile(
+        const std::string& filename,
+        std::vector<glm::vec3>& vertices, std::vector<uint32_t>& cellIndices,
+        std::vector<glm::vec3>& deformations, std::vector<float>& anisotropyMetricList,
+        std::vector<float>* stressTensors) {
     bool foundVersionHeader = false;
     bool foundTitle = false;
     bool foundType = false;
@@ -57,8 +115,11 @@ bool VtkLoader::loadHexahedralMeshFromFile(
     int numCellTypesLeft = 0;
     bool isCellDataReadMode = false;
     int numCellDataLinesLeft = 0;
+    size_t numPointDataTuples = 0;
     bool isPointDataReadMode = false;
-    int numPointDataLinesLeft = 0;
+    size_t numPointDataValuesLeft = 0;
+    VtkStressTensorFormat pointDataStressTensorFormat = VtkStressTensorFormat::NONE;
+    std::vector<float> pointDataValues;
     bool isDeformationDataReadMode = false;
     int numDeformationDataLinesLeft = 0;
     bool isAnisotropyMetricReadMode = false;
@@ -119,9 +180,27 @@ bool VtkLoader::loadHexahedralMeshFromFile(
         }
 
         if (isPointDataReadMode) {
-            numPointDataLinesLeft--;
-            if (numPointDataLinesLeft <= 0) {
+            // The values may be distributed arbitrarily over the lines.
+            if (tokens.at(0) == "LOOKUP_TABLE") {
+                return true;
+            }
+            if (tokens.size() > numPointDataValuesLeft) {
+                sgl::Logfile::get()->writeError("Error in VtkLoader: Invalid number of point data values!");
+                return false;
+            }
+            if (pointDataStressTensorFormat != VtkStressTensorFormat::NONE) {
+                for (const std::string& token : tokens) {
+                    pointDataValues.push_back(sgl::fromString<float>(token));
+                }
+            }
+            numPointDataValuesLeft -= tokens.size();
+            if (numPointDataValuesLeft == 0) {
                 isPointDataReadMode = false;
+                if (pointDataStressTensorFormat != VtkStressTensorFormat::NONE) {
+                    convertStressTensors(pointDataStressTensorFormat, pointDataValues, *stressTensors);
+                    pointDataValues = {};
+                    pointDataStressTensorFormat = VtkStressTensorFormat::NONE;
+                }
             }
             return true;
         }
@@ -248,14 +327,46 @@ bool VtkLoader::loadHexahedralMeshFromFile(
             return true;
         }
 
-        // Ignore point data
+        // Point data (only stress tensors are stored, all other data is ignored).
         if (tokens.at(0) == "POINT_DATA") {
             if (tokens.size() != 2) {
                 sgl::Logfile::get()->writeError("Error in VtkLoader: Malformed POINT_DATA declaration!");
                 return false;
             }
-            // Number of entries + SCALARS + LOOKUP_TABLE information
-            numPointDataLinesLeft = sgl::fromString<size_t>(tokens.at(1)) + 2;
+            numPointDataTuples = sgl::fromString<size_t>(tokens.at(1));
+            return true;
+        }
+
+        // Expecting: SCALARS <name> <data_type> [<num_components>] or
+        // VECTORS/NORMALS/TENSORS/TENSORS6 <name> <data_type>
+        if (numPointDataTuples > 0 && (tokens.at(0) == "SCALARS" || tokens.at(0) == "VECTORS"
+                || tokens.at(0) == "NORMALS" || tokens.at(0) == "TENSORS" || tokens.at(0) == "TENSORS6")) {
+            if (tokens.size() < 3) {
+                sgl::Logfile::get()->writeError("Error in VtkLoader: Malformed point data declaration!");
+                return false;
+            }
+            size_t numComponents = 1;
+            VtkStressTensorFormat format = VtkStressTensorFormat::NONE;
+            if (tokens.at(0) == "SCALARS") {
+                numComponents = tokens.size() >= 4 ? sgl::fromString<size_t>(tokens.at(3)) : 1;
+                format = numComponents == 6 ? VtkStressTensorFormat::VOIGT : VtkStressTensorFormat::NONE;
+            } else if (tokens.at(0) == "TENSORS") {
+                numComponents = 9;
+                format = VtkStressTensorFormat::TENSORS;
+            } else if (tokens.at(0) == "TENSORS6") {
+                numComponents = 6;
+                format = VtkStressTensorFormat::TENSORS6;
+            } else {
+                numComponents = 3;
+            }
+            // Only the first tensor field is used.
+            pointDataStressTensorFormat =
+                    stressTensors && stressTensors->empty() ? format : VtkStressTensorFormat::NONE;
+            pointDataValues.clear();
+            if (pointDataStressTensorFormat != VtkStressTensorFormat::NONE) {
+                pointDataValues.reserve(numPointDataTuples * numComponents);
+            }
+            numPointDataValuesLeft = numPointDataTuples * numComponents;
             isPointDataReadMode = true;
             return true;
         }
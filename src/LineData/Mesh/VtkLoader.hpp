@@ -38,6 +38,22 @@ public:
             const std::string& filename,
             std::vector<glm::vec3>& vertices, std::vector<uint32_t>& cellIndices,
             std::vector<glm::vec3>& deformations, std::vector<float>& anisotropyMetricList);
+
+    /**
+     * Stress tensors are read from the point data. Supported are TENSORS (3x3 tensors), TENSORS6 (VTK order xx, yy, zz,
+     * xy, yz, xz) and SCALARS with six components (order xx, yy, zz, yz, zx, xy).
+     */
+    virtual bool loadHexahedralMeshWithStressFromFile(
+            const std::string& filename,
+            std::vector<glm::vec3>& vertices, std::vector<uint32_t>& cellIndices,
+            std::vector<float>& stressTensors);
+
+private:
+    bool loadFile(
+            const std::string& filename,
+            std::vector<glm::vec3>& vertices, std::vector<uint32_t>& cellIndices,
+            std::vector<glm::vec3>& deformations, std::vector<float>& anisotropyMetricList,
+            std::vector<float>* stressTensors);
 };
 
 #endif // LOADERS_VTKLOADER_HPP
\ No newline at end of file
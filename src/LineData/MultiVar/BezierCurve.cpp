@@ -48,6 +48,9 @@
  * -------------------------------------------------------------------------------
  */
 
+#include <algorithm>
+#include <cassert>
+
 #include "BezierCurve.hpp"
 
 // Bezier Curve code --> quick evaluation
@@ -138,7 +141,7 @@ float BezierCurve::evalArcLength(const float _minT, const float _maxT, const uin
         float curT = std::min(minTN + i * h, maxTN);
         float segmentL = glm::length(derivative(curT));
 
-        if (i > 0 || i < numSteps - 1) {
+        if (i > 0 && i < numSteps - 1) {
             segmentL *= 2.0f;
         }
 
@@ -192,3 +195,41 @@ float BezierCurve::solveTForArcLength(const float _arcLength) const {
 
     return t;
 }
+
+void BezierCurve::computeArcLengthTable(const uint32_t numEntries, float* arcLengthTable) const {
+    assert(numEntries >= 2);
+
+    const float h = (maxT - minT) / float(numEntries - 1);
+    float lastSpeed = glm::length(derivative(minT));
+    float L = 0.0f;
+    arcLengthTable[0] = 0.0f;
+    for (uint32_t i = 1; i < numEntries; ++i) {
+        float curT = std::min(minT + float(i) * h, maxT);
+        float speed = glm::length(derivative(curT));
+        L += (lastSpeed + speed) * (h / 2.0f);
+        arcLengthTable[i] = L;
+        lastSpeed = speed;
+    }
+}
+
+float BezierCurve::solveTForArcLengthTable(
+        const float* arcLengthTable, const uint32_t numEntries, float _arcLength) const {
+    _arcLength = std::max(std::min(_arcLength, arcLengthTable[numEntries - 1]), 0.0f);
+
+    // Find the first table entry with an arc length greater than the searched one.
+    const float* upperEntry = std::upper_bound(arcLengthTable, arcLengthTable + numEntries, _arcLength);
+    if (upperEntry == arcLengthTable + numEntries) {
+        return maxT;
+    }
+    const uint32_t upperIdx = std::max(uint32_t(upperEntry - arcLengthTable), 1u);
+    const float lowerArcLength = arcLengthTable[upperIdx - 1];
+    const float upperArcLength = arcLengthTable[upperIdx];
+
+    // Interpolate linearly between the two entries.
+    float alpha = 0.0f;
+    if (upperArcLength > lowerArcLength) {
+        alpha = (_arcLength - lowerArcLength) / (upperArcLength - lowerArcLength);
+    }
+    float tN = (float(upperIdx - 1) + alpha) / float(numEntries - 1);
+    return std::min(denormalizeT(tN), maxT);
+}
@@ -30,6 +30,7 @@
 #define STRESSLINEVIS_BEZIERCURVE_HPP
 
 #include <array>
+#include <cstdint>
 #include <glm/glm.hpp>
 
 class BezierCurve {
@@ -47,6 +48,18 @@ public:
     glm::vec3 curvature(const float t) const;
     float evalArcLength(const float _minT, const float _maxT, const uint16_t numSteps) const;
     float solveTForArcLength(const float _arcLength) const;
+
+    /**
+     * Tabulates the arc length from minT to numEntries equidistant parameter values in [minT, maxT] using the
+     * cumulative trapezoidal rule (i.e., arcLengthTable[0] = 0 and arcLengthTable[numEntries - 1] is the arc length
+     * of the whole curve).
+     */
+    void computeArcLengthTable(const uint32_t numEntries, float* arcLengthTable) const;
+    /**
+     * Inverts an arc length table computed by @see computeArcLengthTable using binary search and linear interpolation.
+     * In contrast to @see solveTForArcLength, no numerical integration is necessary.
+     */
+    float solveTForArcLengthTable(const float* arcLengthTable, const uint32_t numEntries, float _arcLength) const;
     float normalizeT(const float t) const { return (t - minT) / (maxT - minT); }
 
 private:
@@ -26,27 +26,56 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <limits>
+
 #include <Utils/File/Logfile.hpp>
 
 #include "BezierCurve.hpp"
 #include "BezierTrajectory.hpp"
 
-BezierTrajectories convertTrajectoriesToBezierCurves(const Trajectories &inTrajectories) {
+/// Number of entries of the arc length table of each Bezier segment.
+static const uint32_t ARC_LENGTH_TABLE_SIZE = 32;
+
+bool convertTrajectoriesToBezierCurves(
+        const Trajectories& inTrajectories, BezierTrajectories& newTrajectories,
+        BezierArcLengthSolver arcLengthSolver) {
+    newTrajectories.clear();
+    if (inTrajectories.empty()) {
+        return true;
+    }
+
+    const uint32_t numVariables = inTrajectories[0].attributes.size();
+    if (numVariables <= 0) {
+        sgl::Logfile::get()->writeError("ERROR: No variable was found in trajectory file.");
+        return false;
+    }
+    const uint32_t maxNumVariables = numVariables;
+    const uint32_t numLines = inTrajectories.size();
+    const bool useArcLengthTables = arcLengthSolver == BEZIER_ARC_LENGTH_SOLVER_TABLE;
+
     // 1) Determine Bezier segments
-    std::vector<std::vector<BezierCurve>> curves(inTrajectories.size());
+    std::vector<std::vector<BezierCurve>> curves(numLines);
     // Store the arclength of all segments along a curve
-    std::vector<float> curveArcLengths(inTrajectories.size(), 0.0f);
+    std::vector<float> curveArcLengths(numLines, 0.0f);
+    // Per segment arc length tables (ARC_LENGTH_TABLE_SIZE entries per segment).
+    std::vector<std::vector<float>> curveArcLengthTables(useArcLengthTables ? numLines : 0);
 
     // Average segment length;
     float avgSegLength = 0.0f;
     float minSegLength = std::numeric_limits<float>::max();
     float numSegments = 0;
 
-    int32_t trajCounter = 0;
-    for (const auto& trajectory : inTrajectories) {
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(inTrajectories, curves, curveArcLengths, curveArcLengthTables) \
+    shared(numLines, useArcLengthTables) default(none) schedule(dynamic) \
+    reduction(+: avgSegLength) reduction(min: minSegLength) reduction(+: numSegments)
+#endif
+    for (uint32_t trajCounter = 0; trajCounter < numLines; trajCounter++) {
+        const Trajectory& trajectory = inTrajectories[trajCounter];
         std::vector<BezierCurve> &curveSet = curves[trajCounter];
 
         const int maxVertices = trajectory.positions.size();
+        curveSet.reserve(std::max(maxVertices - 1, 0));
 
         float minT = 0.0f;
         float maxT = 1.0f;
@@ -71,9 +100,6 @@ BezierTrajectories convertTrajectoriesToBezierCurves(const Trajectories &inTraje
             glm::vec3 C2 = pos2 - cotangent2 * lenTangent * 0.5f;
             glm::vec3 C3 = pos2;
 
-//            const std::vector<float>& attributes = trajectory.attributes[v];
-
-//            curveSet.emplace_back({{ C0, C1, C2, C3 }}, minT, maxT);
             BezierCurve BCurve({{C0, C1, C2, C3}}, minT, maxT);
 
             curveSet.push_back(BCurve);
@@ -83,36 +109,32 @@ BezierTrajectories convertTrajectoriesToBezierCurves(const Trajectories &inTraje
             maxT += 1.0f;
         }
 
-        trajCounter++;
+        if (useArcLengthTables) {
+            std::vector<float>& arcLengthTables = curveArcLengthTables[trajCounter];
+            arcLengthTables.resize(curveSet.size() * ARC_LENGTH_TABLE_SIZE);
+            for (size_t curveIdx = 0; curveIdx < curveSet.size(); curveIdx++) {
+                curveSet[curveIdx].computeArcLengthTable(
+                        ARC_LENGTH_TABLE_SIZE, arcLengthTables.data() + curveIdx * ARC_LENGTH_TABLE_SIZE);
+            }
+        }
     }
 
     avgSegLength /= numSegments;
 
-    // 2) Compute min max values of all attributes across all trajectories
-    const uint32_t numVariables = inTrajectories[0].attributes.size();
-    if (numVariables <= 0) {
-        sgl::Logfile::get()->writeError("ERROR: No variable was found in trajectory file.");
-        std::exit(-2);
-    }
-
-    std::vector<glm::vec2> attributesMinMax(
-            numVariables, glm::vec2(std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest()));
-
-    const uint32_t maxNumVariables = inTrajectories[0].attributes.size();
-    const uint32_t numLines = inTrajectories.size();
-
-    // 2.5) Create buffer array with all variables and statistics
+    // 2) Create buffer array with all variables and statistics
     std::vector<std::vector<float>> multiVarData(numLines);
     std::vector<LineDesc> lineDescs(numLines);
     std::vector<std::vector<VarDesc>> lineMultiVarDescs(numLines);
 
-    uint32_t lineOffset = 0;
-    uint32_t lineID = 0;
-
-    for (const auto& trajectory : inTrajectories) {
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(inTrajectories, multiVarData, lineDescs, lineMultiVarDescs) \
+    shared(numLines, maxNumVariables) default(none)
+#endif
+    for (uint32_t lineID = 0; lineID < numLines; lineID++) {
+        const Trajectory& trajectory = inTrajectories[lineID];
         uint32_t varOffsetPerLine = 0;
 
-        for (auto v = 0; v < maxNumVariables; ++v) {
+        for (uint32_t v = 0; v < maxNumVariables; ++v) {
             VarDesc varDescPerLine = {0};
             varDescPerLine.minMax = glm::vec2(
                     std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest());
@@ -122,41 +144,60 @@ BezierTrajectories convertTrajectoriesToBezierCurves(const Trajectories &inTraje
             const std::vector<float>& variableArray = trajectory.attributes[v];
 
             for (const auto &variable : variableArray) {
-                attributesMinMax[v].x = std::min(attributesMinMax[v].x, variable);
-                attributesMinMax[v].y = std::max(attributesMinMax[v].y, variable);
-
                 varDescPerLine.minMax.x = std::min(varDescPerLine.minMax.x, variable);
                 varDescPerLine.minMax.y = std::max(varDescPerLine.minMax.y, variable);
-
-                multiVarData[lineID].push_back(variable);
             }
+            multiVarData[lineID].insert(multiVarData[lineID].end(), variableArray.begin(), variableArray.end());
 
             lineMultiVarDescs[lineID].push_back(varDescPerLine);
             varOffsetPerLine += variableArray.size();
         }
-        lineDescs[lineID].startIndex = lineOffset;
         lineDescs[lineID].numValues = varOffsetPerLine;
+    }
 
-        lineOffset += varOffsetPerLine;
-        lineID++;
+    // Compute min max values of all attributes across all trajectories and the offsets of the lines in the buffer.
+    std::vector<glm::vec2> attributesMinMax(
+            numVariables, glm::vec2(std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest()));
+    uint32_t lineOffset = 0;
+    for (uint32_t lineID = 0; lineID < numLines; lineID++) {
+        for (uint32_t v = 0; v < maxNumVariables; ++v) {
+            const glm::vec2& minMax = lineMultiVarDescs[lineID][v].minMax;
+            attributesMinMax[v].x = std::min(attributesMinMax[v].x, minMax.x);
+            attributesMinMax[v].y = std::max(attributesMinMax[v].y, minMax.y);
+        }
+        lineDescs[lineID].startIndex = lineOffset;
+        lineOffset += uint32_t(lineDescs[lineID].numValues);
     }
 
 
     // 3) Compute several equally-distributed / equi-distant points along Bezier curves.
     // Store these points in a new trajectory
-    float rollSegLength = avgSegLength / maxNumVariables;// avgSegLength * 0.2f;
+    const float rollSegLength = avgSegLength / maxNumVariables;// avgSegLength * 0.2f;
 
-    BezierTrajectories newTrajectories(inTrajectories.size());
+    newTrajectories.resize(numLines);
 
-    for (int32_t traj = 0; traj < int(inTrajectories.size()); ++traj) {
-        float curArcLength = 0.0f;
-        BezierTrajectory newTrajectory;
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(inTrajectories, newTrajectories, curves, curveArcLengths, curveArcLengthTables) \
+    shared(multiVarData, lineDescs, lineMultiVarDescs, attributesMinMax) \
+    shared(numLines, numVariables, rollSegLength, useArcLengthTables) default(none) schedule(dynamic)
+#endif
+    for (uint32_t traj = 0; traj < numLines; ++traj) {
+        BezierTrajectory& newTrajectory = newTrajectories[traj];
+        newTrajectory.lineDesc = lineDescs[traj];
+        newTrajectory.multiVarData = std::move(multiVarData[traj]);
+        newTrajectory.multiVarDescs = std::move(lineMultiVarDescs[traj]);
+        newTrajectory.attributes.resize(8);
 
         // Obtain set of Bezier Curves
-        std::vector<BezierCurve> &BCurves = curves[traj];
+        const std::vector<BezierCurve> &BCurves = curves[traj];
+        if (BCurves.empty()) {
+            continue;
+        }
         // Obtain total arc length
         const float totalArcLength = curveArcLengths[traj];
+        const float* arcLengthTables = useArcLengthTables ? curveArcLengthTables[traj].data() : nullptr;
 
+        float curArcLength = 0.0f;
         glm::vec3 pos;
         glm::vec3 tangent;
         uint32_t lineID = 0;
@@ -165,11 +206,8 @@ BezierTrajectories convertTrajectoriesToBezierCurves(const Trajectories &inTraje
         BCurves[0].evaluate(0, pos, tangent);
 
         newTrajectory.positions.push_back(pos);
-        //newTrajectory.tangents.push_back(tangent);
-        //newTrajectory.segmentID.push_back(lineID);
 
         // Now we store variable, min, and max, and var ID per vertex as new attributes
-        newTrajectory.attributes.resize(8);
         float varValue = inTrajectories[traj].attributes[varIDPerLine][lineID];
         newTrajectory.attributes[0].push_back(varValue);
         newTrajectory.attributes[1].push_back(attributesMinMax[varIDPerLine].x);
@@ -211,13 +249,23 @@ BezierTrajectories convertTrajectoriesToBezierCurves(const Trajectories &inTraje
 
             const auto &BCurve = BCurves[lineID];
 
-            float t = BCurve.solveTForArcLength(curArcLength - sumArcLengths);
+            float t;
+            if (useArcLengthTables) {
+                // The table may deviate slightly from the total arc length used for selecting the segment.
+                const float* arcLengthTable = arcLengthTables + lineID * ARC_LENGTH_TABLE_SIZE;
+                float tableArcLength = arcLengthTable[ARC_LENGTH_TABLE_SIZE - 1];
+                float arcLength = curArcLength - sumArcLengths;
+                if (BCurve.totalArcLength > 0.0f) {
+                    arcLength *= tableArcLength / BCurve.totalArcLength;
+                }
+                t = BCurve.solveTForArcLengthTable(arcLengthTable, ARC_LENGTH_TABLE_SIZE, arcLength);
+            } else {
+                t = BCurve.solveTForArcLength(curArcLength - sumArcLengths);
+            }
 
-            BCurves[lineID].evaluate(t, pos, tangent);
+            BCurve.evaluate(t, pos, tangent);
 
             newTrajectory.positions.push_back(pos);
-            //newTrajectory.tangents.push_back(tangent);
-            //newTrajectory.segmentID.push_back(lineID);
 
             if (varIDPerLine < numVariables) {
                 float varValue = inTrajectories[traj].attributes[varIDPerLine][lineID];
@@ -248,13 +296,7 @@ BezierTrajectories convertTrajectoriesToBezierCurves(const Trajectories &inTraje
             curArcLength += rollSegLength;
             varIDPerLine++;
         }
-
-        newTrajectory.lineDesc = lineDescs[traj];
-        newTrajectory.multiVarData = multiVarData[traj];
-        newTrajectory.multiVarDescs = lineMultiVarDescs[traj];
-
-        newTrajectories[traj] = newTrajectory;
     }
 
-    return newTrajectories;
+    return true;
 }
@@ -64,6 +64,23 @@ public:
 };
 typedef std::vector<BezierTrajectory> BezierTrajectories;
 
-BezierTrajectories convertTrajectoriesToBezierCurves(const Trajectories& inTrajectories);
+enum BezierArcLengthSolver {
+    /// Newton-Raphson iteration with a numerical integration of the arc length per step (reference solution).
+    BEZIER_ARC_LENGTH_SOLVER_NEWTON,
+    /// Binary search in an arc length table computed once per Bezier segment.
+    BEZIER_ARC_LENGTH_SOLVER_TABLE
+};
+
+/**
+ * Converts the passed trajectories to Bezier curves and resamples them equidistantly (one sample per variable).
+ * The trajectories are processed in parallel.
+ * @param inTrajectories The input trajectories.
+ * @param newTrajectories The resampled Bezier trajectories.
+ * @param arcLengthSolver How the curve parameter of an arc length is computed when resampling.
+ * @return False if the trajectories have no variables (an error is written to the log file).
+ */
+bool convertTrajectoriesToBezierCurves(
+        const Trajectories& inTrajectories, BezierTrajectories& newTrajectories,
+        BezierArcLengthSolver arcLengthSolver = BEZIER_ARC_LENGTH_SOLVER_TABLE);
 
 #endif //STRESSLINEVIS_BEZIERTRAJECTORY_HPP
@@ -47,23 +47,11 @@ void MultiVarWindow::setAttributes(
         const std::vector<std::string> &_names) {
     // Set min/max and further information here
     // Maybe also KDE for Violin Plots
-    // Copy Constructor
-    attributes = _variables;
     names = _names;
-    variablesMinMax.clear();
-
-    for (const std::vector<float> &attrList : attributes) {
-        float minValue = std::numeric_limits<float>::max();
-        float maxValue = std::numeric_limits<float>::lowest();
-#if _OPENMP >= 201107
-        #pragma omp parallel for reduction(min: minValue) reduction(max: maxValue) shared(attrList) default(none)
-#endif
-        for (size_t i = 0; i < attrList.size(); i++) {
-            float value = attrList.at(i);
-            minValue = std::min(minValue, value);
-            maxValue = std::max(maxValue, value);
-        }
-        variablesMinMax.emplace_back(minValue, maxValue);
+    attributeHistograms.clear();
+    attributeHistograms.resize(_variables.size());
+    for (size_t v = 0; v < _variables.size(); ++v) {
+        attributeHistograms[v].build(_variables[v]);
     }
 
     // Recompute histograms
@@ -91,31 +79,12 @@ bool MultiVarWindow::renderGui() {
 }
 
 void MultiVarWindow::computeHistograms() {
-    histograms.resize(attributes.size());
-
-    for (auto v = 0; v < attributes.size(); ++v) {
-        float histogramsMax = 0;
-
-        const auto& var = attributes[v];
-        const auto& minMax = variablesMinMax[v];
-        auto& histogram = histograms[v];
-        histogram = std::vector<float>(histogramRes, 0.0f);
-
-        for (const auto &value : var) {
-            int32_t index = glm::clamp(
-                    static_cast<int32_t>((value - minMax.x) / (minMax.y - minMax.x)
-                    * static_cast<float>(histogramRes)), 0, histogramRes - 1);
-            histogram[index]++;
-        }
-
-        // Normalize values of histogram
-        for (const auto &numBin : histogram) {
-            histogramsMax = std::max(histogramsMax, numBin);
-        }
+    histograms.resize(attributeHistograms.size());
 
-        for (auto &numBin : histogram) {
-            numBin /= histogramsMax;
-        }
+    // Derived from the cached histograms, i.e., changing the resolution does not touch the attribute values.
+    for (size_t v = 0; v < attributeHistograms.size(); ++v) {
+        const AttributeHistogram& attributeHistogram = attributeHistograms[v];
+        attributeHistogram.getNormalizedHistogram(attributeHistogram.getDataRange(), histogramRes, histograms[v]);
     }
 }
 
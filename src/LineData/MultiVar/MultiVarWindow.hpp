@@ -36,6 +36,8 @@
 #include <Graphics/Color.hpp>
 #include <ImGui/ImGuiWrapper.hpp>
 
+#include "Utils/Histogram.hpp"
+
 class MultiVarWindow {
 public:
     MultiVarWindow();
@@ -59,10 +61,9 @@ protected:
     int32_t variableIndex;
     sgl::Color clearColor;
     int32_t histogramRes;
-    std::vector<std::vector<float>> attributes;
+    std::vector<AttributeHistogram> attributeHistograms; ///< Built once when the attributes are set.
     std::vector<std::string> names;
     std::vector<std::vector<float>> histograms;
-    std::vector<glm::vec2> variablesMinMax;
 
     void computeHistograms();
     // Render a VIS graph for the currently selected variable
@@ -0,0 +1,434 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+#include "FlatKdTree.hpp"
+
+void FlatKdTree::build(const std::vector<IndexedPoint*>& indexedPoints) {
+    const size_t numPoints = indexedPoints.size();
+    std::vector<BuildPoint> buildPoints(numPoints);
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(indexedPoints, numPoints, buildPoints) default(none)
+#endif
+    for (size_t i = 0; i < numPoints; i++) {
+        IndexedPoint* indexedPoint = indexedPoints[i];
+        buildPoints[i].position = indexedPoint->position;
+        buildPoints[i].point = indexedPoint;
+    }
+
+#if _OPENMP >= 201107
+    #pragma omp parallel default(none) shared(buildPoints, numPoints)
+    #pragma omp single
+#endif
+    buildRecursive(buildPoints, 0, uint32_t(numPoints), 0);
+
+    for (int axis = 0; axis < 3; axis++) {
+        coordinates[axis].resize(numPoints);
+    }
+    points.resize(numPoints);
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numPoints, buildPoints) default(none)
+#endif
+    for (size_t i = 0; i < numPoints; i++) {
+        const BuildPoint& buildPoint = buildPoints[i];
+        coordinates[0][i] = buildPoint.position.x;
+        coordinates[1][i] = buildPoint.position.y;
+        coordinates[2][i] = buildPoint.position.z;
+        points[i] = buildPoint.point;
+    }
+}
+
+void FlatKdTree::buildRecursive(std::vector<BuildPoint>& buildPoints, uint32_t begin, uint32_t end, uint32_t depth) {
+    if (end - begin <= MAX_LEAF_SIZE) {
+        return;
+    }
+
+    const uint32_t axis = depth % 3;
+    const uint32_t mid = begin + (end - begin) / 2;
+    std::nth_element(
+            buildPoints.begin() + begin, buildPoints.begin() + mid, buildPoints.begin() + end,
+            [axis](const BuildPoint& a, const BuildPoint& b) {
+                return a.position[axis] < b.position[axis];
+            });
+
+    const bool useTasks = depth < MAX_TASK_DEPTH && end - begin >= MIN_TASK_SIZE;
+    if (useTasks) {
+#if _OPENMP >= 201107
+        #pragma omp task default(none) shared(buildPoints) firstprivate(begin, mid, depth)
+#endif
+        buildRecursive(buildPoints, begin, mid, depth + 1);
+        buildRecursive(buildPoints, mid + 1, end, depth + 1);
+#if _OPENMP >= 201107
+        #pragma omp taskwait
+#endif
+    } else {
+        buildRecursive(buildPoints, begin, mid, depth + 1);
+        buildRecursive(buildPoints, mid + 1, end, depth + 1);
+    }
+}
+
+void FlatKdTree::computeDistancesSquared(
+        uint32_t begin, uint32_t count, const glm::vec3& point, float* distancesSquared) const {
+    const float* xs = coordinates[0].data() + begin;
+    const float* ys = coordinates[1].data() + begin;
+    const float* zs = coordinates[2].data() + begin;
+#if _OPENMP >= 201307
+    #pragma omp simd
+#endif
+    for (uint32_t i = 0; i < count; i++) {
+        float dx = xs[i] - point.x;
+        float dy = ys[i] - point.y;
+        float dz = zs[i] - point.z;
+        distancesSquared[i] = dx * dx + dy * dy + dz * dz;
+    }
+}
+
+std::vector<IndexedPoint*> FlatKdTree::findPointsInAxisAlignedBox(const AxisAlignedBox& box) {
+    std::vector<IndexedPoint*> pointsInBox;
+    findPointsInAxisAlignedBox(box, pointsInBox);
+    return pointsInBox;
+}
+
+std::vector<IndexedPoint*> FlatKdTree::findPointsInSphere(const glm::vec3& center, float radius) {
+    std::vector<IndexedPoint*> pointsInSphere;
+    findPointsInSphere(center, radius, pointsInSphere);
+    return pointsInSphere;
+}
+
+void FlatKdTree::findPointsInAxisAlignedBox(
+        const AxisAlignedBox& box, std::vector<IndexedPoint*>& pointsInBox) const {
+    QueryStackEntry stack[MAX_STACK_SIZE];
+    uint32_t stackSize = 0;
+    if (!points.empty()) {
+        stack[stackSize++] = { 0, uint32_t(points.size()), 0, 0.0f };
+    }
+
+    while (stackSize > 0) {
+        const QueryStackEntry entry = stack[--stackSize];
+        if (entry.end - entry.begin <= MAX_LEAF_SIZE) {
+            for (uint32_t i = entry.begin; i < entry.end; i++) {
+                if (box.contains(glm::vec3(coordinates[0][i], coordinates[1][i], coordinates[2][i]))) {
+                    pointsInBox.push_back(points[i]);
+                }
+            }
+            continue;
+        }
+
+        const uint32_t mid = entry.begin + (entry.end - entry.begin) / 2;
+        if (box.contains(glm::vec3(coordinates[0][mid], coordinates[1][mid], coordinates[2][mid]))) {
+            pointsInBox.push_back(points[mid]);
+        }
+
+        const uint32_t childAxis = (entry.axis + 1) % 3;
+        const float splitPosition = coordinates[entry.axis][mid];
+        if (box.max[entry.axis] >= splitPosition) {
+            stack[stackSize++] = { mid + 1, entry.end, childAxis, 0.0f };
+        }
+        if (box.min[entry.axis] <= splitPosition) {
+            stack[stackSize++] = { entry.begin, mid, childAxis, 0.0f };
+        }
+    }
+}
+
+void FlatKdTree::findPointsInSphere(
+        const glm::vec3& center, float radius, std::vector<IndexedPoint*>& pointsInSphere) const {
+    const float radiusSquared = radius * radius;
+    float distancesSquared[MAX_LEAF_SIZE];
+    QueryStackEntry stack[MAX_STACK_SIZE];
+    uint32_t stackSize = 0;
+    if (!points.empty()) {
+        stack[stackSize++] = { 0, uint32_t(points.size()), 0, 0.0f };
+    }
+
+    while (stackSize > 0) {
+        const QueryStackEntry entry = stack[--stackSize];
+        const uint32_t count = entry.end - entry.begin;
+        if (count <= MAX_LEAF_SIZE) {
+            computeDistancesSquared(entry.begin, count, center, distancesSquared);
+            for (uint32_t i = 0; i < count; i++) {
+                if (distancesSquared[i] <= radiusSquared) {
+                    pointsInSphere.push_back(points[entry.begin + i]);
+                }
+            }
+            continue;
+        }
+
+        const uint32_t mid = entry.begin + (entry.end - entry.begin) / 2;
+        computeDistancesSquared(mid, 1, center, distancesSquared);
+        if (distancesSquared[0] <= radiusSquared) {
+            pointsInSphere.push_back(points[mid]);
+        }
+
+        const uint32_t childAxis = (entry.axis + 1) % 3;
+        const float splitOffset = center[entry.axis] - coordinates[entry.axis][mid];
+        if (splitOffset <= radius) {
+            stack[stackSize++] = { entry.begin, mid, childAxis, 0.0f };
+        }
+        if (splitOffset >= -radius) {
+            stack[stackSize++] = { mid + 1, entry.end, childAxis, 0.0f };
+        }
+    }
+}
+
+uint32_t FlatKdTree::findNearestNeighborIndex(const glm::vec3& point) const {
+    uint32_t nearestNeighborIndex = 0;
+    float nearestNeighborDistanceSquared = std::numeric_limits<float>::max();
+    float distancesSquared[MAX_LEAF_SIZE];
+
+    QueryStackEntry stack[MAX_STACK_SIZE];
+    uint32_t stackSize = 0;
+    stack[stackSize++] = { 0, uint32_t(points.size()), 0, 0.0f };
+
+    while (stackSize > 0) {
+        const QueryStackEntry entry = stack[--stackSize];
+        // Skip sub-trees on the far side of a split plane that is farther away than the nearest neighbor found so far.
+        if (entry.splitDistanceSquared > nearestNeighborDistanceSquared) {
+            continue;
+        }
+
+        const uint32_t count = entry.end - entry.begin;
+        if (count <= MAX_LEAF_SIZE) {
+            computeDistancesSquared(entry.begin, count, point, distancesSquared);
+            for (uint32_t i = 0; i < count; i++) {
+                if (distancesSquared[i] < nearestNeighborDistanceSquared) {
+                    nearestNeighborDistanceSquared = distancesSquared[i];
+                    nearestNeighborIndex = entry.begin + i;
+                }
+            }
+            continue;
+        }
+
+        // Compute the distance of this node to the point.
+        const uint32_t mid = entry.begin + count / 2;
+        computeDistancesSquared(mid, 1, point, distancesSquared);
+        if (distancesSquared[0] < nearestNeighborDistanceSquared) {
+            nearestNeighborDistanceSquared = distancesSquared[0];
+            nearestNeighborIndex = mid;
+        }
+
+        // Descend on the side of the split plane where the point lies first (i.e., push it last).
+        const uint32_t childAxis = (entry.axis + 1) % 3;
+        const float splitOffset = point[entry.axis] - coordinates[entry.axis][mid];
+        const float farDistanceSquared = std::max(entry.splitDistanceSquared, splitOffset * splitOffset);
+        if (splitOffset <= 0.0f) {
+            stack[stackSize++] = { mid + 1, entry.end, childAxis, farDistanceSquared };
+            stack[stackSize++] = { entry.begin, mid, childAxis, entry.splitDistanceSquared };
+        } else {
+            stack[stackSize++] = { entry.begin, mid, childAxis, farDistanceSquared };
+            stack[stackSize++] = { mid + 1, entry.end, childAxis, entry.splitDistanceSquared };
+        }
+    }
+
+    return nearestNeighborIndex;
+}
+
+IndexedPoint* FlatKdTree::findNearestNeighbor(const glm::vec3& point) const {
+    if (points.empty()) {
+        return nullptr;
+    }
+    return points[findNearestNeighborIndex(point)];
+}
+
+void FlatKdTree::findKNearestNeighborsHeap(
+        const glm::vec3& point, size_t k, std::vector<NeighborEntry>& heap) const {
+    heap.clear();
+    if (k == 0) {
+        return;
+    }
+    float distancesSquared[MAX_LEAF_SIZE];
+
+    // The heap holds the k closest points found so far with the farthest of them at the front.
+    auto insertNeighbor = [&heap, k](float distanceSquared, uint32_t idx) {
+        if (heap.size() < k) {
+            heap.push_back(NeighborEntry(distanceSquared, idx));
+            std::push_heap(heap.begin(), heap.end());
+        } else if (distanceSquared < heap.front().first) {
+            std::pop_heap(heap.begin(), heap.end());
+            heap.back() = NeighborEntry(distanceSquared, idx);
+            std::push_heap(heap.begin(), heap.end());
+        }
+    };
+
+    QueryStackEntry stack[MAX_STACK_SIZE];
+    uint32_t stackSize = 0;
+    if (!points.empty()) {
+        stack[stackSize++] = { 0, uint32_t(points.size()), 0, 0.0f };
+    }
+
+    while (stackSize > 0) {
+        const QueryStackEntry entry = stack[--stackSize];
+        if (heap.size() == k && entry.splitDistanceSquared > heap.front().first) {
+            continue;
+        }
+
+        const uint32_t count = entry.end - entry.begin;
+        if (count <= MAX_LEAF_SIZE) {
+            computeDistancesSquared(entry.begin, count, point, distancesSquared);
+            for (uint32_t i = 0; i < count; i++) {
+                insertNeighbor(distancesSquared[i], entry.begin + i);
+            }
+            continue;
+        }
+
+        const uint32_t mid = entry.begin + count / 2;
+        computeDistancesSquared(mid, 1, point, distancesSquared);
+        insertNeighbor(distancesSquared[0], mid);
+
+        const uint32_t childAxis = (entry.axis + 1) % 3;
+        const float splitOffset = point[entry.axis] - coordinates[entry.axis][mid];
+        const float farDistanceSquared = std::max(entry.splitDistanceSquared, splitOffset * splitOffset);
+        if (splitOffset <= 0.0f) {
+            stack[stackSize++] = { mid + 1, entry.end, childAxis, farDistanceSquared };
+            stack[stackSize++] = { entry.begin, mid, childAxis, entry.splitDistanceSquared };
+        } else {
+            stack[stackSize++] = { entry.begin, mid, childAxis, farDistanceSquared };
+            stack[stackSize++] = { mid + 1, entry.end, childAxis, entry.splitDistanceSquared };
+        }
+    }
+
+    std::sort_heap(heap.begin(), heap.end());
+}
+
+void FlatKdTree::findKNearestNeighbors(
+        const glm::vec3& point, size_t k, std::vector<IndexedPoint*>& kNearestNeighbors) const {
+    std::vector<NeighborEntry> heap;
+    heap.reserve(k);
+    findKNearestNeighborsHeap(point, k, heap);
+    kNearestNeighbors.clear();
+    for (const NeighborEntry& neighbor : heap) {
+        kNearestNeighbors.push_back(points[neighbor.second]);
+    }
+}
+
+void FlatKdTree::computeQueryOrder(const std::vector<glm::vec3>& queryPoints, std::vector<uint32_t>& queryOrder) {
+    const size_t numQueries = queryPoints.size();
+    glm::vec3 minPosition(std::numeric_limits<float>::max());
+    glm::vec3 maxPosition(std::numeric_limits<float>::lowest());
+    for (const glm::vec3& queryPoint : queryPoints) {
+        minPosition = glm::min(minPosition, queryPoint);
+        maxPosition = glm::max(maxPosition, queryPoint);
+    }
+    const glm::vec3 extent = glm::max(maxPosition - minPosition, glm::vec3(std::numeric_limits<float>::min()));
+
+    // 30-bit Morton code (10 bits per axis) in the upper and the query index in the lower half of the sort key.
+    std::vector<uint64_t> sortKeys(numQueries);
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(queryPoints, numQueries, sortKeys, minPosition, extent) default(none)
+#endif
+    for (size_t i = 0; i < numQueries; i++) {
+        glm::vec3 normalizedPosition = (queryPoints[i] - minPosition) / extent;
+        uint64_t mortonCode = 0;
+        for (int axis = 0; axis < 3; axis++) {
+            auto cell = uint64_t(std::min(std::max(normalizedPosition[axis] * 1024.0f, 0.0f), 1023.0f));
+            for (int bit = 0; bit < 10; bit++) {
+                mortonCode |= ((cell >> bit) & 1u) << (3 * bit + axis);
+            }
+        }
+        sortKeys[i] = (mortonCode << 32) | uint64_t(i);
+    }
+    std::sort(sortKeys.begin(), sortKeys.end());
+
+    queryOrder.resize(numQueries);
+    for (size_t i = 0; i < numQueries; i++) {
+        queryOrder[i] = uint32_t(sortKeys[i] & 0xFFFFFFFFu);
+    }
+}
+
+void FlatKdTree::findNearestNeighbors(
+        const std::vector<glm::vec3>& queryPoints, std::vector<IndexedPoint*>& nearestNeighbors) const {
+    const size_t numQueries = queryPoints.size();
+    nearestNeighbors.resize(numQueries);
+    if (points.empty()) {
+        std::fill(nearestNeighbors.begin(), nearestNeighbors.end(), nullptr);
+        return;
+    }
+
+    std::vector<uint32_t> queryOrder;
+    computeQueryOrder(queryPoints, queryOrder);
+
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(queryPoints, numQueries, queryOrder, nearestNeighbors) default(none)
+#endif
+    for (size_t i = 0; i < numQueries; i++) {
+        uint32_t queryIdx = queryOrder[i];
+        nearestNeighbors[queryIdx] = points[findNearestNeighborIndex(queryPoints[queryIdx])];
+    }
+}
+
+void FlatKdTree::findKNearestNeighbors(
+        const std::vector<glm::vec3>& queryPoints, size_t k, std::vector<IndexedPoint*>& kNearestNeighbors) const {
+    const size_t numQueries = queryPoints.size();
+    kNearestNeighbors.clear();
+    kNearestNeighbors.resize(numQueries * k, nullptr);
+
+    std::vector<uint32_t> queryOrder;
+    computeQueryOrder(queryPoints, queryOrder);
+
+#if _OPENMP >= 201107
+    #pragma omp parallel shared(queryPoints, numQueries, k, queryOrder, kNearestNeighbors) default(none)
+#endif
+    {
+        std::vector<NeighborEntry> heap;
+        heap.reserve(k);
+#if _OPENMP >= 201107
+        #pragma omp for
+#endif
+        for (size_t i = 0; i < numQueries; i++) {
+            uint32_t queryIdx = queryOrder[i];
+            findKNearestNeighborsHeap(queryPoints[queryIdx], k, heap);
+            IndexedPoint** queryNeighbors = kNearestNeighbors.data() + queryIdx * k;
+            for (size_t j = 0; j < heap.size(); j++) {
+                queryNeighbors[j] = points[heap[j].second];
+            }
+        }
+    }
+}
+
+void FlatKdTree::findPointsInSpheres(
+        const std::vector<glm::vec3>& queryPoints, float radius,
+        std::vector<std::vector<IndexedPoint*>>& pointsInSpheres) const {
+    const size_t numQueries = queryPoints.size();
+    pointsInSpheres.resize(numQueries);
+
+    std::vector<uint32_t> queryOrder;
+    computeQueryOrder(queryPoints, queryOrder);
+
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(queryPoints, numQueries, radius, queryOrder, pointsInSpheres) default(none) \
+    schedule(dynamic, 64)
+#endif
+    for (size_t i = 0; i < numQueries; i++) {
+        uint32_t queryIdx = queryOrder[i];
+        std::vector<IndexedPoint*>& pointsInSphere = pointsInSpheres[queryIdx];
+        pointsInSphere.clear();
+        findPointsInSphere(queryPoints[queryIdx], radius, pointsInSphere);
+    }
+}
@@ -0,0 +1,171 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef FLAT_KDTREE_H_
+#define FLAT_KDTREE_H_
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+#include "SearchStructure.hpp"
+
+/**
+ * A k-d-tree stored implicitly in contiguous arrays. The node of the index range [begin, end) of the arrays is the
+ * median element begin + (end - begin) / 2, and its children are the ranges left and right of it. The split axis is
+ * the depth of the node modulo 3 (as in @see KdTree), so no child pointers or axes need to be stored. Ranges with at
+ * most MAX_LEAF_SIZE points are not split any further, but are stored as leaf buckets that are scanned linearly.
+ * The point coordinates are stored as a structure of arrays, such that the distance computations of a bucket can be
+ * vectorized.
+ * The tree is built by nth_element partitioning in place, where the sub-trees of the top levels are built in parallel
+ * using OpenMP tasks. All queries are iterative and use a small stack on the call stack, i.e., they are thread-safe.
+ * The batch queries spatially sort the query points and process them in parallel.
+ * NOTE: The ownership of the memory the IndexedPoint objects lies in the responsibility of the user.
+ */
+class FlatKdTree : public SearchStructure
+{
+public:
+    /**
+     * Builds a k-d-tree from the passed point array.
+     * @param indexedPoints The point array.
+     */
+    void build(const std::vector<IndexedPoint*>& indexedPoints) override;
+
+    /**
+     * Performs an area search in the k-d-tree and returns all points within a certain bounding box.
+     * @param box The bounding box.
+     * @return The points stored in the k-d-tree inside of the bounding box.
+     */
+    std::vector<IndexedPoint*> findPointsInAxisAlignedBox(const AxisAlignedBox& box) override;
+
+    /**
+     * Performs an area search in the k-d-tree and returns all points within a certain distance to some center point.
+     * @param centerPoint The center point.
+     * @param radius The search radius.
+     * @return The points stored in the k-d-tree inside of the search radius.
+     */
+    std::vector<IndexedPoint*> findPointsInSphere(const glm::vec3& center, float radius) override;
+
+    /**
+     * Returns the nearest neighbor in the k-d-tree to the passed point position.
+     * @param point The point to which to find the closest neighbor to.
+     * @return The closest neighbor (or nullptr if the tree is empty).
+     */
+    IndexedPoint* findNearestNeighbor(const glm::vec3& point) const;
+
+    /**
+     * Returns the k nearest neighbors in the k-d-tree to the passed point position.
+     * @param point The point to which to find the closest neighbors to.
+     * @param k The number of neighbors to find.
+     * @param kNearestNeighbors The min(k, number of points) closest neighbors sorted by increasing distance.
+     */
+    void findKNearestNeighbors(
+            const glm::vec3& point, size_t k, std::vector<IndexedPoint*>& kNearestNeighbors) const;
+
+    /**
+     * Batched version of @see findNearestNeighbor.
+     * @param queryPoints The points to which to find the closest neighbors to.
+     * @param nearestNeighbors The closest neighbor of each query point (or nullptr if the tree is empty).
+     */
+    void findNearestNeighbors(
+            const std::vector<glm::vec3>& queryPoints, std::vector<IndexedPoint*>& nearestNeighbors) const;
+
+    /**
+     * Batched version of @see findKNearestNeighbors.
+     * @param queryPoints The points to which to find the closest neighbors to.
+     * @param k The number of neighbors to find per query point.
+     * @param kNearestNeighbors The k closest neighbors of query point i sorted by increasing distance are stored at the
+     * indices [i * k, (i + 1) * k). If the tree contains less than k points, the remaining entries are nullptr.
+     */
+    void findKNearestNeighbors(
+            const std::vector<glm::vec3>& queryPoints, size_t k, std::vector<IndexedPoint*>& kNearestNeighbors) const;
+
+    /**
+     * Batched version of @see findPointsInSphere.
+     * @param queryPoints The center points.
+     * @param radius The search radius.
+     * @param pointsInSpheres The points inside of the search radius of each query point.
+     */
+    void findPointsInSpheres(
+            const std::vector<glm::vec3>& queryPoints, float radius,
+            std::vector<std::vector<IndexedPoint*>>& pointsInSpheres) const;
+
+    inline size_t getNumPoints() const { return points.size(); }
+
+private:
+    /// A range of the arrays still to be traversed by a query.
+    struct QueryStackEntry {
+        uint32_t begin;
+        uint32_t end;
+        uint32_t axis;
+        float splitDistanceSquared; ///< Lower bound of the squared distance of the points in the range.
+    };
+    /// Max-heap entry of the k nearest neighbor search (squared distance, point index).
+    typedef std::pair<float, uint32_t> NeighborEntry;
+
+    /// Point with its position used for partitioning the points during the build.
+    struct BuildPoint {
+        glm::vec3 position;
+        IndexedPoint* point;
+    };
+
+    /**
+     * Partitions the passed range of the build point array recursively (for internal use only).
+     * @param buildPoints The points to partition.
+     * @param begin The first point of the range.
+     * @param end The end of the range.
+     * @param depth The depth of the node of the range.
+     */
+    void buildRecursive(std::vector<BuildPoint>& buildPoints, uint32_t begin, uint32_t end, uint32_t depth);
+
+    /// Computes the squared distances of the points [begin, begin + count) to the passed point.
+    void computeDistancesSquared(uint32_t begin, uint32_t count, const glm::vec3& point, float* distancesSquared) const;
+
+    void findPointsInAxisAlignedBox(const AxisAlignedBox& box, std::vector<IndexedPoint*>& pointsInBox) const;
+    void findPointsInSphere(const glm::vec3& center, float radius, std::vector<IndexedPoint*>& pointsInSphere) const;
+    uint32_t findNearestNeighborIndex(const glm::vec3& point) const;
+    /// Leaves the k nearest neighbors in the passed heap, which is sorted by increasing distance afterwards.
+    void findKNearestNeighborsHeap(const glm::vec3& point, size_t k, std::vector<NeighborEntry>& heap) const;
+
+    /**
+     * Sorts the query points along a Morton curve in order to increase the cache locality of batched queries.
+     * @param queryPoints The query points.
+     * @param queryOrder The permutation of the query point indices.
+     */
+    static void computeQueryOrder(const std::vector<glm::vec3>& queryPoints, std::vector<uint32_t>& queryOrder);
+
+    static const uint32_t MAX_LEAF_SIZE = 8; ///< Ranges with at most this many points are stored as leaf buckets.
+    static const uint32_t MAX_STACK_SIZE = 128; ///< Sufficient for a balanced tree with 2^63 points.
+    static const uint32_t MAX_TASK_DEPTH = 8; ///< Sub-trees below this depth are built by the spawning thread.
+    static const uint32_t MIN_TASK_SIZE = 16384; ///< Ranges smaller than this are not split into tasks.
+
+    std::vector<float> coordinates[3]; ///< The x, y and z coordinates of the points in tree order.
+    std::vector<IndexedPoint*> points; ///< The points in tree order.
+};
+
+#endif //FLAT_KDTREE_H_
@@ -0,0 +1,284 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+#include "HexahedralCellGrid.hpp"
+
+/// Local coordinates of the hexahedron corners in VTK vertex order.
+static const int HEX_CORNER_TABLE[8][3] = {
+        { 0,0,0 }, { 1,0,0 }, { 1,1,0 }, { 0,1,0 }, { 0,0,1 }, { 1,0,1 }, { 1,1,1 }, { 0,1,1 }
+};
+
+bool computeHexahedronLocalCoordinates(
+        const glm::vec3 cornerPositions[8], const glm::vec3& position, glm::vec3& localCoordinates) {
+    // The positions are made relative to the first corner. Otherwise, the float precision of the residual in cells
+    // far away from the origin is too low for the convergence criterion.
+    glm::vec3 relativeCornerPositions[8];
+    for (int i = 0; i < 8; i++) {
+        relativeCornerPositions[i] = cornerPositions[i] - cornerPositions[0];
+    }
+    const glm::vec3 relativePosition = position - cornerPositions[0];
+
+    // Newton iterations for inverting the trilinear mapping x(u, v, w) = sum_i N_i(u, v, w) x_i.
+    glm::vec3 uvw(0.5f);
+    for (int iteration = 0; iteration < 16; iteration++) {
+        glm::vec3 mappedPosition(0.0f), dxdu(0.0f), dxdv(0.0f), dxdw(0.0f);
+        for (int i = 0; i < 8; i++) {
+            const int* corner = HEX_CORNER_TABLE[i];
+            float nu = corner[0] ? uvw.x : 1.0f - uvw.x;
+            float nv = corner[1] ? uvw.y : 1.0f - uvw.y;
+            float nw = corner[2] ? uvw.z : 1.0f - uvw.z;
+            float su = corner[0] ? 1.0f : -1.0f;
+            float sv = corner[1] ? 1.0f : -1.0f;
+            float sw = corner[2] ? 1.0f : -1.0f;
+            mappedPosition += (nu * nv * nw) * relativeCornerPositions[i];
+            dxdu += (su * nv * nw) * relativeCornerPositions[i];
+            dxdv += (nu * sv * nw) * relativeCornerPositions[i];
+            dxdw += (nu * nv * sw) * relativeCornerPositions[i];
+        }
+        glm::mat3 jacobian(dxdu, dxdv, dxdw);
+        if (std::abs(glm::determinant(jacobian)) < 1e-30f) {
+            localCoordinates = uvw;
+            return false;
+        }
+        glm::vec3 delta = glm::inverse(jacobian) * (mappedPosition - relativePosition);
+        // Keep the iterations from diverging for positions far outside of the cell.
+        uvw = glm::clamp(uvw - delta, -1.0f, 2.0f);
+        if (std::abs(delta.x) < 1e-5f && std::abs(delta.y) < 1e-5f && std::abs(delta.z) < 1e-5f) {
+            localCoordinates = uvw;
+            return true;
+        }
+    }
+    localCoordinates = uvw;
+    return false;
+}
+
+
+const float HexahedralCellGrid::TARGET_NUM_GRID_CELLS_PER_CELL = 1.0f;
+
+void HexahedralCellGrid::clear() {
+    vertices = nullptr;
+    cellIndices = nullptr;
+    cellBoundsMin.clear();
+    cellBoundsMax.clear();
+    minBounds = glm::vec3(0.0f);
+    maxBounds = glm::vec3(0.0f);
+    averageCellExtent = 0.0f;
+    gridCellSize = 0.0f;
+    gridResolution = glm::ivec3(0);
+    gridCellOffsets.clear();
+    gridCellReferences.clear();
+}
+
+void HexahedralCellGrid::build(const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& cellIndices) {
+    clear();
+    const size_t numCells = cellIndices.size() / 8;
+    if (numCells == 0) {
+        return;
+    }
+    this->vertices = &vertices;
+    this->cellIndices = &cellIndices;
+
+    // Compute the bounding boxes of the cells and of the whole mesh.
+    cellBoundsMin.resize(numCells);
+    cellBoundsMax.resize(numCells);
+    float minX = std::numeric_limits<float>::max(), minY = minX, minZ = minX;
+    float maxX = std::numeric_limits<float>::lowest(), maxY = maxX, maxZ = maxX;
+    double extentSum = 0.0;
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(vertices, cellIndices, numCells) default(none) \
+    reduction(min: minX, minY, minZ) reduction(max: maxX, maxY, maxZ) reduction(+: extentSum)
+#endif
+    for (size_t cellIdx = 0; cellIdx < numCells; cellIdx++) {
+        glm::vec3 cellMin(std::numeric_limits<float>::max()), cellMax(std::numeric_limits<float>::lowest());
+        for (int i = 0; i < 8; i++) {
+            const glm::vec3& vertex = vertices[cellIndices[cellIdx * 8 + i]];
+            cellMin = glm::min(cellMin, vertex);
+            cellMax = glm::max(cellMax, vertex);
+        }
+        cellBoundsMin[cellIdx] = cellMin;
+        cellBoundsMax[cellIdx] = cellMax;
+        minX = std::min(minX, cellMin.x);
+        minY = std::min(minY, cellMin.y);
+        minZ = std::min(minZ, cellMin.z);
+        maxX = std::max(maxX, cellMax.x);
+        maxY = std::max(maxY, cellMax.y);
+        maxZ = std::max(maxZ, cellMax.z);
+        glm::vec3 cellExtent = cellMax - cellMin;
+        extentSum += double(cellExtent.x + cellExtent.y + cellExtent.z) / 3.0;
+    }
+    minBounds = glm::vec3(minX, minY, minZ);
+    maxBounds = glm::vec3(maxX, maxY, maxZ);
+    averageCellExtent = float(extentSum / double(numCells));
+    const glm::vec3 extent = maxBounds - minBounds;
+    const float maxExtent = std::max(extent.x, std::max(extent.y, extent.z));
+
+    // Derive the grid cell size from the cell density. Flat extents are clamped so that planar meshes still work.
+    if (maxExtent <= 0.0f) {
+        gridCellSize = 1.0f;
+    } else {
+        glm::vec3 clampedExtent = glm::max(extent, glm::vec3(maxExtent * 1e-3f));
+        double volume = double(clampedExtent.x) * double(clampedExtent.y) * double(clampedExtent.z);
+        gridCellSize = float(std::cbrt(volume / (double(TARGET_NUM_GRID_CELLS_PER_CELL) * double(numCells))));
+    }
+    const double maxNumGridCells = double(8 * numCells + 1);
+    double resolution[3];
+    while (true) {
+        for (int i = 0; i < 3; i++) {
+            resolution[i] = std::floor(double(extent[i]) / double(gridCellSize)) + 1.0;
+        }
+        if (resolution[0] * resolution[1] * resolution[2] <= maxNumGridCells) {
+            break;
+        }
+        gridCellSize *= 1.25f;
+    }
+    gridResolution = glm::ivec3(int(resolution[0]), int(resolution[1]), int(resolution[2]));
+    const size_t numGridCells = size_t(gridResolution.x) * size_t(gridResolution.y) * size_t(gridResolution.z);
+    glm::ivec3 maxGridPosition = gridResolution - glm::ivec3(1);
+
+    // Counting sort, pass 1: Count the number of mesh cells overlapping each grid cell.
+    gridCellOffsets.resize(numGridCells + 1, 0);
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numCells, maxGridPosition) default(none)
+#endif
+    for (size_t cellIdx = 0; cellIdx < numCells; cellIdx++) {
+        glm::ivec3 lower = glm::clamp(
+                glm::ivec3(glm::floor((cellBoundsMin[cellIdx] - minBounds) / gridCellSize)),
+                glm::ivec3(0), maxGridPosition);
+        glm::ivec3 upper = glm::clamp(
+                glm::ivec3(glm::floor((cellBoundsMax[cellIdx] - minBounds) / gridCellSize)),
+                glm::ivec3(0), maxGridPosition);
+        for (int z = lower.z; z <= upper.z; z++) {
+            for (int y = lower.y; y <= upper.y; y++) {
+                for (int x = lower.x; x <= upper.x; x++) {
+                    size_t gridCellIdx =
+                            size_t(x) + size_t(gridResolution.x) * (size_t(y) + size_t(gridResolution.y) * size_t(z));
+#if _OPENMP >= 201107
+                    #pragma omp atomic
+#endif
+                    gridCellOffsets[gridCellIdx + 1]++;
+                }
+            }
+        }
+    }
+
+    // Pass 2: Prefix sum over the counts.
+    for (size_t gridCellIdx = 0; gridCellIdx < numGridCells; gridCellIdx++) {
+        gridCellOffsets[gridCellIdx + 1] += gridCellOffsets[gridCellIdx];
+    }
+
+    // Pass 3: Scatter the cell references to the grid cells.
+    std::vector<uint32_t> writeOffsets(gridCellOffsets.begin(), gridCellOffsets.end() - 1);
+    gridCellReferences.resize(gridCellOffsets.back());
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numCells, maxGridPosition, writeOffsets) default(none)
+#endif
+    for (size_t cellIdx = 0; cellIdx < numCells; cellIdx++) {
+        glm::ivec3 lower = glm::clamp(
+                glm::ivec3(glm::floor((cellBoundsMin[cellIdx] - minBounds) / gridCellSize)),
+                glm::ivec3(0), maxGridPosition);
+        glm::ivec3 upper = glm::clamp(
+                glm::ivec3(glm::floor((cellBoundsMax[cellIdx] - minBounds) / gridCellSize)),
+                glm::ivec3(0), maxGridPosition);
+        for (int z = lower.z; z <= upper.z; z++) {
+            for (int y = lower.y; y <= upper.y; y++) {
+                for (int x = lower.x; x <= upper.x; x++) {
+                    size_t gridCellIdx =
+                            size_t(x) + size_t(gridResolution.x) * (size_t(y) + size_t(gridResolution.y) * size_t(z));
+                    uint32_t writeIdx;
+#if _OPENMP >= 201107
+                    #pragma omp atomic capture
+#endif
+                    writeIdx = writeOffsets[gridCellIdx]++;
+                    gridCellReferences[writeIdx] = uint32_t(cellIdx);
+                }
+            }
+        }
+    }
+
+    // The scatter order depends on the thread scheduling. Sorting makes the queries deterministic.
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(numGridCells) default(none) schedule(dynamic, 256)
+#endif
+    for (size_t gridCellIdx = 0; gridCellIdx < numGridCells; gridCellIdx++) {
+        std::sort(
+                gridCellReferences.begin() + gridCellOffsets[gridCellIdx],
+                gridCellReferences.begin() + gridCellOffsets[gridCellIdx + 1]);
+    }
+}
+
+bool HexahedralCellGrid::findCell(const glm::vec3& position, uint32_t& cellIdx, glm::vec3& localCoordinates) const {
+    if (getIsEmpty()) {
+        return false;
+    }
+    for (int i = 0; i < 3; i++) {
+        if (!(position[i] >= minBounds[i] && position[i] <= maxBounds[i])) {
+            return false;
+        }
+    }
+    glm::ivec3 gridPosition = glm::clamp(
+            glm::ivec3(glm::floor((position - minBounds) / gridCellSize)),
+            glm::ivec3(0), gridResolution - glm::ivec3(1));
+    size_t gridCellIdx = size_t(gridPosition.x)
+            + size_t(gridResolution.x) * (size_t(gridPosition.y) + size_t(gridResolution.y) * size_t(gridPosition.z));
+
+    const float epsilon = 1e-4f;
+    const glm::vec3 boundsEpsilon(epsilon * averageCellExtent);
+    const uint32_t begin = gridCellOffsets[gridCellIdx];
+    const uint32_t end = gridCellOffsets[gridCellIdx + 1];
+    for (uint32_t i = begin; i < end; i++) {
+        uint32_t candidateCellIdx = gridCellReferences[i];
+        const glm::vec3& cellMin = cellBoundsMin[candidateCellIdx];
+        const glm::vec3& cellMax = cellBoundsMax[candidateCellIdx];
+        if (position.x < cellMin.x - boundsEpsilon.x || position.x > cellMax.x + boundsEpsilon.x
+                || position.y < cellMin.y - boundsEpsilon.y || position.y > cellMax.y + boundsEpsilon.y
+                || position.z < cellMin.z - boundsEpsilon.z || position.z > cellMax.z + boundsEpsilon.z) {
+            continue;
+        }
+
+        glm::vec3 cornerPositions[8];
+        for (int j = 0; j < 8; j++) {
+            cornerPositions[j] = (*vertices)[(*cellIndices)[size_t(candidateCellIdx) * 8 + j]];
+        }
+        glm::vec3 candidateLocalCoordinates;
+        if (!computeHexahedronLocalCoordinates(cornerPositions, position, candidateLocalCoordinates)) {
+            continue;
+        }
+        if (candidateLocalCoordinates.x >= -epsilon && candidateLocalCoordinates.x <= 1.0f + epsilon
+                && candidateLocalCoordinates.y >= -epsilon && candidateLocalCoordinates.y <= 1.0f + epsilon
+                && candidateLocalCoordinates.z >= -epsilon && candidateLocalCoordinates.z <= 1.0f + epsilon) {
+            cellIdx = candidateCellIdx;
+            localCoordinates = glm::clamp(candidateLocalCoordinates, 0.0f, 1.0f);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,99 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef HEXAHEDRAL_CELL_GRID_H_
+#define HEXAHEDRAL_CELL_GRID_H_
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+/**
+ * Computes the local (trilinear) coordinates of a position in a hexahedron using Newton iterations.
+ * @param cornerPositions The corner positions of the hexahedron in VTK vertex order.
+ * @param position The world space position.
+ * @param localCoordinates The local coordinates. They lie in [0, 1]^3 if the position lies in the hexahedron.
+ * @return Whether the Newton iterations converged.
+ */
+bool computeHexahedronLocalCoordinates(
+        const glm::vec3 cornerPositions[8], const glm::vec3& position, glm::vec3& localCoordinates);
+
+/**
+ * A uniform grid over the bounding boxes of the cells of a hexahedral mesh for point location queries (e.g., for
+ * probing a field defined on the mesh at the mouse cursor). Every cell is referenced by all grid cells its bounding
+ * box overlaps. Like in @see UniformGrid, the references are sorted by grid cell into one contiguous array using a
+ * parallel counting sort. A query tests the cells referenced by the grid cell containing the position, first against
+ * their bounding boxes and then by inverting the trilinear mapping (@see computeHexahedronLocalCoordinates).
+ * NOTE: The grid stores pointers to the vertex and cell index arrays passed to build. They need to stay valid and
+ * unchanged as long as the grid is used. All queries are const and thus thread-safe.
+ */
+class HexahedralCellGrid {
+public:
+    /**
+     * Builds the grid.
+     * @param vertices The vertex positions of the mesh.
+     * @param cellIndices Eight vertex indices per cell (VTK vertex order).
+     */
+    void build(const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& cellIndices);
+    void clear();
+
+    /**
+     * Finds the cell containing a position. If the position lies on a face shared by multiple cells, the cell with
+     * the lowest index is returned.
+     * @param position The position.
+     * @param cellIdx The index of the cell containing the position.
+     * @param localCoordinates The local coordinates of the position in the found cell (clamped to [0, 1]^3).
+     * @return False if the position lies outside of the mesh (or the grid is empty).
+     */
+    bool findCell(const glm::vec3& position, uint32_t& cellIdx, glm::vec3& localCoordinates) const;
+
+    inline bool getIsEmpty() const { return cellBoundsMin.empty(); }
+    inline size_t getNumCells() const { return cellBoundsMin.size(); }
+    inline const glm::ivec3& getGridResolution() const { return gridResolution; }
+    inline float getGridCellSize() const { return gridCellSize; }
+    inline const glm::vec3& getMinBounds() const { return minBounds; }
+    inline const glm::vec3& getMaxBounds() const { return maxBounds; }
+    /// The average extent of the cell bounding boxes (e.g., for choosing step sizes when marching along rays).
+    inline float getAverageCellExtent() const { return averageCellExtent; }
+
+private:
+    static const float TARGET_NUM_GRID_CELLS_PER_CELL; ///< Used for deriving the grid cell size from the cell density.
+
+    const std::vector<glm::vec3>* vertices = nullptr;
+    const std::vector<uint32_t>* cellIndices = nullptr;
+    std::vector<glm::vec3> cellBoundsMin, cellBoundsMax; ///< The bounding boxes of the mesh cells.
+    glm::vec3 minBounds = glm::vec3(0.0f), maxBounds = glm::vec3(0.0f);
+    float averageCellExtent = 0.0f;
+
+    float gridCellSize = 0.0f;
+    glm::ivec3 gridResolution = glm::ivec3(0);
+    std::vector<uint32_t> gridCellOffsets; ///< Offsets into gridCellReferences (number of grid cells + 1 entries).
+    std::vector<uint32_t> gridCellReferences; ///< The mesh cell indices sorted by grid cell (ascending per cell).
+};
+
+#endif //HEXAHEDRAL_CELL_GRID_H_
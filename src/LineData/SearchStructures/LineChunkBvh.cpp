@@ -0,0 +1,424 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
+#include "LineChunkBvh.hpp"
+
+void intersectLineIndexRanges(
+        const std::vector<LineIndexRange>& ranges0, const std::vector<LineIndexRange>& ranges1,
+        std::vector<LineIndexRange>& intersectedRanges) {
+    intersectedRanges.clear();
+    size_t i = 0, j = 0;
+    while (i < ranges0.size() && j < ranges1.size()) {
+        const LineIndexRange& range0 = ranges0.at(i);
+        const LineIndexRange& range1 = ranges1.at(j);
+        uint32_t end0 = range0.indexOffset + range0.numIndices;
+        uint32_t end1 = range1.indexOffset + range1.numIndices;
+        uint32_t start = std::max(range0.indexOffset, range1.indexOffset);
+        uint32_t end = std::min(end0, end1);
+        if (start < end) {
+            intersectedRanges.push_back(LineIndexRange(start, end - start));
+        }
+        if (end0 < end1) {
+            i++;
+        } else {
+            j++;
+        }
+    }
+}
+
+
+ViewFrustum::ViewFrustum() {
+    for (int i = 0; i < 6; i++) {
+        planes[i] = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+    }
+}
+
+ViewFrustum::ViewFrustum(const glm::mat4& viewProjectionMatrix) {
+    const glm::mat4& m = viewProjectionMatrix;
+    glm::vec4 rows[4];
+    for (int i = 0; i < 4; i++) {
+        rows[i] = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+    }
+    planes[0] = rows[3] + rows[0]; // Left
+    planes[1] = rows[3] - rows[0]; // Right
+    planes[2] = rows[3] + rows[1]; // Bottom
+    planes[3] = rows[3] - rows[1]; // Top
+    planes[4] = rows[3] + rows[2]; // Near
+    planes[5] = rows[3] - rows[2]; // Far
+}
+
+ViewFrustum::IntersectionType ViewFrustum::intersectBox(const AxisAlignedBox& box) const {
+    bool isIntersecting = false;
+    for (int i = 0; i < 6; i++) {
+        const glm::vec4& plane = planes[i];
+        const glm::vec3 planeNormal(plane.x, plane.y, plane.z);
+        // The box corners farthest in the positive and negative direction of the plane normal.
+        glm::vec3 positiveVertex(
+                plane.x >= 0.0f ? box.max.x : box.min.x,
+                plane.y >= 0.0f ? box.max.y : box.min.y,
+                plane.z >= 0.0f ? box.max.z : box.min.z);
+        glm::vec3 negativeVertex(
+                plane.x >= 0.0f ? box.min.x : box.max.x,
+                plane.y >= 0.0f ? box.min.y : box.max.y,
+                plane.z >= 0.0f ? box.min.z : box.max.z);
+        if (glm::dot(planeNormal, positiveVertex) + plane.w < 0.0f) {
+            return OUTSIDE;
+        }
+        if (glm::dot(planeNormal, negativeVertex) + plane.w < 0.0f) {
+            isIntersecting = true;
+        }
+    }
+    return isIntersecting ? INTERSECTING : INSIDE;
+}
+
+ViewFrustum::IntersectionType ViewFrustum::intersectSphere(const glm::vec3& center, float radius) const {
+    bool isIntersecting = false;
+    for (int i = 0; i < 6; i++) {
+        const glm::vec4& plane = planes[i];
+        const glm::vec3 planeNormal(plane.x, plane.y, plane.z);
+        // The planes are not normalized, so the radius is scaled by the length of the plane normal.
+        float signedDistance = glm::dot(planeNormal, center) + plane.w;
+        float scaledRadius = radius * glm::length(planeNormal);
+        if (signedDistance < -scaledRadius) {
+            return OUTSIDE;
+        }
+        if (signedDistance < scaledRadius) {
+            isIntersecting = true;
+        }
+    }
+    return isIntersecting ? INTERSECTING : INSIDE;
+}
+
+/// Grows the passed box by the passed distance in all directions.
+static inline AxisAlignedBox getPaddedBox(const AxisAlignedBox& box, float padding) {
+    return AxisAlignedBox(box.min - glm::vec3(padding), box.max + glm::vec3(padding));
+}
+
+static inline float getDistance(const AxisAlignedBox& box, const glm::vec3& point) {
+    return glm::length(point - glm::clamp(point, box.min, box.max));
+}
+
+/// A simplified level is only kept if it has at most this fraction of the indices of the next finer level.
+static const float MAX_LEVEL_OF_DETAIL_INDEX_RATIO = 0.75f;
+
+void LineChunkBvh::clear() {
+    chunks.clear();
+    nodes.clear();
+    numIndices = 0;
+    levelErrors.clear();
+    chunkLevelRanges.clear();
+}
+
+void LineChunkBvh::build(
+        const std::vector<uint32_t>& lineIndices, const std::vector<glm::vec3>& vertexPositions,
+        uint32_t maxNumSegmentsPerChunk, const std::vector<float>* vertexRadiusScales) {
+    clear();
+    numIndices = lineIndices.size();
+    const size_t numSegments = lineIndices.size() / 2;
+    if (numSegments == 0) {
+        return;
+    }
+
+    // 1. Split the segments into chunks. A new line starts if a segment does not continue the previous segment.
+    maxNumSegmentsPerChunk = std::max(maxNumSegmentsPerChunk, 1u);
+    const uint32_t minNumSegmentsPerChunk = std::max(maxNumSegmentsPerChunk / 2, 1u);
+    size_t chunkStartSegmentIdx = 0;
+    uint32_t numChunkSegments = 0;
+    for (size_t segmentIdx = 0; segmentIdx < numSegments; segmentIdx++) {
+        bool isLineStart = segmentIdx > 0 && lineIndices.at(segmentIdx * 2) != lineIndices.at(segmentIdx * 2 - 1);
+        if (numChunkSegments == maxNumSegmentsPerChunk || (isLineStart && numChunkSegments >= minNumSegmentsPerChunk)) {
+            chunks.push_back({ AxisAlignedBox(), 1.0f, uint32_t(chunkStartSegmentIdx * 2), numChunkSegments * 2 });
+            chunkStartSegmentIdx = segmentIdx;
+            numChunkSegments = 0;
+        }
+        numChunkSegments++;
+    }
+    chunks.push_back({ AxisAlignedBox(), 1.0f, uint32_t(chunkStartSegmentIdx * 2), numChunkSegments * 2 });
+
+    // 2. Compute the bounding boxes of the chunks.
+    const size_t numChunks = chunks.size();
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(lineIndices, vertexPositions, vertexRadiusScales, numChunks) default(none)
+#endif
+    for (size_t chunkIdx = 0; chunkIdx < numChunks; chunkIdx++) {
+        LineChunk& chunk = chunks.at(chunkIdx);
+        glm::vec3 minPosition(std::numeric_limits<float>::max());
+        glm::vec3 maxPosition(std::numeric_limits<float>::lowest());
+        float radiusScale = vertexRadiusScales ? 0.0f : 1.0f;
+        for (uint32_t idx = chunk.indexOffset; idx < chunk.indexOffset + chunk.numIndices; idx++) {
+            const glm::vec3& position = vertexPositions.at(lineIndices.at(idx));
+            minPosition = glm::min(minPosition, position);
+            maxPosition = glm::max(maxPosition, position);
+            if (vertexRadiusScales) {
+                radiusScale = std::max(radiusScale, vertexRadiusScales->at(lineIndices.at(idx)));
+            }
+        }
+        chunk.aabb = AxisAlignedBox(minPosition, maxPosition);
+        chunk.radiusScale = radiusScale;
+    }
+
+    // 3. Build the hierarchy using median splits along the axis of the largest extent of the chunk centers.
+    nodes.reserve(numChunks * 2);
+    buildRecursive(0, uint32_t(numChunks));
+}
+
+void LineChunkBvh::buildLevelsOfDetail(
+        std::vector<uint32_t>& lineIndices, const std::vector<float>& vertexErrors,
+        const std::vector<float>& candidateLevelErrors) {
+    levelErrors.clear();
+    chunkLevelRanges.clear();
+    const size_t numChunks = chunks.size();
+    const size_t numCandidateLevels = candidateLevelErrors.size();
+    if (numChunks == 0 || numCandidateLevels == 0) {
+        return;
+    }
+
+    // 1. Simplify the lines of every chunk on every level. The first and last vertex of every line piece are kept.
+    std::vector<std::vector<uint32_t>> chunkLevelIndices(numChunks * numCandidateLevels);
+#if _OPENMP >= 201107
+    #pragma omp parallel for default(none) schedule(dynamic) \
+            shared(lineIndices, vertexErrors, candidateLevelErrors, chunkLevelIndices, numChunks, numCandidateLevels)
+#endif
+    for (size_t chunkIdx = 0; chunkIdx < numChunks; chunkIdx++) {
+        const LineChunk& chunk = chunks.at(chunkIdx);
+        const uint32_t indexEnd = chunk.indexOffset + chunk.numIndices;
+        for (size_t levelIdx = 0; levelIdx < numCandidateLevels; levelIdx++) {
+            const float levelError = candidateLevelErrors.at(levelIdx);
+            std::vector<uint32_t>& indices = chunkLevelIndices.at(chunkIdx * numCandidateLevels + levelIdx);
+            uint32_t lastKeptVertexIdx = 0;
+            for (uint32_t idx = chunk.indexOffset; idx < indexEnd; idx += 2) {
+                uint32_t vertexIdx0 = lineIndices.at(idx);
+                uint32_t vertexIdx1 = lineIndices.at(idx + 1);
+                if (idx == chunk.indexOffset || vertexIdx0 != lineIndices.at(idx - 1)) {
+                    lastKeptVertexIdx = vertexIdx0;
+                }
+                bool isLineEnd = idx + 2 >= indexEnd || lineIndices.at(idx + 2) != vertexIdx1;
+                if (isLineEnd || vertexErrors.at(vertexIdx1) >= levelError) {
+                    indices.push_back(lastKeptVertexIdx);
+                    indices.push_back(vertexIdx1);
+                    lastKeptVertexIdx = vertexIdx1;
+                }
+            }
+        }
+    }
+
+    // 2. Only keep the levels that considerably reduce the number of indices.
+    std::vector<size_t> keptLevelIndices;
+    size_t numIndicesFinerLevel = numIndices;
+    for (size_t levelIdx = 0; levelIdx < numCandidateLevels; levelIdx++) {
+        size_t numLevelIndices = 0;
+        for (size_t chunkIdx = 0; chunkIdx < numChunks; chunkIdx++) {
+            numLevelIndices += chunkLevelIndices.at(chunkIdx * numCandidateLevels + levelIdx).size();
+        }
+        if (float(numLevelIndices) <= MAX_LEVEL_OF_DETAIL_INDEX_RATIO * float(numIndicesFinerLevel)) {
+            keptLevelIndices.push_back(levelIdx);
+            numIndicesFinerLevel = numLevelIndices;
+        }
+    }
+
+    // 3. Append the levels to the index list. Within a level, the chunks are ordered like in the full resolution
+    // list, so that the ranges of neighboring chunks with the same level can be merged when drawing.
+    std::vector<uint32_t> chunkOrder(numChunks);
+    for (size_t chunkIdx = 0; chunkIdx < numChunks; chunkIdx++) {
+        chunkOrder.at(chunkIdx) = uint32_t(chunkIdx);
+    }
+    std::sort(chunkOrder.begin(), chunkOrder.end(), [this](uint32_t chunkIdx0, uint32_t chunkIdx1) {
+        return chunks.at(chunkIdx0).indexOffset < chunks.at(chunkIdx1).indexOffset;
+    });
+    const size_t numLevels = keptLevelIndices.size();
+    chunkLevelRanges.resize(numChunks * numLevels);
+    for (size_t keptLevelIdx = 0; keptLevelIdx < numLevels; keptLevelIdx++) {
+        const size_t levelIdx = keptLevelIndices.at(keptLevelIdx);
+        levelErrors.push_back(candidateLevelErrors.at(levelIdx));
+        for (uint32_t chunkIdx : chunkOrder) {
+            const std::vector<uint32_t>& indices = chunkLevelIndices.at(chunkIdx * numCandidateLevels + levelIdx);
+            chunkLevelRanges.at(chunkIdx * numLevels + keptLevelIdx) = LineIndexRange(
+                    uint32_t(lineIndices.size()), uint32_t(indices.size()));
+            lineIndices.insert(lineIndices.end(), indices.begin(), indices.end());
+        }
+    }
+}
+
+uint32_t LineChunkBvh::buildRecursive(uint32_t chunkOffset, uint32_t numChunks) {
+    auto nodeIdx = uint32_t(nodes.size());
+    nodes.push_back(BvhNode());
+
+    BvhNode node;
+    node.chunkOffset = chunkOffset;
+    node.numChunks = numChunks;
+    node.rightChildIdx = 0;
+    node.aabb = chunks.at(chunkOffset).aabb;
+    node.radiusScale = 0.0f;
+    glm::vec3 minCenter(std::numeric_limits<float>::max());
+    glm::vec3 maxCenter(std::numeric_limits<float>::lowest());
+    for (uint32_t chunkIdx = chunkOffset; chunkIdx < chunkOffset + numChunks; chunkIdx++) {
+        const AxisAlignedBox& aabb = chunks.at(chunkIdx).aabb;
+        node.aabb.min = glm::min(node.aabb.min, aabb.min);
+        node.aabb.max = glm::max(node.aabb.max, aabb.max);
+        node.radiusScale = std::max(node.radiusScale, chunks.at(chunkIdx).radiusScale);
+        glm::vec3 center = (aabb.min + aabb.max) * 0.5f;
+        minCenter = glm::min(minCenter, center);
+        maxCenter = glm::max(maxCenter, center);
+    }
+
+    if (numChunks > MAX_NUM_CHUNKS_PER_LEAF) {
+        glm::vec3 extent = maxCenter - minCenter;
+        int axis = 0;
+        if (extent.y > extent[axis]) {
+            axis = 1;
+        }
+        if (extent.z > extent[axis]) {
+            axis = 2;
+        }
+        uint32_t numChunksLeft = numChunks / 2;
+        std::nth_element(
+                chunks.begin() + chunkOffset, chunks.begin() + chunkOffset + numChunksLeft,
+                chunks.begin() + chunkOffset + numChunks,
+                [axis](const LineChunk& chunk0, const LineChunk& chunk1) {
+                    return chunk0.aabb.min[axis] + chunk0.aabb.max[axis]
+                            < chunk1.aabb.min[axis] + chunk1.aabb.max[axis];
+                });
+        buildRecursive(chunkOffset, numChunksLeft);
+        node.rightChildIdx = buildRecursive(chunkOffset + numChunksLeft, numChunks - numChunksLeft);
+    }
+
+    nodes.at(nodeIdx) = node;
+    return nodeIdx;
+}
+
+void LineChunkBvh::cull(
+        const ViewFrustum& frustum, std::vector<LineIndexRange>& visibleRanges,
+        LineCullingStatistics* statistics, float lineRadius, const LineLevelOfDetailSelection* levelOfDetail,
+        const std::vector<LineIndexRange>* indexRanges) const {
+    auto startTime = std::chrono::high_resolution_clock::now();
+    visibleRanges.clear();
+
+    std::vector<LineIndexRange> chunkRanges;
+    size_t numVisibleChunks = 0;
+    if (!nodes.empty()) {
+        std::vector<uint32_t> nodeStack;
+        nodeStack.push_back(0);
+        while (!nodeStack.empty()) {
+            uint32_t nodeIdx = nodeStack.back();
+            nodeStack.pop_back();
+            const BvhNode& node = nodes.at(nodeIdx);
+            ViewFrustum::IntersectionType intersectionType = frustum.intersectBox(
+                    getPaddedBox(node.aabb, lineRadius * node.radiusScale));
+            if (intersectionType == ViewFrustum::OUTSIDE) {
+                continue;
+            }
+            if (intersectionType == ViewFrustum::INSIDE || node.rightChildIdx == 0) {
+                // The whole subtree is visible (or the node is a leaf).
+                for (uint32_t chunkIdx = node.chunkOffset; chunkIdx < node.chunkOffset + node.numChunks; chunkIdx++) {
+                    const LineChunk& chunk = chunks.at(chunkIdx);
+                    if (node.numChunks == 1 || intersectionType == ViewFrustum::INSIDE
+                            || frustum.intersectBox(getPaddedBox(chunk.aabb, lineRadius * chunk.radiusScale))
+                                    != ViewFrustum::OUTSIDE) {
+                        addChunkRanges(chunkIdx, levelOfDetail, indexRanges, chunkRanges);
+                        numVisibleChunks++;
+                    }
+                }
+                continue;
+            }
+            nodeStack.push_back(node.rightChildIdx);
+            nodeStack.push_back(nodeIdx + 1);
+        }
+    }
+
+    // Sort the ranges by their offset and merge adjacent ranges.
+    std::sort(chunkRanges.begin(), chunkRanges.end(), [](const LineIndexRange& range0, const LineIndexRange& range1) {
+        return range0.indexOffset < range1.indexOffset;
+    });
+    size_t numVisibleIndices = 0;
+    for (const LineIndexRange& range : chunkRanges) {
+        numVisibleIndices += range.numIndices;
+        if (!visibleRanges.empty()
+                && visibleRanges.back().indexOffset + visibleRanges.back().numIndices == range.indexOffset) {
+            visibleRanges.back().numIndices += range.numIndices;
+        } else {
+            visibleRanges.push_back(range);
+        }
+    }
+
+    if (statistics) {
+        auto endTime = std::chrono::high_resolution_clock::now();
+        statistics->cullingTimeMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+        statistics->numChunks = chunks.size();
+        statistics->numVisibleChunks = numVisibleChunks;
+        statistics->numIndices = numIndices;
+        statistics->numVisibleIndices = numVisibleIndices;
+        statistics->numDrawRanges = visibleRanges.size();
+    }
+}
+
+void LineChunkBvh::addChunkRanges(
+        uint32_t chunkIdx, const LineLevelOfDetailSelection* levelOfDetail,
+        const std::vector<LineIndexRange>* indexRanges, std::vector<LineIndexRange>& chunkRanges) const {
+    const LineChunk& chunk = chunks.at(chunkIdx);
+    const uint32_t chunkIndexEnd = chunk.indexOffset + chunk.numIndices;
+
+    if (indexRanges) {
+        // The first range ending after the start of the chunk.
+        auto it = std::upper_bound(
+                indexRanges->begin(), indexRanges->end(), chunk.indexOffset,
+                [](uint32_t indexOffset, const LineIndexRange& range) {
+                    return indexOffset < range.indexOffset + range.numIndices;
+                });
+        bool isChunkContained =
+                it != indexRanges->end() && it->indexOffset <= chunk.indexOffset
+                && it->indexOffset + it->numIndices >= chunkIndexEnd;
+        if (!isChunkContained) {
+            // The simplified levels do not know which of their indices belong to the ranges.
+            for (; it != indexRanges->end() && it->indexOffset < chunkIndexEnd; it++) {
+                uint32_t start = std::max(it->indexOffset, chunk.indexOffset);
+                uint32_t end = std::min(it->indexOffset + it->numIndices, chunkIndexEnd);
+                if (start < end) {
+                    chunkRanges.push_back(LineIndexRange(start, end - start));
+                }
+            }
+            return;
+        }
+    }
+
+    LineIndexRange range(chunk.indexOffset, chunk.numIndices);
+    if (levelOfDetail && !levelErrors.empty()) {
+        float maxError = getDistance(chunk.aabb, levelOfDetail->cameraPosition) * levelOfDetail->errorPerDistance;
+        auto numLevels = size_t(
+                std::upper_bound(levelErrors.begin(), levelErrors.end(), maxError) - levelErrors.begin());
+        if (numLevels > 0) {
+            range = chunkLevelRanges.at(chunkIdx * levelErrors.size() + numLevels - 1);
+        }
+    }
+    if (range.numIndices > 0) {
+        chunkRanges.push_back(range);
+    }
+}
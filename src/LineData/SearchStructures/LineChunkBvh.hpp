@@ -0,0 +1,207 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LINE_CHUNK_BVH_H_
+#define LINE_CHUNK_BVH_H_
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "SearchStructure.hpp"
+
+/// A contiguous range in a line segment index list (two indices per line segment).
+struct LineIndexRange {
+    LineIndexRange() {}
+    LineIndexRange(uint32_t indexOffset, uint32_t numIndices) : indexOffset(indexOffset), numIndices(numIndices) {}
+    uint32_t indexOffset = 0;
+    uint32_t numIndices = 0;
+};
+
+/**
+ * Computes the intersection of two lists of index ranges. Both lists need to be sorted by their offset and may not
+ * contain overlapping ranges.
+ * @param ranges0 The first list of ranges.
+ * @param ranges1 The second list of ranges.
+ * @param intersectedRanges The output list of ranges (sorted by offset).
+ */
+void intersectLineIndexRanges(
+        const std::vector<LineIndexRange>& ranges0, const std::vector<LineIndexRange>& ranges1,
+        std::vector<LineIndexRange>& intersectedRanges);
+
+/**
+ * The six planes of a view frustum. A point p lies inside of the frustum if dot(plane, vec4(p, 1)) >= 0 holds for all
+ * planes. The planes are extracted from the view-projection matrix using the method by Gribb and Hartmann, assuming
+ * OpenGL clip space conventions (i.e., -w <= z <= w).
+ */
+class ViewFrustum {
+public:
+    /// The default frustum contains all points (e.g., for selecting the level of detail without culling).
+    ViewFrustum();
+    explicit ViewFrustum(const glm::mat4& viewProjectionMatrix);
+
+    enum IntersectionType {
+        OUTSIDE, INTERSECTING, INSIDE
+    };
+    /// Conservative intersection test (i.e., some boxes outside of the frustum might be reported as intersecting).
+    IntersectionType intersectBox(const AxisAlignedBox& box) const;
+    /// Conservative intersection test of a sphere (like @see intersectBox).
+    IntersectionType intersectSphere(const glm::vec3& center, float radius) const;
+
+private:
+    glm::vec4 planes[6];
+};
+
+/// Statistics about the last culling pass.
+struct LineCullingStatistics {
+    double cullingTimeMs = 0.0;
+    size_t numChunks = 0;
+    size_t numVisibleChunks = 0;
+    size_t numIndices = 0;
+    size_t numVisibleIndices = 0;
+    size_t numDrawRanges = 0;
+
+    /// @return The fraction of line segment indices that were culled.
+    inline float getCulledFraction() const {
+        return numIndices == 0 ? 0.0f : 1.0f - float(numVisibleIndices) / float(numIndices);
+    }
+};
+
+/**
+ * Selects the level of detail of the line chunks by their distance to the camera (@see LineChunkBvh::cull).
+ */
+struct LineLevelOfDetailSelection {
+    glm::vec3 cameraPosition = glm::vec3(0.0f);
+    /// Maximum world space error per unit of distance to the camera (@see computeLineSimplificationErrorPerDistance).
+    float errorPerDistance = 0.0f;
+};
+
+/**
+ * A bounding volume hierarchy over chunks of consecutive line segments of an index buffer with line topology. Each
+ * chunk corresponds to a contiguous range of the index buffer. Traversing the hierarchy against the view frustum
+ * results in a compact list of index ranges that can, e.g., be drawn using glMultiDrawElements.
+ * The bounding boxes only contain the line centers. As the rendered tubes and bands extend beyond them, the boxes are
+ * grown by the line radius passed when culling. Thus, changing the line width does not require rebuilding.
+ *
+ * Optionally, simplified index lists of every chunk can be appended to the index buffer for multiple levels of detail
+ * (@see buildLevelsOfDetail). The vertices stay the same for all levels, so switching the level of a chunk only
+ * changes the drawn index range.
+ */
+class LineChunkBvh {
+public:
+    /**
+     * Builds the hierarchy. The bounding boxes of the chunks are computed in parallel.
+     * @param lineIndices The line segment index list (two vertex indices per segment).
+     * @param vertexPositions The vertex positions referenced by lineIndices.
+     * @param maxNumSegmentsPerChunk The maximum number of line segments per chunk. Chunks preferably end at the end of
+     * a line, as long as they contain at least half of this number of segments.
+     * @param vertexRadiusScales Optional factors the line radius is scaled with at the vertices (e.g., the length of
+     * the band offset vectors). A factor of 1 is used for all vertices if this is nullptr.
+     */
+    void build(
+            const std::vector<uint32_t>& lineIndices, const std::vector<glm::vec3>& vertexPositions,
+            uint32_t maxNumSegmentsPerChunk = 256, const std::vector<float>* vertexRadiusScales = nullptr);
+    /**
+     * Appends simplified index lists of all chunks to the index buffer. Each chunk is simplified on its own and keeps
+     * its first and last vertex, so that neighboring chunks with different levels stay connected. Levels that do not
+     * remove at least a quarter of the indices of the next finer level are skipped. Needs to be called after
+     * @see build with the same index list.
+     * @param lineIndices The line segment index list passed to @see build. The simplified lists are appended.
+     * @param vertexErrors The simplification error of every vertex (@see computeLineSimplificationErrors). Vertices
+     * with an error below the error of a level are removed on this level.
+     * @param levelErrors The increasing world space errors of the simplified levels.
+     */
+    void buildLevelsOfDetail(
+            std::vector<uint32_t>& lineIndices, const std::vector<float>& vertexErrors,
+            const std::vector<float>& levelErrors);
+    void clear();
+
+    inline bool getIsEmpty() const { return nodes.empty(); }
+    inline size_t getNumChunks() const { return chunks.size(); }
+    inline size_t getNumNodes() const { return nodes.size(); }
+    /// @return The number of indices of the full resolution index list.
+    inline size_t getNumIndices() const { return numIndices; }
+    /// @return The errors of the simplified levels of detail (without the full resolution level).
+    inline const std::vector<float>& getLevelErrors() const { return levelErrors; }
+
+    /**
+     * Traverses the hierarchy against the passed view frustum.
+     * @param frustum The view frustum.
+     * @param visibleRanges The index ranges of all chunks intersecting the frustum, sorted by their offset. Adjacent
+     * ranges are merged.
+     * @param statistics Optional statistics about the culling pass (may be nullptr).
+     * @param lineRadius The world space radius of the rendered lines. The bounding boxes are grown by this radius
+     * (times the largest radius scale of the vertices they contain).
+     * @param levelOfDetail If not nullptr, the coarsest level of every chunk whose error stays below the allowed error
+     * at the distance of the chunk to the camera is drawn (@see buildLevelsOfDetail).
+     * @param indexRanges If not nullptr, only these sorted ranges of the full resolution index list are drawn (e.g.,
+     * the lines above a hierarchy level). Chunks only partly contained in the ranges are drawn at full resolution.
+     */
+    void cull(
+            const ViewFrustum& frustum, std::vector<LineIndexRange>& visibleRanges,
+            LineCullingStatistics* statistics = nullptr, float lineRadius = 0.0f,
+            const LineLevelOfDetailSelection* levelOfDetail = nullptr,
+            const std::vector<LineIndexRange>* indexRanges = nullptr) const;
+
+private:
+    struct LineChunk {
+        AxisAlignedBox aabb;
+        float radiusScale; ///< Maximum radius scale of the vertices of the chunk.
+        uint32_t indexOffset;
+        uint32_t numIndices;
+    };
+
+    /**
+     * A node of the hierarchy. The nodes are stored in depth-first order, i.e., the left child of an inner node
+     * directly follows the node. The chunks of the subtree of a node are stored contiguously.
+     */
+    struct BvhNode {
+        AxisAlignedBox aabb;
+        float radiusScale; ///< Maximum radius scale of the chunks of the subtree.
+        uint32_t chunkOffset;
+        uint32_t numChunks;
+        uint32_t rightChildIdx; ///< 0 for leaf nodes.
+    };
+
+    uint32_t buildRecursive(uint32_t chunkOffset, uint32_t numChunks);
+    /// Adds the index range(s) of the visible chunk to the passed list (@see cull).
+    void addChunkRanges(
+            uint32_t chunkIdx, const LineLevelOfDetailSelection* levelOfDetail,
+            const std::vector<LineIndexRange>* indexRanges, std::vector<LineIndexRange>& chunkRanges) const;
+
+    static const uint32_t MAX_NUM_CHUNKS_PER_LEAF = 4;
+    std::vector<LineChunk> chunks;
+    std::vector<BvhNode> nodes;
+    size_t numIndices = 0;
+
+    // Levels of detail (@see buildLevelsOfDetail).
+    std::vector<float> levelErrors;
+    std::vector<LineIndexRange> chunkLevelRanges; ///< levelErrors.size() ranges per chunk.
+};
+
+#endif //LINE_CHUNK_BVH_H_
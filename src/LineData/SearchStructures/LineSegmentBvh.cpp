@@ -0,0 +1,561 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "LineSegmentBvh.hpp"
+
+/// @return The squared distance of a point to a box (zero if the point lies inside of the box).
+static inline float getDistanceSquared(const AxisAlignedBox& box, const glm::vec3& point) {
+    glm::vec3 diff = glm::max(glm::max(box.min - point, point - box.max), glm::vec3(0.0f));
+    return glm::dot(diff, diff);
+}
+
+/// @return The squared distance between two boxes (zero if they overlap).
+static inline float getDistanceSquared(const AxisAlignedBox& box0, const AxisAlignedBox& box1) {
+    glm::vec3 diff = glm::max(glm::max(box0.min - box1.max, box1.min - box0.max), glm::vec3(0.0f));
+    return glm::dot(diff, diff);
+}
+
+/**
+ * Intersects a ray with a box enlarged by the passed radius.
+ * @param rayOrigin The origin of the ray.
+ * @param rayDirectionInv The component-wise inverse of the ray direction.
+ * @param box The box.
+ * @param radius The radius the box is enlarged by in every direction.
+ * @param maxDistance The maximum ray parameter.
+ * @param entryDistance The ray parameter where the ray enters the box (zero if the origin lies inside of the box).
+ * @return Whether the ray intersects the box between zero and maxDistance.
+ */
+static inline bool intersectRayBox(
+        const glm::vec3& rayOrigin, const glm::vec3& rayDirectionInv, const AxisAlignedBox& box, float radius,
+        float maxDistance, float& entryDistance) {
+    glm::vec3 t0 = (box.min - glm::vec3(radius) - rayOrigin) * rayDirectionInv;
+    glm::vec3 t1 = (box.max + glm::vec3(radius) - rayOrigin) * rayDirectionInv;
+    glm::vec3 tMin = glm::min(t0, t1);
+    glm::vec3 tMax = glm::max(t0, t1);
+    entryDistance = std::max(std::max(tMin.x, tMin.y), std::max(tMin.z, 0.0f));
+    float exitDistance = std::min(std::min(tMax.x, tMax.y), std::min(tMax.z, maxDistance));
+    return entryDistance <= exitDistance;
+}
+
+/**
+ * Intersects a ray with a capsule (i.e., a cylinder closed by two spheres). For more details see:
+ * https://iquilezles.org/articles/intersectors/
+ * @return The ray parameter of the first intersection with the capsule surface or a negative value if there is none.
+ */
+static float intersectRayCapsule(
+        const glm::vec3& rayOrigin, const glm::vec3& rayDirection, const glm::vec3& p0, const glm::vec3& p1,
+        float radius) {
+    glm::vec3 ba = p1 - p0;
+    glm::vec3 oa = rayOrigin - p0;
+    float baba = glm::dot(ba, ba);
+    float bard = glm::dot(ba, rayDirection);
+    float baoa = glm::dot(ba, oa);
+    float rdoa = glm::dot(rayDirection, oa);
+    float oaoa = glm::dot(oa, oa);
+    float a = baba - bard * bard;
+    float b = baba * rdoa - baoa * bard;
+    float c = baba * oaoa - baoa * baoa - radius * radius * baba;
+    float h = b * b - a * c;
+    float y = 0.0f;
+    if (h >= 0.0f && a > 0.0f) {
+        // Intersection with the cylinder body.
+        float t = (-b - std::sqrt(h)) / a;
+        y = baoa + t * bard;
+        if (y > 0.0f && y < baba) {
+            return t;
+        }
+    } else if (baba > 0.0f) {
+        y = baoa;
+    }
+    // Intersection with the closer one of the two spheres.
+    glm::vec3 oc = y <= 0.0f ? oa : rayOrigin - p1;
+    b = glm::dot(rayDirection, oc);
+    c = glm::dot(oc, oc) - radius * radius;
+    h = b * b - c;
+    if (h > 0.0f) {
+        return -b - std::sqrt(h);
+    }
+    return -1.0f;
+}
+
+void LineSegmentBvh::clear() {
+    segments.clear();
+    nodes.clear();
+}
+
+void LineSegmentBvh::build(const std::vector<std::vector<glm::vec3>>& lines) {
+    clear();
+
+    // 1. Collect the segments of all lines.
+    const size_t numLines = lines.size();
+    std::vector<size_t> lineSegmentOffsets(numLines + 1, 0);
+    for (size_t lineIdx = 0; lineIdx < numLines; lineIdx++) {
+        size_t numLinePoints = lines.at(lineIdx).size();
+        lineSegmentOffsets.at(lineIdx + 1) =
+                lineSegmentOffsets.at(lineIdx) + (numLinePoints > 1 ? numLinePoints - 1 : 0);
+    }
+    const size_t numSegments = lineSegmentOffsets.back();
+    if (numSegments == 0) {
+        return;
+    }
+    segments.resize(numSegments);
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(lines, numLines, lineSegmentOffsets) default(none) schedule(dynamic)
+#endif
+    for (size_t lineIdx = 0; lineIdx < numLines; lineIdx++) {
+        const std::vector<glm::vec3>& line = lines.at(lineIdx);
+        size_t segmentOffset = lineSegmentOffsets.at(lineIdx);
+        size_t numLineSegments = lineSegmentOffsets.at(lineIdx + 1) - segmentOffset;
+        for (size_t segmentIdx = 0; segmentIdx < numLineSegments; segmentIdx++) {
+            LineSegment& segment = segments.at(segmentOffset + segmentIdx);
+            segment.p0 = line.at(segmentIdx);
+            segment.p1 = line.at(segmentIdx + 1);
+            segment.lineIdx = uint32_t(lineIdx);
+            segment.segmentIdx = uint32_t(segmentIdx);
+        }
+    }
+
+    // 2. Build the hierarchy. The number of nodes of a binary tree with n leaves is 2n - 1.
+    nodes.resize(2 * getNumLeaves(uint32_t(numSegments)) - 1);
+#if _OPENMP >= 201107
+    #pragma omp parallel default(none) shared(numSegments)
+    #pragma omp single
+#endif
+    buildRecursive(0, 0, uint32_t(numSegments), 0);
+}
+
+uint32_t LineSegmentBvh::getNumLeaves(uint32_t numSegments) {
+    // The subtrees of one level of the hierarchy have either size s or s + 1.
+    uint64_t s = numSegments, count0 = 1, count1 = 0, numLeaves = 0;
+    while (count0 + count1 > 0) {
+        if (s <= MAX_NUM_SEGMENTS_PER_LEAF) {
+            numLeaves += count0;
+            count0 = 0;
+        }
+        if (s + 1 <= MAX_NUM_SEGMENTS_PER_LEAF) {
+            numLeaves += count1;
+            count1 = 0;
+        }
+        // Split s into (s / 2, s - s / 2) and s + 1 into ((s + 1) / 2, s + 1 - (s + 1) / 2).
+        if (s % 2 == 0) {
+            count0 = 2 * count0 + count1;
+        } else {
+            count1 = count0 + 2 * count1;
+        }
+        s = s / 2;
+    }
+    return uint32_t(numLeaves);
+}
+
+void LineSegmentBvh::buildRecursive(uint32_t nodeIdx, uint32_t segmentOffset, uint32_t numSegments, uint32_t depth) {
+    BvhNode& node = nodes.at(nodeIdx);
+    node.segmentOffset = segmentOffset;
+    node.numSegments = numSegments;
+    node.rightChildIdx = 0;
+
+    if (numSegments <= MAX_NUM_SEGMENTS_PER_LEAF) {
+        glm::vec3 minPosition(std::numeric_limits<float>::max());
+        glm::vec3 maxPosition(std::numeric_limits<float>::lowest());
+        for (uint32_t segmentIdx = segmentOffset; segmentIdx < segmentOffset + numSegments; segmentIdx++) {
+            const LineSegment& segment = segments.at(segmentIdx);
+            minPosition = glm::min(minPosition, glm::min(segment.p0, segment.p1));
+            maxPosition = glm::max(maxPosition, glm::max(segment.p0, segment.p1));
+        }
+        node.aabb = AxisAlignedBox(minPosition, maxPosition);
+        return;
+    }
+
+    // Median split along the axis of the largest extent of the segment centers (scaled by two).
+    float minCenter[3], maxCenter[3];
+    for (int i = 0; i < 3; i++) {
+        minCenter[i] = std::numeric_limits<float>::max();
+        maxCenter[i] = std::numeric_limits<float>::lowest();
+    }
+    const LineSegment* nodeSegments = segments.data() + segmentOffset;
+    for (uint32_t segmentIdx = 0; segmentIdx < numSegments; segmentIdx++) {
+        const LineSegment& segment = nodeSegments[segmentIdx];
+        for (int i = 0; i < 3; i++) {
+            float center = segment.p0[i] + segment.p1[i];
+            minCenter[i] = std::min(minCenter[i], center);
+            maxCenter[i] = std::max(maxCenter[i], center);
+        }
+    }
+    glm::vec3 extent(maxCenter[0] - minCenter[0], maxCenter[1] - minCenter[1], maxCenter[2] - minCenter[2]);
+    int axis = 0;
+    if (extent.y > extent[axis]) {
+        axis = 1;
+    }
+    if (extent.z > extent[axis]) {
+        axis = 2;
+    }
+    uint32_t numSegmentsLeft = numSegments / 2;
+    std::nth_element(
+            segments.begin() + segmentOffset, segments.begin() + segmentOffset + numSegmentsLeft,
+            segments.begin() + segmentOffset + numSegments,
+            [axis](const LineSegment& segment0, const LineSegment& segment1) {
+                return segment0.p0[axis] + segment0.p1[axis] < segment1.p0[axis] + segment1.p1[axis];
+            });
+
+    const uint32_t leftChildIdx = nodeIdx + 1;
+    const uint32_t rightChildIdx = leftChildIdx + 2 * getNumLeaves(numSegmentsLeft) - 1;
+    if (depth < MAX_TASK_DEPTH && numSegments >= MIN_TASK_SIZE) {
+#if _OPENMP >= 201107
+        #pragma omp task default(none) firstprivate(leftChildIdx, segmentOffset, numSegmentsLeft, depth)
+#endif
+        buildRecursive(leftChildIdx, segmentOffset, numSegmentsLeft, depth + 1);
+        buildRecursive(rightChildIdx, segmentOffset + numSegmentsLeft, numSegments - numSegmentsLeft, depth + 1);
+#if _OPENMP >= 201107
+        #pragma omp taskwait
+#endif
+    } else {
+        buildRecursive(leftChildIdx, segmentOffset, numSegmentsLeft, depth + 1);
+        buildRecursive(rightChildIdx, segmentOffset + numSegmentsLeft, numSegments - numSegmentsLeft, depth + 1);
+    }
+
+    const AxisAlignedBox& leftAabb = nodes.at(leftChildIdx).aabb;
+    const AxisAlignedBox& rightAabb = nodes.at(rightChildIdx).aabb;
+    node.aabb = AxisAlignedBox(glm::min(leftAabb.min, rightAabb.min), glm::max(leftAabb.max, rightAabb.max));
+    node.rightChildIdx = rightChildIdx;
+}
+
+void LineSegmentBvh::computeClosestPoint(const LineSegment& segment, const glm::vec3& point, LineSegmentHit& hit) {
+    glm::vec3 direction = segment.p1 - segment.p0;
+    float lengthSquared = glm::dot(direction, direction);
+    float t = 0.0f;
+    if (lengthSquared > 0.0f) {
+        t = glm::clamp(glm::dot(point - segment.p0, direction) / lengthSquared, 0.0f, 1.0f);
+    }
+    hit.lineIdx = segment.lineIdx;
+    hit.segmentIdx = segment.segmentIdx;
+    hit.t = t;
+    hit.closestPoint = segment.p0 + t * direction;
+    hit.distance = glm::distance(point, hit.closestPoint);
+}
+
+float LineSegmentBvh::computeClosestPoints(
+        const LineSegment& segment0, const LineSegment& segment1, LineSegmentHit& hit0, LineSegmentHit& hit1) {
+    // For more details see "Real-Time Collision Detection" by Christer Ericson, Section 5.1.9.
+    const float EPSILON = 1e-12f;
+    glm::vec3 d0 = segment0.p1 - segment0.p0;
+    glm::vec3 d1 = segment1.p1 - segment1.p0;
+    glm::vec3 r = segment0.p0 - segment1.p0;
+    float a = glm::dot(d0, d0);
+    float e = glm::dot(d1, d1);
+    float f = glm::dot(d1, r);
+    float s, t;
+
+    if (a <= EPSILON && e <= EPSILON) {
+        s = t = 0.0f;
+    } else if (a <= EPSILON) {
+        s = 0.0f;
+        t = glm::clamp(f / e, 0.0f, 1.0f);
+    } else {
+        float c = glm::dot(d0, r);
+        if (e <= EPSILON) {
+            t = 0.0f;
+            s = glm::clamp(-c / a, 0.0f, 1.0f);
+        } else {
+            float b = glm::dot(d0, d1);
+            float denom = a * e - b * b;
+            // For parallel segments, an arbitrary point of the first segment is used.
+            s = denom > 0.0f ? glm::clamp((b * f - c * e) / denom, 0.0f, 1.0f) : 0.0f;
+            t = (b * s + f) / e;
+            if (t < 0.0f) {
+                t = 0.0f;
+                s = glm::clamp(-c / a, 0.0f, 1.0f);
+            } else if (t > 1.0f) {
+                t = 1.0f;
+                s = glm::clamp((b - c) / a, 0.0f, 1.0f);
+            }
+        }
+    }
+
+    glm::vec3 closestPoint0 = segment0.p0 + s * d0;
+    glm::vec3 closestPoint1 = segment1.p0 + t * d1;
+    glm::vec3 diff = closestPoint0 - closestPoint1;
+    float distanceSquared = glm::dot(diff, diff);
+    float distance = std::sqrt(distanceSquared);
+
+    hit0.lineIdx = segment0.lineIdx;
+    hit0.segmentIdx = segment0.segmentIdx;
+    hit0.t = s;
+    hit0.closestPoint = closestPoint0;
+    hit0.distance = distance;
+    hit1.lineIdx = segment1.lineIdx;
+    hit1.segmentIdx = segment1.segmentIdx;
+    hit1.t = t;
+    hit1.closestPoint = closestPoint1;
+    hit1.distance = distance;
+    return distanceSquared;
+}
+
+bool LineSegmentBvh::findClosestSegment(const glm::vec3& point, LineSegmentHit& hit, float maxDistance) const {
+    if (nodes.empty()) {
+        return false;
+    }
+
+    bool hasHit = false;
+    float closestDistance = maxDistance;
+    LineSegmentHit segmentHit;
+
+    uint32_t nodeStack[MAX_STACK_SIZE];
+    uint32_t stackSize = 0;
+    nodeStack[stackSize++] = 0;
+    while (stackSize > 0) {
+        uint32_t nodeIdx = nodeStack[--stackSize];
+        const BvhNode& node = nodes[nodeIdx];
+        if (getDistanceSquared(node.aabb, point) > closestDistance * closestDistance) {
+            continue;
+        }
+
+        if (node.rightChildIdx == 0) {
+            for (uint32_t segmentIdx = node.segmentOffset; segmentIdx < node.segmentOffset + node.numSegments;
+                    segmentIdx++) {
+                computeClosestPoint(segments[segmentIdx], point, segmentHit);
+                if (segmentHit.distance <= closestDistance) {
+                    closestDistance = segmentHit.distance;
+                    hit = segmentHit;
+                    hasHit = true;
+                }
+            }
+            continue;
+        }
+
+        // Visit the closer child first (i.e., push it last).
+        uint32_t leftChildIdx = nodeIdx + 1;
+        uint32_t rightChildIdx = node.rightChildIdx;
+        if (getDistanceSquared(nodes[leftChildIdx].aabb, point) < getDistanceSquared(nodes[rightChildIdx].aabb, point)) {
+            std::swap(leftChildIdx, rightChildIdx);
+        }
+        nodeStack[stackSize++] = leftChildIdx;
+        nodeStack[stackSize++] = rightChildIdx;
+    }
+
+    return hasHit;
+}
+
+void LineSegmentBvh::findClosestSegments(
+        const std::vector<glm::vec3>& queryPoints, std::vector<LineSegmentHit>& hits,
+        std::vector<bool>& hasHits, float maxDistance) const {
+    const size_t numQueries = queryPoints.size();
+    hits.resize(numQueries);
+    // std::vector<bool> may not be written to concurrently.
+    std::vector<uint8_t> hasHitsBytes(numQueries);
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(queryPoints, numQueries, hits, hasHitsBytes, maxDistance) default(none)
+#endif
+    for (size_t queryIdx = 0; queryIdx < numQueries; queryIdx++) {
+        hasHitsBytes[queryIdx] = findClosestSegment(queryPoints[queryIdx], hits[queryIdx], maxDistance) ? 1 : 0;
+    }
+    hasHits.assign(hasHitsBytes.begin(), hasHitsBytes.end());
+}
+
+void LineSegmentBvh::findSegmentsInSphere(
+        const glm::vec3& center, float radius, std::vector<LineSegmentHit>& hits) const {
+    if (nodes.empty()) {
+        return;
+    }
+
+    const float radiusSquared = radius * radius;
+    LineSegmentHit segmentHit;
+    uint32_t nodeStack[MAX_STACK_SIZE];
+    uint32_t stackSize = 0;
+    nodeStack[stackSize++] = 0;
+    while (stackSize > 0) {
+        uint32_t nodeIdx = nodeStack[--stackSize];
+        const BvhNode& node = nodes[nodeIdx];
+        if (getDistanceSquared(node.aabb, center) > radiusSquared) {
+            continue;
+        }
+
+        if (node.rightChildIdx == 0) {
+            for (uint32_t segmentIdx = node.segmentOffset; segmentIdx < node.segmentOffset + node.numSegments;
+                    segmentIdx++) {
+                computeClosestPoint(segments[segmentIdx], center, segmentHit);
+                if (segmentHit.distance <= radius) {
+                    hits.push_back(segmentHit);
+                }
+            }
+            continue;
+        }
+
+        nodeStack[stackSize++] = node.rightChildIdx;
+        nodeStack[stackSize++] = nodeIdx + 1;
+    }
+}
+
+bool LineSegmentBvh::intersectRay(
+        const glm::vec3& rayOrigin, const glm::vec3& rayDirection, float tubeRadius, LineSegmentHit& hit,
+        float maxDistance, const std::function<bool(uint32_t lineIdx)>& lineFilter) const {
+    if (nodes.empty()) {
+        return false;
+    }
+
+    // Avoid NaN values in the slab test for rays parallel to a coordinate plane.
+    const float EPSILON = 1e-30f;
+    glm::vec3 rayDirectionInv;
+    for (int i = 0; i < 3; i++) {
+        rayDirectionInv[i] = 1.0f / (std::abs(rayDirection[i]) > EPSILON ? rayDirection[i] : EPSILON);
+    }
+
+    struct StackEntry {
+        uint32_t nodeIdx;
+        float entryDistance;
+    };
+    StackEntry nodeStack[MAX_STACK_SIZE];
+    uint32_t stackSize = 0;
+    float entryDistance = 0.0f;
+    if (!intersectRayBox(rayOrigin, rayDirectionInv, nodes.front().aabb, tubeRadius, maxDistance, entryDistance)) {
+        return false;
+    }
+    nodeStack[stackSize++] = { 0, entryDistance };
+
+    bool hasHit = false;
+    float closestDistance = maxDistance;
+    while (stackSize > 0) {
+        const StackEntry entry = nodeStack[--stackSize];
+        if (entry.entryDistance > closestDistance) {
+            continue;
+        }
+        const BvhNode& node = nodes[entry.nodeIdx];
+
+        if (node.rightChildIdx == 0) {
+            for (uint32_t segmentIdx = node.segmentOffset; segmentIdx < node.segmentOffset + node.numSegments;
+                    segmentIdx++) {
+                const LineSegment& segment = segments[segmentIdx];
+                if (lineFilter && !lineFilter(segment.lineIdx)) {
+                    continue;
+                }
+                float t = intersectRayCapsule(rayOrigin, rayDirection, segment.p0, segment.p1, tubeRadius);
+                if (t >= 0.0f && t <= closestDistance) {
+                    closestDistance = t;
+                    hasHit = true;
+                    hit.lineIdx = segment.lineIdx;
+                    hit.segmentIdx = segment.segmentIdx;
+                    hit.distance = t;
+                    hit.closestPoint = rayOrigin + t * rayDirection;
+                    glm::vec3 direction = segment.p1 - segment.p0;
+                    float lengthSquared = glm::dot(direction, direction);
+                    hit.t = lengthSquared > 0.0f ? glm::clamp(
+                            glm::dot(hit.closestPoint - segment.p0, direction) / lengthSquared, 0.0f, 1.0f) : 0.0f;
+                }
+            }
+            continue;
+        }
+
+        // Visit the child entered first by the ray first (i.e., push it last).
+        StackEntry childEntries[2];
+        bool childHits[2];
+        childEntries[0].nodeIdx = entry.nodeIdx + 1;
+        childEntries[1].nodeIdx = node.rightChildIdx;
+        for (int i = 0; i < 2; i++) {
+            childHits[i] = intersectRayBox(
+                    rayOrigin, rayDirectionInv, nodes[childEntries[i].nodeIdx].aabb, tubeRadius, closestDistance,
+                    childEntries[i].entryDistance);
+        }
+        int firstChild = childEntries[0].entryDistance <= childEntries[1].entryDistance ? 0 : 1;
+        if (childHits[1 - firstChild]) {
+            nodeStack[stackSize++] = childEntries[1 - firstChild];
+        }
+        if (childHits[firstChild]) {
+            nodeStack[stackSize++] = childEntries[firstChild];
+        }
+    }
+
+    return hasHit;
+}
+
+bool LineSegmentBvh::computeMinimumDistance(
+        const LineSegmentBvh& other, LineSegmentHit& hit, LineSegmentHit& otherHit) const {
+    if (nodes.empty() || other.nodes.empty()) {
+        return false;
+    }
+
+    struct NodePair {
+        uint32_t nodeIdx;
+        uint32_t otherNodeIdx;
+        float distanceSquared; ///< Lower bound of the squared distance of the segments in the two subtrees.
+    };
+    std::vector<NodePair> nodePairStack;
+    nodePairStack.push_back({ 0, 0, getDistanceSquared(nodes.front().aabb, other.nodes.front().aabb) });
+
+    float closestDistanceSquared = std::numeric_limits<float>::max();
+    LineSegmentHit segmentHit, otherSegmentHit;
+    while (!nodePairStack.empty()) {
+        NodePair nodePair = nodePairStack.back();
+        nodePairStack.pop_back();
+        if (nodePair.distanceSquared > closestDistanceSquared) {
+            continue;
+        }
+
+        const BvhNode& node = nodes[nodePair.nodeIdx];
+        const BvhNode& otherNode = other.nodes[nodePair.otherNodeIdx];
+        bool isLeaf = node.rightChildIdx == 0;
+        bool isOtherLeaf = otherNode.rightChildIdx == 0;
+        if (isLeaf && isOtherLeaf) {
+            for (uint32_t segmentIdx = node.segmentOffset; segmentIdx < node.segmentOffset + node.numSegments;
+                    segmentIdx++) {
+                for (uint32_t otherSegmentIdx = otherNode.segmentOffset;
+                        otherSegmentIdx < otherNode.segmentOffset + otherNode.numSegments; otherSegmentIdx++) {
+                    float distanceSquared = computeClosestPoints(
+                            segments[segmentIdx], other.segments[otherSegmentIdx], segmentHit, otherSegmentHit);
+                    if (distanceSquared < closestDistanceSquared) {
+                        closestDistanceSquared = distanceSquared;
+                        hit = segmentHit;
+                        otherHit = otherSegmentHit;
+                    }
+                }
+            }
+            continue;
+        }
+
+        // Descend into the node with more segments, and visit the closer child pair first (i.e., push it last).
+        NodePair childPairs[2];
+        if (!isLeaf && (isOtherLeaf || node.numSegments >= otherNode.numSegments)) {
+            childPairs[0] = { nodePair.nodeIdx + 1, nodePair.otherNodeIdx, 0.0f };
+            childPairs[1] = { node.rightChildIdx, nodePair.otherNodeIdx, 0.0f };
+        } else {
+            childPairs[0] = { nodePair.nodeIdx, nodePair.otherNodeIdx + 1, 0.0f };
+            childPairs[1] = { nodePair.nodeIdx, otherNode.rightChildIdx, 0.0f };
+        }
+        for (NodePair& childPair : childPairs) {
+            childPair.distanceSquared = getDistanceSquared(
+                    nodes[childPair.nodeIdx].aabb, other.nodes[childPair.otherNodeIdx].aabb);
+        }
+        if (childPairs[0].distanceSquared < childPairs[1].distanceSquared) {
+            std::swap(childPairs[0], childPairs[1]);
+        }
+        nodePairStack.push_back(childPairs[0]);
+        nodePairStack.push_back(childPairs[1]);
+    }
+
+    return true;
+}
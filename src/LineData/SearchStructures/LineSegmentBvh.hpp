@@ -0,0 +1,171 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LINE_SEGMENT_BVH_H_
+#define LINE_SEGMENT_BVH_H_
+
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <limits>
+#include <glm/glm.hpp>
+
+#include "SearchStructure.hpp"
+
+/// The closest point on a line segment found by a query of @see LineSegmentBvh.
+struct LineSegmentHit {
+    uint32_t lineIdx = 0; ///< Index of the line in the line list passed to LineSegmentBvh::build.
+    uint32_t segmentIdx = 0; ///< The segment connects the line points segmentIdx and segmentIdx + 1.
+    float t = 0.0f; ///< Parameter of the closest point along the segment in [0, 1].
+    float distance = 0.0f; ///< Distance of the closest point to the query.
+    glm::vec3 closestPoint = glm::vec3(0.0f);
+};
+
+/**
+ * A bounding volume hierarchy over the line segments of a set of lines. In contrast to the point search structures
+ * (@see SearchStructure), the queries operate on the segments, e.g., for finding the line closest to a cursor
+ * position, all lines within a certain distance of a probe, or the minimum distance between two line sets.
+ * The nodes are stored in depth-first order like in @see LineChunkBvh. As the hierarchy is split by the median of the
+ * segment centers, the size of every subtree is known in advance, and the subtrees of the top levels are built in
+ * parallel using OpenMP tasks. All queries are const and thus thread-safe.
+ */
+class LineSegmentBvh {
+public:
+    /**
+     * Builds the hierarchy.
+     * @param lines The point lists of the lines. Lines with less than two points do not contain any segments.
+     */
+    void build(const std::vector<std::vector<glm::vec3>>& lines);
+    void clear();
+
+    inline bool getIsEmpty() const { return nodes.empty(); }
+    inline size_t getNumSegments() const { return segments.size(); }
+    inline size_t getNumNodes() const { return nodes.size(); }
+
+    /**
+     * Finds the segment closest to the passed point.
+     * @param point The query point.
+     * @param hit The closest segment and the closest point on it.
+     * @param maxDistance Segments farther away than this distance are ignored.
+     * @return False if no segment lies within maxDistance (or the hierarchy is empty).
+     */
+    bool findClosestSegment(
+            const glm::vec3& point, LineSegmentHit& hit,
+            float maxDistance = std::numeric_limits<float>::max()) const;
+
+    /**
+     * Batched version of @see findClosestSegment. The query points are processed in parallel.
+     * @param queryPoints The query points.
+     * @param hits The closest segment per query point.
+     * @param hasHits Whether a segment lies within maxDistance per query point.
+     * @param maxDistance Segments farther away than this distance are ignored.
+     */
+    void findClosestSegments(
+            const std::vector<glm::vec3>& queryPoints, std::vector<LineSegmentHit>& hits,
+            std::vector<bool>& hasHits, float maxDistance = std::numeric_limits<float>::max()) const;
+
+    /**
+     * Finds all segments with a distance of at most radius to the passed center point.
+     * @param center The center point.
+     * @param radius The search radius.
+     * @param hits The segments and their points closest to the center (in no particular order).
+     */
+    void findSegmentsInSphere(const glm::vec3& center, float radius, std::vector<LineSegmentHit>& hits) const;
+
+    /**
+     * Intersects a ray with the tubes of the passed radius around the segments. The tube segments are closed by
+     * spheres at the line points (i.e., every segment is a capsule), so that tubes with joints have no gaps.
+     * @param rayOrigin The origin of the ray.
+     * @param rayDirection The normalized direction of the ray.
+     * @param tubeRadius The radius of the tubes.
+     * @param hit The segment hit first. closestPoint is the hit point on the tube surface, distance is the distance of
+     * the hit point to the ray origin and t is the parameter of the point on the segment closest to the hit point.
+     * @param maxDistance Hits farther away from the ray origin are ignored.
+     * @param lineFilter If set, the segments of lines for which it returns false are skipped (i.e., they can neither
+     * be hit nor occlude other lines).
+     * @return False if the ray does not hit any tube.
+     */
+    bool intersectRay(
+            const glm::vec3& rayOrigin, const glm::vec3& rayDirection, float tubeRadius, LineSegmentHit& hit,
+            float maxDistance = std::numeric_limits<float>::max(),
+            const std::function<bool(uint32_t lineIdx)>& lineFilter = nullptr) const;
+
+    /**
+     * Computes the minimum distance between the segments of this and another hierarchy using a simultaneous traversal
+     * of both hierarchies.
+     * @param other The other hierarchy.
+     * @param hit The closest point on the segments of this hierarchy.
+     * @param otherHit The closest point on the segments of the other hierarchy.
+     * @return False if one of the hierarchies is empty.
+     */
+    bool computeMinimumDistance(const LineSegmentBvh& other, LineSegmentHit& hit, LineSegmentHit& otherHit) const;
+
+private:
+    struct LineSegment {
+        glm::vec3 p0;
+        glm::vec3 p1;
+        uint32_t lineIdx;
+        uint32_t segmentIdx;
+    };
+
+    /**
+     * A node of the hierarchy. The left child of an inner node directly follows the node. The segments of the subtree
+     * of a node are stored contiguously.
+     */
+    struct BvhNode {
+        AxisAlignedBox aabb;
+        uint32_t segmentOffset;
+        uint32_t numSegments;
+        uint32_t rightChildIdx; ///< 0 for leaf nodes.
+    };
+
+    void buildRecursive(uint32_t nodeIdx, uint32_t segmentOffset, uint32_t numSegments, uint32_t depth);
+
+    /// @return The number of leaves of a subtree with the passed number of segments.
+    static uint32_t getNumLeaves(uint32_t numSegments);
+
+    /// Fills hit with the closest point on the passed segment to the passed point.
+    static void computeClosestPoint(const LineSegment& segment, const glm::vec3& point, LineSegmentHit& hit);
+
+    /**
+     * Computes the closest points of two segments.
+     * @return The squared distance between the closest points.
+     */
+    static float computeClosestPoints(
+            const LineSegment& segment0, const LineSegment& segment1, LineSegmentHit& hit0, LineSegmentHit& hit1);
+
+    static const uint32_t MAX_NUM_SEGMENTS_PER_LEAF = 4;
+    static const uint32_t MAX_STACK_SIZE = 128; ///< Sufficient, as the hierarchy is balanced.
+    static const uint32_t MAX_TASK_DEPTH = 8; ///< Subtrees below this depth are built by the spawning thread.
+    static const uint32_t MIN_TASK_SIZE = 16384; ///< Subtrees with fewer segments are not split into tasks.
+
+    std::vector<LineSegment> segments;
+    std::vector<BvhNode> nodes;
+};
+
+#endif //LINE_SEGMENT_BVH_H_
@@ -0,0 +1,196 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+#include "PointDistanceField.hpp"
+
+const uint32_t PointDistanceField::INVALID_SEED_INDEX;
+
+void PointDistanceField::clear() {
+    seedPoints.clear();
+    cellSeedIndices.clear();
+    cellSeedIndices.shrink_to_fit();
+    resolution = glm::ivec3(0);
+}
+
+void PointDistanceField::build(
+        const std::vector<glm::vec3>& seedPoints, const AxisAlignedBox& domain, int maxResolution) {
+    clear();
+    if (seedPoints.empty()) {
+        return;
+    }
+    this->seedPoints = seedPoints;
+
+    glm::vec3 extent = domain.max - domain.min;
+    float maxExtent = std::max(extent.x, std::max(extent.y, extent.z));
+    maxResolution = std::max(maxResolution, 1);
+    cellSize = maxExtent > 0.0f ? maxExtent / float(maxResolution) : 1.0f;
+    gridOrigin = domain.min;
+    for (int i = 0; i < 3; i++) {
+        resolution[i] = glm::clamp(int(std::ceil(extent[i] / cellSize)), 1, maxResolution);
+    }
+    const size_t numCells = size_t(resolution.x) * size_t(resolution.y) * size_t(resolution.z);
+
+    // Each seed point initializes the cell it lies in. Seed points outside of the domain initialize the closest cell.
+    std::vector<uint32_t> cellSeedsIn(numCells, INVALID_SEED_INDEX);
+    for (size_t seedIdx = 0; seedIdx < seedPoints.size(); seedIdx++) {
+        const glm::vec3& seedPoint = seedPoints.at(seedIdx);
+        glm::ivec3 cell;
+        for (int i = 0; i < 3; i++) {
+            cell[i] = glm::clamp(int(std::floor((seedPoint[i] - gridOrigin[i]) / cellSize)), 0, resolution[i] - 1);
+        }
+        uint32_t& cellSeedIdx = cellSeedsIn.at(getCellIndex(cell.x, cell.y, cell.z));
+        glm::vec3 cellCenter = getCellCenter(cell.x, cell.y, cell.z);
+        if (cellSeedIdx == INVALID_SEED_INDEX
+                || glm::length(seedPoint - cellCenter) < glm::length(seedPoints.at(cellSeedIdx) - cellCenter)) {
+            cellSeedIdx = uint32_t(seedIdx);
+        }
+    }
+
+    // Jump flooding with halving step sizes, followed by two passes with step size two and one (JFA+2).
+    std::vector<uint32_t> cellSeedsOut(numCells);
+    int maxSize = std::max(resolution.x, std::max(resolution.y, resolution.z));
+    std::vector<int> stepSizes;
+    for (int stepSize = 1; stepSize < maxSize; stepSize *= 2) {
+        stepSizes.insert(stepSizes.begin(), stepSize);
+    }
+    stepSizes.push_back(2);
+    stepSizes.push_back(1);
+    for (int stepSize : stepSizes) {
+        jumpFloodPass(stepSize, cellSeedsIn, cellSeedsOut);
+        std::swap(cellSeedsIn, cellSeedsOut);
+    }
+    cellSeedIndices = std::move(cellSeedsIn);
+}
+
+void PointDistanceField::jumpFloodPass(
+        int stepSize, const std::vector<uint32_t>& cellSeedsIn, std::vector<uint32_t>& cellSeedsOut) const {
+    const int numSlices = resolution.z;
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(stepSize, cellSeedsIn, cellSeedsOut, numSlices) default(none)
+#endif
+    for (int z = 0; z < numSlices; z++) {
+        for (int y = 0; y < resolution.y; y++) {
+            for (int x = 0; x < resolution.x; x++) {
+                glm::vec3 cellCenter = getCellCenter(x, y, z);
+                uint32_t closestSeedIdx = cellSeedsIn[getCellIndex(x, y, z)];
+                float closestDistanceSquared = std::numeric_limits<float>::max();
+                if (closestSeedIdx != INVALID_SEED_INDEX) {
+                    glm::vec3 diff = seedPoints[closestSeedIdx] - cellCenter;
+                    closestDistanceSquared = diff.x * diff.x + diff.y * diff.y + diff.z * diff.z;
+                }
+
+                for (int dz = -stepSize; dz <= stepSize; dz += stepSize) {
+                    int nz = z + dz;
+                    if (nz < 0 || nz >= resolution.z) {
+                        continue;
+                    }
+                    for (int dy = -stepSize; dy <= stepSize; dy += stepSize) {
+                        int ny = y + dy;
+                        if (ny < 0 || ny >= resolution.y) {
+                            continue;
+                        }
+                        for (int dx = -stepSize; dx <= stepSize; dx += stepSize) {
+                            int nx = x + dx;
+                            if (nx < 0 || nx >= resolution.x) {
+                                continue;
+                            }
+                            uint32_t seedIdx = cellSeedsIn[getCellIndex(nx, ny, nz)];
+                            if (seedIdx == INVALID_SEED_INDEX || seedIdx == closestSeedIdx) {
+                                continue;
+                            }
+                            glm::vec3 diff = seedPoints[seedIdx] - cellCenter;
+                            float distanceSquared = diff.x * diff.x + diff.y * diff.y + diff.z * diff.z;
+                            if (distanceSquared < closestDistanceSquared) {
+                                closestDistanceSquared = distanceSquared;
+                                closestSeedIdx = seedIdx;
+                            }
+                        }
+                    }
+                }
+                cellSeedsOut[getCellIndex(x, y, z)] = closestSeedIdx;
+            }
+        }
+    }
+}
+
+uint32_t PointDistanceField::findClosestSeedPointIndex(const glm::vec3& point) const {
+    if (seedPoints.empty()) {
+        return INVALID_SEED_INDEX;
+    }
+
+    // The lower corner of the 2x2x2 cell block trilinear interpolation would use (clamped to the grid).
+    int lower[3], upper[3];
+    for (int i = 0; i < 3; i++) {
+        float gridPosition = (point[i] - gridOrigin[i]) / cellSize - 0.5f;
+        lower[i] = glm::clamp(int(std::floor(gridPosition)), 0, resolution[i] - 1);
+        upper[i] = std::min(lower[i] + 1, resolution[i] - 1);
+    }
+
+    uint32_t closestSeedIdx = INVALID_SEED_INDEX;
+    float closestDistanceSquared = std::numeric_limits<float>::max();
+    for (int z = lower[2]; z <= upper[2]; z++) {
+        for (int y = lower[1]; y <= upper[1]; y++) {
+            for (int x = lower[0]; x <= upper[0]; x++) {
+                uint32_t seedIdx = cellSeedIndices[getCellIndex(x, y, z)];
+                if (seedIdx == closestSeedIdx) {
+                    continue;
+                }
+                glm::vec3 diff = seedPoints[seedIdx] - point;
+                float distanceSquared = diff.x * diff.x + diff.y * diff.y + diff.z * diff.z;
+                if (distanceSquared < closestDistanceSquared) {
+                    closestDistanceSquared = distanceSquared;
+                    closestSeedIdx = seedIdx;
+                }
+            }
+        }
+    }
+    return closestSeedIdx;
+}
+
+float PointDistanceField::getDistance(const glm::vec3& point) const {
+    uint32_t seedIdx = findClosestSeedPointIndex(point);
+    if (seedIdx == INVALID_SEED_INDEX) {
+        return std::numeric_limits<float>::max();
+    }
+    return glm::length(seedPoints[seedIdx] - point);
+}
+
+void PointDistanceField::getDistances(const std::vector<glm::vec3>& points, std::vector<float>& distances) const {
+    const auto numPoints = int(points.size());
+    distances.resize(points.size());
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(points, distances, numPoints) default(none)
+#endif
+    for (int i = 0; i < numPoints; i++) {
+        distances[i] = getDistance(points[i]);
+    }
+}
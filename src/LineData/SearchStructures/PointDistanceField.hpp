@@ -0,0 +1,101 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef POINT_DISTANCE_FIELD_H_
+#define POINT_DISTANCE_FIELD_H_
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "SearchStructure.hpp"
+
+/**
+ * A field storing the distance to a set of seed points on a uniform grid. Each grid cell stores the index of the seed
+ * point closest to the cell center, i.e., the grid is a discrete Voronoi diagram of the seed points. It is computed in
+ * parallel using the jump flooding algorithm (Rong and Tan 2006) with two additional passes of step size two and one
+ * (JFA+2), which removes most of the errors of plain jump flooding.
+ * The distance of a point is evaluated using the eight cells trilinear interpolation would use at the point by
+ * computing the exact distance to the closest of their seed points. In contrast to interpolating the cell distances,
+ * this does not smooth out the distance at the seed points. The result is exact if the closest seed point of the point
+ * is stored in one of the eight cells, which only fails close to Voronoi cell boundaries on coarse grids. Otherwise,
+ * the distance is overestimated.
+ */
+class PointDistanceField {
+public:
+    /**
+     * Builds the field.
+     * @param seedPoints The points to compute the distance to.
+     * @param domain The box covered by the grid. Points outside of the box can be evaluated, but are less accurate.
+     * @param maxResolution The number of grid cells along the largest side of the domain.
+     */
+    void build(const std::vector<glm::vec3>& seedPoints, const AxisAlignedBox& domain, int maxResolution);
+    void clear();
+
+    inline bool getIsEmpty() const { return seedPoints.empty(); }
+    inline const glm::ivec3& getResolution() const { return resolution; }
+    inline float getCellSize() const { return cellSize; }
+
+    /**
+     * @param point The point to evaluate the field at.
+     * @return The index of the (approximately) closest seed point or INVALID_SEED_INDEX if the field is empty.
+     */
+    uint32_t findClosestSeedPointIndex(const glm::vec3& point) const;
+    /**
+     * @param point The point to evaluate the field at.
+     * @return The (approximate) distance of the point to the closest seed point.
+     */
+    float getDistance(const glm::vec3& point) const;
+    /**
+     * Batched version of @see getDistance. The points are evaluated in parallel.
+     * @param points The points to evaluate the field at.
+     * @param distances The distances of the points to the closest seed point.
+     */
+    void getDistances(const std::vector<glm::vec3>& points, std::vector<float>& distances) const;
+
+    static const uint32_t INVALID_SEED_INDEX = 0xFFFFFFFFu;
+
+private:
+    /// Propagates the seeds of the cells with the passed offset in each direction to the neighboring cells.
+    void jumpFloodPass(
+            int stepSize, const std::vector<uint32_t>& cellSeedsIn, std::vector<uint32_t>& cellSeedsOut) const;
+    inline glm::vec3 getCellCenter(int x, int y, int z) const {
+        return gridOrigin + (glm::vec3(float(x), float(y), float(z)) + glm::vec3(0.5f)) * cellSize;
+    }
+    inline size_t getCellIndex(int x, int y, int z) const {
+        return size_t(x) + size_t(resolution.x) * (size_t(y) + size_t(resolution.y) * size_t(z));
+    }
+
+    std::vector<glm::vec3> seedPoints;
+    std::vector<uint32_t> cellSeedIndices; ///< Index of the closest seed point of each cell (x-major order).
+    glm::vec3 gridOrigin = glm::vec3(0.0f);
+    float cellSize = 1.0f;
+    glm::ivec3 resolution = glm::ivec3(0);
+};
+
+#endif //POINT_DISTANCE_FIELD_H_
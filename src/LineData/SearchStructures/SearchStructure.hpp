@@ -66,7 +66,7 @@ public:
 
     /// All types of search structures
     enum SearchStructureType {
-        SEARCH_STRUCTURE_KD_TREE, SEARCH_STRUCTURE_HASHED_GRID, SEARCH_STRUCTURE_NAIVE
+        SEARCH_STRUCTURE_KD_TREE, SEARCH_STRUCTURE_HASHED_GRID, SEARCH_STRUCTURE_UNIFORM_GRID, SEARCH_STRUCTURE_NAIVE
     };
 
     /**
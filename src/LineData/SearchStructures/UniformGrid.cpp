@@ -0,0 +1,218 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+#include "UniformGrid.hpp"
+
+const float UniformGrid::TARGET_NUM_POINTS_PER_CELL = 4.0f;
+
+UniformGrid::UniformGrid(float cellSize) : userCellSize(cellSize) {
+}
+
+void UniformGrid::build(const std::vector<IndexedPoint*>& indexedPoints) {
+    const size_t numPoints = indexedPoints.size();
+    cellOffsets.clear();
+    positions.clear();
+    points.clear();
+    gridResolution = glm::ivec3(0);
+    if (numPoints == 0) {
+        return;
+    }
+
+    // Compute the bounding box of the points.
+    float minX = std::numeric_limits<float>::max(), minY = minX, minZ = minX;
+    float maxX = std::numeric_limits<float>::lowest(), maxY = maxX, maxZ = maxX;
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(indexedPoints, numPoints) default(none) \
+    reduction(min: minX, minY, minZ) reduction(max: maxX, maxY, maxZ)
+#endif
+    for (size_t i = 0; i < numPoints; i++) {
+        const glm::vec3& position = indexedPoints[i]->position;
+        minX = std::min(minX, position.x);
+        minY = std::min(minY, position.y);
+        minZ = std::min(minZ, position.z);
+        maxX = std::max(maxX, position.x);
+        maxY = std::max(maxY, position.y);
+        maxZ = std::max(maxZ, position.z);
+    }
+    gridOrigin = glm::vec3(minX, minY, minZ);
+    const glm::vec3 extent = glm::vec3(maxX, maxY, maxZ) - gridOrigin;
+    const float maxExtent = std::max(extent.x, std::max(extent.y, extent.z));
+
+    // Derive the cell size from the point density. Flat extents are clamped so that planar point sets still work.
+    if (userCellSize > 0.0f) {
+        cellSize = userCellSize;
+    } else if (maxExtent <= 0.0f) {
+        cellSize = 1.0f;
+    } else {
+        glm::vec3 clampedExtent = glm::max(extent, glm::vec3(maxExtent * 1e-3f));
+        double volume = double(clampedExtent.x) * double(clampedExtent.y) * double(clampedExtent.z);
+        cellSize = float(std::cbrt(volume * TARGET_NUM_POINTS_PER_CELL / double(numPoints)));
+    }
+
+    // Enlarge the cells if the offset table would get too large (e.g., for a too small user-specified cell size).
+    const double maxNumCells = double(MAX_NUM_CELLS_PER_POINT * numPoints + 1);
+    double resolution[3];
+    while (true) {
+        for (int i = 0; i < 3; i++) {
+            resolution[i] = std::floor(double(extent[i]) / double(cellSize)) + 1.0;
+        }
+        if (resolution[0] * resolution[1] * resolution[2] <= maxNumCells) {
+            break;
+        }
+        cellSize *= 1.25f;
+    }
+    gridResolution = glm::ivec3(int(resolution[0]), int(resolution[1]), int(resolution[2]));
+    const size_t numCells = size_t(gridResolution.x) * size_t(gridResolution.y) * size_t(gridResolution.z);
+
+    // Counting sort, pass 1: Count the number of points per cell.
+    std::vector<uint32_t> pointCellIndices(numPoints);
+    cellOffsets.resize(numCells + 1, 0);
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(indexedPoints, numPoints, pointCellIndices) default(none)
+#endif
+    for (size_t i = 0; i < numPoints; i++) {
+        glm::ivec3 gridPosition = glm::clamp(
+                convertPointToGridPosition(indexedPoints[i]->position), glm::ivec3(0), gridResolution - glm::ivec3(1));
+        uint32_t cellIdx = uint32_t(
+                gridPosition.x + gridResolution.x * (gridPosition.y + gridResolution.y * gridPosition.z));
+        pointCellIndices[i] = cellIdx;
+#if _OPENMP >= 201107
+        #pragma omp atomic
+#endif
+        cellOffsets[cellIdx + 1]++;
+    }
+
+    // Pass 2: Prefix sum over the cell counts.
+    for (size_t cellIdx = 0; cellIdx < numCells; cellIdx++) {
+        cellOffsets[cellIdx + 1] += cellOffsets[cellIdx];
+    }
+
+    // Pass 3: Scatter the points to their cells.
+    std::vector<uint32_t> writeOffsets(cellOffsets.begin(), cellOffsets.end() - 1);
+    positions.resize(numPoints);
+    points.resize(numPoints);
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(indexedPoints, numPoints, pointCellIndices, writeOffsets) default(none)
+#endif
+    for (size_t i = 0; i < numPoints; i++) {
+        uint32_t cellIdx = pointCellIndices[i];
+        uint32_t writeIdx;
+#if _OPENMP >= 201107
+        #pragma omp atomic capture
+#endif
+        writeIdx = writeOffsets[cellIdx]++;
+        positions[writeIdx] = indexedPoints[i]->position;
+        points[writeIdx] = indexedPoints[i];
+    }
+}
+
+glm::ivec3 UniformGrid::convertPointToGridPosition(const glm::vec3& pos) const {
+    return glm::ivec3(glm::floor((pos - gridOrigin) / cellSize));
+}
+
+bool UniformGrid::getOverlappingCellRange(
+        const AxisAlignedBox& box, glm::ivec3& lowerGrid, glm::ivec3& upperGrid) const {
+    if (points.empty()) {
+        return false;
+    }
+    // Clamp in floating point first to avoid overflows when converting far away positions to integers.
+    glm::vec3 lower = glm::floor((box.min - gridOrigin) / cellSize);
+    glm::vec3 upper = glm::floor((box.max - gridOrigin) / cellSize);
+    glm::vec3 maxGridPosition = glm::vec3(gridResolution - glm::ivec3(1));
+    for (int i = 0; i < 3; i++) {
+        if (upper[i] < 0.0f || lower[i] > maxGridPosition[i] || lower[i] > upper[i]) {
+            return false;
+        }
+    }
+    lowerGrid = glm::ivec3(glm::clamp(lower, glm::vec3(0.0f), maxGridPosition));
+    upperGrid = glm::ivec3(glm::clamp(upper, glm::vec3(0.0f), maxGridPosition));
+    return true;
+}
+
+std::vector<IndexedPoint*> UniformGrid::findPointsInAxisAlignedBox(const AxisAlignedBox& box) {
+    std::vector<IndexedPoint*> pointsInBox;
+    findPointsInAxisAlignedBox(box, pointsInBox);
+    return pointsInBox;
+}
+
+std::vector<IndexedPoint*> UniformGrid::findPointsInSphere(const glm::vec3& center, float radius) {
+    std::vector<IndexedPoint*> pointsInSphere;
+    findPointsInSphere(center, radius, pointsInSphere);
+    return pointsInSphere;
+}
+
+void UniformGrid::findPointsInAxisAlignedBox(
+        const AxisAlignedBox& box, std::vector<IndexedPoint*>& pointsInBox) const {
+    glm::ivec3 lowerGrid, upperGrid;
+    if (!getOverlappingCellRange(box, lowerGrid, upperGrid)) {
+        return;
+    }
+
+    // The overlapping cells of one grid row are stored contiguously.
+    for (int z = lowerGrid.z; z <= upperGrid.z; z++) {
+        for (int y = lowerGrid.y; y <= upperGrid.y; y++) {
+            size_t rowOffset = size_t(gridResolution.x) * (size_t(y) + size_t(gridResolution.y) * size_t(z));
+            uint32_t begin = cellOffsets[rowOffset + lowerGrid.x];
+            uint32_t end = cellOffsets[rowOffset + upperGrid.x + 1];
+            for (uint32_t i = begin; i < end; i++) {
+                if (box.contains(positions[i])) {
+                    pointsInBox.push_back(points[i]);
+                }
+            }
+        }
+    }
+}
+
+void UniformGrid::findPointsInSphere(
+        const glm::vec3& center, float radius, std::vector<IndexedPoint*>& pointsInSphere) const {
+    AxisAlignedBox box(center - glm::vec3(radius), center + glm::vec3(radius));
+    glm::ivec3 lowerGrid, upperGrid;
+    if (!getOverlappingCellRange(box, lowerGrid, upperGrid)) {
+        return;
+    }
+
+    const float squaredRadius = radius * radius;
+    for (int z = lowerGrid.z; z <= upperGrid.z; z++) {
+        for (int y = lowerGrid.y; y <= upperGrid.y; y++) {
+            size_t rowOffset = size_t(gridResolution.x) * (size_t(y) + size_t(gridResolution.y) * size_t(z));
+            uint32_t begin = cellOffsets[rowOffset + lowerGrid.x];
+            uint32_t end = cellOffsets[rowOffset + upperGrid.x + 1];
+            for (uint32_t i = begin; i < end; i++) {
+                glm::vec3 differenceVector = positions[i] - center;
+                if (differenceVector.x * differenceVector.x + differenceVector.y * differenceVector.y
+                        + differenceVector.z * differenceVector.z <= squaredRadius) {
+                    pointsInSphere.push_back(points[i]);
+                }
+            }
+        }
+    }
+}
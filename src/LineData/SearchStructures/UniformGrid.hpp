@@ -0,0 +1,109 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef UNIFORM_GRID_H_
+#define UNIFORM_GRID_H_
+
+#include <vector>
+#include <cstdint>
+#include <glm/glm.hpp>
+
+#include "SearchStructure.hpp"
+
+/**
+ * A compact uniform grid over the bounding box of the points. In contrast to @see HashedGrid, the points are not
+ * stored in one list per hash table entry, but sorted by their cell index into one contiguous array using a parallel
+ * counting sort. The points of cell i are the array range [cellOffsets[i], cellOffsets[i + 1]).
+ * As the cells are stored in x-major order, the cells of one grid row overlapping a query are one contiguous range.
+ * NOTE: The ownership of the memory the IndexedPoint objects lies in the responsibility of the user.
+ */
+class UniformGrid : public SearchStructure
+{
+public:
+    /**
+     * Creates a uniform grid acceleration data structure.
+     * @param cellSize The size of a cell in x, y and z direction (uniform). If the cell size is zero, it is derived
+     * from the point density when building the grid, such that a cell contains TARGET_NUM_POINTS_PER_CELL points on
+     * average.
+     */
+    explicit UniformGrid(float cellSize = 0.0f);
+
+    /**
+     * Builds a uniform grid from the passed point array.
+     * @param points The point array.
+     */
+    void build(const std::vector<IndexedPoint*>& indexedPoints) override;
+
+    /**
+     * Performs an area search in the uniform grid and returns all points within a certain bounding box.
+     * @param box The bounding box.
+     * @return The points stored in the uniform grid inside of the bounding box.
+     */
+    std::vector<IndexedPoint*> findPointsInAxisAlignedBox(const AxisAlignedBox& box) override;
+
+    /**
+     * Performs an area search in the uniform grid and returns all points within a certain distance to some center
+     * point.
+     * @param centerPoint The center point.
+     * @param radius The search radius.
+     * @return The points stored in the uniform grid inside of the search radius.
+     */
+    std::vector<IndexedPoint*> findPointsInSphere(const glm::vec3& center, float radius) override;
+
+    /// The cell size used by the last call to build.
+    inline float getCellSize() const { return cellSize; }
+    inline const glm::ivec3& getGridResolution() const { return gridResolution; }
+    inline size_t getNumPoints() const { return points.size(); }
+
+private:
+    /// Converts a point position to its (not necessarily valid) integer grid cell position.
+    glm::ivec3 convertPointToGridPosition(const glm::vec3& pos) const;
+
+    /**
+     * Computes the range of grid cells overlapping the passed box.
+     * @return False if the box does not overlap the grid.
+     */
+    bool getOverlappingCellRange(const AxisAlignedBox& box, glm::ivec3& lowerGrid, glm::ivec3& upperGrid) const;
+
+    void findPointsInAxisAlignedBox(const AxisAlignedBox& box, std::vector<IndexedPoint*>& pointsInBox) const;
+    void findPointsInSphere(const glm::vec3& center, float radius, std::vector<IndexedPoint*>& pointsInSphere) const;
+
+    static const float TARGET_NUM_POINTS_PER_CELL; ///< Used for deriving the cell size from the point density.
+    static const size_t MAX_NUM_CELLS_PER_POINT = 8; ///< Limits the memory used by the offset table.
+
+    float userCellSize; ///< The cell size passed by the user (or zero for automatic sizing).
+    float cellSize = 0.0f; ///< Cell size in x, y and z direction (uniform).
+    glm::vec3 gridOrigin = glm::vec3(0.0f);
+    glm::ivec3 gridResolution = glm::ivec3(0);
+
+    std::vector<uint32_t> cellOffsets; ///< Offsets of the cells into the point arrays (number of cells + 1 entries).
+    std::vector<glm::vec3> positions; ///< The point positions sorted by cell.
+    std::vector<IndexedPoint*> points; ///< The points sorted by cell.
+};
+
+#endif //UNIFORM_GRID_H_
@@ -0,0 +1,839 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+#include <limits>
+#include <map>
+#include <unordered_map>
+#include <algorithm>
+#include <glm/glm.hpp>
+
+#include <Utils/File/Logfile.hpp>
+
+#include "Loaders/StressTrajectoriesBinaryLoader.hpp"
+#include "LineData/Mesh/VtkLoader.hpp"
+#include "LineData/Mesh/MeshLoader.hpp"
+#include "LineData/SearchStructures/HexahedralCellGrid.hpp"
+#include "StressLineTracer.hpp"
+
+/// Local coordinates of the hexahedron corners in VTK vertex order.
+static const int HEX_CORNER_TABLE[8][3] = {
+        { 0,0,0 }, { 1,0,0 }, { 1,1,0 }, { 0,1,0 }, { 0,0,1 }, { 1,0,1 }, { 1,1,1 }, { 0,1,1 }
+};
+/// The faces in the order w = 0, w = 1, v = 0, u = 0, v = 1, u = 1 (cmp. hexFaceTable in MeshBoundarySurface.cpp).
+static const int HEX_FACE_TABLE[6][4] = {
+        { 0,1,2,3 },
+        { 5,4,7,6 },
+        { 4,5,1,0 },
+        { 4,0,3,7 },
+        { 6,7,3,2 },
+        { 1,5,6,2 },
+};
+static const int HEX_EDGE_TABLE[12][2] = {
+        { 0,1 }, { 1,2 }, { 2,3 }, { 3,0 }, { 4,5 }, { 5,6 }, { 6,7 }, { 7,4 }, { 0,4 }, { 1,5 }, { 2,6 }, { 3,7 }
+};
+/// The faces at local coordinate 0 and 1 for the u, v and w axis.
+static const int LOWER_FACE_INDICES[3] = { 3, 2, 0 };
+static const int UPPER_FACE_INDICES[3] = { 5, 4, 1 };
+/// Lower bound of the line separation distance relative to the smallest mesh extent.
+static const float MIN_SEPARATION_DISTANCE_FACTOR = 1e-2f;
+
+bool loadStressTensorMeshFromFile(const std::string& meshFilename, StressTensorMesh& mesh) {
+    std::map<std::string, HexahedralMeshLoader*> meshLoaderMap;
+    meshLoaderMap.insert(std::make_pair("vtk", new VtkLoader));
+    meshLoaderMap.insert(std::make_pair("mesh", new MeshLoader));
+
+    bool loadingSuccessful = false;
+    size_t extensionPos = meshFilename.find_last_of('.');
+    std::string extension = extensionPos == std::string::npos ? "" : meshFilename.substr(extensionPos + 1);
+    auto it = meshLoaderMap.find(extension);
+    if (it == meshLoaderMap.end()) {
+        sgl::Logfile::get()->writeError(
+                "Error in loadStressTensorMeshFromFile: Unknown extension: \"" + extension + "\".");
+    } else {
+        mesh = StressTensorMesh();
+        loadingSuccessful = it->second->loadHexahedralMeshWithStressFromFile(
+                meshFilename, mesh.vertices, mesh.cellIndices, mesh.stressTensors);
+        if (!loadingSuccessful) {
+            sgl::Logfile::get()->writeError(
+                    "Error in loadStressTensorMeshFromFile: Couldn't load the stress tensors from the file \""
+                    + meshFilename + "\".");
+        }
+    }
+
+    for (auto& loaderPair : meshLoaderMap) {
+        delete loaderPair.second;
+    }
+    meshLoaderMap.clear();
+    return loadingSuccessful;
+}
+
+void computeEigenDecompositionSymmetric(const float tensor[6], float eigenvalues[3], glm::vec3 eigenvectors[3]) {
+    double a[3][3] = {
+            { tensor[0], tensor[5], tensor[4] },
+            { tensor[5], tensor[1], tensor[3] },
+            { tensor[4], tensor[3], tensor[2] },
+    };
+    double v[3][3] = { { 1, 0, 0 }, { 0, 1, 0 }, { 0, 0, 1 } };
+
+    // Cyclic Jacobi sweeps (cmp. Numerical Recipes, Chapter 11.1). Three sweeps usually suffice for 3x3 matrices.
+    for (int sweep = 0; sweep < 32; sweep++) {
+        double offDiagonalNorm = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+        double diagonalNorm = a[0][0] * a[0][0] + a[1][1] * a[1][1] + a[2][2] * a[2][2];
+        if (offDiagonalNorm <= 1e-30 * diagonalNorm || offDiagonalNorm == 0.0) {
+            break;
+        }
+        for (int p = 0; p < 2; p++) {
+            for (int q = p + 1; q < 3; q++) {
+                if (a[p][q] == 0.0) {
+                    continue;
+                }
+                double theta = (a[q][q] - a[p][p]) / (2.0 * a[p][q]);
+                double t = (theta >= 0.0 ? 1.0 : -1.0) / (std::abs(theta) + std::sqrt(theta * theta + 1.0));
+                double c = 1.0 / std::sqrt(t * t + 1.0);
+                double s = t * c;
+                for (int k = 0; k < 3; k++) {
+                    double akp = a[k][p], akq = a[k][q];
+                    a[k][p] = c * akp - s * akq;
+                    a[k][q] = s * akp + c * akq;
+                }
+                for (int k = 0; k < 3; k++) {
+                    double apk = a[p][k], aqk = a[q][k];
+                    a[p][k] = c * apk - s * aqk;
+                    a[q][k] = s * apk + c * aqk;
+                }
+                for (int k = 0; k < 3; k++) {
+                    double vkp = v[k][p], vkq = v[k][q];
+                    v[k][p] = c * vkp - s * vkq;
+                    v[k][q] = s * vkp + c * vkq;
+                }
+            }
+        }
+    }
+
+    int order[3] = { 0, 1, 2 };
+    std::sort(order, order + 3, [&a](int i, int j) { return a[i][i] > a[j][j]; });
+    for (int i = 0; i < 3; i++) {
+        int j = order[i];
+        eigenvalues[i] = float(a[j][j]);
+        eigenvectors[i] = glm::normalize(glm::vec3(float(v[0][j]), float(v[1][j]), float(v[2][j])));
+    }
+}
+
+float computeVonMisesStress(const float tensor[6]) {
+    float dxy = tensor[0] - tensor[1];
+    float dyz = tensor[1] - tensor[2];
+    float dzx = tensor[2] - tensor[0];
+    float shear = tensor[3] * tensor[3] + tensor[4] * tensor[4] + tensor[5] * tensor[5];
+    return std::sqrt(0.5f * (dxy * dxy + dyz * dyz + dzx * dzx) + 3.0f * shear);
+}
+
+void interpolateStressTensorTrilinear(
+        const StressTensorMesh& mesh, uint32_t cellIdx, const glm::vec3& localCoordinates, float tensor[6]) {
+    for (int j = 0; j < 6; j++) {
+        tensor[j] = 0.0f;
+    }
+    for (int i = 0; i < 8; i++) {
+        const int* corner = HEX_CORNER_TABLE[i];
+        float weight =
+                (corner[0] ? localCoordinates.x : 1.0f - localCoordinates.x)
+                * (corner[1] ? localCoordinates.y : 1.0f - localCoordinates.y)
+                * (corner[2] ? localCoordinates.z : 1.0f - localCoordinates.z);
+        const float* vertexTensor = &mesh.stressTensors[size_t(mesh.cellIndices[size_t(cellIdx) * 8 + i]) * 6];
+        for (int j = 0; j < 6; j++) {
+            tensor[j] += weight * vertexTensor[j];
+        }
+    }
+}
+
+
+const uint32_t StressLineTracer::INVALID_CELL;
+
+StressLineTracer::StressLineTracer(const StressTensorMesh& mesh) : mesh(mesh) {
+    minBounds = glm::vec3(std::numeric_limits<float>::max());
+    maxBounds = glm::vec3(std::numeric_limits<float>::lowest());
+    for (const glm::vec3& vertex : mesh.vertices) {
+        minBounds = glm::min(minBounds, vertex);
+        maxBounds = glm::max(maxBounds, vertex);
+    }
+
+    const uint32_t numCells = getNumCells();
+    double edgeLengthSum = 0.0;
+    for (uint32_t cellIdx = 0; cellIdx < numCells; cellIdx++) {
+        const uint32_t* cellVertexIndices = &mesh.cellIndices.at(cellIdx * 8);
+        for (int edgeIdx = 0; edgeIdx < 12; edgeIdx++) {
+            edgeLengthSum += double(glm::distance(
+                    mesh.vertices.at(cellVertexIndices[HEX_EDGE_TABLE[edgeIdx][0]]),
+                    mesh.vertices.at(cellVertexIndices[HEX_EDGE_TABLE[edgeIdx][1]])));
+        }
+    }
+    averageEdgeLength = numCells == 0 ? 0.0f : float(edgeLengthSum / double(numCells * 12));
+
+    buildCellFaceNeighbors();
+}
+
+void StressLineTracer::buildCellFaceNeighbors() {
+    // Faces shared by two cells have the same sorted vertex indices. Sorting the faces makes them adjacent.
+    struct FaceKey {
+        uint32_t vs[4];
+        uint32_t cellFaceIdx;
+
+        inline bool hasSameVertices(const FaceKey& other) const {
+            return vs[0] == other.vs[0] && vs[1] == other.vs[1] && vs[2] == other.vs[2] && vs[3] == other.vs[3];
+        }
+        inline bool operator<(const FaceKey& other) const {
+            for (int i = 0; i < 4; i++) {
+                if (vs[i] != other.vs[i]) {
+                    return vs[i] < other.vs[i];
+                }
+            }
+            return cellFaceIdx < other.cellFaceIdx;
+        }
+    };
+
+    uint32_t numCells = getNumCells();
+    const uint32_t* cellIndices = mesh.cellIndices.data();
+    std::vector<FaceKey> faceKeys(size_t(numCells) * 6);
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(faceKeys, cellIndices, numCells, HEX_FACE_TABLE) default(none)
+#endif
+    for (uint32_t cellIdx = 0; cellIdx < numCells; cellIdx++) {
+        for (int faceIdx = 0; faceIdx < 6; faceIdx++) {
+            FaceKey& faceKey = faceKeys.at(cellIdx * 6 + faceIdx);
+            for (int i = 0; i < 4; i++) {
+                faceKey.vs[i] = cellIndices[cellIdx * 8 + HEX_FACE_TABLE[faceIdx][i]];
+            }
+            std::sort(faceKey.vs, faceKey.vs + 4);
+            faceKey.cellFaceIdx = cellIdx * 6 + faceIdx;
+        }
+    }
+    std::sort(faceKeys.begin(), faceKeys.end());
+
+    cellFaceNeighbors.clear();
+    cellFaceNeighbors.resize(faceKeys.size(), INVALID_CELL);
+    for (size_t i = 0; i + 1 < faceKeys.size(); i++) {
+        if (faceKeys.at(i).hasSameVertices(faceKeys.at(i + 1))) {
+            uint32_t cellFaceIdx0 = faceKeys.at(i).cellFaceIdx;
+            uint32_t cellFaceIdx1 = faceKeys.at(i + 1).cellFaceIdx;
+            cellFaceNeighbors.at(cellFaceIdx0) = cellFaceIdx1 / 6;
+            cellFaceNeighbors.at(cellFaceIdx1) = cellFaceIdx0 / 6;
+            i++;
+        }
+    }
+}
+
+bool StressLineTracer::computeLocalCoordinates(
+        uint32_t cellIdx, const glm::vec3& position, glm::vec3& localCoordinates) const {
+    glm::vec3 cornerPositions[8];
+    for (int i = 0; i < 8; i++) {
+        cornerPositions[i] = mesh.vertices[mesh.cellIndices[cellIdx * 8 + i]];
+    }
+    return computeHexahedronLocalCoordinates(cornerPositions, position, localCoordinates);
+}
+
+bool StressLineTracer::locateCell(const glm::vec3& position, uint32_t& cellIdx, glm::vec3& localCoordinates) const {
+    const float epsilon = 1e-4f;
+    uint32_t currentCellIdx = cellIdx;
+    uint32_t previousCellIdx = INVALID_CELL;
+    for (int walkStep = 0; walkStep < 256; walkStep++) {
+        bool converged = computeLocalCoordinates(currentCellIdx, position, localCoordinates);
+
+        // Walk over the face with the largest violation of the [0, 1] range.
+        int faceIdx = -1;
+        float maxViolation = epsilon;
+        for (int i = 0; i < 3; i++) {
+            if (-localCoordinates[i] > maxViolation) {
+                maxViolation = -localCoordinates[i];
+                faceIdx = LOWER_FACE_INDICES[i];
+            }
+            if (localCoordinates[i] - 1.0f > maxViolation) {
+                maxViolation = localCoordinates[i] - 1.0f;
+                faceIdx = UPPER_FACE_INDICES[i];
+            }
+        }
+        if (faceIdx < 0) {
+            if (!converged) {
+                return false;
+            }
+            localCoordinates = glm::clamp(localCoordinates, 0.0f, 1.0f);
+            cellIdx = currentCellIdx;
+            return true;
+        }
+
+        uint32_t neighborCellIdx = cellFaceNeighbors[currentCellIdx * 6 + faceIdx];
+        // Stepping back to the previous cell means the position lies in a gap (e.g., at a concave boundary).
+        if (neighborCellIdx == INVALID_CELL || neighborCellIdx == previousCellIdx) {
+            return false;
+        }
+        previousCellIdx = currentCellIdx;
+        currentCellIdx = neighborCellIdx;
+    }
+    return false;
+}
+
+void StressLineTracer::interpolateStressTensor(
+        uint32_t cellIdx, const glm::vec3& localCoordinates, float tensor[6]) const {
+    interpolateStressTensorTrilinear(mesh, cellIdx, localCoordinates, tensor);
+}
+
+
+/**
+ * A sparse uniform grid over the points of the accepted lines of one principal stress direction. In contrast to the
+ * search structures in LineData/SearchStructures, points can be inserted incrementally, and the queries only check
+ * whether any point lies within a distance (which must not be larger than the cell size).
+ */
+class LinePointGrid {
+public:
+    LinePointGrid(const glm::vec3& origin, float cellSize) : origin(origin), cellSize(cellSize) {}
+
+    void insert(const glm::vec3& point) {
+        glm::ivec3 gridPosition = getGridPosition(point);
+        cells[getCellKey(gridPosition.x, gridPosition.y, gridPosition.z)].push_back(point);
+    }
+
+    bool hasPointCloserThan(const glm::vec3& point, float distance) const {
+        const float distanceSquared = distance * distance;
+        glm::ivec3 gridPosition = getGridPosition(point);
+        for (int z = gridPosition.z - 1; z <= gridPosition.z + 1; z++) {
+            for (int y = gridPosition.y - 1; y <= gridPosition.y + 1; y++) {
+                for (int x = gridPosition.x - 1; x <= gridPosition.x + 1; x++) {
+                    auto it = cells.find(getCellKey(x, y, z));
+                    if (it == cells.end()) {
+                        continue;
+                    }
+                    for (const glm::vec3& cellPoint : it->second) {
+                        glm::vec3 diff = cellPoint - point;
+                        if (glm::dot(diff, diff) < distanceSquared) {
+                            return true;
+                        }
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+private:
+    inline glm::ivec3 getGridPosition(const glm::vec3& point) const {
+        glm::vec3 gridPosition = glm::floor((point - origin) / cellSize);
+        return glm::ivec3(int(gridPosition.x), int(gridPosition.y), int(gridPosition.z));
+    }
+    static inline uint64_t getCellKey(int x, int y, int z) {
+        const int offset = 1 << 20;
+        return (uint64_t(uint32_t(x + offset) & 0x1FFFFFu) << 42u)
+                | (uint64_t(uint32_t(y + offset) & 0x1FFFFFu) << 21u)
+                | uint64_t(uint32_t(z + offset) & 0x1FFFFFu);
+    }
+
+    glm::vec3 origin;
+    float cellSize;
+    std::unordered_map<uint64_t, std::vector<glm::vec3>> cells;
+};
+
+/// The state shared by all seeds of one principal stress direction while tracing.
+struct StressLineTracingContext {
+    const StressLineTracer* tracer;
+    const LinePointGrid* grid; ///< The points of the lines accepted before the current batch.
+    const std::atomic<bool>* isCancelled;
+    int psIdx;
+    TracingAlgorithm tracingAlgorithm;
+    float stepSize;
+    float testDistance; ///< Lines stop when getting closer than this distance to accepted lines.
+    float cosMaxAngleDeviation;
+    int maxNumPointsPerDirection;
+};
+
+/// A line traced from a seed point in both directions.
+struct TracedStressLine {
+    std::vector<glm::vec3> positions;
+    std::vector<float> stressTensors; ///< Six values per point.
+    size_t seedPointIdx = 0;
+};
+
+/**
+ * A principal stress direction can't be determined at degenerate points, i.e., where the principal stress is equal to
+ * a neighboring principal stress.
+ */
+static bool getIsDegenerate(const float eigenvalues[3], int psIdx) {
+    float epsilon = 1e-3f * (std::abs(eigenvalues[0]) + std::abs(eigenvalues[1]) + std::abs(eigenvalues[2]));
+    if (epsilon <= 0.0f) {
+        return true;
+    }
+    return (psIdx != 2 && eigenvalues[0] - eigenvalues[1] <= epsilon)
+            || (psIdx != 0 && eigenvalues[1] - eigenvalues[2] <= epsilon);
+}
+
+/**
+ * Samples the tensor field and returns the principal stress direction aligned with the reference direction.
+ * @return False if the position lies outside of the mesh or at a degenerate point.
+ */
+static bool sampleDirection(
+        const StressLineTracingContext& ctx, const glm::vec3& position, uint32_t& cellIdx,
+        const glm::vec3& referenceDirection, glm::vec3& direction, float* tensorOut = nullptr) {
+    glm::vec3 localCoordinates;
+    if (!ctx.tracer->locateCell(position, cellIdx, localCoordinates)) {
+        return false;
+    }
+    float tensor[6];
+    ctx.tracer->interpolateStressTensor(cellIdx, localCoordinates, tensor);
+    float eigenvalues[3];
+    glm::vec3 eigenvectors[3];
+    computeEigenDecompositionSymmetric(tensor, eigenvalues, eigenvectors);
+    if (getIsDegenerate(eigenvalues, ctx.psIdx)) {
+        return false;
+    }
+    direction = eigenvectors[ctx.psIdx];
+    if (glm::dot(direction, referenceDirection) < 0.0f) {
+        direction = -direction;
+    }
+    if (tensorOut) {
+        for (int i = 0; i < 6; i++) {
+            tensorOut[i] = tensor[i];
+        }
+    }
+    return true;
+}
+
+/// Integrates the line starting at the seed in one direction (the seed point itself is not added).
+static void traceStressLineDirection(
+        const StressLineTracingContext& ctx, const glm::vec3& seedPosition, uint32_t seedCellIdx,
+        const glm::vec3& initialDirection, std::vector<glm::vec3>& positions, std::vector<float>& stressTensors) {
+    glm::vec3 position = seedPosition;
+    glm::vec3 previousDirection = initialDirection;
+    uint32_t cellIdx = seedCellIdx;
+    const float h = ctx.stepSize;
+    float tensor[6];
+
+    for (int pointIdx = 0; pointIdx < ctx.maxNumPointsPerDirection; pointIdx++) {
+        glm::vec3 k1, k2, k3, k4, direction;
+        if (!sampleDirection(ctx, position, cellIdx, previousDirection, k1)) {
+            break;
+        }
+        uint32_t stepCellIdx = cellIdx;
+        if (ctx.tracingAlgorithm == TracingAlgorithm::EULER) {
+            direction = k1;
+        } else if (ctx.tracingAlgorithm == TracingAlgorithm::RK2) {
+            if (!sampleDirection(ctx, position + (0.5f * h) * k1, stepCellIdx, k1, k2)) {
+                break;
+            }
+            direction = k2;
+        } else {
+            if (!sampleDirection(ctx, position + (0.5f * h) * k1, stepCellIdx, k1, k2)
+                    || !sampleDirection(ctx, position + (0.5f * h) * k2, stepCellIdx, k1, k3)
+                    || !sampleDirection(ctx, position + h * k3, stepCellIdx, k1, k4)) {
+                break;
+            }
+            direction = glm::normalize(k1 + 2.0f * k2 + 2.0f * k3 + k4);
+        }
+        if (glm::dot(direction, previousDirection) < ctx.cosMaxAngleDeviation) {
+            break;
+        }
+
+        glm::vec3 newPosition = position + h * direction;
+        glm::vec3 newDirection;
+        if (!sampleDirection(ctx, newPosition, stepCellIdx, direction, newDirection, tensor)) {
+            break;
+        }
+        if (ctx.grid->hasPointCloserThan(newPosition, ctx.testDistance)) {
+            break;
+        }
+        positions.push_back(newPosition);
+        stressTensors.insert(stressTensors.end(), tensor, tensor + 6);
+        position = newPosition;
+        previousDirection = direction;
+        cellIdx = stepCellIdx;
+    }
+}
+
+static void traceStressLine(
+        const StressLineTracingContext& ctx, const glm::vec3& seedPosition, uint32_t seedCellIdx,
+        TracedStressLine& line) {
+    glm::vec3 seedDirection;
+    float seedTensor[6];
+    uint32_t cellIdx = seedCellIdx;
+    if (!sampleDirection(ctx, seedPosition, cellIdx, glm::vec3(1.0f, 0.0f, 0.0f), seedDirection, seedTensor)) {
+        return;
+    }
+
+    std::vector<glm::vec3> backwardPositions;
+    std::vector<float> backwardStressTensors;
+    traceStressLineDirection(ctx, seedPosition, cellIdx, -seedDirection, backwardPositions, backwardStressTensors);
+
+    const size_t numBackwardPoints = backwardPositions.size();
+    line.positions.reserve(numBackwardPoints + 1);
+    line.stressTensors.reserve((numBackwardPoints + 1) * 6);
+    for (size_t i = 0; i < numBackwardPoints; i++) {
+        size_t srcIdx = numBackwardPoints - i - 1;
+        line.positions.push_back(backwardPositions.at(srcIdx));
+        line.stressTensors.insert(
+                line.stressTensors.end(), backwardStressTensors.begin() + srcIdx * 6,
+                backwardStressTensors.begin() + (srcIdx + 1) * 6);
+    }
+    line.seedPointIdx = numBackwardPoints;
+    line.positions.push_back(seedPosition);
+    line.stressTensors.insert(line.stressTensors.end(), seedTensor, seedTensor + 6);
+    traceStressLineDirection(ctx, seedPosition, cellIdx, seedDirection, line.positions, line.stressTensors);
+}
+
+/**
+ * Cuts off the parts of the line that come closer to the accepted lines than the test distance. This is necessary, as
+ * lines of the same batch were traced independently of each other.
+ */
+static void truncateStressLine(const LinePointGrid& grid, float testDistance, TracedStressLine& line) {
+    size_t startIdx = line.seedPointIdx;
+    while (startIdx > 0 && !grid.hasPointCloserThan(line.positions.at(startIdx - 1), testDistance)) {
+        startIdx--;
+    }
+    size_t endIdx = line.seedPointIdx + 1;
+    while (endIdx < line.positions.size() && !grid.hasPointCloserThan(line.positions.at(endIdx), testDistance)) {
+        endIdx++;
+    }
+    if (startIdx != 0 || endIdx != line.positions.size()) {
+        line.positions = std::vector<glm::vec3>(line.positions.begin() + startIdx, line.positions.begin() + endIdx);
+        line.stressTensors = std::vector<float>(
+                line.stressTensors.begin() + startIdx * 6, line.stressTensors.begin() + endIdx * 6);
+        line.seedPointIdx -= startIdx;
+    }
+}
+
+/**
+ * Computes the geometric hierarchy level of the lines. The lines are greedily thinned out with the separation distance
+ * doubled per level, i.e., lines still accepted for a large separation distance get a high importance.
+ * @return For each line, a level between 1 / numLevels (only shown at full density) and 1 (always shown).
+ */
+static std::vector<float> computeGeometricHierarchyLevels(
+        const std::vector<TracedStressLine>& lines, const glm::vec3& origin, float separationDistance,
+        int numLevels) {
+    numLevels = std::max(numLevels, 1);
+    std::vector<int> lineLevels(lines.size(), numLevels - 1);
+    for (int levelIdx = 0; levelIdx < numLevels - 1; levelIdx++) {
+        const float levelDistance = separationDistance * float(1 << (numLevels - 1 - levelIdx));
+        LinePointGrid grid(origin, levelDistance);
+        for (size_t lineIdx = 0; lineIdx < lines.size(); lineIdx++) {
+            const TracedStressLine& line = lines.at(lineIdx);
+            if (lineLevels.at(lineIdx) < levelIdx || !grid.hasPointCloserThan(
+                    line.positions.at(line.seedPointIdx), levelDistance)) {
+                lineLevels.at(lineIdx) = std::min(lineLevels.at(lineIdx), levelIdx);
+                for (const glm::vec3& position : line.positions) {
+                    grid.insert(position);
+                }
+            }
+        }
+    }
+
+    std::vector<float> hierarchyLevels(lines.size());
+    for (size_t lineIdx = 0; lineIdx < lines.size(); lineIdx++) {
+        hierarchyLevels.at(lineIdx) = float(numLevels - lineLevels.at(lineIdx)) / float(numLevels);
+    }
+    return hierarchyLevels;
+}
+
+void StressLineTracer::computeSeedPoints(
+        const StressLineTracingSettings& settings, std::vector<glm::vec3>& seedPoints,
+        std::vector<uint32_t>& seedCells) const {
+    const uint32_t numCells = getNumCells();
+    const uint32_t stride = uint32_t(std::max(std::round(settings.seedDensCtrl), 1.0f));
+    auto getCellCenter = [this](uint32_t cellIdx) {
+        glm::vec3 center(0.0f);
+        for (int i = 0; i < 8; i++) {
+            center += mesh.vertices.at(mesh.cellIndices.at(cellIdx * 8 + i));
+        }
+        return center / 8.0f;
+    };
+
+    if (settings.seedStrategy == SeedStrategy::SURFACE) {
+        // Seed points at the centers of the boundary faces (moved slightly into the cell).
+        uint32_t boundaryFaceCounter = 0;
+        for (uint32_t cellIdx = 0; cellIdx < numCells; cellIdx++) {
+            for (int faceIdx = 0; faceIdx < 6; faceIdx++) {
+                if (cellFaceNeighbors.at(cellIdx * 6 + faceIdx) != INVALID_CELL) {
+                    continue;
+                }
+                if (boundaryFaceCounter++ % stride != 0) {
+                    continue;
+                }
+                glm::vec3 faceCenter(0.0f);
+                for (int i = 0; i < 4; i++) {
+                    faceCenter += mesh.vertices.at(mesh.cellIndices.at(cellIdx * 8 + HEX_FACE_TABLE[faceIdx][i]));
+                }
+                faceCenter /= 4.0f;
+                seedPoints.push_back(faceCenter + 0.01f * (getCellCenter(cellIdx) - faceCenter));
+                seedCells.push_back(cellIdx);
+            }
+        }
+    } else {
+        // Loading areas and fixed areas are not part of the mesh files, so volume seeding is used for them.
+        for (uint32_t cellIdx = 0; cellIdx < numCells; cellIdx += stride) {
+            seedPoints.push_back(getCellCenter(cellIdx));
+            seedCells.push_back(cellIdx);
+        }
+    }
+
+    // Lines are seeded in regions with high stress first.
+    size_t numSeeds = seedPoints.size();
+    std::vector<float> seedVonMisesStresses(numSeeds);
+#if _OPENMP >= 201107
+    #pragma omp parallel for shared(seedPoints, seedCells, seedVonMisesStresses, numSeeds) default(none)
+#endif
+    for (size_t seedIdx = 0; seedIdx < numSeeds; seedIdx++) {
+        uint32_t cellIdx = seedCells.at(seedIdx);
+        glm::vec3 localCoordinates;
+        float tensor[6];
+        computeLocalCoordinates(cellIdx, seedPoints.at(seedIdx), localCoordinates);
+        interpolateStressTensor(cellIdx, glm::clamp(localCoordinates, 0.0f, 1.0f), tensor);
+        seedVonMisesStresses.at(seedIdx) = computeVonMisesStress(tensor);
+    }
+    std::vector<size_t> seedOrder(numSeeds);
+    for (size_t seedIdx = 0; seedIdx < numSeeds; seedIdx++) {
+        seedOrder.at(seedIdx) = seedIdx;
+    }
+    std::stable_sort(seedOrder.begin(), seedOrder.end(), [&seedVonMisesStresses](size_t i, size_t j) {
+        return seedVonMisesStresses.at(i) > seedVonMisesStresses.at(j);
+    });
+    std::vector<glm::vec3> sortedSeedPoints(numSeeds);
+    std::vector<uint32_t> sortedSeedCells(numSeeds);
+    for (size_t i = 0; i < numSeeds; i++) {
+        sortedSeedPoints.at(i) = seedPoints.at(seedOrder.at(i));
+        sortedSeedCells.at(i) = seedCells.at(seedOrder.at(i));
+    }
+    seedPoints = std::move(sortedSeedPoints);
+    seedCells = std::move(sortedSeedCells);
+}
+
+bool StressLineTracer::trace(
+        const StressLineTracingSettings& settings, StressTrajectoriesMemoryData& data,
+        const std::atomic<bool>* isCancelled) const {
+    data = StressTrajectoriesMemoryData();
+    data.meshType = MeshType::UNSTRUCTURED;
+    if (getNumCells() == 0) {
+        return true;
+    }
+
+    std::vector<glm::vec3> seedPoints;
+    std::vector<uint32_t> seedCells;
+    computeSeedPoints(settings, seedPoints, seedCells);
+
+    glm::vec3 extent = maxBounds - minBounds;
+    float minExtent = std::max(extent.x, std::max(extent.y, extent.z));
+    for (int i = 0; i < 3; i++) {
+        if (extent[i] > 0.0f) {
+            minExtent = std::min(minExtent, extent[i]);
+        }
+    }
+    if (minExtent <= 0.0f) {
+        // All vertices of the mesh coincide.
+        return true;
+    }
+    const float cosMaxAngleDeviation = std::cos(glm::radians(settings.maxAngleDeviation));
+    int appearanceOrder = 0;
+
+    for (int psIdx : settings.psIndices) {
+        // A merging threshold of zero would result in grid cells of size zero (@see LinePointGrid).
+        const float separationDistance = std::max(
+                minExtent / std::max(settings.lineDensCtrl, 1.0f) * settings.multiMergingThresholds[psIdx],
+                MIN_SEPARATION_DISTANCE_FACTOR * minExtent);
+        const float testDistance = 0.5f * separationDistance;
+        LinePointGrid grid(minBounds, separationDistance);
+
+        StressLineTracingContext ctx;
+        ctx.tracer = this;
+        ctx.grid = &grid;
+        ctx.isCancelled = isCancelled;
+        ctx.psIdx = psIdx;
+        ctx.tracingAlgorithm = settings.tracingAlgorithm;
+        ctx.stepSize = std::min(settings.stepSizeFactor * averageEdgeLength, 0.25f * separationDistance);
+        ctx.testDistance = testDistance;
+        ctx.cosMaxAngleDeviation = cosMaxAngleDeviation;
+        ctx.maxNumPointsPerDirection = std::max(settings.maxNumPointsPerLine / 2, 1);
+
+        // Early batches are small, as the first lines usually cover most of the seed points. Larger batches expose
+        // more parallelism, but more of their lines are rejected for running close to lines of the same batch.
+        std::vector<TracedStressLine> lines;
+        size_t seedIdx = 0;
+        size_t batchSize = 8;
+        while (seedIdx < seedPoints.size()) {
+            if (isCancelled && *isCancelled) {
+                return false;
+            }
+            // Seeds close to the accepted lines or to other seeds of the batch would most likely be rejected.
+            std::vector<size_t> batchSeedIndices;
+            LinePointGrid batchSeedGrid(minBounds, separationDistance);
+            while (seedIdx < seedPoints.size() && batchSeedIndices.size() < batchSize) {
+                const glm::vec3& seedPoint = seedPoints.at(seedIdx);
+                if (!grid.hasPointCloserThan(seedPoint, separationDistance)
+                        && !batchSeedGrid.hasPointCloserThan(seedPoint, separationDistance)) {
+                    batchSeedIndices.push_back(seedIdx);
+                    batchSeedGrid.insert(seedPoint);
+                }
+                seedIdx++;
+            }
+
+            int numBatchSeeds = int(batchSeedIndices.size());
+            std::vector<TracedStressLine> batchLines(batchSeedIndices.size());
+#if _OPENMP >= 201107
+            #pragma omp parallel for shared(ctx, batchSeedIndices, batchLines, seedPoints, seedCells, numBatchSeeds) \
+            default(none) schedule(dynamic)
+#endif
+            for (int batchIdx = 0; batchIdx < numBatchSeeds; batchIdx++) {
+                if (ctx.isCancelled && *ctx.isCancelled) {
+                    continue;
+                }
+                size_t lineSeedIdx = batchSeedIndices.at(batchIdx);
+                traceStressLine(ctx, seedPoints.at(lineSeedIdx), seedCells.at(lineSeedIdx), batchLines.at(batchIdx));
+            }
+
+            // Accept the lines in seed order, so the result is deterministic.
+            for (TracedStressLine& line : batchLines) {
+                if (line.positions.empty()
+                        || grid.hasPointCloserThan(line.positions.at(line.seedPointIdx), separationDistance)) {
+                    continue;
+                }
+                truncateStressLine(grid, testDistance, line);
+                if (line.positions.size() < 2) {
+                    continue;
+                }
+                for (const glm::vec3& position : line.positions) {
+                    grid.insert(position);
+                }
+                lines.push_back(std::move(line));
+            }
+            batchSize = std::min(batchSize * 2, size_t(64));
+        }
+        if (isCancelled && *isCancelled) {
+            return false;
+        }
+
+        // Convert the lines to the format used by the loaders.
+        const size_t numLines = lines.size();
+        data.loadedPsIndices.push_back(psIdx);
+        data.trajectoriesPs.emplace_back(numLines);
+        data.stressTrajectoriesDataPs.emplace_back(numLines);
+        data.bandPointsUnsmoothedListLeftPs.emplace_back(numLines);
+        data.bandPointsUnsmoothedListRightPs.emplace_back(numLines);
+        data.bandPointsSmoothedListLeftPs.emplace_back(numLines);
+        data.bandPointsSmoothedListRightPs.emplace_back(numLines);
+        Trajectories& trajectories = data.trajectoriesPs.back();
+        StressTrajectoriesData& stressTrajectoriesData = data.stressTrajectoriesDataPs.back();
+
+        // The bands of major and minor lines span the medium principal stress direction and vice versa.
+        const int bandPsIdx = psIdx == 1 ? 0 : 1;
+        const float bandHalfWidth = 0.25f * separationDistance;
+        std::vector<float> meanPrincipalStresses(numLines), meanVonMisesStresses(numLines), lineLengths(numLines);
+        for (size_t lineIdx = 0; lineIdx < numLines; lineIdx++) {
+            const TracedStressLine& line = lines.at(lineIdx);
+            const size_t numPoints = line.positions.size();
+            Trajectory& trajectory = trajectories.at(lineIdx);
+            trajectory.positions = line.positions;
+            trajectory.attributes.resize(9);
+            for (std::vector<float>& attributes : trajectory.attributes) {
+                attributes.reserve(numPoints);
+            }
+
+            std::vector<glm::vec3> bandDirections(numPoints);
+            double principalStressSum = 0.0, vonMisesStressSum = 0.0, lineLength = 0.0;
+            for (size_t pointIdx = 0; pointIdx < numPoints; pointIdx++) {
+                const float* tensor = &line.stressTensors.at(pointIdx * 6);
+                float eigenvalues[3];
+                glm::vec3 eigenvectors[3];
+                computeEigenDecompositionSymmetric(tensor, eigenvalues, eigenvectors);
+                float principalStress = eigenvalues[psIdx];
+                float vonMisesStress = computeVonMisesStress(tensor);
+                trajectory.attributes.at(0).push_back(principalStress);
+                trajectory.attributes.at(1).push_back(std::abs(principalStress));
+                trajectory.attributes.at(2).push_back(vonMisesStress);
+                for (int i = 0; i < 6; i++) {
+                    trajectory.attributes.at(3 + i).push_back(tensor[i]);
+                }
+                principalStressSum += std::abs(principalStress);
+                vonMisesStressSum += vonMisesStress;
+                if (pointIdx > 0) {
+                    lineLength += glm::distance(line.positions.at(pointIdx - 1), line.positions.at(pointIdx));
+                }
+
+                glm::vec3 bandDirection = eigenvectors[bandPsIdx];
+                if (pointIdx > 0 && glm::dot(bandDirection, bandDirections.at(pointIdx - 1)) < 0.0f) {
+                    bandDirection = -bandDirection;
+                }
+                bandDirections.at(pointIdx) = bandDirection;
+            }
+            meanPrincipalStresses.at(lineIdx) = float(principalStressSum / double(numPoints));
+            meanVonMisesStresses.at(lineIdx) = float(vonMisesStressSum / double(numPoints));
+            lineLengths.at(lineIdx) = float(lineLength);
+
+            std::vector<glm::vec3>& bandPointsUnsmoothedLeft = data.bandPointsUnsmoothedListLeftPs.back().at(lineIdx);
+            std::vector<glm::vec3>& bandPointsUnsmoothedRight = data.bandPointsUnsmoothedListRightPs.back().at(lineIdx);
+            std::vector<glm::vec3>& bandPointsSmoothedLeft = data.bandPointsSmoothedListLeftPs.back().at(lineIdx);
+            std::vector<glm::vec3>& bandPointsSmoothedRight = data.bandPointsSmoothedListRightPs.back().at(lineIdx);
+            for (size_t pointIdx = 0; pointIdx < numPoints; pointIdx++) {
+                const glm::vec3& position = line.positions.at(pointIdx);
+                glm::vec3 offset = bandHalfWidth * bandDirections.at(pointIdx);
+                bandPointsUnsmoothedLeft.push_back(position - offset);
+                bandPointsUnsmoothedRight.push_back(position + offset);
+
+                // The smoothed band uses the mean direction of the neighboring points.
+                glm::vec3 smoothedDirection(0.0f);
+                size_t windowStart = pointIdx >= 2 ? pointIdx - 2 : 0;
+                size_t windowEnd = std::min(pointIdx + 3, numPoints);
+                for (size_t windowIdx = windowStart; windowIdx < windowEnd; windowIdx++) {
+                    smoothedDirection += bandDirections.at(windowIdx);
+                }
+                float smoothedDirectionLength = glm::length(smoothedDirection);
+                smoothedDirection = smoothedDirectionLength > 1e-6f
+                        ? smoothedDirection / smoothedDirectionLength : bandDirections.at(pointIdx);
+                offset = bandHalfWidth * smoothedDirection;
+                bandPointsSmoothedLeft.push_back(position - offset);
+                bandPointsSmoothedRight.push_back(position + offset);
+            }
+
+            StressTrajectoryData& stressTrajectoryData = stressTrajectoriesData.at(lineIdx);
+            stressTrajectoryData.appearanceOrder = appearanceOrder++;
+            stressTrajectoryData.seedPosition = line.positions.at(line.seedPointIdx);
+        }
+
+        // Hierarchy levels: Geometric, principal stress, von Mises stress and line length.
+        std::vector<float> geometricLevels = computeGeometricHierarchyLevels(
+                lines, minBounds, separationDistance, settings.numLevels);
+        float maxPrincipalStress = 0.0f, maxVonMisesStress = 0.0f, maxLineLength = 0.0f;
+        for (size_t lineIdx = 0; lineIdx < numLines; lineIdx++) {
+            maxPrincipalStress = std::max(maxPrincipalStress, meanPrincipalStresses.at(lineIdx));
+            maxVonMisesStress = std::max(maxVonMisesStress, meanVonMisesStresses.at(lineIdx));
+            maxLineLength = std::max(maxLineLength, lineLengths.at(lineIdx));
+        }
+        for (size_t lineIdx = 0; lineIdx < numLines; lineIdx++) {
+            std::vector<float>& hierarchyLevels = stressTrajectoriesData.at(lineIdx).hierarchyLevels;
+            hierarchyLevels.push_back(geometricLevels.at(lineIdx));
+            hierarchyLevels.push_back(
+                    maxPrincipalStress > 0.0f ? meanPrincipalStresses.at(lineIdx) / maxPrincipalStress : 1.0f);
+            hierarchyLevels.push_back(
+                    maxVonMisesStress > 0.0f ? meanVonMisesStresses.at(lineIdx) / maxVonMisesStress : 1.0f);
+            hierarchyLevels.push_back(maxLineLength > 0.0f ? lineLengths.at(lineIdx) / maxLineLength : 1.0f);
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,197 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LINEVIS_STRESSLINETRACER_HPP
+#define LINEVIS_STRESSLINETRACER_HPP
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <glm/vec3.hpp>
+
+struct StressTrajectoriesMemoryData;
+
+enum class SeedStrategy {
+    VOLUME, SURFACE, LOADING_AREA, APPROX_TOPOLOGY
+};
+const char* const SEED_STRATEGY_NAMES[] = {
+        "Homogeneous Volume Seeding",
+        "Surface Seeding",
+        "Loading Areas Seeding",
+        "Fixed Area Seeding"
+};
+const char* const SEED_STRATEGY_ABBREVIATIONS[] = {
+        "Volume",
+        "Surface",
+        "LoadingArea",
+        "FixedArea"
+};
+
+enum class TracingAlgorithm {
+    EULER, RK2, RK4
+};
+const char* const TRACING_ALGORITHM_NAMES[] = {
+        "Euler", "Runge-Kutta 2nd Order", "Runge-Kutta 4th Order"
+};
+const char* const TRACING_ALGORITHM_ABBREVIATIONS[] = {
+        "Euler", "RK2", "RK4"
+};
+
+/// A hexahedral simulation mesh with per-vertex stress tensors.
+struct StressTensorMesh {
+    std::vector<glm::vec3> vertices;
+    std::vector<uint32_t> cellIndices; ///< Eight vertex indices per cell (VTK vertex order).
+    std::vector<float> stressTensors; ///< Six values per vertex (xx, yy, zz, yz, zx, xy).
+};
+
+/**
+ * Loads a hexahedral mesh with per-vertex stress tensors (@see HexahedralMeshLoader).
+ * @param meshFilename The name of the mesh file.
+ * @param mesh Where to store the mesh.
+ * @return Whether loading has succeeded.
+ */
+bool loadStressTensorMeshFromFile(const std::string& meshFilename, StressTensorMesh& mesh);
+
+/**
+ * Computes the eigenvalues and eigenvectors of a symmetric stress tensor using the Jacobi eigenvalue algorithm.
+ * @param tensor The tensor (xx, yy, zz, yz, zx, xy).
+ * @param eigenvalues The principal stresses sorted in descending order (major, medium, minor).
+ * @param eigenvectors The normalized principal stress directions belonging to the eigenvalues.
+ */
+void computeEigenDecompositionSymmetric(const float tensor[6], float eigenvalues[3], glm::vec3 eigenvectors[3]);
+
+/// Computes the von Mises stress of a stress tensor (xx, yy, zz, yz, zx, xy).
+float computeVonMisesStress(const float tensor[6]);
+
+/**
+ * Interpolates the per-vertex stress tensors of a mesh cell trilinearly.
+ * @param mesh The mesh.
+ * @param cellIdx The index of the cell.
+ * @param localCoordinates The local coordinates in the cell.
+ * @param tensor The interpolated tensor (xx, yy, zz, yz, zx, xy).
+ */
+void interpolateStressTensorTrilinear(
+        const StressTensorMesh& mesh, uint32_t cellIdx, const glm::vec3& localCoordinates, float tensor[6]);
+
+struct StressLineTracingSettings {
+    std::vector<int> psIndices = { 0, 2 }; ///< The principal stress directions to trace (0: major, 2: minor).
+    SeedStrategy seedStrategy = SeedStrategy::VOLUME;
+    TracingAlgorithm tracingAlgorithm = TracingAlgorithm::RK2;
+    float lineDensCtrl = 16.0f; ///< The line separation distance is the smallest mesh extent divided by this value.
+    float seedDensCtrl = 4.0f; ///< Only every n-th seed point candidate is used.
+    int numLevels = 4; ///< The number of geometric hierarchy levels.
+    float maxAngleDeviation = 6.0f; ///< Lines are stopped if they bend by more than this angle per step (in degrees).
+    glm::vec3 multiMergingThresholds = glm::vec3(1.0f); ///< Separation distance factors of the three directions.
+    float stepSizeFactor = 0.2f; ///< The integration step size relative to the average edge length of the mesh.
+    int maxNumPointsPerLine = 10000;
+};
+
+/**
+ * Traces principal stress lines (PSLs) in a hexahedral mesh with per-vertex stress tensors.
+ * The tensors are interpolated trilinearly in the cells, and the eigenvector field of the selected principal stress is
+ * integrated using Euler, RK2 or RK4 steps starting at seed points in the volume or on the boundary surface. The
+ * orientation of the eigenvectors is aligned with the previous step direction.
+ * A line is stopped when it leaves the mesh, bends more than the maximum angle deviation per step, reaches a degenerate
+ * point (two equal principal stresses), or comes closer to an existing line of the same direction than half the
+ * separation distance (cmp. Jobard and Lefer, "Creating Evenly-Spaced Streamlines of Arbitrary Density", 1997).
+ * Seeds are traced in parallel in batches. The lines of a batch are accepted sequentially in seed order, so the result
+ * does not depend on the number of threads.
+ */
+class StressLineTracer {
+public:
+    /**
+     * @param mesh The mesh to trace the lines in. The face adjacency of the cells is computed on construction.
+     */
+    explicit StressLineTracer(const StressTensorMesh& mesh);
+
+    /**
+     * Traces the principal stress lines.
+     * @param settings The tracing settings.
+     * @param data Where to store the lines (including bands and hierarchy levels).
+     * @param isCancelled If not nullptr, tracing is aborted as soon as the flag is set.
+     * @return False if tracing was cancelled.
+     */
+    bool trace(
+            const StressLineTracingSettings& settings, StressTrajectoriesMemoryData& data,
+            const std::atomic<bool>* isCancelled = nullptr) const;
+
+    /**
+     * Computes the local (trilinear) coordinates of a position in a cell using Newton iterations
+     * (@see computeHexahedronLocalCoordinates).
+     * @param cellIdx The index of the cell.
+     * @param position The world space position.
+     * @param localCoordinates The local coordinates. They lie in [0, 1]^3 if the position lies in the cell.
+     * @return Whether the Newton iterations converged.
+     */
+    bool computeLocalCoordinates(uint32_t cellIdx, const glm::vec3& position, glm::vec3& localCoordinates) const;
+    /**
+     * Finds the cell containing a position by walking over the face neighbors starting at a cell close to it.
+     * @param position The world space position.
+     * @param cellIdx The start cell. On success, the index of the cell containing the position is stored here.
+     * @param localCoordinates The local coordinates of the position in the found cell.
+     * @return False if the position lies outside of the mesh.
+     */
+    bool locateCell(const glm::vec3& position, uint32_t& cellIdx, glm::vec3& localCoordinates) const;
+    /**
+     * Interpolates the stress tensor trilinearly.
+     * @param cellIdx The index of the cell.
+     * @param localCoordinates The local coordinates in the cell.
+     * @param tensor The interpolated tensor (xx, yy, zz, yz, zx, xy).
+     */
+    void interpolateStressTensor(uint32_t cellIdx, const glm::vec3& localCoordinates, float tensor[6]) const;
+
+    inline const StressTensorMesh& getMesh() const { return mesh; }
+    inline uint32_t getNumCells() const { return uint32_t(mesh.cellIndices.size() / 8); }
+    inline float getAverageEdgeLength() const { return averageEdgeLength; }
+    inline const glm::vec3& getMinBounds() const { return minBounds; }
+    inline const glm::vec3& getMaxBounds() const { return maxBounds; }
+    /// @return The neighbor of a cell across a face (@see cellFaceNeighbors) or INVALID_CELL at the boundary.
+    inline uint32_t getCellFaceNeighbor(uint32_t cellIdx, int faceIdx) const {
+        return cellFaceNeighbors.at(cellIdx * 6 + faceIdx);
+    }
+
+    static const uint32_t INVALID_CELL = 0xFFFFFFFFu;
+
+private:
+    void buildCellFaceNeighbors();
+    void computeSeedPoints(
+            const StressLineTracingSettings& settings, std::vector<glm::vec3>& seedPoints,
+            std::vector<uint32_t>& seedCells) const;
+
+    StressTensorMesh mesh;
+    /**
+     * Six neighbor cell indices per cell. The faces are ordered w = 0, w = 1, v = 0, u = 0, v = 1, u = 1 in local
+     * coordinates (the same face order as in MeshBoundarySurface.cpp).
+     */
+    std::vector<uint32_t> cellFaceNeighbors;
+    float averageEdgeLength = 0.0f;
+    glm::vec3 minBounds, maxBounds;
+};
+
+#endif //LINEVIS_STRESSLINETRACER_HPP
@@ -0,0 +1,214 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <Utils/File/Logfile.hpp>
+
+#include "Loaders/StressTrajectoriesBinaryLoader.hpp"
+#include "StressLineTracingResultCache.hpp"
+#include "StressLineTracingLocalWorker.hpp"
+
+static double getElapsedMilliseconds(const std::chrono::steady_clock::time_point& start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void parseStressLineTracingRequest(const Json::Value& request, StressLineTracingSettings& settings) {
+    if (request["lineDensCtrl"].isNumeric()) {
+        settings.lineDensCtrl = request["lineDensCtrl"].asFloat();
+    }
+    if (request["seedDensCtrl"].isNumeric()) {
+        settings.seedDensCtrl = request["seedDensCtrl"].asFloat();
+    }
+    if (request["numLevels"].isNumeric()) {
+        settings.numLevels = request["numLevels"].asInt();
+    }
+    if (request["maxAngleDevi"].isNumeric()) {
+        settings.maxAngleDeviation = request["maxAngleDevi"].asFloat();
+    }
+    const Json::Value& multiMergingThresholds = request["multiMergingThresholds"];
+    if (multiMergingThresholds.isArray() && multiMergingThresholds.size() == 3) {
+        for (Json::ArrayIndex i = 0; i < 3; i++) {
+            settings.multiMergingThresholds[int(i)] = multiMergingThresholds[i].asFloat();
+        }
+    }
+
+    const std::string seedStrategyName = request.get("seedStrategy", "").asString();
+    for (int i = 0; i < int(sizeof(SEED_STRATEGY_ABBREVIATIONS) / sizeof(*SEED_STRATEGY_ABBREVIATIONS)); i++) {
+        if (seedStrategyName == SEED_STRATEGY_ABBREVIATIONS[i]) {
+            settings.seedStrategy = SeedStrategy(i);
+        }
+    }
+    const std::string tracingAlgorithmName = request.get("traceAlgorithm", "").asString();
+    for (int i = 0; i < int(sizeof(TRACING_ALGORITHM_ABBREVIATIONS) / sizeof(*TRACING_ALGORITHM_ABBREVIATIONS)); i++) {
+        if (tracingAlgorithmName == TRACING_ALGORITHM_ABBREVIATIONS[i]) {
+            settings.tracingAlgorithm = TracingAlgorithm(i);
+        }
+    }
+
+    // The principal stress fields are numbered starting at one in the requests.
+    const Json::Value& selectedPrincipalStressField = request["selectedPrincipalStressField"];
+    if (selectedPrincipalStressField.isArray()) {
+        settings.psIndices.clear();
+        for (const Json::Value& psIdx : selectedPrincipalStressField) {
+            if (psIdx.isNumeric() && psIdx.asInt() >= 1 && psIdx.asInt() <= 3) {
+                settings.psIndices.push_back(psIdx.asInt() - 1);
+            }
+        }
+    }
+}
+
+StressLineTracingLocalWorker::StressLineTracingLocalWorker() : isCancelled(false), isProcessingRequest(false) {
+    workerThread = std::thread(&StressLineTracingLocalWorker::mainLoop, this);
+}
+
+StressLineTracingLocalWorker::~StressLineTracingLocalWorker() {
+    join();
+}
+
+void StressLineTracingLocalWorker::join() {
+    if (!programIsFinished) {
+        {
+            std::lock_guard<std::mutex> lock(requestMutex);
+            programIsFinished = true;
+            hasRequest = true;
+            isCancelled = true;
+        }
+        hasRequestConditionVariable.notify_all();
+        if (workerThread.joinable()) {
+            workerThread.join();
+        }
+    }
+}
+
+uint64_t StressLineTracingLocalWorker::queueRequestJson(const Json::Value& request) {
+    uint64_t newRequestId;
+    {
+        std::lock_guard<std::mutex> lock(requestMutex);
+        newRequestId = requestId = ++lastRequestId;
+        this->request = request;
+        this->request["requestId"] = Json::UInt64(newRequestId);
+        requestQueuedTime = std::chrono::steady_clock::now();
+        hasRequest = true;
+        // The request currently traced (if any) is outdated.
+        isCancelled = true;
+        isProcessingRequest = true;
+    }
+    hasRequestConditionVariable.notify_all();
+    return newRequestId;
+}
+
+bool StressLineTracingLocalWorker::getReplyJson(
+        Json::Value& reply, std::shared_ptr<const StressTrajectoriesMemoryData>& replyData,
+        StressLineTracingReplyTimings* replyTimings) {
+    std::lock_guard<std::mutex> lock(replyMutex);
+    bool hasReply = this->hasReply;
+    replyData = nullptr;
+    if (hasReply) {
+        reply = this->reply;
+        replyData = this->replyData;
+        if (replyTimings) {
+            *replyTimings = this->replyTimings;
+        }
+    }
+    this->hasReply = false;
+    this->reply = Json::Value();
+    this->replyData = nullptr;
+    return hasReply;
+}
+
+void StressLineTracingLocalWorker::mainLoop() {
+    while (true) {
+        Json::Value currentRequest;
+        uint64_t currentRequestId;
+        std::chrono::steady_clock::time_point currentRequestQueuedTime;
+        {
+            std::unique_lock<std::mutex> lock(requestMutex);
+            hasRequestConditionVariable.wait(lock, [this] { return hasRequest; });
+            if (programIsFinished) {
+                break;
+            }
+            currentRequest = request;
+            currentRequestId = requestId;
+            currentRequestQueuedTime = requestQueuedTime;
+            hasRequest = false;
+            isCancelled = false;
+        }
+
+        Json::Value currentReply;
+        std::shared_ptr<const StressTrajectoriesMemoryData> currentReplyData;
+        bool hasCurrentReply = processRequest(currentRequest, currentReply, currentReplyData);
+        if (hasCurrentReply) {
+            currentReply["requestId"] = Json::UInt64(currentRequestId);
+            std::lock_guard<std::mutex> lock(replyMutex);
+            hasReply = true;
+            reply = currentReply;
+            replyData = currentReplyData;
+            replyTimings.roundTripMs = getElapsedMilliseconds(currentRequestQueuedTime);
+            replyTimings.decodingMs = 0.0;
+        }
+
+        std::lock_guard<std::mutex> lock(requestMutex);
+        isProcessingRequest = hasRequest;
+    }
+}
+
+bool StressLineTracingLocalWorker::processRequest(
+        const Json::Value& request, Json::Value& reply,
+        std::shared_ptr<const StressTrajectoriesMemoryData>& replyData) {
+    auto startTime = std::chrono::steady_clock::now();
+    const std::string meshFilename = request.get("fileName", "").asString();
+    const std::string meshIdentity = StressLineTracingResultCache::getMeshIdentity(meshFilename);
+    if (!tracer || meshIdentity != loadedMeshIdentity) {
+        tracer = {};
+        loadedMeshIdentity.clear();
+        StressTensorMesh mesh;
+        if (!loadStressTensorMeshFromFile(meshFilename, mesh)) {
+            sgl::Logfile::get()->writeError(
+                    "Error in StressLineTracingLocalWorker::processRequest: The built-in tracer needs a hexahedral "
+                    "mesh with per-vertex stress tensors.");
+            return false;
+        }
+        tracer = std::unique_ptr<StressLineTracer>(new StressLineTracer(mesh));
+        loadedMeshIdentity = meshIdentity;
+    }
+    const double meshLoadingMs = getElapsedMilliseconds(startTime);
+
+    StressLineTracingSettings settings;
+    parseStressLineTracingRequest(request, settings);
+    std::shared_ptr<StressTrajectoriesMemoryData> data = std::make_shared<StressTrajectoriesMemoryData>();
+    if (!tracer->trace(settings, *data, &isCancelled)) {
+        return false;
+    }
+
+    reply = Json::Value();
+    reply["serverTimings"]["meshLoadingMs"] = meshLoadingMs;
+    // The tracing time includes loading the mesh, so only the waiting time in the queue is left for "transport".
+    reply["serverTimings"]["tracingMs"] = getElapsedMilliseconds(startTime);
+    reply["serverTimings"]["serializationMs"] = 0.0;
+    replyData = data;
+    return true;
+}
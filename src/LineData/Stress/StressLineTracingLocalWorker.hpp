@@ -0,0 +1,124 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LINEVIS_STRESSLINETRACINGLOCALWORKER_HPP
+#define LINEVIS_STRESSLINETRACINGLOCALWORKER_HPP
+
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <condition_variable>
+
+#include <json/json.h>
+
+#include "StressLineTracingRequesterSocket.hpp"
+#include "StressLineTracer.hpp"
+
+/**
+ * Traces stress lines with the built-in CPU tracer (@see StressLineTracer) on a worker thread. It offers the same
+ * mailbox interface as StressLineTracingRequesterSocket, so the requester can use it in place of the tracing service,
+ * and it accepts the same JSON requests.
+ * A request queued while an older one is still traced cancels the older one. The mesh of the last request is kept
+ * until the file changes, so changing the tracing parameters doesn't reload it.
+ * Replies contain the "requestId" of the request and the entry "serverTimings" with the time needed for loading the
+ * mesh and tracing the lines (in milliseconds). The lines are passed in memory.
+ */
+class StressLineTracingLocalWorker {
+public:
+    StressLineTracingLocalWorker();
+    ~StressLineTracingLocalWorker();
+
+    /// Stops the worker thread.
+    void join();
+
+    /**
+     * Queues the request for the worker thread. The entry "requestId" is added to the request.
+     * @param request The request to queue.
+     * @return The ID of the request.
+     */
+    uint64_t queueRequestJson(const Json::Value& request);
+    /**
+     * Checks if a request was processed. If so, the reply is stored in reply.
+     * @param reply Where to store the reply (if one is available).
+     * @param replyData Where to store the traced lines.
+     * @param replyTimings If not nullptr, the timings of the reply are stored here.
+     * @return Whether a reply is available.
+     */
+    bool getReplyJson(
+            Json::Value& reply, std::shared_ptr<const StressTrajectoriesMemoryData>& replyData,
+            StressLineTracingReplyTimings* replyTimings = nullptr);
+
+    /**
+     * @return Whether a request is currently processed (for UI progress spinner).
+     */
+    inline bool getIsProcessingRequest() const { return isProcessingRequest; }
+
+private:
+    /// The main loop of the worker thread.
+    void mainLoop();
+    /**
+     * Loads the mesh (if necessary) and traces the lines.
+     * @return False if the mesh couldn't be loaded or the request was cancelled.
+     */
+    bool processRequest(
+            const Json::Value& request, Json::Value& reply,
+            std::shared_ptr<const StressTrajectoriesMemoryData>& replyData);
+
+    std::thread workerThread;
+    std::condition_variable hasRequestConditionVariable;
+    std::mutex requestMutex;
+    std::mutex replyMutex;
+
+    bool programIsFinished = false;
+    bool hasRequest = false;
+    Json::Value request;
+    uint64_t requestId = 0; ///< The ID of the queued request.
+    uint64_t lastRequestId = 0;
+    std::chrono::steady_clock::time_point requestQueuedTime;
+    std::atomic<bool> isCancelled; ///< Set when a newer request is queued.
+    std::atomic<bool> isProcessingRequest;
+
+    bool hasReply = false;
+    Json::Value reply;
+    std::shared_ptr<const StressTrajectoriesMemoryData> replyData;
+    StressLineTracingReplyTimings replyTimings;
+
+    // The last loaded mesh (only accessed by the worker thread).
+    std::string loadedMeshIdentity;
+    std::unique_ptr<StressLineTracer> tracer;
+};
+
+/**
+ * Converts a tracing request (cmp. StressLineTracingRequester::requestNewData) to the settings of the built-in tracer.
+ * Entries with the value "default" or missing entries keep the default settings.
+ */
+void parseStressLineTracingRequest(const Json::Value& request, StressLineTracingSettings& settings);
+
+#endif //LINEVIS_STRESSLINETRACINGLOCALWORKER_HPP
@@ -0,0 +1,481 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <fstream>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <cmath>
+
+#ifdef USE_ZEROMQ
+#include <zmq.hpp>
+#endif
+#include <boost/filesystem.hpp>
+
+#include <Utils/File/Logfile.hpp>
+
+#include "Loaders/StressTrajectoriesDatLoader.hpp"
+#include "StressLineTracingMockServer.hpp"
+
+StressLineTracingMockServer::StressLineTracingMockServer(
+        void* context, const StressLineTracingMockServerSettings& settings)
+        : context(context), isFinished(false), settings(settings) {
+    builder["commentStyle"] = "None";
+    builder["indentation"] = "";
+    serverThread = std::thread(&StressLineTracingMockServer::mainLoop, this);
+}
+
+StressLineTracingMockServer::~StressLineTracingMockServer() {
+    join();
+}
+
+void StressLineTracingMockServer::join() {
+    if (serverThread.joinable()) {
+        isFinished = true;
+        serverThread.join();
+    }
+}
+
+void StressLineTracingMockServer::setSettings(const StressLineTracingMockServerSettings& newSettings) {
+    std::lock_guard<std::mutex> lockSettings(settingsMutex);
+    const int port = settings.port;
+    settings = newSettings;
+    settings.port = port;
+}
+
+void generateSyntheticStressLines(
+        const std::vector<int>& psIndices, size_t numLinesPerSet, size_t numPointsPerLine, uint32_t seed,
+        StressTrajectoriesMemoryData& data) {
+    std::default_random_engine randomEngine(seed);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    data = StressTrajectoriesMemoryData();
+    data.meshType = MeshType::CARTESIAN;
+    for (int psIdx : psIndices) {
+        data.loadedPsIndices.push_back(psIdx);
+        data.trajectoriesPs.emplace_back(numLinesPerSet);
+        data.stressTrajectoriesDataPs.emplace_back(numLinesPerSet);
+        data.bandPointsUnsmoothedListLeftPs.emplace_back(numLinesPerSet);
+        data.bandPointsUnsmoothedListRightPs.emplace_back(numLinesPerSet);
+        data.bandPointsSmoothedListLeftPs.emplace_back(numLinesPerSet);
+        data.bandPointsSmoothedListRightPs.emplace_back(numLinesPerSet);
+        for (size_t lineIdx = 0; lineIdx < numLinesPerSet; lineIdx++) {
+            Trajectory& trajectory = data.trajectoriesPs.back().at(lineIdx);
+            StressTrajectoryData& stressTrajectoryData = data.stressTrajectoriesDataPs.back().at(lineIdx);
+            trajectory.positions.reserve(numPointsPerLine);
+            trajectory.attributes.resize(9);
+            glm::vec3 position(distribution(randomEngine), distribution(randomEngine), distribution(randomEngine));
+            for (size_t pointIdx = 0; pointIdx < numPointsPerLine; pointIdx++) {
+                position += 0.01f * glm::vec3(
+                        distribution(randomEngine), distribution(randomEngine), distribution(randomEngine));
+                trajectory.positions.push_back(position);
+                for (int attributeIdx = 0; attributeIdx < 9; attributeIdx++) {
+                    trajectory.attributes.at(attributeIdx).push_back(100.0f * distribution(randomEngine));
+                }
+                trajectory.attributes.at(1).back() = std::abs(trajectory.attributes.at(0).back());
+                glm::vec3 offset(0.005f, 0.0f, 0.0f);
+                data.bandPointsUnsmoothedListLeftPs.back().at(lineIdx).push_back(position - offset);
+                data.bandPointsUnsmoothedListRightPs.back().at(lineIdx).push_back(position + offset);
+                data.bandPointsSmoothedListLeftPs.back().at(lineIdx).push_back(position - offset);
+                data.bandPointsSmoothedListRightPs.back().at(lineIdx).push_back(position + offset);
+            }
+            for (int hierarchyIdx = 0; hierarchyIdx < 4; hierarchyIdx++) {
+                stressTrajectoryData.hierarchyLevels.push_back(0.5f * distribution(randomEngine) + 0.5f);
+            }
+            stressTrajectoryData.appearanceOrder = int(lineIdx);
+            stressTrajectoryData.seedPosition = trajectory.positions.front();
+        }
+    }
+}
+
+static void writeFloatLine(std::ofstream& file, const float* values, size_t numValues) {
+    for (size_t i = 0; i < numValues; i++) {
+        if (i != 0) {
+            file << ' ';
+        }
+        file << values[i];
+    }
+    file << '\n';
+}
+
+void writeStressTrajectoriesToDat_v3(const std::string& filename, const StressTrajectoriesMemoryData& data) {
+    const char* const PS_NAMES[] = { "#Major", "#Medium", "#Minor" };
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        sgl::Logfile::get()->writeError(
+                "Error in writeStressTrajectoriesToDat_v3: Couldn't open the file \"" + filename + "\".");
+        return;
+    }
+    file.precision(9);
+    const bool hasBands = !data.bandPointsUnsmoothedListLeftPs.empty();
+    std::vector<float> values;
+    for (size_t lineSetIdx = 0; lineSetIdx < data.trajectoriesPs.size(); lineSetIdx++) {
+        const Trajectories& trajectories = data.trajectoriesPs.at(lineSetIdx);
+        file << PS_NAMES[data.loadedPsIndices.at(lineSetIdx)] << ' ' << trajectories.size() << '\n';
+        for (size_t lineIdx = 0; lineIdx < trajectories.size(); lineIdx++) {
+            const Trajectory& trajectory = trajectories.at(lineIdx);
+            const StressTrajectoryData& stressTrajectoryData = data.stressTrajectoriesDataPs.at(lineSetIdx).at(lineIdx);
+            const size_t lineLength = trajectory.positions.size();
+            file << lineLength;
+            for (float hierarchyLevel : stressTrajectoryData.hierarchyLevels) {
+                file << ' ' << hierarchyLevel;
+            }
+            file << ' ' << (stressTrajectoryData.appearanceOrder + 1);
+            file << ' ' << stressTrajectoryData.seedPosition.x << ' ' << stressTrajectoryData.seedPosition.y
+                    << ' ' << stressTrajectoryData.seedPosition.z << '\n';
+            writeFloatLine(file, &trajectory.positions.front().x, lineLength * 3);
+
+            // The left and right band points are stored interleaved (the line points are used if no bands exist).
+            const std::vector<std::vector<std::vector<glm::vec3>>>* bandPointsListPs[] = {
+                    &data.bandPointsUnsmoothedListLeftPs, &data.bandPointsUnsmoothedListRightPs,
+                    &data.bandPointsSmoothedListLeftPs, &data.bandPointsSmoothedListRightPs };
+            for (int bandIdx = 0; bandIdx < 4; bandIdx += 2) {
+                const std::vector<glm::vec3>& bandPointsLeft = hasBands
+                        ? bandPointsListPs[bandIdx]->at(lineSetIdx).at(lineIdx) : trajectory.positions;
+                const std::vector<glm::vec3>& bandPointsRight = hasBands
+                        ? bandPointsListPs[bandIdx + 1]->at(lineSetIdx).at(lineIdx) : trajectory.positions;
+                values.clear();
+                for (size_t pointIdx = 0; pointIdx < lineLength; pointIdx++) {
+                    const glm::vec3& pointLeft = bandPointsLeft.at(pointIdx);
+                    const glm::vec3& pointRight = bandPointsRight.at(pointIdx);
+                    values.insert(values.end(), { pointLeft.x, pointLeft.y, pointLeft.z });
+                    values.insert(values.end(), { pointRight.x, pointRight.y, pointRight.z });
+                }
+                writeFloatLine(file, values.data(), values.size());
+            }
+
+            for (size_t attributeIdx = 0; attributeIdx < trajectory.attributes.size(); attributeIdx++) {
+                // The principal stress magnitude is computed by the loader.
+                if (attributeIdx != 1) {
+                    writeFloatLine(file, trajectory.attributes.at(attributeIdx).data(), lineLength);
+                }
+            }
+        }
+    }
+}
+
+#ifdef USE_ZEROMQ
+
+static double getElapsedMilliseconds(const std::chrono::steady_clock::time_point& start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void freeFrame(void* data, void* hint) {
+    delete static_cast<std::string*>(hint);
+}
+
+/// Sends a message part without copying its data. The ownership of the frame is passed to ZeroMQ.
+static void sendFrame(void* socket, std::string* frame, bool hasMore) {
+    zmq_msg_t message;
+    zmq_msg_init_data(&message, &(*frame)[0], frame->size(), freeFrame, frame);
+    if (zmq_msg_send(&message, socket, hasMore ? ZMQ_SNDMORE : 0) < 0) {
+        zmq_msg_close(&message);
+    }
+}
+
+template<class T>
+static void appendRange(std::vector<T>& dst, const std::vector<T>& src, size_t begin, size_t end) {
+    dst.insert(dst.end(), src.begin() + ptrdiff_t(begin), src.begin() + ptrdiff_t(end));
+}
+
+/// Copies the lines [batchIdx * n / numBatches, (batchIdx + 1) * n / numBatches) of each line set into batch.
+static void extractBatch(
+        const StressTrajectoriesMemoryData& data, int batchIdx, int numBatches, StressTrajectoriesMemoryData& batch) {
+    const bool hasBands = !data.bandPointsUnsmoothedListLeftPs.empty();
+    batch = StressTrajectoriesMemoryData();
+    batch.meshType = data.meshType;
+    batch.loadedPsIndices = data.loadedPsIndices;
+    for (size_t lineSetIdx = 0; lineSetIdx < data.trajectoriesPs.size(); lineSetIdx++) {
+        const size_t numLines = data.trajectoriesPs.at(lineSetIdx).size();
+        const size_t begin = size_t(batchIdx) * numLines / size_t(numBatches);
+        const size_t end = size_t(batchIdx + 1) * numLines / size_t(numBatches);
+        batch.trajectoriesPs.emplace_back();
+        appendRange(batch.trajectoriesPs.back(), data.trajectoriesPs.at(lineSetIdx), begin, end);
+        batch.stressTrajectoriesDataPs.emplace_back();
+        appendRange(batch.stressTrajectoriesDataPs.back(), data.stressTrajectoriesDataPs.at(lineSetIdx), begin, end);
+        if (hasBands) {
+            batch.bandPointsUnsmoothedListLeftPs.emplace_back();
+            appendRange(
+                    batch.bandPointsUnsmoothedListLeftPs.back(), data.bandPointsUnsmoothedListLeftPs.at(lineSetIdx),
+                    begin, end);
+            batch.bandPointsUnsmoothedListRightPs.emplace_back();
+            appendRange(
+                    batch.bandPointsUnsmoothedListRightPs.back(), data.bandPointsUnsmoothedListRightPs.at(lineSetIdx),
+                    begin, end);
+            batch.bandPointsSmoothedListLeftPs.emplace_back();
+            appendRange(
+                    batch.bandPointsSmoothedListLeftPs.back(), data.bandPointsSmoothedListLeftPs.at(lineSetIdx),
+                    begin, end);
+            batch.bandPointsSmoothedListRightPs.emplace_back();
+            appendRange(
+                    batch.bandPointsSmoothedListRightPs.back(), data.bandPointsSmoothedListRightPs.at(lineSetIdx),
+                    begin, end);
+        }
+    }
+    // The outline of the simulation mesh is sent with the last batch.
+    if (batchIdx == numBatches - 1) {
+        batch.simulationMeshOutlineTriangleIndices = data.simulationMeshOutlineTriangleIndices;
+        batch.simulationMeshOutlineVertexPositions = data.simulationMeshOutlineVertexPositions;
+    }
+}
+
+void StressLineTracingMockServer::mainLoop() {
+    int port;
+    {
+        std::lock_guard<std::mutex> lockSettings(settingsMutex);
+        port = settings.port;
+    }
+    void* socket = zmq_socket(context, ZMQ_ROUTER);
+    int lingerTime = 0;
+    zmq_setsockopt(socket, ZMQ_LINGER, &lingerTime, sizeof(lingerTime));
+    std::string endpoint = "tcp://127.0.0.1:" + std::to_string(port);
+    if (zmq_bind(socket, endpoint.c_str()) != 0) {
+        sgl::Logfile::get()->writeError(
+                "Error in StressLineTracingMockServer::mainLoop: Couldn't bind to \"" + endpoint + "\": "
+                + zmq_strerror(zmq_errno()));
+        zmq_close(socket);
+        return;
+    }
+
+    MockRequest pendingRequest;
+    bool hasPendingRequest = false;
+    while (!isFinished) {
+        if (!hasPendingRequest) {
+            zmq_pollitem_t pollItem = { socket, 0, ZMQ_POLLIN, 0 };
+            if (zmq_poll(&pollItem, 1, 100) <= 0 || (pollItem.revents & ZMQ_POLLIN) == 0) {
+                continue;
+            }
+            receiveQueuedMessages(socket, pendingRequest, hasPendingRequest, 0);
+            continue;
+        }
+        MockRequest request = std::move(pendingRequest);
+        hasPendingRequest = false;
+        processRequest(socket, request, pendingRequest, hasPendingRequest);
+    }
+
+    zmq_close(socket);
+}
+
+bool StressLineTracingMockServer::receiveQueuedMessages(
+        void* socket, MockRequest& pendingRequest, bool& hasPendingRequest, uint64_t activeRequestId) {
+    Json::CharReaderBuilder readerBuilder;
+    std::unique_ptr<Json::CharReader> jsonCharReader(readerBuilder.newCharReader());
+    bool isCancelled = false;
+    while (true) {
+        // Message layout: [identity, (empty delimiter), payload].
+        std::vector<std::string> parts;
+        do {
+            zmq_msg_t part;
+            zmq_msg_init(&part);
+            if (zmq_msg_recv(&part, socket, parts.empty() ? ZMQ_DONTWAIT : 0) < 0) {
+                zmq_msg_close(&part);
+                return isCancelled;
+            }
+            parts.emplace_back(static_cast<const char*>(zmq_msg_data(&part)), zmq_msg_size(&part));
+            const bool hasMore = zmq_msg_more(&part) != 0;
+            zmq_msg_close(&part);
+            if (!hasMore) {
+                break;
+            }
+        } while (true);
+        if (parts.size() < 2) {
+            continue;
+        }
+
+        const std::string& payload = parts.back();
+        Json::Value message;
+        std::string errorString;
+        if (!jsonCharReader->parse(payload.c_str(), payload.c_str() + payload.size(), &message, &errorString)
+                || !message.isObject()) {
+            sgl::Logfile::get()->writeError(
+                    "Error in StressLineTracingMockServer::receiveQueuedMessages: Invalid request: " + errorString);
+            continue;
+        }
+
+        if (message.isMember("cancelRequestId")) {
+            uint64_t cancelRequestId = message["cancelRequestId"].asUInt64();
+            if (cancelRequestId == activeRequestId && activeRequestId != 0) {
+                isCancelled = true;
+            }
+            if (hasPendingRequest && pendingRequest.requestId == cancelRequestId) {
+                hasPendingRequest = false;
+            }
+            continue;
+        }
+
+        // Debouncing: Only the newest request is kept.
+        MockRequest request;
+        request.identity = parts.front();
+        request.hasDelimiter = parts.size() > 2;
+        request.requestId = message.get("requestId", 0).asUInt64();
+        request.request = std::move(message);
+        if (!hasPendingRequest || request.requestId >= pendingRequest.requestId) {
+            pendingRequest = std::move(request);
+            hasPendingRequest = true;
+        }
+    }
+}
+
+bool StressLineTracingMockServer::simulateTracing(
+        void* socket, int timeMs, const MockRequest& request, MockRequest& pendingRequest, bool& hasPendingRequest) {
+    auto startTime = std::chrono::steady_clock::now();
+    while (true) {
+        // Requests without an ID come from clients not supporting cancellation, so they are always answered.
+        if (request.requestId != 0) {
+            if (receiveQueuedMessages(socket, pendingRequest, hasPendingRequest, request.requestId)) {
+                return false;
+            }
+            if (hasPendingRequest && pendingRequest.requestId > request.requestId) {
+                return false;
+            }
+        }
+        double remainingTimeMs = double(timeMs) - getElapsedMilliseconds(startTime);
+        if (remainingTimeMs <= 0.0 || isFinished) {
+            return !isFinished;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(
+                int64_t(std::min(remainingTimeMs, 10.0) * 1000.0)));
+    }
+}
+
+void StressLineTracingMockServer::processRequest(
+        void* socket, const MockRequest& request, MockRequest& pendingRequest, bool& hasPendingRequest) {
+    StressLineTracingMockServerSettings currentSettings;
+    {
+        std::lock_guard<std::mutex> lockSettings(settingsMutex);
+        currentSettings = settings;
+    }
+    const bool binaryReply = request.request.get("binaryReply", false).asBool();
+    const bool streamReply = binaryReply && request.request.get("streamReply", false).asBool();
+    const int numBatches = streamReply ? std::max(currentSettings.numBatches, 1) : 1;
+
+    // The selected principal stress directions are passed as 1 (major), 2 (medium) and 3 (minor).
+    std::vector<int> psIndices;
+    for (const Json::Value& psIdx : request.request["selectedPrincipalStressField"]) {
+        if (psIdx.isInt() && psIdx.asInt() >= 1 && psIdx.asInt() <= 3) {
+            psIndices.push_back(psIdx.asInt() - 1);
+        }
+    }
+    if (psIndices.empty()) {
+        psIndices = { 0, 2 };
+    }
+
+    // The line density scales the number of lines relative to the default line density of 16.
+    size_t numLinesPerSet = size_t(std::max(currentSettings.numLinesPerSet, 1));
+    const Json::Value& lineDensCtrl = request.request["lineDensCtrl"];
+    if (lineDensCtrl.isNumeric()) {
+        numLinesPerSet = std::max(size_t(double(numLinesPerSet) * lineDensCtrl.asDouble() / 16.0), size_t(1));
+    }
+
+    // The same parameters always yield the same lines.
+    Json::Value parameters = request.request;
+    parameters.removeMember("requestId");
+    parameters.removeMember("binaryReply");
+    parameters.removeMember("streamReply");
+    const uint32_t seed = uint32_t(std::hash<std::string>()(Json::writeString(builder, parameters)));
+
+    const bool useRecordedData = !currentSettings.recordedFilenames.empty();
+    if (useRecordedData && binaryReply && loadedRecordedFilenames != currentSettings.recordedFilenames) {
+        StressTrajectoriesMemoryData& data = recordedData;
+        data = StressTrajectoriesMemoryData();
+        loadStressTrajectoriesFromDat_v3(
+                currentSettings.recordedFilenames, data.loadedPsIndices, data.meshType,
+                data.trajectoriesPs, data.stressTrajectoriesDataPs,
+                data.bandPointsUnsmoothedListLeftPs, data.bandPointsUnsmoothedListRightPs,
+                data.bandPointsSmoothedListLeftPs, data.bandPointsSmoothedListRightPs,
+                data.simulationMeshOutlineTriangleIndices, data.simulationMeshOutlineVertexPositions);
+        loadedRecordedFilenames = currentSettings.recordedFilenames;
+    }
+
+    StressTrajectoriesMemoryData syntheticData;
+    for (int batchIdx = 0; batchIdx < numBatches; batchIdx++) {
+        const int batchTimeMs = (currentSettings.tracingTimeMs * (batchIdx + 1)) / numBatches
+                - (currentSettings.tracingTimeMs * batchIdx) / numBatches;
+        auto tracingStartTime = std::chrono::steady_clock::now();
+        if (!simulateTracing(socket, batchTimeMs, request, pendingRequest, hasPendingRequest)) {
+            return;
+        }
+        if (batchIdx == 0 && !useRecordedData) {
+            generateSyntheticStressLines(
+                    psIndices, numLinesPerSet, size_t(std::max(currentSettings.numPointsPerLine, 2)), seed,
+                    syntheticData);
+        }
+        const StressTrajectoriesMemoryData& data = useRecordedData ? recordedData : syntheticData;
+        const double tracingMs = getElapsedMilliseconds(tracingStartTime);
+
+        auto serializationStartTime = std::chrono::steady_clock::now();
+        Json::Value header;
+        std::vector<std::string> frames;
+        if (binaryReply) {
+            if (numBatches == 1) {
+                encodeStressTrajectoriesBinary(data, header, frames);
+            } else {
+                StressTrajectoriesMemoryData batch;
+                extractBatch(data, batchIdx, numBatches, batch);
+                encodeStressTrajectoriesBinary(batch, header, frames);
+            }
+            if (batchIdx != numBatches - 1) {
+                header["partial"] = true;
+            }
+        } else if (useRecordedData) {
+            header["fileName"] = currentSettings.recordedFilenames.front();
+        } else {
+            std::string filename = (boost::filesystem::temp_directory_path() / (
+                    "LineVis_mock_tracer_" + std::to_string(currentSettings.port) + ".dat")).string();
+            writeStressTrajectoriesToDat_v3(filename, data);
+            header["fileName"] = filename;
+        }
+        header["serverTimings"]["tracingMs"] = tracingMs;
+        header["serverTimings"]["serializationMs"] = getElapsedMilliseconds(serializationStartTime);
+        sendReply(socket, request, header, frames);
+    }
+}
+
+void StressLineTracingMockServer::sendReply(
+        void* socket, const MockRequest& request, Json::Value& header, std::vector<std::string>& frames) {
+    if (request.requestId != 0) {
+        header["requestId"] = Json::UInt64(request.requestId);
+    }
+    zmq_send(socket, request.identity.data(), request.identity.size(), ZMQ_SNDMORE);
+    if (request.hasDelimiter) {
+        zmq_send(socket, "", 0, ZMQ_SNDMORE);
+    }
+    sendFrame(socket, new std::string(Json::writeString(builder, header)), !frames.empty());
+    for (size_t frameIdx = 0; frameIdx < frames.size(); frameIdx++) {
+        sendFrame(socket, new std::string(std::move(frames.at(frameIdx))), frameIdx + 1 != frames.size());
+    }
+}
+
+#else
+
+void StressLineTracingMockServer::mainLoop() {
+    sgl::Logfile::get()->writeError(
+            "Error in StressLineTracingMockServer::mainLoop: The program was built without ZeroMQ support.");
+}
+
+#endif
@@ -0,0 +1,133 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LINEVIS_STRESSLINETRACINGMOCKSERVER_HPP
+#define LINEVIS_STRESSLINETRACINGMOCKSERVER_HPP
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+#include "Loaders/StressTrajectoriesBinaryLoader.hpp"
+
+struct StressLineTracingMockServerSettings {
+    int port = 17384;
+    int numLinesPerSet = 500; ///< Number of lines per principal stress direction for the default line density.
+    int numPointsPerLine = 200;
+    int tracingTimeMs = 500; ///< Simulated tracing time per request.
+    int numBatches = 4; ///< Number of partial results sent for requests with "streamReply".
+    /// Optional pre-recorded .dat (version 3) files that are returned instead of synthetic lines.
+    std::vector<std::string> recordedFilenames;
+};
+
+/**
+ * A local stand-in for the stress line tracing service that speaks the same ZeroMQ protocol as the tracer
+ * (cmp. StressLineTracingRequesterSocket). It uses a ROUTER socket and supports binary and streamed replies, request
+ * IDs, cancellation and debouncing of queued requests. Instead of tracing lines, it returns synthetic or pre-recorded
+ * line sets after a configurable delay. This way, the tracing pipeline can be tested and profiled offline.
+ * All replies contain the entry "serverTimings" with the simulated tracing time and the time needed for serialization
+ * (in milliseconds).
+ */
+class StressLineTracingMockServer {
+public:
+    /**
+     * @param context The ZeroMQ context.
+     * @param settings The settings of the server. The port can't be changed after the server was started.
+     */
+    StressLineTracingMockServer(void* context, const StressLineTracingMockServerSettings& settings);
+    ~StressLineTracingMockServer();
+
+    /// Stops the server thread.
+    void join();
+
+    /// Changes the line set size, delay and batch settings used for subsequent requests.
+    void setSettings(const StressLineTracingMockServerSettings& settings);
+
+private:
+    struct MockRequest {
+        std::string identity;
+        bool hasDelimiter = false;
+        Json::Value request;
+        uint64_t requestId = 0;
+    };
+
+    void mainLoop();
+    /**
+     * Receives all queued messages without blocking. Only the newest request is kept (debouncing).
+     * @param pendingRequest The newest queued request.
+     * @param hasPendingRequest Whether a request is queued.
+     * @param activeRequestId The ID of the request currently processed.
+     * @return Whether the request currently processed was cancelled.
+     */
+    bool receiveQueuedMessages(
+            void* socket, MockRequest& pendingRequest, bool& hasPendingRequest, uint64_t activeRequestId);
+    /**
+     * Simulates the tracing of the lines and sends the reply. The processing is aborted early if the request is
+     * cancelled or a newer request arrives.
+     */
+    void processRequest(void* socket, const MockRequest& request, MockRequest& pendingRequest, bool& hasPendingRequest);
+    /// Sleeps for the passed time while checking for new requests. Returns false if the request should be aborted.
+    bool simulateTracing(
+            void* socket, int timeMs, const MockRequest& request, MockRequest& pendingRequest, bool& hasPendingRequest);
+    void sendReply(void* socket, const MockRequest& request, Json::Value& header, std::vector<std::string>& frames);
+
+    void* context;
+    std::thread serverThread;
+    std::atomic<bool> isFinished;
+    std::mutex settingsMutex;
+    StressLineTracingMockServerSettings settings;
+    Json::StreamWriterBuilder builder;
+
+    // Pre-recorded data (loaded on first use).
+    std::vector<std::string> loadedRecordedFilenames;
+    StressTrajectoriesMemoryData recordedData;
+};
+
+/**
+ * Creates random walk principal stress lines with band points, attributes and hierarchy levels like the ones created
+ * by the stress line tracer.
+ * @param psIndices The principal stress directions to create lines for (0 = major, 1 = medium, 2 = minor).
+ * @param numLinesPerSet The number of lines per principal stress direction.
+ * @param numPointsPerLine The number of points per line.
+ * @param seed The seed of the random number generator.
+ * @param data The created lines (output).
+ */
+void generateSyntheticStressLines(
+        const std::vector<int>& psIndices, size_t numLinesPerSet, size_t numPointsPerLine, uint32_t seed,
+        StressTrajectoriesMemoryData& data);
+
+/**
+ * Writes principal stress lines to a file in the .dat version 3 format (cmp. loadStressTrajectoriesFromDat_v3).
+ * @param filename The name of the file to write.
+ * @param data The lines to write.
+ */
+void writeStressTrajectoriesToDat_v3(const std::string& filename, const StressTrajectoriesMemoryData& data);
+
+#endif //LINEVIS_STRESSLINETRACINGMOCKSERVER_HPP
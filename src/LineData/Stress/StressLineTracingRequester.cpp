@@ -38,10 +38,23 @@
 #include <boost/filesystem.hpp>
 
 #include "Loaders/DataSetList.hpp"
+#include "Loaders/StressTrajectoriesBinaryLoader.hpp"
 #include "StressLineTracingRequester.hpp"
 
 StressLineTracingRequester::StressLineTracingRequester(void* context) : context(context), worker(context) {
     loadMeshList();
+    updateResultCacheSettings();
+}
+
+StressLineTracingRequester::~StressLineTracingRequester() {
+    if (localWorker) {
+        localWorker->join();
+        localWorker = {};
+    }
+    if (mockServer) {
+        mockServer->join();
+        mockServer = {};
+    }
 }
 
 void StressLineTracingRequester::loadMeshList() {
@@ -111,9 +124,66 @@ void StressLineTracingRequester::renderGui() {
                     "Tracing Algorithm", (int*)&tracingAlgorithm, TRACING_ALGORITHM_NAMES,
                     IM_ARRAYSIZE(TRACING_ALGORITHM_NAMES));
             changed |= ImGui::SliderInt("Max Angle Deviation", &maxAngleDeviation, 1, 20);
-            changed |= ImGui::Checkbox("Merge Close PSLs", &mergingOpt);
-            changed |= ImGui::Checkbox("Snap Close PSLs", &snappingOpt);
+            if (!useBuiltInTracer) {
+                changed |= ImGui::Checkbox("Merge Close PSLs", &mergingOpt);
+                changed |= ImGui::Checkbox("Snap Close PSLs", &snappingOpt);
+            }
             changed |= ImGui::SliderFloat3("Merging Thresholds", &multiMergingThresholds.x, 1, 5);
+            changed |= ImGui::Checkbox("Binary Transfer", &useBinaryTransfer);
+            if (useBinaryTransfer) {
+                ImGui::SameLine();
+                changed |= ImGui::Checkbox("Progressive Results", &useProgressiveResults);
+            }
+            if (ImGui::Checkbox("Built-in CPU Tracer", &useBuiltInTracer)) {
+                if (useBuiltInTracer) {
+                    localWorker = std::unique_ptr<StressLineTracingLocalWorker>(new StressLineTracingLocalWorker);
+                } else {
+                    localWorker->join();
+                    localWorker = {};
+                }
+                changed = true;
+            }
+            if (!useBuiltInTracer && ImGui::Checkbox("Local Mock Tracer", &useMockServer)) {
+                if (useMockServer) {
+                    mockServer = std::unique_ptr<StressLineTracingMockServer>(
+                            new StressLineTracingMockServer(context, mockServerSettings));
+                } else {
+                    mockServer->join();
+                    mockServer = {};
+                }
+                changed = true;
+            }
+            if (useMockServer && !useBuiltInTracer) {
+                bool mockSettingsChanged = false;
+                mockSettingsChanged |= ImGui::SliderInt("Mock #Lines", &mockServerSettings.numLinesPerSet, 1, 10000);
+                mockSettingsChanged |= ImGui::SliderInt(
+                        "Mock #Points/Line", &mockServerSettings.numPointsPerLine, 2, 1000);
+                mockSettingsChanged |= ImGui::SliderInt("Mock Delay (ms)", &mockServerSettings.tracingTimeMs, 0, 5000);
+                mockSettingsChanged |= ImGui::SliderInt("Mock #Batches", &mockServerSettings.numBatches, 1, 16);
+                if (mockSettingsChanged) {
+                    mockServer->setSettings(mockServerSettings);
+                    changed = true;
+                }
+            }
+
+            bool cacheSettingsChanged = false;
+            cacheSettingsChanged |= ImGui::Checkbox("Result Cache", &useResultCache);
+            if (useResultCache) {
+                ImGui::SameLine();
+                cacheSettingsChanged |= ImGui::Checkbox("Disk Cache", &useDiskResultCache);
+                ImGui::SameLine();
+                if (ImGui::Button("Clear Cache")) {
+                    resultCache.clear();
+                }
+                cacheSettingsChanged |= ImGui::SliderInt("Cache Size (MiB)", &maxResultCacheSizeMiB, 64, 16384);
+                if (useDiskResultCache) {
+                    cacheSettingsChanged |= ImGui::SliderInt(
+                            "Disk Cache Size (MiB)", &maxDiskResultCacheSizeMiB, 64, 65536);
+                }
+            }
+            if (cacheSettingsChanged) {
+                updateResultCacheSettings();
+            }
         }
 
         if (changed) {
@@ -124,7 +194,8 @@ void StressLineTracingRequester::renderGui() {
 }
 
 void StressLineTracingRequester::requestNewData() {
-    if (meshFilename.empty()) {
+    // Only the mock tracer works without a simulation mesh.
+    if (meshFilename.empty() && (useBuiltInTracer || !useMockServer)) {
         return;
     }
 
@@ -156,26 +227,168 @@ void StressLineTracingRequester::requestNewData() {
     if (traceMinorPS) {
         request["selectedPrincipalStressField"].append(3);
     }
-    request["mergingOpt"] = mergingOpt;
-    request["snappingOpt"] = snappingOpt;
+    if (!useBuiltInTracer) {
+        // Not supported by the built-in tracer, so they must not be part of the result cache key either.
+        request["mergingOpt"] = mergingOpt;
+        request["snappingOpt"] = snappingOpt;
+    }
     request["maxAngleDevi"] = maxAngleDeviation;
     for (int i = 0; i < 3; i++) {
         request["multiMergingThresholds"].append(multiMergingThresholds[i]);
     }
     request["traceAlgorithm"] = TRACING_ALGORITHM_ABBREVIATIONS[int(tracingAlgorithm)];
+    if (useBinaryTransfer) {
+        // The tracer may send the lines as binary message parts instead of writing a .dat file.
+        request["binaryReply"] = true;
+        if (useProgressiveResults) {
+            // Batches of finished lines may be sent (and shown) before all lines were traced.
+            request["streamReply"] = true;
+        }
+    }
     std::cout << request << std::endl;
-    worker.queueRequestJson(request);
+
+    // Batches still arriving for the previous request must not be appended to the reply to this one.
+    isReceivingStreamedReply = false;
+    streamedReplyBatches.clear();
+
+    // Parameter sets that were already traced are loaded from the result cache. The key is also computed if the cache
+    // is disabled, as it may be enabled before the reply arrives.
+    std::string canonicalRequest;
+    std::string cacheKey = StressLineTracingResultCache::computeCacheKey(
+            getCacheMeshIdentity(), request, canonicalRequest);
+    if (useResultCache && resultCache.get(cacheKey, canonicalRequest, cachedReply, cachedReplyData)) {
+        // Replies to older requests still processed by the tracer are dropped.
+        hasCachedReply = true;
+        expectedRequestId = 0;
+        resultCache.setPendingRequest(0, "", "");
+        return;
+    }
+    hasCachedReply = false;
+    if (useBuiltInTracer) {
+        expectedRequestId = localWorker->queueRequestJson(request);
+    } else {
+        expectedRequestId = worker.queueRequestJson(request);
+    }
+    resultCache.setPendingRequest(expectedRequestId, cacheKey, canonicalRequest);
+}
+
+void StressLineTracingRequester::updateStreamedReply(
+        const Json::Value& reply, const std::shared_ptr<const StressTrajectoriesMemoryData>& replyData) {
+    // Tracers not sending request IDs only work on one request at a time.
+    const uint64_t replyRequestId = reply.get("requestId", Json::UInt64(0)).asUInt64();
+    const bool isPartialReply = replyData && reply.get("partial", false).asBool();
+    lastReplyContinuesStream =
+            replyData && isReceivingStreamedReply && replyRequestId == streamedReplyRequestId;
+    if (!lastReplyContinuesStream) {
+        streamedReplyBatches.clear();
+    }
+    isReceivingStreamedReply = isPartialReply;
+    streamedReplyRequestId = replyRequestId;
+
+    // The batches only contain the new lines, so they are merged once all of them were received.
+    if (isPartialReply) {
+        streamedReplyBatches.push_back(replyData);
+    } else if (useResultCache && lastReplyContinuesStream) {
+        auto mergedReplyData = std::make_shared<StressTrajectoriesMemoryData>();
+        streamedReplyBatches.push_back(replyData);
+        for (const std::shared_ptr<const StressTrajectoriesMemoryData>& batchPtr : streamedReplyBatches) {
+            StressTrajectoriesMemoryData batch = *batchPtr;
+            appendStressTrajectoriesMemoryData(*mergedReplyData, batch);
+        }
+        resultCache.putReply(reply, mergedReplyData);
+    } else if (useResultCache) {
+        // Only the reply to the request the pending cache key belongs to is stored.
+        resultCache.putReply(reply, replyData);
+    }
+    if (!isPartialReply) {
+        streamedReplyBatches.clear();
+    }
+}
+
+std::string StressLineTracingRequester::getCacheMeshIdentity() {
+    const std::string lineDataSetsDirectory = sgl::AppSettings::get()->getDataDirectory() + "LineDataSets/";
+    if (useBuiltInTracer) {
+        // The built-in tracer doesn't produce the same lines as the tracing service.
+        return "builtin;" + StressLineTracingResultCache::getMeshIdentity(lineDataSetsDirectory + meshFilename);
+    }
+    if (useMockServer) {
+        // The lines returned by the mock tracer depend on its settings.
+        std::string meshIdentity =
+                "mock;" + std::to_string(mockServerSettings.numLinesPerSet) + ";"
+                + std::to_string(mockServerSettings.numPointsPerLine);
+        for (const std::string& recordedFilename : mockServerSettings.recordedFilenames) {
+            meshIdentity += ";" + StressLineTracingResultCache::getMeshIdentity(recordedFilename);
+        }
+        return meshIdentity;
+    }
+    return StressLineTracingResultCache::getMeshIdentity(lineDataSetsDirectory + meshFilename);
+}
+
+void StressLineTracingRequester::updateResultCacheSettings() {
+    if (useResultCache && useDiskResultCache) {
+        resultCache.setDiskCacheDirectory(
+                sgl::AppSettings::get()->getDataDirectory() + "LineDataSets/TracingCache/");
+    } else {
+        resultCache.setDiskCacheDirectory("");
+    }
+    resultCache.setMaxMemorySize(size_t(maxResultCacheSizeMiB) << 20);
+    resultCache.setMaxDiskSize(uint64_t(maxDiskResultCacheSizeMiB) << 20);
+    if (!useResultCache) {
+        // Only the results in memory are freed. The disk cache is kept for when the cache is enabled again.
+        resultCache.clear();
+    }
 }
 
 bool StressLineTracingRequester::getHasNewData(DataSetInformation& dataSetInformation) {
     Json::Value reply;
-    if (worker.getReplyJson(reply)) {
+    std::shared_ptr<const StressTrajectoriesMemoryData> replyData;
+    StressLineTracingReplyTimings replyTimings;
+    bool hasReply = false;
+    if (hasCachedReply) {
+        hasCachedReply = false;
+        hasReply = true;
+        reply = cachedReply;
+        replyData = cachedReplyData;
+        cachedReply = Json::Value();
+        cachedReplyData = {};
+        lastReplyLatencyMs = 0.0;
+        lastReplyContinuesStream = false;
+    } else {
+        bool isLocalReply = localWorker && localWorker->getReplyJson(reply, replyData, &replyTimings);
+        if (isLocalReply || worker.getReplyJson(reply, replyData, &replyTimings)) {
+            // Tracers not supporting request IDs send no ID. In this case, only replies to sent requests are expected.
+            // Replies of the tracer not selected anymore are dropped, as the request IDs of both tracers may overlap.
+            hasReply = isLocalReply == useBuiltInTracer && (reply.isMember("requestId")
+                    ? reply["requestId"].asUInt64() == expectedRequestId : expectedRequestId != 0);
+            lastReplyLatencyMs = replyTimings.roundTripMs + replyTimings.decodingMs;
+            if (hasReply) {
+                updateStreamedReply(reply, replyData);
+            }
+        }
+    }
+
+    if (hasReply) {
+        if (reply.isMember("serverTimings")) {
+            // Everything not spent on the server was spent on the transport of the request and the reply.
+            const double tracingMs = reply["serverTimings"].get("tracingMs", 0.0).asDouble();
+            const double serializationMs = reply["serverTimings"].get("serializationMs", 0.0).asDouble();
+            sgl::Logfile::get()->writeInfo(
+                    "Stress line tracing reply: tracing " + std::to_string(tracingMs) + "ms, serialization "
+                    + std::to_string(serializationMs) + "ms, transport "
+                    + std::to_string(replyTimings.roundTripMs - tracingMs - serializationMs) + "ms, decoding "
+                    + std::to_string(replyTimings.decodingMs) + "ms");
+        }
+
         dataSetInformation = DataSetInformation();
         dataSetInformation.type = DATA_SET_TYPE_STRESS_LINES;
         dataSetInformation.hasCustomTransform = true;
         dataSetInformation.transformMatrix = parseTransformString("rotate(270°, 1, 0, 0)");
         dataSetInformation.version = 3;
-        dataSetInformation.meshFilename = meshFilename;
+        // The mesh is needed again for probing the stress tensor (@see LineDataStress::probeStressTensor).
+        if (!meshFilename.empty()) {
+            dataSetInformation.meshFilename =
+                    sgl::AppSettings::get()->getDataDirectory() + "LineDataSets/" + meshFilename;
+        }
 
         std::string meshName;
         if (selectedMeshIndex == 0) {
@@ -185,8 +398,12 @@ bool StressLineTracingRequester::getHasNewData(DataSetInformation& dataSetInform
         }
         dataSetInformation.name = meshName;
 
+        dataSetInformation.stressTrajectoriesMemoryData = replyData;
         Json::Value filenames = reply["fileName"];
-        if (filenames.isArray()) {
+        if (replyData && filenames.isNull()) {
+            // No file was written by the tracer. The mesh file name is used for identifying the data set.
+            dataSetInformation.filenames.push_back(meshFilename.empty() ? "StressLineTracer" : meshFilename);
+        } else if (filenames.isArray()) {
             for (Json::Value::const_iterator filenameIt = filenames.begin();
                  filenameIt != filenames.end(); ++filenameIt) {
                 dataSetInformation.filenames.push_back(filenameIt->asString());
@@ -30,48 +30,43 @@
 #define LINEVIS_STRESSLINETRACINGREQUESTER_HPP
 
 #include "StressLineTracingRequesterSocket.hpp"
+#include "StressLineTracingMockServer.hpp"
+#include "StressLineTracingResultCache.hpp"
+#include "StressLineTracingLocalWorker.hpp"
 
 class DataSetInformation;
 
-enum class SeedStrategy {
-    VOLUME, SURFACE, LOADING_AREA, APPROX_TOPOLOGY
-};
-const char* const SEED_STRATEGY_NAMES[] = {
-        "Homogeneous Volume Seeding",
-        "Surface Seeding",
-        "Loading Areas Seeding",
-        "Fixed Area Seeding"
-};
-const char* const SEED_STRATEGY_ABBREVIATIONS[] = {
-        "Volume",
-        "Surface",
-        "LoadingArea",
-        "FixedArea"
-};
-
-enum class TracingAlgorithm {
-    EULER, RK2, RK4
-};
-const char* const TRACING_ALGORITHM_NAMES[] = {
-        "Euler", "Runge-Kutta 2nd Order", "Runge-Kutta 4th Order"
-};
-const char* const TRACING_ALGORITHM_ABBREVIATIONS[] = {
-        "Euler", "RK2", "RK4"
-};
-
 class StressLineTracingRequester {
 public:
     /**
      * @param context The ZeroMQ context.
      */
     StressLineTracingRequester(void* context);
+    ~StressLineTracingRequester();
     void renderGui();
     bool getHasNewData(DataSetInformation& dataSetInformation);
-    inline bool getIsProcessingRequest() const { return worker.getIsProcessingRequest(); }
+    inline bool getIsProcessingRequest() const {
+        return worker.getIsProcessingRequest() || (localWorker && localWorker->getIsProcessingRequest());
+    }
+    /// @return The time from sending the request until the lines of the last reply were decoded (in milliseconds).
+    inline double getLastReplyLatencyMs() const { return lastReplyLatencyMs; }
+    /// @return Whether more lines of the last reply are going to follow (i.e., it was a partial result).
+    inline bool getLastReplyIsPartial() const { return isReceivingStreamedReply; }
+    /**
+     * @return Whether the lines of the last reply continue the ones of the previous partial reply, i.e., need to be
+     * appended to the data set loaded from it instead of replacing it.
+     */
+    inline bool getLastReplyContinuesStream() const { return lastReplyContinuesStream; }
 
 private:
     void loadMeshList();
     void requestNewData();
+    /// @return The identity of the mesh (or of the mock tracer settings) used for the result cache keys.
+    std::string getCacheMeshIdentity();
+    void updateResultCacheSettings();
+    /// Keeps track of the batches of streamed replies (@see getLastReplyContinuesStream) and caches complete replies.
+    void updateStreamedReply(
+            const Json::Value& reply, const std::shared_ptr<const StressTrajectoriesMemoryData>& replyData);
 
     // ZeroMQ context
     void* context;
@@ -100,6 +95,37 @@ private:
     bool mergingOpt = true;
     bool snappingOpt = false;
     glm::vec3 multiMergingThresholds = glm::vec3(1, 1, 1);
+    // Receive the lines as binary message parts instead of loading a .dat file written by the tracer?
+    bool useBinaryTransfer = true;
+    // Show partial results while the tracer is still running (only supported for binary transfers).
+    bool useProgressiveResults = true;
+
+    // Local stand-in for the tracer for testing without the tracing service (cmp. StressLineTracingMockServer).
+    bool useMockServer = false;
+    StressLineTracingMockServerSettings mockServerSettings;
+    std::unique_ptr<StressLineTracingMockServer> mockServer;
+    double lastReplyLatencyMs = 0.0;
+
+    // Trace the lines with the built-in CPU tracer instead of sending the requests to the tracing service.
+    bool useBuiltInTracer = false;
+    std::unique_ptr<StressLineTracingLocalWorker> localWorker;
+
+    // Client-side cache of traced lines. Only binary replies are cached, as the tracer may overwrite .dat files.
+    bool useResultCache = true;
+    bool useDiskResultCache = false;
+    int maxResultCacheSizeMiB = 1024;
+    int maxDiskResultCacheSizeMiB = 4096;
+    StressLineTracingResultCache resultCache;
+    uint64_t expectedRequestId = 0; ///< ID of the newest request sent to the tracer (0 if a cached result was used).
+    bool hasCachedReply = false;
+    Json::Value cachedReply;
+    std::shared_ptr<const StressTrajectoriesMemoryData> cachedReplyData;
+
+    // Streamed replies (@see StressLineTracingRequesterSocket). The batches are merged for the result cache at the end.
+    bool isReceivingStreamedReply = false;
+    bool lastReplyContinuesStream = false;
+    uint64_t streamedReplyRequestId = 0;
+    std::vector<std::shared_ptr<const StressTrajectoriesMemoryData>> streamedReplyBatches;
 };
 
 #endif //LINEVIS_STRESSLINETRACINGREQUESTER_HPP
@@ -27,15 +27,18 @@
  */
 
 #include <iostream>
+#include <deque>
+#include <cstring>
 
 #ifdef USE_ZEROMQ
 #include <zmq.hpp>
 #endif
 
+#include "Loaders/StressTrajectoriesBinaryLoader.hpp"
 #include "StressLineTracingRequesterSocket.hpp"
 
 StressLineTracingRequesterSocket::StressLineTracingRequesterSocket(void* context, const std::string& address, int port)
-        : context(context), address(address), port(port) {
+        : context(context), address(address), port(port), isProcessingRequest(false) {
     jsonCharReader = readerBuilder.newCharReader();
 
     controllerSocketPub = zmq_socket(context, ZMQ_PUB);
@@ -75,6 +78,7 @@ void StressLineTracingRequesterSocket::join() {
                 std::lock_guard<std::mutex> lock(replyMutex);
                 this->hasReply = false;
                 this->replyMessage.clear();
+                this->replyData = nullptr;
             }
             hasReplyConditionVariable.notify_all();
         }
@@ -87,20 +91,35 @@ void StressLineTracingRequesterSocket::join() {
 
 void StressLineTracingRequesterSocket::queueRequestString(const std::string& requestMessage) {
     {
-        std::lock_guard<std::mutex> lock(replyMutex);
+        std::lock_guard<std::mutex> lock(requestMutex);
         this->requestMessage = requestMessage;
+        requestId = ++lastRequestId;
         hasRequest = true;
     }
     hasRequestConditionVariable.notify_all();
+    wakeRequesterThread();
 }
 
-void StressLineTracingRequesterSocket::queueRequestJson(const Json::Value& request) {
+uint64_t StressLineTracingRequesterSocket::queueRequestJson(const Json::Value& request) {
+    uint64_t newRequestId;
     {
-        std::lock_guard<std::mutex> lock(replyMutex);
-        requestMessage = Json::writeString(builder, request);
+        std::lock_guard<std::mutex> lock(requestMutex);
+        newRequestId = requestId = ++lastRequestId;
+        Json::Value requestWithId = request;
+        requestWithId["requestId"] = Json::UInt64(newRequestId);
+        requestMessage = Json::writeString(builder, requestWithId);
         hasRequest = true;
     }
     hasRequestConditionVariable.notify_all();
+    wakeRequesterThread();
+    return newRequestId;
+}
+
+void StressLineTracingRequesterSocket::wakeRequesterThread() {
+#ifdef USE_ZEROMQ
+    // The requester thread may be waiting for a reply to an older request in zmq_poll.
+    zmq_send(controllerSocketPub, "WAKE", 4, ZMQ_DONTWAIT);
+#endif
 }
 
 bool StressLineTracingRequesterSocket::getReplyString(std::string& replyMessage) {
@@ -115,17 +134,30 @@ bool StressLineTracingRequesterSocket::getReplyString(std::string& replyMessage)
         // Now, new requests can be worked on.
         this->hasReply = false;
         this->replyMessage.clear();
+        this->replyData = nullptr;
     }
     hasReplyConditionVariable.notify_all();
     return hasReply;
 }
 
 bool StressLineTracingRequesterSocket::getReplyJson(Json::Value& reply) {
+    std::shared_ptr<const StressTrajectoriesMemoryData> replyData;
+    return getReplyJson(reply, replyData);
+}
+
+bool StressLineTracingRequesterSocket::getReplyJson(
+        Json::Value& reply, std::shared_ptr<const StressTrajectoriesMemoryData>& replyData,
+        StressLineTracingReplyTimings* replyTimings) {
     bool hasReply;
     {
         std::lock_guard<std::mutex> lock(replyMutex);
         hasReply = this->hasReply;
+        replyData = nullptr;
         if (hasReply) {
+            replyData = this->replyData;
+            if (replyTimings) {
+                *replyTimings = this->replyTimings;
+            }
             std::string jsonErrorString;
             if (!jsonCharReader->parse(
                     replyMessage.c_str(), replyMessage.c_str() + replyMessage.size(),
@@ -138,15 +170,131 @@ bool StressLineTracingRequesterSocket::getReplyJson(Json::Value& reply) {
         // Now, new requests can be worked on.
         this->hasReply = false;
         this->replyMessage.clear();
+        this->replyData = nullptr;
     }
     hasReplyConditionVariable.notify_all();
     return hasReply;
 }
 
+#ifdef USE_ZEROMQ
+/**
+ * Sends a message preceded by the empty delimiter frame DEALER sockets need for being compatible with REP and ROUTER
+ * sockets.
+ */
+static int sendRequestMessage(void* socket, const std::string& message) {
+    int sentBytes = zmq_send(socket, "", 0, ZMQ_SNDMORE);
+    if (sentBytes >= 0) {
+        sentBytes = zmq_send(socket, message.data(), message.size(), 0);
+    }
+    return sentBytes;
+}
+
+bool StressLineTracingRequesterSocket::receiveReplyMessage(
+        void* socket, Json::CharReader* jsonCharReaderRequester, uint64_t currentRequestId,
+        const std::chrono::steady_clock::time_point& requestSentTime, bool& serverSupportsRequestIds,
+        bool& isFinalMessage) {
+    // Receive all parts of the message. A deque is used, as zmq_msg_t objects must not be moved in memory.
+    std::deque<zmq_msg_t> replyParts;
+    bool receivedAllParts = false;
+    while (true) {
+        replyParts.emplace_back();
+        zmq_msg_t& replyPart = replyParts.back();
+        int rc = zmq_msg_init(&replyPart);
+        assert(rc == 0);
+        const int receivedBytes = zmq_msg_recv(&replyPart, socket, 0);
+        if (receivedBytes < 0) {
+            break;
+        }
+        if (!zmq_msg_more(&replyPart)) {
+            receivedAllParts = true;
+            break;
+        }
+    }
+    auto receiveEndTime = std::chrono::steady_clock::now();
+
+    // Remove the empty delimiter frame.
+    if (receivedAllParts && replyParts.size() > 1 && zmq_msg_size(&replyParts.front()) == 0) {
+        zmq_msg_close(&replyParts.front());
+        replyParts.pop_front();
+    }
+    if (!receivedAllParts) {
+        for (zmq_msg_t& replyPart : replyParts) {
+            zmq_msg_close(&replyPart);
+        }
+        return false;
+    }
+
+    std::string replyString = std::string(
+            static_cast<const char*>(zmq_msg_data(&replyParts.front())), zmq_msg_size(&replyParts.front()));
+
+    Json::Value replyHeader;
+    std::string jsonErrorString;
+    const bool isJsonReply = jsonCharReaderRequester->parse(
+            replyString.c_str(), replyString.c_str() + replyString.size(), &replyHeader, &jsonErrorString)
+            && replyHeader.isObject();
+
+    // Drop replies to superseded requests. Tracers not sending request IDs only get one request at a time.
+    if (isJsonReply && replyHeader.isMember("requestId")) {
+        serverSupportsRequestIds = true;
+        if (replyHeader["requestId"].asUInt64() != currentRequestId) {
+            for (zmq_msg_t& replyPart : replyParts) {
+                zmq_msg_close(&replyPart);
+            }
+            isFinalMessage = false;
+            return true;
+        }
+    }
+
+    // Binary line data is decoded directly from the received message parts.
+    isFinalMessage = true;
+    std::shared_ptr<StressTrajectoriesMemoryData> replyLineData;
+    if (replyParts.size() > 1) {
+        if (isJsonReply && getIsStressTrajectoriesBinaryHeader(replyHeader)) {
+            std::vector<StressTrajectoriesBinaryFrame> frames;
+            frames.reserve(replyParts.size() - 1);
+            for (auto it = replyParts.begin() + 1; it != replyParts.end(); ++it) {
+                frames.push_back({ zmq_msg_data(&*it), zmq_msg_size(&*it) });
+            }
+            replyLineData = std::make_shared<StressTrajectoriesMemoryData>();
+            if (decodeStressTrajectoriesBinary(replyHeader, frames, *replyLineData)) {
+                // Partial results are shown while the tracer is still working on the remaining lines.
+                isFinalMessage = !replyHeader.get("partial", false).asBool();
+            } else {
+                replyLineData = nullptr;
+            }
+        }
+    }
+    for (zmq_msg_t& replyPart : replyParts) {
+        zmq_msg_close(&replyPart);
+    }
+
+    auto decodeEndTime = std::chrono::steady_clock::now();
+
+    std::lock_guard<std::mutex> replyLock(replyMutex);
+    // The batches of a streamed reply only contain the new lines, so batches not fetched yet must not be dropped.
+    if (hasReply && isReplyPartial && replyRequestId == currentRequestId && replyData) {
+        if (replyLineData) {
+            appendStressTrajectoriesMemoryData(*replyData, *replyLineData);
+        }
+        replyLineData = replyData;
+    }
+    hasReply = true;
+    replyMessage = replyString;
+    replyData = replyLineData;
+    replyRequestId = currentRequestId;
+    isReplyPartial = !isFinalMessage;
+    replyTimings.roundTripMs =
+            std::chrono::duration<double, std::milli>(receiveEndTime - requestSentTime).count();
+    replyTimings.decodingMs = std::chrono::duration<double, std::milli>(decodeEndTime - receiveEndTime).count();
+    isProcessingRequest = !isFinalMessage;
+    return true;
+}
+#endif
+
 void StressLineTracingRequesterSocket::mainLoop() {
 #ifdef USE_ZEROMQ
     std::string endpoint = std::string() + "tcp://" + address + ":" + std::to_string(port);
-    void* socket = zmq_socket(context, ZMQ_REQ);
+    void* socket = zmq_socket(context, ZMQ_DEALER);
     if (socket == nullptr) {
         throw std::runtime_error("Error in StressLineTracingRequesterSocket::mainLoop: socket == nullptr");
     }
@@ -162,65 +310,87 @@ void StressLineTracingRequesterSocket::mainLoop() {
     zmq_setsockopt(controllerSocketSub, ZMQ_SUBSCRIBE, "", 0);
     zmq_connect(controllerSocketSub, controllerAddress.c_str());
 
+    // The reader used by the main thread in getReplyJson must not be shared with the requester thread.
+    std::unique_ptr<Json::CharReader> jsonCharReaderRequester(readerBuilder.newCharReader());
+
     zmq_pollitem_t items [] = {
             { socket, 0, ZMQ_POLLIN, 0 },
             { controllerSocketSub, 0, ZMQ_POLLIN, 0 }
     };
 #endif
 
+    // State of the newest request sent to the tracer.
+    uint64_t currentRequestId = 0;
+    bool isWaitingForReply = false;
+    bool serverSupportsRequestIds = false;
+#ifdef USE_ZEROMQ
+    std::chrono::steady_clock::time_point requestSentTime;
+#endif
+
     while (true) {
         std::unique_lock<std::mutex> requestLock(requestMutex);
-        hasRequestConditionVariable.wait(requestLock, [this] { return hasRequest; });
+        if (!isWaitingForReply) {
+            hasRequestConditionVariable.wait(requestLock, [this] { return hasRequest; });
+        }
 
         if (programIsFinished) {
             break;
         }
 
-        if (hasRequest) {
+        // A new request is only sent while another one is outstanding if the tracer can cancel the old request.
+        if (hasRequest && (!isWaitingForReply || serverSupportsRequestIds)) {
 #ifdef USE_ZEROMQ
-            int sentBytes = zmq_send(socket, requestMessage.data(), requestMessage.size(), 0);
-            if (sentBytes < 0) {
+            if (isWaitingForReply) {
+                std::string cancelMessage = "{\"cancelRequestId\": " + std::to_string(currentRequestId) + "}";
+                sendRequestMessage(socket, cancelMessage);
+            }
+            if (sendRequestMessage(socket, requestMessage) < 0) {
                 if (zmq_errno() == ETERM) {
                     break;
                 }
                 continue;
             }
+            isWaitingForReply = true;
+            requestSentTime = std::chrono::steady_clock::now();
 #endif
 
+            currentRequestId = requestId;
             hasRequest = false;
             isProcessingRequest = true;
-            requestLock.unlock();
+        }
+        requestLock.unlock();
 
 #ifdef USE_ZEROMQ
-            zmq_poll(items, 2, -1);
-
-            if (items[0].revents & ZMQ_POLLIN) {
-                zmq_msg_t reply;
-                int rc = zmq_msg_init(&reply);
-                assert(rc == 0);
-                const int receivedBytes = zmq_msg_recv(&reply, socket, 0);
-                if (receivedBytes < 0) {
-                    zmq_msg_close(&reply);
-                    if (zmq_errno() == ETERM) {
-                        break;
-                    }
-                    continue;
-                }
-                std::string replyString = std::string(
-                        static_cast<const char*>(zmq_msg_data(&reply)), zmq_msg_size(&reply));
-                zmq_msg_close(&reply);
-
-                std::lock_guard<std::mutex> replyLock(requestMutex);
-                hasReply = true;
-                replyMessage = replyString;
-                isProcessingRequest = false;
-            }
+        // Wait for a reply or for a new request, which is signaled over the controller socket.
+        zmq_poll(items, 2, -1);
 
-            if (items[1].revents & ZMQ_POLLIN) {
+        if (items[1].revents & ZMQ_POLLIN) {
+            bool shallStop = false;
+            char controllerMessage[4];
+            int messageSize;
+            while ((messageSize = zmq_recv(controllerSocketSub, controllerMessage, 4, ZMQ_DONTWAIT)) >= 0) {
+                shallStop = shallStop || (messageSize == 4 && strncmp(controllerMessage, "KILL", 4) == 0);
+            }
+            if (shallStop) {
                 break;
             }
-#endif
         }
+
+        if (items[0].revents & ZMQ_POLLIN) {
+            bool isReplyFinished = false;
+            if (!receiveReplyMessage(
+                    socket, jsonCharReaderRequester.get(), currentRequestId, requestSentTime,
+                    serverSupportsRequestIds, isReplyFinished)) {
+                if (zmq_errno() == ETERM) {
+                    break;
+                }
+                continue;
+            }
+            if (isReplyFinished) {
+                isWaitingForReply = false;
+            }
+        }
+#endif
     }
 
     zmq_close(socket);
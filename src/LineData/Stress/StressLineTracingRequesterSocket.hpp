@@ -30,14 +30,46 @@
 #define LINEVIS_STRESSLINETRACINGREQUESTERSOCKET_HPP
 
 #include <thread>
+#include <atomic>
+#include <memory>
+#include <chrono>
 #include <condition_variable>
 
 #include <json/json.h>
 
+struct StressTrajectoriesMemoryData;
+
+/**
+ * Timings measured by the requester thread for a reply (in milliseconds). Together with the entry "serverTimings" of
+ * the reply (if sent by the tracer), they allow splitting up the latency of a request.
+ */
+struct StressLineTracingReplyTimings {
+    double roundTripMs = 0.0; ///< Time from sending the request until all parts of the reply message were received.
+    double decodingMs = 0.0; ///< Time needed for decoding and merging the binary line data.
+};
+
 /**
  * A multi-threaded requester socket for stress line tracing. It listens on port 17384.
  * Similar to a mailbox queue of size 1 in the Vulkan API (cmp. VK_PRESENT_MODE_MAILBOX_KHR), it stores the most recent
  * request and reply. Older requests and replies are discarded if they are not handled fast enough.
+ * A reply may consist of multiple message parts. In this case, the first part is a JSON header, and the remaining parts
+ * are binary frames containing the traced lines, which are decoded on the requester thread
+ * (cmp. StressTrajectoriesBinaryLoader.hpp).
+ * A DEALER socket is used, so the tracer can stream partial results (batches of finished lines) before the final reply.
+ * The binary line data of a reply only contains the lines received since the previous reply to the same request was
+ * fetched (@see getReplyJson), i.e., the lines of replies marked as "partial" need to be appended to the ones received
+ * before. Batches not fetched before the next one arrives are merged, so no lines are lost. Tracers using a REP socket
+ * are still supported, as the requests start with an empty delimiter frame.
+ *
+ * JSON requests carry a strictly increasing "requestId". Tracers echoing the ID in their replies signal that they
+ * support the following protocol.
+ * - Requests may be sent while an older request is still being processed. Replies with an ID other than the one of
+ *   the newest request are dropped, so only the newest parameter set is shown.
+ * - Before a new request is sent, the outstanding one is cancelled with the message { "cancelRequestId": id }.
+ * - The tracer may debounce its queue, i.e., skip all queued requests but the one with the highest ID.
+ * Until the first reply with an ID was received, a new request is only sent after the reply to the previous one.
+ * Together with the mailbox of size 1, this makes sure fast parameter changes (e.g., slider drags) never back up the
+ * tracer.
  */
 class StressLineTracingRequesterSocket {
 public:
@@ -61,10 +93,11 @@ public:
      */
     void queueRequestString(const std::string& requestMessage);
     /**
-     * Queues the request for sending to the request worker over TCP.
+     * Queues the request for sending to the request worker over TCP. The entry "requestId" is added to the request.
      * @param request The message to queue.
+     * @return The ID of the request.
      */
-    void queueRequestJson(const Json::Value& request);
+    uint64_t queueRequestJson(const Json::Value& request);
     /**
      * Checks if a reply was received to a request. If a reply was received, it is stored in replyMessage.
      * @param replyMessage Where to store the reply (if one was received).
@@ -77,6 +110,17 @@ public:
      * @return Whether a reply was received.
      */
     bool getReplyJson(Json::Value& reply);
+    /**
+     * Checks if a reply was received to a request. If a reply was received, it is stored in reply.
+     * @param reply Where to store the reply (if one was received).
+     * @param replyData Where to store the decoded binary line data of the reply. It is set to nullptr if the reply
+     * contained no binary data. For streamed replies, only the lines not fetched before are stored.
+     * @param replyTimings If not nullptr, the timings measured for the reply are stored here.
+     * @return Whether a reply was received.
+     */
+    bool getReplyJson(
+            Json::Value& reply, std::shared_ptr<const StressTrajectoriesMemoryData>& replyData,
+            StressLineTracingReplyTimings* replyTimings = nullptr);
 
     /**
      * @return Whether a request is currently processed (for UI progress spinner).
@@ -86,6 +130,22 @@ public:
 private:
     /// The main loop of the requester thread.
     void mainLoop();
+    /**
+     * Receives one (partial or final) reply message and makes it available to the main thread.
+     * @param socket The ZeroMQ socket to receive from.
+     * @param jsonCharReaderRequester The JSON reader of the requester thread.
+     * @param currentRequestId The ID of the newest request sent. Messages belonging to older requests are dropped.
+     * @param requestSentTime The time when the newest request was sent.
+     * @param serverSupportsRequestIds Set to true if the message contains a request ID.
+     * @param isFinalMessage Set to whether this was the final message of the reply to the newest request.
+     * @return False if the message could not be received.
+     */
+    bool receiveReplyMessage(
+            void* socket, Json::CharReader* jsonCharReaderRequester, uint64_t currentRequestId,
+            const std::chrono::steady_clock::time_point& requestSentTime, bool& serverSupportsRequestIds,
+            bool& isFinalMessage);
+    /// Wakes up the requester thread if it is waiting for a reply, so it can send the newly queued request.
+    void wakeRequesterThread();
 
     std::thread requesterThread;
     std::condition_variable hasRequestConditionVariable;
@@ -103,9 +163,15 @@ private:
     bool programIsFinished = false;
     bool hasRequest = false;
     bool hasReply = false;
-    bool isProcessingRequest = false;
+    std::atomic<bool> isProcessingRequest; ///< Written by the requester thread, read by the main thread.
     std::string requestMessage;
+    uint64_t requestId = 0; ///< The ID of the queued request.
+    uint64_t lastRequestId = 0;
     std::string replyMessage;
+    std::shared_ptr<StressTrajectoriesMemoryData> replyData; ///< Only referenced by the socket until it is fetched.
+    uint64_t replyRequestId = 0;
+    bool isReplyPartial = false;
+    StressLineTracingReplyTimings replyTimings;
 
     Json::CharReaderBuilder readerBuilder;
     Json::CharReader* jsonCharReader = nullptr;
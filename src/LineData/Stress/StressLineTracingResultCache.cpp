@@ -0,0 +1,434 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#include <boost/filesystem.hpp>
+#include <Utils/File/Logfile.hpp>
+
+#include "Loaders/StressTrajectoriesBinaryLoader.hpp"
+#include "StressLineTracingResultCache.hpp"
+
+static const char DISK_CACHE_MAGIC[8] = { 'P', 'S', 'L', 'C', 'A', 'C', 'H', 'E' };
+static const uint32_t DISK_CACHE_VERSION = 1;
+static const char* const DISK_CACHE_EXTENSION = ".pslcache";
+
+template<class T>
+static inline size_t getVectorSize(const std::vector<T>& vec) {
+    return vec.size() * sizeof(T);
+}
+
+size_t getStressTrajectoriesMemoryDataSize(const StressTrajectoriesMemoryData& data) {
+    size_t size = sizeof(StressTrajectoriesMemoryData);
+    for (const Trajectories& trajectories : data.trajectoriesPs) {
+        for (const Trajectory& trajectory : trajectories) {
+            size += sizeof(Trajectory) + getVectorSize(trajectory.positions);
+            for (const std::vector<float>& attributes : trajectory.attributes) {
+                size += getVectorSize(attributes);
+            }
+        }
+    }
+    for (const StressTrajectoriesData& stressTrajectoriesData : data.stressTrajectoriesDataPs) {
+        for (const StressTrajectoryData& stressTrajectoryData : stressTrajectoriesData) {
+            size += sizeof(StressTrajectoryData) + getVectorSize(stressTrajectoryData.hierarchyLevels);
+        }
+    }
+    const std::vector<std::vector<std::vector<glm::vec3>>>* bandPointsListPs[] = {
+            &data.bandPointsUnsmoothedListLeftPs, &data.bandPointsUnsmoothedListRightPs,
+            &data.bandPointsSmoothedListLeftPs, &data.bandPointsSmoothedListRightPs };
+    for (const std::vector<std::vector<std::vector<glm::vec3>>>* bandPointsListPsPtr : bandPointsListPs) {
+        for (const std::vector<std::vector<glm::vec3>>& bandPointsList : *bandPointsListPsPtr) {
+            for (const std::vector<glm::vec3>& bandPoints : bandPointsList) {
+                size += sizeof(std::vector<glm::vec3>) + getVectorSize(bandPoints);
+            }
+        }
+    }
+    size += getVectorSize(data.simulationMeshOutlineTriangleIndices);
+    size += getVectorSize(data.simulationMeshOutlineVertexPositions);
+    return size;
+}
+
+StressLineTracingResultCache::StressLineTracingResultCache(
+        size_t maxMemorySize, const std::string& diskCacheDirectory, uint64_t maxDiskSize)
+        : maxMemorySize(maxMemorySize), maxDiskSize(maxDiskSize) {
+    setDiskCacheDirectory(diskCacheDirectory);
+}
+
+std::string StressLineTracingResultCache::getMeshIdentity(const std::string& meshFilename) {
+    boost::system::error_code errorCode;
+    boost::filesystem::path path = boost::filesystem::absolute(meshFilename);
+    std::string meshIdentity = path.generic_string();
+    uintmax_t fileSize = boost::filesystem::file_size(path, errorCode);
+    if (!errorCode) {
+        meshIdentity += ";" + std::to_string(fileSize);
+    }
+    std::time_t lastWriteTime = boost::filesystem::last_write_time(path, errorCode);
+    if (!errorCode) {
+        meshIdentity += ";" + std::to_string(int64_t(lastWriteTime));
+    }
+    return meshIdentity;
+}
+
+std::string StressLineTracingResultCache::computeCacheKey(
+        const std::string& meshIdentity, const Json::Value& request, std::string& canonicalRequest) {
+    Json::Value canonicalRequestJson = request;
+    canonicalRequestJson.removeMember("requestId");
+    canonicalRequestJson.removeMember("binaryReply");
+    canonicalRequestJson.removeMember("streamReply");
+
+    // JSON objects store their members sorted by name, so the compact string representation is canonical.
+    Json::StreamWriterBuilder builder;
+    builder["commentStyle"] = "None";
+    builder["indentation"] = "";
+    canonicalRequest = meshIdentity + "\n" + Json::writeString(builder, canonicalRequestJson);
+
+    // 64-bit FNV-1a hash.
+    uint64_t hash = 14695981039346656037ull;
+    for (char c : canonicalRequest) {
+        hash ^= uint64_t(uint8_t(c));
+        hash *= 1099511628211ull;
+    }
+    char hashString[17];
+    snprintf(hashString, sizeof(hashString), "%016llx", static_cast<unsigned long long>(hash));
+    return hashString;
+}
+
+bool StressLineTracingResultCache::get(
+        const std::string& key, const std::string& canonicalRequest,
+        Json::Value& reply, std::shared_ptr<const StressTrajectoriesMemoryData>& data) {
+    auto it = entryMap.find(key);
+    if (it != entryMap.end()) {
+        if (it->second->canonicalRequest != canonicalRequest) {
+            return false;
+        }
+        // Move the entry to the front of the least recently used list.
+        entries.splice(entries.begin(), entries, it->second);
+        reply = it->second->reply;
+        data = it->second->data;
+        return true;
+    }
+
+    if (diskCacheDirectory.empty()) {
+        return false;
+    }
+    std::string filename = getDiskCacheFilename(key);
+    if (!boost::filesystem::exists(filename)) {
+        return false;
+    }
+    CacheEntry entry;
+    if (!loadFromDisk(filename, entry) || entry.canonicalRequest != canonicalRequest) {
+        return false;
+    }
+    // The modification time of the files is used for evicting the least recently used files.
+    boost::system::error_code errorCode;
+    boost::filesystem::last_write_time(filename, std::time(nullptr), errorCode);
+    entry.key = key;
+    reply = entry.reply;
+    data = entry.data;
+    putMemory(std::move(entry));
+    return true;
+}
+
+void StressLineTracingResultCache::put(
+        const std::string& key, const std::string& canonicalRequest,
+        const Json::Value& reply, const std::shared_ptr<const StressTrajectoriesMemoryData>& data) {
+    CacheEntry entry;
+    entry.key = key;
+    entry.canonicalRequest = canonicalRequest;
+    entry.reply = reply;
+    entry.reply.removeMember("requestId");
+    entry.reply.removeMember("partial");
+    entry.reply.removeMember("serverTimings");
+    entry.data = data;
+    entry.size = data ? getStressTrajectoriesMemoryDataSize(*data) : 0;
+    if (!diskCacheDirectory.empty() && data) {
+        storeOnDisk(entry);
+        evictDisk();
+    }
+    putMemory(std::move(entry));
+}
+
+void StressLineTracingResultCache::setPendingRequest(
+        uint64_t requestId, const std::string& key, const std::string& canonicalRequest) {
+    pendingRequestId = requestId;
+    pendingKey = key;
+    pendingCanonicalRequest = canonicalRequest;
+}
+
+bool StressLineTracingResultCache::putReply(
+        const Json::Value& reply, const std::shared_ptr<const StressTrajectoriesMemoryData>& data) {
+    // Replies without an ID can't be attributed to a request with certainty.
+    if (pendingRequestId == 0 || !data || !reply.isMember("requestId")
+            || reply["requestId"].asUInt64() != pendingRequestId || reply.get("partial", false).asBool()) {
+        return false;
+    }
+    put(pendingKey, pendingCanonicalRequest, reply, data);
+    pendingRequestId = 0;
+    return true;
+}
+
+void StressLineTracingResultCache::putMemory(CacheEntry&& entry) {
+    auto it = entryMap.find(entry.key);
+    if (it != entryMap.end()) {
+        memorySize -= it->second->size;
+        entries.erase(it->second);
+        entryMap.erase(it);
+    }
+    memorySize += entry.size;
+    entries.push_front(std::move(entry));
+    entryMap.insert(std::make_pair(entries.front().key, entries.begin()));
+    evictMemory();
+}
+
+void StressLineTracingResultCache::evictMemory() {
+    // The most recently used entry is always kept, even if it exceeds the size limit on its own.
+    while (memorySize > maxMemorySize && entries.size() > 1) {
+        memorySize -= entries.back().size;
+        entryMap.erase(entries.back().key);
+        entries.pop_back();
+    }
+}
+
+void StressLineTracingResultCache::clear() {
+    entries.clear();
+    entryMap.clear();
+    memorySize = 0;
+
+    if (!diskCacheDirectory.empty()) {
+        boost::system::error_code errorCode;
+        for (boost::filesystem::directory_iterator it(diskCacheDirectory, errorCode), end; it != end;
+                it.increment(errorCode)) {
+            if (it->path().extension() == DISK_CACHE_EXTENSION) {
+                boost::filesystem::remove(it->path(), errorCode);
+            }
+        }
+    }
+}
+
+void StressLineTracingResultCache::setMaxMemorySize(size_t maxSize) {
+    maxMemorySize = maxSize;
+    evictMemory();
+}
+
+void StressLineTracingResultCache::setDiskCacheDirectory(const std::string& directory) {
+    diskCacheDirectory = directory;
+    if (!diskCacheDirectory.empty()) {
+        boost::system::error_code errorCode;
+        boost::filesystem::create_directories(diskCacheDirectory, errorCode);
+        if (errorCode) {
+            sgl::Logfile::get()->writeError(
+                    "Error in StressLineTracingResultCache::setDiskCacheDirectory: Couldn't create the directory \""
+                    + diskCacheDirectory + "\".");
+            diskCacheDirectory.clear();
+        }
+    }
+}
+
+void StressLineTracingResultCache::setMaxDiskSize(uint64_t maxSize) {
+    maxDiskSize = maxSize;
+    evictDisk();
+}
+
+std::string StressLineTracingResultCache::getDiskCacheFilename(const std::string& key) const {
+    return (boost::filesystem::path(diskCacheDirectory) / (key + DISK_CACHE_EXTENSION)).string();
+}
+
+static void writeString(std::ofstream& file, const std::string& str) {
+    uint64_t size = str.size();
+    file.write(reinterpret_cast<const char*>(&size), sizeof(uint64_t));
+    file.write(str.data(), std::streamsize(size));
+}
+
+static bool readString(std::ifstream& file, uint64_t maxSize, std::string& str) {
+    uint64_t size = 0;
+    if (!file.read(reinterpret_cast<char*>(&size), sizeof(uint64_t)) || size > maxSize) {
+        return false;
+    }
+    str.resize(size_t(size));
+    return size == 0 || bool(file.read(&str[0], std::streamsize(size)));
+}
+
+/*
+ * Disk cache file layout: The magic string "PSLCACHE", the uint32 version, the canonical request, the JSON reply and
+ * the binary message header (each as uint64 size and bytes), the uint32 number of frames and the frames (each as
+ * uint64 size and bytes). The binary message format is described in StressTrajectoriesBinaryLoader.hpp.
+ */
+void StressLineTracingResultCache::storeOnDisk(const CacheEntry& entry) {
+    Json::Value header;
+    std::vector<std::string> frames;
+    encodeStressTrajectoriesBinary(*entry.data, header, frames);
+    Json::StreamWriterBuilder builder;
+    builder["commentStyle"] = "None";
+    builder["indentation"] = "";
+
+    // Write to a temporary file first, so no partially written files are left behind if the program is terminated.
+    std::string filename = getDiskCacheFilename(entry.key);
+    std::string tmpFilename = filename + ".tmp";
+    {
+        std::ofstream file(tmpFilename, std::ios::binary);
+        if (!file.is_open()) {
+            sgl::Logfile::get()->writeError(
+                    "Error in StressLineTracingResultCache::storeOnDisk: Couldn't open the file \""
+                    + tmpFilename + "\".");
+            return;
+        }
+        file.write(DISK_CACHE_MAGIC, sizeof(DISK_CACHE_MAGIC));
+        file.write(reinterpret_cast<const char*>(&DISK_CACHE_VERSION), sizeof(uint32_t));
+        writeString(file, entry.canonicalRequest);
+        writeString(file, Json::writeString(builder, entry.reply));
+        writeString(file, Json::writeString(builder, header));
+        uint32_t numFrames = uint32_t(frames.size());
+        file.write(reinterpret_cast<const char*>(&numFrames), sizeof(uint32_t));
+        for (const std::string& frame : frames) {
+            writeString(file, frame);
+        }
+        if (!file.good()) {
+            file.close();
+            boost::system::error_code errorCode;
+            boost::filesystem::remove(tmpFilename, errorCode);
+            sgl::Logfile::get()->writeError(
+                    "Error in StressLineTracingResultCache::storeOnDisk: Couldn't write the file \""
+                    + tmpFilename + "\".");
+            return;
+        }
+    }
+    boost::system::error_code errorCode;
+    boost::filesystem::rename(tmpFilename, filename, errorCode);
+}
+
+bool StressLineTracingResultCache::loadFromDisk(const std::string& filename, CacheEntry& entry) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    boost::system::error_code errorCode;
+    const uint64_t fileSize = boost::filesystem::file_size(filename, errorCode);
+    if (errorCode) {
+        return false;
+    }
+
+    char magic[sizeof(DISK_CACHE_MAGIC)];
+    uint32_t version = 0;
+    if (!file.read(magic, sizeof(magic)) || std::memcmp(magic, DISK_CACHE_MAGIC, sizeof(magic)) != 0
+            || !file.read(reinterpret_cast<char*>(&version), sizeof(uint32_t)) || version != DISK_CACHE_VERSION) {
+        sgl::Logfile::get()->writeError(
+                "Error in StressLineTracingResultCache::loadFromDisk: Invalid cache file \"" + filename + "\".");
+        return false;
+    }
+
+    std::string replyString, headerString;
+    uint32_t numFrames = 0;
+    if (!readString(file, fileSize, entry.canonicalRequest) || !readString(file, fileSize, replyString)
+            || !readString(file, fileSize, headerString)
+            || !file.read(reinterpret_cast<char*>(&numFrames), sizeof(uint32_t))) {
+        sgl::Logfile::get()->writeError(
+                "Error in StressLineTracingResultCache::loadFromDisk: Truncated cache file \"" + filename + "\".");
+        return false;
+    }
+    std::vector<std::string> frameData(std::min(uint64_t(numFrames), fileSize / sizeof(uint64_t)));
+    std::vector<StressTrajectoriesBinaryFrame> frames;
+    frames.reserve(frameData.size());
+    for (std::string& frame : frameData) {
+        if (!readString(file, fileSize, frame)) {
+            sgl::Logfile::get()->writeError(
+                    "Error in StressLineTracingResultCache::loadFromDisk: Truncated cache file \"" + filename + "\".");
+            return false;
+        }
+        frames.push_back({ frame.data(), frame.size() });
+    }
+
+    Json::CharReaderBuilder readerBuilder;
+    std::unique_ptr<Json::CharReader> jsonCharReader(readerBuilder.newCharReader());
+    Json::Value header;
+    std::string errorString;
+    if (!jsonCharReader->parse(
+                replyString.c_str(), replyString.c_str() + replyString.size(), &entry.reply, &errorString)
+            || !jsonCharReader->parse(
+                headerString.c_str(), headerString.c_str() + headerString.size(), &header, &errorString)) {
+        sgl::Logfile::get()->writeError(
+                "Error in StressLineTracingResultCache::loadFromDisk: Invalid JSON data in the cache file \""
+                + filename + "\": " + errorString);
+        return false;
+    }
+
+    std::shared_ptr<StressTrajectoriesMemoryData> data = std::make_shared<StressTrajectoriesMemoryData>();
+    if (!decodeStressTrajectoriesBinary(header, frames, *data)) {
+        return false;
+    }
+    entry.size = getStressTrajectoriesMemoryDataSize(*data);
+    entry.data = data;
+    return true;
+}
+
+void StressLineTracingResultCache::evictDisk() {
+    if (diskCacheDirectory.empty()) {
+        return;
+    }
+
+    struct DiskCacheFile {
+        boost::filesystem::path path;
+        uint64_t size;
+        std::time_t lastWriteTime;
+    };
+    std::vector<DiskCacheFile> files;
+    uint64_t diskSize = 0;
+    boost::system::error_code errorCode;
+    for (boost::filesystem::directory_iterator it(diskCacheDirectory, errorCode), end; it != end;
+            it.increment(errorCode)) {
+        if (it->path().extension() != DISK_CACHE_EXTENSION) {
+            continue;
+        }
+        DiskCacheFile file;
+        file.path = it->path();
+        file.size = boost::filesystem::file_size(file.path, errorCode);
+        file.lastWriteTime = boost::filesystem::last_write_time(file.path, errorCode);
+        if (!errorCode) {
+            diskSize += file.size;
+            files.push_back(file);
+        }
+    }
+    if (diskSize <= maxDiskSize) {
+        return;
+    }
+
+    // Remove the least recently used files (all but the newest one) until the size limit is met.
+    std::sort(files.begin(), files.end(), [](const DiskCacheFile& file0, const DiskCacheFile& file1) {
+        return file0.lastWriteTime < file1.lastWriteTime;
+    });
+    for (size_t i = 0; i + 1 < files.size() && diskSize > maxDiskSize; i++) {
+        boost::filesystem::remove(files.at(i).path, errorCode);
+        if (!errorCode) {
+            diskSize -= files.at(i).size;
+        }
+    }
+}
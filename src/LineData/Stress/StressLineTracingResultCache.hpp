@@ -0,0 +1,163 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LINEVIS_STRESSLINETRACINGRESULTCACHE_HPP
+#define LINEVIS_STRESSLINETRACINGRESULTCACHE_HPP
+
+#include <string>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+
+#include <json/json.h>
+
+struct StressTrajectoriesMemoryData;
+
+/**
+ * A client-side cache for the results of the stress line tracer. The results are identified by the simulation mesh and
+ * the tracing parameters (@see computeCacheKey), so a parameter set that was already traced can be shown without
+ * contacting the tracer again.
+ * The cache keeps the most recently used results in memory up to a size limit. Optionally, results are also stored in
+ * a directory on disk (with its own size limit), so they are available after restarting the program. In both cases,
+ * the least recently used results are evicted first.
+ */
+class StressLineTracingResultCache {
+public:
+    /**
+     * @param maxMemorySize The maximum size of all results kept in memory (in bytes).
+     * @param diskCacheDirectory The directory for the disk cache. An empty string disables the disk cache.
+     * @param maxDiskSize The maximum size of all files in the disk cache directory (in bytes).
+     */
+    explicit StressLineTracingResultCache(
+            size_t maxMemorySize = size_t(1) << 30, const std::string& diskCacheDirectory = "",
+            uint64_t maxDiskSize = uint64_t(4) << 30);
+
+    /**
+     * Returns an identity string for a mesh file. It changes if the file is modified.
+     * @param meshFilename The path of the mesh file.
+     * @return The absolute path of the file together with its size and modification time.
+     */
+    static std::string getMeshIdentity(const std::string& meshFilename);
+    /**
+     * Computes the key of a result from the mesh identity and the tracing request. The request is canonicalized first,
+     * i.e., entries not influencing the traced lines (request ID, transfer options) are removed, and the entries are
+     * ordered by name.
+     * @param meshIdentity The identity of the mesh the lines were traced on (@see getMeshIdentity).
+     * @param request The JSON request sent to the tracer.
+     * @return The key (a hexadecimal hash value) and the canonical string it was computed from.
+     */
+    static std::string computeCacheKey(
+            const std::string& meshIdentity, const Json::Value& request, std::string& canonicalRequest);
+
+    /**
+     * Looks up a result in memory and, if not found there, on disk.
+     * @param key The key of the result.
+     * @param canonicalRequest The canonical request string returned by @see computeCacheKey (for detecting hash
+     * collisions).
+     * @param reply The JSON reply of the tracer (output).
+     * @param data The traced lines (output).
+     * @return Whether the result was found.
+     */
+    bool get(
+            const std::string& key, const std::string& canonicalRequest,
+            Json::Value& reply, std::shared_ptr<const StressTrajectoriesMemoryData>& data);
+    /**
+     * Adds a result to the cache. Older results are evicted if the size limits are exceeded.
+     * @param key The key of the result.
+     * @param canonicalRequest The canonical request string returned by @see computeCacheKey.
+     * @param reply The JSON reply of the tracer (the entries "requestId", "partial" and "serverTimings" are dropped).
+     * @param data The traced lines.
+     */
+    void put(
+            const std::string& key, const std::string& canonicalRequest,
+            const Json::Value& reply, const std::shared_ptr<const StressTrajectoriesMemoryData>& data);
+
+    /**
+     * Remembers the key of the request sent to the tracer last. The reply is stored with @see putReply, which only
+     * accepts the reply to exactly this request. Replies to older requests arriving later are dropped, so they can't be
+     * stored under the key of a newer request.
+     * @param requestId The ID of the request (0 if no request is pending, e.g., as a cached result was used).
+     * @param key The key of the request (@see computeCacheKey).
+     * @param canonicalRequest The canonical request string returned by @see computeCacheKey.
+     */
+    void setPendingRequest(uint64_t requestId, const std::string& key, const std::string& canonicalRequest);
+    /**
+     * Adds the reply to the pending request to the cache (@see setPendingRequest). Partial replies and replies without
+     * or with a different request ID are ignored.
+     * @param reply The JSON reply of the tracer.
+     * @param data The traced lines.
+     * @return Whether the reply was added to the cache.
+     */
+    bool putReply(const Json::Value& reply, const std::shared_ptr<const StressTrajectoriesMemoryData>& data);
+
+    /// Removes all results from memory and from the disk cache directory.
+    void clear();
+
+    void setMaxMemorySize(size_t maxSize);
+    void setDiskCacheDirectory(const std::string& directory);
+    void setMaxDiskSize(uint64_t maxSize);
+    inline size_t getMemorySize() const { return memorySize; }
+    inline size_t getNumEntries() const { return entries.size(); }
+
+private:
+    struct CacheEntry {
+        std::string key;
+        std::string canonicalRequest;
+        Json::Value reply;
+        std::shared_ptr<const StressTrajectoriesMemoryData> data;
+        size_t size;
+    };
+
+    void putMemory(CacheEntry&& entry);
+    void evictMemory();
+    std::string getDiskCacheFilename(const std::string& key) const;
+    bool loadFromDisk(const std::string& filename, CacheEntry& entry);
+    void storeOnDisk(const CacheEntry& entry);
+    void evictDisk();
+
+    // Most recently used entries first.
+    std::list<CacheEntry> entries;
+    std::unordered_map<std::string, std::list<CacheEntry>::iterator> entryMap;
+    size_t memorySize = 0;
+    size_t maxMemorySize;
+
+    std::string diskCacheDirectory;
+    uint64_t maxDiskSize;
+
+    uint64_t pendingRequestId = 0;
+    std::string pendingKey, pendingCanonicalRequest;
+};
+
+/**
+ * @param data Principal stress line data.
+ * @return The approximate number of bytes of memory used by the data.
+ */
+size_t getStressTrajectoriesMemoryDataSize(const StressTrajectoriesMemoryData& data);
+
+#endif //LINEVIS_STRESSLINETRACINGRESULTCACHE_HPP
@@ -0,0 +1,130 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+#include "StressTensorProbe.hpp"
+
+bool StressTensorProbe::loadMeshFromFile(const std::string& meshFilename) {
+    clear();
+    if (!loadStressTensorMeshFromFile(meshFilename, mesh)) {
+        mesh = StressTensorMesh();
+        return false;
+    }
+    cellGrid.build(mesh.vertices, mesh.cellIndices);
+    return true;
+}
+
+void StressTensorProbe::setMesh(const StressTensorMesh& mesh) {
+    clear();
+    this->mesh = mesh;
+    cellGrid.build(this->mesh.vertices, this->mesh.cellIndices);
+}
+
+void StressTensorProbe::clear() {
+    cellGrid.clear();
+    mesh = StressTensorMesh();
+}
+
+bool StressTensorProbe::probe(const glm::vec3& position, StressTensorProbeResult& result) const {
+    uint32_t cellIdx;
+    glm::vec3 localCoordinates;
+    if (!cellGrid.findCell(position, cellIdx, localCoordinates)) {
+        return false;
+    }
+    result.position = position;
+    result.cellIdx = cellIdx;
+    interpolateStressTensorTrilinear(mesh, cellIdx, localCoordinates, result.stressTensor);
+    computeEigenDecompositionSymmetric(
+            result.stressTensor, result.principalStresses, result.principalStressDirections);
+    result.vonMisesStress = computeVonMisesStress(result.stressTensor);
+    return true;
+}
+
+bool StressTensorProbe::probeAlongRay(
+        const glm::vec3& rayOrigin, const glm::vec3& rayDirection, StressTensorProbeResult& result) const {
+    if (cellGrid.getIsEmpty()) {
+        return false;
+    }
+
+    // Clip the ray against the bounding box of the mesh (slab test).
+    const glm::vec3& minBounds = cellGrid.getMinBounds();
+    const glm::vec3& maxBounds = cellGrid.getMaxBounds();
+    float tMin = 0.0f, tMax = std::numeric_limits<float>::max();
+    for (int i = 0; i < 3; i++) {
+        if (std::abs(rayDirection[i]) < 1e-12f) {
+            if (rayOrigin[i] < minBounds[i] || rayOrigin[i] > maxBounds[i]) {
+                return false;
+            }
+            continue;
+        }
+        float t0 = (minBounds[i] - rayOrigin[i]) / rayDirection[i];
+        float t1 = (maxBounds[i] - rayOrigin[i]) / rayDirection[i];
+        tMin = std::max(tMin, std::min(t0, t1));
+        tMax = std::min(tMax, std::max(t0, t1));
+    }
+    if (tMin > tMax) {
+        return false;
+    }
+
+    // March along the clipped ray until a position inside of a cell is found.
+    float stepSize = std::max(
+            0.5f * cellGrid.getAverageCellExtent(), (tMax - tMin) / float(MAX_NUM_RAY_MARCHING_STEPS));
+    uint32_t cellIdx;
+    glm::vec3 localCoordinates;
+    float tOutside = tMin;
+    float tInside = tMin;
+    bool foundInside = false;
+    for (float t = tMin; t <= tMax + 0.5f * stepSize; t += stepSize) {
+        float tClamped = std::min(t, tMax);
+        if (cellGrid.findCell(rayOrigin + tClamped * rayDirection, cellIdx, localCoordinates)) {
+            tInside = tClamped;
+            foundInside = true;
+            break;
+        }
+        tOutside = tClamped;
+    }
+    if (!foundInside) {
+        return false;
+    }
+
+    // Refine the entry point between the last position outside and the first position inside of the mesh.
+    if (tInside > tMin) {
+        for (int iteration = 0; iteration < 16; iteration++) {
+            float tMid = 0.5f * (tOutside + tInside);
+            if (cellGrid.findCell(rayOrigin + tMid * rayDirection, cellIdx, localCoordinates)) {
+                tInside = tMid;
+            } else {
+                tOutside = tMid;
+            }
+        }
+    }
+    return probe(rayOrigin + tInside * rayDirection, result);
+}
@@ -0,0 +1,97 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LINEVIS_STRESSTENSORPROBE_HPP
+#define LINEVIS_STRESSTENSORPROBE_HPP
+
+#include <string>
+#include <glm/vec3.hpp>
+
+#include "LineData/SearchStructures/HexahedralCellGrid.hpp"
+#include "StressLineTracer.hpp"
+
+/// The stress tensor interpolated at a probed position (@see StressTensorProbe).
+struct StressTensorProbeResult {
+    glm::vec3 position = glm::vec3(0.0f); ///< The probed position.
+    uint32_t cellIdx = 0; ///< The index of the mesh cell containing the position.
+    float stressTensor[6] = {}; ///< The interpolated tensor (xx, yy, zz, yz, zx, xy).
+    float principalStresses[3] = {}; ///< The principal stresses (major, medium, minor).
+    glm::vec3 principalStressDirections[3]; ///< The normalized directions of the principal stresses.
+    float vonMisesStress = 0.0f;
+};
+
+/**
+ * Interpolates the stress tensor of a hexahedral simulation mesh at arbitrary positions, e.g., at the mouse cursor.
+ * The cell containing a position is found using @see HexahedralCellGrid, which answers a query in a few microseconds.
+ */
+class StressTensorProbe {
+public:
+    StressTensorProbe() = default;
+    // The cell grid references the arrays of the mesh, so copying would leave it pointing to the original object.
+    StressTensorProbe(const StressTensorProbe&) = delete;
+    StressTensorProbe& operator=(const StressTensorProbe&) = delete;
+
+    /**
+     * Loads the mesh and its per-vertex stress tensors (@see loadStressTensorMeshFromFile) and builds the cell grid.
+     * @param meshFilename The name of the mesh file.
+     * @return Whether loading has succeeded.
+     */
+    bool loadMeshFromFile(const std::string& meshFilename);
+    /// Uses the passed mesh (e.g., a mesh already loaded for line tracing).
+    void setMesh(const StressTensorMesh& mesh);
+    void clear();
+    inline bool getIsEmpty() const { return cellGrid.getIsEmpty(); }
+    inline const StressTensorMesh& getMesh() const { return mesh; }
+    inline const HexahedralCellGrid& getCellGrid() const { return cellGrid; }
+
+    /**
+     * Interpolates the stress tensor at a position and computes its principal stresses.
+     * @param position The position in mesh coordinates.
+     * @param result The interpolated tensor and its eigen decomposition.
+     * @return False if the position lies outside of the mesh.
+     */
+    bool probe(const glm::vec3& position, StressTensorProbeResult& result) const;
+    /**
+     * Probes the stress tensor at the first position along a ray lying inside of the mesh. The ray is marched in steps
+     * of half the average cell extent, and the entry point is refined using bisection.
+     * @param rayOrigin The origin of the ray in mesh coordinates.
+     * @param rayDirection The normalized direction of the ray.
+     * @param result The interpolated tensor at the entry point and its eigen decomposition.
+     * @return False if the ray misses the mesh.
+     */
+    bool probeAlongRay(
+            const glm::vec3& rayOrigin, const glm::vec3& rayDirection, StressTensorProbeResult& result) const;
+
+private:
+    static const int MAX_NUM_RAY_MARCHING_STEPS = 4096;
+
+    StressTensorMesh mesh;
+    HexahedralCellGrid cellGrid; ///< References the vertex and cell index arrays of mesh.
+};
+
+#endif //LINEVIS_STRESSTENSORPROBE_HPP
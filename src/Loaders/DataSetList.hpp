@@ -30,6 +30,7 @@
 #define LINEDENSITYCONTROL_DATASETLIST_HPP
 
 #include <vector>
+#include <memory>
 
 #include <Math/Geometry/MatrixUtil.hpp>
 
@@ -37,6 +38,8 @@ enum DataSetType {
     DATA_SET_TYPE_NONE, DATA_SET_TYPE_FLOW_LINES, DATA_SET_TYPE_STRESS_LINES, DATA_SET_TYPE_FLOW_LINES_MULTIVAR
 };
 
+struct StressTrajectoriesMemoryData;
+
 const float STANDARD_LINE_WIDTH = 0.002f;
 const float STANDARD_BAND_WIDTH = 0.005f;
 
@@ -57,6 +60,8 @@ struct DataSetInformation {
     std::string meshFilename;
     std::string degeneratePointsFilename;
     std::vector<std::string> filenamesStressLineHierarchy;
+    /// Stress lines received from the line tracer in binary form. If set, they are used instead of the file names.
+    std::shared_ptr<const StressTrajectoriesMemoryData> stressTrajectoriesMemoryData;
 };
 
 std::vector<DataSetInformation> loadDataSetList(const std::string& filename);
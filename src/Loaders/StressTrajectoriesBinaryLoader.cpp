@@ -0,0 +1,454 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstring>
+#include <cmath>
+#include <algorithm>
+#include <iterator>
+
+#include <Utils/File/Logfile.hpp>
+
+#include "StressTrajectoriesBinaryLoader.hpp"
+
+static bool checkFrameSize(
+        const std::vector<StressTrajectoriesBinaryFrame>& frames, size_t frameIdx, size_t expectedSize) {
+    if (frameIdx >= frames.size()) {
+        sgl::Logfile::get()->writeError(
+                "Error in decodeStressTrajectoriesBinary: Frame " + std::to_string(frameIdx) + " is missing.");
+        return false;
+    }
+    if (frames.at(frameIdx).size != expectedSize) {
+        sgl::Logfile::get()->writeError(
+                "Error in decodeStressTrajectoriesBinary: Frame " + std::to_string(frameIdx) + " has "
+                + std::to_string(frames.at(frameIdx).size) + " bytes, but " + std::to_string(expectedSize)
+                + " bytes were expected.");
+        return false;
+    }
+    return true;
+}
+
+/// Copies the per point vectors of all lines from a frame of size numPoints * sizeof(glm::vec3).
+static void decodeLinePointsFrame(
+        const StressTrajectoriesBinaryFrame& frame, const std::vector<uint32_t>& lineOffsets,
+        std::vector<std::vector<glm::vec3>>& linePointsList) {
+    const char* frameData = static_cast<const char*>(frame.data);
+    const size_t numLines = lineOffsets.size() - 1;
+    linePointsList.resize(numLines);
+    for (size_t lineIdx = 0; lineIdx < numLines; lineIdx++) {
+        std::vector<glm::vec3>& linePoints = linePointsList.at(lineIdx);
+        linePoints.resize(lineOffsets.at(lineIdx + 1) - lineOffsets.at(lineIdx));
+        if (!linePoints.empty()) {
+            memcpy(
+                    linePoints.data(), frameData + size_t(lineOffsets.at(lineIdx)) * sizeof(glm::vec3),
+                    linePoints.size() * sizeof(glm::vec3));
+        }
+    }
+}
+
+static void encodeLinePointsFrame(
+        const std::vector<std::vector<glm::vec3>>& linePointsList, size_t numPoints, std::vector<std::string>& frames) {
+    frames.emplace_back();
+    std::string& frame = frames.back();
+    frame.resize(numPoints * sizeof(glm::vec3));
+    size_t byteOffset = 0;
+    for (const std::vector<glm::vec3>& linePoints : linePointsList) {
+        if (!linePoints.empty()) {
+            memcpy(&frame[byteOffset], linePoints.data(), linePoints.size() * sizeof(glm::vec3));
+        }
+        byteOffset += linePoints.size() * sizeof(glm::vec3);
+    }
+}
+
+bool getIsStressTrajectoriesBinaryHeader(const Json::Value& header) {
+    return header.isObject() && header.isMember("format")
+            && header["format"].asString() == STRESS_TRAJECTORIES_BINARY_FORMAT_NAME;
+}
+
+bool decodeStressTrajectoriesBinary(
+        const Json::Value& header, const std::vector<StressTrajectoriesBinaryFrame>& frames,
+        StressTrajectoriesMemoryData& data) {
+    data = StressTrajectoriesMemoryData();
+    if (!getIsStressTrajectoriesBinaryHeader(header) || !header["lineSets"].isArray()) {
+        sgl::Logfile::get()->writeError("Error in decodeStressTrajectoriesBinary: Invalid message header.");
+        return false;
+    }
+    if (header.get("formatVersion", 0).asInt() != STRESS_TRAJECTORIES_BINARY_FORMAT_VERSION) {
+        sgl::Logfile::get()->writeError("Error in decodeStressTrajectoriesBinary: Unsupported format version.");
+        return false;
+    }
+
+    if (header.get("meshType", "Cartesian").asString() == "Cartesian") {
+        data.meshType = MeshType::CARTESIAN;
+    } else {
+        data.meshType = MeshType::UNSTRUCTURED;
+    }
+    const bool hasBands = header.get("hasBands", false).asBool();
+
+    size_t frameIdx = 0;
+    const Json::Value& lineSets = header["lineSets"];
+    for (Json::Value::ArrayIndex lineSetIdx = 0; lineSetIdx < lineSets.size(); lineSetIdx++) {
+        const Json::Value& lineSet = lineSets[lineSetIdx];
+        const int psIdx = lineSet.get("psIdx", -1).asInt();
+        const uint32_t numLines = lineSet.get("numLines", 0).asUInt();
+        const uint32_t numPoints = lineSet.get("numPoints", 0).asUInt();
+        const uint32_t numAttributes = lineSet.get("numAttributes", 0).asUInt();
+        const uint32_t numHierarchyLevels = lineSet.get("numHierarchyLevels", 0).asUInt();
+        if (psIdx < 0 || psIdx > 2 || numAttributes == 0) {
+            sgl::Logfile::get()->writeError(
+                    "Error in decodeStressTrajectoriesBinary: Invalid metadata of line set "
+                    + std::to_string(lineSetIdx) + ".");
+            return false;
+        }
+
+        // Line offsets.
+        std::vector<uint32_t> lineOffsets(numLines + 1);
+        if (!checkFrameSize(frames, frameIdx, lineOffsets.size() * sizeof(uint32_t))) {
+            return false;
+        }
+        memcpy(lineOffsets.data(), frames.at(frameIdx).data, lineOffsets.size() * sizeof(uint32_t));
+        frameIdx++;
+        bool lineOffsetsValid = lineOffsets.front() == 0 && lineOffsets.back() == numPoints;
+        for (uint32_t lineIdx = 0; lineIdx < numLines && lineOffsetsValid; lineIdx++) {
+            lineOffsetsValid = lineOffsets.at(lineIdx) <= lineOffsets.at(lineIdx + 1);
+        }
+        if (!lineOffsetsValid) {
+            sgl::Logfile::get()->writeError(
+                    "Error in decodeStressTrajectoriesBinary: Invalid line offsets in line set "
+                    + std::to_string(lineSetIdx) + ".");
+            return false;
+        }
+
+        Trajectories trajectories(numLines);
+        StressTrajectoriesData stressTrajectoriesData(numLines);
+
+        // Positions.
+        if (!checkFrameSize(frames, frameIdx, size_t(numPoints) * sizeof(glm::vec3))) {
+            return false;
+        }
+        {
+            std::vector<std::vector<glm::vec3>> positionsList;
+            decodeLinePointsFrame(frames.at(frameIdx), lineOffsets, positionsList);
+            for (uint32_t lineIdx = 0; lineIdx < numLines; lineIdx++) {
+                trajectories.at(lineIdx).positions = std::move(positionsList.at(lineIdx));
+            }
+        }
+        frameIdx++;
+
+        // Attributes. The principal stress magnitude is inserted as the second attribute like in the .dat loader.
+        if (!checkFrameSize(frames, frameIdx, size_t(numAttributes) * size_t(numPoints) * sizeof(float))) {
+            return false;
+        }
+        const char* attributeData = static_cast<const char*>(frames.at(frameIdx).data);
+        for (uint32_t lineIdx = 0; lineIdx < numLines; lineIdx++) {
+            Trajectory& trajectory = trajectories.at(lineIdx);
+            const uint32_t lineOffset = lineOffsets.at(lineIdx);
+            const size_t lineLength = trajectory.positions.size();
+            trajectory.attributes.resize(numAttributes + 1);
+            for (uint32_t attributeIdx = 0; attributeIdx < numAttributes; attributeIdx++) {
+                std::vector<float>& attributes = trajectory.attributes.at(attributeIdx == 0 ? 0 : attributeIdx + 1);
+                attributes.resize(lineLength);
+                if (lineLength > 0) {
+                    memcpy(
+                            attributes.data(),
+                            attributeData + (size_t(attributeIdx) * numPoints + lineOffset) * sizeof(float),
+                            lineLength * sizeof(float));
+                }
+            }
+            std::vector<float>& principalStressMagnitudes = trajectory.attributes.at(1);
+            principalStressMagnitudes.resize(lineLength);
+            for (size_t pointIdx = 0; pointIdx < lineLength; pointIdx++) {
+                principalStressMagnitudes.at(pointIdx) = std::abs(trajectory.attributes.at(0).at(pointIdx));
+            }
+        }
+        frameIdx++;
+
+        // Hierarchy levels.
+        if (!checkFrameSize(frames, frameIdx, size_t(numLines) * numHierarchyLevels * sizeof(float))) {
+            return false;
+        }
+        const char* hierarchyLevelData = static_cast<const char*>(frames.at(frameIdx).data);
+        for (uint32_t lineIdx = 0; lineIdx < numLines; lineIdx++) {
+            std::vector<float>& hierarchyLevels = stressTrajectoriesData.at(lineIdx).hierarchyLevels;
+            hierarchyLevels.resize(numHierarchyLevels);
+            if (numHierarchyLevels > 0) {
+                memcpy(
+                        hierarchyLevels.data(),
+                        hierarchyLevelData + size_t(lineIdx) * numHierarchyLevels * sizeof(float),
+                        numHierarchyLevels * sizeof(float));
+            }
+        }
+        frameIdx++;
+
+        // Information about the seeding process.
+        if (!checkFrameSize(frames, frameIdx, size_t(numLines) * sizeof(int32_t))
+                || !checkFrameSize(frames, frameIdx + 1, size_t(numLines) * sizeof(glm::vec3))) {
+            return false;
+        }
+        const char* appearanceOrderData = static_cast<const char*>(frames.at(frameIdx).data);
+        const char* seedPositionData = static_cast<const char*>(frames.at(frameIdx + 1).data);
+        for (uint32_t lineIdx = 0; lineIdx < numLines; lineIdx++) {
+            StressTrajectoryData& stressTrajectoryData = stressTrajectoriesData.at(lineIdx);
+            int32_t appearanceOrder;
+            memcpy(&appearanceOrder, appearanceOrderData + size_t(lineIdx) * sizeof(int32_t), sizeof(int32_t));
+            stressTrajectoryData.appearanceOrder = int(appearanceOrder);
+            memcpy(
+                    &stressTrajectoryData.seedPosition, seedPositionData + size_t(lineIdx) * sizeof(glm::vec3),
+                    sizeof(glm::vec3));
+        }
+        frameIdx += 2;
+
+        // Band points.
+        if (hasBands) {
+            for (size_t i = 0; i < 4; i++) {
+                if (!checkFrameSize(frames, frameIdx + i, size_t(numPoints) * sizeof(glm::vec3))) {
+                    return false;
+                }
+            }
+            data.bandPointsUnsmoothedListLeftPs.emplace_back();
+            decodeLinePointsFrame(frames.at(frameIdx++), lineOffsets, data.bandPointsUnsmoothedListLeftPs.back());
+            data.bandPointsUnsmoothedListRightPs.emplace_back();
+            decodeLinePointsFrame(frames.at(frameIdx++), lineOffsets, data.bandPointsUnsmoothedListRightPs.back());
+            data.bandPointsSmoothedListLeftPs.emplace_back();
+            decodeLinePointsFrame(frames.at(frameIdx++), lineOffsets, data.bandPointsSmoothedListLeftPs.back());
+            data.bandPointsSmoothedListRightPs.emplace_back();
+            decodeLinePointsFrame(frames.at(frameIdx++), lineOffsets, data.bandPointsSmoothedListRightPs.back());
+        }
+
+        data.loadedPsIndices.push_back(psIdx);
+        data.trajectoriesPs.emplace_back(std::move(trajectories));
+        data.stressTrajectoriesDataPs.emplace_back(std::move(stressTrajectoriesData));
+    }
+
+    // Optional simulation mesh hull.
+    const uint32_t numOutlineTriangleIndices = header.get("numOutlineTriangleIndices", 0).asUInt();
+    const uint32_t numOutlineVertices = header.get("numOutlineVertices", 0).asUInt();
+    if (numOutlineTriangleIndices > 0) {
+        if (!checkFrameSize(frames, frameIdx, size_t(numOutlineTriangleIndices) * sizeof(uint32_t))
+                || !checkFrameSize(frames, frameIdx + 1, size_t(numOutlineVertices) * sizeof(glm::vec3))) {
+            return false;
+        }
+        data.simulationMeshOutlineTriangleIndices.resize(numOutlineTriangleIndices);
+        memcpy(
+                data.simulationMeshOutlineTriangleIndices.data(), frames.at(frameIdx).data,
+                size_t(numOutlineTriangleIndices) * sizeof(uint32_t));
+        data.simulationMeshOutlineVertexPositions.resize(numOutlineVertices);
+        if (numOutlineVertices > 0) {
+            memcpy(
+                    data.simulationMeshOutlineVertexPositions.data(), frames.at(frameIdx + 1).data,
+                    size_t(numOutlineVertices) * sizeof(glm::vec3));
+        }
+        frameIdx += 2;
+    }
+
+    if (frameIdx != frames.size()) {
+        sgl::Logfile::get()->writeError(
+                "Error in decodeStressTrajectoriesBinary: Expected " + std::to_string(frameIdx) + " frames, but "
+                + std::to_string(frames.size()) + " frames were received.");
+        return false;
+    }
+
+    return true;
+}
+
+template<class T>
+static void appendMoved(std::vector<T>& data, std::vector<T>& batch) {
+    data.insert(data.end(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+}
+
+void appendStressTrajectoriesMemoryData(StressTrajectoriesMemoryData& data, StressTrajectoriesMemoryData& batch) {
+    if (data.trajectoriesPs.empty() && data.simulationMeshOutlineTriangleIndices.empty()) {
+        data = std::move(batch);
+        return;
+    }
+
+    const bool batchHasBands = !batch.bandPointsUnsmoothedListLeftPs.empty();
+    const bool hasBands = data.trajectoriesPs.empty() ? batchHasBands : !data.bandPointsUnsmoothedListLeftPs.empty();
+    for (size_t batchLineSetIdx = 0; batchLineSetIdx < batch.trajectoriesPs.size(); batchLineSetIdx++) {
+        const int psIdx = batch.loadedPsIndices.at(batchLineSetIdx);
+        auto it = std::find(data.loadedPsIndices.begin(), data.loadedPsIndices.end(), psIdx);
+        size_t lineSetIdx = size_t(it - data.loadedPsIndices.begin());
+        if (it == data.loadedPsIndices.end()) {
+            data.loadedPsIndices.push_back(psIdx);
+            data.trajectoriesPs.emplace_back();
+            data.stressTrajectoriesDataPs.emplace_back();
+            if (hasBands) {
+                data.bandPointsUnsmoothedListLeftPs.emplace_back();
+                data.bandPointsUnsmoothedListRightPs.emplace_back();
+                data.bandPointsSmoothedListLeftPs.emplace_back();
+                data.bandPointsSmoothedListRightPs.emplace_back();
+            }
+        }
+        appendMoved(data.trajectoriesPs.at(lineSetIdx), batch.trajectoriesPs.at(batchLineSetIdx));
+        appendMoved(data.stressTrajectoriesDataPs.at(lineSetIdx), batch.stressTrajectoriesDataPs.at(batchLineSetIdx));
+        if (hasBands && batchHasBands) {
+            appendMoved(
+                    data.bandPointsUnsmoothedListLeftPs.at(lineSetIdx),
+                    batch.bandPointsUnsmoothedListLeftPs.at(batchLineSetIdx));
+            appendMoved(
+                    data.bandPointsUnsmoothedListRightPs.at(lineSetIdx),
+                    batch.bandPointsUnsmoothedListRightPs.at(batchLineSetIdx));
+            appendMoved(
+                    data.bandPointsSmoothedListLeftPs.at(lineSetIdx),
+                    batch.bandPointsSmoothedListLeftPs.at(batchLineSetIdx));
+            appendMoved(
+                    data.bandPointsSmoothedListRightPs.at(lineSetIdx),
+                    batch.bandPointsSmoothedListRightPs.at(batchLineSetIdx));
+        }
+    }
+
+    // Band points can only be used if they were sent for all lines.
+    if (hasBands && !batchHasBands) {
+        data.bandPointsUnsmoothedListLeftPs.clear();
+        data.bandPointsUnsmoothedListRightPs.clear();
+        data.bandPointsSmoothedListLeftPs.clear();
+        data.bandPointsSmoothedListRightPs.clear();
+    }
+
+    // The simulation mesh hull only needs to be sent once.
+    if (data.simulationMeshOutlineTriangleIndices.empty() && !batch.simulationMeshOutlineTriangleIndices.empty()) {
+        data.meshType = batch.meshType;
+        data.simulationMeshOutlineTriangleIndices = std::move(batch.simulationMeshOutlineTriangleIndices);
+        data.simulationMeshOutlineVertexPositions = std::move(batch.simulationMeshOutlineVertexPositions);
+    }
+}
+
+void encodeStressTrajectoriesBinary(
+        const StressTrajectoriesMemoryData& data, Json::Value& header, std::vector<std::string>& frames) {
+    const bool hasBands = !data.bandPointsUnsmoothedListLeftPs.empty();
+    header = Json::Value(Json::objectValue);
+    header["format"] = STRESS_TRAJECTORIES_BINARY_FORMAT_NAME;
+    header["formatVersion"] = STRESS_TRAJECTORIES_BINARY_FORMAT_VERSION;
+    header["meshType"] = data.meshType == MeshType::CARTESIAN ? "Cartesian" : "Unstructured";
+    header["hasBands"] = hasBands;
+    header["lineSets"] = Json::Value(Json::arrayValue);
+    frames.clear();
+
+    for (size_t lineSetIdx = 0; lineSetIdx < data.trajectoriesPs.size(); lineSetIdx++) {
+        const Trajectories& trajectories = data.trajectoriesPs.at(lineSetIdx);
+        const StressTrajectoriesData& stressTrajectoriesData = data.stressTrajectoriesDataPs.at(lineSetIdx);
+        const uint32_t numLines = uint32_t(trajectories.size());
+
+        // The attribute and hierarchy level counts are assumed to be equal for all lines of a line set.
+        uint32_t numAttributes = 8;
+        uint32_t numHierarchyLevels = 0;
+        if (numLines > 0) {
+            numAttributes = uint32_t(std::max(trajectories.front().attributes.size(), size_t(2)) - 1);
+            numHierarchyLevels = uint32_t(stressTrajectoriesData.front().hierarchyLevels.size());
+        }
+
+        std::vector<uint32_t> lineOffsets;
+        lineOffsets.reserve(numLines + 1);
+        uint32_t numPoints = 0;
+        for (const Trajectory& trajectory : trajectories) {
+            lineOffsets.push_back(numPoints);
+            numPoints += uint32_t(trajectory.positions.size());
+        }
+        lineOffsets.push_back(numPoints);
+
+        Json::Value lineSet;
+        lineSet["psIdx"] = lineSetIdx < data.loadedPsIndices.size()
+                ? data.loadedPsIndices.at(lineSetIdx) : int(lineSetIdx);
+        lineSet["numLines"] = numLines;
+        lineSet["numPoints"] = numPoints;
+        lineSet["numAttributes"] = numAttributes;
+        lineSet["numHierarchyLevels"] = numHierarchyLevels;
+        header["lineSets"].append(lineSet);
+
+        frames.emplace_back(reinterpret_cast<const char*>(lineOffsets.data()), lineOffsets.size() * sizeof(uint32_t));
+
+        frames.emplace_back(size_t(numPoints) * sizeof(glm::vec3), '\0');
+        std::string& positionFrame = frames.back();
+        for (uint32_t lineIdx = 0; lineIdx < numLines; lineIdx++) {
+            const std::vector<glm::vec3>& positions = trajectories.at(lineIdx).positions;
+            if (!positions.empty()) {
+                memcpy(
+                        &positionFrame[size_t(lineOffsets.at(lineIdx)) * sizeof(glm::vec3)], positions.data(),
+                        positions.size() * sizeof(glm::vec3));
+            }
+        }
+
+        frames.emplace_back(size_t(numAttributes) * numPoints * sizeof(float), '\0');
+        std::string& attributeFrame = frames.back();
+        for (uint32_t attributeIdx = 0; attributeIdx < numAttributes; attributeIdx++) {
+            for (uint32_t lineIdx = 0; lineIdx < numLines; lineIdx++) {
+                const std::vector<float>& attributes =
+                        trajectories.at(lineIdx).attributes.at(attributeIdx == 0 ? 0 : attributeIdx + 1);
+                if (!attributes.empty()) {
+                    memcpy(
+                            &attributeFrame[(size_t(attributeIdx) * numPoints + lineOffsets.at(lineIdx))
+                                    * sizeof(float)],
+                            attributes.data(), attributes.size() * sizeof(float));
+                }
+            }
+        }
+
+        frames.emplace_back(size_t(numLines) * numHierarchyLevels * sizeof(float), '\0');
+        std::string& hierarchyLevelFrame = frames.back();
+        for (uint32_t lineIdx = 0; lineIdx < numLines; lineIdx++) {
+            const std::vector<float>& hierarchyLevels = stressTrajectoriesData.at(lineIdx).hierarchyLevels;
+            if (hierarchyLevels.empty()) {
+                continue;
+            }
+            memcpy(
+                    &hierarchyLevelFrame[size_t(lineIdx) * numHierarchyLevels * sizeof(float)],
+                    hierarchyLevels.data(),
+                    std::min(hierarchyLevels.size(), size_t(numHierarchyLevels)) * sizeof(float));
+        }
+
+        frames.emplace_back(size_t(numLines) * sizeof(int32_t), '\0');
+        frames.emplace_back(size_t(numLines) * sizeof(glm::vec3), '\0');
+        std::string& appearanceOrderFrame = frames.at(frames.size() - 2);
+        std::string& seedPositionFrame = frames.back();
+        for (uint32_t lineIdx = 0; lineIdx < numLines; lineIdx++) {
+            const StressTrajectoryData& stressTrajectoryData = stressTrajectoriesData.at(lineIdx);
+            int32_t appearanceOrder = int32_t(stressTrajectoryData.appearanceOrder);
+            memcpy(&appearanceOrderFrame[size_t(lineIdx) * sizeof(int32_t)], &appearanceOrder, sizeof(int32_t));
+            memcpy(
+                    &seedPositionFrame[size_t(lineIdx) * sizeof(glm::vec3)], &stressTrajectoryData.seedPosition,
+                    sizeof(glm::vec3));
+        }
+
+        if (hasBands) {
+            encodeLinePointsFrame(data.bandPointsUnsmoothedListLeftPs.at(lineSetIdx), numPoints, frames);
+            encodeLinePointsFrame(data.bandPointsUnsmoothedListRightPs.at(lineSetIdx), numPoints, frames);
+            encodeLinePointsFrame(data.bandPointsSmoothedListLeftPs.at(lineSetIdx), numPoints, frames);
+            encodeLinePointsFrame(data.bandPointsSmoothedListRightPs.at(lineSetIdx), numPoints, frames);
+        }
+    }
+
+    header["numOutlineTriangleIndices"] = uint32_t(data.simulationMeshOutlineTriangleIndices.size());
+    header["numOutlineVertices"] = uint32_t(data.simulationMeshOutlineVertexPositions.size());
+    if (!data.simulationMeshOutlineTriangleIndices.empty()) {
+        frames.emplace_back(
+                reinterpret_cast<const char*>(data.simulationMeshOutlineTriangleIndices.data()),
+                data.simulationMeshOutlineTriangleIndices.size() * sizeof(uint32_t));
+        frames.emplace_back(
+                reinterpret_cast<const char*>(data.simulationMeshOutlineVertexPositions.data()),
+                data.simulationMeshOutlineVertexPositions.size() * sizeof(glm::vec3));
+    }
+}
@@ -0,0 +1,124 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef STRESSLINEVIS_STRESSTRAJECTORIESBINARYLOADER_HPP
+#define STRESSLINEVIS_STRESSTRAJECTORIESBINARYLOADER_HPP
+
+#include <json/json.h>
+
+#include "TrajectoryFile.hpp"
+
+/**
+ * Principal stress line data kept in memory instead of being loaded from a .dat file. It stores the same data as the
+ * .dat version 3 format (@see loadStressTrajectoriesFromDat_v3) before any normalization was applied.
+ */
+struct StressTrajectoriesMemoryData {
+    std::vector<int> loadedPsIndices;
+    MeshType meshType = MeshType::CARTESIAN;
+    std::vector<Trajectories> trajectoriesPs;
+    std::vector<StressTrajectoriesData> stressTrajectoriesDataPs;
+    std::vector<std::vector<std::vector<glm::vec3>>> bandPointsUnsmoothedListLeftPs;
+    std::vector<std::vector<std::vector<glm::vec3>>> bandPointsUnsmoothedListRightPs;
+    std::vector<std::vector<std::vector<glm::vec3>>> bandPointsSmoothedListLeftPs;
+    std::vector<std::vector<std::vector<glm::vec3>>> bandPointsSmoothedListRightPs;
+    std::vector<uint32_t> simulationMeshOutlineTriangleIndices;
+    std::vector<glm::vec3> simulationMeshOutlineVertexPositions;
+};
+
+/// A view on the memory of one binary message frame (e.g., the data of a received ZeroMQ message part).
+struct StressTrajectoriesBinaryFrame {
+    const void* data;
+    size_t size;
+};
+
+/**
+ * The binary message format consists of a JSON header (the first message part) and a list of binary frames.
+ * All binary data is stored in little endian byte order without padding. The header has the following layout.
+ * {
+ *     "format": "psl-binary", "formatVersion": 1, "meshType": "Cartesian" | "Unstructured",
+ *     "hasBands": true | false,
+ *     "lineSets": [ { "psIdx": 0-2, "numLines": n, "numPoints": p, "numAttributes": 8, "numHierarchyLevels": h },
+ *                   ... ],
+ *     "numOutlineTriangleIndices": i, "numOutlineVertices": v
+ * }
+ * For each line set, the following frames follow in this order.
+ * - uint32 lineOffsets[n + 1]: The index of the first point of each line (the last entry is p).
+ * - float32 positions[p * 3]
+ * - float32 attributes[numAttributes * p]: Principal stress, von Mises stress, normal stress (xx, yy, zz) and shear
+ *   stress (yz, zx, xy), stored attribute by attribute like in the .dat version 3 format. The principal stress
+ *   magnitude is not transferred and is recomputed while decoding.
+ * - float32 hierarchyLevels[n * h]
+ * - int32 appearanceOrders[n] (starting at zero)
+ * - float32 seedPositions[n * 3]
+ * - If hasBands is true: float32 bandPoints[p * 3] for the unsmoothed left, unsmoothed right, smoothed left and
+ *   smoothed right band strands (four frames).
+ * Finally, if i > 0, uint32 outlineTriangleIndices[i] and float32 outlineVertexPositions[v * 3] follow.
+ *
+ * The lines may also be streamed as multiple messages. In this case, all messages but the last one have the header
+ * entry "partial": true. The complete data is the concatenation of the lines of all messages in the order they were
+ * sent (@see appendStressTrajectoriesMemoryData).
+ */
+const char* const STRESS_TRAJECTORIES_BINARY_FORMAT_NAME = "psl-binary";
+const int STRESS_TRAJECTORIES_BINARY_FORMAT_VERSION = 1;
+
+/**
+ * @param header The JSON header of a message.
+ * @return Whether the header describes a binary stress line message (@see decodeStressTrajectoriesBinary).
+ */
+bool getIsStressTrajectoriesBinaryHeader(const Json::Value& header);
+
+/**
+ * Decodes principal stress lines from a binary message. The data is copied directly from the frames into the line data
+ * without any intermediate representation.
+ * @param header The JSON header of the message.
+ * @param frames The binary frames following the header.
+ * @param data The decoded data (output).
+ * @return Whether the message could be decoded. If false is returned, an error was written to the log file.
+ */
+bool decodeStressTrajectoriesBinary(
+        const Json::Value& header, const std::vector<StressTrajectoriesBinaryFrame>& frames,
+        StressTrajectoriesMemoryData& data);
+
+/**
+ * Appends the lines of a partial result to the lines received so far. Line sets with the same principal stress
+ * direction are concatenated. The data of the batch is moved and afterwards left in an unspecified state.
+ * @param data The lines received so far.
+ * @param batch The lines of the new partial result.
+ */
+void appendStressTrajectoriesMemoryData(StressTrajectoriesMemoryData& data, StressTrajectoriesMemoryData& batch);
+
+/**
+ * Encodes principal stress lines as a binary message (the inverse of @see decodeStressTrajectoriesBinary).
+ * @param data The data to encode.
+ * @param header The JSON header of the message (output).
+ * @param frames The binary frames following the header (output).
+ */
+void encodeStressTrajectoriesBinary(
+        const StressTrajectoriesMemoryData& data, Json::Value& header, std::vector<std::string>& frames);
+
+#endif //STRESSLINEVIS_STRESSTRAJECTORIESBINARYLOADER_HPP
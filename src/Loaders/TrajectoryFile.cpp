@@ -456,57 +456,86 @@ void loadStressTrajectoriesFromFile(
         sgl::Logfile::get()->writeError("ERROR in loadStressTrajectoriesFromFile: Unknown file extension.");
     }
 
+    normalizeStressTrajectoriesPs(
+            version >= 2, trajectoriesPs,
+            bandPointsUnsmoothedListLeftPs, bandPointsUnsmoothedListRightPs,
+            bandPointsSmoothedListLeftPs, bandPointsSmoothedListRightPs,
+            normalizeVertexPositions, normalizeAttributes, oldAABB, vertexTransformationMatrixPtr);
+}
+
+void normalizeStressTrajectoriesPs(
+        bool hasBandPoints, std::vector<Trajectories>& trajectoriesPs,
+        std::vector<std::vector<std::vector<glm::vec3>>>& bandPointsUnsmoothedListLeftPs,
+        std::vector<std::vector<std::vector<glm::vec3>>>& bandPointsUnsmoothedListRightPs,
+        std::vector<std::vector<std::vector<glm::vec3>>>& bandPointsSmoothedListLeftPs,
+        std::vector<std::vector<std::vector<glm::vec3>>>& bandPointsSmoothedListRightPs,
+        bool normalizeVertexPositions, bool normalizeAttributes,
+        sgl::AABB3* oldAABB, const glm::mat4* vertexTransformationMatrixPtr) {
     if (normalizeVertexPositions) {
         sgl::AABB3 aabb = computeTrajectoriesPsAABB3(trajectoriesPs);
         if (oldAABB) {
             *oldAABB = aabb;
         }
-        if (version >= 2) {
-            normalizeTrajectoriesPsVertexPositions(
-                    trajectoriesPs, bandPointsUnsmoothedListLeftPs, bandPointsUnsmoothedListRightPs,
-                    bandPointsSmoothedListLeftPs, bandPointsSmoothedListRightPs, aabb, vertexTransformationMatrixPtr);
-
-            for (size_t psIdx = 0; psIdx < trajectoriesPs.size(); psIdx++) {
-                Trajectories& trajectories = trajectoriesPs.at(psIdx);
-                std::vector<std::vector<glm::vec3>>& bandPointsUnsmoothedListLeft = bandPointsUnsmoothedListLeftPs.at(psIdx);
-                std::vector<std::vector<glm::vec3>>& bandPointsUnsmoothedListRight = bandPointsUnsmoothedListRightPs.at(psIdx);
-                std::vector<std::vector<glm::vec3>>& bandPointsSmoothedListLeft = bandPointsSmoothedListLeftPs.at(psIdx);
-                std::vector<std::vector<glm::vec3>>& bandPointsSmoothedListRight = bandPointsSmoothedListRightPs.at(psIdx);
-
-                for (size_t trajectoryIdx = 0; trajectoryIdx < trajectories.size(); trajectoryIdx++) {
-                    Trajectory& trajectory = trajectories.at(trajectoryIdx);
-                    std::vector<glm::vec3>& bandPointsUnsmoothedLeft = bandPointsUnsmoothedListLeft.at(trajectoryIdx);
-                    std::vector<glm::vec3>& bandPointsUnsmoothedRight = bandPointsUnsmoothedListRight.at(trajectoryIdx);
-                    std::vector<glm::vec3>& bandPointsSmoothedLeft = bandPointsSmoothedListLeft.at(trajectoryIdx);
-                    std::vector<glm::vec3>& bandPointsSmoothedRight = bandPointsSmoothedListRight.at(trajectoryIdx);
-                    for (size_t linePos = 0; linePos < trajectory.positions.size(); linePos++) {
-                        glm::vec3& trajectoryPoint = trajectory.positions.at(linePos);
-
-                        glm::vec3& bandPointUnsmoothedLeft = bandPointsUnsmoothedLeft.at(linePos);
-                        glm::vec3& bandPointUnsmoothedRight = bandPointsUnsmoothedRight.at(linePos);
-                        bandPointUnsmoothedLeft = bandPointUnsmoothedLeft - trajectoryPoint;
-                        bandPointUnsmoothedRight = bandPointUnsmoothedRight - trajectoryPoint;
-                        bandPointUnsmoothedLeft /= 0.005f;
-                        bandPointUnsmoothedRight /= 0.005f;
-
-                        glm::vec3& bandPointSmoothedLeft = bandPointsSmoothedLeft.at(linePos);
-                        glm::vec3& bandPointSmoothedRight = bandPointsSmoothedRight.at(linePos);
-                        bandPointSmoothedLeft = bandPointSmoothedLeft - trajectoryPoint;
-                        bandPointSmoothedRight = bandPointSmoothedRight - trajectoryPoint;
-                        bandPointSmoothedLeft /= 0.005f;
-                        bandPointSmoothedRight /= 0.005f;
-                    }
-                }
-            }
-        } else {
-            normalizeTrajectoriesPsVertexPositions(trajectoriesPs, aabb, vertexTransformationMatrixPtr);
-        }
+        normalizeStressTrajectoriesPs(
+                hasBandPoints, trajectoriesPs,
+                bandPointsUnsmoothedListLeftPs, bandPointsUnsmoothedListRightPs,
+                bandPointsSmoothedListLeftPs, bandPointsSmoothedListRightPs,
+                aabb, vertexTransformationMatrixPtr);
     }
     if (normalizeAttributes) {
         normalizeTrajectoriesPsVertexAttributes_PerPs(trajectoriesPs);
     }
 }
 
+void normalizeStressTrajectoriesPs(
+        bool hasBandPoints, std::vector<Trajectories>& trajectoriesPs,
+        std::vector<std::vector<std::vector<glm::vec3>>>& bandPointsUnsmoothedListLeftPs,
+        std::vector<std::vector<std::vector<glm::vec3>>>& bandPointsUnsmoothedListRightPs,
+        std::vector<std::vector<std::vector<glm::vec3>>>& bandPointsSmoothedListLeftPs,
+        std::vector<std::vector<std::vector<glm::vec3>>>& bandPointsSmoothedListRightPs,
+        const sgl::AABB3& aabb, const glm::mat4* vertexTransformationMatrixPtr) {
+    if (hasBandPoints) {
+        normalizeTrajectoriesPsVertexPositions(
+                trajectoriesPs, bandPointsUnsmoothedListLeftPs, bandPointsUnsmoothedListRightPs,
+                bandPointsSmoothedListLeftPs, bandPointsSmoothedListRightPs, aabb, vertexTransformationMatrixPtr);
+
+        for (size_t psIdx = 0; psIdx < trajectoriesPs.size(); psIdx++) {
+            Trajectories& trajectories = trajectoriesPs.at(psIdx);
+            std::vector<std::vector<glm::vec3>>& bandPointsUnsmoothedListLeft = bandPointsUnsmoothedListLeftPs.at(psIdx);
+            std::vector<std::vector<glm::vec3>>& bandPointsUnsmoothedListRight = bandPointsUnsmoothedListRightPs.at(psIdx);
+            std::vector<std::vector<glm::vec3>>& bandPointsSmoothedListLeft = bandPointsSmoothedListLeftPs.at(psIdx);
+            std::vector<std::vector<glm::vec3>>& bandPointsSmoothedListRight = bandPointsSmoothedListRightPs.at(psIdx);
+
+            for (size_t trajectoryIdx = 0; trajectoryIdx < trajectories.size(); trajectoryIdx++) {
+                Trajectory& trajectory = trajectories.at(trajectoryIdx);
+                std::vector<glm::vec3>& bandPointsUnsmoothedLeft = bandPointsUnsmoothedListLeft.at(trajectoryIdx);
+                std::vector<glm::vec3>& bandPointsUnsmoothedRight = bandPointsUnsmoothedListRight.at(trajectoryIdx);
+                std::vector<glm::vec3>& bandPointsSmoothedLeft = bandPointsSmoothedListLeft.at(trajectoryIdx);
+                std::vector<glm::vec3>& bandPointsSmoothedRight = bandPointsSmoothedListRight.at(trajectoryIdx);
+                for (size_t linePos = 0; linePos < trajectory.positions.size(); linePos++) {
+                    glm::vec3& trajectoryPoint = trajectory.positions.at(linePos);
+
+                    glm::vec3& bandPointUnsmoothedLeft = bandPointsUnsmoothedLeft.at(linePos);
+                    glm::vec3& bandPointUnsmoothedRight = bandPointsUnsmoothedRight.at(linePos);
+                    bandPointUnsmoothedLeft = bandPointUnsmoothedLeft - trajectoryPoint;
+                    bandPointUnsmoothedRight = bandPointUnsmoothedRight - trajectoryPoint;
+                    bandPointUnsmoothedLeft /= 0.005f;
+                    bandPointUnsmoothedRight /= 0.005f;
+
+                    glm::vec3& bandPointSmoothedLeft = bandPointsSmoothedLeft.at(linePos);
+                    glm::vec3& bandPointSmoothedRight = bandPointsSmoothedRight.at(linePos);
+                    bandPointSmoothedLeft = bandPointSmoothedLeft - trajectoryPoint;
+                    bandPointSmoothedRight = bandPointSmoothedRight - trajectoryPoint;
+                    bandPointSmoothedLeft /= 0.005f;
+                    bandPointSmoothedRight /= 0.005f;
+                }
+            }
+        }
+    } else {
+        normalizeTrajectoriesPsVertexPositions(trajectoriesPs, aabb, vertexTransformationMatrixPtr);
+    }
+}
+
 Trajectories loadTrajectoriesFromObj(const std::string& filename,  std::vector<std::string>& attributeNames) {
     Trajectories trajectories;
 
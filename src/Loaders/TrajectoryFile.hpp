@@ -139,6 +139,35 @@ void loadStressTrajectoriesFromFile(
         bool normalizeVertexPositions = true, bool normalizeAttributes = false,
         sgl::AABB3* oldAABB = nullptr, const glm::mat4* vertexTransformationMatrixPtr = nullptr);
 
+/**
+ * Normalizes principal stress trajectories after loading like @see loadStressTrajectoriesFromFile. If band points are
+ * available, they are normalized together with the trajectories and afterwards stored relative to their line point.
+ * @param hasBandPoints Whether the band point lists are filled (.dat version >= 2).
+ * @param normalizeVertexPositions Whether to normalize the vertex positions.
+ * @param normalizeAttributes Whether to normalize the list of attributes to the range [0,1].
+ * @param oldAABB The old AABB before normalization is stored in the pointer (optional, can be nullptr).
+ * @param vertexTransformationMatrixPtr Can be used to pass a transformation matrix for the vertex positions (optional).
+ */
+void normalizeStressTrajectoriesPs(
+        bool hasBandPoints, std::vector<Trajectories>& trajectoriesPs,
+        std::vector<std::vector<std::vector<glm::vec3>>>& bandPointsUnsmoothedListLeftPs,
+        std::vector<std::vector<std::vector<glm::vec3>>>& bandPointsUnsmoothedListRightPs,
+        std::vector<std::vector<std::vector<glm::vec3>>>& bandPointsSmoothedListLeftPs,
+        std::vector<std::vector<std::vector<glm::vec3>>>& bandPointsSmoothedListRightPs,
+        bool normalizeVertexPositions = true, bool normalizeAttributes = false,
+        sgl::AABB3* oldAABB = nullptr, const glm::mat4* vertexTransformationMatrixPtr = nullptr);
+/**
+ * Same as above, but the vertex positions are normalized using the passed AABB instead of the AABB of the passed
+ * trajectories (e.g., for appending lines to trajectories normalized before).
+ */
+void normalizeStressTrajectoriesPs(
+        bool hasBandPoints, std::vector<Trajectories>& trajectoriesPs,
+        std::vector<std::vector<std::vector<glm::vec3>>>& bandPointsUnsmoothedListLeftPs,
+        std::vector<std::vector<std::vector<glm::vec3>>>& bandPointsUnsmoothedListRightPs,
+        std::vector<std::vector<std::vector<glm::vec3>>>& bandPointsSmoothedListLeftPs,
+        std::vector<std::vector<std::vector<glm::vec3>>>& bandPointsSmoothedListRightPs,
+        const sgl::AABB3& aabb, const glm::mat4* vertexTransformationMatrixPtr = nullptr);
+
 Trajectories loadTrajectoriesFromObj(const std::string& filename, std::vector<std::string>& attributeNames);
 
 Trajectories loadTrajectoriesFromNetCdf(const std::string& filename);
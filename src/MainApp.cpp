@@ -292,6 +292,9 @@ MainApp::MainApp(bool supportsRaytracing)
                 [this](const InternalState &newState) { this->setNewState(newState); });
         performanceMeasurer->setInitialFreeMemKilobytes(gpuInitialFreeMemKilobytes);
     }
+
+    // Measurements should not include frames where the data is still being uploaded.
+    streamingBufferUploader.setIsEnabled(!usePerformanceMeasurementMode);
 }
 
 MainApp::~MainApp() {
@@ -468,7 +471,11 @@ void MainApp::updateColorSpaceMode() {
 
 void MainApp::render() {
     SciVisApp::preRender();
+    if (lineData) {
+        lineData->setViewportHeight(sgl::AppSettings::get()->getMainWindow()->getHeight());
+    }
     prepareVisualizationPipeline();
+    streamingBufferUploader.update();
 
     if (lineRenderer != nullptr) {
         reRender = reRender || lineRenderer->needsReRender();
@@ -484,8 +491,17 @@ void MainApp::render() {
 
         SciVisApp::prepareReRender();
 
+        // Lines are only rendered when their render data was uploaded completely. Until then, the previous render
+        // data is drawn (if the renderer supports it; @see LineRenderer::keepPreviousRenderData).
         if (lineData.get() != nullptr && lineRenderer != nullptr) {
-            lineRenderer->render();
+            if (!streamingBufferUploader.getIsUploading()) {
+                lineRenderer->render();
+                if (stressLineTracerLoadedTimeStamp != 0) {
+                    logStressLineTracerLatency();
+                }
+            } else if (lineRenderer->getHasPreviousRenderData()) {
+                lineRenderer->renderPreviousRenderData();
+            }
         }
 
         if (renderingMode != RENDERING_MODE_PER_PIXEL_LINKED_LIST && usePerformanceMeasurementMode) {
@@ -608,6 +624,14 @@ void MainApp::renderGui() {
     }
     lineRenderer->renderGuiWindow();
 
+    if (hasPickedLine && lineData) {
+        lineData->renderGuiPickedLineTooltip(pickedLine);
+    }
+    if (hasProbedStressTensor && lineData && lineData->getType() == DATA_SET_TYPE_STRESS_LINES) {
+        LineDataStress* lineDataStress = static_cast<LineDataStress*>(lineData.get());
+        lineDataStress->renderGuiStressTensorProbeTooltip(probedStressTensor);
+    }
+
     sgl::ImGuiWrapper::get()->renderEnd();
 }
 
@@ -681,6 +705,10 @@ void MainApp::renderSceneSettingsGui() {
 
     SciVisApp::renderSceneSettingsGuiPre();
     ImGui::Checkbox("Show Transfer Function Window", &transferFunctionWindow.getShowTransferFunctionWindow());
+    ImGui::Checkbox("Show Line Information on Hover", &useLinePicking);
+    if (lineData && lineData->getType() == DATA_SET_TYPE_STRESS_LINES) {
+        ImGui::Checkbox("Probe Stress Tensor on Hover", &useStressTensorProbe);
+    }
     if (lineData && lineData->getType() == DATA_SET_TYPE_STRESS_LINES && renderingMode == RENDERING_MODE_ALL_LINES_OPAQUE) {
         if (ImGui::Checkbox("Visualize Seeding Process", &visualizeSeedingProcess)) {
             LineDataStress* lineDataStress = static_cast<LineDataStress*>(lineData.get());
@@ -702,6 +730,55 @@ void MainApp::renderSceneSettingsGui() {
     SciVisApp::renderSceneSettingsGuiPost();
 }
 
+void MainApp::computeMouseRay(glm::vec3& rayOrigin, glm::vec3& rayDirection) {
+    sgl::Window* window = sgl::AppSettings::get()->getMainWindow();
+    int width = window->getWidth();
+    int height = window->getHeight();
+
+    // Unproject the mouse position on the near and far plane to get the ray through the cursor.
+    ImVec2 mousePosition = ImGui::GetMousePos();
+    glm::vec2 mousePositionNdc(
+            2.0f * mousePosition.x / float(width) - 1.0f, 1.0f - 2.0f * mousePosition.y / float(height));
+    glm::mat4 inverseViewProjectionMatrix = glm::inverse(camera->getProjectionMatrix() * camera->getViewMatrix());
+    glm::vec4 nearPoint = inverseViewProjectionMatrix * glm::vec4(mousePositionNdc, -1.0f, 1.0f);
+    glm::vec4 farPoint = inverseViewProjectionMatrix * glm::vec4(mousePositionNdc, 1.0f, 1.0f);
+    rayOrigin = glm::vec3(nearPoint) / nearPoint.w;
+    rayDirection = glm::normalize(glm::vec3(farPoint) / farPoint.w - rayOrigin);
+}
+
+void MainApp::pickLineAtMousePosition() {
+    if (!lineData || !lineRenderer) {
+        return;
+    }
+    sgl::Window* window = sgl::AppSettings::get()->getMainWindow();
+    if (window->getWidth() <= 0 || window->getHeight() <= 0) {
+        return;
+    }
+    glm::vec3 rayOrigin, rayDirection;
+    computeMouseRay(rayOrigin, rayDirection);
+
+    // Bands are approximated by tubes with the band width as diameter.
+    float lineRadius = 0.5f * (lineData->useBands() ? LineRenderer::getBandWidth() : LineRenderer::getLineWidth());
+    hasPickedLine = lineData->pickLine(rayOrigin, rayDirection, lineRadius, pickedLine);
+}
+
+void MainApp::probeStressTensorAtMousePosition() {
+    if (!lineData || lineData->getType() != DATA_SET_TYPE_STRESS_LINES) {
+        return;
+    }
+    sgl::Window* window = sgl::AppSettings::get()->getMainWindow();
+    if (window->getWidth() <= 0 || window->getHeight() <= 0) {
+        return;
+    }
+    glm::vec3 rayOrigin, rayDirection;
+    computeMouseRay(rayOrigin, rayDirection);
+
+    // Probe at the picked line if there is one. Otherwise, probe where the ray enters the simulation mesh.
+    LineDataStress* lineDataStress = static_cast<LineDataStress*>(lineData.get());
+    hasProbedStressTensor = lineDataStress->probeStressTensor(
+            rayOrigin, rayDirection, hasPickedLine ? &pickedLine.hitPosition : nullptr, probedStressTensor);
+}
+
 void MainApp::update(float dt) {
     sgl::SciVisApp::update(dt);
 
@@ -797,7 +874,35 @@ void MainApp::update(float dt) {
 
     if (stressLineTracingRequester->getHasNewData(stressLineTracerDataSetInformation)) {
         dataSetType = stressLineTracerDataSetInformation.type;
-        loadLineDataSet(stressLineTracerDataSetInformation.filenames);
+        stressLineTracerReplyTimeStamp = sgl::Timer->getTicksMicroseconds();
+        stressLineTracerLoadedTimeStamp = 0;
+        stressLineTracerReplyLatencyMs = stressLineTracingRequester->getLastReplyLatencyMs();
+        const bool isReplyPartial = stressLineTracingRequester->getLastReplyIsPartial();
+        LineDataPtr streamedLineData = stressLineTracerStreamedLineData.lock();
+        if (stressLineTracingRequester->getLastReplyContinuesStream() && streamedLineData
+                && streamedLineData == lineData && stressLineTracerDataSetInformation.stressTrajectoriesMemoryData) {
+            // Further batches of a streamed reply only contain the new lines.
+            auto* lineDataStress = static_cast<LineDataStress*>(lineData.get());
+            lineDataStress->appendStreamedLines(*stressLineTracerDataSetInformation.stressTrajectoriesMemoryData);
+            if (!isReplyPartial) {
+                lineData->recomputeHistogram();
+            }
+            stressLineTracerLoadedTimeStamp = sgl::Timer->getTicksMicroseconds();
+            stressLineTracerRebuildTimeMicroseconds = 0;
+        } else {
+            // The first batch of a streamed reply is loaded synchronously, as the next batches are appended to it.
+            LineDataPtr oldLineData = lineData;
+            loadLineDataSet(stressLineTracerDataSetInformation.filenames, isReplyPartial);
+            stressLineTracerStreamedLineData.reset();
+            if (isReplyPartial && lineData != oldLineData) {
+                stressLineTracerStreamedLineData = lineData;
+                stressLineTracerLoadedTimeStamp = sgl::Timer->getTicksMicroseconds();
+                stressLineTracerRebuildTimeMicroseconds = 0;
+            }
+        }
+        if (!isReplyPartial) {
+            stressLineTracerStreamedLineData.reset();
+        }
     }
     checkLoadingRequestFinished();
 
@@ -806,6 +911,8 @@ void MainApp::update(float dt) {
         lineData->update(dt);
     }
 
+    hasPickedLine = false;
+    hasProbedStressTensor = false;
     ImGuiIO &io = ImGui::GetIO();
     if (io.WantCaptureKeyboard && !recording) {
         // Ignore inputs below
@@ -823,6 +930,12 @@ void MainApp::update(float dt) {
     }
 
     moveCameraMouse(dt);
+    if (useLinePicking) {
+        pickLineAtMousePosition();
+    }
+    if (useStressTensorProbe) {
+        probeStressTensorAtMousePosition();
+    }
 
     if (lineRenderer != nullptr) {
         lineRenderer->update(dt);
@@ -897,6 +1010,7 @@ void MainApp::loadLineDataSet(const std::vector<std::string>& fileNames, bool bl
             lineData->setUseLinearRGB(useLinearRGB);
             lineData->setRenderingMode(renderingMode);
             lineData->setLineRenderer(lineRenderer);
+            lineData->setStreamingBufferUploader(&streamingBufferUploader);
             newMeshLoaded = true;
             modelBoundingBox = lineData->getModelBoundingBox();
 
@@ -936,6 +1050,10 @@ void MainApp::checkLoadingRequestFinished() {
     LineDataPtr lineData = lineDataRequester.getLoadedData(loadedDataSetInformation);
 
     if (lineData) {
+        if (stressLineTracerReplyTimeStamp != 0) {
+            stressLineTracerLoadedTimeStamp = sgl::Timer->getTicksMicroseconds();
+            stressLineTracerRebuildTimeMicroseconds = 0;
+        }
         if (loadedDataSetInformation.hasCustomLineWidth) {
             LineRenderer::setLineWidth(loadedDataSetInformation.lineWidth);
         }
@@ -947,6 +1065,7 @@ void MainApp::checkLoadingRequestFinished() {
         lineData->setUseLinearRGB(useLinearRGB);
         lineData->setRenderingMode(renderingMode);
         lineData->setLineRenderer(lineRenderer);
+        lineData->setStreamingBufferUploader(&streamingBufferUploader);
         newMeshLoaded = true;
         modelBoundingBox = lineData->getModelBoundingBox();
 
@@ -978,6 +1097,21 @@ void MainApp::checkLoadingRequestFinished() {
     }
 }
 
+void MainApp::logStressLineTracerLatency() {
+    // The reply latency covers tracing, serialization, transport and decoding (logged by the requester).
+    const uint64_t displayedTimeStamp = sgl::Timer->getTicksMicroseconds();
+    const double loadingMs = double(stressLineTracerLoadedTimeStamp - stressLineTracerReplyTimeStamp) * 1e-3;
+    const double rebuildMs = double(stressLineTracerRebuildTimeMicroseconds) * 1e-3;
+    const double totalMs =
+            stressLineTracerReplyLatencyMs + double(displayedTimeStamp - stressLineTracerReplyTimeStamp) * 1e-3;
+    sgl::Logfile::get()->writeInfo(
+            "Stress line tracing: request-to-displayed latency " + std::to_string(totalMs) + "ms (reply "
+            + std::to_string(stressLineTracerReplyLatencyMs) + "ms, loading " + std::to_string(loadingMs)
+            + "ms, render data rebuild " + std::to_string(rebuildMs) + "ms)");
+    stressLineTracerReplyTimeStamp = 0;
+    stressLineTracerLoadedTimeStamp = 0;
+}
+
 void MainApp::reloadDataSet() {
     loadLineDataSet(getSelectedMeshFilenames());
 }
@@ -987,7 +1121,23 @@ void MainApp::prepareVisualizationPipeline() {
         bool isPreviousNodeDirty = lineData->isDirty();
         filterData(isPreviousNodeDirty);
         if (lineRenderer->isDirty() || isPreviousNodeDirty) {
+            // If the last render data is still uploaded, the render data kept before that one stays the previous one.
+            if (!streamingBufferUploader.getIsUploading()) {
+                lineRenderer->keepPreviousRenderData(lineData);
+            }
+            uint64_t rebuildStartTimeStamp = sgl::Timer->getTicksMicroseconds();
             lineRenderer->setLineData(lineData, newMeshLoaded);
+            if (stressLineTracerLoadedTimeStamp != 0) {
+                stressLineTracerRebuildTimeMicroseconds +=
+                        sgl::Timer->getTicksMicroseconds() - rebuildStartTimeStamp;
+            }
+            streamingBufferUploader.addCompletionCallback([this]() {
+                // Later rebuilds may still be uploaded.
+                if (lineRenderer && !streamingBufferUploader.getIsUploading()) {
+                    lineRenderer->releasePreviousRenderData();
+                }
+                reRender = true;
+            });
         }
     }
     newMeshLoaded = false;
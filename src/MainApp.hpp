@@ -42,7 +42,9 @@
 #include "LineData/LineDataRequester.hpp"
 #include "LineData/Filters/LineFilter.hpp"
 #include "LineData/Stress/StressLineTracingRequester.hpp"
+#include "LineData/Stress/StressTensorProbe.hpp"
 #include "Renderers/SceneData.hpp"
+#include "Renderers/Helpers/StreamingBufferUploader.hpp"
 
 #ifdef USE_PYTHON
 #include "Widgets/ReplayWidget.hpp"
@@ -95,6 +97,18 @@ private:
     std::string customDataSetFileName;
     DataSetType dataSetType = DATA_SET_TYPE_NONE;
     bool visualizeSeedingProcess = false; ///< Only for stress line data.
+
+    // Shows information about the line under the mouse cursor (@see LineData::pickLine).
+    void computeMouseRay(glm::vec3& rayOrigin, glm::vec3& rayDirection);
+    void pickLineAtMousePosition();
+    bool useLinePicking = false;
+    bool hasPickedLine = false;
+    LinePickingResult pickedLine;
+    // Shows the stress tensor under the mouse cursor (@see LineDataStress::probeStressTensor).
+    void probeStressTensorAtMousePosition();
+    bool useStressTensorProbe = false;
+    bool hasProbedStressTensor = false;
+    StressTensorProbeResult probedStressTensor;
     const float TIME_PER_SEED_POINT = 0.5f;
 
     // Coloring & filtering dependent on importance criteria.
@@ -121,6 +135,8 @@ private:
     void loadLineDataSet(const std::vector<std::string>& fileName, bool blockingDataLoading = false);
     /// Checks if an asynchronous loading request was finished.
     void checkLoadingRequestFinished();
+    /// Logs the time from a stress line tracing request until its lines were displayed.
+    void logStressLineTracerLatency();
     /// Reload the currently loaded data set.
     void reloadDataSet() override;
     /// Prepares the visualization pipeline for rendering.
@@ -135,12 +151,21 @@ private:
 
     LineRenderer* lineRenderer = nullptr;
     LineDataPtr lineData;
+    /// Uploads large render data over multiple frames to avoid stalling the UI.
+    StreamingBufferUploader streamingBufferUploader;
     LineDataRequester lineDataRequester;
     bool newMeshLoaded = true;
     sgl::AABB3 modelBoundingBox;
     void* zeromqContext = nullptr;
     StressLineTracingRequester* stressLineTracingRequester;
     DataSetInformation stressLineTracerDataSetInformation;
+    /// The data loaded from the first batch of a streamed reply, which the further batches are appended to.
+    std::weak_ptr<LineData> stressLineTracerStreamedLineData;
+    // Latency measurement for the newest reply of the stress line tracer (time stamps in microseconds, 0 if unused).
+    uint64_t stressLineTracerReplyTimeStamp = 0;
+    uint64_t stressLineTracerLoadedTimeStamp = 0;
+    uint64_t stressLineTracerRebuildTimeMicroseconds = 0;
+    double stressLineTracerReplyLatencyMs = 0.0;
     bool supportsRaytracing = false;
 };
 
@@ -0,0 +1,194 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cstring>
+
+#include <Graphics/Renderer.hpp>
+#include <Graphics/OpenGL/GeometryBuffer.hpp>
+#include <Utils/File/Logfile.hpp>
+
+#include "StreamingBufferUploader.hpp"
+
+StreamingBufferUploader::StreamingBufferUploader(
+        size_t numStagingBuffers, size_t stagingBufferSize, size_t frameBudget)
+        : stagingBufferSize(stagingBufferSize), frameBudget(frameBudget) {
+    stagingBuffers.resize(std::max(numStagingBuffers, size_t(1)));
+    stagingBufferFences.resize(stagingBuffers.size(), nullptr);
+}
+
+StreamingBufferUploader::~StreamingBufferUploader() {
+    for (GLsync& fence : stagingBufferFences) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+}
+
+sgl::GeometryBufferPtr StreamingBufferUploader::createGeometryBuffer(
+        size_t size, const void* data, sgl::BufferType bufferType) {
+    if (!getShallStream(size)) {
+        return createGeometryBufferInternal(size, data, std::shared_ptr<void>(), bufferType);
+    }
+    std::shared_ptr<std::vector<uint8_t>> dataOwner(new std::vector<uint8_t>(size));
+    memcpy(dataOwner->data(), data, size);
+    return createGeometryBufferInternal(size, dataOwner->data(), dataOwner, bufferType);
+}
+
+sgl::GeometryBufferPtr StreamingBufferUploader::createGeometryBufferInternal(
+        size_t size, const void* data, std::shared_ptr<void> dataOwner, sgl::BufferType bufferType) {
+    if (!getShallStream(size)) {
+        return sgl::Renderer->createGeometryBuffer(size, const_cast<void*>(data), bufferType);
+    }
+
+    // Only allocate the storage now. The data is filled in chunks in @see update.
+    sgl::GeometryBufferPtr buffer = sgl::Renderer->createGeometryBuffer(size, bufferType, sgl::BUFFER_STATIC);
+    UploadJob uploadJob;
+    uploadJob.buffer = buffer;
+    uploadJob.dataOwner = dataOwner;
+    uploadJob.data = static_cast<const uint8_t*>(data);
+    uploadJob.size = size;
+    uploadJobs.push_back(uploadJob);
+    numBytesPending += size;
+    return buffer;
+}
+
+void StreamingBufferUploader::addCompletionCallback(std::function<void()> callback) {
+    if (uploadJobs.empty()) {
+        callback();
+        return;
+    }
+    UploadJob completionMarker;
+    completionMarker.completionCallback = callback;
+    uploadJobs.push_back(completionMarker);
+}
+
+void StreamingBufferUploader::processCompletionMarkers() {
+    while (!uploadJobs.empty()) {
+        UploadJob& uploadJob = uploadJobs.front();
+        if (uploadJob.completionCallback) {
+            std::function<void()> callback = uploadJob.completionCallback;
+            uploadJobs.pop_front();
+            callback();
+        } else if (uploadJob.buffer.expired()) {
+            // The buffer is no longer used (e.g., a new data set was loaded in the meantime).
+            numBytesPending -= uploadJob.size - uploadJob.offset;
+            uploadJobs.pop_front();
+        } else {
+            break;
+        }
+    }
+}
+
+void StreamingBufferUploader::update() {
+    numBytesUploadedLastFrame = 0;
+    processCompletionMarkers();
+    while (!uploadJobs.empty() && numBytesUploadedLastFrame < frameBudget) {
+        size_t numBytesUploaded = uploadNextChunk(frameBudget - numBytesUploadedLastFrame, false);
+        if (numBytesUploaded == 0) {
+            // The GPU is still busy copying from the next staging buffer; continue in the next frame.
+            break;
+        }
+        numBytesUploadedLastFrame += numBytesUploaded;
+        processCompletionMarkers();
+    }
+}
+
+void StreamingBufferUploader::flush() {
+    processCompletionMarkers();
+    while (!uploadJobs.empty()) {
+        uploadNextChunk(stagingBufferSize, true);
+        processCompletionMarkers();
+    }
+}
+
+size_t StreamingBufferUploader::uploadNextChunk(size_t maxChunkSize, bool waitForStagingBuffer) {
+    UploadJob& uploadJob = uploadJobs.front();
+    sgl::GeometryBufferPtr buffer = uploadJob.buffer.lock();
+
+    // Wait until the GPU has finished the last copy from the staging buffer.
+    GLsync& fence = stagingBufferFences.at(nextStagingBufferIdx);
+    if (fence) {
+        GLuint64 timeout = waitForStagingBuffer ? GLuint64(1000000000) : GLuint64(0);
+        GLenum status;
+        do {
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout);
+        } while (waitForStagingBuffer && status == GL_TIMEOUT_EXPIRED);
+        if (status == GL_TIMEOUT_EXPIRED) {
+            return 0;
+        }
+        if (status == GL_WAIT_FAILED) {
+            sgl::Logfile::get()->writeError(
+                    "Error in StreamingBufferUploader::uploadNextChunk: glClientWaitSync failed.");
+        }
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    sgl::GeometryBufferPtr& stagingBuffer = stagingBuffers.at(nextStagingBufferIdx);
+    if (!stagingBuffer) {
+        stagingBuffer = sgl::Renderer->createGeometryBuffer(
+                stagingBufferSize, sgl::VERTEX_BUFFER, sgl::BUFFER_STREAM);
+    }
+    GLuint stagingBufferId = static_cast<sgl::GeometryBufferGL*>(stagingBuffer.get())->getBuffer();
+    GLuint bufferId = static_cast<sgl::GeometryBufferGL*>(buffer.get())->getBuffer();
+
+    size_t chunkSize = std::min(std::min(maxChunkSize, stagingBufferSize), uploadJob.size - uploadJob.offset);
+    const uint8_t* chunkData = uploadJob.data + uploadJob.offset;
+
+    // The GPU no longer reads from the staging buffer (see fence above), so it can be mapped unsynchronized.
+    glBindBuffer(GL_COPY_WRITE_BUFFER, stagingBufferId);
+    void* stagingMemory = glMapBufferRange(
+            GL_COPY_WRITE_BUFFER, 0, GLsizeiptr(chunkSize),
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (stagingMemory) {
+        memcpy(stagingMemory, chunkData, chunkSize);
+        glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+        glBindBuffer(GL_COPY_READ_BUFFER, stagingBufferId);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, bufferId);
+        glCopyBufferSubData(
+                GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, GLintptr(uploadJob.offset), GLsizeiptr(chunkSize));
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    } else {
+        // Fall back to a direct upload if mapping the staging buffer is not possible.
+        sgl::Logfile::get()->writeError(
+                "Error in StreamingBufferUploader::uploadNextChunk: Could not map the staging buffer.");
+        glBindBuffer(GL_COPY_WRITE_BUFFER, bufferId);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, GLintptr(uploadJob.offset), GLsizeiptr(chunkSize), chunkData);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    nextStagingBufferIdx = (nextStagingBufferIdx + 1) % stagingBuffers.size();
+
+    uploadJob.offset += chunkSize;
+    numBytesPending -= chunkSize;
+    if (uploadJob.offset == uploadJob.size) {
+        uploadJobs.pop_front();
+    }
+    return chunkSize;
+}
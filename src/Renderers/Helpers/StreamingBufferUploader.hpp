@@ -0,0 +1,144 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LINEVIS_STREAMINGBUFFERUPLOADER_HPP
+#define LINEVIS_STREAMINGBUFFERUPLOADER_HPP
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+
+#include <GL/glew.h>
+#include <Graphics/Buffers/GeometryBuffer.hpp>
+
+/**
+ * Uploads large geometry buffers in chunks over multiple frames instead of in one go. This way, loading large data
+ * sets does not stall the UI for seconds and the driver does not need to allocate a second copy of all data at once.
+ *
+ * The chunks are copied through a ring of staging buffers. A fence is inserted after each copy, and a staging buffer
+ * is only reused when the GPU has finished the copy from it. At most @see frameBudget bytes are uploaded per call of
+ * @see update. As GL commands are executed in order, all draw calls issued after the last copy of a buffer see its
+ * full content.
+ *
+ * Only core OpenGL 3.2 functionality is used (buffer mapping, buffer copies and sync objects), so the uploader also
+ * works with software implementations like Mesa's llvmpipe (e.g., LIBGL_ALWAYS_SOFTWARE=1).
+ */
+class StreamingBufferUploader {
+public:
+    /**
+     * @param numStagingBuffers The number of staging buffers in the ring.
+     * @param stagingBufferSize The size of one staging buffer (i.e., of one upload chunk) in bytes.
+     * @param frameBudget The maximum number of bytes to upload per frame.
+     */
+    explicit StreamingBufferUploader(
+            size_t numStagingBuffers = 3, size_t stagingBufferSize = 16u << 20u, size_t frameBudget = 64u << 20u);
+    ~StreamingBufferUploader();
+
+    /// Streaming can be disabled, e.g., when rendering performance measurements or videos.
+    inline void setIsEnabled(bool enabled) { isEnabled = enabled; }
+    inline bool getIsEnabled() const { return isEnabled; }
+    inline void setFrameBudget(size_t budget) { frameBudget = budget; }
+    inline size_t getFrameBudget() const { return frameBudget; }
+    /// Buffers smaller than this size are uploaded immediately.
+    inline void setMinStreamedBufferSize(size_t size) { minStreamedBufferSize = size; }
+
+    /**
+     * Creates a geometry buffer with the passed data. Large buffers are filled over the next calls of @see update;
+     * the returned buffer object is valid immediately (e.g., for querying its size or creating shader attributes).
+     * @param data The data to upload. It is moved into the uploader and released after the upload has finished.
+     * @param bufferType The type of the buffer to create.
+     */
+    template<typename T>
+    sgl::GeometryBufferPtr createGeometryBuffer(std::vector<T>&& data, sgl::BufferType bufferType) {
+        std::shared_ptr<std::vector<T>> dataOwner(new std::vector<T>(std::move(data)));
+        return createGeometryBufferInternal(
+                dataOwner->size() * sizeof(T), dataOwner->data(), dataOwner, bufferType);
+    }
+
+    /**
+     * Same as above, but the passed data is copied (if the buffer is streamed).
+     */
+    sgl::GeometryBufferPtr createGeometryBuffer(size_t size, const void* data, sgl::BufferType bufferType);
+
+    /**
+     * Adds a callback that is called as soon as all buffers created before this call have been fully uploaded.
+     * If nothing is pending, the callback is called immediately.
+     */
+    void addCompletionCallback(std::function<void()> callback);
+
+    /// Uploads pending chunks until the per-frame byte budget is used up. Needs to be called once per frame.
+    void update();
+    /// Uploads all pending data immediately.
+    void flush();
+
+    /// Whether there is still data pending for upload.
+    inline bool getIsUploading() const { return numBytesPending > 0; }
+    inline size_t getNumBytesPending() const { return numBytesPending; }
+    /// Returns the number of bytes uploaded in the last call of @see update.
+    inline size_t getNumBytesUploadedLastFrame() const { return numBytesUploadedLastFrame; }
+
+private:
+    struct UploadJob {
+        std::weak_ptr<sgl::GeometryBuffer> buffer; ///< The upload is skipped if the buffer was freed in the meantime.
+        std::shared_ptr<void> dataOwner;
+        const uint8_t* data = nullptr;
+        size_t size = 0;
+        size_t offset = 0; ///< Number of bytes already uploaded.
+        std::function<void()> completionCallback; ///< Set for completion markers (i.e., jobs without data).
+    };
+
+    inline bool getShallStream(size_t size) const {
+        return isEnabled && size > 0 && size >= minStreamedBufferSize;
+    }
+    sgl::GeometryBufferPtr createGeometryBufferInternal(
+            size_t size, const void* data, std::shared_ptr<void> dataOwner, sgl::BufferType bufferType);
+    /**
+     * Uploads at most maxChunkSize bytes of the first job in the queue.
+     * @param waitForStagingBuffer Whether to block if the next staging buffer is still in use by the GPU.
+     * @return The number of bytes uploaded (0 if the next staging buffer is still in use).
+     */
+    size_t uploadNextChunk(size_t maxChunkSize, bool waitForStagingBuffer);
+    void processCompletionMarkers();
+
+    bool isEnabled = true;
+    size_t stagingBufferSize;
+    size_t frameBudget;
+    size_t minStreamedBufferSize = 16u << 20u;
+
+    std::deque<UploadJob> uploadJobs;
+    size_t numBytesPending = 0;
+    size_t numBytesUploadedLastFrame = 0;
+
+    // Ring of staging buffers.
+    std::vector<sgl::GeometryBufferPtr> stagingBuffers;
+    std::vector<GLsync> stagingBufferFences;
+    size_t nextStagingBufferIdx = 0;
+};
+
+#endif //LINEVIS_STREAMINGBUFFERUPLOADER_HPP
@@ -27,6 +27,7 @@
  */
 
 #include <iostream>
+#include <utility>
 
 #include <Math/Geometry/MatrixUtil.hpp>
 #include <Graphics/Renderer.hpp>
@@ -49,6 +50,7 @@ void LineRenderer::initialize() {
 }
 
 LineRenderer::~LineRenderer() {
+    releasePreviousRenderData();
     if (useDepthCues) {
         sgl::ShaderManager->removePreprocessorDefine("USE_SCREEN_SPACE_POSITION");
         sgl::ShaderManager->removePreprocessorDefine("USE_DEPTH_CUES");
@@ -74,10 +76,11 @@ void LineRenderer::updateDepthCueMode() {
 }
 
 void LineRenderer::updateDepthCueGeometryData() {
-    filteredLines = lineData->getFilteredLines();
+    filteredLines = lineData->getFilteredLinesView();
     std::vector<glm::vec4> filteredLinesVertices;
-    for (std::vector<glm::vec3>& line : filteredLines) {
-        for (const glm::vec3& point : line) {
+    filteredLinesVertices.reserve(filteredLines.getNumLinePoints());
+    for (size_t lineIdx = 0; lineIdx < filteredLines.getNumLines(); lineIdx++) {
+        for (const glm::vec3& point : filteredLines.getLinePoints(lineIdx)) {
             filteredLinesVertices.push_back(glm::vec4(point.x, point.y, point.z, 1.0f));
         }
     }
@@ -149,8 +152,8 @@ void LineRenderer::setUniformData_Pass(sgl::ShaderProgramPtr shaderProgram) {
             #pragma omp parallel for default(none) shared(viewMatrix, filteredLines) \
             reduction(min: minDepth) reduction(max: maxDepth)
 #endif
-            for (size_t lineIdx = 0; lineIdx < filteredLines.size(); lineIdx++) {
-                const std::vector<glm::vec3>& line = filteredLines.at(lineIdx);
+            for (size_t lineIdx = 0; lineIdx < filteredLines.getNumLines(); lineIdx++) {
+                ArrayView<glm::vec3> line = filteredLines.getLinePoints(lineIdx);
                 for (const glm::vec3& point : line) {
                     float depth = -sgl::transformPoint(viewMatrix, point).z;
                     minDepth = std::min(minDepth, depth);
@@ -265,7 +268,52 @@ void LineRenderer::updateNewLineData(LineDataPtr& lineData, bool isNewData) {
     }
 }
 
+void LineRenderer::keepPreviousRenderData(const LineDataPtr& newLineData) {
+    releasePreviousRenderData();
+    // The gather shaders are reloaded for line data of another type (@see updateNewLineData).
+    if (doubleBufferedRenderData.empty() || !lineData || !newLineData || lineData->getType() != newLineData->getType()
+            || newLineData->settingsDiffer(lineData.get())) {
+        return;
+    }
+    previousRenderData.reserve(doubleBufferedRenderData.size());
+    for (sgl::ShaderAttributesPtr* renderData : doubleBufferedRenderData) {
+        previousRenderData.push_back(*renderData);
+    }
+    previousShaderAttributesHull = shaderAttributesHull;
+    previousLineData = lineData;
+    previousLineData->keepPreviousDrawState();
+    hasPreviousRenderData = true;
+}
+
+void LineRenderer::releasePreviousRenderData() {
+    if (previousLineData) {
+        previousLineData->releasePreviousDrawState();
+    }
+    previousRenderData.clear();
+    previousShaderAttributesHull = sgl::ShaderAttributesPtr();
+    previousLineData = LineDataPtr();
+    hasPreviousRenderData = false;
+}
+
+void LineRenderer::swapPreviousRenderData() {
+    for (size_t i = 0; i < doubleBufferedRenderData.size(); i++) {
+        std::swap(*doubleBufferedRenderData.at(i), previousRenderData.at(i));
+    }
+    std::swap(shaderAttributesHull, previousShaderAttributesHull);
+    std::swap(lineData, previousLineData);
+}
+
+void LineRenderer::renderPreviousRenderData() {
+    swapPreviousRenderData();
+    lineData->swapPreviousDrawState();
+    render();
+    lineData->swapPreviousDrawState();
+    swapPreviousRenderData();
+}
+
 void LineRenderer::reloadGatherShader(bool canCopyShaderAttributes) {
+    // The kept render data is bound to the old shaders.
+    releasePreviousRenderData();
     if (lineData && lineData->hasSimulationMeshOutline()) {
         gatherShaderHull = lineData->reloadGatherShaderHull();
         if (canCopyShaderAttributes && shaderAttributesHull) {
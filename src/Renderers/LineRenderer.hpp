@@ -66,6 +66,19 @@ public:
 
     // Renders the object to the scene framebuffer.
     virtual void render()=0;
+
+    /**
+     * Double buffering of the render data: The render data created by @see setLineData may still be uploaded over the
+     * next frames (@see StreamingBufferUploader). Renderers registering their render data
+     * (@see addDoubleBufferedRenderData) keep the current render data drawable until then.
+     * @param newLineData The line data the render data is rebuilt for next.
+     */
+    void keepPreviousRenderData(const LineDataPtr& newLineData);
+    /// Frees the render data kept by @see keepPreviousRenderData (e.g., after the new render data was uploaded).
+    void releasePreviousRenderData();
+    inline bool getHasPreviousRenderData() const { return hasPreviousRenderData; }
+    /// Renders the render data kept by @see keepPreviousRenderData to the scene framebuffer.
+    void renderPreviousRenderData();
     // Renders the GUI. The "dirty" and "reRender" flags might be set depending on the user's actions.
     virtual void renderGuiWindow();
     // Updates the internal logic (called once per frame).
@@ -87,6 +100,8 @@ public:
 
     /// Sets the global line width.
     static void setLineWidth(float lineWidth) { LineRenderer::lineWidth = lineWidth; }
+    static float getLineWidth() { return lineWidth; }
+    static float getBandWidth() { return bandWidth; }
 
 protected:
     // Reload the gather shader.
@@ -98,6 +113,17 @@ protected:
     // Rendering helpers for sub-classes.
     void renderHull();
 
+    /// Registers a member storing render data created by @see setLineData (@see keepPreviousRenderData).
+    inline void addDoubleBufferedRenderData(sgl::ShaderAttributesPtr* renderData) {
+        doubleBufferedRenderData.push_back(renderData);
+    }
+    void swapPreviousRenderData();
+    std::vector<sgl::ShaderAttributesPtr*> doubleBufferedRenderData;
+    std::vector<sgl::ShaderAttributesPtr> previousRenderData;
+    sgl::ShaderAttributesPtr previousShaderAttributesHull;
+    LineDataPtr previousLineData;
+    bool hasPreviousRenderData = false;
+
     // Metadata about renderer.
     bool isRasterizer = true;
     std::string windowName;
@@ -121,7 +147,7 @@ protected:
     bool computeDepthCuesOnGpu = true;
     float minDepth = 0.0f;
     float maxDepth = 1.0f;
-    std::vector<std::vector<glm::vec3>> filteredLines;
+    FilteredLinesView filteredLines;
     sgl::GeometryBufferPtr filteredLinesVerticesBuffer;
     sgl::GeometryBufferPtr depthMinMaxBuffers[2];
     sgl::ShaderProgramPtr computeDepthValuesShaderProgram;
@@ -43,6 +43,7 @@
 
 DepthComplexityRenderer::DepthComplexityRenderer(SceneData &sceneData, sgl::TransferFunctionWindow &transferFunctionWindow)
         : LineRenderer("Depth Complexity Renderer", sceneData, transferFunctionWindow) {
+    addDoubleBufferedRenderData(&shaderAttributes);
     sgl::ShaderManager->invalidateShaderCache();
     sgl::ShaderManager->addPreprocessorDefine("OIT_GATHER_HEADER", "\"DepthComplexityGatherInc.glsl\"");
     resolveShader = sgl::ShaderManager->getShaderProgram(
@@ -159,7 +160,7 @@ void DepthComplexityRenderer::gather() {
     sgl::Renderer->setModelMatrix(sgl::matrixIdentity());
 
     // Now, the final gather step.
-    sgl::Renderer->render(shaderAttributes);
+    lineData->drawLines(shaderAttributes, sceneData.camera);
     //renderHull(); // Doesn't make sense for this renderer.
     glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
     glEnable(GL_CULL_FACE);
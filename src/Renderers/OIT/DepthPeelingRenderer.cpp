@@ -46,6 +46,8 @@
 DepthPeelingRenderer::DepthPeelingRenderer(
         SceneData& sceneData, sgl::TransferFunctionWindow& transferFunctionWindow)
         : LineRenderer("Depth Peeling", sceneData, transferFunctionWindow) {
+    addDoubleBufferedRenderData(&shaderAttributes);
+    addDoubleBufferedRenderData(&depthComplexityShaderAttributes);
     onResolutionChanged();
 }
 
@@ -197,7 +199,7 @@ void DepthPeelingRenderer::gather() {
         sgl::Renderer->setViewMatrix(sceneData.camera->getViewMatrix());
         sgl::Renderer->setModelMatrix(sgl::matrixIdentity());
 
-        sgl::Renderer->render(shaderAttributes);
+        lineData->drawLines(shaderAttributes, sceneData.camera);
         //renderHull();
 
         // 2. Store it in the accumulator
@@ -258,7 +260,7 @@ void DepthPeelingRenderer::computeDepthComplexity() {
     if (lineData->getLinePrimitiveMode() == LineData::LINE_PRIMITIVES_BAND) {
         glDisable(GL_CULL_FACE);
     }
-    sgl::Renderer->render(depthComplexityShaderAttributes);
+    lineData->drawLines(depthComplexityShaderAttributes, sceneData.camera);
     if (lineData->getLinePrimitiveMode() == LineData::LINE_PRIMITIVES_BAND) {
         glEnable(GL_CULL_FACE);
     }
@@ -53,6 +53,8 @@ MBOITRenderer::MBOITRenderer(
         SceneData& sceneData, sgl::TransferFunctionWindow& transferFunctionWindow)
         : LineRenderer("Moment-Based Order Independent Transparency",
                        sceneData, transferFunctionWindow) {
+    addDoubleBufferedRenderData(&shaderAttributesPass1);
+    addDoubleBufferedRenderData(&shaderAttributesPass2);
     syncMode = getSupportedSyncMode();
 
     // Create moment OIT uniform data buffer.
@@ -105,6 +107,8 @@ void MBOITRenderer::reloadShaders() {
 }
 
 void MBOITRenderer::reloadGatherShader(bool canCopyShaderAttributes) {
+    // The kept render data is bound to the old shaders.
+    releasePreviousRenderData();
     if (syncMode == SYNC_FRAGMENT_SHADER_INTERLOCK) {
         sgl::ShaderManager->addPreprocessorDefine("USE_SYNC_FRAGMENT_SHADER_INTERLOCK", "");
         if (!useOrderedFragmentShaderInterlock) {
@@ -468,7 +472,7 @@ void MBOITRenderer::gather() {
     sgl::Renderer->setViewMatrix(sceneData.camera->getViewMatrix());
     sgl::Renderer->setModelMatrix(sgl::matrixIdentity());
 
-    sgl::Renderer->render(shaderAttributesPass1);
+    lineData->drawLines(shaderAttributesPass1, sceneData.camera);
 
     glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
 
@@ -479,7 +483,7 @@ void MBOITRenderer::gather() {
 
     glBlendFuncSeparate(GL_ONE, GL_ONE, GL_ONE, GL_ONE);
 
-    sgl::Renderer->render(shaderAttributesPass2);
+    lineData->drawLines(shaderAttributesPass2, sceneData.camera);
 
     if (lineData->getLinePrimitiveMode() == LineData::LINE_PRIMITIVES_BAND) {
         glEnable(GL_CULL_FACE);
@@ -48,6 +48,7 @@ MLABBucketRenderer::MLABBucketRenderer(
         SceneData& sceneData, sgl::TransferFunctionWindow& transferFunctionWindow)
         : MLABRenderer("Multi-Layer Alpha Blending Renderer with Depth Buckets",
                        sceneData, transferFunctionWindow) {
+    addDoubleBufferedRenderData(&minDepthPassShaderAttributes);
 }
 
 void MLABBucketRenderer::initialize() {
@@ -201,10 +202,10 @@ void MLABBucketRenderer::gather() {
         glDisable(GL_CULL_FACE);
     }
 
-    sgl::Renderer->render(minDepthPassShaderAttributes);
+    lineData->drawLines(minDepthPassShaderAttributes, sceneData.camera);
     glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 
-    sgl::Renderer->render(shaderAttributes);
+    lineData->drawLines(shaderAttributes, sceneData.camera);
     renderHull();
     glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 
@@ -51,6 +51,7 @@ MLABRenderer::MLABRenderer(SceneData& sceneData, sgl::TransferFunctionWindow& tr
 MLABRenderer::MLABRenderer(
         const std::string& windowName, SceneData &sceneData, sgl::TransferFunctionWindow &transferFunctionWindow)
         : LineRenderer("Multi-Layer Alpha Blending Renderer", sceneData, transferFunctionWindow) {
+    addDoubleBufferedRenderData(&shaderAttributes);
 }
 
 void MLABRenderer::initialize() {
@@ -318,7 +319,7 @@ void MLABRenderer::gather() {
     if (lineData->getLinePrimitiveMode() == LineData::LINE_PRIMITIVES_BAND) {
         glDisable(GL_CULL_FACE);
     }
-    sgl::Renderer->render(shaderAttributes);
+    lineData->drawLines(shaderAttributes, sceneData.camera);
     renderHull();
     if (lineData->getLinePrimitiveMode() == LineData::LINE_PRIMITIVES_BAND) {
         glEnable(GL_CULL_FACE);
@@ -264,7 +264,7 @@ void OpacityOptimizationRenderer::setLineData(LineDataPtr& lineData, bool isNewD
     gatherPpllFinalRenderData = sgl::ShaderAttributesPtr();
     updateLargeMeshMode();
 
-    lines = lineData->getFilteredLines();
+    lines = lineData->getFilteredLinesView();
 
     sgl::GeometryBufferPtr indexBuffer;
     sgl::GeometryBufferPtr vertexPositionBuffer;
@@ -380,14 +380,14 @@ void OpacityOptimizationRenderer::generateBlendingWeightParametrization(bool isN
     numPolylineSegments = 0;
     polylineLengths.clear();
     polylineLengths.shrink_to_fit();
-    polylineLengths.resize(lines.size());
+    polylineLengths.resize(lines.getNumLines());
 
 #if _OPENMP >= 201107
     #pragma omp parallel for reduction(+: linesLengthSum) reduction(+: numPolylineSegments) shared(polylineLengths) \
     default(none)
 #endif
-    for (size_t lineIdx = 0; lineIdx < lines.size(); lineIdx++) {
-        std::vector<glm::vec3>& line = lines.at(lineIdx);
+    for (size_t lineIdx = 0; lineIdx < lines.getNumLines(); lineIdx++) {
+        ArrayView<glm::vec3> line = lines.getLinePoints(lineIdx);
         const size_t n = line.size();
         float polylineLength = 0.0f;
         for (size_t i = 1; i < n; i++) {
@@ -415,13 +415,13 @@ void OpacityOptimizationRenderer::recomputeStaticParametrization() {
     std::vector<glm::uvec2> lineSegmentConnectivityData;
 
     const float EPSILON = 1e-5f;
-    const int approximateLineSegmentsTotal = lines.size() * 32; // Avg. discretization of 8 segments per line.
+    const int approximateLineSegmentsTotal = lines.getNumLines() * 32; // Avg. discretization of 8 segments per line.
     lineSegmentConnectivityData.reserve(approximateLineSegmentsTotal);
 
     size_t segmentIdOffset = 0;
     size_t vertexIdx = 0;
-    for (size_t lineIdx = 0; lineIdx < lines.size(); lineIdx++) {
-        std::vector<glm::vec3>& line = lines.at(lineIdx);
+    for (size_t lineIdx = 0; lineIdx < lines.getNumLines(); lineIdx++) {
+        ArrayView<glm::vec3> line = lines.getLinePoints(lineIdx);
         const size_t n = line.size();
         float polylineLength = polylineLengths.at(lineIdx);
 
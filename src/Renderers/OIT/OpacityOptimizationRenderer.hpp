@@ -97,7 +97,7 @@ protected:
     void resolvePpllFinal();
 
     // Line data.
-    std::vector<std::vector<glm::vec3>> lines;
+    FilteredLinesView lines;
 
     // When the camera has moved or parameters have been changed, we need to render some more frames due to temporal
     // smoothing if continuous rendering is disabled.
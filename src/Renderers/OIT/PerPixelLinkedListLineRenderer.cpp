@@ -48,6 +48,7 @@ static bool useStencilBuffer = true;
 PerPixelLinkedListLineRenderer::PerPixelLinkedListLineRenderer(
         SceneData& sceneData, sgl::TransferFunctionWindow& transferFunctionWindow)
         : LineRenderer("Per-Pixel Linked List Renderer", sceneData, transferFunctionWindow) {
+    addDoubleBufferedRenderData(&shaderAttributes);
     sgl::ShaderManager->invalidateShaderCache();
     setSortingAlgorithmDefine();
     sgl::ShaderManager->addPreprocessorDefine("OIT_GATHER_HEADER", "\"LinkedListGather.glsl\"");
@@ -312,7 +313,7 @@ void PerPixelLinkedListLineRenderer::gather() {
     if (lineData->getLinePrimitiveMode() == LineData::LINE_PRIMITIVES_BAND) {
         glDisable(GL_CULL_FACE);
     }
-    sgl::Renderer->render(shaderAttributes);
+    lineData->drawLines(shaderAttributes, sceneData.camera);
     renderHull();
     if (lineData->getLinePrimitiveMode() == LineData::LINE_PRIMITIVES_BAND) {
         glEnable(GL_CULL_FACE);
@@ -48,6 +48,7 @@ const bool useStencilBuffer = true;
 WBOITRenderer::WBOITRenderer(SceneData& sceneData, sgl::TransferFunctionWindow& transferFunctionWindow)
         : LineRenderer("Weighted Blended Order Independent Transparency",
                        sceneData, transferFunctionWindow) {
+    addDoubleBufferedRenderData(&shaderAttributes);
     sgl::ShaderManager->invalidateShaderCache();
     sgl::ShaderManager->addPreprocessorDefine("OIT_GATHER_HEADER", "\"WBOITGather.glsl\"");
     onResolutionChanged();
@@ -169,7 +170,7 @@ void WBOITRenderer::render() {
     if (lineData->getLinePrimitiveMode() == LineData::LINE_PRIMITIVES_BAND) {
         glDisable(GL_CULL_FACE);
     }
-    sgl::Renderer->render(shaderAttributes);
+    lineData->drawLines(shaderAttributes, sceneData.camera);
     renderHull();
     if (lineData->getLinePrimitiveMode() == LineData::LINE_PRIMITIVES_BAND) {
         glEnable(GL_CULL_FACE);
@@ -44,6 +44,8 @@
 
 OpaqueLineRenderer::OpaqueLineRenderer(SceneData& sceneData, sgl::TransferFunctionWindow& transferFunctionWindow)
         : LineRenderer("Opaque Line Renderer", sceneData, transferFunctionWindow) {
+    addDoubleBufferedRenderData(&shaderAttributes);
+    addDoubleBufferedRenderData(&shaderAttributesDegeneratePoints);
     // Get all available multisampling modes.
     glGetIntegerv(GL_MAX_SAMPLES, &maximumNumberOfSamples);
     if (maximumNumberOfSamples <= 1) {
@@ -207,7 +209,7 @@ void OpaqueLineRenderer::render() {
     //if (lineData->getLinePrimitiveMode() == LineData::LINE_PRIMITIVES_BAND) {
         glDisable(GL_CULL_FACE);
     //}
-    sgl::Renderer->render(shaderAttributes);
+    lineData->drawLines(shaderAttributes, sceneData.camera);
     //if (lineData->getLinePrimitiveMode() == LineData::LINE_PRIMITIVES_BAND) {
         glEnable(GL_CULL_FACE);
     //}
@@ -0,0 +1,177 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <glm/glm.hpp>
+
+#include "Histogram.hpp"
+
+const int AttributeHistogram::FINE_RESOLUTION;
+
+void computeHistograms(
+        const float* values, size_t numValues, const glm::vec2& range, const std::vector<int>& binCounts,
+        std::vector<std::vector<uint32_t>>& histograms) {
+    const size_t numHistograms = binCounts.size();
+    std::vector<size_t> histogramOffsets(numHistograms);
+    size_t numBinsTotal = 0;
+    for (size_t histogramIdx = 0; histogramIdx < numHistograms; histogramIdx++) {
+        histogramOffsets.at(histogramIdx) = numBinsTotal;
+        numBinsTotal += size_t(binCounts.at(histogramIdx));
+    }
+    std::vector<uint32_t> histogramsFlat(numBinsTotal, 0);
+
+    const float rangeMin = range.x;
+    const float rangeExtent = range.y - range.x;
+    const float rangeExtentInv = rangeExtent > 0.0f ? 1.0f / rangeExtent : 0.0f;
+
+#if _OPENMP >= 201107
+    #pragma omp parallel shared(values, numValues, binCounts, histogramOffsets, histogramsFlat) \
+    shared(numHistograms, numBinsTotal, rangeMin, rangeExtentInv) default(none)
+#endif
+    {
+        // Per-thread partial histograms.
+        std::vector<uint32_t> histogramsLocal(numBinsTotal, 0);
+
+#if _OPENMP >= 201107
+        #pragma omp for nowait
+#endif
+        for (size_t i = 0; i < numValues; i++) {
+            const float normalizedValue = (values[i] - rangeMin) * rangeExtentInv;
+            for (size_t histogramIdx = 0; histogramIdx < numHistograms; histogramIdx++) {
+                const int numBins = binCounts[histogramIdx];
+                int binIdx = glm::clamp(int(normalizedValue * float(numBins)), 0, numBins - 1);
+                histogramsLocal[histogramOffsets[histogramIdx] + size_t(binIdx)]++;
+            }
+        }
+
+#if _OPENMP >= 201107
+        #pragma omp critical
+#endif
+        {
+            for (size_t binIdx = 0; binIdx < numBinsTotal; binIdx++) {
+                histogramsFlat[binIdx] += histogramsLocal[binIdx];
+            }
+        }
+    }
+
+    histograms.resize(numHistograms);
+    for (size_t histogramIdx = 0; histogramIdx < numHistograms; histogramIdx++) {
+        auto histogramBegin = histogramsFlat.begin() + ptrdiff_t(histogramOffsets.at(histogramIdx));
+        histograms.at(histogramIdx).assign(histogramBegin, histogramBegin + binCounts.at(histogramIdx));
+    }
+}
+
+glm::vec2 computeMinMax(const float* values, size_t numValues) {
+    float minValue = std::numeric_limits<float>::max();
+    float maxValue = std::numeric_limits<float>::lowest();
+#if _OPENMP >= 201107
+    #pragma omp parallel for reduction(min: minValue) reduction(max: maxValue) shared(values, numValues) default(none)
+#endif
+    for (size_t i = 0; i < numValues; i++) {
+        float value = values[i];
+        minValue = std::min(minValue, value);
+        maxValue = std::max(maxValue, value);
+    }
+    return glm::vec2(minValue, maxValue);
+}
+
+void AttributeHistogram::build(const std::vector<float>& values) {
+    build(values.data(), values.size(), computeMinMax(values.data(), values.size()));
+}
+
+void AttributeHistogram::build(const float* values, size_t numValues, const glm::vec2& dataRange) {
+    this->dataRange = dataRange;
+    this->numValues = numValues;
+    std::vector<std::vector<uint32_t>> histograms;
+    computeHistograms(values, numValues, dataRange, { FINE_RESOLUTION }, histograms);
+    fineHistogram = std::move(histograms.front());
+}
+
+void AttributeHistogram::getNormalizedHistogram(
+        const glm::vec2& selectedRange, int numBins, std::vector<float>& histogram) const {
+    histogram.assign(size_t(std::max(numBins, 0)), 0.0f);
+    if (numBins <= 0 || fineHistogram.empty()) {
+        return;
+    }
+
+    const float dataExtent = dataRange.y - dataRange.x;
+    const float selectedExtent = selectedRange.y - selectedRange.x;
+    if (selectedExtent <= 0.0f) {
+        histogram.front() = numValues > 0 ? 1.0f : 0.0f;
+        return;
+    }
+
+    // Position of the fine bin boundaries in units of the derived bins. The scale is computed such that it is exact
+    // if the selected range is the data range and numBins divides the fine resolution.
+    const float fineBinScale = dataExtent / selectedExtent * (float(numBins) / float(FINE_RESOLUTION));
+    const float fineBinOffset = (dataRange.x - selectedRange.x) / selectedExtent * float(numBins);
+    const auto numBinsFloat = float(numBins);
+    for (int fineBinIdx = 0; fineBinIdx < FINE_RESOLUTION; fineBinIdx++) {
+        uint32_t count = fineHistogram[fineBinIdx];
+        if (count == 0) {
+            continue;
+        }
+        const float binStart = fineBinOffset + float(fineBinIdx) * fineBinScale;
+        const float binEnd = binStart + fineBinScale;
+        if (!(binEnd > binStart)) {
+            // All values are equal.
+            histogram[glm::clamp(int(binStart), 0, numBins - 1)] += float(count);
+            continue;
+        }
+
+        // The parts outside of the selected range are counted in the first or last bin.
+        const float countPerBin = float(count) / (binEnd - binStart);
+        if (binStart < 0.0f) {
+            histogram.front() += (std::min(binEnd, 0.0f) - binStart) * countPerBin;
+        }
+        if (binEnd > numBinsFloat) {
+            histogram.back() += (binEnd - std::max(binStart, numBinsFloat)) * countPerBin;
+        }
+        const float overlapStart = std::max(binStart, 0.0f);
+        const float overlapEnd = std::min(binEnd, numBinsFloat);
+        for (int binIdx = int(overlapStart); binIdx < numBins && float(binIdx) < overlapEnd; binIdx++) {
+            float overlap = std::min(overlapEnd, float(binIdx + 1)) - std::max(overlapStart, float(binIdx));
+            if (overlap > 0.0f) {
+                histogram[binIdx] += overlap * countPerBin;
+            }
+        }
+    }
+
+    // Normalize values of histogram.
+    float histogramMax = 0.0f;
+    for (float binCount : histogram) {
+        histogramMax = std::max(histogramMax, binCount);
+    }
+    if (histogramMax > 0.0f) {
+        for (float& binCount : histogram) {
+            binCount /= histogramMax;
+        }
+    }
+}
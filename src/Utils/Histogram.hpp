@@ -0,0 +1,96 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef LINEVIS_HISTOGRAM_HPP
+#define LINEVIS_HISTOGRAM_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <glm/vec2.hpp>
+
+/**
+ * Computes histograms with different numbers of bins over the passed value range in one parallel pass over the
+ * values. Each thread accumulates its own partial histograms, which are summed up at the end. Values outside of the
+ * range are clamped to the first or last bin.
+ * @param values The values to compute the histograms of.
+ * @param numValues The number of values.
+ * @param range The value range covered by the bins.
+ * @param binCounts The number of bins of each histogram (must be at least one).
+ * @param histograms The bin counts of the histograms (one histogram per entry of binCounts).
+ */
+void computeHistograms(
+        const float* values, size_t numValues, const glm::vec2& range, const std::vector<int>& binCounts,
+        std::vector<std::vector<uint32_t>>& histograms);
+
+/**
+ * @param values The values.
+ * @param numValues The number of values.
+ * @return The minimum and maximum of the values (computed in parallel).
+ */
+glm::vec2 computeMinMax(const float* values, size_t numValues);
+
+/**
+ * Histogram of the values of one attribute that is built once (e.g., when an attribute is first displayed) at a fine
+ * resolution over the whole data range. Histograms with a coarser resolution or of a sub-range of the data range, as
+ * displayed in the transfer function editors, are derived from it without touching the attribute values again. The
+ * values are not kept.
+ * Each fine bin is distributed over the derived bins proportionally to its overlap with them, i.e., the values are
+ * assumed to be uniformly distributed within a fine bin. Thus, derived histograms are exact if the data range is used
+ * and the number of bins divides FINE_RESOLUTION. Selected ranges covering fewer fine bins than bins are requested
+ * are interpolated without gaps.
+ */
+class AttributeHistogram {
+public:
+    static const int FINE_RESOLUTION = 16384;
+
+    /// Builds the histogram over the range of the passed values.
+    void build(const std::vector<float>& values);
+    /// Builds the histogram over a given data range.
+    void build(const float* values, size_t numValues, const glm::vec2& dataRange);
+
+    inline bool getIsEmpty() const { return fineHistogram.empty(); }
+    inline const glm::vec2& getDataRange() const { return dataRange; }
+    inline size_t getNumValues() const { return numValues; }
+
+    /**
+     * Derives a histogram of the selected range with the passed number of bins. Values outside of the selected range
+     * are counted in the first or last bin.
+     * @param selectedRange The value range covered by the bins.
+     * @param numBins The number of bins.
+     * @param histogram The bin counts normalized by the maximum bin count (i.e., the maximum bin has the value 1).
+     */
+    void getNormalizedHistogram(const glm::vec2& selectedRange, int numBins, std::vector<float>& histogram) const;
+
+private:
+    glm::vec2 dataRange = glm::vec2(0.0f);
+    size_t numValues = 0;
+    std::vector<uint32_t> fineHistogram;
+};
+
+#endif //LINEVIS_HISTOGRAM_HPP
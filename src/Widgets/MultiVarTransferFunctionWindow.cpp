@@ -207,43 +207,21 @@ bool GuiVarData::loadTfFromFile(const std::string& filename) {
 }
 
 void GuiVarData::setAttributeValues(const std::string& name, const std::vector<float>& attributes) {
-    attributeName = name;
-    this->attributes = attributes;
+    AttributeHistogram newAttributeHistogram;
+    newAttributeHistogram.build(attributes);
+    setAttributeHistogram(name, newAttributeHistogram);
+}
 
-    float minAttr = std::numeric_limits<float>::max();
-    float maxAttr = std::numeric_limits<float>::lowest();
-#if _OPENMP >= 201107
-    #pragma omp parallel for reduction(min: minAttr) reduction(max: maxAttr) shared(attributes) default(none)
-#endif
-    for (size_t i = 0; i < attributes.size(); i++) {
-        float value = attributes.at(i);
-        minAttr = std::min(minAttr, value);
-        maxAttr = std::max(maxAttr, value);
-    }
-    this->dataRange = glm::vec2(minAttr, maxAttr);
-    this->selectedRange = glm::vec2(minAttr, maxAttr);
+void GuiVarData::setAttributeHistogram(const std::string& name, const AttributeHistogram& attributeHistogram) {
+    attributeName = name;
+    this->attributeHistogram = attributeHistogram;
+    this->dataRange = attributeHistogram.getDataRange();
+    this->selectedRange = attributeHistogram.getDataRange();
     computeHistogram();
 }
 
 void GuiVarData::computeHistogram() {
-    float histogramsMax = 0;
-    histogram = std::vector<float>(histogramResolution, 0.0f);
-
-    for (const float& value : attributes) {
-        int32_t index = glm::clamp(
-                static_cast<int>((value - selectedRange.x) / (selectedRange.y - selectedRange.x)
-                * static_cast<float>(histogramResolution)), 0, histogramResolution - 1);
-        histogram.at(index)++;
-    }
-
-    // Normalize values of histogram.
-    for (const float& binNumber : histogram) {
-        histogramsMax = std::max(histogramsMax, binNumber);
-    }
-
-    for (float& numBin : histogram) {
-        numBin /= histogramsMax;
-    }
+    attributeHistogram.getNormalizedHistogram(selectedRange, histogramResolution, histogram);
 }
 
 // For OpenGL: Has TRANSFER_FUNCTION_TEXTURE_SIZE entries.
@@ -783,6 +761,17 @@ void MultiVarTransferFunctionWindow::setAttributesValues(
         const std::vector<std::string>& names,
         const std::vector<std::vector<float>>& allAttributes) {
     assert(names.size() == allAttributes.size());
+    std::vector<AttributeHistogram> attributeHistograms(allAttributes.size());
+    for (size_t varIdx = 0; varIdx < allAttributes.size(); varIdx++) {
+        attributeHistograms.at(varIdx).build(allAttributes.at(varIdx));
+    }
+    setAttributeHistograms(names, attributeHistograms);
+}
+
+void MultiVarTransferFunctionWindow::setAttributeHistograms(
+        const std::vector<std::string>& names,
+        const std::vector<AttributeHistogram>& attributeHistograms) {
+    assert(names.size() == attributeHistograms.size());
     varNames = names;
     transferFunctionMap_sRGB.resize(TRANSFER_FUNCTION_TEXTURE_SIZE * names.size());
     transferFunctionMap_linearRGB.resize(TRANSFER_FUNCTION_TEXTURE_SIZE * names.size());
@@ -809,7 +798,7 @@ void MultiVarTransferFunctionWindow::setAttributesValues(
 
     for (size_t varIdx = 0; varIdx < names.size(); varIdx++) {
         GuiVarData& varData = guiVarData.at(varIdx);
-        varData.setAttributeValues(names.at(varIdx), allAttributes.at(varIdx));
+        varData.setAttributeHistogram(names.at(varIdx), attributeHistograms.at(varIdx));
     }
     currVarData = &guiVarData.at(selectedVarIndex);
 
@@ -32,6 +32,8 @@
 #include <Utils/File/PathWatch.hpp>
 #include <ImGui/Widgets/TransferFunctionWindow.hpp>
 
+#include "Utils/Histogram.hpp"
+
 class MultiVarTransferFunctionWindow;
 
 // Data for one variable.
@@ -52,6 +54,8 @@ public:
     bool saveTfToFile(const std::string& filename);
     bool loadTfFromFile(const std::string& filename);
     void setAttributeValues(const std::string& name, const std::vector<float>& attributes);
+    /// Uses a precomputed histogram of the attribute values (the values themselves are not needed).
+    void setAttributeHistogram(const std::string& name, const AttributeHistogram& attributeHistogram);
 
     bool renderGui();
     inline const std::string& getSaveFileString() { return saveFileString; }
@@ -85,7 +89,7 @@ private:
     std::vector<float> histogram;
     glm::vec2 dataRange = glm::vec2(0.0f);
     glm::vec2 selectedRange = glm::vec2(0.0f);
-    std::vector<float> attributes;
+    AttributeHistogram attributeHistogram;
 
     // Drag-and-drop data
     sgl::SelectedPointType selectedPointType = sgl::SELECTED_POINT_TYPE_NONE;
@@ -133,6 +137,13 @@ public:
     void setAttributesValues(
             const std::vector<std::string>& names,
             const std::vector<std::vector<float>>& allAttributes);
+    /**
+     * Same as @see setAttributesValues, but with histograms that were computed in advance (e.g., cached when loading
+     * the data set). Changing the selected range or the histogram resolution never touches the attribute values.
+     */
+    void setAttributeHistograms(
+            const std::vector<std::string>& names,
+            const std::vector<AttributeHistogram>& attributeHistograms);
 
     bool saveCurrentVarTfToFile(const std::string& filename);
     bool loadTfFromFile(int varIdx, const std::string& filename);
@@ -0,0 +1,156 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+#include <random>
+#include <glm/glm.hpp>
+#include "gtest/gtest.h"
+#include "LineData/MultiVar/BezierCurve.hpp"
+#include "LineData/MultiVar/BezierTrajectory.hpp"
+
+/**
+ * Creates smooth random trajectories (perturbed helices) with the passed number of variables.
+ */
+static Trajectories createTestTrajectories(int numLines, int numLinePoints, int numVariables) {
+    std::default_random_engine generator(12345);
+    std::uniform_real_distribution<float> positionDistribution(0.0f, 1.0f);
+    std::uniform_real_distribution<float> noiseDistribution(-0.002f, 0.002f);
+    std::uniform_real_distribution<float> attributeDistribution(-10.0f, 10.0f);
+
+    Trajectories trajectories(numLines);
+    for (Trajectory& trajectory : trajectories) {
+        glm::vec3 center(
+                positionDistribution(generator), positionDistribution(generator), positionDistribution(generator));
+        float radius = 0.02f + 0.05f * positionDistribution(generator);
+        float pitch = 0.001f + 0.004f * positionDistribution(generator);
+        for (int i = 0; i < numLinePoints; i++) {
+            float angle = 0.2f * float(i);
+            glm::vec3 offset(
+                    radius * std::cos(angle) + noiseDistribution(generator),
+                    radius * std::sin(angle) + noiseDistribution(generator),
+                    pitch * float(i));
+            trajectory.positions.push_back(center + offset);
+        }
+        trajectory.attributes.resize(numVariables);
+        for (int varIdx = 0; varIdx < numVariables; varIdx++) {
+            for (int i = 0; i < numLinePoints; i++) {
+                trajectory.attributes.at(varIdx).push_back(attributeDistribution(generator));
+            }
+        }
+    }
+    return trajectories;
+}
+
+/// Returns the average length of the first segment of the passed trajectories.
+static float computeAverageSegmentLength(const Trajectories& trajectories) {
+    float avgSegmentLength = 0.0f;
+    for (const Trajectory& trajectory : trajectories) {
+        avgSegmentLength += glm::length(trajectory.positions.at(1) - trajectory.positions.at(0));
+    }
+    return avgSegmentLength / float(trajectories.size());
+}
+
+/// Returns the maximum distance between corresponding resampled points of the two sets of Bezier trajectories.
+static float compareBezierTrajectories(
+        const BezierTrajectories& trajectories0, const BezierTrajectories& trajectories1) {
+    float maxDistance = 0.0f;
+    EXPECT_EQ(trajectories0.size(), trajectories1.size());
+    for (size_t lineIdx = 0; lineIdx < trajectories0.size(); lineIdx++) {
+        const BezierTrajectory& trajectory0 = trajectories0.at(lineIdx);
+        const BezierTrajectory& trajectory1 = trajectories1.at(lineIdx);
+        EXPECT_EQ(trajectory0.positions.size(), trajectory1.positions.size());
+        EXPECT_EQ(trajectory0.multiVarData, trajectory1.multiVarData);
+        size_t numPoints = std::min(trajectory0.positions.size(), trajectory1.positions.size());
+        for (size_t i = 0; i < numPoints; i++) {
+            maxDistance = std::max(maxDistance, glm::length(trajectory0.positions.at(i) - trajectory1.positions.at(i)));
+            // Variable values and IDs need to match exactly.
+            for (int attrIdx = 0; attrIdx < 7; attrIdx++) {
+                EXPECT_EQ(trajectory0.attributes.at(attrIdx).at(i), trajectory1.attributes.at(attrIdx).at(i));
+            }
+        }
+    }
+    return maxDistance;
+}
+
+TEST(BezierCurveTest, ArcLengthTableInversion) {
+    BezierCurve curve({{
+            glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 2.0f, 0.0f),
+            glm::vec3(2.0f, -1.0f, 1.0f), glm::vec3(3.0f, 0.0f, 0.0f)}}, 4.0f, 5.0f);
+    const uint32_t numEntries = 32;
+    float arcLengthTable[numEntries];
+    curve.computeArcLengthTable(numEntries, arcLengthTable);
+    EXPECT_EQ(arcLengthTable[0], 0.0f);
+    EXPECT_NEAR(arcLengthTable[numEntries - 1], curve.totalArcLength, 0.01f * curve.totalArcLength);
+
+    EXPECT_FLOAT_EQ(curve.solveTForArcLengthTable(arcLengthTable, numEntries, 0.0f), 4.0f);
+    EXPECT_FLOAT_EQ(curve.solveTForArcLengthTable(arcLengthTable, numEntries, arcLengthTable[numEntries - 1]), 5.0f);
+    for (int i = 1; i < 10; i++) {
+        float arcLength = float(i) / 10.0f * curve.totalArcLength;
+        float tNewton = curve.solveTForArcLength(arcLength);
+        float tTable = curve.solveTForArcLengthTable(arcLengthTable, numEntries, arcLength);
+        EXPECT_NEAR(tNewton, tTable, 5e-3f);
+    }
+}
+
+TEST(BezierTrajectoryTest, NoVariables) {
+    Trajectories trajectories = createTestTrajectories(4, 10, 0);
+    BezierTrajectories bezierTrajectories;
+    EXPECT_FALSE(convertTrajectoriesToBezierCurves(trajectories, bezierTrajectories));
+    EXPECT_TRUE(bezierTrajectories.empty());
+}
+
+TEST(BezierTrajectoryTest, TableMatchesNewton) {
+    Trajectories trajectories = createTestTrajectories(100, 50, 4);
+    BezierTrajectories bezierTrajectoriesNewton, bezierTrajectoriesTable;
+    ASSERT_TRUE(convertTrajectoriesToBezierCurves(
+            trajectories, bezierTrajectoriesNewton, BEZIER_ARC_LENGTH_SOLVER_NEWTON));
+    ASSERT_TRUE(convertTrajectoriesToBezierCurves(
+            trajectories, bezierTrajectoriesTable, BEZIER_ARC_LENGTH_SOLVER_TABLE));
+
+    // The resampled points need to lie (almost) on the same positions as the reference solution.
+    float avgSegmentLength = computeAverageSegmentLength(trajectories);
+    float maxDistance = compareBezierTrajectories(bezierTrajectoriesNewton, bezierTrajectoriesTable);
+    EXPECT_LT(maxDistance, 0.01f * avgSegmentLength);
+}
+
+/**
+ * Checks the accuracy of the arc length table solver on a larger data set with more variables (i.e., with more curve
+ * segments per line and more than one variable per line point).
+ */
+TEST(BezierTrajectoryTest, TableMatchesNewtonManyVariables) {
+    Trajectories trajectories = createTestTrajectories(500, 100, 8);
+    BezierTrajectories bezierTrajectoriesNewton, bezierTrajectoriesTable;
+    ASSERT_TRUE(convertTrajectoriesToBezierCurves(
+            trajectories, bezierTrajectoriesNewton, BEZIER_ARC_LENGTH_SOLVER_NEWTON));
+    ASSERT_TRUE(convertTrajectoriesToBezierCurves(
+            trajectories, bezierTrajectoriesTable, BEZIER_ARC_LENGTH_SOLVER_TABLE));
+
+    float avgSegmentLength = computeAverageSegmentLength(trajectories);
+    float maxDistance = compareBezierTrajectories(bezierTrajectoriesNewton, bezierTrajectoriesTable);
+    EXPECT_LT(maxDistance, 0.01f * avgSegmentLength);
+}
@@ -0,0 +1,74 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <glm/glm.hpp>
+#include "gtest/gtest.h"
+#include "LineData/FilteredLinesView.hpp"
+
+/// Creates straight lines with the passed number of points, where the point i of line l lies at (i, l, 0).
+static Trajectories createLineGrid(int numLines, int numLinePoints) {
+    Trajectories trajectories(numLines);
+    for (int lineIdx = 0; lineIdx < numLines; lineIdx++) {
+        for (int i = 0; i < numLinePoints; i++) {
+            trajectories.at(lineIdx).positions.push_back(glm::vec3(float(i), float(lineIdx), 0.0f));
+        }
+    }
+    return trajectories;
+}
+
+/// A view retrieved before the cache recomputes its data keeps referencing the (unchanged) old line positions.
+TEST(FilteredLinesViewTest, OutlivesCacheRecomputation) {
+    Trajectories trajectories = createLineGrid(10, 20);
+    LinePreprocessingCache linePreprocessingCache;
+    std::vector<bool> filteredTrajectories;
+
+    FilteredLinesView filteredLinesView;
+    filteredLinesView.addLineSet(linePreprocessingCache.getShared(trajectories, filteredTrajectories));
+    ASSERT_EQ(filteredLinesView.getNumLines(), trajectories.size());
+    EXPECT_EQ(filteredLinesView.getNumLinePoints(), size_t(10 * 20));
+
+    // Filter out every second line and invalidate the cache; both recompute the cached data.
+    filteredTrajectories.resize(trajectories.size(), false);
+    for (size_t trajectoryIdx = 0; trajectoryIdx < trajectories.size(); trajectoryIdx += 2) {
+        filteredTrajectories.at(trajectoryIdx) = true;
+    }
+    EXPECT_EQ(linePreprocessingCache.get(trajectories, filteredTrajectories).getNumLines(), trajectories.size() / 2);
+    linePreprocessingCache.invalidate();
+    trajectories = createLineGrid(3, 5);
+    filteredTrajectories.clear();
+    EXPECT_EQ(linePreprocessingCache.get(trajectories, filteredTrajectories).getNumLines(), size_t(3));
+
+    ASSERT_EQ(filteredLinesView.getNumLines(), size_t(10));
+    for (size_t lineIdx = 0; lineIdx < filteredLinesView.getNumLines(); lineIdx++) {
+        ArrayView<glm::vec3> linePoints = filteredLinesView.getLinePoints(lineIdx);
+        ASSERT_EQ(linePoints.size(), size_t(20));
+        for (size_t i = 0; i < linePoints.size(); i++) {
+            EXPECT_EQ(linePoints[i], glm::vec3(float(i), float(lineIdx), 0.0f));
+        }
+    }
+}
@@ -0,0 +1,154 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <random>
+#include <cmath>
+#include <glm/glm.hpp>
+#include "gtest/gtest.h"
+#include "LineData/SearchStructures/HexahedralCellGrid.hpp"
+#include "LineData/Stress/StressTensorProbe.hpp"
+
+/**
+ * Creates a hexahedral grid with numCells^3 cells over [0, 1]^3. The inner vertices are displaced randomly by up to
+ * jitter times the cell size, so the cells are general (non-parallelepiped) hexahedra.
+ */
+static StressTensorMesh createJitteredHexGrid(int numCells, float jitter) {
+    std::default_random_engine generator(12345);
+    std::uniform_real_distribution<float> distribution(-jitter, jitter);
+    StressTensorMesh mesh;
+    const int numVerticesPerAxis = numCells + 1;
+    for (int z = 0; z < numVerticesPerAxis; z++) {
+        for (int y = 0; y < numVerticesPerAxis; y++) {
+            for (int x = 0; x < numVerticesPerAxis; x++) {
+                glm::vec3 vertex = glm::vec3(float(x), float(y), float(z));
+                if (x > 0 && y > 0 && z > 0 && x < numCells && y < numCells && z < numCells) {
+                    vertex += glm::vec3(distribution(generator), distribution(generator), distribution(generator));
+                }
+                vertex /= float(numCells);
+                mesh.vertices.push_back(vertex);
+                // A linear field is reproduced exactly only in parallelepipeds, so the tensors are chosen per vertex.
+                const float tensor[6] = { vertex.x, vertex.y, vertex.z, 0.0f, 0.0f, 0.0f };
+                mesh.stressTensors.insert(mesh.stressTensors.end(), tensor, tensor + 6);
+            }
+        }
+    }
+    auto vertexIndex = [numVerticesPerAxis](int x, int y, int z) {
+        return uint32_t((z * numVerticesPerAxis + y) * numVerticesPerAxis + x);
+    };
+    for (int z = 0; z < numCells; z++) {
+        for (int y = 0; y < numCells; y++) {
+            for (int x = 0; x < numCells; x++) {
+                mesh.cellIndices.insert(mesh.cellIndices.end(), {
+                        vertexIndex(x, y, z), vertexIndex(x + 1, y, z),
+                        vertexIndex(x + 1, y + 1, z), vertexIndex(x, y + 1, z),
+                        vertexIndex(x, y, z + 1), vertexIndex(x + 1, y, z + 1),
+                        vertexIndex(x + 1, y + 1, z + 1), vertexIndex(x, y + 1, z + 1) });
+            }
+        }
+    }
+    return mesh;
+}
+
+/// Maps local coordinates of a cell to a world space position (the forward trilinear mapping).
+static glm::vec3 mapLocalCoordinates(const StressTensorMesh& mesh, uint32_t cellIdx, const glm::vec3& uvw) {
+    const int corners[8][3] = {
+            { 0,0,0 }, { 1,0,0 }, { 1,1,0 }, { 0,1,0 }, { 0,0,1 }, { 1,0,1 }, { 1,1,1 }, { 0,1,1 } };
+    glm::vec3 position(0.0f);
+    for (int i = 0; i < 8; i++) {
+        float weight =
+                (corners[i][0] ? uvw.x : 1.0f - uvw.x)
+                * (corners[i][1] ? uvw.y : 1.0f - uvw.y)
+                * (corners[i][2] ? uvw.z : 1.0f - uvw.z);
+        position += weight * mesh.vertices.at(mesh.cellIndices.at(cellIdx * 8 + i));
+    }
+    return position;
+}
+
+TEST(HexahedralCellGridTest, FindCellInJitteredGrid) {
+    const int numCells = 12;
+    StressTensorMesh mesh = createJitteredHexGrid(numCells, 0.3f);
+    HexahedralCellGrid cellGrid;
+    cellGrid.build(mesh.vertices, mesh.cellIndices);
+    EXPECT_EQ(cellGrid.getNumCells(), size_t(numCells * numCells * numCells));
+
+    // Positions generated inside of random cells need to be located in exactly these cells.
+    std::default_random_engine generator(54321);
+    std::uniform_int_distribution<uint32_t> cellDistribution(0, uint32_t(cellGrid.getNumCells() - 1));
+    std::uniform_real_distribution<float> localDistribution(0.01f, 0.99f);
+    for (int i = 0; i < 2000; i++) {
+        uint32_t expectedCellIdx = cellDistribution(generator);
+        glm::vec3 expectedLocalCoordinates(
+                localDistribution(generator), localDistribution(generator), localDistribution(generator));
+        glm::vec3 position = mapLocalCoordinates(mesh, expectedCellIdx, expectedLocalCoordinates);
+
+        uint32_t cellIdx;
+        glm::vec3 localCoordinates;
+        ASSERT_TRUE(cellGrid.findCell(position, cellIdx, localCoordinates));
+        EXPECT_EQ(cellIdx, expectedCellIdx);
+        EXPECT_NEAR(glm::length(localCoordinates - expectedLocalCoordinates), 0.0f, 1e-3f);
+    }
+
+    // Positions outside of the mesh.
+    uint32_t cellIdx;
+    glm::vec3 localCoordinates;
+    EXPECT_FALSE(cellGrid.findCell(glm::vec3(-0.01f, 0.5f, 0.5f), cellIdx, localCoordinates));
+    EXPECT_FALSE(cellGrid.findCell(glm::vec3(0.5f, 0.5f, 1.5f), cellIdx, localCoordinates));
+
+    // Positions on a boundary edge shared by two cells resolve to the cell with the lower index.
+    ASSERT_TRUE(cellGrid.findCell(glm::vec3(0.5f, 0.0f, 0.0f), cellIdx, localCoordinates));
+    EXPECT_EQ(cellIdx, uint32_t(numCells / 2 - 1));
+    EXPECT_NEAR(localCoordinates.x, 1.0f, 1e-4f);
+}
+
+TEST(HexahedralCellGridTest, StressTensorProbe) {
+    StressTensorProbe stressTensorProbe;
+    stressTensorProbe.setMesh(createJitteredHexGrid(8, 0.0f));
+    ASSERT_FALSE(stressTensorProbe.getIsEmpty());
+
+    // On an undistorted grid, the linear per-vertex field is reproduced exactly.
+    StressTensorProbeResult result;
+    ASSERT_TRUE(stressTensorProbe.probe(glm::vec3(0.3f, 0.7f, 0.55f), result));
+    EXPECT_NEAR(result.stressTensor[0], 0.3f, 1e-4f);
+    EXPECT_NEAR(result.stressTensor[1], 0.7f, 1e-4f);
+    EXPECT_NEAR(result.stressTensor[2], 0.55f, 1e-4f);
+    EXPECT_NEAR(result.principalStresses[0], 0.7f, 1e-4f);
+    EXPECT_NEAR(result.principalStresses[2], 0.3f, 1e-4f);
+    EXPECT_NEAR(std::abs(result.principalStressDirections[0].y), 1.0f, 1e-4f);
+    EXPECT_NEAR(result.vonMisesStress, computeVonMisesStress(result.stressTensor), 1e-6f);
+    EXPECT_FALSE(stressTensorProbe.probe(glm::vec3(1.1f, 0.5f, 0.5f), result));
+
+    // A ray entering the mesh through the face z = 1.
+    ASSERT_TRUE(stressTensorProbe.probeAlongRay(glm::vec3(0.4f, 0.6f, 3.0f), glm::vec3(0.0f, 0.0f, -1.0f), result));
+    EXPECT_NEAR(result.position.z, 1.0f, 1e-3f);
+    EXPECT_NEAR(result.stressTensor[2], 1.0f, 1e-3f);
+    // A ray starting inside of the mesh is probed at its origin.
+    ASSERT_TRUE(stressTensorProbe.probeAlongRay(glm::vec3(0.5f), glm::vec3(1.0f, 0.0f, 0.0f), result));
+    EXPECT_NEAR(result.position.x, 0.5f, 1e-6f);
+    // A ray missing the mesh.
+    EXPECT_FALSE(stressTensorProbe.probeAlongRay(glm::vec3(2.0f), glm::vec3(1.0f, 0.0f, 0.0f), result));
+}
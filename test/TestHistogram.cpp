@@ -0,0 +1,157 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <random>
+#include <glm/glm.hpp>
+#include "gtest/gtest.h"
+#include "Utils/Histogram.hpp"
+
+/// Straightforward single-threaded histogram the parallel implementation is compared against.
+static std::vector<uint32_t> computeHistogramSerial(
+        const std::vector<float>& values, const glm::vec2& range, int numBins) {
+    std::vector<uint32_t> histogram(numBins, 0);
+    const float rangeExtentInv = 1.0f / (range.y - range.x);
+    for (float value : values) {
+        int binIdx = int((value - range.x) * rangeExtentInv * float(numBins));
+        histogram.at(glm::clamp(binIdx, 0, numBins - 1))++;
+    }
+    return histogram;
+}
+
+static std::vector<float> createRandomValues(size_t numValues, float minValue, float maxValue, uint32_t seed) {
+    std::default_random_engine generator(seed);
+    std::uniform_real_distribution<float> distribution(minValue, maxValue);
+    std::vector<float> values(numValues);
+    for (float& value : values) {
+        value = distribution(generator);
+    }
+    return values;
+}
+
+static void normalizeHistogram(const std::vector<uint32_t>& histogram, std::vector<float>& normalizedHistogram) {
+    uint32_t histogramMax = 0;
+    for (uint32_t binCount : histogram) {
+        histogramMax = std::max(histogramMax, binCount);
+    }
+    normalizedHistogram.resize(histogram.size());
+    for (size_t binIdx = 0; binIdx < histogram.size(); binIdx++) {
+        normalizedHistogram.at(binIdx) = float(histogram.at(binIdx)) / float(histogramMax);
+    }
+}
+
+/**
+ * All histograms computed in one parallel pass need to match the serial reference, including values outside of the
+ * range, which are clamped to the first or last bin.
+ */
+TEST(HistogramTest, ComputeHistogramsMatchesSerial) {
+    std::vector<float> values = createRandomValues(1000003, -0.5f, 2.5f, 17);
+    const glm::vec2 range(0.0f, 2.0f);
+    const std::vector<int> binCounts = { 1, 7, 64, 255, 4096 };
+    std::vector<std::vector<uint32_t>> histograms;
+    computeHistograms(values.data(), values.size(), range, binCounts, histograms);
+    ASSERT_EQ(histograms.size(), binCounts.size());
+    for (size_t histogramIdx = 0; histogramIdx < binCounts.size(); histogramIdx++) {
+        EXPECT_EQ(histograms.at(histogramIdx), computeHistogramSerial(values, range, binCounts.at(histogramIdx)));
+    }
+}
+
+/// Bins are half-open intervals, except for the last bin, which also contains the maximum of the range.
+TEST(HistogramTest, BinEdges) {
+    std::vector<float> values = { -1.0f, 0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f };
+    std::vector<std::vector<uint32_t>> histograms;
+    computeHistograms(values.data(), values.size(), glm::vec2(0.0f, 4.0f), { 4 }, histograms);
+    std::vector<uint32_t> expectedHistogram = { 2, 1, 1, 3 };
+    EXPECT_EQ(histograms.front(), expectedHistogram);
+}
+
+/// A range with min == max must not divide by zero; all values land in the first bin.
+TEST(HistogramTest, MinEqualsMax) {
+    std::vector<float> values(100, 3.0f);
+    std::vector<std::vector<uint32_t>> histograms;
+    computeHistograms(values.data(), values.size(), glm::vec2(3.0f), { 1, 16 }, histograms);
+    EXPECT_EQ(histograms.at(0).front(), 100u);
+    EXPECT_EQ(histograms.at(1).front(), 100u);
+    for (size_t binIdx = 1; binIdx < histograms.at(1).size(); binIdx++) {
+        EXPECT_EQ(histograms.at(1).at(binIdx), 0u);
+    }
+
+    AttributeHistogram attributeHistogram;
+    attributeHistogram.build(values);
+    std::vector<float> histogram;
+    attributeHistogram.getNormalizedHistogram(attributeHistogram.getDataRange(), 16, histogram);
+    ASSERT_EQ(histogram.size(), size_t(16));
+    EXPECT_EQ(histogram.front(), 1.0f);
+    for (size_t binIdx = 1; binIdx < histogram.size(); binIdx++) {
+        EXPECT_EQ(histogram.at(binIdx), 0.0f);
+    }
+}
+
+/// Over the data range, bin counts dividing the fine resolution are derived exactly from the fine histogram.
+TEST(HistogramTest, DerivedHistogramExactOverDataRange) {
+    std::vector<float> values = createRandomValues(200000, 1.0f, 5.0f, 3);
+    AttributeHistogram attributeHistogram;
+    attributeHistogram.build(values);
+    const glm::vec2 dataRange = attributeHistogram.getDataRange();
+    for (int numBins : { 1, 16, 64, 256 }) {
+        std::vector<float> histogram, expectedHistogram;
+        attributeHistogram.getNormalizedHistogram(dataRange, numBins, histogram);
+        normalizeHistogram(computeHistogramSerial(values, dataRange, numBins), expectedHistogram);
+        EXPECT_EQ(histogram, expectedHistogram);
+    }
+}
+
+/**
+ * A selected range covering fewer fine bins than display bins must not show gaps between the fine bins. The fine bins
+ * are spread over the display bins they overlap, which matches the exact histogram for evenly distributed values.
+ */
+TEST(HistogramTest, NarrowSelectedRangeHasNoGaps) {
+    const size_t numValues = 1000000;
+    std::vector<float> values(numValues);
+    for (size_t i = 0; i < numValues; i++) {
+        values.at(i) = float(i) / float(numValues - 1);
+    }
+    AttributeHistogram attributeHistogram;
+    attributeHistogram.build(values);
+    const glm::vec2 selectedRange(0.5f, 0.51f);
+    const int numBins = 256;
+    ASSERT_LT((selectedRange.y - selectedRange.x) * float(AttributeHistogram::FINE_RESOLUTION), float(numBins));
+    std::vector<float> histogram, expectedHistogram;
+    attributeHistogram.getNormalizedHistogram(selectedRange, numBins, histogram);
+    normalizeHistogram(computeHistogramSerial(values, selectedRange, numBins), expectedHistogram);
+    ASSERT_EQ(histogram.size(), expectedHistogram.size());
+
+    // The first and last bin also contain the values outside of the selected range.
+    EXPECT_EQ(histogram.front(), 1.0f);
+    EXPECT_EQ(expectedHistogram.front(), 1.0f);
+    EXPECT_NEAR(histogram.back(), expectedHistogram.back(), 1e-3f);
+    for (int binIdx = 1; binIdx < numBins - 1; binIdx++) {
+        EXPECT_GT(histogram.at(binIdx), 0.0f);
+        EXPECT_NEAR(histogram.at(binIdx) / expectedHistogram.at(binIdx), 1.0f, 0.05f);
+    }
+}
@@ -27,10 +27,12 @@
  */
 
 #include <random>
+#include <algorithm>
 #include <glm/glm.hpp>
 #include "gtest/gtest.h"
 #include "LineData/SearchStructures/NearestNeighborNaive.hpp"
 #include "LineData/SearchStructures/KdTree.hpp"
+#include "LineData/SearchStructures/FlatKdTree.hpp"
 
 class KdTreeNearestNeighborTest : public ::testing::TestWithParam<int> {
 protected:
@@ -40,6 +42,7 @@ protected:
         pointSetFind.resize(N);
         distancesSlow.resize(N);
         distancesKdTree.resize(N);
+        distancesFlatKdTree.resize(N);
 
         // Compute search point data.
         std::default_random_engine generator(12345);
@@ -55,10 +58,7 @@ protected:
                     distribution(generator), distribution(generator), distribution(generator));
         }
 
-        // Build the search structure on the points.
-        KdTree kdTree;
-        std::vector<IndexedPoint> indexedPoints;
-        std::vector<IndexedPoint*> indexedPointsPointers;
+        // Build the search structures on the points.
         indexedPoints.resize(pointSetSearch.size());
         indexedPointsPointers.reserve(pointSetSearch.size());
         for (size_t i = 0; i < pointSetSearch.size(); i++) {
@@ -68,11 +68,14 @@ protected:
             indexedPointsPointers.push_back(indexedPoint);
         }
         kdTree.build(indexedPointsPointers);
+        flatKdTree.build(indexedPointsPointers);
 
         // Get the k-d-tree distances.
         for (int i = 0; i < N; i++) {
             IndexedPoint* nearestNeighbor = kdTree.findNearestNeighbor(pointSetFind.at(i));
             distancesKdTree.at(i) = glm::distance(pointSetFind.at(i), nearestNeighbor->position);
+            nearestNeighbor = flatKdTree.findNearestNeighbor(pointSetFind.at(i));
+            distancesFlatKdTree.at(i) = glm::distance(pointSetFind.at(i), nearestNeighbor->position);
         }
 
         // Get the ground-truth distances.
@@ -87,10 +90,14 @@ protected:
 
     int N = 0;
     KdTree kdTree;
+    FlatKdTree flatKdTree;
+    std::vector<IndexedPoint> indexedPoints;
+    std::vector<IndexedPoint*> indexedPointsPointers;
     std::vector<glm::vec3> pointSetSearch;
     std::vector<glm::vec3> pointSetFind;
     std::vector<float> distancesSlow;
     std::vector<float> distancesKdTree;
+    std::vector<float> distancesFlatKdTree;
 };
 
 TEST_P(KdTreeNearestNeighborTest, DistanceCorrect){
@@ -99,5 +106,105 @@ TEST_P(KdTreeNearestNeighborTest, DistanceCorrect){
     }
 }
 
+TEST_P(KdTreeNearestNeighborTest, FlatDistanceCorrect){
+    for (int i = 0; i < N; i++) {
+        EXPECT_FLOAT_EQ(distancesSlow.at(i), distancesFlatKdTree.at(i));
+    }
+}
+
+/// Returns the sorted indices of the passed points for comparing the results of area searches.
+static std::vector<ptrdiff_t> getSortedIndices(const std::vector<IndexedPoint*>& points) {
+    std::vector<ptrdiff_t> indices;
+    indices.reserve(points.size());
+    for (IndexedPoint* point : points) {
+        indices.push_back(point->index);
+    }
+    std::sort(indices.begin(), indices.end());
+    return indices;
+}
+
+TEST_P(KdTreeNearestNeighborTest, FlatAreaSearchCorrect){
+    std::default_random_engine generator(54321);
+    std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+    for (int i = 0; i < 16; i++) {
+        glm::vec3 center(distribution(generator), distribution(generator), distribution(generator));
+        float radius = 0.5f * distribution(generator);
+
+        EXPECT_EQ(
+                getSortedIndices(kdTree.findPointsInSphere(center, radius)),
+                getSortedIndices(flatKdTree.findPointsInSphere(center, radius)));
+
+        AxisAlignedBox box;
+        box.min = center - glm::vec3(radius, 0.5f * radius, 2.0f * radius);
+        box.max = center + glm::vec3(0.5f * radius, radius, radius);
+        EXPECT_EQ(
+                getSortedIndices(kdTree.findPointsInAxisAlignedBox(box)),
+                getSortedIndices(flatKdTree.findPointsInAxisAlignedBox(box)));
+    }
+}
+
+TEST_P(KdTreeNearestNeighborTest, FlatKNearestNeighborsCorrect){
+    const size_t k = 5;
+    std::vector<IndexedPoint*> kNearestNeighborsBatch;
+    flatKdTree.findKNearestNeighbors(pointSetFind, k, kNearestNeighborsBatch);
+    ASSERT_EQ(kNearestNeighborsBatch.size(), size_t(N) * k);
+
+    std::vector<IndexedPoint*> kNearestNeighbors;
+    for (int i = 0; i < N; i++) {
+        // Ground truth: The k smallest distances to the search points.
+        std::vector<float> distancesSorted;
+        for (const glm::vec3& point : pointSetSearch) {
+            distancesSorted.push_back(glm::distance(pointSetFind.at(i), point));
+        }
+        std::sort(distancesSorted.begin(), distancesSorted.end());
+        size_t numNeighbors = std::min(k, distancesSorted.size());
+
+        flatKdTree.findKNearestNeighbors(pointSetFind.at(i), k, kNearestNeighbors);
+        ASSERT_EQ(kNearestNeighbors.size(), numNeighbors);
+        for (size_t j = 0; j < numNeighbors; j++) {
+            EXPECT_FLOAT_EQ(
+                    distancesSorted.at(j), glm::distance(pointSetFind.at(i), kNearestNeighbors.at(j)->position));
+            EXPECT_EQ(kNearestNeighborsBatch.at(i * k + j), kNearestNeighbors.at(j));
+        }
+        for (size_t j = numNeighbors; j < k; j++) {
+            EXPECT_EQ(kNearestNeighborsBatch.at(i * k + j), nullptr);
+        }
+    }
+}
+
+TEST_P(KdTreeNearestNeighborTest, FlatBatchQueriesCorrect){
+    std::vector<IndexedPoint*> nearestNeighbors;
+    flatKdTree.findNearestNeighbors(pointSetFind, nearestNeighbors);
+    ASSERT_EQ(nearestNeighbors.size(), size_t(N));
+    for (int i = 0; i < N; i++) {
+        EXPECT_FLOAT_EQ(distancesSlow.at(i), glm::distance(pointSetFind.at(i), nearestNeighbors.at(i)->position));
+    }
+
+    const float radius = 0.2f;
+    std::vector<std::vector<IndexedPoint*>> pointsInSpheres;
+    flatKdTree.findPointsInSpheres(pointSetFind, radius, pointsInSpheres);
+    ASSERT_EQ(pointsInSpheres.size(), size_t(N));
+    for (int i = 0; i < N; i++) {
+        EXPECT_EQ(
+                getSortedIndices(kdTree.findPointsInSphere(pointSetFind.at(i), radius)),
+                getSortedIndices(pointsInSpheres.at(i)));
+    }
+}
+
 INSTANTIATE_TEST_SUITE_P(DistanceRangeTest, KdTreeNearestNeighborTest, ::testing::Values(
         2, 3, 4, 5, 6, 7, 8, 10, 128, 1024));
+
+TEST(FlatKdTreeTest, FlatEmptyTree){
+    FlatKdTree flatKdTree;
+    flatKdTree.build({});
+    EXPECT_EQ(flatKdTree.findNearestNeighbor(glm::vec3(0.0f)), nullptr);
+    EXPECT_TRUE(flatKdTree.findPointsInSphere(glm::vec3(0.0f), 1.0f).empty());
+    std::vector<IndexedPoint*> kNearestNeighbors;
+    flatKdTree.findKNearestNeighbors(glm::vec3(0.0f), 3, kNearestNeighbors);
+    EXPECT_TRUE(kNearestNeighbors.empty());
+    std::vector<IndexedPoint*> nearestNeighbors;
+    flatKdTree.findNearestNeighbors({ glm::vec3(0.0f), glm::vec3(1.0f) }, nearestNeighbors);
+    ASSERT_EQ(nearestNeighbors.size(), 2u);
+    EXPECT_EQ(nearestNeighbors.at(0), nullptr);
+}
+
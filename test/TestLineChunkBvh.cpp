@@ -0,0 +1,298 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+#include <random>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include "gtest/gtest.h"
+#include "LineData/SearchStructures/LineChunkBvh.hpp"
+
+/**
+ * Tests the frustum culling of line segment chunks on random walk lines. The parameter is the maximum number of line
+ * segments per chunk.
+ */
+class LineChunkBvhTest : public ::testing::TestWithParam<int> {
+protected:
+    void SetUp() override {
+        std::default_random_engine generator(12345);
+        std::uniform_real_distribution<float> positionDistribution(0.0f, 1.0f);
+        std::uniform_real_distribution<float> stepDistribution(-0.01f, 0.01f);
+        std::uniform_int_distribution<int> lengthDistribution(2, 300);
+
+        const int numLines = 500;
+        for (int lineIdx = 0; lineIdx < numLines; lineIdx++) {
+            glm::vec3 position(
+                    positionDistribution(generator), positionDistribution(generator), positionDistribution(generator));
+            int numLinePoints = lengthDistribution(generator);
+            auto vertexOffset = uint32_t(vertexPositions.size());
+            for (int i = 0; i < numLinePoints; i++) {
+                vertexPositions.push_back(position);
+                position += glm::vec3(
+                        stepDistribution(generator), stepDistribution(generator), stepDistribution(generator));
+                if (i > 0) {
+                    lineIndices.push_back(vertexOffset + i - 1);
+                    lineIndices.push_back(vertexOffset + i);
+                }
+            }
+        }
+
+        bvh.build(lineIndices, vertexPositions, uint32_t(GetParam()));
+    }
+
+    static glm::mat4 getViewProjectionMatrix(const glm::vec3& cameraPosition, const glm::vec3& lookAtPosition) {
+        glm::mat4 viewMatrix = glm::lookAt(cameraPosition, lookAtPosition, glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::mat4 projectionMatrix = glm::perspective(glm::radians(60.0f), 1.0f, 0.01f, 100.0f);
+        return projectionMatrix * viewMatrix;
+    }
+
+    static bool getIsPointInClipVolume(const glm::mat4& viewProjectionMatrix, const glm::vec3& position) {
+        glm::vec4 clipPosition = viewProjectionMatrix * glm::vec4(position, 1.0f);
+        return clipPosition.w > 0.0f
+                && std::abs(clipPosition.x) <= clipPosition.w && std::abs(clipPosition.y) <= clipPosition.w
+                && std::abs(clipPosition.z) <= clipPosition.w;
+    }
+
+    /// Checks that the ranges are sorted, merged and lie inside of the index list.
+    void checkRangesValid(const std::vector<LineIndexRange>& ranges) {
+        for (size_t i = 0; i < ranges.size(); i++) {
+            EXPECT_GT(ranges.at(i).numIndices, 0u);
+            EXPECT_EQ(ranges.at(i).indexOffset % 2, 0u);
+            EXPECT_LE(ranges.at(i).indexOffset + ranges.at(i).numIndices, lineIndices.size());
+            if (i > 0) {
+                EXPECT_GT(ranges.at(i).indexOffset, ranges.at(i - 1).indexOffset + ranges.at(i - 1).numIndices);
+            }
+        }
+    }
+
+    std::vector<uint32_t> lineIndices;
+    std::vector<glm::vec3> vertexPositions;
+    LineChunkBvh bvh;
+};
+
+TEST_P(LineChunkBvhTest, AllVisible) {
+    glm::mat4 viewProjectionMatrix = getViewProjectionMatrix(glm::vec3(0.5f, 0.5f, 4.0f), glm::vec3(0.5f));
+    std::vector<LineIndexRange> visibleRanges;
+    LineCullingStatistics statistics;
+    bvh.cull(ViewFrustum(viewProjectionMatrix), visibleRanges, &statistics);
+    ASSERT_EQ(visibleRanges.size(), 1u);
+    EXPECT_EQ(visibleRanges.front().indexOffset, 0u);
+    EXPECT_EQ(visibleRanges.front().numIndices, lineIndices.size());
+    EXPECT_EQ(statistics.numVisibleIndices, lineIndices.size());
+    EXPECT_FLOAT_EQ(statistics.getCulledFraction(), 0.0f);
+}
+
+TEST_P(LineChunkBvhTest, NothingVisible) {
+    // The camera looks away from the data.
+    glm::mat4 viewProjectionMatrix = getViewProjectionMatrix(glm::vec3(0.5f, 0.5f, 4.0f), glm::vec3(0.5f, 0.5f, 8.0f));
+    std::vector<LineIndexRange> visibleRanges;
+    LineCullingStatistics statistics;
+    bvh.cull(ViewFrustum(viewProjectionMatrix), visibleRanges, &statistics);
+    EXPECT_TRUE(visibleRanges.empty());
+    EXPECT_FLOAT_EQ(statistics.getCulledFraction(), 1.0f);
+}
+
+TEST_P(LineChunkBvhTest, Conservative) {
+    std::default_random_engine generator(54321);
+    std::uniform_real_distribution<float> distribution(-0.5f, 1.5f);
+    for (int viewIdx = 0; viewIdx < 20; viewIdx++) {
+        glm::vec3 cameraPosition(distribution(generator), distribution(generator), distribution(generator));
+        glm::vec3 lookAtPosition(distribution(generator), distribution(generator), distribution(generator));
+        glm::mat4 viewProjectionMatrix = getViewProjectionMatrix(cameraPosition, lookAtPosition);
+        std::vector<LineIndexRange> visibleRanges;
+        bvh.cull(ViewFrustum(viewProjectionMatrix), visibleRanges);
+        checkRangesValid(visibleRanges);
+
+        std::vector<bool> isIndexVisible(lineIndices.size(), false);
+        for (const LineIndexRange& range : visibleRanges) {
+            for (uint32_t idx = range.indexOffset; idx < range.indexOffset + range.numIndices; idx++) {
+                isIndexVisible.at(idx) = true;
+            }
+        }
+        for (size_t idx = 0; idx < lineIndices.size(); idx++) {
+            if (getIsPointInClipVolume(viewProjectionMatrix, vertexPositions.at(lineIndices.at(idx)))) {
+                ASSERT_TRUE(isIndexVisible.at(idx));
+            }
+        }
+    }
+}
+
+TEST_P(LineChunkBvhTest, CullsZoomedInView) {
+    glm::mat4 viewProjectionMatrix = getViewProjectionMatrix(glm::vec3(0.1f, 0.1f, 0.3f), glm::vec3(0.1f, 0.1f, 0.0f));
+    std::vector<LineIndexRange> visibleRanges;
+    LineCullingStatistics statistics;
+    bvh.cull(ViewFrustum(viewProjectionMatrix), visibleRanges, &statistics);
+    checkRangesValid(visibleRanges);
+    EXPECT_GT(statistics.getCulledFraction(), 0.5f);
+}
+
+INSTANTIATE_TEST_SUITE_P(ChunkSizeTest, LineChunkBvhTest, ::testing::Values(1, 16, 256));
+
+TEST(LineChunkBvhRadiusTest, TubeSurfaceInsideFrustum) {
+    // A line just outside of the left frustum plane, whose tube surface reaches into the frustum.
+    std::vector<glm::vec3> vertexPositions = { glm::vec3(-1.2f, -0.1f, 0.0f), glm::vec3(-1.2f, 0.1f, 0.0f) };
+    std::vector<uint32_t> lineIndices = { 0, 1 };
+    const float lineRadius = 0.05f;
+    glm::mat4 viewMatrix = glm::lookAt(glm::vec3(0.0f, 0.0f, 2.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projectionMatrix = glm::perspective(glm::radians(60.0f), 1.0f, 0.01f, 100.0f);
+    glm::mat4 viewProjectionMatrix = projectionMatrix * viewMatrix;
+    for (const glm::vec3& vertexPosition : vertexPositions) {
+        glm::vec4 clipPositionCenter = viewProjectionMatrix * glm::vec4(vertexPosition, 1.0f);
+        glm::vec4 clipPositionSurface =
+                viewProjectionMatrix * glm::vec4(vertexPosition + glm::vec3(lineRadius, 0.0f, 0.0f), 1.0f);
+        ASSERT_LT(clipPositionCenter.x, -clipPositionCenter.w);
+        ASSERT_GT(clipPositionSurface.x, -clipPositionSurface.w);
+    }
+    ViewFrustum frustum(viewProjectionMatrix);
+
+    LineChunkBvh bvh;
+    bvh.build(lineIndices, vertexPositions);
+    std::vector<LineIndexRange> visibleRanges;
+    bvh.cull(frustum, visibleRanges, nullptr, 0.0f);
+    EXPECT_TRUE(visibleRanges.empty());
+    bvh.cull(frustum, visibleRanges, nullptr, lineRadius);
+    ASSERT_EQ(visibleRanges.size(), 1u);
+    EXPECT_EQ(visibleRanges.front().numIndices, 2u);
+
+    // The radius is scaled per vertex, e.g., by the length of band offsets.
+    std::vector<float> vertexRadiusScales = { 2.0f, 1.0f };
+    bvh.cull(frustum, visibleRanges, nullptr, 0.5f * lineRadius);
+    EXPECT_TRUE(visibleRanges.empty());
+    bvh.build(lineIndices, vertexPositions, 256, &vertexRadiusScales);
+    bvh.cull(frustum, visibleRanges, nullptr, 0.5f * lineRadius);
+    EXPECT_EQ(visibleRanges.size(), 1u);
+}
+
+/**
+ * A straight line along the x axis with 1024 segments, split into chunks of 64 segments. All interior vertices can be
+ * removed on the coarse level, except for every 16th vertex, which is kept on the fine level.
+ */
+class LineChunkBvhLevelOfDetailTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        const uint32_t numLinePoints = 1025;
+        for (uint32_t i = 0; i < numLinePoints; i++) {
+            vertexPositions.push_back(glm::vec3(float(i) * 0.01f, 0.0f, 0.0f));
+            if (i == 0 || i == numLinePoints - 1) {
+                vertexErrors.push_back(1e6f);
+            } else {
+                vertexErrors.push_back(i % 16 == 0 ? 0.5f : 0.05f);
+            }
+            if (i > 0) {
+                lineIndices.push_back(i - 1);
+                lineIndices.push_back(i);
+            }
+        }
+        numIndices = lineIndices.size();
+        bvh.build(lineIndices, vertexPositions, 64);
+        bvh.buildLevelsOfDetail(lineIndices, vertexErrors, { 0.01f, 0.1f, 0.2f, 1.0f });
+    }
+
+    size_t countIndices(const std::vector<LineIndexRange>& ranges) {
+        size_t numRangeIndices = 0;
+        for (const LineIndexRange& range : ranges) {
+            numRangeIndices += range.numIndices;
+        }
+        return numRangeIndices;
+    }
+
+    std::vector<glm::vec3> vertexPositions;
+    std::vector<float> vertexErrors;
+    std::vector<uint32_t> lineIndices;
+    size_t numIndices = 0;
+    LineChunkBvh bvh;
+};
+
+TEST_F(LineChunkBvhLevelOfDetailTest, LevelSelection) {
+    // The level 0.01 removes no vertex, and 0.2 removes the same vertices as 0.1. Only 0.1 and 1.0 are kept.
+    ASSERT_EQ(bvh.getLevelErrors().size(), 2u);
+    EXPECT_EQ(bvh.getLevelErrors().at(0), 0.1f);
+    EXPECT_EQ(bvh.getLevelErrors().at(1), 1.0f);
+    // 16 chunks with 4 segments on the fine level and 1 segment on the coarse level.
+    EXPECT_EQ(lineIndices.size(), numIndices + 16 * (4 + 1) * 2);
+
+    ViewFrustum frustum;
+    std::vector<LineIndexRange> visibleRanges;
+    LineLevelOfDetailSelection levelOfDetail;
+    levelOfDetail.errorPerDistance = 1.0f;
+
+    // Far away, all chunks use the coarse level (merged to one range, as the chunks are ordered).
+    levelOfDetail.cameraPosition = glm::vec3(5.0f, 0.0f, 100.0f);
+    bvh.cull(frustum, visibleRanges, nullptr, 0.0f, &levelOfDetail);
+    ASSERT_EQ(visibleRanges.size(), 1u);
+    EXPECT_EQ(visibleRanges.front().indexOffset, numIndices + 16 * 4 * 2);
+    EXPECT_EQ(visibleRanges.front().numIndices, 16u * 2u);
+
+    // Inside of the first chunk, it is drawn at full resolution.
+    levelOfDetail.cameraPosition = glm::vec3(0.1f, 0.0f, 0.0f);
+    bvh.cull(frustum, visibleRanges, nullptr, 0.0f, &levelOfDetail);
+    ASSERT_FALSE(visibleRanges.empty());
+    EXPECT_EQ(visibleRanges.front().indexOffset, 0u);
+    EXPECT_EQ(visibleRanges.front().numIndices, 128u);
+    EXPECT_LT(countIndices(visibleRanges), numIndices);
+
+    // Without the selection, the full resolution list is drawn.
+    bvh.cull(frustum, visibleRanges);
+    ASSERT_EQ(visibleRanges.size(), 1u);
+    EXPECT_EQ(visibleRanges.front().indexOffset, 0u);
+    EXPECT_EQ(visibleRanges.front().numIndices, numIndices);
+}
+
+TEST_F(LineChunkBvhLevelOfDetailTest, IndexRangeRestriction) {
+    ViewFrustum frustum;
+    std::vector<LineIndexRange> visibleRanges;
+    LineLevelOfDetailSelection levelOfDetail;
+    levelOfDetail.cameraPosition = glm::vec3(5.0f, 0.0f, 100.0f);
+    levelOfDetail.errorPerDistance = 1.0f;
+
+    // The first four chunks are contained and use the coarse level. The fifth chunk is only partly contained and
+    // drawn at full resolution.
+    std::vector<LineIndexRange> indexRanges = { LineIndexRange(0, 4 * 128 + 20) };
+    bvh.cull(frustum, visibleRanges, nullptr, 0.0f, &levelOfDetail, &indexRanges);
+    ASSERT_EQ(visibleRanges.size(), 2u);
+    EXPECT_EQ(visibleRanges.at(0).indexOffset, 4u * 128u);
+    EXPECT_EQ(visibleRanges.at(0).numIndices, 20u);
+    EXPECT_EQ(visibleRanges.at(1).indexOffset, numIndices + 16 * 4 * 2);
+    EXPECT_EQ(visibleRanges.at(1).numIndices, 4u * 2u);
+}
+
+TEST(LineIndexRangesTest, Intersection) {
+    std::vector<LineIndexRange> ranges0 = { LineIndexRange(0, 10), LineIndexRange(20, 10) };
+    std::vector<LineIndexRange> ranges1 = { LineIndexRange(4, 2), LineIndexRange(8, 16), LineIndexRange(28, 10) };
+    std::vector<LineIndexRange> intersectedRanges;
+    intersectLineIndexRanges(ranges0, ranges1, intersectedRanges);
+    ASSERT_EQ(intersectedRanges.size(), 4u);
+    EXPECT_EQ(intersectedRanges.at(0).indexOffset, 4u);
+    EXPECT_EQ(intersectedRanges.at(0).numIndices, 2u);
+    EXPECT_EQ(intersectedRanges.at(1).indexOffset, 8u);
+    EXPECT_EQ(intersectedRanges.at(1).numIndices, 2u);
+    EXPECT_EQ(intersectedRanges.at(2).indexOffset, 20u);
+    EXPECT_EQ(intersectedRanges.at(2).numIndices, 4u);
+    EXPECT_EQ(intersectedRanges.at(3).indexOffset, 28u);
+    EXPECT_EQ(intersectedRanges.at(3).numIndices, 2u);
+}
@@ -0,0 +1,224 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+#include <random>
+#include <cstring>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "gtest/gtest.h"
+#include "LineData/LinePreprocessingCache.hpp"
+#include "LineData/LineMeshlets.hpp"
+
+/**
+ * Tests the meshlet clustering on random walk lines of varying length. The parameter is the maximum number of
+ * vertices per meshlet.
+ */
+class LineMeshletsTest : public ::testing::TestWithParam<int> {
+protected:
+    void SetUp() override {
+        std::default_random_engine generator(12345);
+        std::uniform_real_distribution<float> positionDistribution(0.0f, 1.0f);
+        std::uniform_real_distribution<float> stepDistribution(-0.01f, 0.01f);
+        std::uniform_int_distribution<int> lengthDistribution(2, 300);
+
+        const int numLines = 500;
+        for (int lineIdx = 0; lineIdx < numLines; lineIdx++) {
+            glm::vec3 position(
+                    positionDistribution(generator), positionDistribution(generator), positionDistribution(generator));
+            // Also test lines consisting of a single segment.
+            uint32_t numLinePoints = lineIdx % 50 == 0 ? 2 : uint32_t(lengthDistribution(generator));
+            auto vertexOffset = uint32_t(lineData.vertexPositions.size());
+            lineData.lineTrajectoryIndices.push_back(uint32_t(lineIdx));
+            lineData.lineVertexOffsets.push_back(vertexOffset);
+            lineData.lineNumVertices.push_back(numLinePoints);
+            for (uint32_t i = 0; i < numLinePoints; i++) {
+                glm::vec3 step(stepDistribution(generator), stepDistribution(generator), stepDistribution(generator));
+                lineData.vertexPointIndices.push_back(i);
+                lineData.vertexPositions.push_back(position);
+                lineData.vertexTangents.push_back(glm::normalize(step + glm::vec3(0.0f, 0.0f, 0.001f)));
+                lineData.vertexNormals.push_back(glm::vec3(1.0f, 0.0f, 0.0f));
+                position += step;
+                if (i > 0) {
+                    lineData.lineIndices.push_back(vertexOffset + i - 1);
+                    lineData.lineIndices.push_back(vertexOffset + i);
+                }
+            }
+        }
+    }
+
+    static glm::mat4 getViewProjectionMatrix(const glm::vec3& cameraPosition, const glm::vec3& lookAtPosition) {
+        glm::mat4 viewMatrix = glm::lookAt(cameraPosition, lookAtPosition, glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::mat4 projectionMatrix = glm::perspective(glm::radians(60.0f), 1.0f, 0.01f, 100.0f);
+        return projectionMatrix * viewMatrix;
+    }
+
+    static bool getIsPointInClipVolume(const glm::mat4& viewProjectionMatrix, const glm::vec3& position) {
+        glm::vec4 clipPosition = viewProjectionMatrix * glm::vec4(position, 1.0f);
+        return clipPosition.w > 0.0f
+                && std::abs(clipPosition.x) <= clipPosition.w && std::abs(clipPosition.y) <= clipPosition.w
+                && std::abs(clipPosition.z) <= clipPosition.w;
+    }
+
+    LinePreprocessedData lineData;
+};
+
+TEST_P(LineMeshletsTest, ThreadCountIndependent) {
+#ifdef _OPENMP
+    const int maxNumThreads = omp_get_max_threads();
+    LineMeshletData meshletDataSingleThread;
+    omp_set_num_threads(1);
+    buildLineMeshlets(lineData, uint32_t(GetParam()), meshletDataSingleThread);
+    LineMeshletData meshletDataMultiThread;
+    omp_set_num_threads(std::max(maxNumThreads, 4));
+    buildLineMeshlets(lineData, uint32_t(GetParam()), meshletDataMultiThread);
+    omp_set_num_threads(maxNumThreads);
+
+    ASSERT_EQ(meshletDataSingleThread.meshlets.size(), meshletDataMultiThread.meshlets.size());
+    EXPECT_EQ(memcmp(
+            meshletDataSingleThread.meshlets.data(), meshletDataMultiThread.meshlets.data(),
+            meshletDataSingleThread.meshlets.size() * sizeof(LineMeshlet)), 0);
+    EXPECT_EQ(meshletDataSingleThread.localIndices, meshletDataMultiThread.localIndices);
+#else
+    GTEST_SKIP() << "Built without OpenMP support.";
+#endif
+}
+
+TEST_P(LineMeshletsTest, SegmentsCoveredExactlyOnce) {
+    const auto maxNumVertices = uint32_t(GetParam());
+    LineMeshletData meshletData;
+    buildLineMeshlets(lineData, maxNumVertices, meshletData);
+    ASSERT_FALSE(meshletData.meshlets.empty());
+
+    // Line segments are identified by their first vertex.
+    std::vector<int> segmentCoverCounts(lineData.getNumVertices(), 0);
+    uint32_t expectedIndexOffset = 0;
+    for (const LineMeshlet& meshlet : meshletData.meshlets) {
+        EXPECT_LE(meshlet.numVertices, maxNumVertices);
+        EXPECT_EQ(meshlet.indexOffset, expectedIndexOffset);
+        EXPECT_EQ(meshlet.numIndices % 2, 0u);
+        expectedIndexOffset += meshlet.numIndices;
+        ASSERT_LE(size_t(meshlet.indexOffset) + meshlet.numIndices, meshletData.localIndices.size());
+        for (uint32_t idx = meshlet.indexOffset; idx < meshlet.indexOffset + meshlet.numIndices; idx += 2) {
+            uint16_t localIdx0 = meshletData.localIndices.at(idx);
+            uint16_t localIdx1 = meshletData.localIndices.at(idx + 1);
+            ASSERT_LT(localIdx1, meshlet.numVertices);
+            ASSERT_EQ(localIdx0 + 1, localIdx1);
+            segmentCoverCounts.at(meshlet.vertexOffset + localIdx0)++;
+        }
+        for (uint32_t vertexIdx = meshlet.vertexOffset; vertexIdx < meshlet.vertexOffset + meshlet.numVertices;
+                vertexIdx++) {
+            float distance = glm::length(lineData.vertexPositions.at(vertexIdx) - meshlet.boundingSphereCenter);
+            EXPECT_LE(distance, meshlet.boundingSphereRadius * 1.0001f + 1e-6f);
+        }
+    }
+    EXPECT_EQ(size_t(expectedIndexOffset), meshletData.localIndices.size());
+
+    std::vector<int> expectedSegmentCoverCounts(lineData.getNumVertices(), 0);
+    for (size_t idx = 0; idx < lineData.lineIndices.size(); idx += 2) {
+        expectedSegmentCoverCounts.at(lineData.lineIndices.at(idx))++;
+    }
+    EXPECT_EQ(segmentCoverCounts, expectedSegmentCoverCounts);
+}
+
+TEST_P(LineMeshletsTest, CullingIsConservative) {
+    LineMeshletData meshletData;
+    buildLineMeshlets(lineData, uint32_t(GetParam()), meshletData);
+
+    // All meshlets are visible if the camera sees the whole data set, and none if the camera looks away.
+    std::vector<uint32_t> visibleMeshletIndices;
+    LineCullingStatistics statistics;
+    glm::mat4 viewProjectionMatrix = getViewProjectionMatrix(glm::vec3(0.5f, 0.5f, 4.0f), glm::vec3(0.5f));
+    cullLineMeshlets(meshletData.meshlets, ViewFrustum(viewProjectionMatrix), visibleMeshletIndices, &statistics);
+    EXPECT_EQ(visibleMeshletIndices.size(), meshletData.meshlets.size());
+    EXPECT_FLOAT_EQ(statistics.getCulledFraction(), 0.0f);
+    viewProjectionMatrix = getViewProjectionMatrix(glm::vec3(0.5f, 0.5f, 4.0f), glm::vec3(0.5f, 0.5f, 8.0f));
+    cullLineMeshlets(meshletData.meshlets, ViewFrustum(viewProjectionMatrix), visibleMeshletIndices, &statistics);
+    EXPECT_TRUE(visibleMeshletIndices.empty());
+    EXPECT_FLOAT_EQ(statistics.getCulledFraction(), 1.0f);
+
+    std::default_random_engine generator(54321);
+    std::uniform_real_distribution<float> distribution(-0.5f, 1.5f);
+    for (int viewIdx = 0; viewIdx < 20; viewIdx++) {
+        glm::vec3 cameraPosition(distribution(generator), distribution(generator), distribution(generator));
+        glm::vec3 lookAtPosition(distribution(generator), distribution(generator), distribution(generator));
+        viewProjectionMatrix = getViewProjectionMatrix(cameraPosition, lookAtPosition);
+        cullLineMeshlets(meshletData.meshlets, ViewFrustum(viewProjectionMatrix), visibleMeshletIndices);
+        std::vector<bool> isMeshletVisible(meshletData.meshlets.size(), false);
+        for (uint32_t meshletIdx : visibleMeshletIndices) {
+            isMeshletVisible.at(meshletIdx) = true;
+        }
+        for (size_t meshletIdx = 0; meshletIdx < meshletData.meshlets.size(); meshletIdx++) {
+            const LineMeshlet& meshlet = meshletData.meshlets.at(meshletIdx);
+            for (uint32_t vertexIdx = meshlet.vertexOffset; vertexIdx < meshlet.vertexOffset + meshlet.numVertices;
+                    vertexIdx++) {
+                if (getIsPointInClipVolume(viewProjectionMatrix, lineData.vertexPositions.at(vertexIdx))) {
+                    ASSERT_TRUE(isMeshletVisible.at(meshletIdx));
+                }
+            }
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(MaxNumVerticesTest, LineMeshletsTest, ::testing::Values(2, 7, 64));
+
+TEST(LineMeshletsRadiusTest, TubeSurfaceInsideFrustum) {
+    // A line just outside of the left frustum plane, whose tube surface reaches into the frustum.
+    LinePreprocessedData lineData;
+    lineData.lineTrajectoryIndices = { 0 };
+    lineData.lineVertexOffsets = { 0 };
+    lineData.lineNumVertices = { 2 };
+    lineData.vertexPointIndices = { 0, 1 };
+    lineData.vertexPositions = { glm::vec3(-1.2f, -0.01f, 0.0f), glm::vec3(-1.2f, 0.01f, 0.0f) };
+    lineData.vertexTangents = { glm::vec3(0.0f, 1.0f, 0.0f), glm::vec3(0.0f, 1.0f, 0.0f) };
+    lineData.vertexNormals = { glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f) };
+    lineData.lineIndices = { 0, 1 };
+    const float lineRadius = 0.05f;
+    glm::mat4 viewMatrix = glm::lookAt(glm::vec3(0.0f, 0.0f, 2.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projectionMatrix = glm::perspective(glm::radians(60.0f), 1.0f, 0.01f, 100.0f);
+    glm::mat4 viewProjectionMatrix = projectionMatrix * viewMatrix;
+    for (const glm::vec3& vertexPosition : lineData.vertexPositions) {
+        glm::vec4 clipPositionCenter = viewProjectionMatrix * glm::vec4(vertexPosition, 1.0f);
+        glm::vec4 clipPositionSurface =
+                viewProjectionMatrix * glm::vec4(vertexPosition + glm::vec3(lineRadius, 0.0f, 0.0f), 1.0f);
+        ASSERT_LT(clipPositionCenter.x, -clipPositionCenter.w);
+        ASSERT_GT(clipPositionSurface.x, -clipPositionSurface.w);
+    }
+
+    LineMeshletData meshletData;
+    buildLineMeshlets(lineData, 64, meshletData);
+    ViewFrustum frustum(viewProjectionMatrix);
+    std::vector<uint32_t> visibleMeshletIndices;
+    cullLineMeshlets(meshletData.meshlets, frustum, visibleMeshletIndices, nullptr, 0.0f);
+    EXPECT_TRUE(visibleMeshletIndices.empty());
+    cullLineMeshlets(meshletData.meshlets, frustum, visibleMeshletIndices, nullptr, lineRadius);
+    EXPECT_EQ(visibleMeshletIndices.size(), 1u);
+}
@@ -0,0 +1,334 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <random>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include "gtest/gtest.h"
+#include "LineData/SearchStructures/LineSegmentBvh.hpp"
+
+/**
+ * Compares the segment queries of the hierarchy with brute force results on random walk lines. The parameter is the
+ * number of lines.
+ */
+class LineSegmentBvhTest : public ::testing::TestWithParam<int> {
+protected:
+    void SetUp() override {
+        createRandomLines(GetParam(), 12345, lines);
+        bvh.build(lines);
+    }
+
+    static void createRandomLines(int numLines, unsigned int seed, std::vector<std::vector<glm::vec3>>& lines) {
+        std::default_random_engine generator(seed);
+        std::uniform_real_distribution<float> positionDistribution(0.0f, 1.0f);
+        std::uniform_real_distribution<float> stepDistribution(-0.02f, 0.02f);
+        std::uniform_int_distribution<int> lengthDistribution(1, 100);
+        lines.resize(numLines);
+        for (std::vector<glm::vec3>& line : lines) {
+            glm::vec3 position(
+                    positionDistribution(generator), positionDistribution(generator), positionDistribution(generator));
+            int numLinePoints = lengthDistribution(generator);
+            for (int i = 0; i < numLinePoints; i++) {
+                line.push_back(position);
+                position += glm::vec3(
+                        stepDistribution(generator), stepDistribution(generator), stepDistribution(generator));
+            }
+        }
+    }
+
+    static float getPointSegmentDistance(const glm::vec3& point, const glm::vec3& p0, const glm::vec3& p1) {
+        glm::vec3 direction = p1 - p0;
+        float lengthSquared = glm::dot(direction, direction);
+        float t = lengthSquared > 0.0f ? glm::clamp(glm::dot(point - p0, direction) / lengthSquared, 0.0f, 1.0f) : 0.0f;
+        return glm::distance(point, p0 + t * direction);
+    }
+
+    /// Exact distance of two segments (closest points of two segments, cf. Ericson, Real-Time Collision Detection).
+    static float getSegmentSegmentDistance(
+            const glm::vec3& p0, const glm::vec3& p1, const glm::vec3& q0, const glm::vec3& q1) {
+        const float epsilon = 1e-12f;
+        glm::vec3 d1 = p1 - p0, d2 = q1 - q0, r = p0 - q0;
+        float a = glm::dot(d1, d1), e = glm::dot(d2, d2), f = glm::dot(d2, r);
+        float s = 0.0f, t = 0.0f;
+        if (a <= epsilon && e <= epsilon) {
+            return glm::distance(p0, q0);
+        }
+        if (a <= epsilon) {
+            t = glm::clamp(f / e, 0.0f, 1.0f);
+        } else {
+            float c = glm::dot(d1, r);
+            if (e <= epsilon) {
+                s = glm::clamp(-c / a, 0.0f, 1.0f);
+            } else {
+                float b = glm::dot(d1, d2);
+                float denominator = a * e - b * b;
+                s = denominator > epsilon ? glm::clamp((b * f - c * e) / denominator, 0.0f, 1.0f) : 0.0f;
+                t = (b * s + f) / e;
+                if (t < 0.0f) {
+                    t = 0.0f;
+                    s = glm::clamp(-c / a, 0.0f, 1.0f);
+                } else if (t > 1.0f) {
+                    t = 1.0f;
+                    s = glm::clamp((b - c) / a, 0.0f, 1.0f);
+                }
+            }
+        }
+        return glm::distance(p0 + s * d1, q0 + t * d2);
+    }
+
+    /// Checks that the hit describes a valid point on a segment.
+    void checkHit(const LineSegmentHit& hit, const glm::vec3& queryPoint) {
+        ASSERT_LT(hit.lineIdx, lines.size());
+        ASSERT_LT(hit.segmentIdx + 1, lines.at(hit.lineIdx).size());
+        EXPECT_GE(hit.t, 0.0f);
+        EXPECT_LE(hit.t, 1.0f);
+        const std::vector<glm::vec3>& line = lines.at(hit.lineIdx);
+        glm::vec3 point = glm::mix(line.at(hit.segmentIdx), line.at(hit.segmentIdx + 1), hit.t);
+        EXPECT_NEAR(glm::distance(point, hit.closestPoint), 0.0f, 1e-5f);
+        EXPECT_NEAR(glm::distance(queryPoint, hit.closestPoint), hit.distance, 1e-5f);
+    }
+
+    std::vector<std::vector<glm::vec3>> lines;
+    LineSegmentBvh bvh;
+};
+
+TEST_P(LineSegmentBvhTest, ClosestSegment) {
+    std::default_random_engine generator(54321);
+    std::uniform_real_distribution<float> distribution(-0.5f, 1.5f);
+    std::vector<glm::vec3> queryPoints;
+    for (int i = 0; i < 100; i++) {
+        queryPoints.push_back(glm::vec3(distribution(generator), distribution(generator), distribution(generator)));
+    }
+    std::vector<LineSegmentHit> hits;
+    std::vector<bool> hasHits;
+    bvh.findClosestSegments(queryPoints, hits, hasHits);
+
+    for (size_t i = 0; i < queryPoints.size(); i++) {
+        const glm::vec3& queryPoint = queryPoints.at(i);
+        float minDistance = std::numeric_limits<float>::max();
+        for (const std::vector<glm::vec3>& line : lines) {
+            for (size_t j = 0; j + 1 < line.size(); j++) {
+                minDistance = std::min(minDistance, getPointSegmentDistance(queryPoint, line.at(j), line.at(j + 1)));
+            }
+        }
+        bool hasSegments = bvh.getNumSegments() > 0;
+        LineSegmentHit hit;
+        ASSERT_EQ(bvh.findClosestSegment(queryPoint, hit), hasSegments);
+        ASSERT_EQ(hasHits.at(i), hasSegments);
+        if (hasSegments) {
+            checkHit(hit, queryPoint);
+            EXPECT_NEAR(hit.distance, minDistance, 1e-5f);
+            EXPECT_NEAR(hits.at(i).distance, minDistance, 1e-5f);
+        }
+        EXPECT_FALSE(bvh.findClosestSegment(queryPoint, hit, minDistance * 0.99f));
+    }
+}
+
+TEST_P(LineSegmentBvhTest, SegmentsInSphere) {
+    std::default_random_engine generator(54321);
+    std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+    for (int i = 0; i < 20; i++) {
+        glm::vec3 center(distribution(generator), distribution(generator), distribution(generator));
+        float radius = 0.2f * distribution(generator);
+        std::vector<LineSegmentHit> hits;
+        bvh.findSegmentsInSphere(center, radius, hits);
+
+        std::vector<std::pair<uint32_t, uint32_t>> segmentsBvh, segmentsBruteForce;
+        for (const LineSegmentHit& hit : hits) {
+            checkHit(hit, center);
+            EXPECT_LE(hit.distance, radius);
+            segmentsBvh.push_back(std::make_pair(hit.lineIdx, hit.segmentIdx));
+        }
+        for (size_t lineIdx = 0; lineIdx < lines.size(); lineIdx++) {
+            const std::vector<glm::vec3>& line = lines.at(lineIdx);
+            for (size_t j = 0; j + 1 < line.size(); j++) {
+                if (getPointSegmentDistance(center, line.at(j), line.at(j + 1)) <= radius) {
+                    segmentsBruteForce.push_back(std::make_pair(uint32_t(lineIdx), uint32_t(j)));
+                }
+            }
+        }
+        std::sort(segmentsBvh.begin(), segmentsBvh.end());
+        EXPECT_EQ(segmentsBvh, segmentsBruteForce);
+    }
+}
+
+TEST_P(LineSegmentBvhTest, LineSetDistance) {
+    std::vector<std::vector<glm::vec3>> otherLines;
+    createRandomLines(5, 999, otherLines);
+    for (std::vector<glm::vec3>& line : otherLines) {
+        for (glm::vec3& point : line) {
+            point += glm::vec3(0.3f, 0.0f, 0.0f);
+        }
+    }
+    LineSegmentBvh otherBvh;
+    otherBvh.build(otherLines);
+
+    float minDistance = std::numeric_limits<float>::max();
+    for (const std::vector<glm::vec3>& line : lines) {
+        for (size_t i = 0; i + 1 < line.size(); i++) {
+            for (const std::vector<glm::vec3>& otherLine : otherLines) {
+                for (size_t j = 0; j + 1 < otherLine.size(); j++) {
+                    minDistance = std::min(minDistance, getSegmentSegmentDistance(
+                            line.at(i), line.at(i + 1), otherLine.at(j), otherLine.at(j + 1)));
+                }
+            }
+        }
+    }
+
+    LineSegmentHit hit, otherHit;
+    bool hasSegments = bvh.getNumSegments() > 0 && otherBvh.getNumSegments() > 0;
+    ASSERT_EQ(bvh.computeMinimumDistance(otherBvh, hit, otherHit), hasSegments);
+    if (hasSegments) {
+        EXPECT_NEAR(glm::distance(hit.closestPoint, otherHit.closestPoint), hit.distance, 1e-5f);
+        EXPECT_FLOAT_EQ(hit.distance, otherHit.distance);
+        EXPECT_NEAR(hit.distance, minDistance, 1e-5f);
+    }
+}
+
+TEST_P(LineSegmentBvhTest, RayIntersection) {
+    // Reference: March along the ray until the distance to the closest segment drops below the tube radius.
+    const float tubeRadius = 0.01f;
+    const float stepSize = 1e-4f;
+    std::default_random_engine generator(54321);
+    std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+    for (int i = 0; i < 20; i++) {
+        glm::vec3 rayOrigin(distribution(generator), distribution(generator), -0.5f);
+        glm::vec3 target(distribution(generator), distribution(generator), 1.0f);
+        // Aim every second ray at a line point so that the test also covers hits.
+        if (i % 2 == 0 && bvh.getNumSegments() > 0) {
+            const std::vector<glm::vec3>& line = lines.at(i % lines.size());
+            target = line.at(line.size() / 2);
+        }
+        glm::vec3 rayDirection = glm::normalize(target - rayOrigin);
+
+        float referenceDistance = -1.0f;
+        for (float t = 0.0f; t < 3.0f; t += stepSize) {
+            LineSegmentHit closestHit;
+            if (bvh.findClosestSegment(rayOrigin + t * rayDirection, closestHit, tubeRadius)) {
+                referenceDistance = t;
+                break;
+            }
+        }
+
+        LineSegmentHit hit;
+        bool hasHit = bvh.intersectRay(rayOrigin, rayDirection, tubeRadius, hit);
+        ASSERT_EQ(hasHit, referenceDistance >= 0.0f);
+        if (hasHit) {
+            EXPECT_NEAR(hit.distance, referenceDistance, 2.0f * stepSize);
+            EXPECT_NEAR(glm::distance(rayOrigin + hit.distance * rayDirection, hit.closestPoint), 0.0f, 1e-5f);
+            // The hit point lies on the surface of the tube of the hit segment.
+            const std::vector<glm::vec3>& line = lines.at(hit.lineIdx);
+            glm::vec3 centerPoint = glm::mix(line.at(hit.segmentIdx), line.at(hit.segmentIdx + 1), hit.t);
+            EXPECT_NEAR(glm::distance(centerPoint, hit.closestPoint), tubeRadius, 1e-4f);
+            EXPECT_FALSE(bvh.intersectRay(rayOrigin, rayDirection, tubeRadius, hit, referenceDistance - stepSize));
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(LineCountTest, LineSegmentBvhTest, ::testing::Values(1, 3, 17, 200));
+
+TEST(LineSegmentBvhBuildTest, DegenerateLines) {
+    LineSegmentBvh bvh;
+    bvh.build({});
+    EXPECT_TRUE(bvh.getIsEmpty());
+    LineSegmentHit hit;
+    EXPECT_FALSE(bvh.findClosestSegment(glm::vec3(0.0f), hit));
+
+    // Single point lines do not contain segments, zero length segments do.
+    bvh.build({ { glm::vec3(1.0f) }, { glm::vec3(0.5f), glm::vec3(0.5f) } });
+    EXPECT_EQ(bvh.getNumSegments(), 1u);
+    ASSERT_TRUE(bvh.findClosestSegment(glm::vec3(0.0f), hit));
+    EXPECT_EQ(hit.lineIdx, 1u);
+    EXPECT_EQ(hit.segmentIdx, 0u);
+    EXPECT_FLOAT_EQ(hit.distance, glm::length(glm::vec3(0.5f)));
+}
+
+TEST(LineSegmentBvhBuildTest, NodeCount) {
+    // The number of nodes is computed in advance for the parallel build, so check it for many segment counts.
+    for (int numSegments = 1; numSegments < 300; numSegments++) {
+        std::vector<std::vector<glm::vec3>> lines(1);
+        for (int i = 0; i <= numSegments; i++) {
+            lines.front().push_back(glm::vec3(float(i), 0.0f, 0.0f));
+        }
+        LineSegmentBvh bvh;
+        bvh.build(lines);
+        ASSERT_EQ(bvh.getNumSegments(), size_t(numSegments));
+        LineSegmentHit hit;
+        ASSERT_TRUE(bvh.findClosestSegment(glm::vec3(float(numSegments) - 0.5f, 1.0f, 0.0f), hit));
+        EXPECT_EQ(hit.segmentIdx, uint32_t(numSegments - 1));
+        EXPECT_FLOAT_EQ(hit.t, 0.5f);
+    }
+}
+
+
+TEST(LineSegmentBvhBuildTest, RayCapsuleCases) {
+    LineSegmentBvh bvh;
+    bvh.build({ { glm::vec3(0.0f), glm::vec3(1.0f, 0.0f, 0.0f) } });
+    LineSegmentHit hit;
+
+    // Perpendicular hit of the cylinder body.
+    ASSERT_TRUE(bvh.intersectRay(glm::vec3(0.5f, 0.0f, -1.0f), glm::vec3(0.0f, 0.0f, 1.0f), 0.1f, hit));
+    EXPECT_FLOAT_EQ(hit.distance, 0.9f);
+    EXPECT_FLOAT_EQ(hit.t, 0.5f);
+
+    // Ray along the segment axis hits the sphere cap.
+    ASSERT_TRUE(bvh.intersectRay(glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f), 0.1f, hit));
+    EXPECT_FLOAT_EQ(hit.distance, 0.9f);
+    EXPECT_FLOAT_EQ(hit.t, 0.0f);
+
+    // Ray pointing away from the segment and ray passing by.
+    EXPECT_FALSE(bvh.intersectRay(glm::vec3(-1.0f, 0.0f, 0.0f), glm::vec3(-1.0f, 0.0f, 0.0f), 0.1f, hit));
+    EXPECT_FALSE(bvh.intersectRay(glm::vec3(0.5f, 0.2f, -1.0f), glm::vec3(0.0f, 0.0f, 1.0f), 0.1f, hit));
+}
+
+
+TEST(LineSegmentBvhBuildTest, RayLineFilter) {
+    // Three parallel lines behind each other along the ray.
+    LineSegmentBvh bvh;
+    bvh.build({
+            { glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.0f, 0.0f) },
+            { glm::vec3(0.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, 1.0f) },
+            { glm::vec3(0.0f, 0.0f, 2.0f), glm::vec3(1.0f, 0.0f, 2.0f) } });
+    const glm::vec3 rayOrigin(0.5f, 0.0f, -1.0f);
+    const glm::vec3 rayDirection(0.0f, 0.0f, 1.0f);
+    LineSegmentHit hit;
+
+    ASSERT_TRUE(bvh.intersectRay(rayOrigin, rayDirection, 0.1f, hit));
+    EXPECT_EQ(hit.lineIdx, 0u);
+
+    // Hidden lines neither get hit nor occlude the lines behind them.
+    auto isLineVisible = [](uint32_t lineIdx) { return lineIdx == 2; };
+    ASSERT_TRUE(bvh.intersectRay(
+            rayOrigin, rayDirection, 0.1f, hit, std::numeric_limits<float>::max(), isLineVisible));
+    EXPECT_EQ(hit.lineIdx, 2u);
+    EXPECT_NEAR(hit.distance, 2.9f, 1e-5f);
+
+    EXPECT_FALSE(bvh.intersectRay(
+            rayOrigin, rayDirection, 0.1f, hit, std::numeric_limits<float>::max(),
+            [](uint32_t lineIdx) { return false; }));
+}
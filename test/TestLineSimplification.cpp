@@ -0,0 +1,232 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <glm/glm.hpp>
+#include "gtest/gtest.h"
+#include "LineData/LineSimplification.hpp"
+#include "LineData/LinePreprocessingCache.hpp"
+#include "LineData/SearchStructures/LineChunkBvh.hpp"
+
+/// Distance of a point to the line segment (p0, p1).
+static float computePointSegmentDistance(const glm::vec3& p, const glm::vec3& p0, const glm::vec3& p1) {
+    glm::vec3 segment = p1 - p0;
+    float segmentLengthSquared = glm::dot(segment, segment);
+    float t = 0.0f;
+    if (segmentLengthSquared > 0.0f) {
+        t = glm::clamp(glm::dot(p - p0, segment) / segmentLengthSquared, 0.0f, 1.0f);
+    }
+    return glm::length(p - (p0 + t * segment));
+}
+
+/// Creates random walk lines with one attribute.
+static Trajectories createRandomWalkTrajectories(int numLines, int numLinePoints, uint32_t seed) {
+    std::default_random_engine generator(seed);
+    std::uniform_real_distribution<float> positionDistribution(0.0f, 1.0f);
+    std::uniform_real_distribution<float> stepDistribution(-0.01f, 0.01f);
+    Trajectories trajectories(numLines);
+    for (Trajectory& trajectory : trajectories) {
+        glm::vec3 position(
+                positionDistribution(generator), positionDistribution(generator), positionDistribution(generator));
+        trajectory.attributes.resize(1);
+        for (int i = 0; i < numLinePoints; i++) {
+            trajectory.positions.push_back(position);
+            trajectory.attributes.front().push_back(positionDistribution(generator));
+            position += glm::vec3(
+                    stepDistribution(generator), stepDistribution(generator), stepDistribution(generator));
+        }
+    }
+    return trajectories;
+}
+
+/**
+ * The points with an error greater or equal to a threshold form the simplified line. Every removed point needs to lie
+ * within the threshold of the simplified segment spanning it, and the end points are never removed.
+ */
+TEST(LineSimplificationTest, RemovedPointsWithinError) {
+    Trajectories trajectories = createRandomWalkTrajectories(50, 500, 12345);
+    std::vector<std::vector<float>> pointErrorsList;
+    computeLineSimplificationErrors(trajectories, pointErrorsList);
+    ASSERT_EQ(pointErrorsList.size(), trajectories.size());
+
+    const float thresholds[] = { 1e-4f, 1e-3f, 4e-3f, 1e-2f, 5e-2f, 1.0f };
+    for (size_t trajectoryIdx = 0; trajectoryIdx < trajectories.size(); trajectoryIdx++) {
+        const std::vector<glm::vec3>& positions = trajectories.at(trajectoryIdx).positions;
+        const std::vector<float>& pointErrors = pointErrorsList.at(trajectoryIdx);
+        ASSERT_EQ(pointErrors.size(), positions.size());
+        EXPECT_EQ(pointErrors.front(), std::numeric_limits<float>::max());
+        EXPECT_EQ(pointErrors.back(), std::numeric_limits<float>::max());
+
+        for (float threshold : thresholds) {
+            size_t lastKeptIdx = 0;
+            for (size_t i = 1; i < positions.size(); i++) {
+                if (pointErrors.at(i) < threshold) {
+                    continue;
+                }
+                for (size_t j = lastKeptIdx + 1; j < i; j++) {
+                    float distance = computePointSegmentDistance(
+                            positions.at(j), positions.at(lastKeptIdx), positions.at(i));
+                    ASSERT_LE(distance, threshold * 1.0001f);
+                }
+                lastKeptIdx = i;
+            }
+            EXPECT_EQ(lastKeptIdx, positions.size() - 1);
+        }
+    }
+}
+
+/// Straight lines with a linear attribute collapse to their two end points.
+TEST(LineSimplificationTest, StraightLineCollapses) {
+    Trajectory trajectory;
+    trajectory.attributes.resize(1);
+    const int numLinePoints = 100;
+    for (int i = 0; i < numLinePoints; i++) {
+        float t = float(i) / float(numLinePoints - 1);
+        trajectory.positions.push_back(glm::vec3(0.5f, -1.0f, 2.0f) + t * glm::vec3(1.0f, 2.0f, -0.5f));
+        trajectory.attributes.front().push_back(t * 10.0f);
+    }
+    std::vector<glm::vec2> minMaxAttributeValues = { glm::vec2(0.0f, 10.0f) };
+    std::vector<float> pointErrors;
+    computeLineSimplificationErrors(trajectory, minMaxAttributeValues, 0.1f, pointErrors);
+    ASSERT_EQ(pointErrors.size(), trajectory.positions.size());
+
+    int numKeptPoints = 0;
+    for (float pointError : pointErrors) {
+        if (pointError >= 1e-4f) {
+            numKeptPoints++;
+        }
+    }
+    EXPECT_EQ(numKeptPoints, 2);
+    EXPECT_EQ(pointErrors.front(), std::numeric_limits<float>::max());
+    EXPECT_EQ(pointErrors.back(), std::numeric_limits<float>::max());
+}
+
+/// The per-vertex errors of the preprocessed render data are the errors of the line points they were created from.
+TEST(LineSimplificationTest, VertexErrorsMatchPointErrors) {
+    Trajectories trajectories = createRandomWalkTrajectories(100, 300, 54321);
+    std::vector<std::vector<float>> pointErrorsList;
+    computeLineSimplificationErrors(trajectories, pointErrorsList);
+
+    LinePreprocessingCache linePreprocessingCache;
+    std::vector<bool> filteredTrajectories(trajectories.size(), false);
+    for (size_t trajectoryIdx = 0; trajectoryIdx < trajectories.size(); trajectoryIdx += 3) {
+        filteredTrajectories.at(trajectoryIdx) = true;
+    }
+    const LinePreprocessedData& lineData = linePreprocessingCache.get(trajectories, filteredTrajectories);
+    const std::vector<float>& vertexErrors = linePreprocessingCache.getVertexSimplificationErrors(trajectories);
+    ASSERT_EQ(vertexErrors.size(), lineData.getNumVertices());
+    for (size_t lineIdx = 0; lineIdx < lineData.getNumLines(); lineIdx++) {
+        const std::vector<float>& pointErrors = pointErrorsList.at(lineData.lineTrajectoryIndices.at(lineIdx));
+        uint32_t vertexStart = lineData.lineVertexOffsets.at(lineIdx);
+        uint32_t vertexEnd = vertexStart + lineData.lineNumVertices.at(lineIdx);
+        for (uint32_t vertexIdx = vertexStart; vertexIdx < vertexEnd; vertexIdx++) {
+            ASSERT_EQ(vertexErrors.at(vertexIdx), pointErrors.at(lineData.vertexPointIndices.at(vertexIdx)));
+        }
+    }
+}
+
+/**
+ * Every simplified level of the line chunks only removes vertices within the level error of the simplified segment
+ * spanning them, and coarser levels have fewer indices.
+ */
+TEST(LineSimplificationTest, ChunkLevelsOfDetailWithinError) {
+    Trajectories trajectories = createRandomWalkTrajectories(100, 300, 54321);
+    LinePreprocessingCache linePreprocessingCache;
+    std::vector<bool> filteredTrajectories;
+    const LinePreprocessedData& lineData = linePreprocessingCache.get(trajectories, filteredTrajectories);
+    const std::vector<float>& vertexErrors = linePreprocessingCache.getVertexSimplificationErrors(trajectories);
+    std::vector<uint32_t> lineIndices = lineData.lineIndices;
+    const size_t numIndices = lineIndices.size();
+
+    sgl::AABB3 modelBoundingBox;
+    for (const glm::vec3& vertexPosition : lineData.vertexPositions) {
+        modelBoundingBox.combine(vertexPosition);
+    }
+    std::vector<float> levelErrors = computeLineSimplificationLevelErrors(modelBoundingBox);
+    ASSERT_FALSE(levelErrors.empty());
+
+    LineChunkBvh bvh;
+    bvh.build(lineIndices, lineData.vertexPositions, 64);
+    bvh.buildLevelsOfDetail(lineIndices, vertexErrors, levelErrors);
+    ASSERT_FALSE(bvh.getLevelErrors().empty());
+    EXPECT_EQ(bvh.getNumIndices(), numIndices);
+    EXPECT_GT(lineIndices.size(), numIndices);
+
+    // A camera far away from the data selects the coarsest level for all chunks.
+    ViewFrustum frustum;
+    std::vector<LineIndexRange> visibleRanges;
+    LineLevelOfDetailSelection levelOfDetail;
+    levelOfDetail.cameraPosition = glm::vec3(0.0f, 0.0f, 1e6f);
+    levelOfDetail.errorPerDistance = 1.0f;
+    bvh.cull(frustum, visibleRanges, nullptr, 0.0f, &levelOfDetail);
+    size_t numVisibleIndices = 0;
+    for (const LineIndexRange& range : visibleRanges) {
+        EXPECT_GE(range.indexOffset, numIndices);
+        EXPECT_LE(range.indexOffset + range.numIndices, lineIndices.size());
+        numVisibleIndices += range.numIndices;
+    }
+    EXPECT_LT(numVisibleIndices, numIndices / 4);
+
+    // All segments of the simplified levels span full resolution vertices within the level error.
+    const float maxLevelError = bvh.getLevelErrors().back();
+    for (size_t idx = numIndices; idx < lineIndices.size(); idx += 2) {
+        uint32_t vertexIdx0 = lineIndices.at(idx);
+        uint32_t vertexIdx1 = lineIndices.at(idx + 1);
+        ASSERT_LT(vertexIdx0, vertexIdx1);
+        for (uint32_t vertexIdx = vertexIdx0 + 1; vertexIdx < vertexIdx1; vertexIdx++) {
+            float distance = computePointSegmentDistance(
+                    lineData.vertexPositions.at(vertexIdx), lineData.vertexPositions.at(vertexIdx0),
+                    lineData.vertexPositions.at(vertexIdx1));
+            ASSERT_LE(distance, maxLevelError * 1.0001f);
+        }
+    }
+}
+
+TEST(LineSimplificationTest, LevelErrorsAndErrorPerDistance) {
+    sgl::AABB3 modelBoundingBox(glm::vec3(-1.0f), glm::vec3(1.0f));
+    std::vector<float> levelErrors = computeLineSimplificationLevelErrors(modelBoundingBox);
+    ASSERT_FALSE(levelErrors.empty());
+    EXPECT_NEAR(levelErrors.front(), glm::length(modelBoundingBox.getDimensions()) * 1e-4f, 1e-7f);
+    for (size_t levelIdx = 1; levelIdx < levelErrors.size(); levelIdx++) {
+        EXPECT_FLOAT_EQ(levelErrors.at(levelIdx), 2.0f * levelErrors.at(levelIdx - 1));
+    }
+    EXPECT_TRUE(computeLineSimplificationLevelErrors(sgl::AABB3(glm::vec3(1.0f), glm::vec3(1.0f))).empty());
+
+    const float fovy = glm::radians(60.0f);
+    const int viewportHeight = 1080;
+    const float maxScreenSpaceError = 2.0f;
+    EXPECT_EQ(computeLineSimplificationErrorPerDistance(fovy, 0, maxScreenSpaceError), 0.0f);
+    EXPECT_EQ(computeLineSimplificationErrorPerDistance(fovy, viewportHeight, 0.0f), 0.0f);
+    // At the distance 1, the height of the viewport covers 2 * tan(fovy / 2) world space units.
+    float worldSizePerPixel = 2.0f * std::tan(fovy * 0.5f) / float(viewportHeight);
+    EXPECT_FLOAT_EQ(
+            computeLineSimplificationErrorPerDistance(fovy, viewportHeight, maxScreenSpaceError),
+            maxScreenSpaceError * worldSizePerPixel);
+}
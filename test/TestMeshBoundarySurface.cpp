@@ -0,0 +1,280 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <random>
+#include <numeric>
+#include <array>
+#include <algorithm>
+#include <map>
+#include <set>
+#include <unordered_map>
+#include <glm/glm.hpp>
+#include "gtest/gtest.h"
+#include "LineData/Mesh/MeshBoundarySurface.hpp"
+
+namespace {
+
+const int HEX_FACE_TABLE[6][4] = {
+        { 0,1,2,3 }, { 5,4,7,6 }, { 4,5,1,0 }, { 4,0,3,7 }, { 6,7,3,2 }, { 1,5,6,2 },
+};
+
+/// The serial boundary extraction of hexahedral meshes the parallel implementation needs to reproduce exactly.
+void extractHexMeshBoundarySurfaceReference(
+        const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& cellIndices,
+        std::vector<uint32_t>& triangleIndices, std::vector<glm::vec3>& vertexPositions) {
+    struct TempFace {
+        uint32_t vertexId[4];
+        uint32_t faceId;
+        bool operator<(const TempFace& other) const {
+            for (int i = 0; i < 4; i++) {
+                if (vertexId[i] != other.vertexId[i]) {
+                    return vertexId[i] < other.vertexId[i];
+                }
+            }
+            return faceId < other.faceId;
+        }
+        bool operator!=(const TempFace& other) const {
+            return !std::equal(vertexId, vertexId + 4, other.vertexId);
+        }
+    };
+
+    const uint32_t numCells = uint32_t(cellIndices.size() / 8);
+    std::vector<std::array<uint32_t, 4>> totalFaces(numCells * 6);
+    std::vector<TempFace> tempFaces(numCells * 6);
+    for (uint32_t cellId = 0; cellId < numCells; cellId++) {
+        for (uint32_t faceIdx = 0; faceIdx < 6; faceIdx++) {
+            std::array<uint32_t, 4> face;
+            for (int i = 0; i < 4; i++) {
+                face[i] = cellIndices.at(cellId * 8 + HEX_FACE_TABLE[faceIdx][i]);
+            }
+            uint32_t faceId = 6 * cellId + faceIdx;
+            totalFaces[faceId] = face;
+            std::sort(face.begin(), face.end());
+            tempFaces[faceId] = TempFace{ { face[0], face[1], face[2], face[3] }, faceId };
+        }
+    }
+    std::sort(tempFaces.begin(), tempFaces.end());
+
+    std::vector<std::array<uint32_t, 4>> faces;
+    std::vector<bool> isBoundaryFace;
+    for (size_t i = 0; i < tempFaces.size(); i++) {
+        if (i == 0 || tempFaces[i] != tempFaces[i - 1]) {
+            faces.push_back(totalFaces[tempFaces[i].faceId]);
+            isBoundaryFace.push_back(true);
+        } else {
+            isBoundaryFace.back() = false;
+        }
+    }
+
+    std::set<uint32_t> usedVertexSet;
+    for (size_t i = 0; i < faces.size(); i++) {
+        if (isBoundaryFace[i]) {
+            usedVertexSet.insert(faces[i].begin(), faces[i].end());
+        }
+    }
+    std::unordered_map<uint32_t, uint32_t> vertexIndexMap;
+    for (uint32_t vertexId : usedVertexSet) {
+        vertexIndexMap.insert(std::make_pair(vertexId, uint32_t(vertexPositions.size())));
+        vertexPositions.push_back(vertices.at(vertexId));
+    }
+    for (size_t i = 0; i < faces.size(); i++) {
+        if (!isBoundaryFace[i]) {
+            continue;
+        }
+        const std::array<uint32_t, 4>& f = faces[i];
+        for (int j : { 2, 1, 0, 3, 2, 0 }) {
+            triangleIndices.push_back(vertexIndexMap[f[j]]);
+        }
+    }
+}
+
+/**
+ * Creates a grid of numCells^3 hexahedra over [0, 1]^3 with the passed offset. Each cell is removed with the passed
+ * probability (creating inner boundaries and non-manifold edges), and the vertex indices are shuffled.
+ */
+void createHexGrid(
+        int numCells, float removalProbability, const glm::vec3& offset,
+        std::vector<glm::vec3>& vertices, std::vector<uint32_t>& cellIndices) {
+    std::default_random_engine generator(12345);
+    std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+    const int numVerticesPerAxis = numCells + 1;
+    const uint32_t numVertices = uint32_t(numVerticesPerAxis * numVerticesPerAxis * numVerticesPerAxis);
+    std::vector<uint32_t> permutation(numVertices);
+    std::iota(permutation.begin(), permutation.end(), 0);
+    std::shuffle(permutation.begin(), permutation.end(), generator);
+
+    const uint32_t vertexOffset = uint32_t(vertices.size());
+    vertices.resize(vertices.size() + numVertices);
+    for (int z = 0; z < numVerticesPerAxis; z++) {
+        for (int y = 0; y < numVerticesPerAxis; y++) {
+            for (int x = 0; x < numVerticesPerAxis; x++) {
+                uint32_t vertexIdx = uint32_t((z * numVerticesPerAxis + y) * numVerticesPerAxis + x);
+                vertices.at(vertexOffset + permutation[vertexIdx]) =
+                        offset + glm::vec3(float(x), float(y), float(z)) / float(numCells);
+            }
+        }
+    }
+    auto vertexIndex = [&](int x, int y, int z) {
+        return vertexOffset + permutation[uint32_t((z * numVerticesPerAxis + y) * numVerticesPerAxis + x)];
+    };
+    for (int z = 0; z < numCells; z++) {
+        for (int y = 0; y < numCells; y++) {
+            for (int x = 0; x < numCells; x++) {
+                if (distribution(generator) < removalProbability) {
+                    continue;
+                }
+                cellIndices.insert(cellIndices.end(), {
+                        vertexIndex(x, y, z), vertexIndex(x + 1, y, z),
+                        vertexIndex(x + 1, y + 1, z), vertexIndex(x, y + 1, z),
+                        vertexIndex(x, y, z + 1), vertexIndex(x + 1, y, z + 1),
+                        vertexIndex(x + 1, y + 1, z + 1), vertexIndex(x, y + 1, z + 1) });
+            }
+        }
+    }
+}
+
+/// Splits the hexahedra into six positively oriented tetrahedra each (sharing the main diagonal 0-6).
+void splitHexahedraIntoTetrahedra(
+        const std::vector<glm::vec3>& vertices, const std::vector<uint32_t>& hexCellIndices,
+        std::vector<uint32_t>& cellIndices, std::vector<uint32_t>& cellOffsets) {
+    const int paths[6][4] = {
+            { 0,1,2,6 }, { 0,1,5,6 }, { 0,3,2,6 }, { 0,3,7,6 }, { 0,4,5,6 }, { 0,4,7,6 } };
+    for (size_t hexIdx = 0; hexIdx < hexCellIndices.size() / 8; hexIdx++) {
+        for (const int* path : paths) {
+            uint32_t tet[4];
+            for (int i = 0; i < 4; i++) {
+                tet[i] = hexCellIndices.at(hexIdx * 8 + path[i]);
+            }
+            const glm::vec3& v0 = vertices.at(tet[0]);
+            if (glm::dot(glm::cross(vertices.at(tet[1]) - v0, vertices.at(tet[2]) - v0), vertices.at(tet[3]) - v0)
+                    < 0.0f) {
+                std::swap(tet[1], tet[2]);
+            }
+            cellIndices.insert(cellIndices.end(), tet, tet + 4);
+            cellOffsets.push_back(uint32_t(cellIndices.size()));
+        }
+    }
+}
+
+/// Computes the enclosed volume of a closed triangle mesh using the divergence theorem.
+float computeEnclosedVolume(const std::vector<uint32_t>& triangleIndices, const std::vector<glm::vec3>& vertices) {
+    double volume = 0.0;
+    for (size_t i = 0; i < triangleIndices.size(); i += 3) {
+        const glm::vec3& v0 = vertices.at(triangleIndices.at(i));
+        const glm::vec3& v1 = vertices.at(triangleIndices.at(i + 1));
+        const glm::vec3& v2 = vertices.at(triangleIndices.at(i + 2));
+        volume += double(glm::dot(v0, glm::cross(v1, v2))) / 6.0;
+    }
+    return float(volume);
+}
+
+/// @return Whether every directed edge is used exactly once and its opposite edge exists (closed, consistent winding).
+bool getIsClosedAndConsistentlyOriented(const std::vector<uint32_t>& triangleIndices) {
+    std::map<std::pair<uint32_t, uint32_t>, int> edgeCounts;
+    for (size_t i = 0; i < triangleIndices.size(); i += 3) {
+        for (int j = 0; j < 3; j++) {
+            edgeCounts[std::make_pair(triangleIndices.at(i + j), triangleIndices.at(i + (j + 1) % 3))]++;
+        }
+    }
+    for (const auto& edgeCount : edgeCounts) {
+        auto it = edgeCounts.find(std::make_pair(edgeCount.first.second, edgeCount.first.first));
+        if (edgeCount.second != 1 || it == edgeCounts.end() || it->second != 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+TEST(MeshBoundarySurfaceTest, HexMeshMatchesSerialReference) {
+    for (float removalProbability : { 0.0f, 0.2f, 0.5f }) {
+        std::vector<glm::vec3> vertices;
+        std::vector<uint32_t> cellIndices;
+        createHexGrid(10, removalProbability, glm::vec3(0.0f), vertices, cellIndices);
+
+        std::vector<uint32_t> triangleIndices, triangleIndicesReference;
+        std::vector<glm::vec3> vertexPositions, vertexPositionsReference;
+        extractMeshBoundarySurface(vertices, cellIndices, triangleIndices, vertexPositions);
+        extractHexMeshBoundarySurfaceReference(
+                vertices, cellIndices, triangleIndicesReference, vertexPositionsReference);
+        EXPECT_EQ(triangleIndices, triangleIndicesReference);
+        ASSERT_EQ(vertexPositions.size(), vertexPositionsReference.size());
+        for (size_t i = 0; i < vertexPositions.size(); i++) {
+            EXPECT_EQ(vertexPositions.at(i), vertexPositionsReference.at(i));
+        }
+
+        // Passing explicit cell offsets for a purely hexahedral mesh gives the same result.
+        std::vector<uint32_t> cellOffsets;
+        for (size_t i = 0; i <= cellIndices.size(); i += 8) {
+            cellOffsets.push_back(uint32_t(i));
+        }
+        std::vector<uint32_t> triangleIndicesOffsets;
+        std::vector<glm::vec3> vertexPositionsOffsets;
+        extractMeshBoundarySurface(
+                vertices, cellIndices, cellOffsets, triangleIndicesOffsets, vertexPositionsOffsets);
+        EXPECT_EQ(triangleIndicesOffsets, triangleIndices);
+    }
+
+    // The full grid is a closed cube of volume one with outward facing normals.
+    std::vector<glm::vec3> vertices;
+    std::vector<uint32_t> cellIndices;
+    createHexGrid(6, 0.0f, glm::vec3(0.0f), vertices, cellIndices);
+    std::vector<uint32_t> triangleIndices;
+    std::vector<glm::vec3> vertexPositions;
+    extractMeshBoundarySurface(vertices, cellIndices, triangleIndices, vertexPositions);
+    EXPECT_EQ(triangleIndices.size(), size_t(6 * 6 * 6 * 2 * 3));
+    EXPECT_EQ(vertexPositions.size(), size_t(7 * 7 * 7 - 5 * 5 * 5));
+    EXPECT_TRUE(getIsClosedAndConsistentlyOriented(triangleIndices));
+    EXPECT_NEAR(computeEnclosedVolume(triangleIndices, vertexPositions), 1.0f, 1e-4f);
+}
+
+TEST(MeshBoundarySurfaceTest, MixedTetrahedralHexahedralMesh) {
+    // A tetrahedralized cube next to a hexahedral cube (not touching).
+    std::vector<glm::vec3> vertices;
+    std::vector<uint32_t> hexCellIndices, cellIndices, cellOffsets = { 0 };
+    createHexGrid(4, 0.0f, glm::vec3(0.0f), vertices, hexCellIndices);
+    splitHexahedraIntoTetrahedra(vertices, hexCellIndices, cellIndices, cellOffsets);
+    const size_t numTetCellIndices = cellIndices.size();
+    hexCellIndices.clear();
+    createHexGrid(3, 0.0f, glm::vec3(2.0f, 0.0f, 0.0f), vertices, hexCellIndices);
+    for (size_t i = 0; i < hexCellIndices.size(); i += 8) {
+        cellIndices.insert(cellIndices.end(), hexCellIndices.begin() + i, hexCellIndices.begin() + i + 8);
+        cellOffsets.push_back(uint32_t(cellIndices.size()));
+    }
+    ASSERT_GT(cellIndices.size(), numTetCellIndices);
+
+    std::vector<uint32_t> triangleIndices;
+    std::vector<glm::vec3> vertexPositions;
+    extractMeshBoundarySurface(vertices, cellIndices, cellOffsets, triangleIndices, vertexPositions);
+    // Two triangles per boundary face of the tetrahedralized cube and two per quad of the hexahedral cube.
+    EXPECT_EQ(triangleIndices.size(), size_t((6 * 4 * 4 * 2 + 6 * 3 * 3 * 2) * 3));
+    EXPECT_EQ(vertexPositions.size(), size_t((5 * 5 * 5 - 3 * 3 * 3) + (4 * 4 * 4 - 2 * 2 * 2)));
+    EXPECT_TRUE(getIsClosedAndConsistentlyOriented(triangleIndices));
+    EXPECT_NEAR(computeEnclosedVolume(triangleIndices, vertexPositions), 2.0f, 1e-4f);
+}
@@ -0,0 +1,116 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <random>
+#include <limits>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include "gtest/gtest.h"
+#include "LineData/SearchStructures/PointDistanceField.hpp"
+
+/**
+ * Compares the distances of the distance field with the exact distances to the closest seed point. The parameter is
+ * the number of seed points.
+ */
+class PointDistanceFieldTest : public ::testing::TestWithParam<int> {
+protected:
+    void SetUp() override {
+        std::default_random_engine generator(12345);
+        std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+        seedPoints.resize(GetParam());
+        for (glm::vec3& seedPoint : seedPoints) {
+            seedPoint = glm::vec3(distribution(generator), distribution(generator), distribution(generator));
+        }
+        queryPoints.resize(10000);
+        for (glm::vec3& queryPoint : queryPoints) {
+            queryPoint = glm::vec3(distribution(generator), distribution(generator), distribution(generator));
+        }
+    }
+
+    float getDistanceExact(const glm::vec3& point) {
+        float closestDistance = std::numeric_limits<float>::max();
+        for (const glm::vec3& seedPoint : seedPoints) {
+            closestDistance = std::min(closestDistance, glm::distance(seedPoint, point));
+        }
+        return closestDistance;
+    }
+
+    /// Returns the maximum difference to the exact distances. The field never underestimates the distance.
+    float computeMaxError(const PointDistanceField& distanceField) {
+        std::vector<float> distances;
+        distanceField.getDistances(queryPoints, distances);
+        float maxError = 0.0f;
+        for (size_t i = 0; i < queryPoints.size(); i++) {
+            float distanceExact = getDistanceExact(queryPoints.at(i));
+            EXPECT_GE(distances.at(i), distanceExact - 1e-6f);
+            maxError = std::max(maxError, distances.at(i) - distanceExact);
+        }
+        return maxError;
+    }
+
+    std::vector<glm::vec3> seedPoints;
+    std::vector<glm::vec3> queryPoints;
+};
+
+TEST_P(PointDistanceFieldTest, Accuracy) {
+    PointDistanceField distanceField;
+    distanceField.build(seedPoints, AxisAlignedBox(glm::vec3(0.0f), glm::vec3(1.0f)), 64);
+    EXPECT_EQ(distanceField.getResolution(), glm::ivec3(64));
+    float maxError = computeMaxError(distanceField);
+    EXPECT_LE(maxError, distanceField.getCellSize());
+}
+
+TEST_P(PointDistanceFieldTest, ConvergesWithResolution) {
+    PointDistanceField distanceField;
+    distanceField.build(seedPoints, AxisAlignedBox(glm::vec3(0.0f), glm::vec3(1.0f)), 8);
+    float maxErrorCoarse = computeMaxError(distanceField);
+    distanceField.build(seedPoints, AxisAlignedBox(glm::vec3(0.0f), glm::vec3(1.0f)), 128);
+    float maxErrorFine = computeMaxError(distanceField);
+    EXPECT_LE(maxErrorFine, maxErrorCoarse);
+    EXPECT_LE(maxErrorFine, 0.25f * distanceField.getCellSize());
+}
+
+INSTANTIATE_TEST_SUITE_P(NumSeedPointsTest, PointDistanceFieldTest, ::testing::Values(1, 10, 200));
+
+TEST(PointDistanceFieldFlatTest, FlatDomainAndOutsidePoints) {
+    // All seed points lie in the plane z = 0.5 and a part of the query points lies outside of the domain.
+    std::vector<glm::vec3> seedPoints = { glm::vec3(0.1f, 0.1f, 0.5f), glm::vec3(0.9f, 0.2f, 0.5f) };
+    PointDistanceField distanceField;
+    distanceField.build(seedPoints, AxisAlignedBox(glm::vec3(0.0f, 0.0f, 0.5f), glm::vec3(1.0f, 1.0f, 0.5f)), 32);
+    EXPECT_EQ(distanceField.getResolution(), glm::ivec3(32, 32, 1));
+    EXPECT_EQ(distanceField.findClosestSeedPointIndex(glm::vec3(0.0f, 0.0f, 0.0f)), 0u);
+    EXPECT_EQ(distanceField.findClosestSeedPointIndex(glm::vec3(2.0f, 0.0f, 1.0f)), 1u);
+    EXPECT_FLOAT_EQ(distanceField.getDistance(glm::vec3(0.1f, 0.1f, 1.5f)), 1.0f);
+}
+
+TEST(PointDistanceFieldFlatTest, Empty) {
+    PointDistanceField distanceField;
+    distanceField.build({}, AxisAlignedBox(glm::vec3(0.0f), glm::vec3(1.0f)), 32);
+    EXPECT_TRUE(distanceField.getIsEmpty());
+    EXPECT_EQ(distanceField.findClosestSeedPointIndex(glm::vec3(0.5f)), PointDistanceField::INVALID_SEED_INDEX);
+}
@@ -0,0 +1,301 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <vector>
+#include <limits>
+#include <cstring>
+#include <algorithm>
+#include <GL/glew.h>
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <Graphics/Renderer.hpp>
+#include <Graphics/OpenGL/RendererGL.hpp>
+#include <Graphics/OpenGL/GeometryBuffer.hpp>
+#include "gtest/gtest.h"
+#include "Renderers/Helpers/StreamingBufferUploader.hpp"
+
+/**
+ * Creates an off-screen OpenGL context via EGL without a window or display server. With Mesa, this also works with
+ * the software rasterizer (e.g., LIBGL_ALWAYS_SOFTWARE=1 or EGL_PLATFORM=surfaceless on a headless CI machine).
+ */
+class StreamingBufferUploaderTest : public ::testing::Test {
+protected:
+    static void SetUpTestCase() {
+        eglDisplay = EGL_NO_DISPLAY;
+        auto eglGetPlatformDisplayEXT = reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+                eglGetProcAddress("eglGetPlatformDisplayEXT"));
+        if (eglGetPlatformDisplayEXT) {
+            eglDisplay = eglGetPlatformDisplayEXT(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr);
+        }
+        if (eglDisplay == EGL_NO_DISPLAY) {
+            eglDisplay = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+        }
+        if (eglDisplay == EGL_NO_DISPLAY || !eglInitialize(eglDisplay, nullptr, nullptr)) {
+            eglDisplay = EGL_NO_DISPLAY;
+            return;
+        }
+
+        const EGLint configAttributes[] = {
+                EGL_SURFACE_TYPE, EGL_PBUFFER_BIT, EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+        EGLConfig eglConfig;
+        EGLint numConfigs = 0;
+        if (!eglChooseConfig(eglDisplay, configAttributes, &eglConfig, 1, &numConfigs) || numConfigs == 0
+                || !eglBindAPI(EGL_OPENGL_API)) {
+            return;
+        }
+        const EGLint pbufferAttributes[] = { EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE };
+        eglSurface = eglCreatePbufferSurface(eglDisplay, eglConfig, pbufferAttributes);
+        const EGLint contextAttributes[] = {
+                EGL_CONTEXT_MAJOR_VERSION, 3, EGL_CONTEXT_MINOR_VERSION, 3, EGL_NONE };
+        eglContext = eglCreateContext(eglDisplay, eglConfig, EGL_NO_CONTEXT, contextAttributes);
+        if (eglContext == EGL_NO_CONTEXT || !eglMakeCurrent(eglDisplay, eglSurface, eglSurface, eglContext)) {
+            return;
+        }
+
+        // GLEW reports a missing GLX display for EGL contexts, but the GL entry points are loaded nevertheless.
+        glewExperimental = GL_TRUE;
+        GLenum glewError = glewInit();
+        if (glewError != GLEW_OK && glewError != GLEW_ERROR_NO_GLX_DISPLAY) {
+            return;
+        }
+        if (!sgl::Renderer) {
+            sgl::Renderer = new sgl::RendererGL();
+            hasCreatedRenderer = true;
+        }
+        hasContext = true;
+    }
+
+    static void TearDownTestCase() {
+        if (hasCreatedRenderer) {
+            delete sgl::Renderer;
+            sgl::Renderer = nullptr;
+            hasCreatedRenderer = false;
+        }
+        if (eglDisplay != EGL_NO_DISPLAY) {
+            eglMakeCurrent(eglDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+            if (eglContext != EGL_NO_CONTEXT) {
+                eglDestroyContext(eglDisplay, eglContext);
+            }
+            if (eglSurface != EGL_NO_SURFACE) {
+                eglDestroySurface(eglDisplay, eglSurface);
+            }
+            eglTerminate(eglDisplay);
+        }
+        eglDisplay = EGL_NO_DISPLAY;
+        eglContext = EGL_NO_CONTEXT;
+        eglSurface = EGL_NO_SURFACE;
+        hasContext = false;
+    }
+
+    void SetUp() override {
+        if (!hasContext) {
+            GTEST_SKIP() << "No off-screen OpenGL context could be created via EGL.";
+        }
+    }
+
+    /// Calls StreamingBufferUploader::update until all data is uploaded, simulating one frame per call.
+    static int runFramesUntilUploaded(StreamingBufferUploader& uploader, size_t& maxBytesPerFrame) {
+        int numFrames = 0;
+        maxBytesPerFrame = 0;
+        while (uploader.getIsUploading() && numFrames < 100000) {
+            uploader.update();
+            maxBytesPerFrame = std::max(maxBytesPerFrame, uploader.getNumBytesUploadedLastFrame());
+            numFrames++;
+            glFinish();
+        }
+        return numFrames;
+    }
+
+    static std::vector<uint32_t> readBackBuffer(const sgl::GeometryBufferPtr& buffer, size_t numElements) {
+        std::vector<uint32_t> data(numElements, 0u);
+        GLuint bufferId = static_cast<sgl::GeometryBufferGL*>(buffer.get())->getBuffer();
+        glBindBuffer(GL_COPY_READ_BUFFER, bufferId);
+        glGetBufferSubData(GL_COPY_READ_BUFFER, 0, GLsizeiptr(numElements * sizeof(uint32_t)), data.data());
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        return data;
+    }
+
+    static std::vector<uint32_t> createTestData(size_t numElements, uint32_t seed) {
+        std::vector<uint32_t> data(numElements);
+        uint32_t state = seed;
+        for (size_t i = 0; i < numElements; i++) {
+            state = state * 1664525u + 1013904223u;
+            data.at(i) = state;
+        }
+        return data;
+    }
+
+    static EGLDisplay eglDisplay;
+    static EGLSurface eglSurface;
+    static EGLContext eglContext;
+    static bool hasContext;
+    static bool hasCreatedRenderer;
+};
+
+EGLDisplay StreamingBufferUploaderTest::eglDisplay = EGL_NO_DISPLAY;
+EGLSurface StreamingBufferUploaderTest::eglSurface = EGL_NO_SURFACE;
+EGLContext StreamingBufferUploaderTest::eglContext = EGL_NO_CONTEXT;
+bool StreamingBufferUploaderTest::hasContext = false;
+bool StreamingBufferUploaderTest::hasCreatedRenderer = false;
+
+const size_t STAGING_BUFFER_SIZE = 64 * 1024;
+const size_t FRAME_BUDGET = 160 * 1024;
+
+/**
+ * Uploads a buffer much larger than the per-frame budget and checks that the budget is respected, that the upload
+ * takes multiple frames and that the GPU-side content is byte-identical to the source data.
+ */
+TEST_F(StreamingBufferUploaderTest, MultiChunkUploadReadsBackIdentical) {
+    StreamingBufferUploader uploader(3, STAGING_BUFFER_SIZE, FRAME_BUDGET);
+    uploader.setMinStreamedBufferSize(0);
+
+    // Not a multiple of the staging buffer size, so the last chunk is a partial one.
+    const size_t numElements = 300 * 1024 + 7;
+    const size_t bufferSize = numElements * sizeof(uint32_t);
+    std::vector<uint32_t> referenceData = createTestData(numElements, 42u);
+    std::vector<uint32_t> data = referenceData;
+    sgl::GeometryBufferPtr buffer = uploader.createGeometryBuffer(std::move(data), sgl::SHADER_STORAGE_BUFFER);
+    ASSERT_NE(buffer, nullptr);
+    EXPECT_TRUE(uploader.getIsUploading());
+    EXPECT_EQ(uploader.getNumBytesPending(), bufferSize);
+
+    size_t maxBytesPerFrame = 0;
+    int numFrames = runFramesUntilUploaded(uploader, maxBytesPerFrame);
+    EXPECT_FALSE(uploader.getIsUploading());
+    EXPECT_EQ(uploader.getNumBytesPending(), size_t(0));
+    EXPECT_LE(maxBytesPerFrame, FRAME_BUDGET);
+    EXPECT_GE(size_t(numFrames), (bufferSize + FRAME_BUDGET - 1) / FRAME_BUDGET);
+
+    std::vector<uint32_t> gpuData = readBackBuffer(buffer, numElements);
+    EXPECT_EQ(memcmp(gpuData.data(), referenceData.data(), bufferSize), 0);
+
+    // Small buffers are uploaded immediately.
+    uploader.setMinStreamedBufferSize(bufferSize + 1);
+    std::vector<uint32_t> smallData = referenceData;
+    sgl::GeometryBufferPtr smallBuffer = uploader.createGeometryBuffer(std::move(smallData), sgl::VERTEX_BUFFER);
+    EXPECT_FALSE(uploader.getIsUploading());
+    gpuData = readBackBuffer(smallBuffer, numElements);
+    EXPECT_EQ(memcmp(gpuData.data(), referenceData.data(), bufferSize), 0);
+}
+
+/**
+ * The completion callback needs to be called exactly once and only after the last chunk of all buffers created
+ * before it was uploaded.
+ */
+TEST_F(StreamingBufferUploaderTest, CompletionCallbackFiresOnceAfterLastChunk) {
+    StreamingBufferUploader uploader(2, STAGING_BUFFER_SIZE, FRAME_BUDGET);
+    uploader.setMinStreamedBufferSize(0);
+
+    const size_t numElements0 = 100 * 1024;
+    const size_t numElements1 = 50 * 1024 + 3;
+    std::vector<uint32_t> referenceData0 = createTestData(numElements0, 1u);
+    std::vector<uint32_t> referenceData1 = createTestData(numElements1, 2u);
+    std::vector<uint32_t> data0 = referenceData0;
+    std::vector<uint32_t> data1 = referenceData1;
+    sgl::GeometryBufferPtr buffer0 = uploader.createGeometryBuffer(std::move(data0), sgl::VERTEX_BUFFER);
+    sgl::GeometryBufferPtr buffer1 = uploader.createGeometryBuffer(std::move(data1), sgl::INDEX_BUFFER);
+
+    int numCallbackCalls = 0;
+    size_t numBytesPendingAtCallback = std::numeric_limits<size_t>::max();
+    uploader.addCompletionCallback([&]() {
+        numCallbackCalls++;
+        numBytesPendingAtCallback = uploader.getNumBytesPending();
+    });
+    EXPECT_EQ(numCallbackCalls, 0);
+
+    int numFrames = 0;
+    while (uploader.getIsUploading() && numFrames < 100000) {
+        EXPECT_EQ(numCallbackCalls, 0);
+        uploader.update();
+        numFrames++;
+        glFinish();
+    }
+    EXPECT_GT(numFrames, 1);
+    EXPECT_EQ(numCallbackCalls, 1);
+    EXPECT_EQ(numBytesPendingAtCallback, size_t(0));
+
+    // Further frames must not call the callback again.
+    for (int i = 0; i < 3; i++) {
+        uploader.update();
+    }
+    EXPECT_EQ(numCallbackCalls, 1);
+
+    std::vector<uint32_t> gpuData0 = readBackBuffer(buffer0, numElements0);
+    std::vector<uint32_t> gpuData1 = readBackBuffer(buffer1, numElements1);
+    EXPECT_EQ(gpuData0, referenceData0);
+    EXPECT_EQ(gpuData1, referenceData1);
+
+    // Without pending uploads, the callback is called immediately.
+    int numImmediateCallbackCalls = 0;
+    uploader.addCompletionCallback([&]() { numImmediateCallbackCalls++; });
+    EXPECT_EQ(numImmediateCallbackCalls, 1);
+}
+
+/**
+ * When a buffer is freed before its upload has finished (e.g., because a new data set was loaded), the remaining
+ * chunks are dropped, while the uploads of the other buffers continue normally.
+ */
+TEST_F(StreamingBufferUploaderTest, UploadsOfFreedBuffersAreDropped) {
+    StreamingBufferUploader uploader(3, STAGING_BUFFER_SIZE, FRAME_BUDGET);
+    uploader.setMinStreamedBufferSize(0);
+
+    const size_t numElementsFreed = 400 * 1024;
+    const size_t numElementsKept = 120 * 1024 + 11;
+    const size_t bufferSizeFreed = numElementsFreed * sizeof(uint32_t);
+    const size_t bufferSizeKept = numElementsKept * sizeof(uint32_t);
+    std::vector<uint32_t> referenceDataKept = createTestData(numElementsKept, 7u);
+    std::vector<uint32_t> dataFreed = createTestData(numElementsFreed, 3u);
+    std::vector<uint32_t> dataKept = referenceDataKept;
+    sgl::GeometryBufferPtr bufferFreed = uploader.createGeometryBuffer(std::move(dataFreed), sgl::VERTEX_BUFFER);
+    sgl::GeometryBufferPtr bufferKept = uploader.createGeometryBuffer(std::move(dataKept), sgl::VERTEX_BUFFER);
+    int numCallbackCalls = 0;
+    uploader.addCompletionCallback([&]() { numCallbackCalls++; });
+
+    // Upload the first frame, so the freed buffer is only partially uploaded.
+    uploader.update();
+    size_t numBytesUploadedBeforeFree = uploader.getNumBytesUploadedLastFrame();
+    ASSERT_GT(numBytesUploadedBeforeFree, size_t(0));
+    ASSERT_LT(numBytesUploadedBeforeFree, bufferSizeFreed);
+    glFinish();
+    bufferFreed = sgl::GeometryBufferPtr();
+
+    size_t numBytesUploadedAfterFree = 0;
+    int numFrames = 0;
+    while (uploader.getIsUploading() && numFrames < 100000) {
+        uploader.update();
+        numBytesUploadedAfterFree += uploader.getNumBytesUploadedLastFrame();
+        numFrames++;
+        glFinish();
+    }
+    EXPECT_EQ(uploader.getNumBytesPending(), size_t(0));
+    EXPECT_EQ(numBytesUploadedAfterFree, bufferSizeKept);
+    EXPECT_EQ(numCallbackCalls, 1);
+
+    std::vector<uint32_t> gpuDataKept = readBackBuffer(bufferKept, numElementsKept);
+    EXPECT_EQ(gpuDataKept, referenceDataKept);
+}
@@ -0,0 +1,291 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+#include <fstream>
+#include <boost/filesystem.hpp>
+#include "gtest/gtest.h"
+#include "Loaders/StressTrajectoriesBinaryLoader.hpp"
+#include "LineData/Stress/StressLineTracer.hpp"
+
+/**
+ * Creates a hexahedral grid with numCells^3 cells over [0, 1]^3 with an optional shear in x direction.
+ * @param tensorFunction Computes the stress tensor (xx, yy, zz, yz, zx, xy) at a vertex position.
+ */
+template<class F>
+static StressTensorMesh createHexGrid(int numCells, float shear, F tensorFunction) {
+    StressTensorMesh mesh;
+    const int numVerticesPerAxis = numCells + 1;
+    for (int z = 0; z < numVerticesPerAxis; z++) {
+        for (int y = 0; y < numVerticesPerAxis; y++) {
+            for (int x = 0; x < numVerticesPerAxis; x++) {
+                glm::vec3 vertex(float(x) / float(numCells), float(y) / float(numCells), float(z) / float(numCells));
+                vertex.x += shear * vertex.y;
+                mesh.vertices.push_back(vertex);
+                float tensor[6];
+                tensorFunction(vertex, tensor);
+                mesh.stressTensors.insert(mesh.stressTensors.end(), tensor, tensor + 6);
+            }
+        }
+    }
+    auto vertexIndex = [numVerticesPerAxis](int x, int y, int z) {
+        return uint32_t((z * numVerticesPerAxis + y) * numVerticesPerAxis + x);
+    };
+    for (int z = 0; z < numCells; z++) {
+        for (int y = 0; y < numCells; y++) {
+            for (int x = 0; x < numCells; x++) {
+                mesh.cellIndices.insert(mesh.cellIndices.end(), {
+                        vertexIndex(x, y, z), vertexIndex(x + 1, y, z),
+                        vertexIndex(x + 1, y + 1, z), vertexIndex(x, y + 1, z),
+                        vertexIndex(x, y, z + 1), vertexIndex(x + 1, y, z + 1),
+                        vertexIndex(x + 1, y + 1, z + 1), vertexIndex(x, y + 1, z + 1) });
+            }
+        }
+    }
+    return mesh;
+}
+
+static void uniformTensor(const glm::vec3& position, float tensor[6]) {
+    const float values[6] = { 3.0f, 2.0f, 1.0f, 0.0f, 0.0f, 0.0f };
+    for (int i = 0; i < 6; i++) {
+        tensor[i] = values[i];
+    }
+}
+
+TEST(StressLineTracerTest, EigenDecomposition) {
+    const float tensor[6] = { 4.0f, -1.0f, 2.5f, 0.7f, -1.3f, 2.0f };
+    float eigenvalues[3];
+    glm::vec3 eigenvectors[3];
+    computeEigenDecompositionSymmetric(tensor, eigenvalues, eigenvectors);
+    EXPECT_GE(eigenvalues[0], eigenvalues[1]);
+    EXPECT_GE(eigenvalues[1], eigenvalues[2]);
+    EXPECT_NEAR(eigenvalues[0] + eigenvalues[1] + eigenvalues[2], 4.0f - 1.0f + 2.5f, 1e-4f);
+
+    for (int i = 0; i < 3; i++) {
+        // A v = lambda v
+        const glm::vec3& v = eigenvectors[i];
+        glm::vec3 av(
+                tensor[0] * v.x + tensor[5] * v.y + tensor[4] * v.z,
+                tensor[5] * v.x + tensor[1] * v.y + tensor[3] * v.z,
+                tensor[4] * v.x + tensor[3] * v.y + tensor[2] * v.z);
+        EXPECT_NEAR(glm::length(av - eigenvalues[i] * v), 0.0f, 1e-4f);
+        EXPECT_NEAR(glm::length(v), 1.0f, 1e-5f);
+    }
+    EXPECT_NEAR(glm::dot(eigenvectors[0], eigenvectors[2]), 0.0f, 1e-5f);
+
+    const float diagonalTensor[6] = { 1.0f, 3.0f, 2.0f, 0.0f, 0.0f, 0.0f };
+    computeEigenDecompositionSymmetric(diagonalTensor, eigenvalues, eigenvectors);
+    EXPECT_FLOAT_EQ(eigenvalues[0], 3.0f);
+    EXPECT_FLOAT_EQ(eigenvalues[2], 1.0f);
+    EXPECT_NEAR(std::abs(eigenvectors[0].y), 1.0f, 1e-6f);
+    EXPECT_NEAR(std::abs(eigenvectors[2].x), 1.0f, 1e-6f);
+}
+
+TEST(StressLineTracerTest, PointLocationAndInterpolation) {
+    // The cells of a sheared grid are parallelepipeds, so a linear field is reproduced exactly by the interpolation.
+    StressTensorMesh mesh = createHexGrid(6, 0.3f, [](const glm::vec3& position, float tensor[6]) {
+        tensor[0] = position.x;
+        tensor[1] = position.y;
+        tensor[2] = position.z;
+        tensor[3] = tensor[4] = tensor[5] = 0.0f;
+    });
+    StressLineTracer tracer(mesh);
+    EXPECT_NEAR(tracer.getAverageEdgeLength(), (1.0f + 1.0f + std::sqrt(1.0f + 0.09f)) / 3.0f / 6.0f, 1e-4f);
+
+    const glm::vec3 queryPoints[] = {
+            glm::vec3(0.5f, 0.5f, 0.5f), glm::vec3(0.95f, 0.9f, 0.1f), glm::vec3(0.31f, 0.02f, 0.77f),
+            glm::vec3(1.25f, 0.99f, 0.5f) };
+    for (const glm::vec3& queryPoint : queryPoints) {
+        uint32_t cellIdx = 0;
+        glm::vec3 localCoordinates;
+        ASSERT_TRUE(tracer.locateCell(queryPoint, cellIdx, localCoordinates));
+        float tensor[6];
+        tracer.interpolateStressTensor(cellIdx, localCoordinates, tensor);
+        EXPECT_NEAR(tensor[0], queryPoint.x, 1e-4f);
+        EXPECT_NEAR(tensor[1], queryPoint.y, 1e-4f);
+        EXPECT_NEAR(tensor[2], queryPoint.z, 1e-4f);
+    }
+
+    // Positions outside of the mesh.
+    uint32_t cellIdx = 0;
+    glm::vec3 localCoordinates;
+    EXPECT_FALSE(tracer.locateCell(glm::vec3(0.0f, 0.5f, 0.5f), cellIdx, localCoordinates));
+    EXPECT_FALSE(tracer.locateCell(glm::vec3(0.5f, 0.5f, 1.2f), cellIdx, localCoordinates));
+}
+
+TEST(StressLineTracerTest, UniformTensorFieldStraightLines) {
+    StressTensorMesh mesh = createHexGrid(8, 0.0f, uniformTensor);
+    StressLineTracer tracer(mesh);
+    const TracingAlgorithm tracingAlgorithms[] = {
+            TracingAlgorithm::EULER, TracingAlgorithm::RK2, TracingAlgorithm::RK4 };
+    for (TracingAlgorithm tracingAlgorithm : tracingAlgorithms) {
+        StressLineTracingSettings settings;
+        settings.psIndices = { 0, 2 };
+        settings.tracingAlgorithm = tracingAlgorithm;
+        settings.lineDensCtrl = 4.0f;
+        settings.seedDensCtrl = 1.0f;
+        StressTrajectoriesMemoryData data;
+        ASSERT_TRUE(tracer.trace(settings, data));
+        ASSERT_EQ(data.trajectoriesPs.size(), size_t(2));
+        EXPECT_EQ(data.meshType, MeshType::UNSTRUCTURED);
+
+        std::vector<bool> usedAppearanceOrders;
+        for (size_t lineSetIdx = 0; lineSetIdx < 2; lineSetIdx++) {
+            // Major lines run along x, minor lines along z.
+            const int axis = lineSetIdx == 0 ? 0 : 2;
+            const Trajectories& trajectories = data.trajectoriesPs.at(lineSetIdx);
+            EXPECT_GE(trajectories.size(), size_t(4));
+            for (size_t lineIdx = 0; lineIdx < trajectories.size(); lineIdx++) {
+                const Trajectory& trajectory = trajectories.at(lineIdx);
+                ASSERT_GE(trajectory.positions.size(), size_t(2));
+                ASSERT_EQ(trajectory.attributes.size(), size_t(9));
+                for (const glm::vec3& position : trajectory.positions) {
+                    for (int i = 0; i < 3; i++) {
+                        if (i != axis) {
+                            EXPECT_NEAR(position[i], trajectory.positions.front()[i], 1e-4f);
+                        }
+                    }
+                }
+                // Lines not stopped by other lines span the whole mesh.
+                float lineExtent = std::abs(trajectory.positions.back()[axis] - trajectory.positions.front()[axis]);
+                EXPECT_GT(lineExtent, 0.2f);
+                EXPECT_FLOAT_EQ(trajectory.attributes.at(0).front(), lineSetIdx == 0 ? 3.0f : 1.0f);
+                EXPECT_FLOAT_EQ(trajectory.attributes.at(3).front(), 3.0f);
+
+                const StressTrajectoryData& stressTrajectoryData =
+                        data.stressTrajectoriesDataPs.at(lineSetIdx).at(lineIdx);
+                ASSERT_EQ(stressTrajectoryData.hierarchyLevels.size(), size_t(4));
+                for (float hierarchyLevel : stressTrajectoryData.hierarchyLevels) {
+                    EXPECT_GT(hierarchyLevel, 0.0f);
+                    EXPECT_LE(hierarchyLevel, 1.0f);
+                }
+                size_t appearanceOrder = size_t(stressTrajectoryData.appearanceOrder);
+                if (appearanceOrder >= usedAppearanceOrders.size()) {
+                    usedAppearanceOrders.resize(appearanceOrder + 1, false);
+                }
+                EXPECT_FALSE(usedAppearanceOrders.at(appearanceOrder));
+                usedAppearanceOrders.at(appearanceOrder) = true;
+                EXPECT_EQ(
+                        data.bandPointsSmoothedListLeftPs.at(lineSetIdx).at(lineIdx).size(),
+                        trajectory.positions.size());
+            }
+        }
+    }
+}
+
+TEST(StressLineTracerTest, DeterministicSeeding) {
+    StressTensorMesh mesh = createHexGrid(10, 0.2f, [](const glm::vec3& position, float tensor[6]) {
+        tensor[0] = 2.0f + position.y;
+        tensor[1] = 1.0f - position.x;
+        tensor[2] = -1.0f;
+        tensor[3] = 0.1f * position.z;
+        tensor[4] = 0.0f;
+        tensor[5] = 0.5f * position.x * position.y;
+    });
+    StressLineTracer tracer(mesh);
+    const SeedStrategy seedStrategies[] = { SeedStrategy::VOLUME, SeedStrategy::SURFACE };
+    for (SeedStrategy seedStrategy : seedStrategies) {
+        StressLineTracingSettings settings;
+        settings.seedStrategy = seedStrategy;
+        settings.psIndices = { 0, 1, 2 };
+        settings.lineDensCtrl = 6.0f;
+        settings.seedDensCtrl = 2.0f;
+        StressTrajectoriesMemoryData data0, data1;
+        ASSERT_TRUE(tracer.trace(settings, data0));
+        ASSERT_TRUE(tracer.trace(settings, data1));
+        ASSERT_EQ(data0.trajectoriesPs.size(), size_t(3));
+        for (size_t lineSetIdx = 0; lineSetIdx < 3; lineSetIdx++) {
+            const Trajectories& trajectories0 = data0.trajectoriesPs.at(lineSetIdx);
+            const Trajectories& trajectories1 = data1.trajectoriesPs.at(lineSetIdx);
+            EXPECT_GT(trajectories0.size(), size_t(0));
+            ASSERT_EQ(trajectories0.size(), trajectories1.size());
+            for (size_t lineIdx = 0; lineIdx < trajectories0.size(); lineIdx++) {
+                EXPECT_TRUE(trajectories0.at(lineIdx).positions == trajectories1.at(lineIdx).positions);
+            }
+        }
+    }
+
+    std::atomic<bool> isCancelled(true);
+    StressTrajectoriesMemoryData data;
+    EXPECT_FALSE(tracer.trace(StressLineTracingSettings(), data, &isCancelled));
+}
+
+/// A merging threshold of zero must not result in a line separation distance (and grid cell size) of zero.
+TEST(StressLineTracerTest, ZeroMergingThreshold) {
+    StressTensorMesh mesh = createHexGrid(4, 0.0f, uniformTensor);
+    StressLineTracer tracer(mesh);
+    StressLineTracingSettings settings;
+    settings.psIndices = { 0 };
+    settings.lineDensCtrl = 4.0f;
+    settings.seedDensCtrl = 1.0f;
+    settings.multiMergingThresholds = glm::vec3(0.0f);
+    StressTrajectoriesMemoryData data;
+    ASSERT_TRUE(tracer.trace(settings, data));
+    ASSERT_EQ(data.trajectoriesPs.size(), size_t(1));
+    EXPECT_GT(data.trajectoriesPs.front().size(), size_t(0));
+    for (const Trajectory& trajectory : data.trajectoriesPs.front()) {
+        for (const glm::vec3& position : trajectory.positions) {
+            EXPECT_TRUE(std::isfinite(position.x) && std::isfinite(position.y) && std::isfinite(position.z));
+        }
+    }
+}
+
+TEST(StressLineTracerTest, LoadVtkStressTensors) {
+    boost::filesystem::path filename = boost::filesystem::temp_directory_path() / "LineVis_test_stress_mesh.vtk";
+    {
+        std::ofstream file(filename.string());
+        file << "# vtk DataFile Version 3.0\nStress mesh\nASCII\nDATASET UNSTRUCTURED_GRID\nPOINTS 8 float\n";
+        for (int i = 0; i < 8; i++) {
+            file << (i == 1 || i == 2 || i == 5 || i == 6) << " " << (i == 2 || i == 3 || i == 6 || i == 7) << " "
+                 << (i >= 4) << "\n";
+        }
+        file << "CELLS 1 9\n8 0 1 2 3 4 5 6 7\nCELL_TYPES 1\n12\n";
+        file << "POINT_DATA 8\nSCALARS vonMises float 1\nLOOKUP_TABLE default\n";
+        for (int i = 0; i < 8; i++) {
+            file << "1.0\n";
+        }
+        // Full tensors with xx = i, yy = 10, zz = 20, xy = 1, yz = 2, zx = 3.
+        file << "TENSORS stress float\n";
+        for (int i = 0; i < 8; i++) {
+            file << i << " 1 3\n1 10 2\n3 2 20\n\n";
+        }
+    }
+
+    StressTensorMesh mesh;
+    ASSERT_TRUE(loadStressTensorMeshFromFile(filename.string(), mesh));
+    boost::filesystem::remove(filename);
+    ASSERT_EQ(mesh.vertices.size(), size_t(8));
+    ASSERT_EQ(mesh.cellIndices.size(), size_t(8));
+    ASSERT_EQ(mesh.stressTensors.size(), size_t(48));
+    for (int i = 0; i < 8; i++) {
+        const float expectedTensor[6] = { float(i), 10.0f, 20.0f, 2.0f, 3.0f, 1.0f };
+        for (int j = 0; j < 6; j++) {
+            EXPECT_FLOAT_EQ(mesh.stressTensors.at(i * 6 + j), expectedTensor[j]);
+        }
+    }
+}
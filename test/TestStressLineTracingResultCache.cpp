@@ -0,0 +1,195 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <boost/filesystem.hpp>
+#include "gtest/gtest.h"
+#include "Loaders/StressTrajectoriesBinaryLoader.hpp"
+#include "LineData/Stress/StressLineTracingResultCache.hpp"
+
+/// Creates one line set with numLines straight lines of three points each.
+static std::shared_ptr<const StressTrajectoriesMemoryData> createLineData(size_t numLines, float offset) {
+    std::shared_ptr<StressTrajectoriesMemoryData> data = std::make_shared<StressTrajectoriesMemoryData>();
+    data->loadedPsIndices.push_back(0);
+    data->trajectoriesPs.emplace_back(numLines);
+    data->stressTrajectoriesDataPs.emplace_back(numLines);
+    for (size_t lineIdx = 0; lineIdx < numLines; lineIdx++) {
+        Trajectory& trajectory = data->trajectoriesPs.back().at(lineIdx);
+        trajectory.attributes.resize(9);
+        for (int pointIdx = 0; pointIdx < 3; pointIdx++) {
+            trajectory.positions.emplace_back(float(pointIdx), float(lineIdx), offset);
+            for (int attributeIdx = 0; attributeIdx < 9; attributeIdx++) {
+                trajectory.attributes.at(attributeIdx).push_back(float(attributeIdx) - 1.0f);
+            }
+        }
+        StressTrajectoryData& stressTrajectoryData = data->stressTrajectoriesDataPs.back().at(lineIdx);
+        stressTrajectoryData.hierarchyLevels = { 0.5f, 1.0f };
+        stressTrajectoryData.appearanceOrder = int(lineIdx);
+        stressTrajectoryData.seedPosition = trajectory.positions.front();
+    }
+    return data;
+}
+
+static Json::Value createRequest(float lineDensCtrl) {
+    Json::Value request;
+    request["lineDensCtrl"] = lineDensCtrl;
+    request["seedStrategy"] = "Volume";
+    request["selectedPrincipalStressField"].append(1);
+    return request;
+}
+
+TEST(StressLineTracingResultCacheTest, CanonicalKey) {
+    std::string canonicalRequest0, canonicalRequest1, canonicalRequest2, canonicalRequest3;
+    Json::Value request0 = createRequest(16.0f);
+    Json::Value request1 = createRequest(16.0f);
+    request1["requestId"] = 42;
+    request1["binaryReply"] = true;
+    request1["streamReply"] = true;
+    std::string key0 = StressLineTracingResultCache::computeCacheKey("mesh", request0, canonicalRequest0);
+    std::string key1 = StressLineTracingResultCache::computeCacheKey("mesh", request1, canonicalRequest1);
+    EXPECT_EQ(key0, key1);
+    EXPECT_EQ(canonicalRequest0, canonicalRequest1);
+
+    // Different parameters or meshes must result in different keys.
+    std::string key2 = StressLineTracingResultCache::computeCacheKey(
+            "mesh", createRequest(8.0f), canonicalRequest2);
+    std::string key3 = StressLineTracingResultCache::computeCacheKey("mesh2", request0, canonicalRequest3);
+    EXPECT_NE(key0, key2);
+    EXPECT_NE(key0, key3);
+}
+
+TEST(StressLineTracingResultCacheTest, MemoryEviction) {
+    std::shared_ptr<const StressTrajectoriesMemoryData> data0 = createLineData(100, 0.0f);
+    const size_t entrySize = getStressTrajectoriesMemoryDataSize(*data0);
+    StressLineTracingResultCache cache(entrySize * 2);
+
+    std::string canonicalRequests[3];
+    std::string keys[3];
+    for (int i = 0; i < 3; i++) {
+        keys[i] = StressLineTracingResultCache::computeCacheKey(
+                "mesh", createRequest(float(i + 1)), canonicalRequests[i]);
+    }
+    cache.put(keys[0], canonicalRequests[0], Json::Value(), data0);
+    cache.put(keys[1], canonicalRequests[1], Json::Value(), createLineData(100, 1.0f));
+
+    // Accessing the first entry makes the second one the least recently used entry.
+    Json::Value reply;
+    std::shared_ptr<const StressTrajectoriesMemoryData> data;
+    EXPECT_TRUE(cache.get(keys[0], canonicalRequests[0], reply, data));
+    EXPECT_EQ(data, data0);
+    cache.put(keys[2], canonicalRequests[2], Json::Value(), createLineData(100, 2.0f));
+    EXPECT_EQ(cache.getNumEntries(), size_t(2));
+    EXPECT_LE(cache.getMemorySize(), entrySize * 2);
+    EXPECT_TRUE(cache.get(keys[0], canonicalRequests[0], reply, data));
+    EXPECT_FALSE(cache.get(keys[1], canonicalRequests[1], reply, data));
+    EXPECT_TRUE(cache.get(keys[2], canonicalRequests[2], reply, data));
+
+    // A key with a different canonical request (i.e., a hash collision) must not be returned.
+    EXPECT_FALSE(cache.get(keys[2], canonicalRequests[0], reply, data));
+}
+
+TEST(StressLineTracingResultCacheTest, DiskCache) {
+    boost::filesystem::path directory =
+            boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("psl-cache-test-%%%%%%%%");
+    std::string canonicalRequest;
+    std::string key = StressLineTracingResultCache::computeCacheKey("mesh", createRequest(16.0f), canonicalRequest);
+    std::shared_ptr<const StressTrajectoriesMemoryData> data0 = createLineData(10, 0.5f);
+    Json::Value reply0;
+    reply0["attributes"].append("Principal Stress");
+    reply0["requestId"] = 7;
+    {
+        StressLineTracingResultCache cache(size_t(1) << 20, directory.string());
+        cache.put(key, canonicalRequest, reply0, data0);
+    }
+
+    // A new cache (e.g., after restarting the program) finds the result on disk.
+    StressLineTracingResultCache cache(size_t(1) << 20, directory.string());
+    Json::Value reply;
+    std::shared_ptr<const StressTrajectoriesMemoryData> data;
+    ASSERT_TRUE(cache.get(key, canonicalRequest, reply, data));
+    ASSERT_TRUE(data != nullptr);
+    EXPECT_EQ(reply["attributes"], reply0["attributes"]);
+    EXPECT_FALSE(reply.isMember("requestId"));
+    ASSERT_EQ(data->trajectoriesPs.size(), size_t(1));
+    ASSERT_EQ(data->trajectoriesPs.front().size(), size_t(10));
+    for (size_t lineIdx = 0; lineIdx < 10; lineIdx++) {
+        const Trajectory& trajectory0 = data0->trajectoriesPs.front().at(lineIdx);
+        const Trajectory& trajectory = data->trajectoriesPs.front().at(lineIdx);
+        EXPECT_EQ(trajectory.positions, trajectory0.positions);
+        EXPECT_EQ(trajectory.attributes.at(0), trajectory0.attributes.at(0));
+        EXPECT_EQ(
+                data->stressTrajectoriesDataPs.front().at(lineIdx).appearanceOrder,
+                data0->stressTrajectoriesDataPs.front().at(lineIdx).appearanceOrder);
+    }
+
+    cache.clear();
+    EXPECT_FALSE(cache.get(key, canonicalRequest, reply, data));
+    boost::filesystem::remove_all(directory);
+}
+
+/**
+ * A reply is only stored under the key of the request it belongs to. E.g., if a reply to an older request arrives
+ * after a newer request was sent (or after the cache was enabled while the older request was processed), it must not
+ * be stored under the key of the newer request.
+ */
+TEST(StressLineTracingResultCacheTest, ReplyStoredUnderKeyOfItsRequest) {
+    StressLineTracingResultCache cache(size_t(1) << 20);
+    std::string canonicalRequest0, canonicalRequest1;
+    std::string key0 = StressLineTracingResultCache::computeCacheKey("mesh", createRequest(8.0f), canonicalRequest0);
+    std::string key1 = StressLineTracingResultCache::computeCacheKey("mesh", createRequest(16.0f), canonicalRequest1);
+    std::shared_ptr<const StressTrajectoriesMemoryData> data0 = createLineData(10, 0.0f);
+    std::shared_ptr<const StressTrajectoriesMemoryData> data1 = createLineData(10, 1.0f);
+    Json::Value reply0, reply1;
+    reply0["requestId"] = 1;
+    reply1["requestId"] = 2;
+
+    // Request 1 is superseded by request 2 before its reply arrives.
+    cache.setPendingRequest(1, key0, canonicalRequest0);
+    cache.setPendingRequest(2, key1, canonicalRequest1);
+    EXPECT_FALSE(cache.putReply(reply0, data0));
+    Json::Value reply;
+    std::shared_ptr<const StressTrajectoriesMemoryData> data;
+    EXPECT_FALSE(cache.get(key0, canonicalRequest0, reply, data));
+    EXPECT_FALSE(cache.get(key1, canonicalRequest1, reply, data));
+
+    // Partial replies and replies without an ID are not stored.
+    Json::Value partialReply = reply1;
+    partialReply["partial"] = true;
+    EXPECT_FALSE(cache.putReply(partialReply, data1));
+    EXPECT_FALSE(cache.putReply(Json::Value(), data1));
+    EXPECT_EQ(cache.getNumEntries(), size_t(0));
+
+    EXPECT_TRUE(cache.putReply(reply1, data1));
+    ASSERT_TRUE(cache.get(key1, canonicalRequest1, reply, data));
+    EXPECT_EQ(data, data1);
+    EXPECT_FALSE(cache.get(key0, canonicalRequest0, reply, data));
+
+    // A result loaded from the cache leaves no request pending, so late replies are dropped.
+    cache.setPendingRequest(0, "", "");
+    EXPECT_FALSE(cache.putReply(reply1, data1));
+    EXPECT_EQ(cache.getNumEntries(), size_t(1));
+}
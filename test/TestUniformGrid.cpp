@@ -0,0 +1,181 @@
+/*
+ * BSD 2-Clause License
+ *
+ * Copyright (c) 2021, Christoph Neuhauser
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <random>
+#include <algorithm>
+#include <glm/glm.hpp>
+#include "gtest/gtest.h"
+#include "LineData/SearchStructures/NaiveSearchStructure.h"
+#include "LineData/SearchStructures/UniformGrid.hpp"
+
+/**
+ * Compares the area searches of the uniform grid with the exact results computed by filtering all points returned by
+ * NaiveSearchStructure. The parameter is the number of points.
+ */
+class UniformGridTest : public ::testing::TestWithParam<int> {
+protected:
+    void SetUp() override {
+        N = GetParam();
+        std::default_random_engine generator(12345);
+        std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+        indexedPoints.resize(N);
+        for (int i = 0; i < N; i++) {
+            indexedPoints.at(i).index = i;
+            indexedPoints.at(i).position = glm::vec3(
+                    distribution(generator), distribution(generator), distribution(generator));
+            indexedPointsPointers.push_back(&indexedPoints.at(i));
+        }
+        naiveSearchStructure.build(indexedPointsPointers);
+    }
+
+    /// Returns the sorted indices of the passed points for comparing the results of area searches.
+    static std::vector<ptrdiff_t> getSortedIndices(const std::vector<IndexedPoint*>& points) {
+        std::vector<ptrdiff_t> indices;
+        indices.reserve(points.size());
+        for (IndexedPoint* point : points) {
+            indices.push_back(point->index);
+        }
+        std::sort(indices.begin(), indices.end());
+        return indices;
+    }
+
+    std::vector<IndexedPoint*> findPointsInSphereNaive(const glm::vec3& center, float radius) {
+        std::vector<IndexedPoint*> pointsInSphere;
+        for (IndexedPoint* point : naiveSearchStructure.findPointsInSphere(center, radius)) {
+            if (glm::distance(point->position, center) <= radius) {
+                pointsInSphere.push_back(point);
+            }
+        }
+        return pointsInSphere;
+    }
+
+    std::vector<IndexedPoint*> findPointsInAxisAlignedBoxNaive(const AxisAlignedBox& box) {
+        std::vector<IndexedPoint*> pointsInBox;
+        for (IndexedPoint* point : naiveSearchStructure.findPointsInAxisAlignedBox(box)) {
+            if (box.contains(point->position)) {
+                pointsInBox.push_back(point);
+            }
+        }
+        return pointsInBox;
+    }
+
+    /// Compares the results of random queries partially or fully outside of the unit cube with the naive results.
+    void testQueries(UniformGrid& uniformGrid) {
+        std::default_random_engine generator(54321);
+        std::uniform_real_distribution<float> distribution(-0.2f, 1.2f);
+        for (int i = 0; i < 32; i++) {
+            glm::vec3 center(distribution(generator), distribution(generator), distribution(generator));
+            float radius = 0.3f * std::abs(distribution(generator));
+
+            EXPECT_EQ(
+                    getSortedIndices(findPointsInSphereNaive(center, radius)),
+                    getSortedIndices(uniformGrid.findPointsInSphere(center, radius)));
+
+            AxisAlignedBox box(
+                    center - glm::vec3(radius, 0.5f * radius, 2.0f * radius),
+                    center + glm::vec3(0.5f * radius, radius, radius));
+            EXPECT_EQ(
+                    getSortedIndices(findPointsInAxisAlignedBoxNaive(box)),
+                    getSortedIndices(uniformGrid.findPointsInAxisAlignedBox(box)));
+        }
+    }
+
+    int N = 0;
+    std::vector<IndexedPoint> indexedPoints;
+    std::vector<IndexedPoint*> indexedPointsPointers;
+    NaiveSearchStructure naiveSearchStructure;
+};
+
+TEST_P(UniformGridTest, AutomaticCellSize) {
+    UniformGrid uniformGrid;
+    uniformGrid.build(indexedPointsPointers);
+    EXPECT_EQ(uniformGrid.getNumPoints(), size_t(N));
+    EXPECT_GT(uniformGrid.getCellSize(), 0.0f);
+    testQueries(uniformGrid);
+}
+
+TEST_P(UniformGridTest, FixedCellSize) {
+    UniformGrid uniformGrid(0.1f);
+    uniformGrid.build(indexedPointsPointers);
+    testQueries(uniformGrid);
+}
+
+TEST_P(UniformGridTest, TooSmallCellSize) {
+    // The cell size needs to be enlarged internally to limit the size of the cell offset table.
+    UniformGrid uniformGrid(1e-6f);
+    uniformGrid.build(indexedPointsPointers);
+    glm::ivec3 gridResolution = uniformGrid.getGridResolution();
+    EXPECT_LE(
+            size_t(gridResolution.x) * size_t(gridResolution.y) * size_t(gridResolution.z), size_t(8 * N + 1));
+    testQueries(uniformGrid);
+}
+
+INSTANTIATE_TEST_SUITE_P(PointCountTest, UniformGridTest, ::testing::Values(1, 2, 10, 128, 1024, 20000));
+
+TEST(UniformGridDegenerateTest, EmptyAndCoincidentPoints) {
+    UniformGrid uniformGrid;
+    uniformGrid.build({});
+    EXPECT_TRUE(uniformGrid.findPointsInSphere(glm::vec3(0.0f), 1.0f).empty());
+
+    std::vector<IndexedPoint> indexedPoints(100);
+    std::vector<IndexedPoint*> indexedPointsPointers;
+    for (size_t i = 0; i < indexedPoints.size(); i++) {
+        indexedPoints.at(i).index = ptrdiff_t(i);
+        indexedPoints.at(i).position = glm::vec3(0.5f);
+        indexedPointsPointers.push_back(&indexedPoints.at(i));
+    }
+    uniformGrid.build(indexedPointsPointers);
+    EXPECT_EQ(uniformGrid.findPointsInSphere(glm::vec3(0.5f), 0.0f).size(), indexedPoints.size());
+    EXPECT_TRUE(uniformGrid.findPointsInSphere(glm::vec3(0.0f), 0.1f).empty());
+}
+
+TEST(UniformGridDegenerateTest, PlanarPoints) {
+    std::default_random_engine generator(12345);
+    std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+    std::vector<IndexedPoint> indexedPoints(10000);
+    std::vector<IndexedPoint*> indexedPointsPointers;
+    for (size_t i = 0; i < indexedPoints.size(); i++) {
+        indexedPoints.at(i).index = ptrdiff_t(i);
+        indexedPoints.at(i).position = glm::vec3(distribution(generator), distribution(generator), 0.0f);
+        indexedPointsPointers.push_back(&indexedPoints.at(i));
+    }
+    UniformGrid uniformGrid;
+    uniformGrid.build(indexedPointsPointers);
+    EXPECT_EQ(uniformGrid.getGridResolution().z, 1);
+    // Roughly a few points per cell in the plane.
+    EXPECT_GT(uniformGrid.getGridResolution().x * uniformGrid.getGridResolution().y, 100);
+
+    std::vector<IndexedPoint*> pointsInSphere = uniformGrid.findPointsInSphere(glm::vec3(0.5f, 0.5f, 0.0f), 0.1f);
+    size_t numPointsInSphere = 0;
+    for (const IndexedPoint& point : indexedPoints) {
+        if (glm::distance(point.position, glm::vec3(0.5f, 0.5f, 0.0f)) <= 0.1f) {
+            numPointsInSphere++;
+        }
+    }
+    EXPECT_EQ(pointsInSphere.size(), numPointsInSphere);
+}